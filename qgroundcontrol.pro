@@ -347,6 +347,7 @@ INCLUDEPATH += \
     src/QtLocationPlugin \
     src/QtLocationPlugin/QMLControl \
     src/Settings \
+    src/Terrain \
     src/VehicleSetup \
     src/ViewWidgets \
     src/audio \
@@ -408,10 +409,14 @@ DebugBuild { PX4FirmwarePlugin { PX4FirmwarePluginFactory  { APMFirmwarePlugin {
         src/qgcunittest
 
     HEADERS += \
+        src/AnalyzeView/GeoTagTest.h \
         src/AnalyzeView/LogDownloadTest.h \
+        src/AnalyzeView/PX4LogParserTest.h \
+        src/AnalyzeView/ULogReaderTest.h \
         src/FactSystem/FactSystemTestBase.h \
         src/FactSystem/FactSystemTestGeneric.h \
         src/FactSystem/FactSystemTestPX4.h \
+        src/FactSystem/ParameterDownloadCoordinatorTest.h \
         src/FactSystem/ParameterManagerTest.h \
         src/MissionManager/CameraSectionTest.h \
         src/MissionManager/MissionCommandTreeTest.h \
@@ -432,6 +437,7 @@ DebugBuild { PX4FirmwarePlugin { PX4FirmwarePluginFactory  { APMFirmwarePlugin {
         src/qgcunittest/FlightGearTest.h \
         src/qgcunittest/GeoTest.h \
         src/qgcunittest/LinkManagerTest.h \
+        src/qgcunittest/LogCompressorTest.h \
         src/qgcunittest/MainWindowTest.h \
         src/qgcunittest/MavlinkLogTest.h \
         src/qgcunittest/MessageBoxTest.h \
@@ -440,13 +446,19 @@ DebugBuild { PX4FirmwarePlugin { PX4FirmwarePluginFactory  { APMFirmwarePlugin {
         src/qgcunittest/TCPLinkTest.h \
         src/qgcunittest/TCPLoopBackServer.h \
         src/qgcunittest/UnitTest.h \
+        src/Terrain/TerrainTileTest.h \
+        src/Vehicle/MAVLinkLogProcessorTest.h \
         src/Vehicle/SendMavCommandTest.h \
 
     SOURCES += \
+        src/AnalyzeView/GeoTagTest.cc \
         src/AnalyzeView/LogDownloadTest.cc \
+        src/AnalyzeView/PX4LogParserTest.cc \
+        src/AnalyzeView/ULogReaderTest.cc \
         src/FactSystem/FactSystemTestBase.cc \
         src/FactSystem/FactSystemTestGeneric.cc \
         src/FactSystem/FactSystemTestPX4.cc \
+        src/FactSystem/ParameterDownloadCoordinatorTest.cc \
         src/FactSystem/ParameterManagerTest.cc \
         src/MissionManager/CameraSectionTest.cc \
         src/MissionManager/MissionCommandTreeTest.cc \
@@ -467,6 +479,7 @@ DebugBuild { PX4FirmwarePlugin { PX4FirmwarePluginFactory  { APMFirmwarePlugin {
         src/qgcunittest/FlightGearTest.cc \
         src/qgcunittest/GeoTest.cc \
         src/qgcunittest/LinkManagerTest.cc \
+        src/qgcunittest/LogCompressorTest.cc \
         src/qgcunittest/MainWindowTest.cc \
         src/qgcunittest/MavlinkLogTest.cc \
         src/qgcunittest/MessageBoxTest.cc \
@@ -476,6 +489,8 @@ DebugBuild { PX4FirmwarePlugin { PX4FirmwarePluginFactory  { APMFirmwarePlugin {
         src/qgcunittest/TCPLoopBackServer.cc \
         src/qgcunittest/UnitTest.cc \
         src/qgcunittest/UnitTestList.cc \
+        src/Terrain/TerrainTileTest.cc \
+        src/Vehicle/MAVLinkLogProcessorTest.cc \
         src/Vehicle/SendMavCommandTest.cc \
 } } } } } }
 
@@ -484,6 +499,7 @@ DebugBuild { PX4FirmwarePlugin { PX4FirmwarePluginFactory  { APMFirmwarePlugin {
 HEADERS += \
     src/AnalyzeView/ExifParser.h \
     src/AnalyzeView/ULogParser.h \
+    src/AnalyzeView/ULogReader.h \
     src/AnalyzeView/PX4LogParser.h \
     src/CmdLineOptParser.h \
     src/FirmwarePlugin/PX4/px4_custom_mode.h \
@@ -494,12 +510,15 @@ HEADERS += \
     src/Joystick/Joystick.h \
     src/Joystick/JoystickManager.h \
     src/JsonHelper.h \
+    src/JsonStreamReader.h \
+    src/JsonStreamWriter.h \
     src/LogCompressor.h \
     src/MG.h \
     src/MissionManager/CameraSection.h \
     src/MissionManager/ComplexMissionItem.h \
     src/MissionManager/FixedWingLandingComplexItem.h \
     src/MissionManager/GeoFenceController.h \
+    src/MissionManager/GeoFenceIndex.h \
     src/MissionManager/GeoFenceManager.h \
     src/MissionManager/MissionCommandList.h \
     src/MissionManager/MissionCommandTree.h \
@@ -517,7 +536,9 @@ HEADERS += \
     src/MissionManager/SimpleMissionItem.h \
     src/MissionManager/Section.h \
     src/MissionManager/SpeedSection.h \
+    src/MissionManager/SurveyGridGenerator.h \
     src/MissionManager/SurveyMissionItem.h \
+    src/MissionManager/SurveyRouteOptimizer.h \
     src/MissionManager/VisualMissionItem.h \
     src/PositionManager/PositionManager.h \
     src/PositionManager/SimulatedPosition.h \
@@ -556,6 +577,9 @@ HEADERS += \
     src/Settings/SettingsManager.h \
     src/Settings/UnitsSettings.h \
     src/Settings/VideoSettings.h \
+    src/Terrain/TerrainClearance.h \
+    src/Terrain/TerrainTile.h \
+    src/Terrain/TerrainTileManager.h \
     src/Vehicle/MAVLinkLogManager.h \
     src/VehicleSetup/JoystickConfigController.h \
     src/audio/QGCAudioWorker.h \
@@ -665,6 +689,7 @@ AndroidBuild {
 SOURCES += \
     src/AnalyzeView/ExifParser.cc \
     src/AnalyzeView/ULogParser.cc \
+    src/AnalyzeView/ULogReader.cc \
     src/AnalyzeView/PX4LogParser.cc \
     src/CmdLineOptParser.cc \
     src/FlightDisplay/VideoManager.cc \
@@ -674,11 +699,14 @@ SOURCES += \
     src/Joystick/Joystick.cc \
     src/Joystick/JoystickManager.cc \
     src/JsonHelper.cc \
+    src/JsonStreamReader.cc \
+    src/JsonStreamWriter.cc \
     src/LogCompressor.cc \
     src/MissionManager/CameraSection.cc \
     src/MissionManager/ComplexMissionItem.cc \
     src/MissionManager/FixedWingLandingComplexItem.cc \
     src/MissionManager/GeoFenceController.cc \
+    src/MissionManager/GeoFenceIndex.cc \
     src/MissionManager/GeoFenceManager.cc \
     src/MissionManager/MissionCommandList.cc \
     src/MissionManager/MissionCommandTree.cc \
@@ -695,7 +723,9 @@ SOURCES += \
     src/MissionManager/RallyPointManager.cc \
     src/MissionManager/SimpleMissionItem.cc \
     src/MissionManager/SpeedSection.cc \
+    src/MissionManager/SurveyGridGenerator.cc \
     src/MissionManager/SurveyMissionItem.cc \
+    src/MissionManager/SurveyRouteOptimizer.cc \
     src/MissionManager/VisualMissionItem.cc \
     src/PositionManager/PositionManager.cpp \
     src/PositionManager/SimulatedPosition.cc \
@@ -732,6 +762,9 @@ SOURCES += \
     src/Settings/SettingsManager.cc \
     src/Settings/UnitsSettings.cc \
     src/Settings/VideoSettings.cc \
+    src/Terrain/TerrainClearance.cc \
+    src/Terrain/TerrainTile.cc \
+    src/Terrain/TerrainTileManager.cc \
     src/Vehicle/MAVLinkLogManager.cc \
     src/VehicleSetup/JoystickConfigController.cc \
     src/audio/QGCAudioWorker.cpp \
@@ -1009,23 +1042,31 @@ INCLUDEPATH += \
     src/FactSystem/FactControls \
 
 HEADERS += \
+    src/FactSystem/CompiledParameterMetaData.h \
     src/FactSystem/Fact.h \
     src/FactSystem/FactControls/FactPanelController.h \
     src/FactSystem/FactGroup.h \
     src/FactSystem/FactMetaData.h \
     src/FactSystem/FactSystem.h \
     src/FactSystem/FactValidator.h \
+    src/FactSystem/ParameterDownloadCoordinator.h \
     src/FactSystem/ParameterManager.h \
+    src/FactSystem/ParameterSearchIndex.h \
+    src/FactSystem/ParameterStore.h \
     src/FactSystem/SettingsFact.h \
 
 SOURCES += \
+    src/FactSystem/CompiledParameterMetaData.cc \
     src/FactSystem/Fact.cc \
     src/FactSystem/FactControls/FactPanelController.cc \
     src/FactSystem/FactGroup.cc \
     src/FactSystem/FactMetaData.cc \
     src/FactSystem/FactSystem.cc \
     src/FactSystem/FactValidator.cc \
+    src/FactSystem/ParameterDownloadCoordinator.cc \
     src/FactSystem/ParameterManager.cc \
+    src/FactSystem/ParameterSearchIndex.cc \
+    src/FactSystem/ParameterStore.cc \
     src/FactSystem/SettingsFact.cc \
 
 #-------------------------------------------------------------------------------------
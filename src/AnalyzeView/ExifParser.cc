@@ -19,10 +19,17 @@ double ExifParser::readTime(QByteArray& buf)
     QByteArray createDateHeader("\x04\x90\x02", 3);
 
     // find header position
-    uint32_t tiffHeaderIndex = buf.indexOf(tiffHeader);
+    int tiffHeaderPosition = buf.indexOf(tiffHeader);
 
     // find creation date header index
-    uint32_t createDateHeaderIndex = buf.indexOf(createDateHeader);
+    int createDateHeaderPosition = buf.indexOf(createDateHeader);
+
+    if (tiffHeaderPosition < 0 || createDateHeaderPosition < 0 || createDateHeaderPosition + 12 > buf.size()) {
+        qWarning() << "Could not find creation time and date";
+        return -1.0;
+    }
+    uint32_t tiffHeaderIndex = tiffHeaderPosition;
+    uint32_t createDateHeaderIndex = createDateHeaderPosition;
 
     // extract size of date-time string, -1 accounting for null-termination
     uint32_t* sizeString = reinterpret_cast<uint32_t*>(buf.mid(createDateHeaderIndex + 4, 4).data());
@@ -56,6 +63,45 @@ double ExifParser::readTime(QByteArray& buf)
     return tagTime.toMSecsSinceEpoch()/1000.0;
 }
 
+QByteArray ExifParser::readHeader(QIODevice& device)
+{
+    QByteArray header = device.read(2);
+
+    // Start of image marker
+    if (header.size() != 2 || (uchar)header[0] != 0xff || (uchar)header[1] != 0xd8) {
+        return QByteArray();
+    }
+
+    // Walk the segments in front of the image data until the APP1 segment is found. Each segment is a two byte marker
+    // followed by a two byte big endian length which includes the length bytes themselves.
+    while (true) {
+        QByteArray segmentHeader = device.read(4);
+        if (segmentHeader.size() != 4 || (uchar)segmentHeader[0] != 0xff) {
+            return QByteArray();
+        }
+
+        uchar   marker = segmentHeader[1];
+        int     segmentLength = qFromBigEndian<quint16>(reinterpret_cast<const uchar*>(segmentHeader.constData() + 2));
+
+        // Only application and comment segments can come before the EXIF data
+        if (!((marker >= 0xe0 && marker <= 0xef) || marker == 0xfe) || segmentLength < 2) {
+            return QByteArray();
+        }
+
+        QByteArray segmentData = device.read(segmentLength - 2);
+        if (segmentData.size() != segmentLength - 2) {
+            return QByteArray();
+        }
+
+        header += segmentHeader;
+        header += segmentData;
+
+        if (marker == 0xe1) {
+            return header;
+        }
+    }
+}
+
 bool ExifParser::write(QByteArray& buf, GeoTagWorker::cameraFeedbackPacket& geotag)
 {
     QByteArray app1Header("\xff\xe1", 2);
@@ -3,6 +3,7 @@
 
 #include <QGeoCoordinate>
 #include <QDebug>
+#include <QIODevice>
 
 #include "GeoTagController.h"
 
@@ -13,6 +14,12 @@ public:
     ~ExifParser();
     double readTime(QByteArray& buf);
     bool write(QByteArray& buf, GeoTagWorker::cameraFeedbackPacket& geotag);
+
+    /// Reads the start of a JPEG file up to and including the APP1 segment which holds the EXIF data. This is all
+    /// readTime and write need, so the image data itself does not have to be loaded. write only changes bytes within
+    /// the returned header, the rest of the file can be copied unchanged.
+    ///     @return Header bytes, empty if the file is not a JPEG with an APP1 segment
+    static QByteArray readHeader(QIODevice& device);
 };
 
 #endif // EXIFPARSER_H
@@ -15,6 +15,8 @@
 #include <QtEndian>
 #include <QMessageBox>
 #include <QDebug>
+#include <QHash>
+#include <QtConcurrent>
 #include <cfloat>
 
 #include "ExifParser.h"
@@ -23,10 +25,12 @@
 
 GeoTagController::GeoTagController(void)
     : _progress(0)
+    , _imagesPerSecond(0)
     , _inProgress(false)
 {
     connect(&_worker, &GeoTagWorker::progressChanged,   this, &GeoTagController::_workerProgressChanged);
     connect(&_worker, &GeoTagWorker::error,             this, &GeoTagController::_workerError);
+    connect(&_worker, &GeoTagWorker::imagesPerSecondChanged, this, &GeoTagController::_workerImagesPerSecondChanged);
     connect(&_worker, &GeoTagWorker::started,           this, &GeoTagController::inProgressChanged);
     connect(&_worker, &GeoTagWorker::finished,          this, &GeoTagController::inProgressChanged);
 }
@@ -67,6 +71,8 @@ void GeoTagController::startTagging(void)
 {
     _errorMessage.clear();
     emit errorMessageChanged(_errorMessage);
+    _imagesPerSecond = 0;
+    emit imagesPerSecondChanged(_imagesPerSecond);
 
     QDir imageDirectory = QDir(_worker.imageDirectory());
     if(!imageDirectory.exists()) {
@@ -144,6 +150,12 @@ void GeoTagController::_workerError(QString errorMessage)
     emit errorMessageChanged(errorMessage);
 }
 
+void GeoTagController::_workerImagesPerSecondChanged(double imagesPerSecond)
+{
+    _imagesPerSecond = imagesPerSecond;
+    emit imagesPerSecondChanged(imagesPerSecond);
+}
+
 GeoTagWorker::GeoTagWorker(void)
     : _cancel(false)
     , _logFile("")
@@ -175,36 +187,32 @@ void GeoTagWorker::run(void)
     emit progressChanged((100/nSteps));
 
     // Parse EXIF
-    ExifParser exifParser;
-    _imageTime.clear();
+    QVector<ImageJob_t> timeJobs(_imageList.count());
     for (int i = 0; i < _imageList.size(); ++i) {
-        QFile file(_imageList.at(i).absoluteFilePath());
-        if (!file.open(QIODevice::ReadOnly)) {
-            emit error(tr("Geotagging failed. Couldn't open an image."));
-            return;
-        }
-        QByteArray imageBuffer = file.readAll();
-        file.close();
-
-        _imageTime.append(exifParser.readTime(imageBuffer));
-
-        emit progressChanged((100/nSteps) + ((100/nSteps) / _imageList.size())*i);
-
-        if (_cancel) {
-            qCDebug(GeotaggingLog) << "Tagging cancelled";
-            emit error(tr("Tagging cancelled"));
+        timeJobs[i].imagePath = _imageList.at(i).absoluteFilePath();
+        timeJobs[i].time = -1.0;
+    }
+    if (!_runImageJobs(timeJobs, _readImageTime, 100/nSteps, 100/nSteps)) {
+        qCDebug(GeotaggingLog) << "Tagging cancelled";
+        emit error(tr("Tagging cancelled"));
+        return;
+    }
+    _imageTime.clear();
+    for (int i = 0; i < timeJobs.count(); ++i) {
+        if (!timeJobs[i].errorMsg.isEmpty()) {
+            emit error(timeJobs[i].errorMsg);
             return;
         }
+        _imageTime.append(timeJobs[i].time);
     }
 
-    // Load log
+    // Check log, the parsers memory map it rather than loading it
     bool isULog = _logFile.endsWith(".ulg", Qt::CaseSensitive);
     QFile file(_logFile);
     if (!file.open(QIODevice::ReadOnly)) {
         emit error(tr("Geotagging failed. Couldn't open log file."));
         return;
     }
-    QByteArray log = file.readAll();
     file.close();
 
     // Instantiate appropriate parser
@@ -212,11 +220,11 @@ void GeoTagWorker::run(void)
     bool parseComplete = false;
     if(isULog) {
         ULogParser parser;
-        parseComplete = parser.getTagsFromLog(log, _triggerList);
+        parseComplete = parser.getTagsFromLog(_logFile, _triggerList);
 
     } else {
         PX4LogParser parser;
-        parseComplete = parser.getTagsFromLog(log, _triggerList);
+        parseComplete = parser.getTagsFromLog(_logFile, _triggerList);
 
     }
 
@@ -255,40 +263,43 @@ void GeoTagWorker::run(void)
         return;
     }
 
-    // Tag images
+    // Tag images. When several triggers map to the same image the last one wins, as each image is only written once.
     int maxIndex = std::min(_imageIndices.count(), _triggerIndices.count());
     maxIndex = std::min(maxIndex, _imageList.count());
+    QVector<ImageJob_t> tagJobs;
+    QHash<int, int>     imageJobIndex;
     for(int i = 0; i < maxIndex; i++) {
-        QFile fileRead(_imageList.at(_imageIndices[i]).absoluteFilePath());
-        if (!fileRead.open(QIODevice::ReadOnly)) {
-            emit error(tr("Geotagging failed. Couldn't open an image."));
-            return;
+        int imageIndex = _imageIndices[i];
+        if (imageIndex < 0 || imageIndex >= _imageList.count()) {
+            qCDebug(GeotaggingLog) << "Skipping trigger for missing image" << imageIndex;
+            continue;
         }
-        QByteArray imageBuffer = fileRead.readAll();
-        fileRead.close();
 
-        if (!exifParser.write(imageBuffer, _triggerList[_triggerIndices[i]])) {
-            emit error(tr("Geotagging failed. Couldn't write to image."));
-            return;
+        ImageJob_t job;
+        job.imagePath = _imageList.at(imageIndex).absoluteFilePath();
+        if(_saveDirectory == "") {
+            job.taggedPath = _imageDirectory + "/TAGGED/" + _imageList.at(imageIndex).fileName();
         } else {
-            QFile fileWrite;
-            if(_saveDirectory == "") {
-                fileWrite.setFileName(_imageDirectory + "/TAGGED/" + _imageList.at(_imageIndices[i]).fileName());
-            } else {
-                fileWrite.setFileName(_saveDirectory + "/" + _imageList.at(_imageIndices[i]).fileName());
-            }
-            if (!fileWrite.open(QFile::WriteOnly)) {
-                emit error(tr("Geotagging failed. Couldn't write to an image."));
-                return;
-            }
-            fileWrite.write(imageBuffer);
-            fileWrite.close();
+            job.taggedPath = _saveDirectory + "/" + _imageList.at(imageIndex).fileName();
         }
-        emit progressChanged(4*(100/nSteps) + ((100/nSteps) / maxIndex)*i);
+        job.feedback = _triggerList[_triggerIndices[i]];
+        job.time = -1.0;
 
-        if (_cancel) {
-            qCDebug(GeotaggingLog) << "Tagging cancelled";
-            emit error(tr("Tagging cancelled"));
+        if (imageJobIndex.contains(imageIndex)) {
+            tagJobs[imageJobIndex[imageIndex]] = job;
+        } else {
+            imageJobIndex[imageIndex] = tagJobs.count();
+            tagJobs.append(job);
+        }
+    }
+    if (!_runImageJobs(tagJobs, _tagImage, 4*(100/nSteps), 100/nSteps)) {
+        qCDebug(GeotaggingLog) << "Tagging cancelled";
+        emit error(tr("Tagging cancelled"));
+        return;
+    }
+    for (int i = 0; i < tagJobs.count(); i++) {
+        if (!tagJobs[i].errorMsg.isEmpty()) {
+            emit error(tagJobs[i].errorMsg);
             return;
         }
     }
@@ -302,6 +313,89 @@ void GeoTagWorker::run(void)
     emit progressChanged(100);
 }
 
+/// Runs the job function for all jobs on the global thread pool and reports progress and rate while waiting for them
+///     @return false: Tagging was cancelled
+bool GeoTagWorker::_runImageJobs(QVector<ImageJob_t>& jobs, ImageJobFunction_t jobFunction, double progressStart, double progressRange)
+{
+    if (jobs.isEmpty()) {
+        return !_cancel;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    _completedJobs.store(0);
+    QFuture<void> future = QtConcurrent::map(jobs, [this, jobFunction](ImageJob_t& job) {
+        jobFunction(job);
+        _completedJobs.ref();
+    });
+
+    while (!future.isFinished()) {
+        if (_cancel) {
+            future.cancel();
+            future.waitForFinished();
+            return false;
+        }
+        QThread::msleep(100);
+
+        int completed = _completedJobs.load();
+        emit progressChanged(progressStart + ((progressRange * completed) / jobs.count()));
+        if (timer.elapsed() > 0) {
+            emit imagesPerSecondChanged((completed * 1000.0) / timer.elapsed());
+        }
+    }
+
+    double imagesPerSecond = (jobs.count() * 1000.0) / qMax(timer.elapsed(), (qint64)1);
+    qCDebug(GeotaggingLog) << "Processed" << jobs.count() << "images in" << timer.elapsed() << "msecs," << imagesPerSecond << "images per second";
+    emit imagesPerSecondChanged(imagesPerSecond);
+
+    return !_cancel;
+}
+
+void GeoTagWorker::_readImageTime(ImageJob_t& job)
+{
+    QFile file(job.imagePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        job.errorMsg = tr("Geotagging failed. Couldn't open an image.");
+        return;
+    }
+
+    QByteArray header = ExifParser::readHeader(file);
+    ExifParser exifParser;
+    job.time = exifParser.readTime(header);
+}
+
+/// Writes a tagged copy of the image. Only the EXIF header is patched in memory, the image data which follows it is
+/// copied over unchanged.
+void GeoTagWorker::_tagImage(ImageJob_t& job)
+{
+    QFile fileRead(job.imagePath);
+    if (!fileRead.open(QIODevice::ReadOnly)) {
+        job.errorMsg = tr("Geotagging failed. Couldn't open an image.");
+        return;
+    }
+
+    QByteArray header = ExifParser::readHeader(fileRead);
+    ExifParser exifParser;
+    if (header.isEmpty() || !exifParser.write(header, job.feedback)) {
+        job.errorMsg = tr("Geotagging failed. Couldn't write to image.");
+        return;
+    }
+
+    QFile fileWrite(job.taggedPath);
+    if (!fileWrite.open(QFile::WriteOnly) || fileWrite.write(header) != header.size()) {
+        job.errorMsg = tr("Geotagging failed. Couldn't write to an image.");
+        return;
+    }
+    while (!fileRead.atEnd()) {
+        QByteArray chunk = fileRead.read(_copyChunkSize);
+        if (chunk.isEmpty() || fileWrite.write(chunk) != chunk.size()) {
+            job.errorMsg = tr("Geotagging failed. Couldn't write to an image.");
+            return;
+        }
+    }
+}
+
 bool GeoTagWorker::triggerFiltering()
 {
     _imageIndices.clear();
@@ -20,11 +20,19 @@
 #include <QElapsedTimer>
 #include <QDebug>
 #include <QGeoCoordinate>
+#include <QVector>
+#include <QAtomicInt>
 
+/// Tags the images in parallel on the global thread pool. Only the EXIF header of each image is held in memory, the
+/// image data is copied from the original to the tagged file in chunks.
 class GeoTagWorker : public QThread
 {
     Q_OBJECT
 
+#ifdef UNITTEST_BUILD
+    friend class GeoTagTest;
+#endif
+
 public:
     GeoTagWorker(void);
 
@@ -54,12 +62,30 @@ protected:
     void run(void) final;
 
 signals:
-    void error              (QString errorMsg);
-    void taggingComplete    (void);
-    void progressChanged    (double progress);
+    void error                  (QString errorMsg);
+    void taggingComplete        (void);
+    void progressChanged        (double progress);
+    void imagesPerSecondChanged (double imagesPerSecond);
 
 private:
+    /// Work for a single image, processed on the thread pool
+    typedef struct {
+        QString                 imagePath;
+        QString                 taggedPath;     ///< Where the tagged copy is written
+        cameraFeedbackPacket    feedback;       ///< Tag to write to the image
+        double                  time;           ///< Creation time from the EXIF data
+        QString                 errorMsg;       ///< Empty if the job succeeded
+    } ImageJob_t;
+
+    typedef void (*ImageJobFunction_t)(ImageJob_t& job);
+
     bool triggerFiltering();
+    bool _runImageJobs(QVector<ImageJob_t>& jobs, ImageJobFunction_t jobFunction, double progressStart, double progressRange);
+
+    static void _readImageTime  (ImageJob_t& job);
+    static void _tagImage       (ImageJob_t& job);
+
+    static const qint64 _copyChunkSize = 1024 * 1024;   ///< Image data is copied to the tagged file in chunks of this size
 
     bool                    _cancel;
     QString                 _logFile;
@@ -70,6 +96,7 @@ private:
     QList<cameraFeedbackPacket> _triggerList;
     QList<int>              _imageIndices;
     QList<int>              _triggerIndices;
+    QAtomicInt              _completedJobs;
 
 };
 
@@ -95,6 +122,9 @@ public:
     /// true: Currently in the process of tagging
     Q_PROPERTY(bool     inProgress      READ inProgress     NOTIFY inProgressChanged)
 
+    /// Rate at which images are tagged, 0 when not tagging
+    Q_PROPERTY(double   imagesPerSecond READ imagesPerSecond NOTIFY imagesPerSecondChanged)
+
     Q_INVOKABLE void pickLogFile(void);
     Q_INVOKABLE void pickImageDirectory(void);
     Q_INVOKABLE void pickSaveDirectory(void);
@@ -107,6 +137,7 @@ public:
     double  progress            (void) const { return _progress; }
     bool    inProgress          (void) const { return _worker.isRunning(); }
     QString errorMessage        (void) const { return _errorMessage; }
+    double  imagesPerSecond     (void) const { return _imagesPerSecond; }
 
 signals:
     void logFileChanged                 (QString logFile);
@@ -115,14 +146,17 @@ signals:
     void progressChanged                (double progress);
     void inProgressChanged              (void);
     void errorMessageChanged            (QString errorMessage);
+    void imagesPerSecondChanged         (double imagesPerSecond);
 
 private slots:
     void _workerProgressChanged(double progress);
     void _workerError(QString errorMsg);
+    void _workerImagesPerSecondChanged(double imagesPerSecond);
 
 private:
     QString             _errorMessage;
     double              _progress;
+    double              _imagesPerSecond;
     bool                _inProgress;
 
     GeoTagWorker        _worker;
@@ -52,6 +52,11 @@ AnalyzePage {
                 }
             }
 
+            QGCLabel {
+                text:           qsTr("%1 images per second").arg(geoController.imagesPerSecond.toFixed(1))
+                visible:        geoController.imagesPerSecond > 0
+            }
+
             QGCLabel {
                 text:           geoController.errorMessage
                 font.bold:      true
@@ -0,0 +1,200 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "GeoTagTest.h"
+#include "GeoTagController.h"
+#include "ExifParser.h"
+
+#include <QBuffer>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtEndian>
+
+#include <cstring>
+
+GeoTagTest::GeoTagTest(void)
+{
+
+}
+
+/// @return Minimal JPEG with a JFIF APP0 segment and an EXIF APP1 segment holding an image description and the creation
+/// date, followed by the specified amount of image data.
+QByteArray GeoTagTest::_jpegBytes(const QString& createDate, int imageDataSize)
+{
+    QByteArray  dateString = createDate.toLatin1() + QByteArray(1, 0);
+    QByteArray  descriptionString = QByteArray(12, ' ') + QByteArray(1, 0);
+    uchar       value[4];
+
+    // TIFF header followed by IFD0 with two entries, its data and an empty IFD1
+    const int   ifd0Offset = 8;
+    const int   ifd0Size = 2 + (2 * 12) + 4;
+    const int   dateOffset = ifd0Offset + ifd0Size;
+    const int   descriptionOffset = dateOffset + dateString.size();
+    const int   ifd1Offset = descriptionOffset + descriptionString.size();
+
+    QByteArray tiff("\x49\x49\x2a\x00", 4);
+    qToLittleEndian<quint32>(ifd0Offset, value);
+    tiff.append((const char*)value, 4);
+
+    qToLittleEndian<quint16>(2, value);
+    tiff.append((const char*)value, 2);
+
+    tiff.append("\x0e\x01\x02\x00", 4);
+    qToLittleEndian<quint32>(descriptionString.size(), value);
+    tiff.append((const char*)value, 4);
+    qToLittleEndian<quint32>(descriptionOffset, value);
+    tiff.append((const char*)value, 4);
+
+    tiff.append("\x04\x90\x02\x00", 4);
+    qToLittleEndian<quint32>(dateString.size(), value);
+    tiff.append((const char*)value, 4);
+    qToLittleEndian<quint32>(dateOffset, value);
+    tiff.append((const char*)value, 4);
+
+    qToLittleEndian<quint32>(ifd1Offset, value);
+    tiff.append((const char*)value, 4);
+
+    tiff.append(dateString);
+    tiff.append(descriptionString);
+    tiff.append(QByteArray(6, 0));
+
+    QByteArray app1Data = QByteArray("Exif\0\0", 6) + tiff;
+    QByteArray jpeg("\xff\xd8", 2);
+
+    jpeg.append("\xff\xe0\x00\x10" "JFIF\0\x01\x01\x00\x00\x01\x00\x01\x00\x00", 18);
+
+    jpeg.append("\xff\xe1", 2);
+    qToBigEndian<quint16>(app1Data.size() + 2, value);
+    jpeg.append((const char*)value, 2);
+    jpeg.append(app1Data);
+
+    // Quantization table marker followed by a recognizable pattern standing in for the image data
+    jpeg.append("\xff\xdb", 2);
+    for (int i=0; i<imageDataSize; i++) {
+        jpeg.append((char)(i % 251));
+    }
+    jpeg.append("\xff\xd9", 2);
+
+    return jpeg;
+}
+
+bool GeoTagTest::_writeFile(const QString& fileName, const QByteArray& bytes)
+{
+    QFile file(fileName);
+    return file.open(QIODevice::WriteOnly) && file.write(bytes) == bytes.size();
+}
+
+void GeoTagTest::_readHeaderTest(void)
+{
+    QByteArray  jpeg = _jpegBytes(QStringLiteral("2017:06:01 12:30:45"), 100000);
+    QBuffer     buffer(&jpeg);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+
+    // Header ends with the APP1 segment, the image data is not read
+    QByteArray header = ExifParser::readHeader(buffer);
+    QVERIFY(!header.isEmpty());
+    QVERIFY(header.size() < 200);
+    QVERIFY(jpeg.startsWith(header));
+    QVERIFY(jpeg.mid(header.size()).startsWith(QByteArray("\xff\xdb", 2)));
+    QCOMPARE(buffer.pos(), (qint64)header.size());
+
+    // Creation time from the header is the same as from the full image
+    ExifParser  exifParser;
+    double      expectedTime = QDateTime(QDate(2017, 6, 1), QTime(12, 30, 45)).toMSecsSinceEpoch() / 1000.0;
+    QCOMPARE(exifParser.readTime(header), expectedTime);
+    QCOMPARE(exifParser.readTime(jpeg), expectedTime);
+
+    // Files without EXIF data
+    QByteArray notJpeg("not a jpeg file");
+    QBuffer notJpegBuffer(&notJpeg);
+    QVERIFY(notJpegBuffer.open(QIODevice::ReadOnly));
+    QVERIFY(ExifParser::readHeader(notJpegBuffer).isEmpty());
+
+    QByteArray noApp1("\xff\xd8\xff\xdb\x00\x04\x00\x00\xff\xd9", 10);
+    QBuffer noApp1Buffer(&noApp1);
+    QVERIFY(noApp1Buffer.open(QIODevice::ReadOnly));
+    QVERIFY(ExifParser::readHeader(noApp1Buffer).isEmpty());
+
+    QByteArray truncated = jpeg.left(30);
+    QBuffer truncatedBuffer(&truncated);
+    QVERIFY(truncatedBuffer.open(QIODevice::ReadOnly));
+    QVERIFY(ExifParser::readHeader(truncatedBuffer).isEmpty());
+
+    QByteArray empty;
+    QCOMPARE(exifParser.readTime(empty), -1.0);
+}
+
+void GeoTagTest::_tagImageTest(void)
+{
+    QTemporaryDir imageDir;
+    QVERIFY(imageDir.isValid());
+    QVERIFY(QDir(imageDir.path()).mkdir(QStringLiteral("TAGGED")));
+
+    // Image data larger than the copy chunk size, so it is copied in several pieces
+    QByteArray jpeg = _jpegBytes(QStringLiteral("2017:06:01 12:30:45"), (GeoTagWorker::_copyChunkSize * 2) + 1000);
+
+    GeoTagWorker                        worker;
+    QVector<GeoTagWorker::ImageJob_t>   jobs;
+    const int                           imageCount = 20;
+
+    for (int i=0; i<imageCount; i++) {
+        GeoTagWorker::ImageJob_t job;
+
+        job.imagePath = QDir(imageDir.path()).filePath(QStringLiteral("image%1.jpg").arg(i));
+        job.taggedPath = QDir(imageDir.path()).filePath(QStringLiteral("TAGGED/image%1.jpg").arg(i));
+        job.time = -1.0;
+        memset(&job.feedback, 0, sizeof(job.feedback));
+        job.feedback.latitude = 47.3764 + (i * 0.001);
+        job.feedback.longitude = -8.5481;
+        job.feedback.altitude = 400 + i;
+        job.feedback.imageSequence = i;
+        QVERIFY(_writeFile(job.imagePath, jpeg));
+
+        jobs.append(job);
+    }
+
+    QVERIFY(worker._runImageJobs(jobs, GeoTagWorker::_tagImage, 0, 100));
+
+    // Tagged copies are the same as tagging the full image in memory
+    for (int i=0; i<imageCount; i++) {
+        QCOMPARE(jobs[i].errorMsg, QString());
+
+        QFile taggedFile(jobs[i].taggedPath);
+        QVERIFY(taggedFile.open(QIODevice::ReadOnly));
+        QByteArray tagged = taggedFile.readAll();
+
+        QByteArray expected = jpeg;
+        ExifParser exifParser;
+        QVERIFY(exifParser.write(expected, jobs[i].feedback));
+        QCOMPARE(tagged.size(), expected.size());
+        QVERIFY(tagged == expected);
+    }
+
+    // Creation time is read from each image
+    QVector<GeoTagWorker::ImageJob_t> timeJobs = jobs;
+    QVERIFY(worker._runImageJobs(timeJobs, GeoTagWorker::_readImageTime, 0, 100));
+    for (int i=0; i<imageCount; i++) {
+        QCOMPARE(timeJobs[i].errorMsg, QString());
+        QCOMPARE(timeJobs[i].time, QDateTime(QDate(2017, 6, 1), QTime(12, 30, 45)).toMSecsSinceEpoch() / 1000.0);
+    }
+
+    // Images which can't be read or have no EXIF data fail with an error
+    GeoTagWorker::ImageJob_t missingJob = jobs[0];
+    missingJob.imagePath = QDir(imageDir.path()).filePath(QStringLiteral("missing.jpg"));
+    GeoTagWorker::_tagImage(missingJob);
+    QVERIFY(!missingJob.errorMsg.isEmpty());
+
+    GeoTagWorker::ImageJob_t notJpegJob = jobs[0];
+    notJpegJob.imagePath = QDir(imageDir.path()).filePath(QStringLiteral("notjpeg.jpg"));
+    QVERIFY(_writeFile(notJpegJob.imagePath, QByteArray("not a jpeg file")));
+    GeoTagWorker::_tagImage(notJpegJob);
+    QVERIFY(!notJpegJob.errorMsg.isEmpty());
+}
@@ -0,0 +1,35 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#ifndef GeoTagTest_H
+#define GeoTagTest_H
+
+#include "UnitTest.h"
+
+#include <QByteArray>
+#include <QString>
+
+/// Unit test for the EXIF header handling in ExifParser and the image jobs of GeoTagWorker
+class GeoTagTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    GeoTagTest(void);
+
+private slots:
+    void _readHeaderTest(void);
+    void _tagImageTest(void);
+
+private:
+    QByteArray _jpegBytes(const QString& createDate, int imageDataSize);
+    bool _writeFile(const QString& fileName, const QByteArray& bytes);
+};
+
+#endif
@@ -26,65 +26,233 @@
 #include <QSettings>
 #include <QUrl>
 #include <QBitArray>
+#include <QDataStream>
+#include <QFileInfo>
 #include <QtCore/qmath.h>
 
 #define kTimeOutMilliseconds 500
 #define kGUIRateMilliseconds 17
 #define kTableBins           512
 #define kChunkSize           (kTableBins * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN)
+#define kWindowChunks        8                                  // Chunks requested ahead of the data received
+#define kWindowSize          (kWindowChunks * kChunkSize)
+#define kGapMergeBins        8                                  // Missing bins closer than this are requested together
+#define kWriteBufferSize     (64 * 1024)
+#define kMaxRetries          5
+#define kQueueSliceSize      (4 * kWindowSize)                  // Data downloaded before a smaller queued log gets a turn
+#define kProgressSaveMilliseconds 2000
+#define kPartialSuffix       ".partial"
+#define kProgressSuffix      ".progress"
+#define kProgressVersion     2
+#define kProgressHeaderSize  (2 * sizeof(quint32))
 
 QGC_LOGGING_CATEGORY(LogDownloadLog, "LogDownloadLog")
 
+const char* LogDownloadController::_queueSettingsGroup = "LogDownloadQueue";
+
 //-----------------------------------------------------------------------------
 struct LogDownloadData {
     LogDownloadData(QGCLogEntry* entry);
-    QBitArray     chunk_table;
-    uint32_t      current_chunk;
-    QFile         file;
+    QBitArray     bin_table;        // Received MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN bins of the whole log
+    uint32_t      bins_received;
+    uint32_t      gap_bin;          // All bins before this one have been received
+    uint32_t      stream_offset;    // End of the furthest data received
+    uint32_t      request_offset;
+    uint32_t      request_end;
+    bool          streaming;        // Current request continues the stream rather than filling a gap
+    QByteArray    write_buffer;
+    uint32_t      write_offset;     // Log offset of the start of write_buffer
+    QFile         file;             // Partial log, renamed to path once complete
+    QFile         progress_file;
+    QString       path;             // Log file once the download is complete
     QString       filename;
+    uint32_t      dirty_first;      // Bins received since the progress was last saved
+    uint32_t      dirty_end;
     uint          ID;
     QGCLogEntry*  entry;
     uint          written;
+    uint          slice_start;      // Value of written when the log got its turn in the queue
     size_t        rate_bytes;
     qreal         rate_avg;
     QElapsedTimer elapsed;
+    QElapsedTimer progress_saved;
+
+    // The number of MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN bins in the file
+    uint32_t numBins() const
+    {
+        return qCeil(entry->size() / static_cast<qreal>(MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN));
+    }
+
+    bool complete() const
+    {
+        return bins_received == static_cast<uint32_t>(bin_table.size());
+    }
+
+    void setReceived(uint32_t bin)
+    {
+        bin_table.setBit(bin);
+        bins_received++;
+        dirty_first = qMin(dirty_first, bin);
+        dirty_end = qMax(dirty_end, bin + 1);
+    }
+
+    // Adds data to the write buffer. The buffer is written to the file when it is full or the data does not follow it.
+    bool write(uint32_t ofs, const uint8_t* data, uint8_t count)
+    {
+        if (!write_buffer.isEmpty() && ofs != write_offset + write_buffer.size()) {
+            if (!flush()) {
+                return false;
+            }
+        }
+        if (write_buffer.isEmpty()) {
+            write_offset = ofs;
+        }
+        write_buffer.append((const char*)data, count);
+        return write_buffer.size() < kWriteBufferSize || flush();
+    }
+
+    bool flush()
+    {
+        if (write_buffer.isEmpty()) {
+            return true;
+        }
+        bool result = file.seek(write_offset) && file.write(write_buffer) == write_buffer.size();
+        // Keeps the allocation for the next data
+        write_buffer.resize(0);
+        return result;
+    }
+
+    // The log is downloaded to a partial file beside the log file, so an unfinished download is never mistaken for a log
+    static QString partialFileName(const QString& path)
+    {
+        return path + kPartialSuffix;
+    }
+
+    // The received bins are saved beside the log file, so an interrupted download can be resumed
+    static QString progressFileName(const QString& path)
+    {
+        return path + kProgressSuffix;
+    }
 
-    void advanceChunk()
+    // The progress file holds one bit for each bin, after a header with the version and the log size
+    int progressBytes() const
     {
-           current_chunk++;
-           chunk_table = QBitArray(chunkBins(), false);
+        return (numBins() + 7) / 8;
     }
 
-    // The number of MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN bins in the current chunk
-    uint32_t chunkBins() const
+    bool createProgress()
     {
-        return qMin(qCeil((entry->size() - current_chunk*kChunkSize)/static_cast<qreal>(MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN)),
-                    kTableBins);
+        progress_file.setFileName(progressFileName(path));
+        if (!progress_file.open(QIODevice::ReadWrite | QIODevice::Truncate)) {
+            return false;
+        }
+        QDataStream stream(&progress_file);
+        stream << (quint32)kProgressVersion << (quint32)entry->size();
+        return stream.status() == QDataStream::Ok &&
+                progress_file.write(QByteArray(progressBytes(), 0)) == progressBytes() &&
+                progress_file.flush();
+    }
+
+    // Only the part of the table which changed since the last save is written. Bins are only saved as received
+    // once their data is in the file.
+    bool saveProgress()
+    {
+        if (dirty_first >= dirty_end) {
+            return true;
+        }
+        if (!flush() || !file.flush()) {
+            return false;
+        }
+        const uint32_t firstByte = dirty_first / 8;
+        const uint32_t endByte = (dirty_end + 7) / 8;
+        const uint32_t endBin = qMin(endByte * 8, numBins());
+        QByteArray bytes(endByte - firstByte, 0);
+        char* data = bytes.data();
+        for (uint32_t bin = firstByte * 8; bin < endBin; bin++) {
+            if (bin_table.testBit(bin)) {
+                data[bin / 8 - firstByte] |= (1 << (bin % 8));
+            }
+        }
+        if (!progress_file.seek(kProgressHeaderSize + firstByte) || progress_file.write(bytes) != bytes.size() || !progress_file.flush()) {
+            return false;
+        }
+        dirty_first = bin_table.size();
+        dirty_end = 0;
+        return true;
     }
 
-    // The number of kChunkSize chunks in the file
-    uint32_t numChunks() const
+    bool loadProgress()
     {
-        return qCeil(entry->size() / static_cast<qreal>(kChunkSize));
+        progress_file.setFileName(progressFileName(path));
+        if (!progress_file.open(QIODevice::ReadWrite)) {
+            return false;
+        }
+        QDataStream stream(&progress_file);
+        quint32     version = 0;
+        quint32     size = 0;
+        stream >> version >> size;
+        if (stream.status() != QDataStream::Ok || version != kProgressVersion || size != entry->size()) {
+            return false;
+        }
+        const QByteArray bytes = progress_file.read(progressBytes());
+        if (bytes.size() != progressBytes()) {
+            return false;
+        }
+        bin_table = QBitArray(numBins(), false);
+        for (uint32_t bin = 0; bin < numBins(); bin++) {
+            if (static_cast<uchar>(bytes[bin / 8]) & (1 << (bin % 8))) {
+                bin_table.setBit(bin);
+            }
+        }
+        bins_received = bin_table.count(true);
+        dirty_first = bin_table.size();
+        dirty_end = 0;
+        written = qMin(bins_received * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN, entry->size());
+        // Stream from after the last bin received, earlier gaps are filled once the stream reaches the end
+        int last = bin_table.size() - 1;
+        while (last >= 0 && !bin_table.testBit(last)) {
+            last--;
+        }
+        stream_offset = qMin((last + 1) * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN, entry->size());
+        return true;
     }
 
-    // True if all bins in the chunk have been set to val
-    bool chunkEquals(const bool val) const
+    // Moves the completed log to its final name, the progress is no longer needed
+    bool finish()
     {
-        return chunk_table == QBitArray(chunk_table.size(), val);
+        if (!flush()) {
+            return false;
+        }
+        file.close();
+        progress_file.close();
+        if (!QFile::rename(file.fileName(), path)) {
+            return false;
+        }
+        QFile::remove(progressFileName(path));
+        return true;
     }
 
 };
 
 //----------------------------------------------------------------------------------------
 LogDownloadData::LogDownloadData(QGCLogEntry* entry_)
-    : ID(entry_->id())
+    : bins_received(0)
+    , gap_bin(0)
+    , stream_offset(0)
+    , request_offset(0)
+    , request_end(0)
+    , streaming(true)
+    , write_offset(0)
+    , dirty_first(0)
+    , dirty_end(0)
+    , ID(entry_->id())
     , entry(entry_)
     , written(0)
+    , slice_start(0)
     , rate_bytes(0)
     , rate_avg(0)
 {
-
+    write_buffer.reserve(kWriteBufferSize);
 }
 
 //----------------------------------------------------------------------------------------
@@ -118,9 +286,22 @@ LogDownloadController::LogDownloadController(void)
     MultiVehicleManager *manager = qgcApp()->toolbox()->multiVehicleManager();
     connect(manager, &MultiVehicleManager::activeVehicleChanged, this, &LogDownloadController::_setActiveVehicle);
     connect(&_timer, &QTimer::timeout, this, &LogDownloadController::_processDownload);
+    _loadQueue();
     _setActiveVehicle(manager->activeVehicle());
 }
 
+//----------------------------------------------------------------------------------------
+LogDownloadController::~LogDownloadController()
+{
+    //-- Keep the queue and the downloaded data, the download can be resumed the next time the log list is received
+    if(_downloadData) {
+        _pauseDownload();
+        delete _downloadData;
+        _downloadData = NULL;
+    }
+    _setDownloading(false);
+}
+
 //----------------------------------------------------------------------------------------
 void
 LogDownloadController::_processDownload()
@@ -136,6 +317,19 @@ LogDownloadController::_processDownload()
 void
 LogDownloadController::_setActiveVehicle(Vehicle* vehicle)
 {
+    //-- Keep the queue and the downloaded data, the download can be resumed once the log list is received again
+    if(_downloadData) {
+        _pauseDownload();
+        delete _downloadData;
+        _downloadData = NULL;
+    }
+    for(int i = 0; i < _downloadQueue.count(); i++) {
+        _downloadQueue[i].paused = true;
+    }
+    if(_downloadingLogs) {
+        _timer.stop();
+        _setDownloading(false);
+    }
     if(_uas) {
         _logEntriesModel.clear();
         disconnect(_uas, &UASInterface::logEntry, this, &LogDownloadController::_logEntry);
@@ -148,6 +342,7 @@ LogDownloadController::_setActiveVehicle(Vehicle* vehicle)
         connect(_uas, &UASInterface::logEntry, this, &LogDownloadController::_logEntry);
         connect(_uas, &UASInterface::logData,  this, &LogDownloadController::_logData);
     }
+    emit resumableChanged();
 }
 
 //----------------------------------------------------------------------------------------
@@ -194,6 +389,7 @@ LogDownloadController::_logEntry(UASInterface* uas, uint32_t time_utc, uint32_t
     //-- Do we have it all?
     if(_entriesComplete()) {
         _receivedAllEntries();
+        _updateQueuedLogs();
     } else {
         //-- Reset timer
         _timer.start(kTimeOutMilliseconds);
@@ -293,6 +489,7 @@ LogDownloadController::_findMissingEntries()
         _requestLogList((uint32_t)start, (uint32_t) end);
     } else {
         _receivedAllEntries();
+        _updateQueuedLogs();
     }
 }
 
@@ -315,87 +512,61 @@ LogDownloadController::_logData(UASInterface* uas, uint32_t ofs, uint16_t id, ui
         return;
     }
 
-    bool result = false;
-    uint32_t timeout_time = kTimeOutMilliseconds;
-    if(ofs <= _downloadData->entry->size()) {
-        const uint32_t chunk = ofs / kChunkSize;
-        if (chunk != _downloadData->current_chunk) {
-            qWarning() << "Ignored packet for out of order chunk" << chunk;
-            return;
-        }
-        const uint16_t bin = (ofs - chunk*kChunkSize) / MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
-        if (bin >= _downloadData->chunk_table.size()) {
-            qWarning() << "Out of range bin received";
-        } else
-            _downloadData->chunk_table.setBit(bin);
-        if (_downloadData->file.pos() != ofs) {
-            // Seek to correct position
-            if (!_downloadData->file.seek(ofs)) {
-                qWarning() << "Error while seeking log file offset";
-                return;
-            }
-        }
+    //-- Empty packets mark the end of the log
+    if(count == 0) {
+        return;
+    }
 
-        //-- Write chunk to file
-        if(_downloadData->file.write((const char*)data, count)) {
-            _downloadData->written += count;
-            _downloadData->rate_bytes += count;
-            if (_downloadData->elapsed.elapsed() >= kGUIRateMilliseconds) {
-                //-- Update download rate
-                qreal rrate = _downloadData->rate_bytes/(_downloadData->elapsed.elapsed()/1000.0);
-                _downloadData->rate_avg = _downloadData->rate_avg*0.95 + rrate*0.05;
-                _downloadData->rate_bytes = 0;
-
-                //-- Update status
-                const QString status = QString("%1 (%2/s)").arg(QGCMapEngine::bigSizeToString(_downloadData->written),
-                                                                QGCMapEngine::bigSizeToString(_downloadData->rate_avg));
-
-                _downloadData->entry->setStatus(status);
-                _downloadData->elapsed.start();
-            }
-            result = true;
-            //-- reset retries
-            _retries = 0;
-            //-- Reset timer
-            _timer.start(timeout_time);
-            //-- Do we have it all?
-            if(_logComplete()) {
-                _downloadData->entry->setStatus(QString(tr("Downloaded")));
-                //-- Check for more
-                _receivedAllData();
-            } else if (_chunkComplete()) {
-                _downloadData->advanceChunk();
-                _requestLogData(_downloadData->ID,
-                                _downloadData->current_chunk*kChunkSize,
-                                _downloadData->chunk_table.size()*MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
-            } else if (bin < _downloadData->chunk_table.size() - 1 && _downloadData->chunk_table.at(bin+1)) {
-                // Likely to be grabbing fragments and got to the end of a gap
-                _findMissingData();
-            }
-        } else {
-            qWarning() << "Error while writing log file chunk";
-        }
-    } else {
+    if(count > MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN || ofs + count > _downloadData->entry->size()) {
         qWarning() << "Received log offset greater than expected";
-    }
-    if(!result) {
         _downloadData->entry->setStatus(QString(tr("Error")));
+        return;
     }
-}
 
+    const uint32_t bin = ofs / MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
+    //-- Data which was requested again can arrive more than once
+    if(!_downloadData->bin_table.testBit(bin)) {
+        //-- Write chunk to file
+        if(!_downloadData->write(ofs, data, count)) {
+            qWarning() << "Error while writing log file chunk";
+            _downloadData->entry->setStatus(QString(tr("Error")));
+            return;
+        }
+        _downloadData->setReceived(bin);
+        _downloadData->written += count;
+        _downloadData->rate_bytes += count;
+        if (_downloadData->elapsed.elapsed() >= kGUIRateMilliseconds) {
+            //-- Update download rate
+            qreal rrate = _downloadData->rate_bytes/(_downloadData->elapsed.elapsed()/1000.0);
+            _downloadData->rate_avg = _downloadData->rate_avg*0.95 + rrate*0.05;
+            _downloadData->rate_bytes = 0;
 
-//----------------------------------------------------------------------------------------
-bool
-LogDownloadController::_chunkComplete() const
-{
-    return _downloadData->chunkEquals(true);
-}
+            //-- Update status
+            const QString status = QString("%1 (%2/s)").arg(QGCMapEngine::bigSizeToString(_downloadData->written),
+                                                            QGCMapEngine::bigSizeToString(_downloadData->rate_avg));
 
-//----------------------------------------------------------------------------------------
-bool
-LogDownloadController::_logComplete() const
-{
-    return _chunkComplete() && (_downloadData->current_chunk+1) == _downloadData->numChunks();
+            _downloadData->entry->setStatus(status);
+            _downloadData->elapsed.start();
+        }
+        if (_downloadData->progress_saved.elapsed() >= kProgressSaveMilliseconds) {
+            _downloadData->saveProgress();
+            _downloadData->progress_saved.start();
+        }
+    }
+    _downloadData->stream_offset = qMax(_downloadData->stream_offset, ofs + count);
+    //-- reset retries
+    _retries = 0;
+    //-- Reset timer
+    _timer.start(kTimeOutMilliseconds);
+
+    //-- Do we have it all, or did the vehicle send everything requested?
+    if(_downloadData->complete() || (ofs >= _downloadData->request_offset && ofs + count >= _downloadData->request_end)) {
+        _requestNextData();
+    } else if(_downloadData->streaming && _downloadData->request_end < _downloadData->entry->size() &&
+              _downloadData->stream_offset + kWindowSize / 2 >= _downloadData->request_end) {
+        //-- Slide the window. The request continues from where the vehicle is sending, so the stream is not interrupted.
+        _requestNextData();
+    }
 }
 
 //----------------------------------------------------------------------------------------
@@ -406,7 +577,7 @@ LogDownloadController::_receivedAllData()
     //-- Anything queued up for download?
     if(_prepareLogDownload()) {
         //-- Request Log
-        _requestLogData(_downloadData->ID, 0, _downloadData->chunk_table.size()*MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
+        _requestNextData();
     } else {
         _resetSelection();
         _setDownloading(false);
@@ -417,14 +588,13 @@ LogDownloadController::_receivedAllData()
 void
 LogDownloadController::_findMissingData()
 {
-    if (_logComplete()) {
-         _receivedAllData();
-         return;
-    } else if (_chunkComplete()) {
-        _downloadData->advanceChunk();
-    }
-
-    if(_retries++ > 2) {
+    if(!_downloadData->complete() && _retries++ > kMaxRetries) {
+        //-- Keep the partial log in the queue, the user can resume it
+        _pauseDownload();
+        int index = _queueIndex(_downloadData->ID);
+        if(index >= 0) {
+            _downloadQueue[index].paused = true;
+        }
         _downloadData->entry->setStatus(QString(tr("Timed Out")));
         //-- Give up
         qWarning() << "Too many errors retreiving log data. Giving up.";
@@ -432,23 +602,62 @@ LogDownloadController::_findMissingData()
         return;
     }
 
-    uint16_t start = 0, end = 0;
-    const int size = _downloadData->chunk_table.size();
-    for (; start < size; start++) {
-        if (!_downloadData->chunk_table.testBit(start)) {
-            break;
+    _requestNextData();
+}
+
+//----------------------------------------------------------------------------------------
+/// Vehicles serve one LOG_REQUEST_DATA at a time, a new request replaces the one in progress. The log is first
+/// streamed with a request for a window of kWindowChunks chunks, which is moved ahead as data arrives. Once the
+/// stream reaches the end of the log the bins lost along the way are requested again.
+void
+LogDownloadController::_requestNextData()
+{
+    const uint32_t size = _downloadData->entry->size();
+
+    if(_downloadData->complete()) {
+        if(_downloadData->finish()) {
+            _downloadData->entry->setStatus(QString(tr("Downloaded")));
+        } else {
+            qWarning() << "Error while writing log file chunk";
+            _downloadData->entry->setStatus(QString(tr("Error")));
         }
+        _dequeue(_downloadData->ID);
+        //-- Check for more
+        _receivedAllData();
+        return;
     }
 
-    for (end = start; end < size; end++) {
-        if (_downloadData->chunk_table.testBit(end)) {
-            break;
+    //-- Give a smaller queued log its turn
+    if(_shouldYield()) {
+        _pauseDownload();
+        _receivedAllData();
+        return;
+    }
+
+    if(_downloadData->stream_offset < size) {
+        _downloadData->streaming = true;
+        _downloadData->request_offset = _downloadData->stream_offset;
+        _downloadData->request_end = qMin(size, _downloadData->stream_offset + kWindowSize);
+    } else {
+        _downloadData->streaming = false;
+        const uint32_t numBins = _downloadData->bin_table.size();
+        while(_downloadData->gap_bin < numBins && _downloadData->bin_table.testBit(_downloadData->gap_bin)) {
+            _downloadData->gap_bin++;
         }
+        //-- Request the first gap along with the gaps which closely follow it
+        uint32_t lastMissing = _downloadData->gap_bin;
+        const uint32_t maxBin = qMin(numBins, _downloadData->gap_bin + (kWindowSize / MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN));
+        for(uint32_t bin = lastMissing + 1; bin < maxBin && bin - lastMissing <= kGapMergeBins; bin++) {
+            if(!_downloadData->bin_table.testBit(bin)) {
+                lastMissing = bin;
+            }
+        }
+        _downloadData->request_offset = _downloadData->gap_bin * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
+        _downloadData->request_end = qMin(size, (lastMissing + 1) * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
     }
 
-    const uint32_t pos = _downloadData->current_chunk*kChunkSize + start*MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN,
-                   len = (end - start)*MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
-    _requestLogData(_downloadData->ID, pos, len);
+    _requestLogData(_downloadData->ID, _downloadData->request_offset, _downloadData->request_end - _downloadData->request_offset);
+    _timer.start(kTimeOutMilliseconds);
 }
 
 //----------------------------------------------------------------------------------------
@@ -528,116 +737,377 @@ void LogDownloadController::downloadToDirectory(const QString& dir)
 {
     //-- Stop listing just in case
     _receivedAllEntries();
-    //-- Reset downloads, again just in case
-    if(_downloadData) {
-        delete _downloadData;
-        _downloadData = 0;
-    }
-    _downloadPath = dir;
-    if(!_downloadPath.isEmpty()) {
-        if(!_downloadPath.endsWith(QDir::separator()))
-            _downloadPath += QDir::separator();
-        //-- Iterate selected entries and shown them as waiting
+    QString path = dir;
+    if(!path.isEmpty()) {
+        if(!path.endsWith(QDir::separator()))
+            path += QDir::separator();
+        //-- Queue selected entries and show them as waiting
         int num_logs = _logEntriesModel.count();
         for(int i = 0; i < num_logs; i++) {
             QGCLogEntry* entry = _logEntriesModel[i];
-            if(entry) {
-                if(entry->selected()) {
-                   entry->setStatus(QString(tr("Waiting")));
+            if(entry && entry->selected()) {
+                entry->setSelected(false);
+                int index = _queueIndex(entry->id());
+                if(index < 0) {
+                    QueuedLog_t queued;
+                    queued.id =         entry->id();
+                    queued.size =       entry->size();
+                    queued.time =       entry->time();
+                    queued.vehicle =    _vehicleKey();
+                    queued.path =       path;
+                    queued.remaining =  entry->size();
+                    queued.paused =     false;
+                    _downloadQueue.append(queued);
+                    entry->setStatus(QString(tr("Waiting")));
+                } else if(_downloadQueue[index].paused) {
+                    //-- A partial download continues in the directory it was started in
+                    _downloadQueue[index].paused = false;
+                    entry->setStatus(QString(tr("Waiting")));
                 }
             }
         }
-        //-- Start download process
-        _setDownloading(true);
-        _receivedAllData();
+        emit selectionChanged();
+        _saveQueue();
+        //-- Start download process, logs queued while downloading get their turn from the queue
+        if(!_downloadingLogs) {
+            _setDownloading(true);
+            _receivedAllData();
+        }
     }
 }
 
+//----------------------------------------------------------------------------------------
+/// @return Index of the queued log with the least left to download, -1 if nothing is waiting to download
+int
+LogDownloadController::_nextQueuedLog() const
+{
+    int next = -1;
+    for(int i = 0; i < _downloadQueue.count(); i++) {
+        if(!_downloadQueue[i].paused && (next < 0 || _downloadQueue[i].remaining < _downloadQueue[next].remaining)) {
+            next = i;
+        }
+    }
+    return next;
+}
 
 //----------------------------------------------------------------------------------------
+/// @return Index of the active vehicle's log in the queue, -1 if it is not queued
+int
+LogDownloadController::_queueIndex(uint id) const
+{
+    const QString vehicleKey = _vehicleKey();
+    for(int i = 0; i < _downloadQueue.count(); i++) {
+        if(_downloadQueue[i].id == id && _downloadQueue[i].vehicle == vehicleKey) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+//----------------------------------------------------------------------------------------
+void
+LogDownloadController::_dequeue(uint id)
+{
+    int index = _queueIndex(id);
+    if(index >= 0) {
+        _downloadQueue.removeAt(index);
+        _saveQueue();
+    }
+}
+
+//----------------------------------------------------------------------------------------
+/// Identifies the vehicle the queued logs belong to. Log ids are only unique on one vehicle.
+QString
+LogDownloadController::_vehicleKey(void) const
+{
+    if(!_vehicle) {
+        return QString();
+    }
+    if(_vehicle->uid() == 0) {
+        return QString("%1_id%2").arg(_vehicle->firmwareType()).arg(_vehicle->id());
+    }
+    return QString("%1_%2").arg(_vehicle->firmwareType()).arg(_vehicle->uid(), 16, 16, QChar('0'));
+}
+
+//----------------------------------------------------------------------------------------
+/// @return Entry in the log list for the queued log, NULL if the active vehicle does not have the same log
 QGCLogEntry*
-LogDownloadController::_getNextSelected()
+LogDownloadController::_queuedEntry(const QueuedLog_t& queued)
 {
-    //-- Iterate entries and look for a selected file
-    int num_logs = _logEntriesModel.count();
-    for(int i = 0; i < num_logs; i++) {
-        QGCLogEntry* entry = _logEntriesModel[i];
+    if(queued.vehicle != _vehicleKey()) {
+        return NULL;
+    }
+    QGCLogEntry* entry = _logEntriesModel[queued.id];
+    if(!entry || !entry->received() || entry->size() != queued.size || entry->time() != queued.time) {
+        return NULL;
+    }
+    return entry;
+}
+
+//----------------------------------------------------------------------------------------
+void
+LogDownloadController::_removeQueuedFiles(const QueuedLog_t& queued)
+{
+    if(!queued.file.isEmpty()) {
+        QFile::remove(LogDownloadData::partialFileName(queued.file));
+        QFile::remove(LogDownloadData::progressFileName(queued.file));
+    }
+}
+
+//----------------------------------------------------------------------------------------
+/// The current log has had its slice of the link and a queued log has less left to download
+bool
+LogDownloadController::_shouldYield() const
+{
+    if(!_downloadData || _downloadData->written - _downloadData->slice_start < kQueueSliceSize) {
+        return false;
+    }
+    const uint remaining = _downloadData->entry->size() - _downloadData->written;
+    for(int i = 0; i < _downloadQueue.count(); i++) {
+        if(!_downloadQueue[i].paused && _downloadQueue[i].id != _downloadData->ID && _downloadQueue[i].remaining < remaining) {
+            return true;
+        }
+    }
+    return false;
+}
+
+//----------------------------------------------------------------------------------------
+/// Saves the progress of the current download and leaves it in the queue
+void
+LogDownloadController::_pauseDownload()
+{
+    _timer.stop();
+    if(!_downloadData->saveProgress()) {
+        qWarning() << "Failed to save log download progress:" << _downloadData->filename;
+    }
+    int index = _queueIndex(_downloadData->ID);
+    if(index >= 0) {
+        _downloadQueue[index].remaining = _downloadData->entry->size() - _downloadData->written;
+        _saveQueue();
+    }
+    _downloadData->entry->setStatus(QString(tr("Waiting")));
+}
+
+//----------------------------------------------------------------------------------------
+/// Shows which of the active vehicle's queued logs can be resumed once the log list is received, after a
+/// reconnect or restart. Queued logs the vehicle no longer has are dropped along with their partial files.
+void
+LogDownloadController::_updateQueuedLogs()
+{
+    if(!_vehicle) {
+        return;
+    }
+    const QString vehicleKey = _vehicleKey();
+    bool dropped = false;
+    for(int i = _downloadQueue.count() - 1; i >= 0; i--) {
+        const QueuedLog_t& queued = _downloadQueue[i];
+        if(!queued.paused || queued.vehicle != vehicleKey) {
+            continue;
+        }
+        QGCLogEntry* entry = _queuedEntry(queued);
         if(entry) {
-            if(entry->selected()) {
-               return entry;
+            entry->setStatus(QString(tr("Paused")));
+        } else {
+            //-- An entry missing from an incomplete list may still be on the vehicle
+            QGCLogEntry* listed = _logEntriesModel[queued.id];
+            if(listed && !listed->received()) {
+                continue;
             }
+            qCDebug(LogDownloadLog) << "Queued log no longer available" << queued.id;
+            _removeQueuedFiles(queued);
+            _downloadQueue.removeAt(i);
+            dropped = true;
         }
     }
-    return NULL;
+    if(dropped) {
+        _saveQueue();
+    }
+    emit resumableChanged();
 }
 
 //----------------------------------------------------------------------------------------
 bool
-LogDownloadController::_prepareLogDownload()
+LogDownloadController::resumable(void)
 {
-    if(_downloadData) {
-        delete _downloadData;
-        _downloadData = NULL;
-    }
-    QGCLogEntry* entry = _getNextSelected();
-    if(!entry) {
+    if(_downloadingLogs || _requestingLogEntries) {
         return false;
     }
-    //-- Deselect file
-    entry->setSelected(false);
-    emit selectionChanged();
-    bool result = false;
+    for(int i = 0; i < _downloadQueue.count(); i++) {
+        if(_downloadQueue[i].paused && _queuedEntry(_downloadQueue[i])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+//----------------------------------------------------------------------------------------
+void
+LogDownloadController::resume(void)
+{
+    if(_downloadingLogs || _requestingLogEntries) {
+        return;
+    }
+    bool resumed = false;
+    for(int i = 0; i < _downloadQueue.count(); i++) {
+        QGCLogEntry* entry = _downloadQueue[i].paused ? _queuedEntry(_downloadQueue[i]) : NULL;
+        if(entry) {
+            _downloadQueue[i].paused = false;
+            entry->setStatus(QString(tr("Waiting")));
+            resumed = true;
+        }
+    }
+    if(resumed) {
+        qCDebug(LogDownloadLog) << "Resuming log download queue";
+        _setDownloading(true);
+        _receivedAllData();
+    }
+}
+
+//----------------------------------------------------------------------------------------
+/// Logs loaded from the settings wait for the user to resume them
+void
+LogDownloadController::_loadQueue()
+{
+    QSettings settings;
+    int count = settings.beginReadArray(_queueSettingsGroup);
+    for(int i = 0; i < count; i++) {
+        settings.setArrayIndex(i);
+        QueuedLog_t queued;
+        queued.id =         settings.value("id").toUInt();
+        queued.size =       settings.value("size").toUInt();
+        queued.time =       settings.value("time").toDateTime();
+        queued.vehicle =    settings.value("vehicle").toString();
+        queued.path =       settings.value("path").toString();
+        queued.file =       settings.value("file").toString();
+        queued.remaining =  settings.value("remaining", queued.size).toUInt();
+        queued.paused =     true;
+        _downloadQueue.append(queued);
+    }
+    settings.endArray();
+}
+
+//----------------------------------------------------------------------------------------
+void
+LogDownloadController::_saveQueue()
+{
+    QSettings settings;
+    settings.remove(_queueSettingsGroup);
+    settings.beginWriteArray(_queueSettingsGroup, _downloadQueue.count());
+    for(int i = 0; i < _downloadQueue.count(); i++) {
+        settings.setArrayIndex(i);
+        settings.setValue("id",         _downloadQueue[i].id);
+        settings.setValue("size",       _downloadQueue[i].size);
+        settings.setValue("time",       _downloadQueue[i].time);
+        settings.setValue("vehicle",    _downloadQueue[i].vehicle);
+        settings.setValue("path",       _downloadQueue[i].path);
+        settings.setValue("file",       _downloadQueue[i].file);
+        settings.setValue("remaining",  _downloadQueue[i].remaining);
+    }
+    settings.endArray();
+}
+
+//----------------------------------------------------------------------------------------
+/// @return Log file name for the entry, with a number appended if a log or a partial download already has the name
+QString
+LogDownloadController::_logFileName(const QString& dir, QGCLogEntry* entry)
+{
     QString ftime;
     if(entry->time().date().year() < 2010) {
         ftime = "UnknownDate";
     } else {
         ftime = entry->time().toString("yyyy-M-d-hh-mm-ss");
     }
-    _downloadData = new LogDownloadData(entry);
-    _downloadData->filename = QString("log_") + QString::number(entry->id()) + "_" + ftime;
+    QString baseName = QString("log_") + QString::number(entry->id()) + "_" + ftime;
+    QString extension;
     if (_vehicle->firmwareType() == MAV_AUTOPILOT_PX4) {
         QString loggerParam("SYS_LOGGER");
         if (_vehicle->parameterManager()->parameterExists(FactSystem::defaultComponentId, loggerParam) &&
                 _vehicle->parameterManager()->getParameter(FactSystem::defaultComponentId, loggerParam)->rawValue().toInt() == 0) {
-            _downloadData->filename += ".px4log";
+            extension = ".px4log";
         } else {
-            _downloadData->filename += ".ulg";
+            extension = ".ulg";
         }
     } else {
-        _downloadData->filename += ".bin";
-    }
-    _downloadData->file.setFileName(_downloadPath + _downloadData->filename);
-    //-- Append a number to the end if the filename already exists
-    if (_downloadData->file.exists()){
-        uint num_dups = 0;
-        QStringList filename_spl = _downloadData->filename.split('.');
-        do {
-            num_dups +=1;
-            _downloadData->file.setFileName(filename_spl[0] + '_' + QString::number(num_dups) + '.' + filename_spl[1]);
-        } while( _downloadData->file.exists());
-    }
-    //-- Create file
-    if (!_downloadData->file.open(QIODevice::WriteOnly)) {
-        qWarning() << "Failed to create log file:" <<  _downloadData->filename;
-    } else {
-        //-- Preallocate file
-        if(!_downloadData->file.resize(entry->size())) {
-            qWarning() << "Failed to allocate space for log file:" <<  _downloadData->filename;
-        } else {
-            _downloadData->current_chunk = 0;
-            _downloadData->chunk_table = QBitArray(_downloadData->chunkBins(), false);
-            _downloadData->elapsed.start();
+        extension = ".bin";
+    }
+    QString fileName = dir + baseName + extension;
+    uint num_dups = 0;
+    while (QFile::exists(fileName) || QFile::exists(LogDownloadData::partialFileName(fileName))) {
+        num_dups +=1;
+        fileName = dir + baseName + '_' + QString::number(num_dups) + extension;
+    }
+    return fileName;
+}
+
+//----------------------------------------------------------------------------------------
+bool
+LogDownloadController::_prepareLogDownload()
+{
+    if(_downloadData) {
+        delete _downloadData;
+        _downloadData = NULL;
+    }
+    int queueIndex = _nextQueuedLog();
+    if(queueIndex < 0) {
+        return false;
+    }
+    const uint id = _downloadQueue[queueIndex].id;
+    QGCLogEntry* entry = _logEntriesModel[id];
+    if(!entry) {
+        qWarning() << "Queued log is not in the log list:" << id;
+        _dequeue(id);
+        return _prepareLogDownload();
+    }
+    //-- The name is chosen once, a partial download keeps it until it completes
+    if(_downloadQueue[queueIndex].file.isEmpty()) {
+        _downloadQueue[queueIndex].file = _logFileName(_downloadQueue[queueIndex].path, entry);
+        _saveQueue();
+    }
+    bool result = false;
+    _downloadData = new LogDownloadData(entry);
+    _downloadData->path = _downloadQueue[queueIndex].file;
+    _downloadData->filename = QFileInfo(_downloadData->path).fileName();
+    _downloadData->file.setFileName(LogDownloadData::partialFileName(_downloadData->path));
+    //-- Continue a partial download
+    if (_downloadData->file.exists()) {
+        if (_downloadData->file.open(QIODevice::ReadWrite) && _downloadData->file.size() == entry->size() && _downloadData->loadProgress()) {
+            qCDebug(LogDownloadLog) << "Resuming log download" << _downloadData->file.fileName() << _downloadData->written;
             result = true;
+        } else {
+            qWarning() << "Unable to resume log download, starting again:" << _downloadData->filename;
+            _downloadData->file.close();
+            _downloadData->progress_file.close();
         }
     }
-    if(!result) {
-        if (_downloadData->file.exists()) {
-            _downloadData->file.remove();
+    if (!result) {
+        //-- Create file
+        if (!_downloadData->file.open(QIODevice::WriteOnly)) {
+            qWarning() << "Failed to create log file:" <<  _downloadData->filename;
+        } else {
+            //-- Preallocate file
+            if(!_downloadData->file.resize(entry->size())) {
+                qWarning() << "Failed to allocate space for log file:" <<  _downloadData->filename;
+            } else {
+                _downloadData->bin_table = QBitArray(_downloadData->numBins(), false);
+                _downloadData->dirty_first = _downloadData->bin_table.size();
+                result = _downloadData->createProgress();
+            }
         }
+    }
+    if(!result) {
+        _downloadData->file.close();
+        _downloadData->progress_file.close();
+        _removeQueuedFiles(_downloadQueue[queueIndex]);
         _downloadData->entry->setStatus(QString(tr("Error")));
         delete _downloadData;
         _downloadData = NULL;
+        //-- Carry on with the rest of the queue
+        _dequeue(id);
+        return _prepareLogDownload();
     }
+    _downloadData->slice_start = _downloadData->written;
+    _downloadData->elapsed.start();
+    _downloadData->progress_saved.start();
     return result;
 }
 
@@ -649,6 +1119,7 @@ LogDownloadController::_setDownloading(bool active)
         _downloadingLogs = active;
         _vehicle->setConnectionLostEnabled(!active);
         emit downloadingLogsChanged();
+        emit resumableChanged();
     }
 }
 
@@ -660,6 +1131,7 @@ LogDownloadController::_setListing(bool active)
         _requestingLogEntries = active;
         _vehicle->setConnectionLostEnabled(!active);
         emit requestingListChanged();
+        emit resumableChanged();
     }
 }
 
@@ -687,14 +1159,23 @@ LogDownloadController::cancel(void)
     if(_uas){
         _receivedAllEntries();
     }
+    _timer.stop();
     if(_downloadData) {
-        _downloadData->entry->setStatus(QString(tr("Canceled")));
-        if (_downloadData->file.exists()) {
-            _downloadData->file.remove();
-        }
         delete _downloadData;
         _downloadData = 0;
     }
+    //-- The logs waiting to download are dropped along with their partial files, paused logs can still be resumed
+    for(int i = _downloadQueue.count() - 1; i >= 0; i--) {
+        if(!_downloadQueue[i].paused) {
+            QGCLogEntry* entry = _queuedEntry(_downloadQueue[i]);
+            if(entry) {
+                entry->setStatus(QString(tr("Canceled")));
+            }
+            _removeQueuedFiles(_downloadQueue[i]);
+            _downloadQueue.removeAt(i);
+        }
+    }
+    _saveQueue();
     _resetSelection(true);
     _setDownloading(false);
 }
@@ -115,19 +115,24 @@ class LogDownloadController : public QObject
 
 public:
     LogDownloadController(void);
+    ~LogDownloadController();
 
     Q_PROPERTY(QGCLogModel* model           READ model              NOTIFY modelChanged)
     Q_PROPERTY(bool         requestingList  READ requestingList     NOTIFY requestingListChanged)
     Q_PROPERTY(bool         downloadingLogs READ downloadingLogs    NOTIFY downloadingLogsChanged)
+    /// true: Partial downloads from an earlier session or a timeout can be resumed from the active vehicle
+    Q_PROPERTY(bool         resumable       READ resumable          NOTIFY resumableChanged)
 
     QGCLogModel*    model                   () { return &_logEntriesModel; }
     bool            requestingList          () { return _requestingLogEntries; }
     bool            downloadingLogs         () { return _downloadingLogs; }
+    bool            resumable               ();
 
     Q_INVOKABLE void refresh                ();
     Q_INVOKABLE void download               (QString path = QString());
     Q_INVOKABLE void eraseAll               ();
     Q_INVOKABLE void cancel                 ();
+    Q_INVOKABLE void resume                 ();
 
     void downloadToDirectory(const QString& dir);
 
@@ -136,6 +141,7 @@ signals:
     void downloadingLogsChanged ();
     void modelChanged           ();
     void selectionChanged       ();
+    void resumableChanged       ();
 
 private slots:
     void _setActiveVehicle  (Vehicle* vehicle);
@@ -144,22 +150,42 @@ private slots:
     void _processDownload   ();
 
 private:
+    /// Log waiting in the download queue
+    typedef struct {
+        uint        id;
+        uint        size;
+        QDateTime   time;
+        QString     vehicle;    ///< Vehicle the log is on, see _vehicleKey
+        QString     path;       ///< Directory the log is downloaded to
+        QString     file;       ///< Log file, chosen when the download starts
+        uint        remaining;  ///< Bytes left to download, logs with the least left go first
+        bool        paused;     ///< Waits for the user to resume it, not saved
+    } QueuedLog_t;
 
     bool _entriesComplete   ();
-    bool _chunkComplete     () const;
-    bool _logComplete       () const;
     void _findMissingEntries();
     void _receivedAllEntries();
     void _receivedAllData   ();
     void _resetSelection    (bool canceled = false);
     void _findMissingData   ();
+    void _requestNextData   ();
     void _requestLogList    (uint32_t start, uint32_t end);
     void _requestLogData    (uint8_t id, uint32_t offset = 0, uint32_t count = 0xFFFFFFFF);
     bool _prepareLogDownload();
     void _setDownloading    (bool active);
     void _setListing        (bool active);
-
-    QGCLogEntry* _getNextSelected();
+    int  _nextQueuedLog     () const;
+    int  _queueIndex        (uint id) const;
+    void _dequeue           (uint id);
+    bool _shouldYield       () const;
+    void _pauseDownload     ();
+    void _updateQueuedLogs  ();
+    QString _vehicleKey     () const;
+    QString _logFileName    (const QString& dir, QGCLogEntry* entry);
+    QGCLogEntry* _queuedEntry(const QueuedLog_t& queued);
+    void _removeQueuedFiles (const QueuedLog_t& queued);
+    void _loadQueue         ();
+    void _saveQueue         ();
 
     UASInterface*       _uas;
     LogDownloadData*    _downloadData;
@@ -170,7 +196,9 @@ private:
     bool                _downloadingLogs;
     int                 _retries;
     int                 _apmOneBased;
-    QString             _downloadPath;
+    QList<QueuedLog_t>  _downloadQueue;
+
+    static const char*  _queueSettingsGroup;
 };
 
 #endif
@@ -138,7 +138,7 @@ AnalyzePage {
                 }
 
                 QGCButton {
-                    enabled:    !logController.requestingList && !logController.downloadingLogs && tableView.selection.count > 0
+                    enabled:    !logController.requestingList && tableView.selection.count > 0
                     text:       qsTr("Download")
                     width:      _butttonWidth
                     onClicked: {
@@ -170,6 +170,13 @@ AnalyzePage {
                     }
                 }
 
+                QGCButton {
+                    enabled:    logController.resumable
+                    text:       qsTr("Resume")
+                    width:      _butttonWidth
+                    onClicked:  logController.resume()
+                }
+
                 QGCButton {
                     enabled:    !logController.requestingList && !logController.downloadingLogs && logController.model.count > 0
                     text:       qsTr("Erase All")
@@ -12,6 +12,8 @@
 #include "MockLink.h"
 
 #include <QDir>
+#include <QElapsedTimer>
+#include <QSignalSpy>
 
 LogDownloadTest::LogDownloadTest(void)
 {
@@ -64,3 +66,223 @@ void LogDownloadTest::downloadTest(void)
 
     delete controller;
 }
+
+/// Downloads a larger log over a link which drops packets and reports the download rate
+void LogDownloadTest::downloadLossTest(void)
+{
+    // Up to 1.8 MB/s from the vehicle, with one packet in twenty lost
+    const uint32_t logSize = 2 * 1024 * 1024;
+
+    _connectMockLink(MAV_AUTOPILOT_PX4);
+    _mockLink->setLogDownloadFileSize(logSize);
+    _mockLink->setLogDownloadPacketsPerTick(40);
+    _mockLink->setLogDownloadLossPercent(5);
+
+    LogDownloadController* controller = new LogDownloadController();
+    QSignalSpy spyRequestingList(controller, &LogDownloadController::requestingListChanged);
+    QSignalSpy spyDownloadingLogs(controller, &LogDownloadController::downloadingLogsChanged);
+
+    controller->refresh();
+    while (controller->requestingList()) {
+        QVERIFY(spyRequestingList.wait(10000));
+    }
+
+    QGCLogModel* model = controller->model();
+    QCOMPARE(model->count(), 1);
+    QCOMPARE((*model)[0]->size(), logSize);
+    (*model)[0]->setSelected(true);
+
+    QElapsedTimer timer;
+    timer.start();
+    QString downloadTo = QDir::currentPath();
+    controller->downloadToDirectory(downloadTo);
+    while (controller->downloadingLogs()) {
+        QVERIFY(spyDownloadingLogs.wait(60000));
+    }
+    qint64 msecs = timer.elapsed();
+
+    QCOMPARE((*model)[0]->status(), QStringLiteral("Downloaded"));
+    QString downloadFile = QDir(downloadTo).filePath("log_0_UnknownDate.px4log");
+    QVERIFY(UnitTest::fileCompare(downloadFile, _mockLink->logDownloadFile()));
+
+    // Only the lost data is requested again, not whole chunks
+    qDebug() << "Downloaded" << logSize << "bytes at" << (logSize / (1024.0 * 1024.0)) / (msecs / 1000.0) << "MB/s,"
+             << _mockLink->logDownloadBytesSent() << "bytes sent";
+    QVERIFY(_mockLink->logDownloadBytesSent() < logSize * 1.5);
+
+    QFile::remove(downloadFile);
+
+    delete controller;
+}
+
+/// Stops a download part way through and checks the user can resume it from the saved progress with a new controller
+void LogDownloadTest::resumeTest(void)
+{
+    const uint32_t logSize = 2 * 1024 * 1024;
+
+    _connectMockLink(MAV_AUTOPILOT_PX4);
+    _mockLink->setLogDownloadFileSize(logSize);
+    _mockLink->setLogDownloadPacketsPerTick(40);
+
+    LogDownloadController* controller = new LogDownloadController();
+    QSignalSpy spyRequestingList(controller, &LogDownloadController::requestingListChanged);
+
+    controller->refresh();
+    while (controller->requestingList()) {
+        QVERIFY(spyRequestingList.wait(10000));
+    }
+
+    QGCLogModel* model = controller->model();
+    QCOMPARE(model->count(), 1);
+    (*model)[0]->setSelected(true);
+
+    QString downloadTo = QDir::currentPath();
+    QString downloadFile = QDir(downloadTo).filePath("log_0_UnknownDate.px4log");
+    QString partialFile = downloadFile + ".partial";
+    QString progressFile = downloadFile + ".progress";
+    controller->downloadToDirectory(downloadTo);
+
+    QElapsedTimer timer;
+    timer.start();
+    while (_mockLink->logDownloadBytesSent() < logSize / 3) {
+        QVERIFY(timer.elapsed() < 10000);
+        QTest::qWait(10);
+    }
+    QVERIFY(controller->downloadingLogs());
+
+    // Same as closing the application part way through the download
+    delete controller;
+    QVERIFY(!QFile::exists(downloadFile));
+    QVERIFY(QFile::exists(partialFile));
+    QVERIFY(QFile::exists(progressFile));
+
+    // The queued download waits for the user once the log list is received
+    controller = new LogDownloadController();
+    QSignalSpy spyRequestingListAgain(controller, &LogDownloadController::requestingListChanged);
+    QSignalSpy spyDownloadingLogs(controller, &LogDownloadController::downloadingLogsChanged);
+    controller->refresh();
+    while (controller->requestingList()) {
+        QVERIFY(spyRequestingListAgain.wait(10000));
+    }
+    model = controller->model();
+    QVERIFY(!controller->downloadingLogs());
+    QCOMPARE((*model)[0]->status(), QStringLiteral("Paused"));
+    QVERIFY(controller->resumable());
+
+    controller->resume();
+    QVERIFY(controller->downloadingLogs());
+    while (controller->downloadingLogs()) {
+        QVERIFY(spyDownloadingLogs.wait(60000));
+    }
+
+    QCOMPARE((*model)[0]->status(), QStringLiteral("Downloaded"));
+    QVERIFY(UnitTest::fileCompare(downloadFile, _mockLink->logDownloadFile()));
+    QVERIFY(!QFile::exists(partialFile));
+    QVERIFY(!QFile::exists(progressFile));
+    QVERIFY(!controller->resumable());
+
+    // The data received before stopping is not downloaded again
+    QVERIFY(_mockLink->logDownloadBytesSent() < logSize * 1.3);
+
+    QFile::remove(downloadFile);
+
+    delete controller;
+}
+
+/// Queues a small log behind a large one and checks the small log does not wait for the large one to finish
+void LogDownloadTest::interleaveTest(void)
+{
+    const uint32_t largeLogSize = 4 * 1024 * 1024;
+    const uint32_t smallLogSize = 60 * 1024;
+
+    _connectMockLink(MAV_AUTOPILOT_PX4);
+    _mockLink->setLogDownloadFileSizes(QList<uint32_t>() << largeLogSize << smallLogSize);
+    _mockLink->setLogDownloadPacketsPerTick(40);
+
+    LogDownloadController* controller = new LogDownloadController();
+    QSignalSpy spyRequestingList(controller, &LogDownloadController::requestingListChanged);
+    QSignalSpy spyDownloadingLogs(controller, &LogDownloadController::downloadingLogsChanged);
+
+    controller->refresh();
+    while (controller->requestingList()) {
+        QVERIFY(spyRequestingList.wait(10000));
+    }
+
+    QGCLogModel* model = controller->model();
+    QCOMPARE(model->count(), 2);
+
+    QList<uint> downloadedIds;
+    for (int i=0; i<model->count(); i++) {
+        QGCLogEntry* entry = (*model)[i];
+        connect(entry, &QGCLogEntry::statusChanged, this, [entry, &downloadedIds]() {
+            if (entry->status() == QStringLiteral("Downloaded")) {
+                downloadedIds.append(entry->id());
+            }
+        });
+    }
+
+    // The small log is queued after the large log has started
+    QString downloadTo = QDir::currentPath();
+    (*model)[0]->setSelected(true);
+    controller->downloadToDirectory(downloadTo);
+    QVERIFY(controller->downloadingLogs());
+    (*model)[1]->setSelected(true);
+    controller->downloadToDirectory(downloadTo);
+
+    while (controller->downloadingLogs()) {
+        QVERIFY(spyDownloadingLogs.wait(60000));
+    }
+
+    QCOMPARE(downloadedIds, QList<uint>() << 1 << 0);
+    for (int i=0; i<model->count(); i++) {
+        QString downloadFile = QDir(downloadTo).filePath(QString("log_%1_UnknownDate.px4log").arg(i));
+        QVERIFY(UnitTest::fileCompare(downloadFile, _mockLink->logDownloadFile(i)));
+        QFile::remove(downloadFile);
+    }
+
+    delete controller;
+}
+
+/// Cancels a download part way through and checks the partial log and its progress are removed
+void LogDownloadTest::cancelTest(void)
+{
+    const uint32_t logSize = 2 * 1024 * 1024;
+
+    _connectMockLink(MAV_AUTOPILOT_PX4);
+    _mockLink->setLogDownloadFileSize(logSize);
+    _mockLink->setLogDownloadPacketsPerTick(40);
+
+    LogDownloadController* controller = new LogDownloadController();
+    QSignalSpy spyRequestingList(controller, &LogDownloadController::requestingListChanged);
+
+    controller->refresh();
+    while (controller->requestingList()) {
+        QVERIFY(spyRequestingList.wait(10000));
+    }
+
+    QGCLogModel* model = controller->model();
+    QCOMPARE(model->count(), 1);
+    (*model)[0]->setSelected(true);
+
+    QString downloadTo = QDir::currentPath();
+    QString downloadFile = QDir(downloadTo).filePath("log_0_UnknownDate.px4log");
+    controller->downloadToDirectory(downloadTo);
+
+    QElapsedTimer timer;
+    timer.start();
+    while (_mockLink->logDownloadBytesSent() < logSize / 3) {
+        QVERIFY(timer.elapsed() < 10000);
+        QTest::qWait(10);
+    }
+    QVERIFY(QFile::exists(downloadFile + ".partial"));
+
+    controller->cancel();
+    QVERIFY(!controller->downloadingLogs());
+    QCOMPARE((*model)[0]->status(), QStringLiteral("Canceled"));
+    QVERIFY(!QFile::exists(downloadFile));
+    QVERIFY(!QFile::exists(downloadFile + ".partial"));
+    QVERIFY(!QFile::exists(downloadFile + ".progress"));
+    QVERIFY(!controller->resumable());
+
+    delete controller;
+}
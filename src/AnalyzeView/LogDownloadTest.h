@@ -25,6 +25,10 @@ private slots:
     //void cleanup(void) { _cleanup(); }
 
     void downloadTest(void);
+    void downloadLossTest(void);
+    void resumeTest(void);
+    void cancelTest(void);
+    void interleaveTest(void);
 
 private:
     // LogDownloadController signals
@@ -1,7 +1,11 @@
 #include "PX4LogParser.h"
+#include "QGCLoggingCategory.h"
 #include <math.h>
 #include <QtEndian>
 #include <QDateTime>
+#include <QFile>
+
+#include <cstring>
 
 PX4LogParser::PX4LogParser()
 {
@@ -15,85 +19,246 @@ PX4LogParser::~PX4LogParser()
 
 bool PX4LogParser::getTagsFromLog(QByteArray& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback)
 {
+    return _getTags(reinterpret_cast<const uchar*>(log.constData()), log.size(), cameraFeedback);
+}
 
-     // general message header
-    char header[] = {(char)0xA3, (char)0x95, (char)0x00};
-    // header for GPOS message header
-    char gposHeaderHeader[] = {(char)0xA3, (char)0x95, (char)0x80, (char)0x10, (char)0x00};
-    int gposHeaderOffset;
-    // header for GPOS message
-    char gposHeader[] = {(char)0xA3, (char)0x95, (char)0x10, (char)0x00};
-    int gposOffsets[3] = {3, 7, 11};
-    int gposLengths[3] = {4, 4, 4};
-    // header for trigger message header
-    char triggerHeaderHeader[] = {(char)0xA3, (char)0x95, (char)0x80, (char)0x37, (char)0x00};
-    int triggerHeaderOffset;
-    // header for trigger message
-    char triggerHeader[] = {(char)0xA3, (char)0x95, (char)0x37, (char)0x00};
-    int triggerOffsets[2] = {3, 11};
-    int triggerLengths[2] = {8, 4};
-
-    // extract header information: message lengths
-    uint8_t* iptr = reinterpret_cast<uint8_t*>(log.mid(log.indexOf(gposHeaderHeader) + 4, 1).data());
-    gposHeaderOffset = static_cast<int>(qFromLittleEndian(*iptr));
-    iptr = reinterpret_cast<uint8_t*>(log.mid(log.indexOf(triggerHeaderHeader) + 4, 1).data());
-    triggerHeaderOffset = static_cast<int>(qFromLittleEndian(*iptr));
-
-    // extract trigger data
-    int index = 1;
-    int sequence = -1;
-    while(index < log.count() - 1) {
-
-        // first extract trigger
-        index = log.indexOf(triggerHeader, index + 1);
-        // check for whether last entry has been passed
-        if (index < 0) {
-            break;
-        }
+bool PX4LogParser::getTagsFromLog(const QString& logFile, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback)
+{
+    QFile file(logFile);
 
-        if (log.indexOf(header, index + 1) != index + triggerHeaderOffset) {
-            continue;
-        }
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Unable to open log file" << logFile << file.errorString();
+        return false;
+    }
+
+    qint64  size = file.size();
+    uchar*  map = size > 0 ? file.map(0, size) : NULL;
+    if (!map) {
+        // Mapping not supported on this platform/file system, fall back to reading it
+        qCDebug(GeotaggingLog) << "Unable to map log, reading it instead" << logFile;
+        QByteArray log = file.readAll();
+        return getTagsFromLog(log, cameraFeedback);
+    }
+
+    bool result = _getTags(map, size, cameraFeedback);
+    file.unmap(map);
+
+    return result;
+}
+
+bool PX4LogParser::_getTags(const uchar* log, qint64 size, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback)
+{
+    // Record length of each message type, 0 until the FORMAT record for the type has been read
+    int lengths[256];
+    memset(lengths, 0, sizeof(lengths));
+    lengths[formatMsgType] = formatLength;
+
+    int                 gposType = -1;
+    int                 triggerType = -1;
+    QVector<Field_t>    gposFields;     // Lat, Lon, Alt
+    QVector<Field_t>    triggerFields;  // T, Seq
+
+    QList<GeoTagWorker::cameraFeedbackPacket> pendingTriggers;  // Triggers waiting for the next position
+    int     sequence = -1;
+    qint64  skippedBytes = 0;
+    qint64  pos = 0;
+
+    while (pos + headerLength <= size) {
+        const uchar*    record = log + pos;
+        int             length = (record[0] == headByte1 && record[1] == headByte2) ? lengths[record[2]] : 0;
 
-        GeoTagWorker::cameraFeedbackPacket feedback;
-        memset(&feedback, 0, sizeof(feedback));
+        // Only accepted as a record when the next record starts right after it. Otherwise this is corrupted data which
+        // happens to look like a record header.
+        if (length < headerLength || pos + length > size ||
+                (pos + length + 2 <= size && (record[length] != headByte1 || record[length + 1] != headByte2))) {
+            const void* next = memchr(record + 1, headByte1, size - pos - 1);
+            qint64      nextPos = next ? static_cast<const uchar*>(next) - log : size;
 
-        uint64_t* time = reinterpret_cast<uint64_t*>(log.mid(index + triggerOffsets[0], triggerLengths[0]).data());
-        double timeDouble = static_cast<double>(qFromLittleEndian(*time)) / 1.0e6;
-        uint32_t* seq = reinterpret_cast<uint32_t*>(log.mid(index + triggerOffsets[1], triggerLengths[1]).data());
-        int seqInt = static_cast<int>(qFromLittleEndian(*seq));
-        if (sequence >= seqInt || sequence + 20 < seqInt) { // assume that logging has not skipped more than 20 triggers. this prevents wrong header detection
+            skippedBytes += nextPos - pos;
+            pos = nextPos;
             continue;
         }
-        feedback.timestamp = timeDouble;
-        feedback.imageSequence = seqInt;
-        sequence = seqInt;
-
-        // second extract position
-        bool lookForGpos = true;
-        while (lookForGpos) {
-
-            int gposIndex = log.indexOf(gposHeader, index + 1);
-            if (gposIndex < 0) {
-                cameraFeedback.append(feedback);
-                break;
+
+        int type = record[2];
+        if (type == formatMsgType) {
+            int         formatType = record[3];
+            const char* name = reinterpret_cast<const char*>(record + 5);
+            QByteArray  formatName(name, qstrnlen(name, 4));
+
+            if (formatType != formatMsgType) {
+                lengths[formatType] = record[4];
+            }
+            if (formatName == "GPOS") {
+                gposType = formatType;
+                _fieldsFromFormat(record, QStringList() << "Lat" << "Lon" << "Alt", gposFields);
+            } else if (formatName == "TRIG") {
+                triggerType = formatType;
+                _fieldsFromFormat(record, QStringList() << "T" << "Seq", triggerFields);
             }
-            index = gposIndex;
-
-            // verify that at an offset of gposHeaderOffset the next log message starts
-            if (gposIndex + gposHeaderOffset == log.indexOf(header, gposIndex + 1)) {
-                int32_t* lat = reinterpret_cast<int32_t*>(log.mid(gposIndex + gposOffsets[0], gposLengths[0]).data());
-                feedback.latitude = static_cast<double>(qFromLittleEndian(*lat))/1.0e7;
-                int32_t* lon = reinterpret_cast<int32_t*>(log.mid(gposIndex + gposOffsets[1], gposLengths[1]).data());
-                feedback.longitude = static_cast<double>(qFromLittleEndian(*lon))/1.0e7;
-                feedback.longitude = fmod(180.0 + feedback.longitude, 360.0) - 180.0;
-                float* alt = reinterpret_cast<float*>(log.mid(gposIndex + gposOffsets[2], gposLengths[2]).data());
-                feedback.altitude = qFromLittleEndian(*alt);
-                cameraFeedback.append(feedback);
-                break;
+
+        } else if (type == triggerType) {
+            int seq = static_cast<int>(_fieldValue(record, triggerFields[1]));
+
+            // assume that logging has not skipped more than 20 triggers. this prevents using a corrupted record
+            if (sequence < seq && seq <= sequence + 20) {
+                GeoTagWorker::cameraFeedbackPacket feedback;
+                memset(&feedback, 0, sizeof(feedback));
+
+                feedback.timestamp = _fieldValue(record, triggerFields[0]) / 1.0e6;
+                feedback.imageSequence = seq;
+                pendingTriggers.append(feedback);
+                sequence = seq;
             }
+
+        } else if (type == gposType && !pendingTriggers.isEmpty()) {
+            double latitude = _fieldValue(record, gposFields[0]);
+            double longitude = fmod(180.0 + _fieldValue(record, gposFields[1]), 360.0) - 180.0;
+            double altitude = _fieldValue(record, gposFields[2]);
+
+            for (int i=0; i<pendingTriggers.count(); i++) {
+                GeoTagWorker::cameraFeedbackPacket& feedback = pendingTriggers[i];
+                feedback.latitude = latitude;
+                feedback.longitude = longitude;
+                feedback.altitude = altitude;
+            }
+            cameraFeedback.append(pendingTriggers);
+            pendingTriggers.clear();
         }
+
+        pos += length;
+    }
+
+    // Triggers after the last position are kept without one
+    cameraFeedback.append(pendingTriggers);
+
+    if (skippedBytes) {
+        qCDebug(GeotaggingLog) << "Skipped corrupted bytes in PX4 log" << skippedBytes;
+    }
+
+    if (triggerType == -1 || cameraFeedback.isEmpty()) {
+        qWarning() << "Could not detect geotag packets in PX4 log";
+        return false;
     }
 
     return true;
 }
+
+/// Finds the fields with the specified labels in a FORMAT record
+///     @param fields Filled with a field for each label, offset is -1 for labels which are not in the format
+void PX4LogParser::_fieldsFromFormat(const uchar* formatRecord, const QStringList& labels, QVector<Field_t>& fields)
+{
+    const char* format = reinterpret_cast<const char*>(formatRecord + 9);
+    const char* formatLabels = reinterpret_cast<const char*>(formatRecord + 25);
+    int         recordLength = formatRecord[4];
+    QByteArray  types(format, qstrnlen(format, 16));
+    QStringList names = QString::fromLatin1(formatLabels, qstrnlen(formatLabels, 64)).split(',');
+
+    Field_t missingField = { -1, 0 };
+    fields.fill(missingField, labels.count());
+
+    int offset = headerLength;
+    for (int i=0; i<types.count(); i++) {
+        int typeSize = _typeSize(types[i]);
+        if (typeSize == 0) {
+            qWarning() << "Unknown field type in PX4 log format" << types[i];
+            break;
+        }
+
+        int labelIndex = i < names.count() ? labels.indexOf(names[i]) : -1;
+        if (labelIndex != -1 && offset + typeSize <= recordLength) {
+            fields[labelIndex].offset = offset;
+            fields[labelIndex].type = types[i];
+        }
+        offset += typeSize;
+    }
+}
+
+/// @return Size of an sdlog2 format character, 0 for an unknown type
+int PX4LogParser::_typeSize(char type)
+{
+    switch (type) {
+    case 'b':
+    case 'B':
+    case 'M':
+        return 1;
+    case 'h':
+    case 'H':
+    case 'c':
+    case 'C':
+        return 2;
+    case 'i':
+    case 'I':
+    case 'e':
+    case 'E':
+    case 'L':
+    case 'f':
+    case 'n':
+        return 4;
+    case 'q':
+    case 'Q':
+    case 'd':
+        return 8;
+    case 'N':
+        return 16;
+    case 'Z':
+        return 64;
+    default:
+        return 0;
+    }
+}
+
+/// @return Field value with the scaling of its format character applied, 0 for missing and text fields
+double PX4LogParser::_fieldValue(const uchar* record, const Field_t& field)
+{
+    if (field.offset < 0) {
+        return 0;
+    }
+
+    const uchar* value = record + field.offset;
+
+    switch (field.type) {
+    case 'b':
+        return static_cast<qint8>(value[0]);
+    case 'B':
+    case 'M':
+        return value[0];
+    case 'h':
+        return qFromLittleEndian<qint16>(value);
+    case 'H':
+        return qFromLittleEndian<quint16>(value);
+    case 'c':
+        return qFromLittleEndian<qint16>(value) / 100.0;
+    case 'C':
+        return qFromLittleEndian<quint16>(value) / 100.0;
+    case 'i':
+        return qFromLittleEndian<qint32>(value);
+    case 'I':
+        return qFromLittleEndian<quint32>(value);
+    case 'e':
+        return qFromLittleEndian<qint32>(value) / 100.0;
+    case 'E':
+        return qFromLittleEndian<quint32>(value) / 100.0;
+    case 'L':
+        return qFromLittleEndian<qint32>(value) / 1.0e7;
+    case 'q':
+        return static_cast<double>(qFromLittleEndian<qint64>(value));
+    case 'Q':
+        return static_cast<double>(qFromLittleEndian<quint64>(value));
+    case 'f':
+    {
+        quint32 bits = qFromLittleEndian<quint32>(value);
+        float   floatValue;
+        memcpy(&floatValue, &bits, sizeof(floatValue));
+        return floatValue;
+    }
+    case 'd':
+    {
+        quint64 bits = qFromLittleEndian<quint64>(value);
+        double  doubleValue;
+        memcpy(&doubleValue, &bits, sizeof(doubleValue));
+        return doubleValue;
+    }
+    default:
+        return 0;
+    }
+}
@@ -3,9 +3,14 @@
 
 #include <QGeoCoordinate>
 #include <QDebug>
+#include <QVector>
 
 #include "GeoTagController.h"
 
+/// Extracts camera trigger records and the positions following them from a PX4 sdlog2 (.px4log) log.
+///
+/// The log is walked record by record in a single pass. The length of each record type comes from the FORMAT records
+/// in the log, as does the location of the fields which are read from the GPOS and TRIG records.
 class PX4LogParser
 {
 public:
@@ -13,8 +18,27 @@ public:
     ~PX4LogParser();
     bool getTagsFromLog(QByteArray& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback);
 
+    /// Reads the tags from a memory mapped log file, without loading the whole file
+    bool getTagsFromLog(const QString& logFile, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback);
+
+    static const uchar  headByte1 =         0xA3;
+    static const uchar  headByte2 =         0x95;
+    static const uchar  formatMsgType =     0x80;
+    static const int    headerLength =      3;
+    static const int    formatLength =      89;     ///< Header, type, length, name[4], format[16], labels[64]
+
 private:
+    /// Location of a field within a record, type is the sdlog2 format character
+    typedef struct {
+        int     offset;     ///< Byte offset from the start of the record, -1 if the field is not in the format
+        char    type;
+    } Field_t;
+
+    bool _getTags(const uchar* log, qint64 size, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback);
 
+    static void     _fieldsFromFormat   (const uchar* formatRecord, const QStringList& labels, QVector<Field_t>& fields);
+    static int      _typeSize           (char type);
+    static double   _fieldValue         (const uchar* record, const Field_t& field);
 };
 
 #endif // PX4LOGPARSER_H
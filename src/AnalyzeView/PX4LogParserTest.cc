@@ -0,0 +1,338 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "PX4LogParserTest.h"
+#include "PX4LogParser.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTemporaryFile>
+#include <QtEndian>
+
+#include <cstring>
+#include <math.h>
+
+PX4LogParserTest::PX4LogParserTest(void)
+{
+
+}
+
+QByteArray PX4LogParserTest::_formatRecord(int type, int length, const char* name, const char* format, const char* labels)
+{
+    QByteArray record(PX4LogParser::formatLength, 0);
+
+    record[0] = (char)PX4LogParser::headByte1;
+    record[1] = (char)PX4LogParser::headByte2;
+    record[2] = (char)PX4LogParser::formatMsgType;
+    record[3] = (char)type;
+    record[4] = (char)length;
+    memcpy(record.data() + 5, name, qstrnlen(name, 4));
+    memcpy(record.data() + 9, format, qstrnlen(format, 16));
+    memcpy(record.data() + 25, labels, qstrnlen(labels, 64));
+
+    return record;
+}
+
+/// @return FORMAT records as sdlog2 writes them at the start of a log
+QByteArray PX4LogParserTest::_formatRecords(void)
+{
+    QByteArray formats;
+
+    formats.append(_formatRecord(PX4LogParser::formatMsgType, PX4LogParser::formatLength, "FMT", "BBnNZ", "Type,Length,Name,Format,Labels"));
+    formats.append(_formatRecord(_imuType, 39, "IMU", "fffffffff", "AccX,AccY,AccZ,GyroX,GyroY,GyroZ,MagX,MagY,MagZ"));
+    formats.append(_formatRecord(_gposType, 39, "GPOS", "LLfffffff", "Lat,Lon,Alt,VelN,VelE,VelD,EPH,EPV,TALT"));
+    formats.append(_formatRecord(_triggerType, 15, "TRIG", "QI", "T,Seq"));
+
+    return formats;
+}
+
+QByteArray PX4LogParserTest::_record(int type, const QByteArray& payload)
+{
+    QByteArray record;
+
+    record.append((char)PX4LogParser::headByte1);
+    record.append((char)PX4LogParser::headByte2);
+    record.append((char)type);
+    record.append(payload);
+
+    return record;
+}
+
+QByteArray PX4LogParserTest::_imuRecord(void)
+{
+    return _record(_imuType, QByteArray(36, 0));
+}
+
+QByteArray PX4LogParserTest::_gposRecord(double latitude, double longitude, float altitude)
+{
+    QByteArray  payload(36, 0);
+    uchar*      data = reinterpret_cast<uchar*>(payload.data());
+    quint32     bits;
+
+    qToLittleEndian<qint32>(qRound(latitude * 1.0e7), data);
+    qToLittleEndian<qint32>(qRound(longitude * 1.0e7), data + 4);
+    memcpy(&bits, &altitude, 4);
+    qToLittleEndian<quint32>(bits, data + 8);
+
+    return _record(_gposType, payload);
+}
+
+QByteArray PX4LogParserTest::_triggerRecord(quint32 seq, quint64 timestamp)
+{
+    QByteArray  payload(12, 0);
+    uchar*      data = reinterpret_cast<uchar*>(payload.data());
+
+    qToLittleEndian<quint64>(timestamp, data);
+    qToLittleEndian<quint32>(seq, data + 8);
+
+    return _record(_triggerType, payload);
+}
+
+/// @return Records of consecutive camera triggers, each followed by a number of IMU records and a position
+QByteArray PX4LogParserTest::_cycleRecords(int firstSeq, int cycleCount, int imuRecordsPerCycle)
+{
+    QByteArray records;
+
+    for (int i=0; i<cycleCount; i++) {
+        int seq = firstSeq + i;
+
+        records.append(_triggerRecord(seq, (seq + 1) * 1000000ULL));
+        for (int j=0; j<imuRecordsPerCycle; j++) {
+            records.append(_imuRecord());
+        }
+        records.append(_gposRecord(47.0 + (seq * 0.00001), 8.5, 400.0f + (seq % 1000)));
+    }
+
+    return records;
+}
+
+/// Reference copy of the search PX4LogParser used before the record walker, kept for the regression and timing tests
+void PX4LogParserTest::_previousParserTags(QByteArray& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback)
+{
+    char header[] = {(char)0xA3, (char)0x95, (char)0x00};
+    char gposHeaderHeader[] = {(char)0xA3, (char)0x95, (char)0x80, (char)0x10, (char)0x00};
+    char gposHeader[] = {(char)0xA3, (char)0x95, (char)0x10, (char)0x00};
+    char triggerHeaderHeader[] = {(char)0xA3, (char)0x95, (char)0x80, (char)0x37, (char)0x00};
+    char triggerHeader[] = {(char)0xA3, (char)0x95, (char)0x37, (char)0x00};
+
+    uint8_t* iptr = reinterpret_cast<uint8_t*>(log.mid(log.indexOf(gposHeaderHeader) + 4, 1).data());
+    int gposHeaderOffset = static_cast<int>(qFromLittleEndian(*iptr));
+    iptr = reinterpret_cast<uint8_t*>(log.mid(log.indexOf(triggerHeaderHeader) + 4, 1).data());
+    int triggerHeaderOffset = static_cast<int>(qFromLittleEndian(*iptr));
+
+    int index = 1;
+    int sequence = -1;
+    while(index < log.count() - 1) {
+        index = log.indexOf(triggerHeader, index + 1);
+        if (index < 0) {
+            break;
+        }
+        if (log.indexOf(header, index + 1) != index + triggerHeaderOffset) {
+            continue;
+        }
+
+        GeoTagWorker::cameraFeedbackPacket feedback;
+        memset(&feedback, 0, sizeof(feedback));
+
+        uint64_t* time = reinterpret_cast<uint64_t*>(log.mid(index + 3, 8).data());
+        double timeDouble = static_cast<double>(qFromLittleEndian(*time)) / 1.0e6;
+        uint32_t* seq = reinterpret_cast<uint32_t*>(log.mid(index + 11, 4).data());
+        int seqInt = static_cast<int>(qFromLittleEndian(*seq));
+        if (sequence >= seqInt || sequence + 20 < seqInt) {
+            continue;
+        }
+        feedback.timestamp = timeDouble;
+        feedback.imageSequence = seqInt;
+        sequence = seqInt;
+
+        while (true) {
+            int gposIndex = log.indexOf(gposHeader, index + 1);
+            if (gposIndex < 0) {
+                cameraFeedback.append(feedback);
+                break;
+            }
+            index = gposIndex;
+
+            if (gposIndex + gposHeaderOffset == log.indexOf(header, gposIndex + 1)) {
+                int32_t* lat = reinterpret_cast<int32_t*>(log.mid(gposIndex + 3, 4).data());
+                feedback.latitude = static_cast<double>(qFromLittleEndian(*lat))/1.0e7;
+                int32_t* lon = reinterpret_cast<int32_t*>(log.mid(gposIndex + 7, 4).data());
+                feedback.longitude = static_cast<double>(qFromLittleEndian(*lon))/1.0e7;
+                feedback.longitude = fmod(180.0 + feedback.longitude, 360.0) - 180.0;
+                float* alt = reinterpret_cast<float*>(log.mid(gposIndex + 11, 4).data());
+                feedback.altitude = qFromLittleEndian(*alt);
+                cameraFeedback.append(feedback);
+                break;
+            }
+        }
+    }
+}
+
+void PX4LogParserTest::_walkTest(void)
+{
+    QByteArray log = _formatRecords();
+
+    // Position before the first trigger is not used
+    log.append(_gposRecord(47.0, 8.0, 400.0f));
+    log.append(_triggerRecord(0, 1000000));
+
+    // Record data which looks like trigger and position headers
+    QByteArray imuRecord = _imuRecord();
+    imuRecord.replace(3, 3, QByteArray("\xA3\x95\x37", 3));
+    imuRecord.replace(20, 3, QByteArray("\xA3\x95\x10", 3));
+    log.append(imuRecord);
+
+    log.append(_gposRecord(47.1, 8.1, 401.0f));
+
+    // Both triggers get the next position
+    log.append(_triggerRecord(1, 2000000));
+    log.append(_triggerRecord(2, 3000000));
+
+    // Corrupted data starting with a trigger header
+    log.append(QByteArray("\xA3\x95\x37", 3));
+    log.append(QByteArray(20, 0x11));
+
+    log.append(_gposRecord(47.2, 8.2, 402.0f));
+
+    // Sequence jump which is too large to be real
+    log.append(_triggerRecord(40, 3500000));
+
+    log.append(_triggerRecord(3, 4000000));
+    log.append(_imuRecord());
+    log.append(_gposRecord(-47.3, 190.0, 403.0f));
+
+    // No position after the last trigger, followed by a truncated record
+    log.append(_triggerRecord(4, 5000000));
+    log.append(_gposRecord(47.4, 8.4, 404.0f).left(10));
+
+    QList<GeoTagWorker::cameraFeedbackPacket> feedback;
+    PX4LogParser parser;
+    QVERIFY(parser.getTagsFromLog(log, feedback));
+    QCOMPARE(feedback.count(), 5);
+
+    double latitudes[] =    { 47.1, 47.2, 47.2, -47.3, 0 };
+    double longitudes[] =   { 8.1, 8.2, 8.2, -170.0, 0 };
+    float altitudes[] =     { 401.0f, 402.0f, 402.0f, 403.0f, 0 };
+    for (int i=0; i<feedback.count(); i++) {
+        QCOMPARE(feedback[i].imageSequence, (uint32_t)i);
+        QCOMPARE(feedback[i].timestamp, i + 1.0);
+        QVERIFY(qAbs(feedback[i].latitude - latitudes[i]) < 1.0e-7);
+        QVERIFY(qAbs(feedback[i].longitude - longitudes[i]) < 1.0e-7);
+        QCOMPARE(feedback[i].altitude, altitudes[i]);
+    }
+
+    // Logs without triggers
+    QByteArray noTriggerLog = _formatRecords() + _gposRecord(47.0, 8.0, 400.0f);
+    QList<GeoTagWorker::cameraFeedbackPacket> noFeedback;
+    QVERIFY(!parser.getTagsFromLog(noTriggerLog, noFeedback));
+    QByteArray emptyLog;
+    QVERIFY(!parser.getTagsFromLog(emptyLog, noFeedback));
+    QCOMPARE(noFeedback.count(), 0);
+    QVERIFY(!parser.getTagsFromLog(QStringLiteral("/missing/file.px4log"), noFeedback));
+}
+
+/// Results for a well formed log match the previous parser, and reading the file matches reading the bytes
+void PX4LogParserTest::_regressionTest(void)
+{
+    const int   triggerCount = 1000;
+    QByteArray  log = _formatRecords() + _cycleRecords(0, triggerCount, 5) + _imuRecord();
+
+    QList<GeoTagWorker::cameraFeedbackPacket> previousFeedback;
+    _previousParserTags(log, previousFeedback);
+    QCOMPARE(previousFeedback.count(), triggerCount);
+
+    QTemporaryFile logFile;
+    QVERIFY(logFile.open());
+    QCOMPARE(logFile.write(log), (qint64)log.size());
+    logFile.close();
+
+    QList<GeoTagWorker::cameraFeedbackPacket> fileFeedback;
+    QList<GeoTagWorker::cameraFeedbackPacket> bytesFeedback;
+    PX4LogParser parser;
+    QVERIFY(parser.getTagsFromLog(logFile.fileName(), fileFeedback));
+    QVERIFY(parser.getTagsFromLog(log, bytesFeedback));
+    QCOMPARE(fileFeedback.count(), triggerCount);
+    QCOMPARE(bytesFeedback.count(), triggerCount);
+
+    for (int i=0; i<triggerCount; i++) {
+        QCOMPARE(fileFeedback[i].imageSequence, previousFeedback[i].imageSequence);
+        QCOMPARE(fileFeedback[i].timestamp, previousFeedback[i].timestamp);
+        QCOMPARE(fileFeedback[i].latitude, previousFeedback[i].latitude);
+        QCOMPARE(fileFeedback[i].longitude, previousFeedback[i].longitude);
+        QCOMPARE(fileFeedback[i].altitude, previousFeedback[i].altitude);
+
+        QCOMPARE(bytesFeedback[i].imageSequence, fileFeedback[i].imageSequence);
+        QCOMPARE(bytesFeedback[i].latitude, fileFeedback[i].latitude);
+    }
+}
+
+/// Timing of the record walker over a mapped log of a few hundred MB against loading the log and searching it the way
+/// PX4LogParser used to. Both have to find every trigger and the record walker has to be faster. Only runs when large
+/// benchmarks are enabled, see UnitTest::largeBenchmarksEnabled.
+void PX4LogParserTest::_benchmarkTest(void)
+{
+    if (!largeBenchmarksEnabled()) {
+        QSKIP("Set QGC_UNITTEST_BENCHMARKS to run the PX4 log benchmark");
+    }
+
+    const int   chunkCount = 256;
+    const int   cyclesPerChunk = 512;
+    const int   imuRecordsPerCycle = 50;
+    const int   triggerCount = chunkCount * cyclesPerChunk;
+
+    QTemporaryFile logFile;
+    QVERIFY(logFile.open());
+    QByteArray formats = _formatRecords();
+    QCOMPARE(logFile.write(formats), (qint64)formats.size());
+
+    // Same chunk of records is written repeatedly, with the trigger sequence numbers and times updated
+    QByteArray  chunk = _cycleRecords(0, cyclesPerChunk, imuRecordsPerCycle);
+    int         cycleSize = chunk.size() / cyclesPerChunk;
+    for (int i=0; i<chunkCount; i++) {
+        for (int j=0; j<cyclesPerChunk; j++) {
+            quint32 seq = (i * cyclesPerChunk) + j;
+            uchar*  trigger = reinterpret_cast<uchar*>(chunk.data()) + (j * cycleSize);
+
+            qToLittleEndian<quint64>((seq + 1) * 1000000ULL, trigger + 3);
+            qToLittleEndian<quint32>(seq, trigger + 11);
+        }
+        QCOMPARE(logFile.write(chunk), (qint64)chunk.size());
+    }
+    qint64 logSize = logFile.size();
+    logFile.close();
+
+    QElapsedTimer timer;
+    timer.start();
+    QList<GeoTagWorker::cameraFeedbackPacket> feedback;
+    PX4LogParser parser;
+    QVERIFY(parser.getTagsFromLog(logFile.fileName(), feedback));
+    qint64 walkerMsecs = timer.elapsed();
+
+    QCOMPARE(feedback.count(), triggerCount);
+    QCOMPARE(feedback.last().imageSequence, (uint32_t)(triggerCount - 1));
+    QCOMPARE(feedback.last().timestamp, (double)triggerCount);
+    QVERIFY(qAbs(feedback.last().latitude - 47.0 - ((cyclesPerChunk - 1) * 0.00001)) < 1.0e-7);
+
+    timer.start();
+    QFile file(logFile.fileName());
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QByteArray log = file.readAll();
+    file.close();
+    QList<GeoTagWorker::cameraFeedbackPacket> previousFeedback;
+    _previousParserTags(log, previousFeedback);
+    qint64 previousMsecs = timer.elapsed();
+
+    qDebug() << "PX4 log" << logSize / (1024 * 1024) << "MB:" << triggerCount << "triggers, record walker" << walkerMsecs
+             << "msecs, previous parser" << previousMsecs << "msecs for" << previousFeedback.count() << "triggers";
+
+    QCOMPARE(previousFeedback.count(), triggerCount);
+    QCOMPARE(previousFeedback.last().imageSequence, feedback.last().imageSequence);
+    QCOMPARE(previousFeedback.last().latitude, feedback.last().latitude);
+    QVERIFY(walkerMsecs < previousMsecs);
+}
@@ -0,0 +1,47 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#ifndef PX4LogParserTest_H
+#define PX4LogParserTest_H
+
+#include "UnitTest.h"
+#include "GeoTagController.h"
+
+#include <QByteArray>
+#include <QString>
+
+/// Unit test for the trigger and position extraction of PX4LogParser
+class PX4LogParserTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    PX4LogParserTest(void);
+
+private slots:
+    void _walkTest(void);
+    void _regressionTest(void);
+    void _benchmarkTest(void);
+
+private:
+    QByteArray  _formatRecord           (int type, int length, const char* name, const char* format, const char* labels);
+    QByteArray  _formatRecords          (void);
+    QByteArray  _record                 (int type, const QByteArray& payload);
+    QByteArray  _imuRecord              (void);
+    QByteArray  _gposRecord             (double latitude, double longitude, float altitude);
+    QByteArray  _triggerRecord          (quint32 seq, quint64 timestamp);
+    QByteArray  _cycleRecords           (int firstSeq, int cycleCount, int imuRecordsPerCycle);
+    void        _previousParserTags     (QByteArray& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback);
+
+    static const int _imuType =     0x04;
+    static const int _gposType =    0x10;
+    static const int _triggerType = 0x37;
+};
+
+#endif
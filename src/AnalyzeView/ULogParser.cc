@@ -12,171 +12,73 @@ ULogParser::~ULogParser()
 
 }
 
-int ULogParser::sizeOfType(QString& typeName)
+bool ULogParser::getTagsFromLog(QByteArray& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback)
 {
-    if (typeName == "int8_t" || typeName == "uint8_t") {
-        return 1;
-
-    } else if (typeName == "int16_t" || typeName == "uint16_t") {
-        return 2;
-
-    } else if (typeName == "int32_t" || typeName == "uint32_t") {
-        return 4;
-
-    } else if (typeName == "int64_t" || typeName == "uint64_t") {
-        return 8;
+    ULogReader reader;
 
-    } else if (typeName == "float") {
-        return 4;
-
-    } else if (typeName == "double") {
-        return 8;
-
-    } else if (typeName == "char" || typeName == "bool") {
-        return 1;
+    if (!reader.open(log)) {
+        qWarning() << reader.errorString();
+        return false;
     }
 
-    qWarning() << "Unkown type in ULog : " << typeName;
-    return 0;
+    return _getTags(reader, cameraFeedback);
 }
 
-int ULogParser::sizeOfFullType(QString& typeNameFull)
+bool ULogParser::getTagsFromLog(const QString& logFile, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback)
 {
-    int arraySize;
-    QString typeName = extractArraySize(typeNameFull, arraySize);
-    return sizeOfType(typeName) * arraySize;
-}
-
-QString ULogParser::extractArraySize(QString &typeNameFull, int &arraySize)
-{
-    int startPos = typeNameFull.indexOf('[');
-    int endPos = typeNameFull.indexOf(']');
+    ULogReader reader;
 
-    if (startPos == -1 || endPos == -1) {
-        arraySize = 1;
-        return typeNameFull;
+    if (!reader.open(logFile)) {
+        qWarning() << reader.errorString();
+        return false;
     }
 
-    arraySize = typeNameFull.mid(startPos + 1, endPos - startPos - 1).toInt();
-    return typeNameFull.mid(0, startPos);
+    return _getTags(reader, cameraFeedback);
 }
 
-bool ULogParser::parseFieldFormat(QString& fields)
+bool ULogParser::_getTags(ULogReader& reader, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback)
 {
-    int prevFieldEnd = 0;
-    int fieldEnd = fields.indexOf(';');
-    int offset = 0;
-
-    while (fieldEnd != -1) {
-        int spacePos = fields.indexOf(' ', prevFieldEnd);
-
-        if (spacePos != -1) {
-            QString typeNameFull = fields.mid(prevFieldEnd, spacePos - prevFieldEnd);
-            QString fieldName = fields.mid(spacePos + 1, fieldEnd - spacePos - 1);
+    const QString topicName("camera_capture");
+
+    // Completely dynamic parsing, so that changing/reordering the message format will not break the parser
+    ULogReader::Field_t timestampField =        reader.field(topicName, "timestamp");
+    ULogReader::Field_t timestampUTCField =     reader.field(topicName, "timestamp_utc");
+    ULogReader::Field_t seqField =              reader.field(topicName, "seq");
+    ULogReader::Field_t latField =              reader.field(topicName, "lat");
+    ULogReader::Field_t lonField =              reader.field(topicName, "lon");
+    ULogReader::Field_t altField =              reader.field(topicName, "alt");
+    ULogReader::Field_t groundDistanceField =   reader.field(topicName, "ground_distance");
+    ULogReader::Field_t qField =                reader.field(topicName, "q");
+    ULogReader::Field_t resultField =           reader.field(topicName, "result");
 
-            if (!fieldName.contains("_padding")) {
-                _cameraCaptureOffsets.insert(fieldName, offset);
-                offset += sizeOfFullType(typeNameFull);
-            }
-        }
-
-        prevFieldEnd = fieldEnd + 1;
-        fieldEnd = fields.indexOf(';', prevFieldEnd);
-    }
-    return false;
-}
-
-bool ULogParser::getTagsFromLog(QByteArray& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback)
-{
-    //verify it's an ULog file
-    if(!log.contains(_ULogMagic)) {
-        qWarning() << "Could not detect ULog file header magic";
-        return false;
-    }
-
-    int index = ULOG_FILE_HEADER_LEN;
     bool geotagFound = false;
 
-    while(index < log.count() - 1) {
-
-        ULogMessageHeader header;
-        memset(&header, 0, sizeof(header));
-        memcpy(&header, log.data() + index, ULOG_MSG_HEADER_LEN);
-
-        switch (header.msgType) {
-            case (int)ULogMessageType::FORMAT:
-            {
-                ULogMessageFormat format_msg;
-                memset(&format_msg, 0, sizeof(format_msg));
-                memcpy(&format_msg, log.data() + index, ULOG_MSG_HEADER_LEN + header.msgSize);
-
-                QString fmt(format_msg.format);
-                int posSeparator = fmt.indexOf(':');
-                QString messageName = fmt.left(posSeparator);
-                QString messageFields = fmt.mid(posSeparator + 1, header.msgSize - posSeparator - 1);
-
-                if(messageName == "camera_capture") {
-                    parseFieldFormat(messageFields);
-                }
-                break;
-            }
-
-            case (int)ULogMessageType::ADD_LOGGED_MSG:
-            {
-                ULogMessageAddLogged addLoggedMsg;
-                memset(&addLoggedMsg, 0, sizeof(addLoggedMsg));
-                memcpy(&addLoggedMsg, log.data() + index, ULOG_MSG_HEADER_LEN + header.msgSize);
-
-                QString messageName(addLoggedMsg.msgName);
-
-                if(messageName.contains("camera_capture")) {
-                    _cameraCaptureMsgID = addLoggedMsg.msgID;
-                    geotagFound = true;
-                }
-
-                break;
-            }
-
-            case (int)ULogMessageType::DATA:
-            {
-                if (!geotagFound) {
-                    qWarning() << "Could not detect geotag packets in ULog";
-                    return false;
-                }
-
-                uint16_t msgID = -1;
-                memcpy(&msgID, log.data() + index + ULOG_MSG_HEADER_LEN, 2);
-
-                if(msgID == _cameraCaptureMsgID) {
-
-                    // Completely dynamic parsing, so that changing/reordering the message format will not break the parser
-                    GeoTagWorker::cameraFeedbackPacket feedback;
-                    memset(&feedback, 0, sizeof(feedback));
-                    memcpy(&feedback.timestamp, log.data() + index + 5 + _cameraCaptureOffsets.value("timestamp"), 8);
-                    feedback.timestamp /= 1.0e6; // to seconds
-                    memcpy(&feedback.timestampUTC, log.data() + index + 5 + _cameraCaptureOffsets.value("timestamp_utc"), 8);
-                    feedback.timestampUTC /= 1.0e6; // to seconds
-                    memcpy(&feedback.imageSequence, log.data() + index + 5 + _cameraCaptureOffsets.value("seq"), 4);
-                    memcpy(&feedback.latitude, log.data() + index + 5 + _cameraCaptureOffsets.value("lat"), 8);
-                    memcpy(&feedback.longitude, log.data() + index + 5 + _cameraCaptureOffsets.value("lon"), 8);
-                    feedback.longitude = fmod(180.0 + feedback.longitude, 360.0) - 180.0;
-                    memcpy(&feedback.altitude, log.data() + index + 5 + _cameraCaptureOffsets.value("alt"), 4);
-                    memcpy(&feedback.groundDistance, log.data() + index + 5 + _cameraCaptureOffsets.value("ground_distance"), 4);
-                    memcpy(&feedback.captureResult, log.data() + index + 5 + _cameraCaptureOffsets.value("result"), 1);
-
-                    cameraFeedback.append(feedback);
-
-                }
-
-                break;
-            }
-
-            default:
-                break;
+    reader.read(QStringList(topicName), [&](int, int, const char* data, int size) {
+        GeoTagWorker::cameraFeedbackPacket feedback;
+        memset(&feedback, 0, sizeof(feedback));
+
+        feedback.timestamp = ULogReader::toUInt64(timestampField, data, size) / 1.0e6; // to seconds
+        feedback.timestampUTC = ULogReader::toUInt64(timestampUTCField, data, size) / 1.0e6; // to seconds
+        feedback.imageSequence = ULogReader::toUInt64(seqField, data, size);
+        feedback.latitude = ULogReader::toDouble(latField, data, size);
+        feedback.longitude = ULogReader::toDouble(lonField, data, size);
+        feedback.longitude = fmod(180.0 + feedback.longitude, 360.0) - 180.0;
+        feedback.altitude = ULogReader::toDouble(altField, data, size);
+        feedback.groundDistance = ULogReader::toDouble(groundDistanceField, data, size);
+        for (int i=0; i<4; i++) {
+            feedback.attitudeQuaternion[i] = ULogReader::toDouble(qField, data, size, i);
         }
+        feedback.captureResult = ULogReader::toInt64(resultField, data, size);
+
+        cameraFeedback.append(feedback);
+        geotagFound = true;
 
-        index += (3 + header.msgSize);
+        return true;
+    });
 
+    if (!geotagFound) {
+        qWarning() << "Could not detect geotag packets in ULog";
+        return false;
     }
 
     return true;
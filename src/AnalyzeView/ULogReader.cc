@@ -0,0 +1,428 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ULogReader.h"
+#include "QGCLoggingCategory.h"
+
+#include <QtEndian>
+#include <QVector>
+
+#include <cstring>
+
+QGC_LOGGING_CATEGORY(ULogReaderLog, "ULogReaderLog")
+
+const char ULogReader::_magic[] = { 'U', 'L', 'o', 'g', 0x01, 0x12, 0x35 };
+
+ULogReader::ULogReader(void)
+    : _map(NULL)
+    , _base(NULL)
+    , _size(0)
+    , _dataOffset(0)
+{
+
+}
+
+ULogReader::~ULogReader()
+{
+    close();
+}
+
+void ULogReader::close(void)
+{
+    if (_map) {
+        _file.unmap(_map);
+        _map = NULL;
+    }
+    if (_file.isOpen()) {
+        _file.close();
+    }
+    _data.clear();
+    _base = NULL;
+    _size = 0;
+    _dataOffset = 0;
+    _formats.clear();
+}
+
+bool ULogReader::open(const QString& fileName)
+{
+    close();
+    _errorString.clear();
+
+    _file.setFileName(fileName);
+    if (!_file.open(QIODevice::ReadOnly)) {
+        _errorString = QStringLiteral("Unable to open log file: %1").arg(_file.errorString());
+        return false;
+    }
+
+    _size = _file.size();
+    _map = _size > 0 ? _file.map(0, _size) : NULL;
+    _base = reinterpret_cast<const char*>(_map);
+    if (!_map) {
+        // Mapping not supported on this platform/file system, fall back to reading it
+        qCDebug(ULogReaderLog) << "Unable to map log, reading it instead" << fileName;
+        _data = _file.readAll();
+        _file.close();
+        _base = _data.constData();
+        _size = _data.size();
+    }
+
+    if (!_parseDefinitions()) {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+bool ULogReader::open(const QByteArray& bytes)
+{
+    close();
+    _errorString.clear();
+
+    _data = bytes;
+    _base = _data.constData();
+    _size = _data.size();
+
+    if (!_parseDefinitions()) {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+/// Parses the FORMAT messages in the definitions section and resolves the field locations for all topics
+bool ULogReader::_parseDefinitions(void)
+{
+    if (_size < fileHeaderLength || memcmp(_base, _magic, sizeof(_magic)) != 0) {
+        _errorString = QStringLiteral("Could not detect ULog file header magic");
+        return false;
+    }
+
+    QHash<QString, QString> formatStrings;
+    qint64                  pos = fileHeaderLength;
+
+    while (pos + messageHeaderLength <= _size) {
+        int         msgSize = qFromLittleEndian<quint16>(reinterpret_cast<const uchar*>(_base + pos));
+        char        msgType = _base[pos + 2];
+        const char* payload = _base + pos + messageHeaderLength;
+
+        if (pos + messageHeaderLength + msgSize > _size) {
+            break;
+        }
+
+        // The data section starts with the first message which is not a definition
+        if (msgType != 'F' && msgType != 'I' && msgType != 'M' && msgType != 'P' && msgType != 'B' && msgType != 'Q') {
+            break;
+        }
+
+        if (msgType == 'F') {
+            QString format = QString::fromLatin1(payload, qstrnlen(payload, msgSize));
+            int     separator = format.indexOf(':');
+            if (separator > 0) {
+                formatStrings[format.left(separator)] = format.mid(separator + 1);
+            }
+        }
+
+        pos += messageHeaderLength + msgSize;
+    }
+    _dataOffset = pos;
+
+    foreach (const QString& topicName, formatStrings.keys()) {
+        QStringList compiling;
+        if (!_compileFormat(topicName, formatStrings, compiling)) {
+            qCWarning(ULogReaderLog) << "Unable to resolve format" << topicName;
+        }
+    }
+
+    qCDebug(ULogReaderLog) << "Formats:data offset" << _formats.count() << _dataOffset;
+    return true;
+}
+
+/// Resolves the field locations of a topic format, first resolving the formats of any nested types it uses
+///     @param compiling Formats currently being resolved, to detect recursive definitions
+bool ULogReader::_compileFormat(const QString& topicName, QHash<QString, QString>& formatStrings, QStringList& compiling)
+{
+    if (_formats.contains(topicName)) {
+        return true;
+    }
+    if (!formatStrings.contains(topicName) || compiling.contains(topicName)) {
+        return false;
+    }
+    compiling.append(topicName);
+
+    Format_t    format;
+    int         offset = 0;
+
+    format.size = 0;
+    foreach (const QString& fieldDefinition, formatStrings[topicName].split(';', QString::SkipEmptyParts)) {
+        int spacePos = fieldDefinition.indexOf(' ');
+        if (spacePos == -1) {
+            continue;
+        }
+        QString typeName = fieldDefinition.left(spacePos);
+        QString fieldName = fieldDefinition.mid(spacePos + 1);
+
+        Field_t field;
+        field.offset = offset;
+        field.arraySize = 1;
+
+        int bracketPos = typeName.indexOf('[');
+        if (bracketPos != -1) {
+            field.arraySize = typeName.mid(bracketPos + 1, typeName.indexOf(']') - bracketPos - 1).toInt();
+            typeName = typeName.left(bracketPos);
+        }
+
+        int elementSize;
+        field.type = _fieldType(typeName);
+        if (field.type == FieldTypeInvalid) {
+            if (!_compileFormat(typeName, formatStrings, compiling)) {
+                qCWarning(ULogReaderLog) << "Unknown type in ULog" << typeName << "for" << topicName;
+                return false;
+            }
+            field.type = FieldTypeNested;
+            elementSize = _formats[typeName].size;
+        } else {
+            elementSize = _typeSize(field.type);
+        }
+
+        offset += elementSize * field.arraySize;
+        if (!fieldName.startsWith(QStringLiteral("_padding"))) {
+            format.fields[fieldName] = field;
+        }
+    }
+    format.size = offset;
+
+    _formats[topicName] = format;
+    compiling.removeOne(topicName);
+
+    return true;
+}
+
+int ULogReader::topicSize(const QString& topicName) const
+{
+    return _formats.contains(topicName) ? _formats[topicName].size : -1;
+}
+
+ULogReader::Field_t ULogReader::field(const QString& topicName, const QString& fieldName) const
+{
+    Field_t field;
+
+    field.type = FieldTypeInvalid;
+    field.offset = 0;
+    field.arraySize = 0;
+
+    if (_formats.contains(topicName)) {
+        field = _formats[topicName].fields.value(fieldName, field);
+    }
+
+    return field;
+}
+
+bool ULogReader::read(const QStringList& topicNames, const RecordHandler_t& handler, const QAtomicInt* cancel)
+{
+    if (!_base) {
+        return false;
+    }
+
+    // Topic index and instance for each message id, assigned by the ADD_LOGGED_MSG messages
+    QVector<int>    topicIndices(0x10000, -1);
+    QVector<int>    multiIds(0x10000, 0);
+    qint64          pos = _dataOffset;
+    int             messageCount = 0;
+
+    while (pos + messageHeaderLength <= _size) {
+        int         msgSize = qFromLittleEndian<quint16>(reinterpret_cast<const uchar*>(_base + pos));
+        char        msgType = _base[pos + 2];
+        const char* payload = _base + pos + messageHeaderLength;
+
+        if (pos + messageHeaderLength + msgSize > _size) {
+            qCDebug(ULogReaderLog) << "Truncated message at end of log" << pos;
+            break;
+        }
+
+        switch (msgType) {
+        case 'D':
+            if (msgSize >= 2) {
+                quint16 msgId = qFromLittleEndian<quint16>(reinterpret_cast<const uchar*>(payload));
+                int     topicIndex = topicIndices[msgId];
+                if (topicIndex != -1 && !handler(topicIndex, multiIds[msgId], payload + 2, msgSize - 2)) {
+                    return true;
+                }
+            }
+            break;
+
+        case 'A':
+            if (msgSize > 3) {
+                quint16 msgId = qFromLittleEndian<quint16>(reinterpret_cast<const uchar*>(payload + 1));
+                QString topicName = QString::fromLatin1(payload + 3, qstrnlen(payload + 3, msgSize - 3));
+
+                topicIndices[msgId] = topicNames.indexOf(topicName);
+                multiIds[msgId] = (uchar)payload[0];
+            }
+            break;
+
+        case 'R':
+            if (msgSize >= 2) {
+                topicIndices[qFromLittleEndian<quint16>(reinterpret_cast<const uchar*>(payload))] = -1;
+            }
+            break;
+
+        default:
+            break;
+        }
+
+        pos += messageHeaderLength + msgSize;
+
+        if (cancel && ++messageCount == _cancelCheckInterval) {
+            messageCount = 0;
+            if (cancel->load()) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+ULogReader::FieldType ULogReader::_fieldType(const QString& typeName)
+{
+    static const struct {
+        const char* name;
+        FieldType   type;
+    } types[] = {
+        { "int8_t",     FieldTypeInt8 },
+        { "uint8_t",    FieldTypeUInt8 },
+        { "int16_t",    FieldTypeInt16 },
+        { "uint16_t",   FieldTypeUInt16 },
+        { "int32_t",    FieldTypeInt32 },
+        { "uint32_t",   FieldTypeUInt32 },
+        { "int64_t",    FieldTypeInt64 },
+        { "uint64_t",   FieldTypeUInt64 },
+        { "float",      FieldTypeFloat },
+        { "double",     FieldTypeDouble },
+        { "bool",       FieldTypeBool },
+        { "char",       FieldTypeChar },
+    };
+
+    for (size_t i=0; i<sizeof(types)/sizeof(types[0]); i++) {
+        if (typeName == QLatin1String(types[i].name)) {
+            return types[i].type;
+        }
+    }
+
+    return FieldTypeInvalid;
+}
+
+int ULogReader::_typeSize(FieldType type)
+{
+    switch (type) {
+    case FieldTypeInt8:
+    case FieldTypeUInt8:
+    case FieldTypeBool:
+    case FieldTypeChar:
+        return 1;
+    case FieldTypeInt16:
+    case FieldTypeUInt16:
+        return 2;
+    case FieldTypeInt32:
+    case FieldTypeUInt32:
+    case FieldTypeFloat:
+        return 4;
+    case FieldTypeInt64:
+    case FieldTypeUInt64:
+    case FieldTypeDouble:
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+/// @return Start of the array element within the record, NULL if it can't be read as a number
+const uchar* ULogReader::_element(const Field_t& field, const char* data, int size, int arrayIndex)
+{
+    int elementSize = _typeSize(field.type);
+    int offset = field.offset + (arrayIndex * elementSize);
+
+    if (elementSize == 0 || arrayIndex < 0 || arrayIndex >= field.arraySize || offset + elementSize > size) {
+        return NULL;
+    }
+
+    return reinterpret_cast<const uchar*>(data + offset);
+}
+
+double ULogReader::toDouble(const Field_t& field, const char* data, int size, int arrayIndex)
+{
+    const uchar* element = _element(field, data, size, arrayIndex);
+
+    if (element) {
+        if (field.type == FieldTypeFloat) {
+            quint32 bits = qFromLittleEndian<quint32>(element);
+            float   value;
+            memcpy(&value, &bits, sizeof(value));
+            return value;
+        } else if (field.type == FieldTypeDouble) {
+            quint64 bits = qFromLittleEndian<quint64>(element);
+            double  value;
+            memcpy(&value, &bits, sizeof(value));
+            return value;
+        } else if (field.type == FieldTypeUInt64) {
+            return (double)toUInt64(field, data, size, arrayIndex);
+        }
+        return (double)toInt64(field, data, size, arrayIndex);
+    }
+
+    return 0;
+}
+
+qint64 ULogReader::toInt64(const Field_t& field, const char* data, int size, int arrayIndex)
+{
+    const uchar* element = _element(field, data, size, arrayIndex);
+
+    if (element) {
+        switch (field.type) {
+        case FieldTypeInt8:
+            return (qint8)element[0];
+        case FieldTypeUInt8:
+        case FieldTypeBool:
+        case FieldTypeChar:
+            return element[0];
+        case FieldTypeInt16:
+            return qFromLittleEndian<qint16>(element);
+        case FieldTypeUInt16:
+            return qFromLittleEndian<quint16>(element);
+        case FieldTypeInt32:
+            return qFromLittleEndian<qint32>(element);
+        case FieldTypeUInt32:
+            return qFromLittleEndian<quint32>(element);
+        case FieldTypeInt64:
+            return qFromLittleEndian<qint64>(element);
+        case FieldTypeUInt64:
+            return (qint64)qFromLittleEndian<quint64>(element);
+        case FieldTypeFloat:
+        case FieldTypeDouble:
+            return (qint64)toDouble(field, data, size, arrayIndex);
+        default:
+            break;
+        }
+    }
+
+    return 0;
+}
+
+quint64 ULogReader::toUInt64(const Field_t& field, const char* data, int size, int arrayIndex)
+{
+    const uchar* element = _element(field, data, size, arrayIndex);
+
+    if (element && field.type == FieldTypeUInt64) {
+        return qFromLittleEndian<quint64>(element);
+    }
+
+    return (quint64)toInt64(field, data, size, arrayIndex);
+}
@@ -0,0 +1,129 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#ifndef ULogReader_H
+#define ULogReader_H
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QLoggingCategory>
+#include <QString>
+#include <QStringList>
+
+#include <functional>
+
+Q_DECLARE_LOGGING_CATEGORY(ULogReaderLog)
+
+/// Reads topics from a ULog file without loading the file into memory.
+///
+/// The file is memory mapped. Opening it only parses the definitions section at the start of the file, which holds
+/// the FORMAT message of each topic. From those the location of every field within a data record is resolved once,
+/// so reading a field from a record is a bounds check and a load. read then passes over the data section a single
+/// time and hands each data record of the requested topics to the caller as a pointer into the mapped file.
+class ULogReader
+{
+public:
+    ULogReader(void);
+    ~ULogReader();
+
+    enum FieldType {
+        FieldTypeInvalid,
+        FieldTypeInt8,
+        FieldTypeUInt8,
+        FieldTypeInt16,
+        FieldTypeUInt16,
+        FieldTypeInt32,
+        FieldTypeUInt32,
+        FieldTypeInt64,
+        FieldTypeUInt64,
+        FieldTypeFloat,
+        FieldTypeDouble,
+        FieldTypeBool,
+        FieldTypeChar,
+        FieldTypeNested,    ///< Field is another topic format, its own fields are not accessible
+    };
+
+    /// Location of a field within the data records of a topic
+    typedef struct {
+        FieldType   type;
+        int         offset;     ///< Byte offset from the start of the record data
+        int         arraySize;  ///< Number of elements, 1 for non array fields
+    } Field_t;
+
+    /// Called for each data record of the topics being read.
+    ///     @param topicIndex Index of the topic within the list passed to read
+    ///     @param multiId Instance of the topic
+    ///     @param data Record data following the message id. Only valid during the call.
+    ///     @param size Size of the record data
+    /// @return false: stop reading
+    typedef std::function<bool(int topicIndex, int multiId, const char* data, int size)> RecordHandler_t;
+
+    /// Opens the file and parses the topic formats
+    bool open(const QString& fileName);
+
+    /// Uses a log which is already in memory
+    bool open(const QByteArray& bytes);
+
+    void close(void);
+
+    QString errorString (void) const { return _errorString; }
+    qint64  size        (void) const { return _size; }
+    bool    isMapped    (void) const { return _map != NULL; }
+
+    /// @return Names of all topics with a format in the log
+    QStringList topics(void) const { return _formats.keys(); }
+
+    /// @return Size of a data record of the topic, -1 if the topic has no format in the log
+    int topicSize(const QString& topicName) const;
+
+    /// @return Accessor for the field, type is FieldTypeInvalid if the topic or field is not in the log
+    Field_t field(const QString& topicName, const QString& fieldName) const;
+
+    /// Passes all data records of the specified topics to the handler, in the order they are in the log
+    ///     @param cancel Stops reading when set to a non zero value, can be NULL
+    /// @return false: not open or cancelled
+    bool read(const QStringList& topicNames, const RecordHandler_t& handler, const QAtomicInt* cancel = NULL);
+
+    /// Field values converted to the return type. 0 if the field is invalid, not numeric or outside of the record.
+    static double   toDouble    (const Field_t& field, const char* data, int size, int arrayIndex = 0);
+    static qint64   toInt64     (const Field_t& field, const char* data, int size, int arrayIndex = 0);
+    static quint64  toUInt64    (const Field_t& field, const char* data, int size, int arrayIndex = 0);
+
+    static const int fileHeaderLength = 16;
+    static const int messageHeaderLength = 3;
+
+private:
+    typedef struct {
+        int                     size;
+        QHash<QString, Field_t> fields;
+    } Format_t;
+
+    bool _parseDefinitions  (void);
+    bool _compileFormat     (const QString& topicName, QHash<QString, QString>& formatStrings, QStringList& compiling);
+
+    static FieldType    _fieldType  (const QString& typeName);
+    static int          _typeSize   (FieldType type);
+    static const uchar* _element    (const Field_t& field, const char* data, int size, int arrayIndex);
+
+    QFile                       _file;
+    uchar*                      _map;           ///< Memory mapped log, NULL if not mapped
+    QByteArray                  _data;          ///< Used when the log does not come from a memory mapped file
+    const char*                 _base;          ///< Start of log
+    qint64                      _size;          ///< Size of log
+    qint64                      _dataOffset;    ///< Start of the data section
+    QHash<QString, Format_t>    _formats;       ///< Key: topic name
+    QString                     _errorString;
+
+    static const char   _magic[];
+    static const int    _cancelCheckInterval = 0x10000; ///< Messages between checks of the cancel flag
+};
+
+#endif
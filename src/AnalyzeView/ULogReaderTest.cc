@@ -0,0 +1,573 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ULogReaderTest.h"
+#include "ULogReader.h"
+#include "ULogParser.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMap>
+#include <QTemporaryFile>
+#include <QtEndian>
+
+#include <cstring>
+#include <math.h>
+
+const char* ULogReaderTest::_cameraCaptureFormat = "camera_capture:uint64_t timestamp;uint64_t timestamp_utc;double lat;double lon;float alt;float ground_distance;float[4] q;uint32_t seq;int8_t result;uint8_t[3] _padding0;";
+
+/// ULogParser as it was before ULogReader, moved into the test without its logging. The benchmark checks ULogParser
+/// against it. It needs the whole log in memory and looks up the field offsets by name for each record.
+class BaselineULogParser
+{
+public:
+    BaselineULogParser() : _cameraCaptureMsgID(-1) { }
+
+    bool getTagsFromLog(QByteArray& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback)
+    {
+        //verify it's an ULog file
+        if(!log.contains(_ULogMagic)) {
+            return false;
+        }
+
+        int index = ULogReader::fileHeaderLength;
+        bool geotagFound = false;
+
+        while(index < log.count() - 1) {
+
+            ULogMessageHeader header;
+            memset(&header, 0, sizeof(header));
+            memcpy(&header, log.data() + index, ULOG_MSG_HEADER_LEN);
+
+            switch (header.msgType) {
+                case (int)ULogMessageType::FORMAT:
+                {
+                    ULogMessageFormat format_msg;
+                    memset(&format_msg, 0, sizeof(format_msg));
+                    memcpy(&format_msg, log.data() + index, ULOG_MSG_HEADER_LEN + header.msgSize);
+
+                    QString fmt(format_msg.format);
+                    int posSeparator = fmt.indexOf(':');
+                    QString messageName = fmt.left(posSeparator);
+                    QString messageFields = fmt.mid(posSeparator + 1, header.msgSize - posSeparator - 1);
+
+                    if(messageName == "camera_capture") {
+                        parseFieldFormat(messageFields);
+                    }
+                    break;
+                }
+
+                case (int)ULogMessageType::ADD_LOGGED_MSG:
+                {
+                    ULogMessageAddLogged addLoggedMsg;
+                    memset(&addLoggedMsg, 0, sizeof(addLoggedMsg));
+                    memcpy(&addLoggedMsg, log.data() + index, ULOG_MSG_HEADER_LEN + header.msgSize);
+
+                    QString messageName(addLoggedMsg.msgName);
+
+                    if(messageName.contains("camera_capture")) {
+                        _cameraCaptureMsgID = addLoggedMsg.msgID;
+                        geotagFound = true;
+                    }
+
+                    break;
+                }
+
+                case (int)ULogMessageType::DATA:
+                {
+                    if (!geotagFound) {
+                        return false;
+                    }
+
+                    uint16_t msgID = -1;
+                    memcpy(&msgID, log.data() + index + ULOG_MSG_HEADER_LEN, 2);
+
+                    if(msgID == _cameraCaptureMsgID) {
+
+                        // Completely dynamic parsing, so that changing/reordering the message format will not break the parser
+                        GeoTagWorker::cameraFeedbackPacket feedback;
+                        memset(&feedback, 0, sizeof(feedback));
+                        memcpy(&feedback.timestamp, log.data() + index + 5 + _cameraCaptureOffsets.value("timestamp"), 8);
+                        feedback.timestamp /= 1.0e6; // to seconds
+                        memcpy(&feedback.timestampUTC, log.data() + index + 5 + _cameraCaptureOffsets.value("timestamp_utc"), 8);
+                        feedback.timestampUTC /= 1.0e6; // to seconds
+                        memcpy(&feedback.imageSequence, log.data() + index + 5 + _cameraCaptureOffsets.value("seq"), 4);
+                        memcpy(&feedback.latitude, log.data() + index + 5 + _cameraCaptureOffsets.value("lat"), 8);
+                        memcpy(&feedback.longitude, log.data() + index + 5 + _cameraCaptureOffsets.value("lon"), 8);
+                        feedback.longitude = fmod(180.0 + feedback.longitude, 360.0) - 180.0;
+                        memcpy(&feedback.altitude, log.data() + index + 5 + _cameraCaptureOffsets.value("alt"), 4);
+                        memcpy(&feedback.groundDistance, log.data() + index + 5 + _cameraCaptureOffsets.value("ground_distance"), 4);
+                        memcpy(&feedback.captureResult, log.data() + index + 5 + _cameraCaptureOffsets.value("result"), 1);
+
+                        cameraFeedback.append(feedback);
+
+                    }
+
+                    break;
+                }
+
+                default:
+                    break;
+            }
+
+            index += (3 + header.msgSize);
+
+        }
+
+        return true;
+    }
+
+private:
+    QMap<QString, int> _cameraCaptureOffsets; // <fieldName, fieldOffset>
+    int _cameraCaptureMsgID;
+
+    const char _ULogMagic[8] = {'U', 'L', 'o', 'g', 0x01, 0x12, 0x35};
+
+    int sizeOfType(QString& typeName)
+    {
+        if (typeName == "int8_t" || typeName == "uint8_t") {
+            return 1;
+
+        } else if (typeName == "int16_t" || typeName == "uint16_t") {
+            return 2;
+
+        } else if (typeName == "int32_t" || typeName == "uint32_t") {
+            return 4;
+
+        } else if (typeName == "int64_t" || typeName == "uint64_t") {
+            return 8;
+
+        } else if (typeName == "float") {
+            return 4;
+
+        } else if (typeName == "double") {
+            return 8;
+
+        } else if (typeName == "char" || typeName == "bool") {
+            return 1;
+        }
+
+        return 0;
+    }
+
+    int sizeOfFullType(QString& typeNameFull)
+    {
+        int arraySize;
+        QString typeName = extractArraySize(typeNameFull, arraySize);
+        return sizeOfType(typeName) * arraySize;
+    }
+
+    QString extractArraySize(QString &typeNameFull, int &arraySize)
+    {
+        int startPos = typeNameFull.indexOf('[');
+        int endPos = typeNameFull.indexOf(']');
+
+        if (startPos == -1 || endPos == -1) {
+            arraySize = 1;
+            return typeNameFull;
+        }
+
+        arraySize = typeNameFull.mid(startPos + 1, endPos - startPos - 1).toInt();
+        return typeNameFull.mid(0, startPos);
+    }
+
+    bool parseFieldFormat(QString& fields)
+    {
+        int prevFieldEnd = 0;
+        int fieldEnd = fields.indexOf(';');
+        int offset = 0;
+
+        while (fieldEnd != -1) {
+            int spacePos = fields.indexOf(' ', prevFieldEnd);
+
+            if (spacePos != -1) {
+                QString typeNameFull = fields.mid(prevFieldEnd, spacePos - prevFieldEnd);
+                QString fieldName = fields.mid(spacePos + 1, fieldEnd - spacePos - 1);
+
+                if (!fieldName.contains("_padding")) {
+                    _cameraCaptureOffsets.insert(fieldName, offset);
+                    offset += sizeOfFullType(typeNameFull);
+                }
+            }
+
+            prevFieldEnd = fieldEnd + 1;
+            fieldEnd = fields.indexOf(';', prevFieldEnd);
+        }
+        return false;
+    }
+
+    enum class ULogMessageType : uint8_t {
+        FORMAT = 'F',
+        DATA = 'D',
+        INFO = 'I',
+        PARAMETER = 'P',
+        ADD_LOGGED_MSG = 'A',
+        REMOVE_LOGGED_MSG = 'R',
+        SYNC = 'S',
+        DROPOUT = 'O',
+        LOGGING = 'L',
+    };
+
+    static const int ULOG_MSG_HEADER_LEN = 3;
+    struct ULogMessageHeader {
+        uint16_t msgSize;
+        uint8_t msgType;
+    };
+
+    struct ULogMessageFormat {
+        uint16_t msgSize;
+        uint8_t msgType;
+
+        char format[2096];
+    };
+
+    struct ULogMessageAddLogged {
+        uint16_t msgSize;
+        uint8_t msgType;
+
+        uint8_t multiID;
+        uint16_t msgID;
+        char msgName[255];
+    };
+};
+
+ULogReaderTest::ULogReaderTest(void)
+{
+
+}
+
+QByteArray ULogReaderTest::_logHeader(void)
+{
+    QByteArray header("ULog\x01\x12\x35\x01", 8);
+
+    // Start timestamp
+    header.append(QByteArray(8, 0));
+
+    return header;
+}
+
+void ULogReaderTest::_appendMessage(QByteArray& log, char msgType, const QByteArray& payload)
+{
+    uchar msgSize[2];
+
+    qToLittleEndian<quint16>(payload.size(), msgSize);
+    log.append((const char*)msgSize, 2);
+    log.append(msgType);
+    log.append(payload);
+}
+
+void ULogReaderTest::_appendFormat(QByteArray& log, const QString& format)
+{
+    _appendMessage(log, 'F', format.toLatin1());
+}
+
+void ULogReaderTest::_appendAddLogged(QByteArray& log, int multiId, int msgId, const QString& topicName)
+{
+    QByteArray  payload;
+    uchar       value[2];
+
+    payload.append((char)multiId);
+    qToLittleEndian<quint16>(msgId, value);
+    payload.append((const char*)value, 2);
+    payload.append(topicName.toLatin1());
+
+    _appendMessage(log, 'A', payload);
+}
+
+void ULogReaderTest::_appendData(QByteArray& log, int msgId, const QByteArray& data)
+{
+    uchar value[2];
+
+    qToLittleEndian<quint16>(msgId, value);
+    _appendMessage(log, 'D', QByteArray((const char*)value, 2) + data);
+}
+
+/// @return Data of a camera_capture record in the layout of _cameraCaptureFormat
+QByteArray ULogReaderTest::_cameraCaptureRecord(quint32 seq, double lat, double lon, float alt)
+{
+    QByteArray  record(64, 0);
+    uchar*      data = reinterpret_cast<uchar*>(record.data());
+    quint64     bits64;
+    quint32     bits32;
+
+    qToLittleEndian<quint64>(1000000ULL * (seq + 1), data);
+    qToLittleEndian<quint64>(1500000000000000ULL + (1000000ULL * seq), data + 8);
+    memcpy(&bits64, &lat, 8);
+    qToLittleEndian<quint64>(bits64, data + 16);
+    memcpy(&bits64, &lon, 8);
+    qToLittleEndian<quint64>(bits64, data + 24);
+    memcpy(&bits32, &alt, 4);
+    qToLittleEndian<quint32>(bits32, data + 32);
+    float q0 = 1.0f;
+    memcpy(&bits32, &q0, 4);
+    qToLittleEndian<quint32>(bits32, data + 40);
+    qToLittleEndian<quint32>(seq, data + 56);
+    data[60] = 1;
+
+    return record;
+}
+
+/// @return Log with a sensor topic logged at a high rate and a camera capture after every sensorRecordsPerCapture
+/// sensor records
+QByteArray ULogReaderTest::_cameraCaptureLog(int sensorRecordsPerCapture, int captureCount)
+{
+    QByteArray log = _logHeader();
+
+    _appendFormat(log, QStringLiteral("sensor_combined:uint64_t timestamp;float[3] gyro_rad;float[3] accelerometer_m_s2;uint32_t gyro_integral_dt;int32_t accelerometer_timestamp_relative;"));
+    _appendFormat(log, _cameraCaptureFormat);
+    _appendMessage(log, 'I', QByteArray("\x0b" "char[3] ver", 12) + QByteArray("1.0"));
+
+    _appendAddLogged(log, 0, 0, QStringLiteral("sensor_combined"));
+    _appendAddLogged(log, 0, 1, QStringLiteral("camera_capture"));
+
+    QByteArray sensorRecord(40, 0);
+    log.reserve(log.size() + (captureCount * ((sensorRecordsPerCapture * (sensorRecord.size() + 5)) + 69)));
+    for (int i=0; i<captureCount; i++) {
+        for (int j=0; j<sensorRecordsPerCapture; j++) {
+            sensorRecord[0] = (char)j;
+            _appendData(log, 0, sensorRecord);
+        }
+        _appendData(log, 1, _cameraCaptureRecord(i, 47.3764 + (i * 0.0001), 8.5481, 400.0f + i));
+    }
+
+    return log;
+}
+
+void ULogReaderTest::_formatTest(void)
+{
+    QByteArray log = _logHeader();
+
+    // Nested type defined after the topic which uses it
+    _appendFormat(log, QStringLiteral("vehicle_info:uint64_t timestamp;esc_report[2] esc;uint8_t count;uint8_t[7] _padding0;"));
+    _appendFormat(log, QStringLiteral("esc_report:uint32_t rpm;float voltage;"));
+    _appendFormat(log, _cameraCaptureFormat);
+    _appendFormat(log, QStringLiteral("broken:unknown_t value;"));
+
+    ULogReader reader;
+    QVERIFY(reader.open(log));
+    QVERIFY(!reader.isMapped());
+
+    QCOMPARE(reader.topicSize("esc_report"), 8);
+    QCOMPARE(reader.topicSize("vehicle_info"), 32);
+    QCOMPARE(reader.topicSize("camera_capture"), 64);
+    QCOMPARE(reader.topicSize("broken"), -1);
+    QCOMPARE(reader.topicSize("missing"), -1);
+    QVERIFY(reader.topics().contains("camera_capture"));
+
+    ULogReader::Field_t field = reader.field("vehicle_info", "esc");
+    QCOMPARE(field.type, ULogReader::FieldTypeNested);
+    QCOMPARE(field.offset, 8);
+    QCOMPARE(field.arraySize, 2);
+
+    field = reader.field("vehicle_info", "count");
+    QCOMPARE(field.type, ULogReader::FieldTypeUInt8);
+    QCOMPARE(field.offset, 24);
+
+    field = reader.field("camera_capture", "q");
+    QCOMPARE(field.type, ULogReader::FieldTypeFloat);
+    QCOMPARE(field.offset, 40);
+    QCOMPARE(field.arraySize, 4);
+
+    field = reader.field("camera_capture", "seq");
+    QCOMPARE(field.type, ULogReader::FieldTypeUInt32);
+    QCOMPARE(field.offset, 56);
+
+    QCOMPARE(reader.field("camera_capture", "_padding0").type, ULogReader::FieldTypeInvalid);
+    QCOMPARE(reader.field("camera_capture", "missing").type, ULogReader::FieldTypeInvalid);
+    QCOMPARE(reader.field("missing", "seq").type, ULogReader::FieldTypeInvalid);
+
+    // Not a ULog file
+    QVERIFY(!reader.open(QByteArray("not a ulog file, not a ulog file")));
+    QVERIFY(!reader.errorString().isEmpty());
+    QVERIFY(!reader.open(QStringLiteral("/missing/file.ulg")));
+}
+
+void ULogReaderTest::_readTest(void)
+{
+    QByteArray log = _logHeader();
+
+    _appendFormat(log, QStringLiteral("esc_status:uint64_t timestamp;int16_t[2] rpm;uint8_t count;bool armed;"));
+    _appendFormat(log, _cameraCaptureFormat);
+    _appendAddLogged(log, 0, 3, QStringLiteral("esc_status"));
+    _appendAddLogged(log, 1, 4, QStringLiteral("esc_status"));
+    _appendAddLogged(log, 0, 5, QStringLiteral("camera_capture"));
+
+    QByteArray  escRecord(14, 0);
+    uchar*      data = reinterpret_cast<uchar*>(escRecord.data());
+    qToLittleEndian<quint64>(12345, data);
+    qToLittleEndian<qint16>(-1200, data + 8);
+    qToLittleEndian<qint16>(1300, data + 10);
+    data[12] = 2;
+    data[13] = 1;
+
+    _appendData(log, 3, escRecord);
+    _appendData(log, 5, _cameraCaptureRecord(0, 47.5, -122.25, 100.5f));
+    _appendData(log, 4, escRecord);
+    _appendMessage(log, 'R', QByteArray("\x03\x00", 2));
+    _appendData(log, 3, escRecord);
+    _appendData(log, 5, _cameraCaptureRecord(1, 47.6, -122.35, 101.5f));
+
+    // Truncated record at the end of the log
+    log.append("\x40\x00\x44\x05", 4);
+
+    ULogReader reader;
+    QVERIFY(reader.open(log));
+
+    ULogReader::Field_t timestampField = reader.field("esc_status", "timestamp");
+    ULogReader::Field_t rpmField = reader.field("esc_status", "rpm");
+    ULogReader::Field_t countField = reader.field("esc_status", "count");
+    ULogReader::Field_t armedField = reader.field("esc_status", "armed");
+    ULogReader::Field_t latField = reader.field("camera_capture", "lat");
+    ULogReader::Field_t altField = reader.field("camera_capture", "alt");
+
+    QList<int>      topicIndices;
+    QList<int>      multiIds;
+    QList<double>   values;
+    QList<qint64>   escValues;
+    QStringList     topicNames;
+    topicNames << "camera_capture" << "esc_status";
+
+    QVERIFY(reader.read(topicNames, [&](int topicIndex, int multiId, const char* data, int size) {
+        topicIndices << topicIndex;
+        multiIds << multiId;
+        if (topicIndex == 0) {
+            values << ULogReader::toDouble(latField, data, size) << ULogReader::toDouble(altField, data, size);
+        } else {
+            escValues << size;
+            escValues << (qint64)ULogReader::toUInt64(timestampField, data, size);
+            escValues << ULogReader::toInt64(rpmField, data, size, 0);
+            escValues << (qint64)ULogReader::toDouble(rpmField, data, size, 1);
+            escValues << ULogReader::toInt64(rpmField, data, size, 2);
+            escValues << ULogReader::toInt64(countField, data, size);
+            escValues << ULogReader::toInt64(armedField, data, size);
+
+            // Field outside of a short record
+            escValues << ULogReader::toInt64(armedField, data, size - 1);
+        }
+        return true;
+    }));
+
+    QList<qint64> expectedEscValues;
+    expectedEscValues << 14 << 12345 << -1200 << 1300 << 0 << 2 << 1 << 0;
+    QCOMPARE(escValues, expectedEscValues + expectedEscValues);
+
+    // Second esc_status record is from instance 1, the third one is not read since its message id was removed
+    QCOMPARE(topicIndices, QList<int>() << 1 << 0 << 1 << 0);
+    QCOMPARE(multiIds, QList<int>() << 0 << 0 << 1 << 0);
+    QCOMPARE(values, QList<double>() << 47.5 << 100.5 << 47.6 << 101.5);
+
+    // Handler stops reading
+    int recordCount = 0;
+    QVERIFY(reader.read(topicNames, [&](int, int, const char*, int) { recordCount++; return false; }));
+    QCOMPARE(recordCount, 1);
+
+    // Topics which aren't requested are skipped
+    recordCount = 0;
+    QVERIFY(reader.read(QStringList("camera_capture"), [&](int, int, const char*, int) { recordCount++; return true; }));
+    QCOMPARE(recordCount, 2);
+
+    // Cancelled read
+    QByteArray  largeLog = _cameraCaptureLog(100, 2000);
+    QAtomicInt  cancel(1);
+    QVERIFY(reader.open(largeLog));
+    QVERIFY(!reader.read(topicNames, [&](int, int, const char*, int) { return true; }, &cancel));
+}
+
+void ULogReaderTest::_cameraCaptureTest(void)
+{
+    QByteArray log = _cameraCaptureLog(10, 50);
+
+    QTemporaryFile logFile;
+    QVERIFY(logFile.open());
+    QCOMPARE(logFile.write(log), (qint64)log.size());
+    logFile.close();
+
+    QList<GeoTagWorker::cameraFeedbackPacket> fileFeedback;
+    QList<GeoTagWorker::cameraFeedbackPacket> bytesFeedback;
+    ULogParser parser;
+    QVERIFY(parser.getTagsFromLog(logFile.fileName(), fileFeedback));
+    QVERIFY(parser.getTagsFromLog(log, bytesFeedback));
+
+    QCOMPARE(fileFeedback.count(), 50);
+    QCOMPARE(bytesFeedback.count(), 50);
+    for (int i=0; i<fileFeedback.count(); i++) {
+        const GeoTagWorker::cameraFeedbackPacket& feedback = fileFeedback[i];
+
+        QCOMPARE(feedback.imageSequence, (uint32_t)i);
+        QCOMPARE(feedback.timestamp, (i + 1) * 1.0);
+        QCOMPARE(feedback.timestampUTC, 1500000000.0 + i);
+        QCOMPARE(feedback.latitude, 47.3764 + (i * 0.0001));
+        QCOMPARE(feedback.longitude, 8.5481);
+        QCOMPARE(feedback.altitude, 400.0f + i);
+        QCOMPARE(feedback.attitudeQuaternion[0], 1.0f);
+        QCOMPARE((int)feedback.captureResult, 1);
+
+        QCOMPARE(bytesFeedback[i].imageSequence, feedback.imageSequence);
+        QCOMPARE(bytesFeedback[i].latitude, feedback.latitude);
+    }
+
+    // Log without camera captures
+    QByteArray noCaptureLog = _logHeader();
+    _appendFormat(noCaptureLog, _cameraCaptureFormat);
+    QList<GeoTagWorker::cameraFeedbackPacket> noFeedback;
+    QVERIFY(!parser.getTagsFromLog(noCaptureLog, noFeedback));
+    QCOMPARE(noFeedback.count(), 0);
+}
+
+/// Checks ULogParser against the parser it replaced on the same log. Both have to find the same camera captures, and
+/// ULogReader has to map the file instead of loading it. The timings are logged for comparison, they are not asserted
+/// since both are a single pass over the log.
+void ULogReaderTest::_benchmarkTest(void)
+{
+    const int   captureCount = 500;
+    QByteArray  log = _cameraCaptureLog(200, captureCount);
+
+    QTemporaryFile logFile;
+    QVERIFY(logFile.open());
+    QCOMPARE(logFile.write(log), (qint64)log.size());
+    logFile.close();
+    log.clear();
+
+    QElapsedTimer timer;
+    timer.start();
+    QFile file(logFile.fileName());
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QByteArray loadedLog = file.readAll();
+    file.close();
+    QList<GeoTagWorker::cameraFeedbackPacket> baselineFeedback;
+    BaselineULogParser baselineParser;
+    QVERIFY(baselineParser.getTagsFromLog(loadedLog, baselineFeedback));
+    qint64 baselineMsecs = timer.elapsed();
+    qint64 logSize = loadedLog.size();
+    loadedLog.clear();
+
+    timer.start();
+    QList<GeoTagWorker::cameraFeedbackPacket> feedback;
+    ULogParser parser;
+    QVERIFY(parser.getTagsFromLog(logFile.fileName(), feedback));
+    qint64 readerMsecs = timer.elapsed();
+
+    qDebug() << "ULog" << logSize / 1024 << "KB: baseline parser" << baselineMsecs << "msecs, ULogReader" << readerMsecs << "msecs";
+
+    ULogReader reader;
+    QVERIFY(reader.open(logFile.fileName()));
+    QVERIFY(reader.isMapped());
+
+    // The baseline copied the uint64 timestamps into doubles, which ULogParser no longer does, so they are left out
+    QCOMPARE(baselineFeedback.count(), captureCount);
+    QCOMPARE(feedback.count(), baselineFeedback.count());
+    for (int i=0; i<feedback.count(); i++) {
+        QCOMPARE(feedback[i].imageSequence, baselineFeedback[i].imageSequence);
+        QCOMPARE(feedback[i].latitude, baselineFeedback[i].latitude);
+        QCOMPARE(feedback[i].longitude, baselineFeedback[i].longitude);
+        QCOMPARE(feedback[i].altitude, baselineFeedback[i].altitude);
+        QCOMPARE(feedback[i].groundDistance, baselineFeedback[i].groundDistance);
+        QCOMPARE((int)feedback[i].captureResult, (int)baselineFeedback[i].captureResult);
+    }
+}
@@ -0,0 +1,44 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#ifndef ULogReaderTest_H
+#define ULogReaderTest_H
+
+#include "UnitTest.h"
+
+#include <QByteArray>
+#include <QString>
+
+/// Unit test for ULogReader and the ULogParser camera capture extraction built on it
+class ULogReaderTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    ULogReaderTest(void);
+
+private slots:
+    void _formatTest(void);
+    void _readTest(void);
+    void _cameraCaptureTest(void);
+    void _benchmarkTest(void);
+
+private:
+    QByteArray  _logHeader              (void);
+    void        _appendMessage          (QByteArray& log, char msgType, const QByteArray& payload);
+    void        _appendFormat           (QByteArray& log, const QString& format);
+    void        _appendAddLogged        (QByteArray& log, int multiId, int msgId, const QString& topicName);
+    void        _appendData             (QByteArray& log, int msgId, const QByteArray& data);
+    QByteArray  _cameraCaptureRecord    (quint32 seq, double lat, double lon, float alt);
+    QByteArray  _cameraCaptureLog       (int sensorRecordsPerCapture, int captureCount);
+
+    static const char* _cameraCaptureFormat;
+};
+
+#endif
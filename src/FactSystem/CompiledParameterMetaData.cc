@@ -0,0 +1,237 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#include "CompiledParameterMetaData.h"
+#include "QGCLoggingCategory.h"
+#include "QGC.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QFileInfo>
+#include <QSettings>
+#include <QDir>
+#include <QtEndian>
+
+QGC_LOGGING_CATEGORY(CompiledParameterMetaDataLog, "CompiledParameterMetaDataLog")
+
+const quint32 CompiledParameterMetaData::_magic =                   0x51504D44; // "QPMD"
+const quint32 CompiledParameterMetaData::_version =                 2;
+const char*   CompiledParameterMetaData::_compiledFilePrefix =      "CompiledParameterMetaData";
+const char*   CompiledParameterMetaData::_compiledFileExtension =   "bin";
+
+CompiledParameterMetaData::CompiledParameterMetaData(void)
+    : _map(NULL)
+    , _base(NULL)
+    , _size(0)
+    , _recordsOffset(0)
+{
+
+}
+
+CompiledParameterMetaData::~CompiledParameterMetaData()
+{
+    _unload();
+}
+
+QString CompiledParameterMetaData::compiledFileName(const QString& sourceName, const QByteArray& sourceData)
+{
+    // Compiled files are stored in settings location alongside the cached meta data xml files
+    QDir cacheDir = QFileInfo(QSettings().fileName()).dir();
+    QString hash = QString::fromLatin1(QCryptographicHash::hash(sourceData, QCryptographicHash::Sha1).toHex());
+
+    return cacheDir.filePath(QString("%1.%2.%3.%4").arg(_compiledFilePrefix).arg(sourceName).arg(hash).arg(_compiledFileExtension));
+}
+
+void CompiledParameterMetaData::_unload(void)
+{
+    if (_map) {
+        _file.unmap(_map);
+        _map = NULL;
+    }
+    if (_file.isOpen()) {
+        _file.close();
+    }
+    _data.clear();
+    _base = NULL;
+    _size = 0;
+    _recordsOffset = 0;
+    _index.clear();
+}
+
+bool CompiledParameterMetaData::load(const QString& sourceName, const QByteArray& sourceData)
+{
+    _unload();
+
+    _file.setFileName(compiledFileName(sourceName, sourceData));
+    if (!_file.exists()) {
+        qCDebug(CompiledParameterMetaDataLog) << "No compiled meta data" << _file.fileName();
+        return false;
+    }
+    if (!_file.open(QIODevice::ReadOnly)) {
+        qCWarning(CompiledParameterMetaDataLog) << "Unable to open compiled meta data" << _file.fileName() << _file.errorString();
+        return false;
+    }
+
+    _size = _file.size();
+    _map = _file.map(0, _size);
+    _base = reinterpret_cast<const char*>(_map);
+    if (!_map) {
+        // Mapping not supported on this platform/file system, fall back to reading it
+        _data = _file.readAll();
+        _file.close();
+        _base = _data.constData();
+        _size = _data.size();
+    }
+
+    if (!_loadIndex()) {
+        qCWarning(CompiledParameterMetaDataLog) << "Corrupt compiled meta data, discarding" << _file.fileName();
+        QString fileName = _file.fileName();
+        _unload();
+        QFile::remove(fileName);
+        return false;
+    }
+
+    qCDebug(CompiledParameterMetaDataLog) << "Loaded compiled meta data" << _file.fileName() << "records:" << _index.count();
+    return true;
+}
+
+bool CompiledParameterMetaData::_loadIndex(void)
+{
+    QDataStream stream(QByteArray::fromRawData(_base, _size));
+    stream.setVersion(QDataStream::Qt_5_4);
+
+    quint32 magic, version, recordCount, recordsSize, recordsCRC;
+    stream >> magic >> version >> recordCount;
+    if (stream.status() != QDataStream::Ok || magic != _magic || version != _version) {
+        return false;
+    }
+
+    // Each index entry is at least a key length, record offset and record length. The count is checked against
+    // the remaining data before anything is allocated for it.
+    if ((quint64)recordCount * 3 * sizeof(quint32) > (quint64)stream.device()->bytesAvailable()) {
+        return false;
+    }
+
+    _index.reserve(recordCount);
+    for (quint32 i=0; i<recordCount; i++) {
+        QString key;
+        quint32 offset, length;
+
+        if (!_readKey(stream, key)) {
+            return false;
+        }
+        stream >> offset >> length;
+        if (stream.status() != QDataStream::Ok) {
+            return false;
+        }
+        _index[key] = QPair<quint32, quint32>(offset, length);
+    }
+
+    stream >> recordsSize >> recordsCRC;
+    if (stream.status() != QDataStream::Ok) {
+        return false;
+    }
+    _recordsOffset = stream.device()->pos();
+    if (_recordsOffset + recordsSize != _size) {
+        return false;
+    }
+
+    // Every record must lie within the record data, which must be intact since records are decoded without further
+    // checks on their contents
+    for (QHash<QString, QPair<quint32, quint32> >::const_iterator entry = _index.constBegin(); entry != _index.constEnd(); ++entry) {
+        if ((quint64)entry.value().first + entry.value().second > recordsSize) {
+            return false;
+        }
+    }
+    if (QGC::crc32(reinterpret_cast<const quint8*>(_base + _recordsOffset), recordsSize, 0) != recordsCRC) {
+        return false;
+    }
+
+    return true;
+}
+
+/// Reads a QString written by QDataStream. Its length is checked against the remaining data before it is read, so a
+/// corrupt length can not cause a large allocation.
+bool CompiledParameterMetaData::_readKey(QDataStream& stream, QString& key)
+{
+    QByteArray lengthBytes = stream.device()->peek(sizeof(quint32));
+    if (lengthBytes.size() != sizeof(quint32)) {
+        return false;
+    }
+
+    // A length of 0xFFFFFFFF is a null string, otherwise it is the length in bytes of the UTF-16 data
+    quint32 length = qFromBigEndian<quint32>(reinterpret_cast<const uchar*>(lengthBytes.constData()));
+    if (length != 0xFFFFFFFF && (length % 2 || (qint64)length > stream.device()->bytesAvailable() - (qint64)sizeof(quint32))) {
+        return false;
+    }
+
+    stream >> key;
+    return stream.status() == QDataStream::Ok;
+}
+
+void CompiledParameterMetaData::compile(const QString& sourceName, const QByteArray& sourceData, const QMap<QString, QByteArray>& records)
+{
+    _unload();
+
+    QByteArray  recordData;
+    QByteArray  compiled;
+    QDataStream stream(&compiled, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_4);
+
+    stream << _magic << _version << (quint32)records.count();
+    QMapIterator<QString, QByteArray> iter(records);
+    while (iter.hasNext()) {
+        iter.next();
+        stream << iter.key() << (quint32)recordData.size() << (quint32)iter.value().size();
+        recordData.append(iter.value());
+    }
+    stream << (quint32)recordData.size() << QGC::crc32(reinterpret_cast<const quint8*>(recordData.constData()), recordData.size(), 0);
+    stream.writeRawData(recordData.constData(), recordData.size());
+
+    // Remove stale compiled versions of this source
+    QString fileName = compiledFileName(sourceName, sourceData);
+    QDir cacheDir = QFileInfo(fileName).dir();
+    QString wildcard = QString("%1.%2.*.%3").arg(_compiledFilePrefix).arg(sourceName).arg(_compiledFileExtension);
+    foreach (const QString& staleFile, cacheDir.entryList(QStringList(wildcard), QDir::Files)) {
+        cacheDir.remove(staleFile);
+    }
+
+    QFile compiledFile(fileName);
+    if (compiledFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (compiledFile.write(compiled) != compiled.size()) {
+            qCWarning(CompiledParameterMetaDataLog) << "Write of compiled meta data failed" << fileName << compiledFile.errorString();
+            compiledFile.close();
+            compiledFile.remove();
+        } else {
+            qCDebug(CompiledParameterMetaDataLog) << "Compiled meta data" << fileName << "records:" << records.count() << "bytes:" << compiled.size();
+        }
+    } else {
+        qCWarning(CompiledParameterMetaDataLog) << "Unable to create compiled meta data" << fileName << compiledFile.errorString();
+    }
+
+    // Serve lookups from the in memory copy, no need to go back to disk
+    _data = compiled;
+    _base = _data.constData();
+    _size = _data.size();
+    if (!_loadIndex()) {
+        qCWarning(CompiledParameterMetaDataLog) << "Internal error: compiled meta data index invalid";
+        _unload();
+    }
+}
+
+QByteArray CompiledParameterMetaData::record(const QString& key) const
+{
+    if (!_index.contains(key)) {
+        return QByteArray();
+    }
+
+    const QPair<quint32, quint32>& entry = _index[key];
+    return QByteArray::fromRawData(_base + _recordsOffset + entry.first, entry.second);
+}
@@ -0,0 +1,81 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#ifndef CompiledParameterMetaData_H
+#define CompiledParameterMetaData_H
+
+#include <QFile>
+#include <QHash>
+#include <QMap>
+#include <QString>
+#include <QByteArray>
+#include <QDataStream>
+#include <QLoggingCategory>
+
+Q_DECLARE_LOGGING_CATEGORY(CompiledParameterMetaDataLog)
+
+/// Compact on disk form of a firmware parameter meta data file.
+///
+/// Parsing the firmware supplied parameter meta data xml is expensive. The firmware plugins parse it once into
+/// per parameter records which they serialize themselves. Those records are then written to a compiled file in the
+/// settings location which is keyed by a hash of the source xml. On the next connect the compiled file is memory
+/// mapped and only the record index is built. Individual records are then decoded on demand as each parameter Fact
+/// asks for its meta data.
+class CompiledParameterMetaData
+{
+public:
+    CompiledParameterMetaData(void);
+    ~CompiledParameterMetaData();
+
+    /// Loads the compiled version of the specified source from the cache.
+    ///     @param sourceName Name which identifies the source independent of its contents
+    ///     @param sourceData Contents of the source file, used to generate the cache key
+    /// @return true: compiled file found and loaded, false: caller must parse the source and call compile
+    bool load(const QString& sourceName, const QByteArray& sourceData);
+
+    /// Writes the specified records to a new compiled file and makes them available for lookup. Older compiled
+    /// versions of the same source are removed.
+    ///     @param sourceName Name which identifies the source independent of its contents
+    ///     @param sourceData Contents of the source file, used to generate the cache key
+    ///     @param records Map from record key to serialized record
+    void compile(const QString& sourceName, const QByteArray& sourceData, const QMap<QString, QByteArray>& records);
+
+    bool        contains    (const QString& key) const { return _index.contains(key); }
+    int         count       (void) const { return _index.count(); }
+    QStringList keys        (void) const { return _index.keys(); }
+
+    /// Returns the serialized record for the specified key, empty if not found. The returned array references
+    /// the compiled data directly, so it must not outlive this object.
+    QByteArray record(const QString& key) const;
+
+    /// @return Location of the compiled file for the specified source
+    static QString compiledFileName(const QString& sourceName, const QByteArray& sourceData);
+
+private:
+    bool _loadIndex (void);
+    void _unload    (void);
+
+    static bool _readKey(QDataStream& stream, QString& key);
+
+    QFile                                   _file;
+    uchar*                                  _map;       ///< Memory mapped compiled file, NULL if not mapped
+    QByteArray                              _data;      ///< Used when compiled data does not come from a memory mapped file
+    const char*                             _base;      ///< Start of compiled data
+    qint64                                  _size;      ///< Size of compiled data
+    qint64                                  _recordsOffset;
+    QHash<QString, QPair<quint32, quint32> > _index;    ///< Key: record key, Value: { record offset, record length }
+
+    static const quint32 _magic;
+    static const quint32 _version;
+    static const char*   _compiledFilePrefix;
+    static const char*   _compiledFileExtension;
+};
+
+#endif
@@ -61,6 +61,8 @@ const FactMetaData::AppSettingsTranslation_s FactMetaData::_rgAppSettingsTransla
     { "m/s",    "kn",       true,   UnitsSettings::SpeedUnitsKnots,             FactMetaData::_metersPerSecondToKnots,              FactMetaData::_knotsToMetersPerSecond },
 };
 
+const char* FactMetaData::defaultGroup =                "*Default Group";
+
 const char* FactMetaData::_decimalPlacesJsonKey =       "decimalPlaces";
 const char* FactMetaData::_nameJsonKey =                "name";
 const char* FactMetaData::_typeJsonKey =                "type";
@@ -77,7 +79,7 @@ FactMetaData::FactMetaData(QObject* parent)
     , _decimalPlaces(unknownDecimalPlaces)
     , _rawDefaultValue(0)
     , _defaultValueAvailable(false)
-    , _group("*Default Group")
+    , _group(defaultGroup)
     , _rawMax(_maxForType())
     , _maxIsDefaultForType(true)
     , _rawMin(_minForType())
@@ -96,7 +98,7 @@ FactMetaData::FactMetaData(ValueType_t type, QObject* parent)
     , _decimalPlaces(unknownDecimalPlaces)
     , _rawDefaultValue(0)
     , _defaultValueAvailable(false)
-    , _group("*Default Group")
+    , _group(defaultGroup)
     , _rawMax(_maxForType())
     , _maxIsDefaultForType(true)
     , _rawMin(_minForType())
@@ -141,6 +141,7 @@ public:
 
     static const int defaultDecimalPlaces = 3;  ///< Default value for decimal places if not specified/known
     static const int unknownDecimalPlaces = -1; ///< Number of decimal places to specify is not known
+    static const char* defaultGroup;            ///< Group for Facts which do not specify one
 
     static ValueType_t stringToType(const QString& typeString, bool& unknownType);
     static size_t typeToSize(ValueType_t type);
@@ -0,0 +1,231 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#include "ParameterDownloadCoordinator.h"
+#include "ParameterManager.h"
+#include "MultiVehicleManager.h"
+#include "LinkInterface.h"
+#include "LinkManager.h"
+#include "QGCLoggingCategory.h"
+
+QGC_LOGGING_CATEGORY(ParameterDownloadCoordinatorLog, "ParameterDownloadCoordinatorLog")
+
+const double ParameterDownloadCoordinator::_headroomFactor =    0.5;
+const double ParameterDownloadCoordinator::_bitsPerParamValue = (MAVLINK_MSG_ID_PARAM_VALUE_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES) * 10;
+
+ParameterDownloadCoordinator::ParameterDownloadCoordinator(MultiVehicleManager* multiVehicleManager, LinkManager* linkManager, QObject* parent)
+    : QObject(parent)
+    , _multiVehicleManager(multiVehicleManager)
+    , _throughput(0)
+{
+    _throughputTimer.setInterval(_throughputIntervalMSecs);
+    connect(&_throughputTimer, &QTimer::timeout, this, &ParameterDownloadCoordinator::_updateThroughput);
+    _throughputTimer.start();
+    _throughputTime.start();
+
+    // The new active vehicle may have a download waiting
+    connect(_multiVehicleManager, &MultiVehicleManager::activeVehicleChanged, this, &ParameterDownloadCoordinator::_schedule);
+
+    // Link state must not outlive the link, a new link could be allocated at the same address
+    connect(linkManager, &LinkManager::linkDeleted, this, &ParameterDownloadCoordinator::_linkDeleted);
+}
+
+int ParameterDownloadCoordinator::pendingDownloads(void) const
+{
+    int count = 0;
+
+    foreach (const LinkState_t& linkState, _linkStates) {
+        count += linkState.pending.count();
+    }
+
+    return count;
+}
+
+double ParameterDownloadCoordinator::linkThroughput(LinkInterface* link) const
+{
+    return _linkStates.contains(link) ? _linkStates[link].throughput : 0.0;
+}
+
+double ParameterDownloadCoordinator::linkCapacity(LinkInterface* link)
+{
+    return link ? _capacityForSpeed(link->getConnectionSpeed()) : 0.0;
+}
+
+double ParameterDownloadCoordinator::_capacityForSpeed(qint64 connectionSpeed)
+{
+    if (connectionSpeed <= 0) {
+        connectionSpeed = _defaultConnectionSpeed;
+    }
+    return connectionSpeed / _bitsPerParamValue;
+}
+
+void ParameterDownloadCoordinator::requestDownload(ParameterManager* parameterManager, LinkInterface* link)
+{
+    LinkState_t& linkState = _linkStates[link];
+
+    if (linkState.active.contains(parameterManager)) {
+        // Retry of a download which is already running
+        parameterManager->_sendParameterRequestList();
+        return;
+    }
+    if (linkState.pending.contains(parameterManager)) {
+        return;
+    }
+
+    qCDebug(ParameterDownloadCoordinatorLog) << "Download requested" << parameterManager->vehicle()->id();
+    linkState.pending.append(parameterManager);
+    emit pendingDownloadsChanged(pendingDownloads());
+
+    _schedule();
+}
+
+void ParameterDownloadCoordinator::downloadComplete(ParameterManager* parameterManager)
+{
+    bool found = false;
+
+    QMutableMapIterator<LinkInterface*, LinkState_t> iter(_linkStates);
+    while (iter.hasNext()) {
+        iter.next();
+        LinkState_t& linkState = iter.value();
+        if (linkState.active.removeOne(parameterManager)) {
+            found = true;
+        }
+        if (linkState.pending.removeOne(parameterManager)) {
+            found = true;
+            emit pendingDownloadsChanged(pendingDownloads());
+        }
+    }
+
+    if (found) {
+        qCDebug(ParameterDownloadCoordinatorLog) << "Download complete" << parameterManager->vehicle()->id();
+        _schedule();
+    }
+}
+
+bool ParameterDownloadCoordinator::_canStartDownload(LinkInterface* link, const LinkState_t& linkState) const
+{
+    if (linkState.active.isEmpty()) {
+        return true;
+    }
+    if (linkState.active.count() >= _maxActiveDownloadsPerLink) {
+        return false;
+    }
+    if (linkState.lastStart.isValid() && linkState.lastStart.elapsed() < _minStartSpacingMSecs) {
+        // Throughput has not caught up with the last download started yet
+        return false;
+    }
+
+    return linkState.throughput < linkCapacity(link) * _headroomFactor;
+}
+
+/// @return Index of the pending download which should start next, the active vehicle takes priority
+int ParameterDownloadCoordinator::_nextPendingIndex(const LinkState_t& linkState) const
+{
+    Vehicle* activeVehicle = _multiVehicleManager->activeVehicle();
+
+    for (int i=0; i<linkState.pending.count(); i++) {
+        if (linkState.pending[i]->vehicle() == activeVehicle) {
+            return i;
+        }
+    }
+
+    return 0;
+}
+
+void ParameterDownloadCoordinator::_schedule(void)
+{
+    QList<QPair<LinkInterface*, ParameterManager*> > startList;
+
+    QMutableMapIterator<LinkInterface*, LinkState_t> iter(_linkStates);
+    while (iter.hasNext()) {
+        iter.next();
+        LinkState_t& linkState = iter.value();
+
+        if (!linkState.pending.isEmpty() && _canStartDownload(iter.key(), linkState)) {
+            ParameterManager* parameterManager = linkState.pending.takeAt(_nextPendingIndex(linkState));
+            linkState.active.append(parameterManager);
+            linkState.lastStart.start();
+            startList.append(QPair<LinkInterface*, ParameterManager*>(iter.key(), parameterManager));
+        }
+    }
+
+    if (startList.count()) {
+        emit pendingDownloadsChanged(pendingDownloads());
+    }
+
+    // Start downloads outside of the iteration since they may call back into us
+    for (int i=0; i<startList.count(); i++) {
+        _startDownload(startList[i].first, startList[i].second);
+    }
+}
+
+void ParameterDownloadCoordinator::_startDownload(LinkInterface* link, ParameterManager* parameterManager)
+{
+    LinkState_t& linkState = _linkStates[link];
+
+    qCDebug(ParameterDownloadCoordinatorLog) << "Starting download" << parameterManager->vehicle()->id()
+                                             << "active:" << linkState.active.count()
+                                             << "link throughput:capacity" << linkState.throughput << linkCapacity(link);
+    parameterManager->_sendParameterRequestList();
+}
+
+void ParameterDownloadCoordinator::_linkDeleted(LinkInterface* link)
+{
+    if (!_linkStates.contains(link)) {
+        return;
+    }
+
+    // The vehicles on the link go away with it, so their downloads are simply dropped
+    bool hadPending = !_linkStates[link].pending.isEmpty();
+    _linkStates.remove(link);
+    qCDebug(ParameterDownloadCoordinatorLog) << "Link deleted, removed link state";
+    if (hadPending) {
+        emit pendingDownloadsChanged(pendingDownloads());
+    }
+}
+
+void ParameterDownloadCoordinator::_updateThroughput(void)
+{
+    double elapsedSecs = _throughputTime.restart() / 1000.0;
+    double throughput = 0;
+
+    if (elapsedSecs <= 0) {
+        return;
+    }
+
+    QMutableMapIterator<LinkInterface*, LinkState_t> iter(_linkStates);
+    while (iter.hasNext()) {
+        iter.next();
+        LinkState_t& linkState = iter.value();
+
+        // Smooth out the bursty nature of parameter streams
+        double currentThroughput = linkState.receivedCount / elapsedSecs;
+        linkState.throughput = (linkState.throughput + currentThroughput) / 2.0;
+        linkState.receivedCount = 0;
+        if (linkState.throughput < 0.5) {
+            linkState.throughput = 0;
+        }
+
+        if (linkState.throughput == 0 && linkState.active.isEmpty() && linkState.pending.isEmpty()) {
+            // Link no longer in use
+            iter.remove();
+        } else {
+            throughput += linkState.throughput;
+        }
+    }
+
+    if (throughput != _throughput) {
+        _throughput = throughput;
+        emit throughputChanged(_throughput);
+    }
+
+    // Throughput may now allow more downloads
+    _schedule();
+}
@@ -0,0 +1,110 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#ifndef ParameterDownloadCoordinator_H
+#define ParameterDownloadCoordinator_H
+
+#include <QObject>
+#include <QMap>
+#include <QList>
+#include <QTimer>
+#include <QTime>
+#include <QLoggingCategory>
+
+class LinkInterface;
+class LinkManager;
+class MultiVehicleManager;
+class ParameterManager;
+
+Q_DECLARE_LOGGING_CATEGORY(ParameterDownloadCoordinatorLog)
+
+/// Schedules full parameter downloads across all vehicles which share a link.
+///
+/// Without coordination every vehicle which connects over the same link sends its PARAM_REQUEST_LIST at the same
+/// moment and the resulting parameter streams compete for the link. Each ParameterManager instead asks the coordinator
+/// for permission to start a download. The first download on a link starts immediately. Further downloads only start
+/// once the measured parameter throughput shows the link has headroom left. Downloads for the active vehicle go to
+/// the front of the queue.
+class ParameterDownloadCoordinator : public QObject
+{
+    Q_OBJECT
+
+public:
+    ParameterDownloadCoordinator(MultiVehicleManager* multiVehicleManager, LinkManager* linkManager, QObject* parent = NULL);
+
+    /// Parameters received per second across all links
+    Q_PROPERTY(double   throughput          READ throughput         NOTIFY throughputChanged)
+
+    /// Number of downloads which are waiting for link capacity
+    Q_PROPERTY(int      pendingDownloads    READ pendingDownloads   NOTIFY pendingDownloadsChanged)
+
+    double  throughput      (void) const { return _throughput; }
+    int     pendingDownloads(void) const;
+
+    /// @return Parameters received per second on the specified link
+    double linkThroughput(LinkInterface* link) const;
+
+    /// @return Estimated maximum number of PARAM_VALUE messages per second the link can carry. Links which do not
+    /// report a speed are assumed to run at _defaultConnectionSpeed.
+    static double linkCapacity(LinkInterface* link);
+
+    /// Requests permission to start a full parameter download. If the download can start now
+    /// ParameterManager::_sendParameterRequestList is called before this returns, otherwise it is called once there
+    /// is capacity on the link. Calling this for a download which is already active sends the request list again.
+    void requestDownload(ParameterManager* parameterManager, LinkInterface* link);
+
+    /// Signals that a download requested through requestDownload is done, whether successful or not. It is safe to call
+    /// this for a ParameterManager which has no download pending or active.
+    void downloadComplete(ParameterManager* parameterManager);
+
+    /// Called for each parameter received over the link to measure throughput
+    void parameterReceived(LinkInterface* link) { _linkStates[link].receivedCount++; }
+
+signals:
+    void throughputChanged      (double throughput);
+    void pendingDownloadsChanged(int pendingDownloads);
+
+private slots:
+    void _updateThroughput  (void);
+    void _schedule          (void);
+    void _linkDeleted       (LinkInterface* link);
+
+private:
+    typedef struct {
+        QList<ParameterManager*>    pending;        ///< Downloads waiting to start, in request order
+        QList<ParameterManager*>    active;         ///< Downloads in progress
+        int                         receivedCount;  ///< Parameters received since last throughput update
+        double                      throughput;     ///< Smoothed parameters per second
+        QTime                       lastStart;      ///< Time the last download was started on this link
+    } LinkState_t;
+
+    bool    _canStartDownload   (LinkInterface* link, const LinkState_t& linkState) const;
+    int     _nextPendingIndex   (const LinkState_t& linkState) const;
+    void    _startDownload      (LinkInterface* link, ParameterManager* parameterManager);
+
+    static double _capacityForSpeed(qint64 connectionSpeed);
+
+    MultiVehicleManager*                _multiVehicleManager;
+    QMap<LinkInterface*, LinkState_t>   _linkStates;
+    QTimer                              _throughputTimer;
+    QTime                               _throughputTime;
+    double                              _throughput;
+
+    static const int    _throughputIntervalMSecs =      1000;
+    static const int    _maxActiveDownloadsPerLink =    4;
+    static const int    _minStartSpacingMSecs =         2000;   ///< Time to let the throughput settle after starting a download
+    static const qint64 _defaultConnectionSpeed =       1000000;///< Bits per second assumed for links which do not report a speed
+    static const double _headroomFactor;                        ///< Fraction of capacity which must be unused to start another download
+    static const double _bitsPerParamValue;                     ///< Serial bits for one PARAM_VALUE message
+
+    friend class ParameterDownloadCoordinatorTest;
+};
+
+#endif
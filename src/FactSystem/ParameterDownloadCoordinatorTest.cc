@@ -0,0 +1,79 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#include "ParameterDownloadCoordinatorTest.h"
+#include "ParameterDownloadCoordinator.h"
+#include "MultiVehicleManager.h"
+#include "QGCApplication.h"
+
+void ParameterDownloadCoordinatorTest::_linkCapacityTest(void)
+{
+    double defaultCapacity = ParameterDownloadCoordinator::_capacityForSpeed(1000000);
+
+    QCOMPARE(ParameterDownloadCoordinator::linkCapacity(NULL), 0.0);
+    QVERIFY(qAbs(ParameterDownloadCoordinator::_capacityForSpeed(57600) * 1000000 / 57600 - defaultCapacity) < 1e-6);
+
+    // Links which do not report a speed must not stop downloads from running in parallel
+    QCOMPARE(ParameterDownloadCoordinator::_capacityForSpeed(0), defaultCapacity);
+    QCOMPARE(ParameterDownloadCoordinator::_capacityForSpeed(-1), defaultCapacity);
+    QVERIFY(defaultCapacity > 100);
+}
+
+void ParameterDownloadCoordinatorTest::_canStartDownloadTest(void)
+{
+    _connectMockLink(MAV_AUTOPILOT_PX4);
+
+    ParameterDownloadCoordinator*               coordinator = qgcApp()->toolbox()->multiVehicleManager()->parameterDownloadCoordinator();
+    LinkInterface*                              link = _vehicle->priorityLink();
+    ParameterManager*                           parameterManager = _vehicle->parameterManager();
+    ParameterDownloadCoordinator::LinkState_t   linkState;
+
+    linkState.receivedCount = 0;
+    linkState.throughput = 0;
+
+    // First download on a link always starts
+    QVERIFY(coordinator->_canStartDownload(link, linkState));
+
+    // Further downloads wait for the throughput to settle
+    linkState.active.append(parameterManager);
+    linkState.lastStart.start();
+    QVERIFY(!coordinator->_canStartDownload(link, linkState));
+
+    // Then start while there is headroom
+    linkState.lastStart = QTime();
+    QVERIFY(coordinator->_canStartDownload(link, linkState));
+    linkState.throughput = ParameterDownloadCoordinator::linkCapacity(link);
+    QVERIFY(!coordinator->_canStartDownload(link, linkState));
+
+    // Up to a limit
+    linkState.throughput = 0;
+    while (linkState.active.count() < ParameterDownloadCoordinator::_maxActiveDownloadsPerLink) {
+        linkState.active.append(parameterManager);
+    }
+    QVERIFY(!coordinator->_canStartDownload(link, linkState));
+
+    _disconnectMockLink();
+}
+
+void ParameterDownloadCoordinatorTest::_linkDeletedTest(void)
+{
+    _connectMockLink(MAV_AUTOPILOT_PX4);
+
+    ParameterDownloadCoordinator*   coordinator = qgcApp()->toolbox()->multiVehicleManager()->parameterDownloadCoordinator();
+    LinkInterface*                  link = _vehicle->priorityLink();
+
+    coordinator->parameterReceived(link);
+    QVERIFY(coordinator->_linkStates.contains(link));
+
+    // State is dropped as soon as the link goes away, not when the throughput timer next finds it idle
+    _disconnectMockLink();
+    QVERIFY(!coordinator->_linkStates.contains(link));
+    QCOMPARE(coordinator->pendingDownloads(), 0);
+}
@@ -0,0 +1,27 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#ifndef ParameterDownloadCoordinatorTest_H
+#define ParameterDownloadCoordinatorTest_H
+
+#include "UnitTest.h"
+
+/// Unit test for scheduling of parameter downloads by ParameterDownloadCoordinator
+class ParameterDownloadCoordinatorTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _linkCapacityTest(void);
+    void _canStartDownloadTest(void);
+    void _linkDeletedTest(void);
+};
+
+#endif
@@ -12,6 +12,7 @@
 ///     @author Don Gagne <don@thegagnes.com>
 
 #include "ParameterManager.h"
+#include "ParameterDownloadCoordinator.h"
 #include "QGCApplication.h"
 #include "QGCLoggingCategory.h"
 #include "QGCApplication.h"
@@ -19,6 +20,7 @@
 #include "FirmwarePlugin.h"
 #include "UAS.h"
 #include "JsonHelper.h"
+#include "MultiVehicleManager.h"
 
 #include <QEasingCurve>
 #include <QFile>
@@ -62,6 +64,11 @@ ParameterManager::ParameterManager(Vehicle* vehicle)
     , _disableAllRetries(false)
     , _indexBatchQueueActive(false)
     , _totalParamCount(0)
+    , _bulkWriteTotalCount(0)
+    , _bulkWriteCompleteCount(0)
+    , _bulkWriteInFlightCount(0)
+    , _requestListComponentId(MAV_COMP_ID_ALL)
+    , _requestListPending(false)
 {
     _versionParam = vehicle->firmwarePlugin()->getVersionParam();
 
@@ -71,6 +78,7 @@ ParameterManager::ParameterManager(Vehicle* vehicle)
     }
 
     _mavlink = qgcApp()->toolbox()->mavlinkProtocol();
+    _downloadCoordinator = qgcApp()->toolbox()->multiVehicleManager()->parameterDownloadCoordinator();
 
     _initialRequestTimeoutTimer.setSingleShot(true);
     _initialRequestTimeoutTimer.setInterval(5000);
@@ -80,6 +88,11 @@ ParameterManager::ParameterManager(Vehicle* vehicle)
     _waitingParamTimeoutTimer.setInterval(3000);
     connect(&_waitingParamTimeoutTimer, &QTimer::timeout, this, &ParameterManager::_waitingParamTimeout);
 
+    // Bulk writes have their own timer so a large write does not hold up read retries and vice versa
+    _bulkWriteTimeoutTimer.setSingleShot(true);
+    _bulkWriteTimeoutTimer.setInterval(1000);
+    connect(&_bulkWriteTimeoutTimer, &QTimer::timeout, this, &ParameterManager::_bulkWriteTimeout);
+
     connect(_vehicle->uas(), &UASInterface::parameterUpdate, this, &ParameterManager::_parameterUpdate);
 
     // Ensure the cache directory exists
@@ -90,6 +103,7 @@ ParameterManager::ParameterManager(Vehicle* vehicle)
 
 ParameterManager::~ParameterManager()
 {
+    _downloadComplete();
     delete _parameterMetaData;
 }
 
@@ -112,13 +126,17 @@ void ParameterManager::_parameterUpdate(int vehicleId, int componentId, QString
 
     // ArduPilot has this strange behavior of streaming parameters that we didn't ask for. This even happens before it responds to the
     // PARAM_REQUEST_LIST. We disregard any of this until the initial request is responded to.
-    if (parameterId == 65535 && parameterName != "_HASH_CHECK" && _initialRequestTimeoutTimer.isActive()) {
+    if (parameterId == 65535 && parameterName != "_HASH_CHECK" && (_initialRequestTimeoutTimer.isActive() || _requestListPending)) {
         qCDebug(ParameterManagerVerbose1Log) << "Disregarding unrequested param prior to initial list response" << parameterName;
         return;
     }
 
     _initialRequestTimeoutTimer.stop();
 
+    if (_downloadCoordinator) {
+        _downloadCoordinator->parameterReceived(_vehicle->priorityLink());
+    }
+
 #if 0
     if (!_initialLoadComplete && !_indexBatchQueueActive) {
         // Handy for testing retry logic
@@ -235,7 +253,7 @@ void ParameterManager::_parameterUpdate(int vehicleId, int componentId, QString
         _waitingParamTimeoutTimer.start();
         qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix() << "Restarting _waitingParamTimeoutTimer: totalWaitingParamCount:" << totalWaitingParamCount;
     } else {
-        if (!_mapParameterName2Variant.contains(_vehicle->defaultComponentId())) {
+        if (!_parameterStores.contains(_vehicle->defaultComponentId())) {
             // Still waiting for parameters from default component
             qCDebug(ParameterManagerLog) << _logVehiclePrefix() << "Restarting _waitingParamTimeoutTimer (still waiting for default component params)";
             _waitingParamTimeoutTimer.start();
@@ -250,6 +268,7 @@ void ParameterManager::_parameterUpdate(int vehicleId, int componentId, QString
         if (_prevWaitingReadParamIndexCount + _prevWaitingReadParamNameCount != 0) {
             // Set progress to 0 if not already there
             _setLoadProgress(0.0);
+            _downloadComplete();
         }
     } else {
         _setLoadProgress((double)(_totalParamCount - readWaitingParamCount) / (double)_totalParamCount);
@@ -260,8 +279,10 @@ void ParameterManager::_parameterUpdate(int vehicleId, int componentId, QString
         _parameterSetMajorVersion = value.toInt();
     }
 
-    if (!_mapParameterName2Variant.contains(componentId) || !_mapParameterName2Variant[componentId].contains(parameterName)) {
-        qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "Adding new fact" << parameterName;
+    ParameterStore& store = _parameterStores[componentId];
+    int paramIndex = store.indexOf(parameterName);
+    if (paramIndex == -1) {
+        qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "Adding new parameter" << parameterName;
 
         FactMetaData::ValueType_t factType;
         switch (mavType) {
@@ -295,26 +316,20 @@ void ParameterManager::_parameterUpdate(int vehicleId, int componentId, QString
                 break;
         }
 
-        Fact* fact = new Fact(componentId, parameterName, factType, this);
-
-        _mapParameterName2Variant[componentId][parameterName] = QVariant::fromValue(fact);
-
-        // We need to know when the fact changes from QML so that we can send the new value to the parameter manager
-        connect(fact, &Fact::_containerRawValueChanged, this, &ParameterManager::_valueUpdated);
+        // The Fact itself is not created until someone asks for it
+        paramIndex = store.add(parameterName, factType);
     }
+    store.setRawValue(paramIndex, value);
 
     _dataMutex.unlock();
 
-    Fact* fact = NULL;
-    if (_mapParameterName2Variant[componentId].contains(parameterName)) {
-        fact = _mapParameterName2Variant[componentId][parameterName].value<Fact*>();
-    }
+    Fact* fact = store.fact(paramIndex);
     if (fact) {
         fact->_containerSetRawValue(value);
-    } else {
-        qWarning() << "Internal error";
     }
 
+    _bulkWriteAck(componentId, parameterName, value);
+
     if (componentParamsComplete) {
         if (componentId == _vehicle->defaultComponentId()) {
             // Add meta data to default component. We need to do this before we setup the group map since group
@@ -368,6 +383,12 @@ void ParameterManager::_valueUpdated(const QVariant& value)
 
     _dataMutex.lock();
 
+    ParameterStore& store = _parameterStores[componentId];
+    int paramIndex = store.indexOf(name);
+    if (paramIndex != -1) {
+        store.setRawValue(paramIndex, value);
+    }
+
     if (_waitingWriteParamNameMap.contains(componentId)) {
         _waitingWriteParamNameMap[componentId].remove(name);    // Remove any old entry
         _waitingWriteParamNameMap[componentId][name] = 0;       // Add new entry and set retry count
@@ -395,10 +416,6 @@ void ParameterManager::refreshAllParameters(uint8_t componentId)
 
     _dataMutex.lock();
 
-    if (!_initialLoadComplete) {
-        _initialRequestTimeoutTimer.start();
-    }
-
     // Reset index wait lists
     foreach (int cid, _paramCountMap.keys()) {
         // Add/Update all indices to the wait list, parameter index is 0-based
@@ -412,6 +429,25 @@ void ParameterManager::refreshAllParameters(uint8_t componentId)
 
     _dataMutex.unlock();
 
+    // The coordinator decides when the request actually goes out so vehicles sharing a link don't all download at once
+    _requestListComponentId = componentId;
+    if (_downloadCoordinator) {
+        _requestListPending = true;
+        _downloadCoordinator->requestDownload(this, _vehicle->priorityLink());
+    } else {
+        _sendParameterRequestList();
+    }
+}
+
+/// Sends the PARAM_REQUEST_LIST for the last call to refreshAllParameters
+void ParameterManager::_sendParameterRequestList(void)
+{
+    _requestListPending = false;
+
+    if (!_initialLoadComplete) {
+        _initialRequestTimeoutTimer.start();
+    }
+
     MAVLinkProtocol* mavlink = qgcApp()->toolbox()->mavlinkProtocol();
 
     mavlink_message_t msg;
@@ -420,13 +456,22 @@ void ParameterManager::refreshAllParameters(uint8_t componentId)
                                              _vehicle->priorityLink()->mavlinkChannel(),
                                              &msg,
                                              _vehicle->id(),
-                                             componentId);
+                                             _requestListComponentId);
     _vehicle->sendMessageOnLink(_vehicle->priorityLink(), msg);
 
-    QString what = (componentId == MAV_COMP_ID_ALL) ? "MAV_COMP_ID_ALL" : QString::number(componentId);
+    QString what = (_requestListComponentId == MAV_COMP_ID_ALL) ? "MAV_COMP_ID_ALL" : QString::number(_requestListComponentId);
     qCDebug(ParameterManagerLog) << _logVehiclePrefix() << "Request to refresh all parameters for component ID:" << what;
 }
 
+/// Tells the download coordinator we are done with the link
+void ParameterManager::_downloadComplete(void)
+{
+    _requestListPending = false;
+    if (_downloadCoordinator) {
+        _downloadCoordinator->downloadComplete(this);
+    }
+}
+
 /// Translates FactSystem::defaultComponentId to real component id if needed
 int ParameterManager::_actualComponentId(int componentId)
 {
@@ -468,7 +513,7 @@ void ParameterManager::refreshParametersPrefix(int componentId, const QString& n
     componentId = _actualComponentId(componentId);
     qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "refreshParametersPrefix - name:" << namePrefix << ")";
 
-    foreach(const QString &name, _mapParameterName2Variant[componentId].keys()) {
+    foreach(const QString &name, _parameterStores[componentId].names()) {
         if (name.startsWith(namePrefix)) {
             refreshParameter(componentId, name);
         }
@@ -480,8 +525,8 @@ bool ParameterManager::parameterExists(int componentId, const QString&  name)
     bool ret = false;
 
     componentId = _actualComponentId(componentId);
-    if (_mapParameterName2Variant.contains(componentId)) {
-        ret = _mapParameterName2Variant[componentId].contains(_remapParamNameToVersion(name));
+    if (_parameterStores.contains(componentId)) {
+        ret = _parameterStores[componentId].contains(_remapParamNameToVersion(name));
     }
 
     return ret;
@@ -492,23 +537,124 @@ Fact* ParameterManager::getParameter(int componentId, const QString& name)
     componentId = _actualComponentId(componentId);
 
     QString mappedParamName = _remapParamNameToVersion(name);
-    if (!_mapParameterName2Variant.contains(componentId) || !_mapParameterName2Variant[componentId].contains(mappedParamName)) {
+    int paramIndex = _parameterStores.contains(componentId) ? _parameterStores[componentId].indexOf(mappedParamName) : -1;
+    if (paramIndex == -1) {
         qgcApp()->reportMissingParameter(componentId, mappedParamName);
         return &_defaultFact;
     }
 
-    return _mapParameterName2Variant[componentId][mappedParamName].value<Fact*>();
+    return _materializeFact(componentId, paramIndex);
+}
+
+/// Returns the Fact for the specified parameter, creating it if needed
+Fact* ParameterManager::_materializeFact(int componentId, int index)
+{
+    ParameterStore& store = _parameterStores[componentId];
+
+    Fact* fact = store.fact(index);
+    if (!fact) {
+        fact = new Fact(componentId, store.name(index), store.type(index), this);
+        store.setFact(index, fact);
+
+        if (_parameterMetaData && componentId == _vehicle->defaultComponentId()) {
+            _vehicle->firmwarePlugin()->addMetaDataToFact(_parameterMetaData, fact, _vehicle->vehicleType());
+        }
+        fact->_containerSetRawValue(store.rawValue(index));
+
+        if (!_vehicle->isOfflineEditingVehicle()) {
+            // We need to know when the fact changes from QML so that we can send the new value to the parameter manager
+            connect(fact, &Fact::_containerRawValueChanged, this, &ParameterManager::_valueUpdated);
+        }
+    }
+
+    return fact;
 }
 
 QStringList ParameterManager::parameterNames(int componentId)
 {
-    QStringList names;
+    componentId = _actualComponentId(componentId);
+    if (!_parameterStores.contains(componentId)) {
+        return QStringList();
+    }
+
+    return _parameterStores[componentId].names();
+}
+
+/// Returns the group for the specified parameter without creating a Fact for it
+QString ParameterManager::_parameterGroup(int componentId, int index)
+{
+    const ParameterStore& store = _parameterStores[componentId];
+
+    Fact* fact = store.fact(index);
+    if (fact) {
+        return fact->group();
+    }
+
+    if (_parameterMetaData && componentId == _vehicle->defaultComponentId()) {
+        QString group = _vehicle->firmwarePlugin()->getParameterMetaDataGroup(_parameterMetaData, store.name(index), _vehicle->vehicleType());
+        if (!group.isEmpty()) {
+            return group;
+        }
+    }
+
+    return FactMetaData::defaultGroup;
+}
+
+/// Returns the descriptions for the specified parameter without creating a Fact for it
+void ParameterManager::_parameterDescriptions(int componentId, int index, QString& shortDescription, QString& longDescription)
+{
+    const ParameterStore& store = _parameterStores[componentId];
+
+    Fact* fact = store.fact(index);
+    if (fact) {
+        shortDescription = fact->shortDescription();
+        longDescription = fact->longDescription();
+    } else if (_parameterMetaData && componentId == _vehicle->defaultComponentId()) {
+        _vehicle->firmwarePlugin()->getParameterMetaDataDescriptions(_parameterMetaData, store.name(index), _vehicle->vehicleType(), shortDescription, longDescription);
+    } else {
+        shortDescription.clear();
+        longDescription.clear();
+    }
+}
 
-    foreach(const QString &paramName, _mapParameterName2Variant[_actualComponentId(componentId)].keys()) {
-        names << paramName;
+/// Adds any parameters which are not yet in the search index for the component
+void ParameterManager::_updateSearchIndex(int componentId)
+{
+    const ParameterStore&   store = _parameterStores[componentId];
+    ParameterSearchIndex&   searchIndex = _searchIndexes[componentId];
+
+    for (int i=0; i<store.count(); i++) {
+        if (!searchIndex.contains(i)) {
+            QString shortDescription, longDescription;
+
+            _parameterDescriptions(componentId, i, shortDescription, longDescription);
+            searchIndex.setParameter(i, store.name(i), shortDescription, longDescription);
+        }
+    }
+}
+
+QStringList ParameterManager::searchParameters(int componentId, const QString& searchText, bool searchInName, bool searchInDescriptions)
+{
+    componentId = _actualComponentId(componentId);
+    if (!_parameterStores.contains(componentId)) {
+        return QStringList();
+    }
+
+    const ParameterStore& store = _parameterStores[componentId];
+    if (searchText.isEmpty()) {
+        return store.names();
     }
 
-    return names;
+    // Pick up parameters which arrived since the index was last updated
+    _updateSearchIndex(componentId);
+
+    QStringList list;
+    foreach (int paramIndex, _searchIndexes[componentId].search(searchText, searchInName, searchInDescriptions)) {
+        list += store.name(paramIndex);
+    }
+    list.sort();
+
+    return list;
 }
 
 void ParameterManager::_setupGroupMap(void)
@@ -516,11 +662,14 @@ void ParameterManager::_setupGroupMap(void)
     // Must be able to handle being called multiple times
     _mapGroup2ParameterName.clear();
 
-    foreach (int componentId, _mapParameterName2Variant.keys()) {
-        foreach (const QString &name, _mapParameterName2Variant[componentId].keys()) {
-            Fact* fact = _mapParameterName2Variant[componentId][name].value<Fact*>();
-            _mapGroup2ParameterName[componentId][fact->group()] += name;
+    foreach (int componentId, _parameterStores.keys()) {
+        const ParameterStore& store = _parameterStores[componentId];
+        foreach (const QString &name, store.names()) {
+            _mapGroup2ParameterName[componentId][_parameterGroup(componentId, store.indexOf(name))] += name;
         }
+
+        // Build the search index up front so the first search does not pay for it
+        _updateSearchIndex(componentId);
     }
 }
 
@@ -548,7 +697,13 @@ bool ParameterManager::_fillIndexBatchQueue(bool waitingParamTimeout)
         qCDebug(ParameterManagerLog) << "Refilling index based batch queue due to received parameter";
     }
 
-    foreach(int componentId, _waitingReadParamIndexMap.keys()) {
+    // Missing default component parameters hold up the vehicle being ready, so request those first
+    QList<int> componentIds = _waitingReadParamIndexMap.keys();
+    if (componentIds.removeOne(_vehicle->defaultComponentId())) {
+        componentIds.prepend(_vehicle->defaultComponentId());
+    }
+
+    foreach(int componentId, componentIds) {
         if (_waitingReadParamIndexMap[componentId].count()) {
             qCDebug(ParameterManagerLog) << _logVehiclePrefix() << "_waitingReadParamIndexMap count" << _waitingReadParamIndexMap[componentId].count();
             qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix() << "_waitingReadParamIndexMap" << _waitingReadParamIndexMap[componentId];
@@ -596,10 +751,10 @@ void ParameterManager::_waitingParamTimeout(void)
     // First check for any missing parameters from the initial index based load
     paramsRequested = _fillIndexBatchQueue(true /* waitingParamTimeout */);
 
-    if (!paramsRequested && !_waitingForDefaultComponent && !_mapParameterName2Variant.contains(_vehicle->defaultComponentId())) {
+    if (!paramsRequested && !_waitingForDefaultComponent && !_parameterStores.contains(_vehicle->defaultComponentId())) {
         // Initial load is complete but we still don't have any default component params. Wait one more cycle to see if the
         // any show up.
-        qCDebug(ParameterManagerLog) << _logVehiclePrefix() << "Restarting _waitingParamTimeoutTimer - still don't have default component params" << _vehicle->defaultComponentId() << _mapParameterName2Variant.keys();
+        qCDebug(ParameterManagerLog) << _logVehiclePrefix() << "Restarting _waitingParamTimeoutTimer - still don't have default component params" << _vehicle->defaultComponentId() << _parameterStores.keys();
         _waitingParamTimeoutTimer.start();
         _waitingForDefaultComponent = true;
         return;
@@ -614,7 +769,8 @@ void ParameterManager::_waitingParamTimeout(void)
                 paramsRequested = true;
                 _waitingWriteParamNameMap[componentId][paramName]++;   // Bump retry count
                 if (_waitingWriteParamNameMap[componentId][paramName] <= _maxReadWriteRetry) {
-                    _writeParameterRaw(componentId, paramName, getParameter(componentId, paramName)->rawValue());
+                    const ParameterStore& store = _parameterStores[componentId];
+                    _writeParameterRaw(componentId, paramName, store.rawValue(store.indexOf(paramName)));
                     qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Write resend for (paramName:" << paramName << "retryCount:" << _waitingWriteParamNameMap[componentId][paramName] << ")";
                     if (++batchCount > maxBatchSize) {
                         goto Out;
@@ -683,7 +839,13 @@ void ParameterManager::_writeParameterRaw(int componentId, const QString& paramN
 
     memset(&p, 0, sizeof(p));
 
-    FactMetaData::ValueType_t factType = getParameter(componentId, paramName)->type();
+    const ParameterStore& store = _parameterStores[componentId];
+    int paramIndex = store.indexOf(paramName);
+    if (paramIndex == -1) {
+        qWarning() << "Internal error: write of unknown parameter" << componentId << paramName;
+        return;
+    }
+    FactMetaData::ValueType_t factType = store.type(paramIndex);
     p.param_type = _factTypeToMavType(factType);
 
     switch (factType) {
@@ -739,10 +901,11 @@ void ParameterManager::_writeLocalParamCache(int vehicleId, int componentId)
 {
     MapID2NamedParam cache_map;
 
+    const ParameterStore& store = _parameterStores[componentId];
     foreach(int id, _mapParameterId2Name[componentId].keys()) {
         const QString name(_mapParameterId2Name[componentId][id]);
-        const Fact *fact = _mapParameterName2Variant[componentId][name].value<Fact*>();
-        cache_map[id] = NamedParam(name, ParamTypeVal(fact->type(), fact->rawValue()));
+        int paramIndex = store.indexOf(name);
+        cache_map[id] = NamedParam(name, ParamTypeVal(store.type(paramIndex), store.rawValue(paramIndex)));
     }
 
     QFile cache_file(parameterCacheFile(vehicleId, componentId));
@@ -859,7 +1022,8 @@ void ParameterManager::_saveToEEPROM(void)
 
 QString ParameterManager::readParametersFromStream(QTextStream& stream)
 {
-    QString errors;
+    QString                             errors;
+    QMap<int, QMap<QString, QVariant> > values;
 
     while (!stream.atEnd()) {
         QString line = stream.readLine();
@@ -884,21 +1048,36 @@ QString ParameterManager::readParametersFromStream(QTextStream& stream)
                     continue;
                 }
 
-                Fact* fact = getParameter(componentId, paramName);
-                if (fact->type() != _mavTypeToFactType((MAV_PARAM_TYPE)mavType)) {
+                componentId = _actualComponentId(componentId);
+                paramName = _remapParamNameToVersion(paramName);
+                const ParameterStore& store = _parameterStores[componentId];
+                FactMetaData::ValueType_t factType = store.type(store.indexOf(paramName));
+                if (factType != _mavTypeToFactType((MAV_PARAM_TYPE)mavType)) {
+                    QString error;
+                    error  = QString("Skipped parameter %1:%2 - type mismatch %3:%4\n").arg(componentId).arg(paramName).arg(factType).arg(_mavTypeToFactType((MAV_PARAM_TYPE)mavType));
+                    errors += error;
+                    qCDebug(ParameterManagerLog) << error;
+                    continue;
+                }
+
+                bool convertOk;
+                QVariant value = ParameterStore::typedRawValue(factType, valStr, &convertOk);
+                if (!convertOk) {
                     QString error;
-                    error  = QString("Skipped parameter %1:%2 - type mismatch %3:%4\n").arg(componentId).arg(paramName).arg(fact->type()).arg(_mavTypeToFactType((MAV_PARAM_TYPE)mavType));
+                    error  = QString("Skipped parameter %1:%2 - invalid value %3\n").arg(componentId).arg(paramName).arg(valStr);
                     errors += error;
                     qCDebug(ParameterManagerLog) << error;
                     continue;
                 }
 
                 qCDebug(ParameterManagerLog) << "Updating parameter" << componentId << paramName << valStr;
-                fact->setRawValue(valStr);
+                values[componentId][paramName] = value;
             }
         }
     }
 
+    writeParameters(values);
+
     return errors;
 }
 
@@ -919,14 +1098,11 @@ void ParameterManager::writeParametersToStream(QTextStream &stream)
     stream << "#\n";
     stream << "# Vehicle-Id Component-Id Name Value Type\n";
 
-    foreach (int componentId, _mapParameterName2Variant.keys()) {
-        foreach (const QString &paramName, _mapParameterName2Variant[componentId].keys()) {
-            Fact* fact = _mapParameterName2Variant[componentId][paramName].value<Fact*>();
-            if (fact) {
-                stream << _vehicle->id() << "\t" << componentId << "\t" << paramName << "\t" << fact->rawValueStringFullPrecision() << "\t" << QString("%1").arg(_factTypeToMavType(fact->type())) << "\n";
-            } else {
-                qWarning() << "Internal error: missing fact";
-            }
+    foreach (int componentId, _parameterStores.keys()) {
+        const ParameterStore& store = _parameterStores[componentId];
+        foreach (const QString &paramName, store.names()) {
+            int paramIndex = store.indexOf(paramName);
+            stream << _vehicle->id() << "\t" << componentId << "\t" << paramName << "\t" << store.rawValueStringFullPrecision(paramIndex) << "\t" << QString("%1").arg(_factTypeToMavType(store.type(paramIndex))) << "\n";
         }
     }
 
@@ -1008,10 +1184,16 @@ void ParameterManager::_addMetaDataToDefaultComponent(void)
 
      _parameterMetaData = _vehicle->firmwarePlugin()->loadParameterMetaData(metaDataFile);
 
-    // Loop over all parameters in default component adding meta data
-    QVariantMap& factMap = _mapParameterName2Variant[_vehicle->defaultComponentId()];
-    foreach (const QString& key, factMap.keys()) {
-        _vehicle->firmwarePlugin()->addMetaDataToFact(_parameterMetaData, factMap[key].value<Fact*>(), _vehicle->vehicleType());
+    // Default component parameters may have been indexed without descriptions
+    _searchIndexes.remove(_vehicle->defaultComponentId());
+
+    // Add meta data to any default component Facts which have already been created. The remainder get their meta data
+    // as they are created.
+    const ParameterStore& store = _parameterStores[_vehicle->defaultComponentId()];
+    for (int i=0; i<store.count(); i++) {
+        if (store.fact(i)) {
+            _vehicle->firmwarePlugin()->addMetaDataToFact(_parameterMetaData, store.fact(i), _vehicle->vehicleType());
+        }
     }
 }
 
@@ -1029,13 +1211,14 @@ void ParameterManager::_checkInitialLoadComplete(void)
         }
     }
 
-    if (!_mapParameterName2Variant.contains(_vehicle->defaultComponentId())) {
+    if (!_parameterStores.contains(_vehicle->defaultComponentId())) {
         // No default component params yet, not done yet
         return;
     }
 
     // We aren't waiting for any more initial parameter updates, initial parameter loading is complete
     _initialLoadComplete = true;
+    _downloadComplete();
 
     qCDebug(ParameterManagerLog) << _logVehiclePrefix() << "Initial load complete";
 
@@ -1087,6 +1270,7 @@ void ParameterManager::_initialRequestTimeout(void)
             qCDebug(ParameterManagerLog) << errorMsg;
             qgcApp()->showMessage(errorMsg);
         }
+        _downloadComplete();
     }
 }
 
@@ -1342,8 +1526,12 @@ void ParameterManager::_loadOfflineEditingParams(void)
             _parameterSetMajorVersion = paramValue.toInt();
         }
 
-        Fact* fact = new Fact(defaultComponentId, paramName, _mavTypeToFactType(paramType), this);
-        _mapParameterName2Variant[defaultComponentId][paramName] = QVariant::fromValue(fact);
+        ParameterStore& store = _parameterStores[defaultComponentId];
+        int paramIndex = store.indexOf(paramName);
+        if (paramIndex == -1) {
+            paramIndex = store.add(paramName, _mavTypeToFactType(paramType));
+        }
+        store.setRawValue(paramIndex, paramValue);
     }
 
     _addMetaDataToDefaultComponent();
@@ -1358,7 +1546,7 @@ void ParameterManager::saveToJson(int componentId, const QStringList& paramsToSa
     QStringList rgParamNames;
 
     if (componentId == MAV_COMP_ID_ALL) {
-        rgCompIds = _mapParameterName2Variant.keys();
+        rgCompIds = _parameterStores.keys();
     } else {
         rgCompIds.append(_actualComponentId(componentId));
     }
@@ -1369,7 +1557,7 @@ void ParameterManager::saveToJson(int componentId, const QStringList& paramsToSa
     for (int i=0; i<rgCompIds.count(); i++) {
         int compId = rgCompIds[i];
 
-        if (!_mapParameterName2Variant.contains(compId)) {
+        if (!_parameterStores.contains(compId)) {
             qCDebug(ParameterManagerLog) << "ParameterManager::saveToJson no params for compId" << compId;
             continue;
         }
@@ -1391,10 +1579,11 @@ void ParameterManager::saveToJson(int componentId, const QStringList& paramsToSa
             }
 
             QJsonObject paramJson;
-            Fact* fact = getParameter(compId, paramName);
+            const ParameterStore& store = _parameterStores[compId];
+            int paramIndex = store.indexOf(_remapParamNameToVersion(paramName));
             paramJson.insert(_jsonCompIdKey, QJsonValue(compId));
-            paramJson.insert(_jsonParamNameKey, QJsonValue(fact->name()));
-            paramJson.insert(_jsonParamValueKey, QJsonValue(fact->rawValue().toDouble()));
+            paramJson.insert(_jsonParamNameKey, QJsonValue(store.name(paramIndex)));
+            paramJson.insert(_jsonParamValueKey, QJsonValue(store.rawValue(paramIndex).toDouble()));
 
             rgParams.append(QJsonValue(paramJson));
         }
@@ -1422,6 +1611,7 @@ bool ParameterManager::loadFromJson(const QJsonObject& json, bool required, QStr
         return false;
     }
 
+    QMap<int, QMap<QString, QVariant> > values;
     QJsonArray rgParams = json[_jsonParametersKey].toArray();
     for (int i=0; i<rgParams.count(); i++) {
         QJsonValueRef paramValue = rgParams[i];
@@ -1450,13 +1640,183 @@ bool ParameterManager::loadFromJson(const QJsonObject& json, bool required, QStr
             continue;
         }
 
-        Fact* fact = getParameter(compId, name);
-        fact->setRawValue(value);
+        compId = _actualComponentId(compId);
+        values[compId][_remapParamNameToVersion(name)] = value;
     }
 
+    writeParameters(values);
+
     return true;
 }
 
+int ParameterManager::writeParameters(const QMap<int, QMap<QString, QVariant> >& values)
+{
+    int queuedCount = 0;
+
+    foreach (int componentId, values.keys()) {
+        if (!_parameterStores.contains(componentId)) {
+            qCWarning(ParameterManagerLog) << _logVehiclePrefix(componentId) << "writeParameters unknown component";
+            continue;
+        }
+        ParameterStore& store = _parameterStores[componentId];
+
+        QMapIterator<QString, QVariant> iter(values[componentId]);
+        while (iter.hasNext()) {
+            iter.next();
+
+            int paramIndex = store.indexOf(iter.key());
+            if (paramIndex == -1) {
+                qCWarning(ParameterManagerLog) << _logVehiclePrefix(componentId) << "writeParameters unknown parameter" << iter.key();
+                continue;
+            }
+
+            // Skip parameters which are already set correctly, unless they are already waiting to be written
+            QVariant value = ParameterStore::typedRawValue(store.type(paramIndex), iter.value());
+            if (store.rawValueEquals(paramIndex, value) && !_bulkWriteInFlightMap[componentId].contains(iter.key())) {
+                continue;
+            }
+
+            if (_vehicle->isOfflineEditingVehicle()) {
+                // Nothing to send to, just update locally
+                store.setRawValue(paramIndex, value);
+                if (store.fact(paramIndex)) {
+                    store.fact(paramIndex)->_containerSetRawValue(value);
+                }
+                continue;
+            }
+
+            BulkWrite_t bulkWrite;
+            bulkWrite.componentId = componentId;
+            bulkWrite.paramName = store.name(paramIndex);
+            bulkWrite.value = value;
+            bulkWrite.retryCount = 0;
+            _bulkWriteQueue.append(bulkWrite);
+
+            // A pending single write of the same parameter would fight with the bulk write
+            _waitingWriteParamNameMap[componentId].remove(iter.key());
+
+            queuedCount++;
+        }
+    }
+
+    qCDebug(ParameterManagerLog) << _logVehiclePrefix() << "writeParameters queued:" << queuedCount;
+
+    if (queuedCount == 0 && _bulkWriteTotalCount == 0) {
+        emit bulkWriteComplete(QStringList());
+        return 0;
+    }
+
+    _bulkWriteTotalCount += queuedCount;
+    emit bulkWriteProgressChanged(bulkWriteProgress());
+    _bulkWriteSendNext();
+
+    return queuedCount;
+}
+
+/// Fills the bulk write window from the queue
+void ParameterManager::_bulkWriteSendNext(void)
+{
+    while (_bulkWriteInFlightCount < _bulkWriteWindowSize && !_bulkWriteQueue.isEmpty()) {
+        BulkWrite_t bulkWrite = _bulkWriteQueue.takeFirst();
+
+        if (_bulkWriteInFlightMap[bulkWrite.componentId].contains(bulkWrite.paramName)) {
+            // Newer value for a parameter which is already in flight. Count the older write as done and send the new value.
+            _bulkWriteInFlightMap[bulkWrite.componentId].remove(bulkWrite.paramName);
+            _bulkWriteInFlightCount--;
+            _bulkWriteCompleteCount++;
+        }
+
+        _bulkWriteInFlightMap[bulkWrite.componentId][bulkWrite.paramName] = bulkWrite;
+        _bulkWriteInFlightCount++;
+        _saveRequired = true;
+        _writeParameterRaw(bulkWrite.componentId, bulkWrite.paramName, bulkWrite.value);
+    }
+
+    if (_bulkWriteInFlightCount) {
+        _bulkWriteTimeoutTimer.start();
+    }
+}
+
+/// Called for every PARAM_VALUE to check whether it acks a bulk write
+void ParameterManager::_bulkWriteAck(int componentId, const QString& paramName, const QVariant& value)
+{
+    if (!_bulkWriteInFlightMap.contains(componentId) || !_bulkWriteInFlightMap[componentId].contains(paramName)) {
+        return;
+    }
+
+    const BulkWrite_t& bulkWrite = _bulkWriteInFlightMap[componentId][paramName];
+    const ParameterStore& store = _parameterStores[componentId];
+    if (!ParameterStore::rawValuesEqual(store.type(store.indexOf(paramName)), bulkWrite.value, value)) {
+        // This may be a stale value from an earlier read, or the vehicle may have rejected the value. Either way keep
+        // waiting, the write is resent on timeout and fails once retries are exhausted.
+        qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Bulk write value mismatch" << paramName << "requested:" << bulkWrite.value << "vehicle:" << value;
+        return;
+    }
+
+    _bulkWriteParamComplete(componentId, paramName, true /* success */);
+}
+
+void ParameterManager::_bulkWriteParamComplete(int componentId, const QString& paramName, bool success)
+{
+    _bulkWriteInFlightMap[componentId].remove(paramName);
+    _bulkWriteInFlightCount--;
+    _bulkWriteCompleteCount++;
+    if (!success) {
+        _bulkWriteFailed.append(QStringLiteral("%1:%2").arg(componentId).arg(paramName));
+    }
+
+    if (_bulkWriteInFlightCount == 0 && _bulkWriteQueue.isEmpty()) {
+        QStringList failed = _bulkWriteFailed;
+
+        qCDebug(ParameterManagerLog) << _logVehiclePrefix() << "Bulk write complete count:failed" << _bulkWriteTotalCount << failed.count();
+
+        _bulkWriteTimeoutTimer.stop();
+        _bulkWriteFailed.clear();
+        _bulkWriteTotalCount = 0;
+        _bulkWriteCompleteCount = 0;
+        _bulkWriteInFlightMap.clear();
+        emit bulkWriteProgressChanged(0.0);
+
+        // Persist once for the whole set rather than once per parameter
+        _saveToEEPROM();
+
+        emit bulkWriteComplete(failed);
+        return;
+    }
+
+    // Acks are processed as they arrive, each one opens a slot in the window
+    _bulkWriteSendNext();
+    emit bulkWriteProgressChanged(bulkWriteProgress());
+}
+
+void ParameterManager::_bulkWriteTimeout(void)
+{
+    QList<QPair<int, QString> > failedWrites;
+
+    foreach (int componentId, _bulkWriteInFlightMap.keys()) {
+        QMap<QString, BulkWrite_t>& inFlightMap = _bulkWriteInFlightMap[componentId];
+        foreach (const QString& paramName, inFlightMap.keys()) {
+            BulkWrite_t& bulkWrite = inFlightMap[paramName];
+            if (++bulkWrite.retryCount <= _maxReadWriteRetry && !_disableAllRetries) {
+                qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Bulk write resend for (paramName:" << paramName << "retryCount:" << bulkWrite.retryCount << ")";
+                _writeParameterRaw(componentId, paramName, bulkWrite.value);
+            } else {
+                failedWrites.append(QPair<int, QString>(componentId, paramName));
+                qCWarning(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Bulk write failed" << paramName << bulkWrite.value;
+            }
+        }
+    }
+
+    // Completing a write may send more, so wait until the in flight map is no longer being walked
+    for (int i=0; i<failedWrites.count(); i++) {
+        _bulkWriteParamComplete(failedWrites[i].first, failedWrites[i].second, false);
+    }
+
+    if (_bulkWriteInFlightCount) {
+        _bulkWriteTimeoutTimer.start();
+    }
+}
+
 void ParameterManager::resetAllParametersToDefaults(void)
 {
     _vehicle->sendMavCommand(MAV_COMP_ID_ALL,
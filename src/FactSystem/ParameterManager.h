@@ -18,12 +18,15 @@
 #include <QMutex>
 #include <QDir>
 #include <QJsonObject>
+#include <QPointer>
 
 #include "FactSystem.h"
 #include "MAVLinkProtocol.h"
 #include "AutoPilotPlugin.h"
 #include "QGCMAVLink.h"
 #include "Vehicle.h"
+#include "ParameterStore.h"
+#include "ParameterSearchIndex.h"
 
 /// @file
 ///     @author Don Gagne <don@thegagnes.com>
@@ -31,6 +34,8 @@
 Q_DECLARE_LOGGING_CATEGORY(ParameterManagerVerbose1Log)
 Q_DECLARE_LOGGING_CATEGORY(ParameterManagerVerbose2Log)
 
+class ParameterDownloadCoordinator;
+
 /// Connects to Parameter Manager to load/update Facts
 class ParameterManager : public QObject
 {
@@ -52,6 +57,10 @@ public:
     Q_PROPERTY(double loadProgress READ loadProgress NOTIFY loadProgressChanged)
     double loadProgress(void) const { return _loadProgress; }
 
+    /// Progress for the current writeParameters operation, [0.0,1.0]. 0.0 when no bulk write is active.
+    Q_PROPERTY(double bulkWriteProgress READ bulkWriteProgress NOTIFY bulkWriteProgressChanged)
+    double bulkWriteProgress(void) const { return _bulkWriteTotalCount ? (double)_bulkWriteCompleteCount / (double)_bulkWriteTotalCount : 0.0; }
+
     /// @return Directory of parameter caches
     static QDir parameterCacheDir();
 
@@ -85,12 +94,25 @@ public:
     Fact* getParameter(int componentId, const QString& name);
     
     const QMap<int, QMap<QString, QStringList> >& getGroupMap(void);
+
+    /// Returns the parameters which contain the search text (case insensitive). Facts are not created for the search.
+    ///     @param componentId Component id or FactSystem::defaultComponentId
+    /// @return Sorted list of matching parameter names, all parameters if search text is empty
+    QStringList searchParameters(int componentId, const QString& searchText, bool searchInName, bool searchInDescriptions);
     
     /// Returns error messages from loading
     QString readParametersFromStream(QTextStream& stream);
     
     void writeParametersToStream(QTextStream &stream);
 
+    /// Writes a set of parameter values to the vehicle as a single bulk operation. Parameters which already have the
+    /// requested value are skipped. PARAM_SETs are pipelined with a window of outstanding writes, and each ack is
+    /// verified against the requested value. Facts are updated as the acks arrive. Completion is signalled through
+    /// bulkWriteComplete. Calling this while a bulk write is active adds to the active write.
+    ///     @param values Key: component id, Value: Map { Key: parameter name, Value: new raw value }
+    /// @return Number of parameters which will be written
+    int writeParameters(const QMap<int, QMap<QString, QVariant> >& values);
+
     /// Returns the version number for the parameter set, -1 if not known
     int parameterSetVersion(void) { return _parameterSetMajorVersion; }
 
@@ -123,6 +145,11 @@ signals:
     void parametersReadyChanged(bool parametersReady);
     void missingParametersChanged(bool missingParameters);
     void loadProgressChanged(float value);
+    void bulkWriteProgressChanged(double progress);
+
+    /// Signalled when all parameters from writeParameters have been acked or have failed
+    ///     @param failedParameters Parameters which could not be written, as "componentId:name"
+    void bulkWriteComplete(QStringList failedParameters);
     
 protected:
     Vehicle*            _vehicle;
@@ -153,12 +180,24 @@ private:
     FactMetaData::ValueType_t _mavTypeToFactType(MAV_PARAM_TYPE mavType);
     void _saveToEEPROM(void);
     void _checkInitialLoadComplete(void);
-
-    /// First mapping is by component id
-    /// Second mapping is parameter name, to Fact* in QVariant
-    QMap<int, QVariantMap>            _mapParameterName2Variant;
+    void _sendParameterRequestList(void);
+    void _downloadComplete(void);
+    void _bulkWriteSendNext(void);
+    void _bulkWriteAck(int componentId, const QString& paramName, const QVariant& value);
+    void _bulkWriteTimeout(void);
+    void _bulkWriteParamComplete(int componentId, const QString& paramName, bool success);
+    Fact* _materializeFact(int componentId, int index);
+    QString _parameterGroup(int componentId, int index);
+    void _parameterDescriptions(int componentId, int index, QString& shortDescription, QString& longDescription);
+    void _updateSearchIndex(int componentId);
+
+    /// Key: component id, Value: parameters for component. Facts are created on demand from the store.
+    QMap<int, ParameterStore>         _parameterStores;
 
     QMap<int, QMap<int, QString> >    _mapParameterId2Name;
+
+    /// Key: component id, Value: search index for component parameters. Keyed by index within the component store.
+    QMap<int, ParameterSearchIndex>   _searchIndexes;
     
     /// First mapping is by component id
     /// Second mapping is group name, to Fact
@@ -196,6 +235,30 @@ private:
     QMap<int, QList<int> >          _failedReadParamIndexMap;   ///< Key: Component id, Value: failed parameter index
 
     int _totalParamCount;   ///< Number of parameters across all components
+
+    QPointer<ParameterDownloadCoordinator>  _downloadCoordinator;       ///< Schedules request list across vehicles sharing a link
+    uint8_t                                 _requestListComponentId;    ///< Component for PARAM_REQUEST_LIST from refreshAllParameters
+    bool                                    _requestListPending;        ///< true: waiting for coordinator to allow PARAM_REQUEST_LIST
+
+    typedef struct {
+        int         componentId;
+        QString     paramName;
+        QVariant    value;
+        int         retryCount;
+    } BulkWrite_t;
+
+    QList<BulkWrite_t>                      _bulkWriteQueue;            ///< Bulk writes which have not been sent yet
+    QMap<int, QMap<QString, BulkWrite_t> >  _bulkWriteInFlightMap;      ///< Key: Component id, Value: Map { Key: parameter name, Value: bulk write waiting for ack }
+    QStringList                             _bulkWriteFailed;           ///< Failed bulk writes, "componentId:name"
+    int                                     _bulkWriteTotalCount;       ///< Number of parameters in active bulk write
+    int                                     _bulkWriteCompleteCount;    ///< Number of parameters acked or failed in active bulk write
+    int                                     _bulkWriteInFlightCount;    ///< Number of PARAM_SETs waiting for ack
+    QTimer                                  _bulkWriteTimeoutTimer;
+
+    static const int _bulkWriteWindowSize = 16;     ///< Maximum number of outstanding bulk PARAM_SETs
+
+    friend class ParameterDownloadCoordinator;
+    friend class ParameterManagerTest;
     
     QTimer _initialRequestTimeoutTimer;
     QTimer _waitingParamTimeoutTimer;
@@ -12,6 +12,10 @@
 #include "MultiVehicleManager.h"
 #include "QGCApplication.h"
 #include "ParameterManager.h"
+#include "ParameterSearchIndex.h"
+
+#include <QElapsedTimer>
+#include <QTextStream>
 
 /// Test failure modes which should still lead to param load success
 void ParameterManagerTest::_noFailureWorker(MockConfiguration::FailureMode_t failureMode)
@@ -138,3 +142,225 @@ void ParameterManagerTest::_requestListMissingParamFail(void)
     // User should have been notified
     checkExpectedMessageBox();
 }
+
+// Indexed search must match a brute force search through the Facts
+void ParameterManagerTest::_searchParameters(void)
+{
+    _connectMockLink(MAV_AUTOPILOT_PX4);
+
+    ParameterManager*   paramMgr = _vehicle->parameterManager();
+    int                 componentId = _vehicle->defaultComponentId();
+    QStringList         searchTexts;
+
+    searchTexts << QStringLiteral("r") << QStringLiteral("RC") << QStringLiteral("_max") << QStringLiteral("Battery") << QStringLiteral("roll rate") << QStringLiteral("NotAParameterText");
+
+    foreach (const QString& searchText, searchTexts) {
+        QStringList nameResults = paramMgr->searchParameters(componentId, searchText, true /* searchInName */, false /* searchInDescriptions */);
+        QStringList allResults = paramMgr->searchParameters(componentId, searchText, true /* searchInName */, true /* searchInDescriptions */);
+
+        QStringList expectedNameResults, expectedAllResults;
+        foreach (const QString& paramName, paramMgr->parameterNames(componentId)) {
+            Fact* fact = paramMgr->getParameter(componentId, paramName);
+            bool nameMatch = fact->name().contains(searchText, Qt::CaseInsensitive);
+            if (nameMatch) {
+                expectedNameResults += paramName;
+            }
+            if (nameMatch || fact->shortDescription().contains(searchText, Qt::CaseInsensitive) || fact->longDescription().contains(searchText, Qt::CaseInsensitive)) {
+                expectedAllResults += paramName;
+            }
+        }
+
+        QCOMPARE(nameResults, expectedNameResults);
+        QCOMPARE(allResults, expectedAllResults);
+    }
+
+    // Empty search returns everything
+    QCOMPARE(paramMgr->searchParameters(componentId, QString(), true, true), paramMgr->parameterNames(componentId));
+
+    _disconnectMockLink();
+}
+
+// Simulates typing into the parameter editor search field with several components of a few thousand parameters each.
+// Each keystroke searches every component, which must fit within a frame.
+void ParameterManagerTest::_searchLatency(void)
+{
+    _connectMockLink(MAV_AUTOPILOT_PX4);
+
+    ParameterManager*   paramMgr = _vehicle->parameterManager();
+    int                 componentId = _vehicle->defaultComponentId();
+    QStringList         paramNames = paramMgr->parameterNames(componentId);
+    QVector<QString>    names, shortDescriptions, longDescriptions;
+
+    foreach (const QString& paramName, paramNames) {
+        Fact* fact = paramMgr->getParameter(componentId, paramName);
+        names += fact->name();
+        shortDescriptions += fact->shortDescription();
+        longDescriptions += fact->longDescription();
+    }
+    QVERIFY(!names.isEmpty());
+
+    // Real parameters are repeated with suffixed names to reach the target size for each component
+    const int                       componentCount = 4;
+    const int                       paramsPerComponent = 3000;
+    QVector<ParameterSearchIndex>   indexes(componentCount);
+    QVector<QVector<QString> >      lowerText(componentCount);
+    for (int component=0; component<componentCount; component++) {
+        for (int i=0; i<paramsPerComponent; i++) {
+            int     source = i % names.count();
+            QString name = names[source] + QString("_%1").arg(i / names.count());
+            indexes[component].setParameter(i, name, shortDescriptions[source], longDescriptions[source]);
+            lowerText[component] += (name + "\n" + shortDescriptions[source] + "\n" + longDescriptions[source]).toLower();
+        }
+    }
+
+    QStringList typedTexts;
+    typedTexts << QStringLiteral("battery") << QStringLiteral("rc_map_") << QStringLiteral("roll rate");
+
+    const qint64    frameNsecs = 16 * 1000 * 1000;
+    qint64          maxIndexedNsecs = 0;
+    qint64          totalIndexedNsecs = 0;
+    qint64          totalScanNsecs = 0;
+    int             keystrokes = 0;
+    QElapsedTimer   timer;
+
+    foreach (const QString& typedText, typedTexts) {
+        for (int length=1; length<=typedText.length(); length++) {
+            QString searchText = typedText.left(length);
+            int     indexedMatches = 0;
+            int     scanMatches = 0;
+
+            timer.start();
+            for (int component=0; component<componentCount; component++) {
+                indexedMatches += indexes[component].search(searchText, true, true).count();
+            }
+            qint64 indexedNsecs = timer.nsecsElapsed();
+
+            // Previous implementation: case insensitive scan of every parameter
+            timer.start();
+            for (int component=0; component<componentCount; component++) {
+                foreach (const QString& text, lowerText[component]) {
+                    if (text.contains(searchText, Qt::CaseInsensitive)) {
+                        scanMatches++;
+                    }
+                }
+            }
+            totalScanNsecs += timer.nsecsElapsed();
+
+            QCOMPARE(indexedMatches, scanMatches);
+            maxIndexedNsecs = qMax(maxIndexedNsecs, indexedNsecs);
+            totalIndexedNsecs += indexedNsecs;
+            keystrokes++;
+        }
+    }
+
+    qDebug() << "Search of" << componentCount * paramsPerComponent << "parameters per keystroke: indexed avg"
+             << totalIndexedNsecs / keystrokes / 1000 << "usecs, max" << maxIndexedNsecs / 1000 << "usecs; scan avg"
+             << totalScanNsecs / keystrokes / 1000 << "usecs";
+
+    // Latency depends on the machine, so it is only a hard limit when benchmarking
+    if (largeBenchmarksEnabled()) {
+        QVERIFY2(maxIndexedNsecs < frameNsecs, qPrintable(QStringLiteral("Slowest keystroke took %1 usecs").arg(maxIndexedNsecs / 1000)));
+    }
+
+    _disconnectMockLink();
+}
+
+// Bulk write of a large parameter set, checks results and reports throughput
+void ParameterManagerTest::_bulkWrite(void)
+{
+    _connectMockLink(MAV_AUTOPILOT_PX4);
+
+    ParameterManager*                   paramMgr = _vehicle->parameterManager();
+    int                                 componentId = _vehicle->defaultComponentId();
+    QMap<int, QMap<QString, QVariant> > values;
+
+    foreach (const QString& paramName, paramMgr->parameterNames(componentId)) {
+        Fact* fact = paramMgr->getParameter(componentId, paramName);
+        if (fact->type() == FactMetaData::valueTypeFloat) {
+            values[componentId][paramName] = QVariant(fact->rawValue().toFloat() + 0.5f);
+        }
+    }
+    QVERIFY(values[componentId].count() > 100);
+
+    QSignalSpy spyComplete(paramMgr, SIGNAL(bulkWriteComplete(QStringList)));
+    QSignalSpy spyProgress(paramMgr, SIGNAL(bulkWriteProgressChanged(double)));
+    QElapsedTimer writeTimer;
+    writeTimer.start();
+
+    QCOMPARE(paramMgr->writeParameters(values), values[componentId].count());
+    QCOMPARE(spyComplete.wait(60000), true);
+    qint64 elapsed = writeTimer.elapsed();
+    qDebug() << "Bulk write of" << values[componentId].count() << "parameters took" << elapsed << "msecs";
+
+    QCOMPARE(spyComplete.count(), 1);
+    QVERIFY(spyComplete.takeFirst().at(0).toStringList().isEmpty());
+    QVERIFY(spyProgress.count() > 1);
+    QCOMPARE(paramMgr->bulkWriteProgress(), 0.0);
+
+    // Facts must reflect the values acked by the vehicle
+    foreach (const QString& paramName, values[componentId].keys()) {
+        QCOMPARE(paramMgr->getParameter(componentId, paramName)->rawValue().toFloat(), values[componentId][paramName].toFloat());
+    }
+
+    // Writing the same values again is a no-op
+    spyComplete.clear();
+    QCOMPARE(paramMgr->writeParameters(values), 0);
+    QCOMPARE(spyComplete.count(), 1);
+
+    _disconnectMockLink();
+}
+
+// Facts are only created for referenced parameters, saving all parameters must not create the rest. Also reports the
+// time to connect and load parameters.
+void ParameterManagerTest::_lazyFacts(void)
+{
+    QElapsedTimer connectTimer;
+    connectTimer.start();
+    _connectMockLink(MAV_AUTOPILOT_PX4);
+    qint64 connectMsecs = connectTimer.elapsed();
+
+    ParameterManager*       paramMgr = _vehicle->parameterManager();
+    int                     componentId = _vehicle->defaultComponentId();
+    const ParameterStore&   store = paramMgr->_parameterStores[componentId];
+
+    int factCount = 0;
+    for (int i=0; i<store.count(); i++) {
+        if (store.fact(i)) {
+            factCount++;
+        }
+    }
+    QVERIFY(store.count() > 100);
+    QVERIFY(factCount < store.count() / 2);
+    qDebug() << "Connect with" << store.count() << "parameters took" << connectMsecs << "msecs," << factCount << "Facts created";
+
+    QString     paramFile;
+    QTextStream stream(&paramFile);
+    paramMgr->writeParametersToStream(stream);
+
+    int savedFactCount = 0;
+    for (int i=0; i<store.count(); i++) {
+        if (store.fact(i)) {
+            savedFactCount++;
+        }
+    }
+    QCOMPARE(savedFactCount, factCount);
+
+    // Saved values must be formatted the same as the Facts would format them
+    int paramLines = 0;
+    foreach (const QString& line, paramFile.split('\n', QString::SkipEmptyParts)) {
+        if (line.startsWith('#')) {
+            continue;
+        }
+        QStringList fields = line.split('\t');
+        QCOMPARE(fields.count(), 5);
+        if (fields[1].toInt() == componentId) {
+            paramLines++;
+            if (paramLines % 50 == 0) {
+                QCOMPARE(fields[3], paramMgr->getParameter(componentId, fields[2])->rawValueStringFullPrecision());
+            }
+        }
+    }
+    QCOMPARE(paramLines, store.count());
+
+    _disconnectMockLink();
+}
@@ -25,6 +25,10 @@ private slots:
     void _requestListNoResponse(void);
     void _requestListMissingParamSuccess(void);
     void _requestListMissingParamFail(void);
+    void _searchParameters(void);
+    void _searchLatency(void);
+    void _bulkWrite(void);
+    void _lazyFacts(void);
 
 private:
     void _noFailureWorker(MockConfiguration::FailureMode_t failureMode);
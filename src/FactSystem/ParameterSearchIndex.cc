@@ -0,0 +1,156 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#include "ParameterSearchIndex.h"
+
+ParameterSearchIndex::ParameterSearchIndex(void)
+{
+
+}
+
+quint64 ParameterSearchIndex::_trigram(const QChar* chars)
+{
+    return ((quint64)chars[0].unicode() << 32) | ((quint64)chars[1].unicode() << 16) | (quint64)chars[2].unicode();
+}
+
+void ParameterSearchIndex::_addTrigrams(TrigramMap_t& trigramMap, int paramIndex, const QString& lowerText)
+{
+    const QChar* chars = lowerText.constData();
+
+    for (int i=0; i<lowerText.length() - 2; i++) {
+        QVector<int>& postings = trigramMap[_trigram(&chars[i])];
+
+        // Parameters are normally indexed in ascending order, so checking the last entry is enough to prevent duplicates
+        if (postings.isEmpty() || postings.last() != paramIndex) {
+            postings.append(paramIndex);
+        }
+    }
+}
+
+void ParameterSearchIndex::setParameter(int paramIndex, const QString& name, const QString& shortDescription, const QString& longDescription)
+{
+    bool replace = contains(paramIndex);
+    bool outOfOrder = paramIndex < _names.count() - 1;
+
+    if (paramIndex >= _names.count()) {
+        _names.resize(paramIndex + 1);
+        _descriptions.resize(paramIndex + 1);
+        _indexed.resize(paramIndex + 1);
+    }
+
+    _names[paramIndex] = name.toLower();
+    _descriptions[paramIndex] = shortDescription.toLower();
+    if (!longDescription.isEmpty()) {
+        _descriptions[paramIndex] += QChar('\n') + longDescription.toLower();
+    }
+    _indexed[paramIndex] = true;
+
+    if (replace || outOfOrder) {
+        // Posting lists must stay sorted and free of stale entries
+        _rebuild();
+    } else {
+        _addTrigrams(_nameTrigrams, paramIndex, _names[paramIndex]);
+        _addTrigrams(_descriptionTrigrams, paramIndex, _descriptions[paramIndex]);
+    }
+}
+
+void ParameterSearchIndex::_rebuild(void)
+{
+    _nameTrigrams.clear();
+    _descriptionTrigrams.clear();
+
+    for (int i=0; i<_names.count(); i++) {
+        if (_indexed[i]) {
+            _addTrigrams(_nameTrigrams, i, _names[i]);
+            _addTrigrams(_descriptionTrigrams, i, _descriptions[i]);
+        }
+    }
+}
+
+void ParameterSearchIndex::clear(void)
+{
+    _names.clear();
+    _descriptions.clear();
+    _indexed.clear();
+    _nameTrigrams.clear();
+    _descriptionTrigrams.clear();
+}
+
+void ParameterSearchIndex::_searchText(const TrigramMap_t& trigramMap, const QVector<QString>& lowerText, const QString& lowerSearchText, QVector<int>& results) const
+{
+    if (lowerSearchText.length() < 3) {
+        // Too short for the trigram index, scan the lower cased text directly
+        for (int i=0; i<lowerText.count(); i++) {
+            if (_indexed[i] && lowerText[i].contains(lowerSearchText)) {
+                results.append(i);
+            }
+        }
+        return;
+    }
+
+    // Find the trigram with the smallest posting list to use as the candidate set
+    const QChar* chars = lowerSearchText.constData();
+    const QVector<int>* candidates = NULL;
+    for (int i=0; i<lowerSearchText.length() - 2; i++) {
+        TrigramMap_t::const_iterator iter = trigramMap.constFind(_trigram(&chars[i]));
+        if (iter == trigramMap.constEnd()) {
+            // Trigram appears nowhere, so nothing can match
+            return;
+        }
+        if (!candidates || iter.value().count() < candidates->count()) {
+            candidates = &iter.value();
+        }
+    }
+
+    // Trigrams only tell us the pieces are there, verify the full string
+    foreach (int paramIndex, *candidates) {
+        if (lowerText[paramIndex].contains(lowerSearchText)) {
+            results.append(paramIndex);
+        }
+    }
+}
+
+QVector<int> ParameterSearchIndex::search(const QString& searchText, bool searchInName, bool searchInDescriptions) const
+{
+    QString         lowerSearchText = searchText.toLower();
+    QVector<int>    nameResults;
+    QVector<int>    descriptionResults;
+
+    if (searchInName) {
+        _searchText(_nameTrigrams, _names, lowerSearchText, nameResults);
+    }
+    if (searchInDescriptions) {
+        _searchText(_descriptionTrigrams, _descriptions, lowerSearchText, descriptionResults);
+    }
+
+    if (nameResults.isEmpty()) {
+        return descriptionResults;
+    } else if (descriptionResults.isEmpty()) {
+        return nameResults;
+    }
+
+    // Merge the two sorted result sets
+    QVector<int> results;
+    results.reserve(nameResults.count() + descriptionResults.count());
+    int nameIndex = 0;
+    int descriptionIndex = 0;
+    while (nameIndex < nameResults.count() || descriptionIndex < descriptionResults.count()) {
+        if (descriptionIndex == descriptionResults.count() || (nameIndex < nameResults.count() && nameResults[nameIndex] < descriptionResults[descriptionIndex])) {
+            results.append(nameResults[nameIndex++]);
+        } else if (nameIndex == nameResults.count() || descriptionResults[descriptionIndex] < nameResults[nameIndex]) {
+            results.append(descriptionResults[descriptionIndex++]);
+        } else {
+            results.append(nameResults[nameIndex++]);
+            descriptionIndex++;
+        }
+    }
+
+    return results;
+}
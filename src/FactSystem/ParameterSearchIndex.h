@@ -0,0 +1,54 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#ifndef ParameterSearchIndex_H
+#define ParameterSearchIndex_H
+
+#include <QHash>
+#include <QVector>
+#include <QString>
+
+/// Trigram index used for case insensitive substring search of parameter names and descriptions.
+///
+/// Each parameter is identified by its index within the component ParameterStore. Parameters can be added
+/// incrementally as they arrive from the vehicle. A search intersects the posting lists for each trigram of the
+/// search text to find candidates, which are then verified against the lower cased text. Search text shorter
+/// than a trigram falls back to a scan of the lower cased text, which is still much cheaper than going through Facts.
+class ParameterSearchIndex
+{
+public:
+    ParameterSearchIndex(void);
+
+    /// Adds or replaces the indexed text for the specified parameter
+    void setParameter(int paramIndex, const QString& name, const QString& shortDescription, const QString& longDescription);
+
+    bool contains(int paramIndex) const { return paramIndex < _names.count() && _indexed[paramIndex]; }
+
+    /// @return Indices of parameters which contain the specified text, in ascending index order
+    QVector<int> search(const QString& searchText, bool searchInName, bool searchInDescriptions) const;
+
+    void clear(void);
+
+private:
+    typedef QHash<quint64, QVector<int> > TrigramMap_t;
+
+    static quint64  _trigram        (const QChar* chars);
+    static void     _addTrigrams    (TrigramMap_t& trigramMap, int paramIndex, const QString& lowerText);
+    void            _rebuild        (void);
+    void            _searchText     (const TrigramMap_t& trigramMap, const QVector<QString>& lowerText, const QString& lowerSearchText, QVector<int>& results) const;
+
+    QVector<QString>    _names;         ///< Lower case parameter names
+    QVector<QString>    _descriptions;  ///< Lower case short and long descriptions
+    QVector<bool>       _indexed;       ///< true: parameter has been added to index
+    TrigramMap_t        _nameTrigrams;
+    TrigramMap_t        _descriptionTrigrams;
+};
+
+#endif
@@ -0,0 +1,175 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#include "ParameterStore.h"
+
+#include <QDebug>
+#include <QtNumeric>
+
+QSet<QString>   ParameterStore::_internedNames;
+QMutex          ParameterStore::_internMutex;
+int             ParameterStore::_storeCount = 0;
+
+ParameterStore::ParameterStore(void)
+{
+    QMutexLocker lock(&_internMutex);
+    _storeCount++;
+}
+
+ParameterStore::ParameterStore(const ParameterStore& other)
+    : _names        (other._names)
+    , _types        (other._types)
+    , _values       (other._values)
+    , _facts        (other._facts)
+    , _nameToIndex  (other._nameToIndex)
+{
+    QMutexLocker lock(&_internMutex);
+    _storeCount++;
+}
+
+ParameterStore::~ParameterStore()
+{
+    QMutexLocker lock(&_internMutex);
+    if (--_storeCount == 0) {
+        // No vehicle is left to share names with
+        _internedNames.clear();
+    }
+}
+
+QString ParameterStore::internName(const QString& name)
+{
+    QMutexLocker lock(&_internMutex);
+
+    QSet<QString>::const_iterator iter = _internedNames.constFind(name);
+    if (iter != _internedNames.constEnd()) {
+        return *iter;
+    }
+    _internedNames.insert(name);
+    return name;
+}
+
+int ParameterStore::add(const QString& name, FactMetaData::ValueType_t type)
+{
+    RawValue_t rawValue;
+    rawValue.doubleValue = 0;
+
+    int index = _names.count();
+    _names.append(internName(name));
+    _types.append(static_cast<quint8>(type));
+    _values.append(rawValue);
+    _facts.append(NULL);
+    _nameToIndex[_names[index]] = index;
+
+    return index;
+}
+
+QVariant ParameterStore::rawValue(int index) const
+{
+    const RawValue_t& rawValue = _values[index];
+
+    switch (type(index)) {
+    case FactMetaData::valueTypeUint8:
+    case FactMetaData::valueTypeUint16:
+    case FactMetaData::valueTypeUint32:
+        return QVariant(rawValue.uint32Value);
+    case FactMetaData::valueTypeInt8:
+    case FactMetaData::valueTypeInt16:
+    case FactMetaData::valueTypeInt32:
+        return QVariant(rawValue.int32Value);
+    case FactMetaData::valueTypeFloat:
+        return QVariant(rawValue.floatValue);
+    case FactMetaData::valueTypeDouble:
+        return QVariant(rawValue.doubleValue);
+    default:
+        qWarning() << "Unsupported parameter type" << type(index);
+        return QVariant(rawValue.int32Value);
+    }
+}
+
+QString ParameterStore::rawValueStringFullPrecision(int index) const
+{
+    const RawValue_t& value = _values[index];
+
+    switch (type(index)) {
+    case FactMetaData::valueTypeFloat:
+        return qIsNaN(value.floatValue) ? QStringLiteral("--.--") : QString("%1").arg(value.floatValue, 0, 'f', 18);
+    case FactMetaData::valueTypeDouble:
+        return qIsNaN(value.doubleValue) ? QStringLiteral("--.--") : QString("%1").arg(value.doubleValue, 0, 'f', 18);
+    default:
+        return rawValue(index).toString();
+    }
+}
+
+QVariant ParameterStore::typedRawValue(FactMetaData::ValueType_t type, const QVariant& value, bool* convertOk)
+{
+    bool ok = false;
+    QVariant typedValue;
+
+    switch (type) {
+    case FactMetaData::valueTypeUint8:
+    case FactMetaData::valueTypeUint16:
+    case FactMetaData::valueTypeUint32:
+        typedValue = QVariant(value.toUInt(&ok));
+        break;
+    case FactMetaData::valueTypeInt8:
+    case FactMetaData::valueTypeInt16:
+    case FactMetaData::valueTypeInt32:
+        typedValue = QVariant(value.toInt(&ok));
+        break;
+    case FactMetaData::valueTypeFloat:
+        typedValue = QVariant(value.toFloat(&ok));
+        break;
+    case FactMetaData::valueTypeDouble:
+        typedValue = QVariant(value.toDouble(&ok));
+        break;
+    default:
+        qWarning() << "Unsupported parameter type" << type;
+        typedValue = QVariant(value.toInt(&ok));
+        break;
+    }
+
+    if (convertOk) {
+        *convertOk = ok;
+    }
+    return typedValue;
+}
+
+bool ParameterStore::rawValuesEqual(FactMetaData::ValueType_t type, const QVariant& value1, const QVariant& value2)
+{
+    return typedRawValue(type, value1) == typedRawValue(type, value2);
+}
+
+void ParameterStore::setRawValue(int index, const QVariant& value)
+{
+    RawValue_t& rawValue = _values[index];
+
+    switch (type(index)) {
+    case FactMetaData::valueTypeUint8:
+    case FactMetaData::valueTypeUint16:
+    case FactMetaData::valueTypeUint32:
+        rawValue.uint32Value = value.toUInt();
+        break;
+    case FactMetaData::valueTypeInt8:
+    case FactMetaData::valueTypeInt16:
+    case FactMetaData::valueTypeInt32:
+        rawValue.int32Value = value.toInt();
+        break;
+    case FactMetaData::valueTypeFloat:
+        rawValue.floatValue = value.toFloat();
+        break;
+    case FactMetaData::valueTypeDouble:
+        rawValue.doubleValue = value.toDouble();
+        break;
+    default:
+        qWarning() << "Unsupported parameter type" << type(index);
+        rawValue.int32Value = value.toInt();
+        break;
+    }
+}
@@ -0,0 +1,97 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#ifndef ParameterStore_H
+#define ParameterStore_H
+
+#include "FactMetaData.h"
+
+#include <QMap>
+#include <QMutex>
+#include <QSet>
+#include <QVector>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+
+class Fact;
+
+/// Compact storage for the parameters of a single component.
+///
+/// Parameters are stored as parallel arrays of interned names, types and raw typed values. A Fact object is only
+/// created for a parameter when client code (normally QML through getParameter) actually references it. Facts are
+/// owned by the ParameterManager, the store only tracks them.
+class ParameterStore
+{
+public:
+    ParameterStore(void);
+    ParameterStore(const ParameterStore& other);
+    ~ParameterStore();
+
+    ParameterStore& operator=(const ParameterStore& other) = default;
+
+    int         count   (void) const { return _names.count(); }
+    bool        contains(const QString& name) const { return _nameToIndex.contains(name); }
+    int         indexOf (const QString& name) const { return _nameToIndex.value(name, -1); }
+
+    /// @return All parameter names in sorted order
+    QStringList names(void) const { return _nameToIndex.keys(); }
+
+    /// Adds a new parameter with a zero value
+    /// @return Index for new parameter
+    int add(const QString& name, FactMetaData::ValueType_t type);
+
+    QString                     name        (int index) const { return _names[index]; }
+    FactMetaData::ValueType_t   type        (int index) const { return static_cast<FactMetaData::ValueType_t>(_types[index]); }
+    QVariant                    rawValue    (int index) const;
+    void                        setRawValue (int index, const QVariant& value);
+
+    /// @return Value formatted as Fact::rawValueStringFullPrecision does, without needing a Fact
+    QString rawValueStringFullPrecision(int index) const;
+
+    /// @return true: the parameter already has the specified value (after conversion to the parameter type)
+    bool rawValueEquals(int index, const QVariant& value) const { return rawValuesEqual(type(index), rawValue(index), value); }
+
+    /// Converts the value to the variant type used for storing the specified parameter type
+    ///     @param[out] convertOk true: conversion succeeded (optional)
+    static QVariant typedRawValue(FactMetaData::ValueType_t type, const QVariant& value, bool* convertOk = NULL);
+
+    /// @return true: values are the same after conversion to the specified parameter type
+    static bool rawValuesEqual(FactMetaData::ValueType_t type, const QVariant& value1, const QVariant& value2);
+
+    /// @return Fact for parameter, NULL if one has not been created yet
+    Fact*   fact    (int index) const { return _facts[index]; }
+    void    setFact (int index, Fact* fact) { _facts[index] = fact; }
+
+    /// Returns a copy of the name which shares its string data with all other users of the same name. Multiple
+    /// vehicles/components using the same firmware then only store each parameter name once. The names are released
+    /// once the last store is destroyed. Thread safe.
+    static QString internName(const QString& name);
+
+private:
+    typedef union {
+        quint32 uint32Value;
+        qint32  int32Value;
+        float   floatValue;
+        double  doubleValue;
+    } RawValue_t;
+
+    QVector<QString>    _names;
+    QVector<quint8>     _types;
+    QVector<RawValue_t> _values;
+    QVector<Fact*>      _facts;
+    QMap<QString, int>  _nameToIndex;
+
+    static QSet<QString>    _internedNames;
+    static QMutex           _internMutex;   ///< Protects _internedNames and _storeCount
+    static int              _storeCount;    ///< Number of stores which may reference _internedNames
+};
+
+#endif
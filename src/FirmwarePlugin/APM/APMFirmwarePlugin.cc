@@ -645,6 +645,31 @@ void APMFirmwarePlugin::addMetaDataToFact(QObject* parameterMetaData, Fact* fact
     }
 }
 
+QString APMFirmwarePlugin::getParameterMetaDataGroup(QObject* parameterMetaData, const QString& name, MAV_TYPE vehicleType)
+{
+    APMParameterMetaData* apmMetaData = qobject_cast<APMParameterMetaData*>(parameterMetaData);
+
+    if (apmMetaData) {
+        return apmMetaData->parameterGroup(name, vehicleType);
+    } else {
+        qWarning() << "Internal error: pointer passed to APMFirmwarePlugin::getParameterMetaDataGroup not APMParameterMetaData";
+        return QString();
+    }
+}
+
+void APMFirmwarePlugin::getParameterMetaDataDescriptions(QObject* parameterMetaData, const QString& name, MAV_TYPE vehicleType, QString& shortDescription, QString& longDescription)
+{
+    APMParameterMetaData* apmMetaData = qobject_cast<APMParameterMetaData*>(parameterMetaData);
+
+    if (apmMetaData) {
+        apmMetaData->parameterDescriptions(name, vehicleType, shortDescription, longDescription);
+    } else {
+        qWarning() << "Internal error: pointer passed to APMFirmwarePlugin::getParameterMetaDataDescriptions not APMParameterMetaData";
+        shortDescription.clear();
+        longDescription.clear();
+    }
+}
+
 QList<MAV_CMD> APMFirmwarePlugin::supportedMissionCommands(void)
 {
     QList<MAV_CMD> list;
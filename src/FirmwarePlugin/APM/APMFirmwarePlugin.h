@@ -87,7 +87,10 @@ public:
     void                adjustOutgoingMavlinkMessage    (Vehicle* vehicle, LinkInterface* outgoingLink, mavlink_message_t* message) final;
     void                initializeVehicle               (Vehicle* vehicle) final;
     bool                sendHomePositionToVehicle       (void) final;
+    bool                supportsMissionPartialWrite     (void) final { return true; }
     void                addMetaDataToFact               (QObject* parameterMetaData, Fact* fact, MAV_TYPE vehicleType) final;
+    QString             getParameterMetaDataGroup       (QObject* parameterMetaData, const QString& name, MAV_TYPE vehicleType) final;
+    void                getParameterMetaDataDescriptions(QObject* parameterMetaData, const QString& name, MAV_TYPE vehicleType, QString& shortDescription, QString& longDescription) final;
     QString             missionCommandOverrides         (MAV_TYPE vehicleType) const override;
     QString             getVersionParam                 (void) final { return QStringLiteral("SYSID_SW_MREV"); }
     QString             internalParameterMetaDataFile   (Vehicle* vehicle) final;
@@ -17,10 +17,27 @@
 #include <QDir>
 #include <QDebug>
 #include <QStack>
+#include <QDataStream>
 
 QGC_LOGGING_CATEGORY(APMParameterMetaDataLog,           "APMParameterMetaDataLog")
 QGC_LOGGING_CATEGORY(APMParameterMetaDataVerboseLog,    "APMParameterMetaDataVerboseLog")
 
+static QDataStream& operator<<(QDataStream& stream, const APMFactMetaDataRaw& raw)
+{
+    stream << raw.name << raw.group << raw.shortDescription << raw.longDescription
+           << raw.min << raw.max << raw.incrementSize << raw.units << raw.rebootRequired
+           << raw.values << raw.bitmask;
+    return stream;
+}
+
+static QDataStream& operator>>(QDataStream& stream, APMFactMetaDataRaw& raw)
+{
+    stream >> raw.name >> raw.group >> raw.shortDescription >> raw.longDescription
+           >> raw.min >> raw.max >> raw.incrementSize >> raw.units >> raw.rebootRequired
+           >> raw.values >> raw.bitmask;
+    return stream;
+}
+
 APMParameterMetaData::APMParameterMetaData(void)
     : _parameterMetaDataLoaded(false)
 {
@@ -127,9 +144,6 @@ void APMParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
     }
     _parameterMetaDataLoaded = true;
 
-    QRegExp parameterCategories = QRegExp("ArduCopter|ArduPlane|APMrover2|ArduSub|AntennaTracker");
-    QString currentCategory;
-
     qCDebug(APMParameterMetaDataLog) << "Loading parameter meta data:" << metaDataFile;
 
     QFile xmlFile(metaDataFile);
@@ -139,8 +153,27 @@ void APMParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
     Q_UNUSED(success);
     Q_ASSERT(success);
 
-    QXmlStreamReader xml(xmlFile.readAll());
+    QByteArray xmlData = xmlFile.readAll();
     xmlFile.close();
+
+    // Reading and hashing the xml is cheap compared to parsing it. If we have already compiled this exact file
+    // we can skip the parse completely.
+    QString sourceName = QFileInfo(metaDataFile).fileName();
+    if (_compiledMetaData.load(sourceName, xmlData)) {
+        qCDebug(APMParameterMetaDataLog) << "Using compiled parameter meta data" << metaDataFile;
+        return;
+    }
+
+    _parseMetaDataXml(xmlData);
+    _compileMetaData(sourceName, xmlData);
+}
+
+void APMParameterMetaData::_parseMetaDataXml(const QByteArray& xmlData)
+{
+    QRegExp parameterCategories = QRegExp("ArduCopter|ArduPlane|APMrover2|ArduSub|AntennaTracker");
+    QString currentCategory;
+
+    QXmlStreamReader xml(xmlData);
     if (xml.hasError()) {
         qCWarning(APMParameterMetaDataLog) << "Badly formed XML, reading failed: " << xml.errorString();
         return;
@@ -289,6 +322,33 @@ void APMParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
     }
 }
 
+QString APMParameterMetaData::_compiledKey(const QString& category, const QString& name)
+{
+    return QStringLiteral("%1/%2").arg(category).arg(name);
+}
+
+/// Writes the parsed meta data out to the compiled cache and releases the parse results
+void APMParameterMetaData::_compileMetaData(const QString& sourceName, const QByteArray& xmlData)
+{
+    QMap<QString, QByteArray> records;
+
+    foreach (const QString& category, _vehicleTypeToParametersMap.keys()) {
+        const ParameterNametoFactMetaDataMap& parameterMap = _vehicleTypeToParametersMap[category];
+
+        foreach (const QString& name, parameterMap.keys()) {
+            QByteArray record;
+            QDataStream stream(&record, QIODevice::WriteOnly);
+            stream.setVersion(QDataStream::Qt_5_4);
+            stream << *parameterMap[name];
+            records[_compiledKey(category, name)] = record;
+        }
+        qDeleteAll(parameterMap);
+    }
+    _vehicleTypeToParametersMap.clear();
+
+    _compiledMetaData.compile(sourceName, xmlData, records);
+}
+
 void APMParameterMetaData::correctGroupMemberships(ParameterNametoFactMetaDataMap& parameterToFactMetaDataMap,
                                                    QMap<QString,QStringList>& groupMembers)
 {
@@ -409,13 +469,23 @@ bool APMParameterMetaData::parseParameterAttributes(QXmlStreamReader& xml, APMFa
 void APMParameterMetaData::addMetaDataToFact(Fact* fact, MAV_TYPE vehicleType)
 {
     const QString mavTypeString = mavTypeToString(vehicleType);
+    APMFactMetaDataRaw  compiledRawMetaData;
     APMFactMetaDataRaw* rawMetaData = NULL;
 
     // check if we have metadata for fact, use generic otherwise
-    if (_vehicleTypeToParametersMap[mavTypeString].contains(fact->name())) {
-        rawMetaData = _vehicleTypeToParametersMap[mavTypeString][fact->name()];
-    } else if (_vehicleTypeToParametersMap["libraries"].contains(fact->name())) {
-        rawMetaData = _vehicleTypeToParametersMap["libraries"][fact->name()];
+    QByteArray record = _compiledMetaData.record(_compiledKey(mavTypeString, fact->name()));
+    if (record.isEmpty()) {
+        record = _compiledMetaData.record(_compiledKey(QStringLiteral("libraries"), fact->name()));
+    }
+    if (!record.isEmpty()) {
+        QDataStream stream(record);
+        stream.setVersion(QDataStream::Qt_5_4);
+        stream >> compiledRawMetaData;
+        if (stream.status() == QDataStream::Ok) {
+            rawMetaData = &compiledRawMetaData;
+        } else {
+            qCWarning(APMParameterMetaDataLog) << "Corrupt compiled meta data for" << fact->name();
+        }
     }
 
     FactMetaData *metaData = new FactMetaData(fact->type(), fact);
@@ -586,6 +656,56 @@ void APMParameterMetaData::addMetaDataToFact(Fact* fact, MAV_TYPE vehicleType)
     fact->setMetaData(metaData);
 }
 
+/// Returns the group for the parameter without creating FactMetaData for it. Group is the second field of the
+/// record so only the start of the record needs to be decoded.
+QString APMParameterMetaData::parameterGroup(const QString& name, MAV_TYPE vehicleType)
+{
+    const QString mavTypeString = mavTypeToString(vehicleType);
+
+    QByteArray record = _compiledMetaData.record(_compiledKey(mavTypeString, name));
+    if (record.isEmpty()) {
+        record = _compiledMetaData.record(_compiledKey(QStringLiteral("libraries"), name));
+    }
+    if (record.isEmpty()) {
+        return QString();
+    }
+
+    QString     recordName, group;
+    QDataStream stream(record);
+    stream.setVersion(QDataStream::Qt_5_4);
+    stream >> recordName >> group;
+
+    return group;
+}
+
+/// Returns the descriptions for the parameter without creating FactMetaData for it. Descriptions follow the group
+/// in the record so the remainder of the record is not decoded.
+void APMParameterMetaData::parameterDescriptions(const QString& name, MAV_TYPE vehicleType, QString& shortDescription, QString& longDescription)
+{
+    const QString mavTypeString = mavTypeToString(vehicleType);
+
+    shortDescription.clear();
+    longDescription.clear();
+
+    QByteArray record = _compiledMetaData.record(_compiledKey(mavTypeString, name));
+    if (record.isEmpty()) {
+        record = _compiledMetaData.record(_compiledKey(QStringLiteral("libraries"), name));
+    }
+    if (record.isEmpty()) {
+        return;
+    }
+
+    QString     recordName, group;
+    QDataStream stream(record);
+    stream.setVersion(QDataStream::Qt_5_4);
+    stream >> recordName >> group >> shortDescription >> longDescription;
+
+    if (stream.status() != QDataStream::Ok) {
+        shortDescription.clear();
+        longDescription.clear();
+    }
+}
+
 void APMParameterMetaData::getParameterMetaDataVersionInfo(const QString& metaDataFile, int& majorVersion, int& minorVersion)
 {
     majorVersion = -1;
@@ -20,6 +20,7 @@
 #include "FactSystem.h"
 #include "AutoPilotPlugin.h"
 #include "Vehicle.h"
+#include "CompiledParameterMetaData.h"
 
 Q_DECLARE_LOGGING_CATEGORY(APMParameterMetaDataLog)
 Q_DECLARE_LOGGING_CATEGORY(APMParameterMetaDataVerboseLog)
@@ -57,6 +58,8 @@ public:
     APMParameterMetaData(void);
 
     void addMetaDataToFact(Fact* fact, MAV_TYPE vehicleType);
+    QString parameterGroup(const QString& name, MAV_TYPE vehicleType);
+    void parameterDescriptions(const QString& name, MAV_TYPE vehicleType, QString& shortDescription, QString& longDescription);
     void loadParameterFactMetaDataFile(const QString& metaDataFile);
 
     static void getParameterMetaDataVersionInfo(const QString& metaDataFile, int& majorVersion, int& minorVersion);
@@ -79,9 +82,13 @@ private:
     bool parseParameterAttributes(QXmlStreamReader& xml, APMFactMetaDataRaw *rawMetaData);
     void correctGroupMemberships(ParameterNametoFactMetaDataMap& parameterToFactMetaDataMap, QMap<QString,QStringList>& groupMembers);
     QString mavTypeToString(MAV_TYPE vehicleTypeEnum);
+    void _parseMetaDataXml(const QByteArray& xmlData);
+    void _compileMetaData(const QString& sourceName, const QByteArray& xmlData);
+    static QString _compiledKey(const QString& category, const QString& name);
 
-    bool _parameterMetaDataLoaded;   ///< true: parameter meta data already loaded
-    QMap<QString, ParameterNametoFactMetaDataMap> _vehicleTypeToParametersMap; ///< Maps from a vehicle type to paramametertoFactMeta map>
+    bool                        _parameterMetaDataLoaded;   ///< true: parameter meta data already loaded
+    QMap<QString, ParameterNametoFactMetaDataMap> _vehicleTypeToParametersMap; ///< Maps from a vehicle type to paramametertoFactMeta map>, only valid during xml parse
+    CompiledParameterMetaData   _compiledMetaData;          ///< Category and parameter name to serialized APMFactMetaDataRaw
 };
 
 #endif
@@ -198,6 +198,10 @@ public:
     ///     false: Do not send first item to vehicle, sequence numbers must be adjusted
     virtual bool sendHomePositionToVehicle(void);
 
+    /// @return true: Vehicle supports MISSION_WRITE_PARTIAL_LIST, so changed mission items can be written without
+    ///                 sending the whole mission again
+    virtual bool supportsMissionPartialWrite(void) { return false; }
+
     /// Returns the parameter which is used to identify the version number of parameter set
     virtual QString getVersionParam(void) { return QString(); }
 
@@ -216,6 +220,19 @@ public:
     ///     @param opaqueParameterMetaData Opaque pointer returned from loadParameterMetaData
     virtual void addMetaDataToFact(QObject* parameterMetaData, Fact* fact, MAV_TYPE vehicleType) { Q_UNUSED(parameterMetaData); Q_UNUSED(fact); Q_UNUSED(vehicleType); return; }
 
+    /// Returns the group for the specified parameter from the meta data. Allows the group map to be built without
+    /// creating Facts for all parameters.
+    ///     @param opaqueParameterMetaData Opaque pointer returned from loadParameterMetaData
+    /// @return Group name, empty string if no meta data available for parameter
+    virtual QString getParameterMetaDataGroup(QObject* parameterMetaData, const QString& name, MAV_TYPE vehicleType) { Q_UNUSED(parameterMetaData); Q_UNUSED(name); Q_UNUSED(vehicleType); return QString(); }
+
+    /// Returns the descriptions for the specified parameter from the meta data. Allows parameters to be searched
+    /// without creating Facts for all parameters.
+    ///     @param opaqueParameterMetaData Opaque pointer returned from loadParameterMetaData
+    ///     @param[out] shortDescription Short description, empty if no meta data available for parameter
+    ///     @param[out] longDescription Long description, empty if no meta data available for parameter
+    virtual void getParameterMetaDataDescriptions(QObject* parameterMetaData, const QString& name, MAV_TYPE vehicleType, QString& shortDescription, QString& longDescription) { Q_UNUSED(parameterMetaData); Q_UNUSED(name); Q_UNUSED(vehicleType); shortDescription.clear(); longDescription.clear(); }
+
     /// List of supported mission commands. Empty list for all commands supported.
     virtual QList<MAV_CMD> supportedMissionCommands(void);
 
@@ -257,6 +257,31 @@ void PX4FirmwarePlugin::addMetaDataToFact(QObject* parameterMetaData, Fact* fact
     }
 }
 
+QString PX4FirmwarePlugin::getParameterMetaDataGroup(QObject* parameterMetaData, const QString& name, MAV_TYPE vehicleType)
+{
+    PX4ParameterMetaData* px4MetaData = qobject_cast<PX4ParameterMetaData*>(parameterMetaData);
+
+    if (px4MetaData) {
+        return px4MetaData->parameterGroup(name, vehicleType);
+    } else {
+        qWarning() << "Internal error: pointer passed to PX4FirmwarePlugin::getParameterMetaDataGroup not PX4ParameterMetaData";
+        return QString();
+    }
+}
+
+void PX4FirmwarePlugin::getParameterMetaDataDescriptions(QObject* parameterMetaData, const QString& name, MAV_TYPE vehicleType, QString& shortDescription, QString& longDescription)
+{
+    PX4ParameterMetaData* px4MetaData = qobject_cast<PX4ParameterMetaData*>(parameterMetaData);
+
+    if (px4MetaData) {
+        px4MetaData->parameterDescriptions(name, vehicleType, shortDescription, longDescription);
+    } else {
+        qWarning() << "Internal error: pointer passed to PX4FirmwarePlugin::getParameterMetaDataDescriptions not PX4ParameterMetaData";
+        shortDescription.clear();
+        longDescription.clear();
+    }
+}
+
 QList<MAV_CMD> PX4FirmwarePlugin::supportedMissionCommands(void)
 {
     QList<MAV_CMD> list;
@@ -56,6 +56,8 @@ public:
     void                initializeVehicle               (Vehicle* vehicle) override;
     bool                sendHomePositionToVehicle       (void) override;
     void                addMetaDataToFact               (QObject* parameterMetaData, Fact* fact, MAV_TYPE vehicleType) override;
+    QString             getParameterMetaDataGroup       (QObject* parameterMetaData, const QString& name, MAV_TYPE vehicleType) override;
+    void                getParameterMetaDataDescriptions(QObject* parameterMetaData, const QString& name, MAV_TYPE vehicleType, QString& shortDescription, QString& longDescription) override;
     QString             missionCommandOverrides         (MAV_TYPE vehicleType) const override;
     QString             getVersionParam                 (void) override { return QString("SYS_PARAM_VER"); }
     QString             internalParameterMetaDataFile   (Vehicle* vehicle) override { Q_UNUSED(vehicle); return QString(":/FirmwarePlugin/PX4/PX4ParameterFactMetaData.xml"); }
@@ -19,6 +19,7 @@
 #include <QFileInfo>
 #include <QDir>
 #include <QDebug>
+#include <QDataStream>
 
 QGC_LOGGING_CATEGORY(PX4ParameterMetaDataLog, "PX4ParameterMetaDataLog")
 
@@ -71,6 +72,27 @@ QVariant PX4ParameterMetaData::_stringToTypedVariant(const QString& string, Fact
     return var;
 }
 
+static QDataStream& operator<<(QDataStream& stream, const PX4FactMetaDataRaw& raw)
+{
+    stream << raw.name << raw.group << (qint32)raw.type << raw.defaultValue
+           << raw.shortDescription << raw.longDescription << raw.min << raw.max
+           << raw.units << raw.decimalPlaces << raw.increment << raw.rebootRequired << raw.boolean
+           << raw.values << raw.bitmask;
+    return stream;
+}
+
+static QDataStream& operator>>(QDataStream& stream, PX4FactMetaDataRaw& raw)
+{
+    qint32 type;
+
+    stream >> raw.name >> raw.group >> type >> raw.defaultValue
+           >> raw.shortDescription >> raw.longDescription >> raw.min >> raw.max
+           >> raw.units >> raw.decimalPlaces >> raw.increment >> raw.rebootRequired >> raw.boolean
+           >> raw.values >> raw.bitmask;
+    raw.type = type;
+    return stream;
+}
+
 void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaDataFile)
 {
     qCDebug(ParameterManagerLog) << "PX4ParameterMetaData::loadParameterFactMetaDataFile" << metaDataFile;
@@ -94,19 +116,44 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
         qWarning() << "Internal error: Unable to open parameter file:" << metaDataFile << xmlFile.errorString();
         return;
     }
-    
-    QXmlStreamReader xml(xmlFile.readAll());
+
+    QByteArray xmlData = xmlFile.readAll();
     xmlFile.close();
+
+    // Reading and hashing the xml is cheap compared to parsing it. If we have already compiled this exact file
+    // we can skip the parse completely.
+    QString sourceName = QFileInfo(metaDataFile).fileName();
+    if (_compiledMetaData.load(sourceName, xmlData)) {
+        qCDebug(PX4ParameterMetaDataLog) << "Using compiled parameter meta data" << metaDataFile;
+        return;
+    }
+
+    QMap<QString, PX4FactMetaDataRaw> rawMetaDataMap;
+    _parseMetaDataXml(metaDataFile, xmlData, rawMetaDataMap);
+
+    QMap<QString, QByteArray> records;
+    foreach (const QString& name, rawMetaDataMap.keys()) {
+        QByteArray record;
+        QDataStream stream(&record, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_5_4);
+        stream << rawMetaDataMap[name];
+        records[name] = record;
+    }
+    _compiledMetaData.compile(sourceName, xmlData, records);
+}
+
+void PX4ParameterMetaData::_parseMetaDataXml(const QString& metaDataFile, const QByteArray& xmlData, QMap<QString, PX4FactMetaDataRaw>& rawMetaDataMap)
+{
+    QXmlStreamReader xml(xmlData);
     if (xml.hasError()) {
         qWarning() << "Badly formed XML" << xml.errorString();
         return;
     }
     
-    QString         factGroup;
-    QString         errorString;
-    FactMetaData*   metaData = NULL;
-    int             xmlState = XmlStateNone;
-    bool            badMetaData = true;
+    QString             factGroup;
+    PX4FactMetaDataRaw* rawMetaData = NULL;
+    int                 xmlState = XmlStateNone;
+    bool                badMetaData = true;
     
     while (!xml.atEnd()) {
         if (xml.isStartElement()) {
@@ -185,29 +232,22 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                     return;
                 }
                 
-                // Now that we know type we can create meta data object and add it to the system
-                
-                metaData = new FactMetaData(foundType);
-                Q_CHECK_PTR(metaData);
-                if (_mapParameterName2FactMetaData.contains(name)) {
+                if (rawMetaDataMap.contains(name)) {
                     // We can't trust the meta dafa since we have dups
                     qCWarning(PX4ParameterMetaDataLog) << "Duplicate parameter found:" << name;
                     badMetaData = true;
                     // Reset to default meta data
-                    _mapParameterName2FactMetaData[name] = metaData;
+                    rawMetaDataMap[name] = PX4FactMetaDataRaw();
+                    rawMetaData = &rawMetaDataMap[name];
+                    rawMetaData->type = foundType;
                 } else {
-                    _mapParameterName2FactMetaData[name] = metaData;
-                    metaData->setName(name);
-                    metaData->setGroup(factGroup);
+                    rawMetaData = &rawMetaDataMap[name];
+                    rawMetaData->type = foundType;
+                    rawMetaData->name = name;
+                    rawMetaData->group = factGroup;
                     
                     if (xml.attributes().hasAttribute("default") && !strDefault.isEmpty()) {
-                        QVariant varDefault;
-                        
-                        if (metaData->convertAndValidateRaw(strDefault, false, varDefault, errorString)) {
-                            metaData->setRawDefaultValue(varDefault);
-                        } else {
-                            qCWarning(PX4ParameterMetaDataLog) << "Invalid default value, name:" << name << " type:" << type << " default:" << strDefault << " error:" << errorString;
-                        }
+                        rawMetaData->defaultValue = strDefault;
                     }
                 }
                 
@@ -219,63 +259,44 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                 }
 
                 if (!badMetaData) {
-                    if (metaData) {
+                    if (rawMetaData) {
                         if (elementName == "short_desc") {
                             QString text = xml.readElementText();
                             text = text.replace("\n", " ");
                             qCDebug(PX4ParameterMetaDataLog) << "Short description:" << text;
-                            metaData->setShortDescription(text);
+                            rawMetaData->shortDescription = text;
 
                         } else if (elementName == "long_desc") {
                             QString text = xml.readElementText();
                             text = text.replace("\n", " ");
                             qCDebug(PX4ParameterMetaDataLog) << "Long description:" << text;
-                            metaData->setLongDescription(text);
+                            rawMetaData->longDescription = text;
 
                         } else if (elementName == "min") {
                             QString text = xml.readElementText();
                             qCDebug(PX4ParameterMetaDataLog) << "Min:" << text;
-
-                            QVariant varMin;
-                            if (metaData->convertAndValidateRaw(text, true /* convertOnly */, varMin, errorString)) {
-                                metaData->setRawMin(varMin);
-                            } else {
-                                qCWarning(PX4ParameterMetaDataLog) << "Invalid min value, name:" << metaData->name() << " type:" << metaData->type() << " min:" << text << " error:" << errorString;
-                            }
+                            rawMetaData->min = text;
 
                         } else if (elementName == "max") {
                             QString text = xml.readElementText();
                             qCDebug(PX4ParameterMetaDataLog) << "Max:" << text;
-
-                            QVariant varMax;
-                            if (metaData->convertAndValidateRaw(text, true /* convertOnly */, varMax, errorString)) {
-                                metaData->setRawMax(varMax);
-                            } else {
-                                qCWarning(PX4ParameterMetaDataLog) << "Invalid max value, name:" << metaData->name() << " type:" << metaData->type() << " max:" << text << " error:" << errorString;
-                            }
+                            rawMetaData->max = text;
 
                         } else if (elementName == "unit") {
                             QString text = xml.readElementText();
                             qCDebug(PX4ParameterMetaDataLog) << "Unit:" << text;
-                            metaData->setRawUnits(text);
+                            rawMetaData->units = text;
 
                         } else if (elementName == "decimal") {
                             QString text = xml.readElementText();
                             qCDebug(PX4ParameterMetaDataLog) << "Decimal:" << text;
-
-                            bool convertOk;
-                            QVariant varDecimals = QVariant(text).toUInt(&convertOk);
-                            if (convertOk) {
-                                metaData->setDecimalPlaces(varDecimals.toInt());
-                            } else {
-                                qCWarning(PX4ParameterMetaDataLog) << "Invalid decimals value, name:" << metaData->name() << " type:" << metaData->type() << " decimals:" << text << " error: invalid number";
-                            }
+                            rawMetaData->decimalPlaces = text;
 
                         } else if (elementName == "reboot_required") {
                             QString text = xml.readElementText();
                             qCDebug(PX4ParameterMetaDataLog) << "RebootRequired:" << text;
                             if (text.compare("true", Qt::CaseInsensitive) == 0) {
-                                metaData->setRebootRequired(true);
+                                rawMetaData->rebootRequired = true;
                             }
 
                         } else if (elementName == "values") {
@@ -286,59 +307,26 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                             QString enumString = xml.readElementText();
                             qCDebug(PX4ParameterMetaDataLog) << "parameter value:"
                                                              << "value desc:" << enumString << "code:" << enumValueStr;
+                            rawMetaData->values << QPair<QString, QString>(enumValueStr, enumString);
 
-                            QVariant    enumValue;
-                            QString     errorString;
-                            if (metaData->convertAndValidateRaw(enumValueStr, false /* validate */, enumValue, errorString)) {
-                                metaData->addEnumInfo(enumString, enumValue);
-                            } else {
-                                qCDebug(PX4ParameterMetaDataLog) << "Invalid enum value, name:" << metaData->name()
-                                                                 << " type:" << metaData->type() << " value:" << enumValueStr
-                                                                 << " error:" << errorString;
-                            }
                         } else if (elementName == "increment") {
-                            double  increment;
-                            bool    ok;
-                            QString text = xml.readElementText();
-                            increment = text.toDouble(&ok);
-                            if (ok) {
-                                metaData->setIncrement(increment);
-                            } else {
-                                qCWarning(PX4ParameterMetaDataLog) << "Invalid value for increment, name:" << metaData->name() << " increment:" << text;
-                            }
+                            rawMetaData->increment = xml.readElementText();
 
                         } else if (elementName == "boolean") {
-                            QVariant    enumValue;
-                            metaData->convertAndValidateRaw(1, false /* validate */, enumValue, errorString);
-                            metaData->addEnumInfo(tr("Enabled"), enumValue);
-                            metaData->convertAndValidateRaw(0, false /* validate */, enumValue, errorString);
-                            metaData->addEnumInfo(tr("Disabled"), enumValue);
+                            rawMetaData->boolean = true;
 
                         } else if (elementName == "bitmask") {
                             // doing nothing individual bits will follow anyway. May be used for sanity checking.
 
                         } else if (elementName == "bit") {
                             bool ok = false;
-                            unsigned char bit = xml.attributes().value("index").toString().toUInt(&ok);
+                            QString bitIndex = xml.attributes().value("index").toString();
+                            bitIndex.toUInt(&ok);
                             if (ok) {
                                 QString bitDescription = xml.readElementText();
                                 qCDebug(PX4ParameterMetaDataLog) << "parameter value:"
-                                                                 << "index:" << bit << "description:" << bitDescription;
-
-                                if (bit < 31) {
-                                    QVariant bitmaskRawValue = 1 << bit;
-                                    QVariant bitmaskValue;
-                                    QString errorString;
-                                    if (metaData->convertAndValidateRaw(bitmaskRawValue, true, bitmaskValue, errorString)) {
-                                        metaData->addBitmaskInfo(bitDescription, bitmaskValue);
-                                    } else {
-                                        qCDebug(PX4ParameterMetaDataLog) << "Invalid bitmask value, name:" << metaData->name()
-                                                                         << " type:" << metaData->type() << " value:" << bitmaskValue
-                                                                         << " error:" << errorString;
-                                    }
-                                } else {
-                                    qCWarning(PX4ParameterMetaDataLog) << "Invalid value for bitmask, bit:" << bit;
-                                }
+                                                                 << "index:" << bitIndex << "description:" << bitDescription;
+                                rawMetaData->bitmask << QPair<QString, QString>(bitIndex, bitDescription);
                             }
                         } else {
                             qCDebug(PX4ParameterMetaDataLog) << "Unknown element in XML: " << elementName;
@@ -352,17 +340,8 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
             QString elementName = xml.name().toString();
 
             if (elementName == "parameter") {
-                // Done loading this parameter, validate default value
-                if (metaData->defaultValueAvailable()) {
-                    QVariant var;
-
-                    if (!metaData->convertAndValidateRaw(metaData->rawDefaultValue(), false /* convertOnly */, var, errorString)) {
-                        qCWarning(PX4ParameterMetaDataLog) << "Invalid default value, name:" << metaData->name() << " type:" << metaData->type() << " default:" << metaData->rawDefaultValue() << " error:" << errorString;
-                    }
-                }
-
                 // Reset for next parameter
-                metaData = NULL;
+                rawMetaData = NULL;
                 badMetaData = false;
                 xmlState = XmlStateFoundGroup;
             } else if (elementName == "group") {
@@ -375,12 +354,200 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
     }
 }
 
+/// Converts the raw xml values to a FactMetaData object. This is done on demand as each parameter is seen from
+/// the vehicle, rather than up front for every parameter in the meta data file.
+FactMetaData* PX4ParameterMetaData::_createFactMetaData(const PX4FactMetaDataRaw& rawMetaData, QObject* parent)
+{
+    QString         errorString;
+    FactMetaData*   metaData = new FactMetaData(static_cast<FactMetaData::ValueType_t>(rawMetaData.type), parent);
+
+    if (rawMetaData.name.isEmpty()) {
+        // Duplicate parameter in xml, use default meta data
+        return metaData;
+    }
+
+    metaData->setName(rawMetaData.name);
+    metaData->setGroup(rawMetaData.group);
+
+    if (!rawMetaData.defaultValue.isEmpty()) {
+        QVariant varDefault;
+
+        if (metaData->convertAndValidateRaw(rawMetaData.defaultValue, false, varDefault, errorString)) {
+            metaData->setRawDefaultValue(varDefault);
+        } else {
+            qCWarning(PX4ParameterMetaDataLog) << "Invalid default value, name:" << metaData->name() << " type:" << metaData->type() << " default:" << rawMetaData.defaultValue << " error:" << errorString;
+        }
+    }
+
+    if (!rawMetaData.shortDescription.isEmpty()) {
+        metaData->setShortDescription(rawMetaData.shortDescription);
+    }
+    if (!rawMetaData.longDescription.isEmpty()) {
+        metaData->setLongDescription(rawMetaData.longDescription);
+    }
+
+    if (!rawMetaData.min.isEmpty()) {
+        QVariant varMin;
+        if (metaData->convertAndValidateRaw(rawMetaData.min, true /* convertOnly */, varMin, errorString)) {
+            metaData->setRawMin(varMin);
+        } else {
+            qCWarning(PX4ParameterMetaDataLog) << "Invalid min value, name:" << metaData->name() << " type:" << metaData->type() << " min:" << rawMetaData.min << " error:" << errorString;
+        }
+    }
+
+    if (!rawMetaData.max.isEmpty()) {
+        QVariant varMax;
+        if (metaData->convertAndValidateRaw(rawMetaData.max, true /* convertOnly */, varMax, errorString)) {
+            metaData->setRawMax(varMax);
+        } else {
+            qCWarning(PX4ParameterMetaDataLog) << "Invalid max value, name:" << metaData->name() << " type:" << metaData->type() << " max:" << rawMetaData.max << " error:" << errorString;
+        }
+    }
+
+    if (!rawMetaData.units.isEmpty()) {
+        metaData->setRawUnits(rawMetaData.units);
+    }
+
+    if (!rawMetaData.decimalPlaces.isEmpty()) {
+        bool convertOk;
+        QVariant varDecimals = QVariant(rawMetaData.decimalPlaces).toUInt(&convertOk);
+        if (convertOk) {
+            metaData->setDecimalPlaces(varDecimals.toInt());
+        } else {
+            qCWarning(PX4ParameterMetaDataLog) << "Invalid decimals value, name:" << metaData->name() << " type:" << metaData->type() << " decimals:" << rawMetaData.decimalPlaces << " error: invalid number";
+        }
+    }
+
+    if (rawMetaData.rebootRequired) {
+        metaData->setRebootRequired(true);
+    }
+
+    for (int i=0; i<rawMetaData.values.count(); i++) {
+        const QPair<QString, QString>& enumPair = rawMetaData.values[i];
+
+        QVariant enumValue;
+        if (metaData->convertAndValidateRaw(enumPair.first, false /* validate */, enumValue, errorString)) {
+            metaData->addEnumInfo(enumPair.second, enumValue);
+        } else {
+            qCDebug(PX4ParameterMetaDataLog) << "Invalid enum value, name:" << metaData->name()
+                                             << " type:" << metaData->type() << " value:" << enumPair.first
+                                             << " error:" << errorString;
+        }
+    }
+
+    if (!rawMetaData.increment.isEmpty()) {
+        bool    ok;
+        double  increment = rawMetaData.increment.toDouble(&ok);
+        if (ok) {
+            metaData->setIncrement(increment);
+        } else {
+            qCWarning(PX4ParameterMetaDataLog) << "Invalid value for increment, name:" << metaData->name() << " increment:" << rawMetaData.increment;
+        }
+    }
+
+    if (rawMetaData.boolean) {
+        QVariant enumValue;
+        metaData->convertAndValidateRaw(1, false /* validate */, enumValue, errorString);
+        metaData->addEnumInfo(tr("Enabled"), enumValue);
+        metaData->convertAndValidateRaw(0, false /* validate */, enumValue, errorString);
+        metaData->addEnumInfo(tr("Disabled"), enumValue);
+    }
+
+    for (int i=0; i<rawMetaData.bitmask.count(); i++) {
+        const QPair<QString, QString>& bitmaskPair = rawMetaData.bitmask[i];
+        unsigned int bit = bitmaskPair.first.toUInt();
+
+        if (bit < 31) {
+            QVariant bitmaskRawValue = 1 << bit;
+            QVariant bitmaskValue;
+            if (metaData->convertAndValidateRaw(bitmaskRawValue, true, bitmaskValue, errorString)) {
+                metaData->addBitmaskInfo(bitmaskPair.second, bitmaskValue);
+            } else {
+                qCDebug(PX4ParameterMetaDataLog) << "Invalid bitmask value, name:" << metaData->name()
+                                                 << " type:" << metaData->type() << " value:" << bitmaskValue
+                                                 << " error:" << errorString;
+            }
+        } else {
+            qCWarning(PX4ParameterMetaDataLog) << "Invalid value for bitmask, bit:" << bit;
+        }
+    }
+
+    // Validate default value against final meta data
+    if (metaData->defaultValueAvailable()) {
+        QVariant var;
+
+        if (!metaData->convertAndValidateRaw(metaData->rawDefaultValue(), false /* convertOnly */, var, errorString)) {
+            qCWarning(PX4ParameterMetaDataLog) << "Invalid default value, name:" << metaData->name() << " type:" << metaData->type() << " default:" << metaData->rawDefaultValue() << " error:" << errorString;
+        }
+    }
+
+    return metaData;
+}
+
 void PX4ParameterMetaData::addMetaDataToFact(Fact* fact, MAV_TYPE vehicleType)
 {
     Q_UNUSED(vehicleType)
 
-    if (_mapParameterName2FactMetaData.contains(fact->name())) {
-        fact->setMetaData(_mapParameterName2FactMetaData[fact->name()]);
+    QByteArray record = _compiledMetaData.record(fact->name());
+    if (record.isEmpty()) {
+        return;
+    }
+
+    PX4FactMetaDataRaw rawMetaData;
+    QDataStream stream(record);
+    stream.setVersion(QDataStream::Qt_5_4);
+    stream >> rawMetaData;
+    if (stream.status() != QDataStream::Ok) {
+        qCWarning(PX4ParameterMetaDataLog) << "Corrupt compiled meta data for" << fact->name();
+        return;
+    }
+
+    fact->setMetaData(_createFactMetaData(rawMetaData, fact));
+}
+
+/// Returns the group for the parameter without creating FactMetaData for it. Group is the second field of the
+/// record so only the start of the record needs to be decoded.
+QString PX4ParameterMetaData::parameterGroup(const QString& name, MAV_TYPE vehicleType)
+{
+    Q_UNUSED(vehicleType)
+
+    QByteArray record = _compiledMetaData.record(name);
+    if (record.isEmpty()) {
+        return QString();
+    }
+
+    QString     recordName, group;
+    QDataStream stream(record);
+    stream.setVersion(QDataStream::Qt_5_4);
+    stream >> recordName >> group;
+
+    // Duplicate parameters in the xml use default meta data
+    return recordName.isEmpty() ? QString() : group;
+}
+
+/// Returns the descriptions for the parameter without creating FactMetaData for it. Only the fields up to the
+/// long description are decoded.
+void PX4ParameterMetaData::parameterDescriptions(const QString& name, MAV_TYPE vehicleType, QString& shortDescription, QString& longDescription)
+{
+    Q_UNUSED(vehicleType)
+
+    shortDescription.clear();
+    longDescription.clear();
+
+    QByteArray record = _compiledMetaData.record(name);
+    if (record.isEmpty()) {
+        return;
+    }
+
+    QString     recordName, group, defaultValue;
+    qint32      type;
+    QDataStream stream(record);
+    stream.setVersion(QDataStream::Qt_5_4);
+    stream >> recordName >> group >> type >> defaultValue >> shortDescription >> longDescription;
+
+    if (recordName.isEmpty() || stream.status() != QDataStream::Ok) {
+        shortDescription.clear();
+        longDescription.clear();
     }
 }
 
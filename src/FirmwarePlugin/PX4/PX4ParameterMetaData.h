@@ -19,12 +19,40 @@
 #include "FactSystem.h"
 #include "AutoPilotPlugin.h"
 #include "Vehicle.h"
+#include "CompiledParameterMetaData.h"
 
 /// @file
 ///     @author Don Gagne <don@thegagnes.com>
 
 Q_DECLARE_LOGGING_CATEGORY(PX4ParameterMetaDataLog)
 
+/// Parameter meta data as read from the xml, prior to conversion to FactMetaData
+class PX4FactMetaDataRaw
+{
+public:
+    PX4FactMetaDataRaw(void)
+        : type(FactMetaData::valueTypeInt32)
+        , rebootRequired(false)
+        , boolean(false)
+    { }
+
+    QString name;
+    QString group;
+    int     type;
+    QString defaultValue;
+    QString shortDescription;
+    QString longDescription;
+    QString min;
+    QString max;
+    QString units;
+    QString decimalPlaces;
+    QString increment;
+    bool    rebootRequired;
+    bool    boolean;
+    QList<QPair<QString, QString> > values;     ///< { code, description }
+    QList<QPair<QString, QString> > bitmask;    ///< { bit index, description }
+};
+
 /// Loads and holds parameter fact meta data for PX4 stack
 class PX4ParameterMetaData : public QObject
 {
@@ -35,6 +63,8 @@ public:
 
     void loadParameterFactMetaDataFile  (const QString& metaDataFile);
     void addMetaDataToFact              (Fact* fact, MAV_TYPE vehicleType);
+    QString parameterGroup              (const QString& name, MAV_TYPE vehicleType);
+    void parameterDescriptions          (const QString& name, MAV_TYPE vehicleType, QString& shortDescription, QString& longDescription);
 
     static void getParameterMetaDataVersionInfo(const QString& metaDataFile, int& majorVersion, int& minorVersion);
 
@@ -48,10 +78,12 @@ private:
         XmlStateDone
     };    
 
-    QVariant _stringToTypedVariant(const QString& string, FactMetaData::ValueType_t type, bool* convertOk);
+    QVariant        _stringToTypedVariant   (const QString& string, FactMetaData::ValueType_t type, bool* convertOk);
+    void            _parseMetaDataXml       (const QString& metaDataFile, const QByteArray& xmlData, QMap<QString, PX4FactMetaDataRaw>& rawMetaDataMap);
+    FactMetaData*   _createFactMetaData     (const PX4FactMetaDataRaw& rawMetaData, QObject* parent);
 
-    bool _parameterMetaDataLoaded;   ///< true: parameter meta data already loaded
-    QMap<QString, FactMetaData*> _mapParameterName2FactMetaData; ///< Maps from a parameter name to FactMetaData
+    bool                        _parameterMetaDataLoaded;   ///< true: parameter meta data already loaded
+    CompiledParameterMetaData   _compiledMetaData;          ///< Parameter name to serialized PX4FactMetaDataRaw
 };
 
 #endif
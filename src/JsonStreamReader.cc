@@ -0,0 +1,313 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "JsonStreamReader.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonParseError>
+#include <QObject>
+
+#include <cstring>
+
+JsonStreamReader::JsonStreamReader(const QByteArray& bytes)
+    : _bytes(bytes)
+    , _data(_bytes.constData())
+    , _size(_bytes.count())
+{
+
+}
+
+JsonStreamReader::JsonStreamReader(QFile& file)
+    : _data(NULL)
+    , _size(file.size())
+{
+    uchar* mappedData = _size > 0 ? file.map(0, _size) : NULL;
+
+    if (mappedData) {
+        _data = (const char*)mappedData;
+    } else {
+        _bytes = file.readAll();
+        _data = _bytes.constData();
+        _size = _bytes.count();
+    }
+}
+
+JsonStreamReader::Span_t JsonStreamReader::document(void) const
+{
+    Span_t span;
+
+    span.offset = _skipWhitespace(0, _size);
+    span.length = _size - span.offset;
+
+    // Trim trailing whitespace
+    while (span.length > 0) {
+        char c = _data[span.offset + span.length - 1];
+        if (c != ' ' && c != '\t' && c != '\r' && c != '\n') {
+            break;
+        }
+        span.length--;
+    }
+
+    return span;
+}
+
+qint64 JsonStreamReader::_skipWhitespace(qint64 pos, qint64 end) const
+{
+    while (pos < end) {
+        char c = _data[pos];
+        if (c != ' ' && c != '\t' && c != '\r' && c != '\n') {
+            break;
+        }
+        pos++;
+    }
+    return pos;
+}
+
+/// @return Position after the closing quote of the string starting at pos, -1 if unterminated
+qint64 JsonStreamReader::_skipString(qint64 pos, qint64 end) const
+{
+    pos++;
+    while (pos < end) {
+        char c = _data[pos];
+        if (c == '\\') {
+            pos += 2;
+        } else if (c == '"') {
+            return pos + 1;
+        } else {
+            pos++;
+        }
+    }
+    return -1;
+}
+
+/// Finds the end of the value starting at pos. Only the nesting is checked here, the contents are validated when the
+/// value is parsed.
+/// @return Position after the value, -1 if the value is not terminated
+qint64 JsonStreamReader::_skipValue(qint64 pos, qint64 end) const
+{
+    pos = _skipWhitespace(pos, end);
+    if (pos >= end) {
+        return -1;
+    }
+
+    char c = _data[pos];
+    if (c == '"') {
+        return _skipString(pos, end);
+    }
+
+    if (c == '{' || c == '[') {
+        int depth = 0;
+        while (pos < end) {
+            c = _data[pos];
+            if (c == '"') {
+                pos = _skipString(pos, end);
+                if (pos == -1) {
+                    return -1;
+                }
+                continue;
+            }
+            if (c == '{' || c == '[') {
+                depth++;
+            } else if (c == '}' || c == ']') {
+                if (--depth == 0) {
+                    return pos + 1;
+                }
+            }
+            pos++;
+        }
+        return -1;
+    }
+
+    // Number or literal
+    qint64 start = pos;
+    while (pos < end) {
+        c = _data[pos];
+        if (c == ',' || c == '}' || c == ']' || c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+            break;
+        }
+        pos++;
+    }
+    return pos == start ? -1 : pos;
+}
+
+/// Decodes the string starting at pos
+bool JsonStreamReader::_string(qint64 pos, qint64 end, QString& string) const
+{
+    const char* start = _data + pos + 1;
+    int         length = end - pos - 2;
+
+    if (!memchr(start, '\\', length)) {
+        string = QString::fromUtf8(start, length);
+        return true;
+    }
+
+    // Let QJsonDocument deal with escape sequences
+    QJsonValue  jsonValue;
+    QString     errorString;
+    Span_t      span = { pos, end - pos };
+    if (!value(span, jsonValue, errorString) || !jsonValue.isString()) {
+        return false;
+    }
+    string = jsonValue.toString();
+    return true;
+}
+
+QString JsonStreamReader::_errorAt(const QString& error, qint64 pos) const
+{
+    return QObject::tr("%1 at offset %2").arg(error).arg(pos);
+}
+
+bool JsonStreamReader::objectMembers(const Span_t& object, Members_t& members, QString& errorString) const
+{
+    qint64 end = object.offset + object.length;
+    qint64 pos = _skipWhitespace(object.offset, end);
+
+    members.clear();
+
+    if (pos >= end || _data[pos] != '{') {
+        errorString = _errorAt(QObject::tr("Expected object"), pos);
+        return false;
+    }
+    pos = _skipWhitespace(pos + 1, end);
+    if (pos < end && _data[pos] == '}') {
+        return true;
+    }
+
+    while (pos < end) {
+        if (_data[pos] != '"') {
+            errorString = _errorAt(QObject::tr("Expected key"), pos);
+            return false;
+        }
+        qint64 keyEnd = _skipString(pos, end);
+        QString key;
+        if (keyEnd == -1 || !_string(pos, keyEnd, key)) {
+            errorString = _errorAt(QObject::tr("Invalid key"), pos);
+            return false;
+        }
+
+        pos = _skipWhitespace(keyEnd, end);
+        if (pos >= end || _data[pos] != ':') {
+            errorString = _errorAt(QObject::tr("Expected ':'"), pos);
+            return false;
+        }
+        pos = _skipWhitespace(pos + 1, end);
+
+        qint64 valueEnd = _skipValue(pos, end);
+        if (valueEnd == -1) {
+            errorString = _errorAt(QObject::tr("Unterminated value for key %1").arg(key), pos);
+            return false;
+        }
+        Span_t valueSpan = { pos, valueEnd - pos };
+        members.append(qMakePair(key, valueSpan));
+
+        pos = _skipWhitespace(valueEnd, end);
+        if (pos < end && _data[pos] == ',') {
+            pos = _skipWhitespace(pos + 1, end);
+        } else if (pos < end && _data[pos] == '}') {
+            return true;
+        } else {
+            errorString = _errorAt(QObject::tr("Expected ',' or '}'"), pos);
+            return false;
+        }
+    }
+
+    errorString = _errorAt(QObject::tr("Unterminated object"), pos);
+    return false;
+}
+
+bool JsonStreamReader::arrayElements(const Span_t& array, QVector<Span_t>& elements, QString& errorString) const
+{
+    qint64 end = array.offset + array.length;
+    qint64 pos = _skipWhitespace(array.offset, end);
+
+    elements.clear();
+
+    if (pos >= end || _data[pos] != '[') {
+        errorString = _errorAt(QObject::tr("Expected array"), pos);
+        return false;
+    }
+    pos = _skipWhitespace(pos + 1, end);
+    if (pos < end && _data[pos] == ']') {
+        return true;
+    }
+
+    while (pos < end) {
+        qint64 valueEnd = _skipValue(pos, end);
+        if (valueEnd == -1) {
+            errorString = _errorAt(QObject::tr("Unterminated array element"), pos);
+            return false;
+        }
+        Span_t valueSpan = { pos, valueEnd - pos };
+        elements.append(valueSpan);
+
+        pos = _skipWhitespace(valueEnd, end);
+        if (pos < end && _data[pos] == ',') {
+            pos = _skipWhitespace(pos + 1, end);
+        } else if (pos < end && _data[pos] == ']') {
+            return true;
+        } else {
+            errorString = _errorAt(QObject::tr("Expected ',' or ']'"), pos);
+            return false;
+        }
+    }
+
+    errorString = _errorAt(QObject::tr("Unterminated array"), pos);
+    return false;
+}
+
+bool JsonStreamReader::value(const Span_t& span, QJsonValue& jsonValue, QString& errorString) const
+{
+    QJsonParseError parseError;
+    QByteArray      bytes;
+    bool            scalar = !isObject(span) && !isArray(span);
+
+    if (scalar) {
+        // QJsonDocument only parses objects and arrays
+        bytes.reserve(span.length + 2);
+        bytes.append('[');
+        bytes.append(_data + span.offset, span.length);
+        bytes.append(']');
+    } else {
+        bytes = QByteArray::fromRawData(_data + span.offset, span.length);
+    }
+
+    QJsonDocument jsonDoc = QJsonDocument::fromJson(bytes, &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        errorString = _errorAt(parseError.errorString(), span.offset + parseError.offset - (scalar ? 1 : 0));
+        return false;
+    }
+
+    if (scalar) {
+        jsonValue = jsonDoc.array()[0];
+    } else if (jsonDoc.isObject()) {
+        jsonValue = jsonDoc.object();
+    } else {
+        jsonValue = jsonDoc.array();
+    }
+
+    return true;
+}
+
+bool JsonStreamReader::objectExcept(const Members_t& members, const QStringList& skipKeys, QJsonObject& jsonObject, QString& errorString) const
+{
+    for (int i=0; i<members.count(); i++) {
+        if (skipKeys.contains(members[i].first)) {
+            continue;
+        }
+
+        QJsonValue jsonValue;
+        if (!value(members[i].second, jsonValue, errorString)) {
+            return false;
+        }
+        jsonObject[members[i].first] = jsonValue;
+    }
+
+    return true;
+}
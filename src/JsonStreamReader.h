@@ -0,0 +1,81 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#ifndef JsonStreamReader_H
+#define JsonStreamReader_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/// Reads large json documents without building a QJsonDocument for the whole document.
+///
+/// The reader only scans the raw bytes to find where each value starts and ends. Objects and arrays can be split
+/// into their members and elements, which are then parsed one at a time using QJsonDocument. This way a document
+/// with a very large array only ever holds a single array element as a QJsonValue. Files are memory mapped instead of
+/// being read into memory where possible.
+class JsonStreamReader
+{
+public:
+    /// Location of a value within the document
+    typedef struct {
+        qint64 offset;
+        qint64 length;
+    } Span_t;
+
+    typedef QList<QPair<QString, Span_t>> Members_t;
+
+    JsonStreamReader(const QByteArray& bytes);
+
+    /// Maps the file into memory, falls back to reading it if it can't be mapped. The file must be open and must stay
+    /// open while the reader is used.
+    JsonStreamReader(QFile& file);
+
+    /// @return Span of the root value, length 0 if the document is empty
+    Span_t document(void) const;
+
+    bool isObject   (const Span_t& span) const { return _firstChar(span) == '{'; }
+    bool isArray    (const Span_t& span) const { return _firstChar(span) == '['; }
+
+    /// Splits an object into its members, in document order. Member values are not parsed.
+    /// @return false: not a valid object, errorString set
+    bool objectMembers(const Span_t& object, Members_t& members, QString& errorString) const;
+
+    /// Splits an array into its elements. Elements are not parsed.
+    /// @return false: not a valid array, errorString set
+    bool arrayElements(const Span_t& array, QVector<Span_t>& elements, QString& errorString) const;
+
+    /// Parses a single value
+    /// @return false: not a valid value, errorString set
+    bool value(const Span_t& span, QJsonValue& jsonValue, QString& errorString) const;
+
+    /// Parses all members of an object except the specified ones, which are typically the large ones
+    /// @return false: not a valid object, errorString set
+    bool objectExcept(const Members_t& members, const QStringList& skipKeys, QJsonObject& jsonObject, QString& errorString) const;
+
+private:
+    char    _firstChar      (const Span_t& span) const { return span.length > 0 ? _data[span.offset] : '\0'; }
+    qint64  _skipWhitespace (qint64 pos, qint64 end) const;
+    qint64  _skipString     (qint64 pos, qint64 end) const;
+    qint64  _skipValue      (qint64 pos, qint64 end) const;
+    bool    _string         (qint64 pos, qint64 end, QString& string) const;
+    QString _errorAt        (const QString& error, qint64 pos) const;
+
+    QByteArray  _bytes; ///< Holds the contents if they are not memory mapped
+    const char* _data;
+    qint64      _size;
+};
+
+#endif
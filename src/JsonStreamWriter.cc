@@ -0,0 +1,118 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "JsonStreamWriter.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+
+JsonStreamWriter::JsonStreamWriter(QIODevice* device)
+    : _device(device)
+    , _keyWritten(false)
+    , _ok(true)
+{
+
+}
+
+void JsonStreamWriter::_write(const QByteArray& bytes)
+{
+    if (_device->write(bytes) != bytes.count()) {
+        _ok = false;
+    }
+}
+
+void JsonStreamWriter::_newLine(void)
+{
+    _write(QByteArray("\n") + QByteArray(_firstValue.count() * 4, ' '));
+}
+
+/// Writes the separator and indentation needed before the next value
+void JsonStreamWriter::_beginValue(void)
+{
+    if (_keyWritten) {
+        _keyWritten = false;
+        return;
+    }
+    if (_firstValue.count()) {
+        if (!_firstValue.last()) {
+            _write(",");
+        }
+        _firstValue.last() = false;
+        _newLine();
+    }
+}
+
+void JsonStreamWriter::beginObject(void)
+{
+    _beginValue();
+    _write("{");
+    _firstValue.append(true);
+}
+
+void JsonStreamWriter::endObject(void)
+{
+    bool empty = _firstValue.takeLast();
+    if (!empty) {
+        _newLine();
+    }
+    _write("}");
+}
+
+void JsonStreamWriter::beginArray(void)
+{
+    _beginValue();
+    _write("[");
+    _firstValue.append(true);
+}
+
+void JsonStreamWriter::endArray(void)
+{
+    bool empty = _firstValue.takeLast();
+    if (!empty) {
+        _newLine();
+    }
+    _write("]");
+}
+
+void JsonStreamWriter::writeKey(const QString& key)
+{
+    _beginValue();
+    _write(_serialize(key));
+    _write(": ");
+    _keyWritten = true;
+}
+
+void JsonStreamWriter::writeValue(const QJsonValue& jsonValue)
+{
+    _beginValue();
+    _write(_serialize(jsonValue));
+}
+
+QByteArray JsonStreamWriter::_serialize(const QJsonValue& jsonValue)
+{
+    if (jsonValue.isObject()) {
+        return QJsonDocument(jsonValue.toObject()).toJson(QJsonDocument::Compact);
+    } else if (jsonValue.isArray()) {
+        return QJsonDocument(jsonValue.toArray()).toJson(QJsonDocument::Compact);
+    }
+
+    // QJsonDocument only serializes objects and arrays, so strip the array brackets from around the value
+    QJsonArray valueArray;
+    valueArray.append(jsonValue);
+    QByteArray bytes = QJsonDocument(valueArray).toJson(QJsonDocument::Compact);
+    return bytes.mid(1, bytes.count() - 2);
+}
+
+void JsonStreamWriter::writeMembers(const QJsonObject& jsonObject)
+{
+    for (QJsonObject::const_iterator it = jsonObject.constBegin(); it != jsonObject.constEnd(); ++it) {
+        writeKey(it.key());
+        writeValue(it.value());
+    }
+}
@@ -0,0 +1,59 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#ifndef JsonStreamWriter_H
+#define JsonStreamWriter_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QString>
+#include <QVector>
+
+/// Writes large json documents straight to a device without building a QJsonDocument for the whole document.
+///
+/// Structure is written with begin/end calls, values are serialized one at a time using QJsonDocument. Each value
+/// goes on its own line so the output stays readable.
+class JsonStreamWriter
+{
+public:
+    JsonStreamWriter(QIODevice* device);
+
+    void beginObject(void);
+    void endObject  (void);
+    void beginArray (void);
+    void endArray   (void);
+
+    /// Writes the key for the next value within an object
+    void writeKey(const QString& key);
+
+    /// Writes a complete value, as an object member after writeKey or as an array element
+    void writeValue(const QJsonValue& jsonValue);
+
+    /// Writes all members of the object into the current object
+    void writeMembers(const QJsonObject& jsonObject);
+
+    /// @return true: all writes to the device succeeded
+    bool ok(void) const { return _ok; }
+
+private:
+    void _beginValue    (void);
+    void _newLine       (void);
+    void _write         (const QByteArray& bytes);
+
+    static QByteArray _serialize(const QJsonValue& jsonValue);
+
+    QIODevice*      _device;
+    QVector<bool>   _firstValue;    ///< true: nothing written yet at each open nesting level
+    bool            _keyWritten;    ///< true: key was just written, value follows on the same line
+    bool            _ok;
+};
+
+#endif
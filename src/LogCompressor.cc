@@ -26,6 +26,12 @@
 #include <QFileInfo>
 #include <QList>
 #include <QDebug>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cstring>
+#include <queue>
+#include <vector>
 
 /**
  * Initializes all the variables necessary for a compression run. This won't actually happen
@@ -46,7 +52,7 @@ void LogCompressor::run()
 {
 	// Verify that the input file is useable
 	QFile infile(logFileName);
-	if (!infile.exists() || !infile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+	if (!infile.exists() || !infile.open(QIODevice::ReadOnly)) {
 		_signalCriticalError(tr("Log Compressor: Cannot start/compress log file, since input file %1 is not readable").arg(QFileInfo(infile.fileName()).absoluteFilePath()));
 		return;
 	}
@@ -68,20 +74,42 @@ void LogCompressor::run()
 		return;
 	}
 
+    // The input is parsed in place from a memory mapping of the file
+    qint64      size = infile.size();
+    QByteArray  inputData;
+    const char* input = size > 0 ? reinterpret_cast<const char*>(infile.map(0, size)) : NULL;
+    if (!input) {
+        // Mapping not supported on this platform/file system, fall back to reading it
+        inputData = infile.readAll();
+        input = inputData.constData();
+        size = inputData.size();
+    }
+    const char*         inputEnd = input + size;
+    const QByteArray    delimiterData = delimiter.toLocal8Bit();
+    Value_t             fields[4];
 
 	// First we search the input file through keySearchLimit number of lines
 	// looking for variables. This is necessary before CSV files require
 	// the same number of fields for every line.
 	const unsigned int keySearchLimit = 15000;
 	unsigned int keyCounter = 0;
-	QTextStream in(&infile);
 	QMap<QString, int> messageMap;
+    QHash<QByteArray, int> columns;     // Output column of each key as it appears in the input
 
-	while (!in.atEnd() && keyCounter < keySearchLimit) {
-		QString messageName = in.readLine().split(delimiter).at(2);
-		messageMap.insert(messageName, 0);
-		++keyCounter;
-	}
+    for (const char* line = input; line < inputEnd && keyCounter < keySearchLimit; ++keyCounter) {
+        const char* lineEnd = static_cast<const char*>(memchr(line, '\n', inputEnd - line));
+        if (!lineEnd) {
+            lineEnd = inputEnd;
+        }
+        if (_splitLine(line, lineEnd, delimiterData, fields, 3) == 3) {
+            QByteArray key(fields[2].data, fields[2].length);
+            if (!columns.contains(key)) {
+                columns.insert(key, 0);
+                messageMap.insert(QString::fromLocal8Bit(key), 0);
+            }
+        }
+        line = lineEnd + 1;
+    }
 
 	// Now update each key with its index in the output string. These are
 	// all offset by one to account for the first field: timestamp_ms.
@@ -90,6 +118,9 @@ void LogCompressor::run()
 	for (i = messageMap.begin(), j = 1; i != messageMap.end(); ++i, ++j) {
 		i.value() = j;
 	}
+    for (QHash<QByteArray, int>::iterator key = columns.begin(); key != columns.end(); ++key) {
+        key.value() = messageMap.value(QString::fromLocal8Bit(key.key()));
+    }
 
 	// Open the output file and write the header line to it
 	QStringList headerList(messageMap.keys());
@@ -104,78 +135,127 @@ void LogCompressor::run()
 
     _signalCriticalError(tr("Log compressor: Dataset contains dimensions: ") + headerLine);
 
-    // Template list stores a list for populating with data as it's parsed from messages.
-    QStringList templateList;
-    for (int i = 0; i < headerList.size() + 1; ++i) {
-        templateList << (holeFillingEnabled?"NaN":"");
+    // Split the input into chunks of whole lines which are parsed in parallel. Each chunk sorts its values by timestamp.
+    const qint64        maxChunkSize = 64 * 1024 * 1024;
+    int                 chunkCount = qMax(QThread::idealThreadCount() * 4, (int)(size / maxChunkSize) + 1);
+    qint64              chunkSize = size / chunkCount + 1;
+    QVector<Chunk_t>    chunks;
+
+    for (const char* chunkStart = input; chunkStart < inputEnd; ) {
+        const char* chunkEnd = chunkStart + qMin(chunkSize, (qint64)(inputEnd - chunkStart));
+        const void* lineEnd = chunkEnd < inputEnd ? memchr(chunkEnd, '\n', inputEnd - chunkEnd) : NULL;
+        chunkEnd = lineEnd ? static_cast<const char*>(lineEnd) + 1 : inputEnd;
+
+        Chunk_t chunk;
+        chunk.data = chunkStart;
+        chunk.length = chunkEnd - chunkStart;
+        chunks.append(chunk);
+        chunkStart = chunkEnd;
     }
 
-
-//	// Reset our position in the input file before we start the main processing loop.
-//    in.seek(0);
-
-//    // Search through all lines and build a list of unique timestamps
-//    QMap<quint64, QStringList> timestampMap;
-//    while (!in.atEnd()) {
-//        quint64 timestamp = in.readLine().split(delimiter).at(0).toULongLong();
-//        timestampMap.insert(timestamp, templateList);
-//    }
-
-    // Jump back to start of file
-    in.seek(0);
-
-    // Map of final output lines, key is time
-    QMap<quint64, QStringList> timestampMap;
-
-    // Run through the whole file and fill map of timestamps
-    while (!in.atEnd()) {
-        QStringList newLine = in.readLine().split(delimiter);
-        quint64 timestamp = newLine.at(0).toULongLong();
-
-        // Check if timestamp does exist - if not, add it
-        if (!timestampMap.contains(timestamp)) {
-            timestampMap.insert(timestamp, templateList);
+    QtConcurrent::map(chunks, [&delimiterData, &columns](Chunk_t& chunk) {
+        _parseChunk(chunk, delimiterData, columns);
+    }).waitForFinished();
+
+    // Merge the chunks in timestamp order. Values with the same timestamp are applied in input order, so a later
+    // line replaces an earlier one.
+    typedef QPair<int, int> Cursor_t;   // Chunk, record
+    const QVector<Chunk_t>& parsed = chunks;
+    auto later = [&parsed](const Cursor_t& a, const Cursor_t& b) {
+        quint64 timestampA = parsed[a.first].records[a.second].timestamp;
+        quint64 timestampB = parsed[b.first].records[b.second].timestamp;
+        return timestampA != timestampB ? timestampA > timestampB : a.first > b.first;
+    };
+    std::priority_queue<Cursor_t, std::vector<Cursor_t>, decltype(later)> merge(later);
+    for (int chunk=0; chunk<parsed.count(); chunk++) {
+        if (parsed[chunk].records.count()) {
+            merge.push(Cursor_t(chunk, 0));
         }
-
-        QStringList list = timestampMap.value(timestamp);
-
-        QString currentDataName = newLine.at(2);
-        QString currentDataValue = newLine.at(3);
-        list.replace(messageMap.value(currentDataName), currentDataValue);
-        timestampMap.insert(timestamp, list);
     }
 
-    int lineCounter = 0;
-
-    QStringList lastList = timestampMap.values().at(1);
-
-    foreach (QStringList list, timestampMap.values()) {
-        // Write this current time set out to the file
-        // only do so from the 2nd line on, since the first
-        // line could be incomplete
-        if (lineCounter > 1) {
-            // Set the timestamp
-            list.replace(0,QString("%1").arg(timestampMap.keys().at(lineCounter)));
+    // Rows are written as they are completed. Values are filled in from the previous row, lastRow.
+    static const char   nan[] = "NaN";
+    const Value_t       placeholder = { holeFillingEnabled ? nan : "", holeFillingEnabled ? 3 : 0 };
+    const int           columnCount = headerList.size() + 1;
+    QVector<Value_t>    row(columnCount, placeholder);
+    QVector<Value_t>    lastRow;
+    quint64             rowTimestamp = 0;
+    int                 lineCounter = 0;
+    QByteArray          output;
+    const int           outputFlushSize = 1024 * 1024;
+    bool                writeError = false;
+
+    output.reserve(outputFlushSize + 4096);
+
+    while (!merge.empty() || lineCounter > 0) {
+        const Record_t* record = NULL;
+        const Chunk_t*  chunk = NULL;
+        if (!merge.empty()) {
+            Cursor_t cursor = merge.top();
+            chunk = &parsed[cursor.first];
+            record = &chunk->records[cursor.second];
+        }
 
-            // Fill holes if necessary
-            if (holeFillingEnabled) {
-                int index = 0;
-                foreach (const QString& str, list) {
-                    if (str == "" || str == "NaN") {
-                        list.replace(index, lastList.at(index));
+        // A new timestamp completes the row in progress
+        if (lineCounter > 0 && (!record || record->timestamp != rowTimestamp)) {
+            // Write this current time set out to the file
+            // only do so from the 2nd line on, since the first
+            // line could be incomplete
+            if (lineCounter > 2) {
+                // Fill holes if necessary
+                if (holeFillingEnabled) {
+                    for (int index=1; index<columnCount; index++) {
+                        const Value_t& value = row[index];
+                        if (value.length == 0 || (value.length == 3 && memcmp(value.data, nan, 3) == 0)) {
+                            row[index] = lastRow[index];
+                        }
                     }
-                    index++;
                 }
+
+                // Write data columns
+                output.append(QByteArray::number(rowTimestamp));
+                for (int index=1; index<columnCount; index++) {
+                    output.append(delimiterData);
+                    output.append(row[index].data, row[index].length);
+                }
+                output.append('\n');
+                if (output.size() >= outputFlushSize) {
+                    writeError |= outTmpFile.write(output) != output.size();
+                    output.resize(0);
+                }
+            }
+
+            // Set last list, the rows are swapped to reuse their storage
+            if (lineCounter > 1) {
+                lastRow.swap(row);
             }
+            row.fill(placeholder, columnCount);
+            if (!record) {
+                break;
+            }
+        }
 
-            // Set last list
-            lastList = list;
+        if (lineCounter == 0 || record->timestamp != rowTimestamp) {
+            rowTimestamp = record->timestamp;
+            lineCounter++;
+        }
+        if (record->column) {
+            Value_t& value = row[record->column];
+            value.data = chunk->data + record->valueOffset;
+            value.length = record->valueLength;
+        }
 
-            // Write data columns
-            QString output = list.join(delimiter) + "\n";
-            outTmpFile.write(output.toLocal8Bit());
+        Cursor_t cursor = merge.top();
+        merge.pop();
+        if (++cursor.second < chunk->records.count()) {
+            merge.push(cursor);
         }
-        lineCounter++;
+    }
+
+    writeError |= outTmpFile.write(output) != output.size();
+    outTmpFile.close();
+    if (writeError) {
+        _signalCriticalError(tr("Log Compressor: Error writing output file %1").arg(QFileInfo(outTmpFile.fileName()).absoluteFilePath()));
     }
 
 	// We're now done with the source file
@@ -187,6 +267,77 @@ void LogCompressor::run()
 	running = false;
 }
 
+/// Splits the start of a line into fields. The last field ends at the following delimiter, or the end of the line.
+///     @param fields Filled with the fields found
+///     @return Number of fields found, up to maxFields
+int LogCompressor::_splitLine(const char* line, const char* end, const QByteArray& delimiter, Value_t* fields, int maxFields)
+{
+    if (end > line && end[-1] == '\r') {
+        end--;
+    }
+    if (line == end) {
+        return 0;
+    }
+
+    int count = 0;
+    while (count < maxFields) {
+        // Look for the first character of the delimiter, then check the rest of it
+        const char* next = line;
+        const char* found = NULL;
+        while (next < end) {
+            next = static_cast<const char*>(memchr(next, delimiter[0], end - next));
+            if (!next || next + delimiter.size() > end) {
+                break;
+            }
+            if (memcmp(next, delimiter.constData(), delimiter.size()) == 0) {
+                found = next;
+                break;
+            }
+            next++;
+        }
+
+        fields[count].data = line;
+        fields[count].length = (found ? found : end) - line;
+        count++;
+        if (!found) {
+            break;
+        }
+        line = found + delimiter.size();
+    }
+
+    return count;
+}
+
+/// Parses the lines of a chunk into records, keys are looked up without copying them
+void LogCompressor::_parseChunk(Chunk_t& chunk, const QByteArray& delimiter, const QHash<QByteArray, int>& columns)
+{
+    const char* end = chunk.data + chunk.length;
+    Value_t     fields[4];
+
+    for (const char* line = chunk.data; line < end; ) {
+        const char* lineEnd = static_cast<const char*>(memchr(line, '\n', end - line));
+        if (!lineEnd) {
+            lineEnd = end;
+        }
+
+        if (_splitLine(line, lineEnd, delimiter, fields, 4) == 4) {
+            Record_t record;
+            record.timestamp = QByteArray::fromRawData(fields[0].data, fields[0].length).toULongLong();
+            record.column = columns.value(QByteArray::fromRawData(fields[2].data, fields[2].length));
+            record.valueOffset = fields[3].data - chunk.data;
+            record.valueLength = fields[3].length;
+            chunk.records.append(record);
+        }
+
+        line = lineEnd + 1;
+    }
+
+    auto earlier = [](const Record_t& a, const Record_t& b) { return a.timestamp < b.timestamp; };
+    if (!std::is_sorted(chunk.records.begin(), chunk.records.end(), earlier)) {
+        std::stable_sort(chunk.records.begin(), chunk.records.end(), earlier);
+    }
+}
+
 /**
  * @param holeFilling If hole filling is enabled, the compressor tries to fill empty data fields with previous
  * values from the same variable (or NaN, if no previous value existed)
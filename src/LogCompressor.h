@@ -2,6 +2,8 @@
 #define LOGCOMPRESSOR_H
 
 #include <QThread>
+#include <QHash>
+#include <QVector>
 
 class LogCompressor : public QThread
 {
@@ -34,8 +36,31 @@ signals:
     void logProcessingCriticalError(const QString& title, const QString& msg);
     
 private:
+    /// A value from the log. The value itself stays in the input data.
+    typedef struct {
+        quint64 timestamp;
+        quint32 valueOffset;    ///< Offset from the start of the chunk
+        quint32 valueLength;    ///< Values are not limited in length, a value can take up most of a line
+        quint16 column;         ///< Output column, 0 for a key which is not in the header
+    } Record_t;
+
+    /// Lines of the input which are parsed together on one thread
+    typedef struct {
+        const char*         data;
+        qint64              length;
+        QVector<Record_t>   records;    ///< Sorted by timestamp, lines with the same timestamp keep their order
+    } Chunk_t;
+
+    /// Location of a value in the input data
+    typedef struct {
+        const char* data;
+        int         length;
+    } Value_t;
+
     void _signalCriticalError(const QString& msg);
-    
+
+    static int  _splitLine  (const char* line, const char* end, const QByteArray& delimiter, Value_t* fields, int maxFields);
+    static void _parseChunk (Chunk_t& chunk, const QByteArray& delimiter, const QHash<QByteArray, int>& columns);
 };
 
 #endif // LOGCOMPRESSOR_H
\ No newline at end of file
@@ -41,9 +41,11 @@ GeoFenceController::GeoFenceController(PlanMasterController* masterController, Q
     , _dirty(false)
     , _mapPolygon(this)
     , _itemsRequested(false)
+    , _vehicleInsidePolygon(true)
 {
     connect(_mapPolygon.qmlPathModel(), &QmlObjectListModel::countChanged, this, &GeoFenceController::_updateContainsItems);
     connect(_mapPolygon.qmlPathModel(), &QmlObjectListModel::dirtyChanged, this, &GeoFenceController::_polygonDirtyChanged);
+    connect(&_mapPolygon,               &QGCMapPolygon::pathChanged,        this, &GeoFenceController::_updateVehicleInsidePolygon);
 
     managerVehicleChanged(_managerVehicle);
 }
@@ -92,6 +94,7 @@ void GeoFenceController::managerVehicleChanged(Vehicle* managerVehicle)
 {
     if (_managerVehicle) {
         _geoFenceManager->disconnect(this);
+        disconnect(_managerVehicle, &Vehicle::coordinateChanged, this, &GeoFenceController::_updateVehicleInsidePolygon);
         _managerVehicle = NULL;
         _geoFenceManager = NULL;
     }
@@ -113,7 +116,11 @@ void GeoFenceController::managerVehicleChanged(Vehicle* managerVehicle)
     connect(_geoFenceManager, &GeoFenceManager::removeAllComplete,              this, &GeoFenceController::_managerRemoveAllComplete);
     connect(_geoFenceManager, &GeoFenceManager::inProgressChanged,              this, &GeoFenceController::syncInProgressChanged);
 
+    // Position updates arrive at telemetry rate, the polygon keeps a cached index for the containment check
+    connect(_managerVehicle, &Vehicle::coordinateChanged, this, &GeoFenceController::_updateVehicleInsidePolygon);
+
     _signalAll();
+    _updateVehicleInsidePolygon();
 }
 
 bool GeoFenceController::load(const QJsonObject& json, QString& errorString)
@@ -266,10 +273,9 @@ void GeoFenceController::_setDirty(void)
 
 void GeoFenceController::_setPolygonFromManager(const QList<QGeoCoordinate>& polygon)
 {
+    // Set the whole path at once so the polygon is only updated once instead of per vertex
     _mapPolygon.clear();
-    for (int i=0; i<polygon.count(); i++) {
-        _mapPolygon.appendVertex(polygon[i]);
-    }
+    _mapPolygon.setPath(polygon);
     _mapPolygon.setDirty(false);
 }
 
@@ -315,10 +321,33 @@ bool GeoFenceController::containsItems(void) const
 }
 
 void GeoFenceController::_updateContainsItems(void)
+{
+    // Polygon vertices change one at a time, only signal once they are done
+    _queueRecalc();
+}
+
+void GeoFenceController::_recalc(void)
 {
     emit containsItemsChanged(containsItems());
 }
 
+void GeoFenceController::_updateVehicleInsidePolygon(void)
+{
+    bool inside = true;
+
+    if (_managerVehicle && containsItems()) {
+        QGeoCoordinate coordinate = _managerVehicle->coordinate();
+        if (coordinate.isValid()) {
+            inside = _mapPolygon.containsCoordinate(coordinate);
+        }
+    }
+
+    if (inside != _vehicleInsidePolygon) {
+        _vehicleInsidePolygon = inside;
+        emit vehicleInsidePolygonChanged(inside);
+    }
+}
+
 bool GeoFenceController::showPlanFromManagerVehicle(void)
 {
     qCDebug(GeoFenceControllerLog) << "showPlanFromManagerVehicle" << _editMode;
@@ -31,6 +31,7 @@ public:
 
     Q_PROPERTY(QGCMapPolygon*   mapPolygon              READ mapPolygon                                         CONSTANT)
     Q_PROPERTY(QGeoCoordinate   breachReturnPoint       READ breachReturnPoint      WRITE setBreachReturnPoint  NOTIFY breachReturnPointChanged)
+    Q_PROPERTY(bool             vehicleInsidePolygon    READ vehicleInsidePolygon                               NOTIFY vehicleInsidePolygonChanged)
 
     // The following properties are reflections of properties from GeoFenceManager
     Q_PROPERTY(bool             circleEnabled           READ circleEnabled          NOTIFY circleEnabledChanged)
@@ -67,6 +68,7 @@ public:
     QStringList     paramLabels             (void) const;
     QGCMapPolygon*  mapPolygon              (void) { return &_mapPolygon; }
     QGeoCoordinate  breachReturnPoint       (void) const { return _breachReturnPoint; }
+    bool            vehicleInsidePolygon    (void) const { return _vehicleInsidePolygon; }
 
     void setBreachReturnPoint(const QGeoCoordinate& breachReturnPoint);
 
@@ -82,6 +84,7 @@ signals:
     void breachReturnSupportedChanged   (bool breachReturnSupported);
     void paramsChanged                  (QVariantList params);
     void paramLabelsChanged             (QStringList paramLabels);
+    void vehicleInsidePolygonChanged    (bool vehicleInsidePolygon);
 
 private slots:
     void _polygonDirtyChanged(bool dirty);
@@ -92,16 +95,19 @@ private slots:
     void _updateContainsItems(void);
     void _managerSendComplete(bool error);
     void _managerRemoveAllComplete(bool error);
+    void _updateVehicleInsidePolygon(void);
 
 private:
     void _init(void);
     void _signalAll(void);
+    void _recalc(void) final;
 
     GeoFenceManager*    _geoFenceManager;
     bool                _dirty;
     QGCMapPolygon       _mapPolygon;
     QGeoCoordinate      _breachReturnPoint;
     bool                _itemsRequested;
+    bool                _vehicleInsidePolygon;
 
     static const char* _jsonFileTypeValue;
     static const char* _jsonBreachReturnKey;
@@ -0,0 +1,234 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "GeoFenceIndex.h"
+#include "QGCGeo.h"
+
+#include <QtMath>
+
+#include <cmath>
+
+GeoFenceIndex::GeoFenceIndex(void)
+{
+
+}
+
+void GeoFenceIndex::clear(void)
+{
+    _fences.clear();
+}
+
+int GeoFenceIndex::addPolygon(const QList<QGeoCoordinate>& polygon)
+{
+    Fence_t fence;
+
+    fence.circle = false;
+    fence.radius = 0;
+    fence.minLat = fence.maxLat = fence.minLon = fence.maxLon = 0;
+    fence.minY = 0;
+    fence.bandHeight = 0;
+
+    if (polygon.count() > 2) {
+        fence.origin = polygon[0];
+        fence.tangentOrigin = geoOrigin(fence.origin);
+
+        double minY = 0;
+        double maxY = 0;
+        double maxDistance = 0;
+        for (int i=0; i<polygon.count(); i++) {
+            const QGeoCoordinate& vertex = polygon[i];
+            double north, east;
+
+            convertGeoToNed(vertex.latitude(), vertex.longitude(), fence.tangentOrigin, &north, &east);
+            fence.vertices.append(QPointF(east, north));
+
+            minY = qMin(minY, north);
+            maxY = qMax(maxY, north);
+            maxDistance = qMax(maxDistance, qSqrt((north * north) + (east * east)));
+        }
+
+        // Edges are straight on the tangent plane, not in lat/lon, so the vertex lat/lon range does not bound them. The
+        // plane keeps distances from the origin, so the whole polygon lies within the vertex distance of the origin.
+        _setBounds(fence, maxDistance);
+
+        int edgeCount = fence.vertices.count();
+        int bandCount = qBound(1, edgeCount, _maxBands);
+        fence.minY = minY;
+        fence.bandHeight = (maxY - minY) / bandCount;
+        if (fence.bandHeight > 0) {
+            fence.bands.resize(bandCount);
+            for (int i=0; i<edgeCount; i++) {
+                const QPointF& p1 = fence.vertices[i];
+                const QPointF& p2 = fence.vertices[(i + 1) % edgeCount];
+
+                int firstBand = qBound(0, (int)((qMin(p1.y(), p2.y()) - minY) / fence.bandHeight), bandCount - 1);
+                int lastBand = qBound(0, (int)((qMax(p1.y(), p2.y()) - minY) / fence.bandHeight), bandCount - 1);
+                for (int band=firstBand; band<=lastBand; band++) {
+                    fence.bands[band].append(i);
+                }
+            }
+        }
+    }
+
+    _fences.append(fence);
+    return _fences.count() - 1;
+}
+
+int GeoFenceIndex::addCircle(const QGeoCoordinate& center, double radius)
+{
+    Fence_t fence;
+
+    fence.circle = true;
+    fence.origin = center;
+    fence.tangentOrigin = geoOrigin(center);
+    fence.radius = radius;
+    fence.minY = 0;
+    fence.bandHeight = 0;
+    _setBounds(fence, radius);
+
+    _fences.append(fence);
+    return _fences.count() - 1;
+}
+
+/// Sets the lat/lon bounding box of the fence to that of all points within distance of its origin
+void GeoFenceIndex::_setBounds(Fence_t& fence, double distance)
+{
+    // Radius of the tangent plane conversion, the smaller of the two QGCGeo uses, so the box is never too small
+    const double earthRadius = 6371000.0;
+    // Absorbs rounding, about a centimeter
+    const double padDegrees = 1e-7;
+
+    double latitude = fence.origin.latitude();
+    double longitude = fence.origin.longitude();
+    double angle = distance / earthRadius;
+    double latDelta = qRadiansToDegrees(angle) + padDegrees;
+
+    fence.minLat = latitude - latDelta;
+    fence.maxLat = latitude + latDelta;
+    fence.minLon = -180;
+    fence.maxLon = 180;
+
+    if (fence.minLat <= -90 || fence.maxLat >= 90 || angle >= M_PI_2) {
+        // Includes a pole, every longitude is in range
+        return;
+    }
+
+    // Widest longitude of a spherical cap which does not include a pole
+    double lonDelta = qRadiansToDegrees(qAsin(qMin(qSin(angle) / qCos(qDegreesToRadians(latitude)), 1.0))) + padDegrees;
+    if (longitude - lonDelta >= -180 && longitude + lonDelta <= 180) {
+        fence.minLon = longitude - lonDelta;
+        fence.maxLon = longitude + lonDelta;
+    }
+}
+
+bool GeoFenceIndex::_polygonContains(const Fence_t& fence, const QPointF& point) const
+{
+    if (fence.bands.isEmpty()) {
+        return false;
+    }
+
+    int band = (int)std::floor((point.y() - fence.minY) / fence.bandHeight);
+    if (band < 0 || band > fence.bands.count() - 1) {
+        return false;
+    }
+
+    // Odd/even crossing count of a ray to the east, same fill rule QGCMapPolygon has always used
+    bool                    inside = false;
+    const QVector<int>&     edges = fence.bands[band];
+    int                     vertexCount = fence.vertices.count();
+    for (int i=0; i<edges.count(); i++) {
+        const QPointF& p1 = fence.vertices[edges[i]];
+        const QPointF& p2 = fence.vertices[(edges[i] + 1) % vertexCount];
+
+        if ((p1.y() > point.y()) != (p2.y() > point.y())) {
+            double crossX = p1.x() + ((point.y() - p1.y()) * (p2.x() - p1.x()) / (p2.y() - p1.y()));
+            if (point.x() < crossX) {
+                inside = !inside;
+            }
+        }
+    }
+
+    return inside;
+}
+
+bool GeoFenceIndex::_contains(const Fence_t& fence, const QGeoCoordinate& coordinate) const
+{
+    double latitude = coordinate.latitude();
+    double longitude = coordinate.longitude();
+
+    if (latitude < fence.minLat || latitude > fence.maxLat || longitude < fence.minLon || longitude > fence.maxLon) {
+        return false;
+    }
+
+    if (fence.circle) {
+        return geoDistance(fence.origin.latitude(), fence.origin.longitude(), latitude, longitude) <= fence.radius;
+    }
+
+    double north, east;
+    convertGeoToNed(latitude, longitude, fence.tangentOrigin, &north, &east);
+    return _polygonContains(fence, QPointF(east, north));
+}
+
+bool GeoFenceIndex::contains(int fenceIndex, const QGeoCoordinate& coordinate) const
+{
+    if (fenceIndex < 0 || fenceIndex >= _fences.count()) {
+        return false;
+    }
+
+    return _contains(_fences[fenceIndex], coordinate);
+}
+
+QVector<bool> GeoFenceIndex::contains(int fenceIndex, const QList<QGeoCoordinate>& coordinates) const
+{
+    QVector<bool> results(coordinates.count(), false);
+
+    if (fenceIndex >= 0 && fenceIndex < _fences.count()) {
+        const Fence_t& fence = _fences[fenceIndex];
+        for (int i=0; i<coordinates.count(); i++) {
+            results[i] = _contains(fence, coordinates[i]);
+        }
+    }
+
+    return results;
+}
+
+bool GeoFenceIndex::insideAll(const QGeoCoordinate& coordinate) const
+{
+    for (int i=0; i<_fences.count(); i++) {
+        if (!_contains(_fences[i], coordinate)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+QVector<bool> GeoFenceIndex::insideAll(const QList<QGeoCoordinate>& coordinates) const
+{
+    QVector<bool> results(coordinates.count(), true);
+
+    for (int i=0; i<coordinates.count(); i++) {
+        results[i] = insideAll(coordinates[i]);
+    }
+
+    return results;
+}
+
+QVector<int> GeoFenceIndex::fencesContaining(const QGeoCoordinate& coordinate) const
+{
+    QVector<int> fenceIndices;
+
+    for (int i=0; i<_fences.count(); i++) {
+        if (_contains(_fences[i], coordinate)) {
+            fenceIndices.append(i);
+        }
+    }
+
+    return fenceIndices;
+}
@@ -0,0 +1,85 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#ifndef GeoFenceIndex_H
+#define GeoFenceIndex_H
+
+#include "QGCGeo.h"
+
+#include <QGeoCoordinate>
+#include <QList>
+#include <QPointF>
+#include <QVector>
+
+/// Precomputed representation of a set of polygon and circle fences for fast containment checks.
+///
+/// Polygons are converted to the same local tangent plane QGCMapPolygon uses once, when they are added. Each fence
+/// keeps a lat/lon bounding box, that of the smallest circle around its origin holding the fence, so points well away
+/// from it are rejected without any conversion. Polygon edges are
+/// sorted into horizontal bands so a point is only tested against the edges in its own band. The index does not track
+/// changes to the fences, it must be rebuilt when they change.
+class GeoFenceIndex
+{
+public:
+    GeoFenceIndex(void);
+
+    void clear(void);
+
+    /// Adds a polygon fence. Polygons with less than three vertices never contain anything.
+    /// @return Index of the new fence
+    int addPolygon(const QList<QGeoCoordinate>& polygon);
+
+    /// Adds a circle fence
+    ///     @param radius Radius in meters
+    /// @return Index of the new fence
+    int addCircle(const QGeoCoordinate& center, double radius);
+
+    int count(void) const { return _fences.count(); }
+
+    /// @return true: coordinate is within the specified fence
+    bool contains(int fenceIndex, const QGeoCoordinate& coordinate) const;
+
+    /// Batch version of contains for checking many coordinates against one fence
+    QVector<bool> contains(int fenceIndex, const QList<QGeoCoordinate>& coordinates) const;
+
+    /// @return true: coordinate is within all fences, also true if there are no fences
+    bool insideAll(const QGeoCoordinate& coordinate) const;
+
+    /// Batch version of insideAll for checking many coordinates, such as all mission items
+    QVector<bool> insideAll(const QList<QGeoCoordinate>& coordinates) const;
+
+    /// @return Indices of all fences which contain the coordinate
+    QVector<int> fencesContaining(const QGeoCoordinate& coordinate) const;
+
+private:
+    typedef struct {
+        bool                    circle;
+        QGeoCoordinate          origin;         ///< Tangent plane origin for polygons, center for circles
+        GeoOrigin_t             tangentOrigin;  ///< Precomputed trigonometry for origin
+        double                  radius;
+        double                  minLat;         ///< Bounding box for quick reject
+        double                  maxLat;
+        double                  minLon;
+        double                  maxLon;
+        QVector<QPointF>        vertices;       ///< Polygon vertices on the tangent plane, x east, y north
+        double                  minY;
+        double                  bandHeight;
+        QVector<QVector<int>>   bands;          ///< Edges crossing each band, by index of the first edge vertex
+    } Fence_t;
+
+    void _setBounds(Fence_t& fence, double distance);
+    bool _contains(const Fence_t& fence, const QGeoCoordinate& coordinate) const;
+    bool _polygonContains(const Fence_t& fence, const QPointF& point) const;
+
+    QVector<Fence_t> _fences;
+
+    static const int _maxBands = 256;
+};
+
+#endif
@@ -18,6 +18,7 @@
 #include "SurveyMissionItem.h"
 #include "FixedWingLandingComplexItem.h"
 #include "JsonHelper.h"
+#include "JsonStreamWriter.h"
 #include "ParameterManager.h"
 #include "QGroundControlQmlGlobal.h"
 #include "SettingsManager.h"
@@ -25,6 +26,9 @@
 #include "MissionSettingsItem.h"
 #include "QGCQGeoCoordinate.h"
 #include "PlanMasterController.h"
+#include "TerrainTileManager.h"
+
+#include <QtConcurrent>
 
 #ifndef __mobile__
 #include "MainWindow.h"
@@ -54,20 +58,51 @@ MissionController::MissionController(PlanMasterController* masterController, QOb
     , _missionManager(_managerVehicle->missionManager())
     , _visualItems(NULL)
     , _settingsItem(NULL)
+    , _waypointLinesShowHome(false)
     , _firstItemsFromVehicle(false)
     , _itemsRequested(false)
     , _surveyMissionItemName(tr("Survey"))
     , _fwLandingMissionItemName(tr("Fixed Wing Landing"))
     , _appSettings(qgcApp()->toolbox()->settingsManager()->appSettings())
     , _progressPct(0)
-{
+    , _flightStatusRangeLeaves(0)
+    , _minAltSeen(0)
+    , _maxAltSeen(0)
+    , _recalcSequenceActive(false)
+    , _pendingWaypointLinesIndex(-1)
+    , _pendingWaypointLinesLastIndex(-1)
+    , _pendingFlightStatusIndex(-1)
+    , _pendingFlightStatusLastIndex(-1)
+    , _routeGeneration(0)
+    , _routeRunningGeneration(0)
+    , _routeSavedDistance(0)
+    , _routeSavedTime(0)
+    , _terrainTilesPending(false)
+    , _minTerrainClearance(std::numeric_limits<double>::quiet_NaN())
+{
+    _homeWaypointLine.line = NULL;
+    _homeWaypointLine.from = NULL;
+    _homeWaypointLine.to = NULL;
+
     _resetMissionFlightStatus();
     managerVehicleChanged(_managerVehicle);
+
+    // Optimization regenerates survey grids, so it waits until edits have settled
+    _routeTimer.setSingleShot(true);
+    _routeTimer.setInterval(500);
+    connect(&_routeTimer, &QTimer::timeout, this, &MissionController::_updateSurveyRoute);
+    connect(&_routeWatcher, &QFutureWatcherBase::finished, this, &MissionController::_surveyRouteOptimized);
+    connect(&_terrainWatcher, &QFutureWatcherBase::finished, this, &MissionController::_terrainClearanceComputed);
+    connect(qgcApp()->toolbox()->terrainTileManager(), &TerrainTileManager::tilesLoaded, this, &MissionController::_terrainTilesLoaded);
 }
 
 MissionController::~MissionController()
 {
-
+    // Running computations reference _routeCancel and _terrainCancel so they can't outlive us
+    _routeCancel.store(1);
+    _terrainCancel.store(1);
+    _routeWatcher.waitForFinished();
+    _terrainWatcher.waitForFinished();
 }
 
 void MissionController::_resetMissionFlightStatus(void)
@@ -238,8 +273,9 @@ bool MissionController::_convertToMissionItems(QmlObjectListModel* visualMission
     for (int i=0; i<visualMissionItems->count(); i++) {
         VisualMissionItem* visualItem = qobject_cast<VisualMissionItem*>(visualMissionItems->get(i));
 
-        lastSeqNum = visualItem->lastSequenceNumber();
+        // Complex items may finish outstanding generation while appending, which can change their sequence numbers
         visualItem->appendMissionItems(rgMissionItems, missionItemParent);
+        lastSeqNum = visualItem->lastSequenceNumber();
 
         qCDebug(MissionControllerLog) << "_convertToMissionItems seqNum:lastSeqNum:command"
                                       << visualItem->sequenceNumber()
@@ -304,8 +340,9 @@ int MissionController::insertSimpleMissionItem(QGeoCoordinate coordinate, int i)
         }
     }
     _visualItems->insert(i, newItem);
+    _insertRecalcState(i);
 
-    _recalcAll();
+    _recalcAllFrom(i);
 
     return newItem->sequenceNumber();
 }
@@ -347,8 +384,9 @@ int MissionController::insertComplexMissionItem(QString itemName, QGeoCoordinate
     _initVisualItem(newItem);
 
     _visualItems->insert(i, newItem);
+    _insertRecalcState(i);
 
-    _recalcAll();
+    _recalcAllFrom(i);
 
     return newItem->sequenceNumber();
 }
@@ -364,8 +402,12 @@ void MissionController::removeMissionItem(int index)
     VisualMissionItem* item = qobject_cast<VisualMissionItem*>(_visualItems->removeAt(index));
 
     _deinitVisualItem(item);
+    _visualItemIndexes.remove(item);
+    _removeTerrainItem(item);
     item->deleteLater();
 
+    _removeRecalcState(index);
+
     if (surveyRemoved) {
         // Determine if the mission still has another survey in it
         bool foundSurvey = false;
@@ -394,7 +436,7 @@ void MissionController::removeMissionItem(int index)
         }
     }
 
-    _recalcAll();
+    _recalcAllFrom(index);
     setDirty(true);
 }
 
@@ -510,6 +552,58 @@ bool MissionController::_loadJsonMissionFileV1(const QJsonObject& json, QmlObjec
 }
 
 bool MissionController::_loadJsonMissionFileV2(const QJsonObject& json, QmlObjectListModel* visualItems, QString& errorString)
+{
+    const QJsonArray rgMissionItems(json[_jsonItemsKey].toArray());
+
+    return _loadJsonMissionV2(json, rgMissionItems.count(), [&rgMissionItems](int index, QJsonValue& itemValue, QString& /* errorString */) {
+        itemValue = rgMissionItems[index];
+        return true;
+    }, visualItems, errorString);
+}
+
+/// Loads a mission whose items are still spans into the reader. Only a single item is parsed at a time.
+///     @param json Mission object with an empty items array in place of the real one
+bool MissionController::_loadJsonMissionStreamV2(const JsonStreamReader& reader, const QJsonObject& json, const QVector<JsonStreamReader::Span_t>& itemSpans, QmlObjectListModel* visualItems, QString& errorString)
+{
+    return _loadJsonMissionV2(json, itemSpans.count(), [&reader, &itemSpans](int index, QJsonValue& itemValue, QString& itemErrorString) {
+        return reader.value(itemSpans[index], itemValue, itemErrorString);
+    }, visualItems, errorString);
+}
+
+/// Splits a mission object into everything but the items, which are only located and not parsed
+///     @param[out] json Mission object, with an empty items array if the items are an array
+///     @param[out] itemSpans Location of each item
+bool MissionController::_readMissionObject(const JsonStreamReader& reader, const JsonStreamReader::Span_t& missionSpan, QJsonObject& json, QVector<JsonStreamReader::Span_t>& itemSpans, QString& errorString)
+{
+    JsonStreamReader::Members_t members;
+
+    if (!reader.objectMembers(missionSpan, members, errorString) || !reader.objectExcept(members, QStringList(_jsonItemsKey), json, errorString)) {
+        return false;
+    }
+
+    for (int i=0; i<members.count(); i++) {
+        if (members[i].first == _jsonItemsKey) {
+            if (reader.isArray(members[i].second)) {
+                json[_jsonItemsKey] = QJsonArray();
+                return reader.arrayElements(members[i].second, itemSpans, errorString);
+            } else {
+                // Let key validation report the bad type
+                QJsonValue itemsValue;
+                if (!reader.value(members[i].second, itemsValue, errorString)) {
+                    return false;
+                }
+                json[_jsonItemsKey] = itemsValue;
+            }
+        }
+    }
+
+    return true;
+}
+
+/// Loads a version 2 mission
+///     @param itemCount Number of items in the mission
+///     @param readItem Returns the specified item
+bool MissionController::_loadJsonMissionV2(const QJsonObject& json, int itemCount, const std::function<bool(int, QJsonValue&, QString&)>& readItem, QmlObjectListModel* visualItems, QString& errorString)
 {
     // Validate root object keys
     QList<JsonHelper::KeyValidateInfo> rootKeyInfoList = {
@@ -524,7 +618,7 @@ bool MissionController::_loadJsonMissionFileV2(const QJsonObject& json, QmlObjec
         return false;
     }
 
-    qCDebug(MissionControllerLog) << "MissionController::_loadJsonMissionFileV2 itemCount:" << json[_jsonItemsKey].toArray().count();
+    qCDebug(MissionControllerLog) << "MissionController::_loadJsonMissionV2 itemCount:" << itemCount;
 
     // Mission Settings
     AppSettings* appSettings = qgcApp()->toolbox()->settingsManager()->appSettings();
@@ -555,10 +649,12 @@ bool MissionController::_loadJsonMissionFileV2(const QJsonObject& json, QmlObjec
     // Read mission items
 
     int nextSequenceNumber = 1; // Start with 1 since home is in 0
-    const QJsonArray rgMissionItems(json[_jsonItemsKey].toArray());
-    for (int i=0; i<rgMissionItems.count(); i++) {
+    for (int i=0; i<itemCount; i++) {
         // Convert to QJsonObject
-        const QJsonValue& itemValue = rgMissionItems[i];
+        QJsonValue itemValue;
+        if (!readItem(i, itemValue, errorString)) {
+            return false;
+        }
         if (!itemValue.isObject()) {
             errorString = tr("Mission item %1 is not an object").arg(i);
             return false;
@@ -657,28 +753,6 @@ bool MissionController::_loadJsonMissionFileV2(const QJsonObject& json, QmlObjec
     return true;
 }
 
-bool MissionController::_loadItemsFromJson(const QJsonObject& json, QmlObjectListModel* visualItems, QString& errorString)
-{
-    // V1 file format has no file type key and version key is string. Convert to new format.
-    if (!json.contains(JsonHelper::jsonFileTypeKey)) {
-        json[JsonHelper::jsonFileTypeKey] = _jsonFileTypeValue;
-    }
-
-    int fileVersion;
-    JsonHelper::validateQGCJsonFile(json,
-                                    _jsonFileTypeValue,    // expected file type
-                                    1,                     // minimum supported version
-                                    2,                     // maximum supported version
-                                    fileVersion,
-                                    errorString);
-
-    if (fileVersion == 1) {
-        return _loadJsonMissionFileV1(json, visualItems, errorString);
-    } else {
-        return _loadJsonMissionFileV2(json, visualItems, errorString);
-    }
-}
-
 bool MissionController::_loadTextMissionFile(QTextStream& stream, QmlObjectListModel* visualItems, QString& errorString)
 {
     bool firstItem = true;
@@ -772,21 +846,57 @@ bool MissionController::load(const QJsonObject& json, QString& errorString)
     return true;
 }
 
+bool MissionController::load(const JsonStreamReader& reader, const JsonStreamReader::Span_t& missionSpan, QString& errorString)
+{
+    QString                             errorStr;
+    QString                             errorMessage = tr("Mission: %1");
+    QJsonObject                         json;
+    QVector<JsonStreamReader::Span_t>   itemSpans;
+    QmlObjectListModel*                 loadedVisualItems = new QmlObjectListModel(this);
+
+    if (!_readMissionObject(reader, missionSpan, json, itemSpans, errorStr) ||
+            !_loadJsonMissionStreamV2(reader, json, itemSpans, loadedVisualItems, errorStr)) {
+        errorString = errorMessage.arg(errorStr);
+        return false;
+    }
+    _initLoadedVisualItems(loadedVisualItems);
+
+    return true;
+}
+
 bool MissionController::loadJsonFile(QFile& file, QString& errorString)
 {
-    QString         errorStr;
-    QString         errorMessage = tr("Mission: %1");
-    QJsonDocument   jsonDoc;
-    QByteArray      bytes = file.readAll();
+    QString                             errorStr;
+    QString                             errorMessage = tr("Mission: %1");
+    JsonStreamReader                    reader(file);
+    QJsonObject                         json;
+    QVector<JsonStreamReader::Span_t>   itemSpans;
+
+    if (!_readMissionObject(reader, reader.document(), json, itemSpans, errorStr)) {
+        errorString = errorMessage.arg(errorStr);
+        return false;
+    }
+
+    // V1 file format has no file type key and version key is string. Convert to new format.
+    if (!json.contains(JsonHelper::jsonFileTypeKey)) {
+        json[JsonHelper::jsonFileTypeKey] = _jsonFileTypeValue;
+    }
 
-    if (!JsonHelper::isJsonFile(bytes, jsonDoc, errorStr)) {
+    int fileVersion;
+    if (!JsonHelper::validateQGCJsonFile(json, _jsonFileTypeValue, 1, 2, fileVersion, errorStr)) {
         errorString = errorMessage.arg(errorStr);
         return false;
     }
 
-    QJsonObject json = jsonDoc.object();
     QmlObjectListModel* loadedVisualItems = new QmlObjectListModel(this);
-    if (!_loadItemsFromJson(json, loadedVisualItems, errorStr)) {
+    if (fileVersion == 1) {
+        // V1 files predate large missions, so they are still loaded as a whole
+        QJsonValue jsonValue;
+        if (!reader.value(reader.document(), jsonValue, errorStr) || !_loadJsonMissionFileV1(jsonValue.toObject(), loadedVisualItems, errorStr)) {
+            errorString = errorMessage.arg(errorStr);
+            return false;
+        }
+    } else if (!_loadJsonMissionStreamV2(reader, json, itemSpans, loadedVisualItems, errorStr)) {
         errorString = errorMessage.arg(errorStr);
         return false;
     }
@@ -814,7 +924,9 @@ bool MissionController::loadTextFile(QFile& file, QString& errorString)
     return true;
 }
 
-void MissionController::save(QJsonObject& json)
+/// Saves everything but the items of the mission object
+///     @return false: first item is not the mission settings
+bool MissionController::_saveHeader(QJsonObject& json)
 {
     json[JsonHelper::jsonVersionKey] = _missionFileVersion;
 
@@ -823,7 +935,7 @@ void MissionController::save(QJsonObject& json)
     MissionSettingsItem* settingsItem = _visualItems->value<MissionSettingsItem*>(0);
     if (!settingsItem) {
         qWarning() << "First item is not MissionSettingsItem";
-        return;
+        return false;
     }
     QJsonValue coordinateValue;
     JsonHelper::saveGeoCoordinate(settingsItem->coordinate(), true /* writeAltitude */, coordinateValue);
@@ -833,6 +945,31 @@ void MissionController::save(QJsonObject& json)
     json[_jsonCruiseSpeedKey] = _controllerVehicle->defaultCruiseSpeed();
     json[_jsonHoverSpeedKey] = _controllerVehicle->defaultHoverSpeed();
 
+    return true;
+}
+
+/// Mission settings has a special case for end mission action
+void MissionController::_saveEndMissionItem(QJsonArray& rgJsonMissionItems)
+{
+    QList<MissionItem*> rgMissionItems;
+
+    if (_convertToMissionItems(_visualItems, rgMissionItems, this /* missionItemParent */)) {
+        QJsonObject saveObject;
+        MissionItem* missionItem = rgMissionItems[rgMissionItems.count() - 1];
+        missionItem->save(saveObject);
+        rgJsonMissionItems.append(saveObject);
+    }
+    for (int i=0; i<rgMissionItems.count(); i++) {
+        rgMissionItems[i]->deleteLater();
+    }
+}
+
+void MissionController::save(QJsonObject& json)
+{
+    if (!_saveHeader(json)) {
+        return;
+    }
+
     // Save the visual items
 
     QJsonArray rgJsonMissionItems;
@@ -841,23 +978,39 @@ void MissionController::save(QJsonObject& json)
 
         visualItem->save(rgJsonMissionItems);
     }
+    _saveEndMissionItem(rgJsonMissionItems);
 
-    // Mission settings has a special case for end mission action
-    if (settingsItem) {
-        QList<MissionItem*> rgMissionItems;
+    json[_jsonItemsKey] = rgJsonMissionItems;
+}
 
-        if (_convertToMissionItems(_visualItems, rgMissionItems, this /* missionItemParent */)) {
-            QJsonObject saveObject;
-            MissionItem* missionItem = rgMissionItems[rgMissionItems.count() - 1];
-            missionItem->save(saveObject);
-            rgJsonMissionItems.append(saveObject);
-        }
-        for (int i=0; i<rgMissionItems.count(); i++) {
-            rgMissionItems[i]->deleteLater();
-        }
+void MissionController::save(JsonStreamWriter& writer)
+{
+    QJsonObject json;
+
+    if (!_saveHeader(json)) {
+        return;
     }
+    writer.writeMembers(json);
 
-    json[_jsonItemsKey] = rgJsonMissionItems;
+    // Save the visual items, only holding the json for a single one at a time
+
+    writer.writeKey(_jsonItemsKey);
+    writer.beginArray();
+    for (int i=0; i<_visualItems->count(); i++) {
+        VisualMissionItem*  visualItem = qobject_cast<VisualMissionItem*>(_visualItems->get(i));
+        QJsonArray          rgJsonMissionItems;
+
+        visualItem->save(rgJsonMissionItems);
+        for (int j=0; j<rgJsonMissionItems.count(); j++) {
+            writer.writeValue(rgJsonMissionItems[j]);
+        }
+    }
+    QJsonArray rgJsonEndItems;
+    _saveEndMissionItem(rgJsonEndItems);
+    if (rgJsonEndItems.count()) {
+        writer.writeValue(rgJsonEndItems[0]);
+    }
+    writer.endArray();
 }
 
 void MissionController::_calcPrevWaypointValues(double homeAlt, VisualMissionItem* currentItem, VisualMissionItem* prevItem, double* azimuth, double* distance, double* altDifference)
@@ -878,8 +1031,13 @@ void MissionController::_calcPrevWaypointValues(double homeAlt, VisualMissionIte
 
     if (distanceOk) {
         *altDifference = currentCoord.altitude() - prevCoord.altitude();
-        *distance = prevCoord.distanceTo(currentCoord);
-        *azimuth = prevCoord.azimuthTo(currentCoord);
+        if (currentCoord.isValid() && prevCoord.isValid()) {
+            // Runs for every item the flight status walk passes, so it shares the trigonometry of both values
+            geoDistanceAzimuth(prevCoord.latitude(), prevCoord.longitude(), currentCoord.latitude(), currentCoord.longitude(), distance, azimuth);
+        } else {
+            *distance = 0.0;
+            *azimuth = 0.0;
+        }
     } else {
         *altDifference = 0.0;
         *azimuth = 0.0;
@@ -887,137 +1045,215 @@ void MissionController::_calcPrevWaypointValues(double homeAlt, VisualMissionIte
     }
 }
 
-double MissionController::_calcDistanceToHome(VisualMissionItem* currentItem, VisualMissionItem* homeItem)
+/// @param homeOrigin Home position precomputed once per flight status walk
+double MissionController::_calcDistanceToHome(VisualMissionItem* currentItem, const GeoOrigin_t& homeOrigin)
 {
-    QGeoCoordinate  currentCoord =  currentItem->coordinate();
-    QGeoCoordinate  homeCoord =     homeItem->exitCoordinate();
-    bool            distanceOk =    false;
+    QGeoCoordinate currentCoord = currentItem->coordinate();
 
-    distanceOk = true;
-
-    return distanceOk ? homeCoord.distanceTo(currentCoord) : 0.0;
+    return currentCoord.isValid() ? geoDistance(homeOrigin, currentCoord.latitude(), currentCoord.longitude()) : 0.0;
 }
 
-void MissionController::_addWaypointLineSegment(CoordVectHashTable& prevItemPairHashTable, VisualItemPair& pair)
+/// Makes the line match the specified end points, replacing the line object in _waypointLines if they changed.
+///     @param from Item the line starts at, NULL for no line
+void MissionController::_setWaypointLine(WaypointLine_t& waypointLine, VisualMissionItem* from, VisualMissionItem* to)
 {
-    if (prevItemPairHashTable.contains(pair)) {
-        // Pair already exists and connected, just re-use
-        _linesTable[pair] = prevItemPairHashTable.take(pair);
-    } else {
+    if (waypointLine.line ? (waypointLine.from == from && waypointLine.to == to) : !from) {
+        return;
+    }
+
+    if (waypointLine.line) {
+        _removeWaypointLine(waypointLine.line);
+        waypointLine.line = NULL;
+    }
+    waypointLine.from = from;
+    waypointLine.to = to;
+
+    if (from) {
         // Create a new segment and wire update notifiers
-        auto linevect       = new CoordinateVector(pair.first->isSimpleItem() ? pair.first->coordinate() : pair.first->exitCoordinate(), pair.second->coordinate(), this);
-        auto originNotifier = pair.first->isSimpleItem() ? &VisualMissionItem::coordinateChanged : &VisualMissionItem::exitCoordinateChanged;
+        auto linevect       = new CoordinateVector(from->isSimpleItem() ? from->coordinate() : from->exitCoordinate(), to->coordinate(), this);
+        auto originNotifier = from->isSimpleItem() ? &VisualMissionItem::coordinateChanged : &VisualMissionItem::exitCoordinateChanged;
         auto endNotifier    = &VisualMissionItem::coordinateChanged;
 
         // Use signals/slots to update the coordinate endpoints
-        connect(pair.first,     originNotifier, linevect, &CoordinateVector::setCoordinate1);
-        connect(pair.second,    endNotifier,    linevect, &CoordinateVector::setCoordinate2);
+        connect(from,   originNotifier, linevect, &CoordinateVector::setCoordinate1);
+        connect(to,     endNotifier,    linevect, &CoordinateVector::setCoordinate2);
+
+        _waypointLineRows[linevect] = _waypointLines.count();
+        _waypointLines.append(linevect);
+        waypointLine.line = linevect;
+    }
+}
+
+/// Removes the line from _waypointLines and deletes it. The last row is moved into the hole so no search or shift is needed.
+void MissionController::_removeWaypointLine(CoordinateVector* line)
+{
+    int row = _waypointLineRows.take(line);
+    int lastRow = _waypointLines.count() - 1;
 
-        // FIXME: We should ideally have signals for 2D position change, alt change, and 3D position change
-        // Not optimal, but still pretty fast, do a full update of range/bearing/altitudes
-        connect(pair.second, &VisualMissionItem::coordinateChanged, this, &MissionController::_recalcMissionFlightStatus);
-        _linesTable[pair] = linevect;
+    if (row != lastRow) {
+        CoordinateVector* lastLine = _waypointLines.value<CoordinateVector*>(lastRow);
+        _waypointLines.replace(row, lastLine);
+        _waypointLineRows[lastLine] = row;
     }
+    _waypointLines.removeAt(lastRow);
+
+    delete line;
 }
 
-void MissionController::_recalcWaypointLines(void)
+void MissionController::_clearWaypointLines(void)
 {
-    bool                firstCoordinateItem =   true;
-    VisualMissionItem*  lastCoordinateItem =    qobject_cast<VisualMissionItem*>(_visualItems->get(0));
+    qDeleteAll(_waypointLines.swapObjectList(QObjectList()));
+
+    _waypointLineItems.clear();
+    _waypointLineRows.clear();
+    _homeWaypointLine.line = NULL;
+    _homeWaypointLine.from = NULL;
+    _homeWaypointLine.to = NULL;
+}
 
+/// Updates the waypoint lines for the items at or after startIndex. The walk state before each item is recorded, so
+/// once past lastChangedIndex and back in sync with the previous walk the remaining lines are known to be unchanged.
+void MissionController::_updateWaypointLinesFrom(int startIndex, int lastChangedIndex)
+{
+    int  endIndex =         _visualItems->count();
     bool showHomePosition = _settingsItem->coordinate().isValid();
 
-    qCDebug(MissionControllerLog) << "_recalcWaypointLines showHomePosition" << showHomePosition;
+    if (startIndex < 0 || startIndex > endIndex || _waypointLineItems.count() != endIndex + 1 || showHomePosition != _waypointLinesShowHome) {
+        // Walk the whole mission, lines which still match are kept
+        startIndex = 0;
+        lastChangedIndex = endIndex;
+
+        for (int i=endIndex; i<_waypointLineItems.count(); i++) {
+            _setWaypointLine(_waypointLineItems[i].line, NULL, NULL);
+        }
+        int oldCount = _waypointLineItems.count();
+        _waypointLineItems.resize(endIndex + 1);
+        for (int i=oldCount; i<=endIndex; i++) {
+            WaypointLineItem_t& lineItem = _waypointLineItems[i];
+            lineItem.item = NULL;
+            lineItem.line.line = NULL;
+            lineItem.line.from = NULL;
+            lineItem.line.to = NULL;
+        }
+    }
+    _waypointLinesShowHome = showHomePosition;
+
+    qCDebug(MissionControllerLog) << "_updateWaypointLinesFrom startIndex:showHomePosition" << startIndex << showHomePosition;
 
-    CoordVectHashTable old_table = _linesTable;
-    _linesTable.clear();
-    _waypointLines.clear();
+    VisualMissionItem*  lastCoordinateItem;
+    bool                firstCoordinateItem;
+    bool                linkStartToHome;
 
-    bool linkEndToHome;
-    SimpleMissionItem* lastItem = _visualItems->value<SimpleMissionItem*>(_visualItems->count() - 1);
-    if (lastItem && (int)lastItem->command() == MAV_CMD_NAV_RETURN_TO_LAUNCH) {
-        linkEndToHome = true;
+    if (startIndex == 0) {
+        lastCoordinateItem = _settingsItem;
+        firstCoordinateItem = true;
+        linkStartToHome = false;
+
+        WaypointLineItem_t& lineItem = _waypointLineItems[0];
+        lineItem.item =                 _settingsItem;
+        lineItem.lastCoordinateItem =   lastCoordinateItem;
+        lineItem.firstCoordinateItem =  firstCoordinateItem;
+        lineItem.linkStartToHome =      linkStartToHome;
+        startIndex = 1;
     } else {
-        linkEndToHome = _settingsItem->missionEndRTL();
+        const WaypointLineItem_t& lineItem = _waypointLineItems[startIndex];
+
+        lastCoordinateItem = lineItem.lastCoordinateItem;
+        firstCoordinateItem = lineItem.firstCoordinateItem;
+        linkStartToHome = lineItem.linkStartToHome;
     }
 
-    bool linkStartToHome = false;
-    for (int i=1; i<_visualItems->count(); i++) {
-        VisualMissionItem* item = qobject_cast<VisualMissionItem*>(_visualItems->get(i));
+    bool inSync = false;
+    for (int i=startIndex; i<endIndex; i++) {
+        VisualMissionItem*  item =      _visualItems->value<VisualMissionItem*>(i);
+        WaypointLineItem_t& lineItem =  _waypointLineItems[i];
+
+        if (i > lastChangedIndex && lineItem.item == item &&
+                lineItem.lastCoordinateItem == lastCoordinateItem &&
+                lineItem.firstCoordinateItem == firstCoordinateItem &&
+                lineItem.linkStartToHome == linkStartToHome) {
+            inSync = true;
+            break;
+        }
 
+        lineItem.item =                 item;
+        lineItem.lastCoordinateItem =   lastCoordinateItem;
+        lineItem.firstCoordinateItem =  firstCoordinateItem;
+        lineItem.linkStartToHome =      linkStartToHome;
 
         // If we still haven't found the first coordinate item and we hit a takeoff command, link back to home
-        if (firstCoordinateItem &&
-                item->isSimpleItem() &&
-                (qobject_cast<SimpleMissionItem*>(item)->command() == MavlinkQmlSingleton::MAV_CMD_NAV_TAKEOFF ||
-                 qobject_cast<SimpleMissionItem*>(item)->command() == MavlinkQmlSingleton::MAV_CMD_NAV_VTOL_TAKEOFF)) {
+        SimpleMissionItem* simpleItem = qobject_cast<SimpleMissionItem*>(item);
+        if (firstCoordinateItem && simpleItem &&
+                (simpleItem->command() == MavlinkQmlSingleton::MAV_CMD_NAV_TAKEOFF ||
+                 simpleItem->command() == MavlinkQmlSingleton::MAV_CMD_NAV_VTOL_TAKEOFF)) {
             linkStartToHome = true;
         }
 
-        if (item->specifiesCoordinate()) {
-            if (!item->isStandaloneCoordinate()) {
-                firstCoordinateItem = false;
-                VisualItemPair pair(lastCoordinateItem, item);
-                if (lastCoordinateItem != _settingsItem || (showHomePosition && linkStartToHome)) {
-                    _addWaypointLineSegment(old_table, pair);
-                }
-                lastCoordinateItem = item;
+        VisualMissionItem* lineFrom = NULL;
+        if (item->specifiesCoordinate() && !item->isStandaloneCoordinate()) {
+            firstCoordinateItem = false;
+            if (lastCoordinateItem != _settingsItem || (showHomePosition && linkStartToHome)) {
+                lineFrom = lastCoordinateItem;
             }
+            lastCoordinateItem = item;
         }
-    }
-    if (linkEndToHome && lastCoordinateItem != _settingsItem && showHomePosition) {
-        VisualItemPair pair(lastCoordinateItem, _settingsItem);
-        _addWaypointLineSegment(old_table, pair);
+        _setWaypointLine(lineItem.line, lineFrom, item);
     }
 
-    {
-        // Create a temporary QObjectList and replace the model data
-        QObjectList objs;
-        objs.reserve(_linesTable.count());
-        foreach(CoordinateVector *vect, _linesTable.values()) {
-            objs.append(vect);
-        }
-
-        // We don't delete here because many links may still be valid
-        _waypointLines.swapObjectList(objs);
+    WaypointLineItem_t& endItem = _waypointLineItems[endIndex];
+    if (inSync) {
+        lastCoordinateItem = endItem.lastCoordinateItem;
+    } else {
+        endItem.item =                  NULL;
+        endItem.lastCoordinateItem =    lastCoordinateItem;
+        endItem.firstCoordinateItem =   firstCoordinateItem;
+        endItem.linkStartToHome =       linkStartToHome;
     }
 
-    // Anything left in the old table is an obsolete line object that can go
-    qDeleteAll(old_table);
+    bool linkEndToHome;
+    SimpleMissionItem* lastItem = _visualItems->value<SimpleMissionItem*>(endIndex - 1);
+    if (lastItem && (int)lastItem->command() == MAV_CMD_NAV_RETURN_TO_LAUNCH) {
+        linkEndToHome = true;
+    } else {
+        linkEndToHome = _settingsItem->missionEndRTL();
+    }
+    bool homeLine = linkEndToHome && lastCoordinateItem != _settingsItem && showHomePosition;
+    _setWaypointLine(_homeWaypointLine, homeLine ? lastCoordinateItem : NULL, _settingsItem);
+}
 
-    _recalcMissionFlightStatus();
+int MissionController::_batteriesRequired(double hoverTime, double cruiseTime)
+{
+    double hoverAmpsTotal = (hoverTime / 60.0) * _missionFlightStatus.hoverAmps;
+    double cruiseAmpsTotal = (cruiseTime / 60.0) * _missionFlightStatus.cruiseAmps;
 
-    emit waypointLinesChanged();
+    return ceil((hoverAmpsTotal + cruiseAmpsTotal) / _missionFlightStatus.ampMinutesAvailable);
 }
 
-void MissionController::_updateBatteryInfo(int waypointIndex)
+void MissionController::_updateBatteryInfo(void)
 {
     if (_missionFlightStatus.mAhBattery != 0) {
         _missionFlightStatus.hoverAmpsTotal = (_missionFlightStatus.hoverTime / 60.0) * _missionFlightStatus.hoverAmps;
         _missionFlightStatus.cruiseAmpsTotal = (_missionFlightStatus.cruiseTime / 60.0) * _missionFlightStatus.cruiseAmps;
-        _missionFlightStatus.batteriesRequired = ceil((_missionFlightStatus.hoverAmpsTotal + _missionFlightStatus.cruiseAmpsTotal) / _missionFlightStatus.ampMinutesAvailable);
-        if (waypointIndex != -1 && _missionFlightStatus.batteriesRequired == 2 && _missionFlightStatus.batteryChangePoint == -1) {
-            _missionFlightStatus.batteryChangePoint = waypointIndex - 1;
-        }
+        _missionFlightStatus.batteriesRequired = _batteriesRequired(_missionFlightStatus.hoverTime, _missionFlightStatus.cruiseTime);
     }
 }
 
-void MissionController::_addHoverTime(double hoverTime, double hoverDistance, int waypointIndex)
+void MissionController::_addHoverTime(double hoverTime, double hoverDistance)
 {
     _missionFlightStatus.totalTime += hoverTime;
     _missionFlightStatus.hoverTime += hoverTime;
     _missionFlightStatus.hoverDistance += hoverDistance;
     _missionFlightStatus.totalDistance += hoverDistance;
-    _updateBatteryInfo(waypointIndex);
+    _updateBatteryInfo();
 }
 
-void MissionController::_addCruiseTime(double cruiseTime, double cruiseDistance, int waypointIndex)
+void MissionController::_addCruiseTime(double cruiseTime, double cruiseDistance)
 {
     _missionFlightStatus.totalTime += cruiseTime;
     _missionFlightStatus.cruiseTime += cruiseTime;
     _missionFlightStatus.cruiseDistance += cruiseDistance;
     _missionFlightStatus.totalDistance += cruiseDistance;
-    _updateBatteryInfo(waypointIndex);
+    _updateBatteryInfo();
 }
 
 /// Adds additional time to a mission as specified by the command
@@ -1037,7 +1273,7 @@ void MissionController::_addCommandTimeDelay(SimpleMissionItem* simpleItem, bool
         break;
     }
 
-    _addTimeDistance(vtolInHover, 0, 0, seconds, 0, -1);
+    _addTimeDistance(vtolInHover, 0, 0, seconds, 0, NULL);
 }
 
 /// Adds the specified time to the appropriate hover or cruise time values.
@@ -1045,74 +1281,303 @@ void MissionController::_addCommandTimeDelay(SimpleMissionItem* simpleItem, bool
 ///     @param hoverTime    Amount of time tp add to hover
 ///     @param cruiseTime   Amount of time to add to cruise
 ///     @param extraTime    Amount of additional time to add to hover/cruise
-///     @param seqNum       Sequence number of waypoint for these values, -1 for no waypoint associated
-void MissionController::_addTimeDistance(bool vtolInHover, double hoverTime, double cruiseTime, double extraTime, double distance, int seqNum)
+///     @param waypointLeg  Item to record the waypoint leg in for battery change calculation, NULL for no waypoint associated
+void MissionController::_addTimeDistance(bool vtolInHover, double hoverTime, double cruiseTime, double extraTime, double distance, FlightStatusItem_t* waypointLeg)
 {
-    if (_controllerVehicle->vtol()) {
-        if (vtolInHover) {
-            _addHoverTime(hoverTime, distance, seqNum);
-            _addHoverTime(extraTime, 0, -1);
-        } else {
-            _addCruiseTime(cruiseTime, distance, seqNum);
-            _addCruiseTime(extraTime, 0, -1);
-        }
+    bool hover = _controllerVehicle->vtol() ? vtolInHover : _controllerVehicle->multiRotor();
+
+    if (hover) {
+        _addHoverTime(hoverTime, distance);
+    } else {
+        _addCruiseTime(cruiseTime, distance);
+    }
+
+    if (waypointLeg && waypointLeg->batteryLegCount < 2) {
+        waypointLeg->batteryLegHoverTime[waypointLeg->batteryLegCount] = _missionFlightStatus.hoverTime;
+        waypointLeg->batteryLegCruiseTime[waypointLeg->batteryLegCount] = _missionFlightStatus.cruiseTime;
+        waypointLeg->batteryLegCount++;
+    }
+
+    if (hover) {
+        _addHoverTime(extraTime, 0);
     } else {
-        if (_controllerVehicle->multiRotor()) {
-            _addHoverTime(hoverTime, distance, seqNum);
-            _addHoverTime(extraTime, 0, -1);
+        _addCruiseTime(extraTime, 0);
+    }
+}
+
+/// Resets the range tree to one leaf per flight status item, in item order. Leaf values are set by the walk.
+void MissionController::_resetFlightStatusRanges(void)
+{
+    FlightStatusRange_t emptyRange;
+    emptyRange.minAltitude =            std::numeric_limits<double>::infinity();
+    emptyRange.maxAltitude =            -std::numeric_limits<double>::infinity();
+    emptyRange.maxTelemetryDistance =   0.0;
+
+    int leaves = 64;
+    while (leaves < _flightStatusItems.count()) {
+        leaves *= 2;
+    }
+    _flightStatusRangeLeaves = leaves;
+    _flightStatusRanges.fill(emptyRange, leaves * 2);
+
+    _freeFlightStatusRanges.clear();
+    for (int slot=leaves-1; slot>=_flightStatusItems.count(); slot--) {
+        _freeFlightStatusRanges.append(slot);
+    }
+    for (int i=0; i<_flightStatusItems.count(); i++) {
+        _flightStatusItems[i].rangeSlot = i;
+    }
+}
+
+/// @return Unused leaf slot for a new flight status item, the tree doubles in size when full
+int MissionController::_allocFlightStatusRange(void)
+{
+    if (_freeFlightStatusRanges.isEmpty()) {
+        FlightStatusRange_t emptyRange;
+        emptyRange.minAltitude =            std::numeric_limits<double>::infinity();
+        emptyRange.maxAltitude =            -std::numeric_limits<double>::infinity();
+        emptyRange.maxTelemetryDistance =   0.0;
+
+        // Existing leaves keep their slots, interior nodes are rebuilt
+        int oldLeaves = _flightStatusRangeLeaves;
+        int leaves = qMax(oldLeaves * 2, 64);
+        QVector<FlightStatusRange_t> ranges(leaves * 2, emptyRange);
+        for (int slot=0; slot<oldLeaves; slot++) {
+            ranges[leaves + slot] = _flightStatusRanges[oldLeaves + slot];
+        }
+        for (int node=leaves-1; node>=1; node--) {
+            const FlightStatusRange_t& left = ranges[node * 2];
+            const FlightStatusRange_t& right = ranges[node * 2 + 1];
+            ranges[node].minAltitude =          std::min(left.minAltitude, right.minAltitude);
+            ranges[node].maxAltitude =          std::max(left.maxAltitude, right.maxAltitude);
+            ranges[node].maxTelemetryDistance = qMax(left.maxTelemetryDistance, right.maxTelemetryDistance);
+        }
+        _flightStatusRanges = ranges;
+        _flightStatusRangeLeaves = leaves;
+
+        for (int slot=leaves-1; slot>=oldLeaves; slot--) {
+            _freeFlightStatusRanges.append(slot);
+        }
+    }
+
+    return _freeFlightStatusRanges.takeLast();
+}
+
+/// Sets the values for a leaf and updates the nodes above it
+///     @param minAltitude NaN for an item without a coordinate
+void MissionController::_setFlightStatusRange(int slot, double minAltitude, double maxAltitude, double maxTelemetryDistance)
+{
+    if (slot < 0 || slot >= _flightStatusRangeLeaves) {
+        return;
+    }
+
+    int node = _flightStatusRangeLeaves + slot;
+    FlightStatusRange_t& leaf = _flightStatusRanges[node];
+    leaf.minAltitude =          qIsNaN(minAltitude) ? std::numeric_limits<double>::infinity() : minAltitude;
+    leaf.maxAltitude =          qIsNaN(maxAltitude) ? -std::numeric_limits<double>::infinity() : maxAltitude;
+    leaf.maxTelemetryDistance = maxTelemetryDistance;
+
+    for (node /= 2; node >= 1; node /= 2) {
+        const FlightStatusRange_t& left = _flightStatusRanges[node * 2];
+        const FlightStatusRange_t& right = _flightStatusRanges[node * 2 + 1];
+        FlightStatusRange_t& range = _flightStatusRanges[node];
+        range.minAltitude =             std::min(left.minAltitude, right.minAltitude);
+        range.maxAltitude =             std::max(left.maxAltitude, right.maxAltitude);
+        range.maxTelemetryDistance =    qMax(left.maxTelemetryDistance, right.maxTelemetryDistance);
+    }
+}
+
+void MissionController::_freeFlightStatusRange(int slot)
+{
+    if (slot < 0 || slot >= _flightStatusRangeLeaves) {
+        return;
+    }
+
+    _setFlightStatusRange(slot, std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN(), 0.0);
+    _freeFlightStatusRanges.append(slot);
+}
+
+/// Finds the item at which a second battery is needed. Battery use only grows along the mission, so the item where
+/// the time totals first require two batteries is found with a binary search over the recorded walk states.
+///     @return Index of the item, -1 for no change point
+int MissionController::_batteryChangeIndex(void)
+{
+    int endIndex = _visualItems->count();
+
+    // First item with two or more batteries required once it completes
+    int low = 1;
+    int high = endIndex;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        const MissionFlightStatus_t& status = _flightStatusItems[mid + 1].walk.status;
+        if (_batteriesRequired(status.hoverTime, status.cruiseTime) >= 2) {
+            high = mid;
         } else {
-            _addCruiseTime(cruiseTime, distance, seqNum);
-            _addCruiseTime(extraTime, 0, -1);
+            low = mid + 1;
+        }
+    }
+
+    // The change point is the first waypoint leg which needs a second battery. If that leg already needs more than
+    // two there is no change point.
+    for (int i=low; i<endIndex; i++) {
+        const FlightStatusItem_t& flightStatusItem = _flightStatusItems[i];
+        for (int leg=0; leg<flightStatusItem.batteryLegCount; leg++) {
+            int batteriesRequired = _batteriesRequired(flightStatusItem.batteryLegHoverTime[leg], flightStatusItem.batteryLegCruiseTime[leg]);
+            if (batteriesRequired >= 2) {
+                return batteriesRequired == 2 ? i : -1;
+            }
         }
     }
+
+    return -1;
+}
+
+/// Keeps the recorded walk states in step with an item inserted at index. The new item starts with the walk state of
+/// the item it was inserted in front of.
+void MissionController::_insertRecalcState(int index)
+{
+    if (_flightStatusItems.count() == _visualItems->count()) {
+        FlightStatusItem_t flightStatusItem = _flightStatusItems[index];
+        flightStatusItem.minAltitude =          std::numeric_limits<double>::quiet_NaN();
+        flightStatusItem.maxAltitude =          std::numeric_limits<double>::quiet_NaN();
+        flightStatusItem.maxTelemetryDistance = 0.0;
+        flightStatusItem.batteryLegCount =      0;
+        flightStatusItem.rangeSlot =            _allocFlightStatusRange();
+        _flightStatusItems.insert(index, flightStatusItem);
+    }
+
+    if (_waypointLineItems.count() == _visualItems->count()) {
+        WaypointLineItem_t lineItem = _waypointLineItems[index];
+        lineItem.item = NULL;
+        lineItem.line.line = NULL;
+        lineItem.line.from = NULL;
+        lineItem.line.to = NULL;
+        _waypointLineItems.insert(index, lineItem);
+    }
+}
+
+/// Keeps the recorded walk states in step with the item removed from index. The walk state of the removed item
+/// becomes the walk state of the item which follows it.
+void MissionController::_removeRecalcState(int index)
+{
+    if (_flightStatusItems.count() == _visualItems->count() + 2) {
+        int removedSlot = _flightStatusItems[index].rangeSlot;
+        _flightStatusItems[index + 1].walk = _flightStatusItems[index].walk;
+        _flightStatusItems.remove(index);
+        _freeFlightStatusRange(removedSlot);
+    }
+
+    if (_waypointLineItems.count() == _visualItems->count() + 2) {
+        WaypointLineItem_t& lineItem = _waypointLineItems[index];
+        _setWaypointLine(lineItem.line, NULL, NULL);
+        WaypointLineItem_t& nextLineItem = _waypointLineItems[index + 1];
+        nextLineItem.lastCoordinateItem =   lineItem.lastCoordinateItem;
+        nextLineItem.firstCoordinateItem =  lineItem.firstCoordinateItem;
+        nextLineItem.linkStartToHome =      lineItem.linkStartToHome;
+        _waypointLineItems.remove(index);
+    }
+}
+
+void MissionController::_recalcMissionFlightStatus(void)
+{
+    _recalcMissionFlightStatusFrom(0, 0);
+}
+
+/// @return true: Walk state matches the previously recorded walk state, so the items which follow will produce the same values
+bool MissionController::_flightStatusWalkMatches(const FlightStatusWalk_t& walk, VisualMissionItem* lastCoordinateItem, bool firstCoordinateItem, bool vtolInHover, bool linkStartToHome)
+{
+    const MissionFlightStatus_t& status = walk.status;
+
+    return walk.lastCoordinateItem == lastCoordinateItem &&
+            walk.firstCoordinateItem == firstCoordinateItem &&
+            walk.vtolInHover == vtolInHover &&
+            walk.linkStartToHome == linkStartToHome &&
+            status.hoverSpeed == _missionFlightStatus.hoverSpeed &&
+            status.cruiseSpeed == _missionFlightStatus.cruiseSpeed &&
+            status.vehicleSpeed == _missionFlightStatus.vehicleSpeed &&
+            status.vehicleYaw == _missionFlightStatus.vehicleYaw &&
+            (status.gimbalYaw == _missionFlightStatus.gimbalYaw || (qIsNaN(status.gimbalYaw) && qIsNaN(_missionFlightStatus.gimbalYaw)));
 }
 
-void MissionController::_recalcMissionFlightStatus()
+/// Recalculates the flight status values for all items at or after startIndex. The walk state before each item is
+/// recorded, so the walk can resume at startIndex. Once past lastChangedIndex and back in sync with the previous walk
+/// the remaining items would produce the same values, so only the time/distance prefix sums are shifted.
+void MissionController::_recalcMissionFlightStatusFrom(int startIndex, int lastChangedIndex)
 {
     if (!_visualItems->count()) {
         return;
     }
 
-    bool                firstCoordinateItem =   true;
-    VisualMissionItem*  lastCoordinateItem =    qobject_cast<VisualMissionItem*>(_visualItems->get(0));
+    if (startIndex <= 0 || startIndex > _visualItems->count() || _flightStatusItems.count() != _visualItems->count() + 1) {
+        startIndex = 0;
+    }
 
     bool showHomePosition = _settingsItem->coordinate().isValid();
+    const double homePositionAltitude = _settingsItem->coordinate().altitude();
+    const GeoOrigin_t homeOrigin = geoOrigin(_settingsItem->exitCoordinate());
 
-    qCDebug(MissionControllerLog) << "_recalcMissionFlightStatus";
+    qCDebug(MissionControllerLog) << "_recalcMissionFlightStatus startIndex" << startIndex;
 
     // If home position is valid we can calculate distances between all waypoints.
     // If home position is not valid we can only calculate distances between waypoints which are
     // both relative altitude.
 
-    // No values for first item
-    lastCoordinateItem->setAltDifference(0.0);
-    lastCoordinateItem->setAzimuth(0.0);
-    lastCoordinateItem->setDistance(0.0);
+    bool                firstCoordinateItem;
+    VisualMissionItem*  lastCoordinateItem;
+    bool                vtolInHover;
+    bool                linkStartToHome;
 
-    double minAltSeen = 0.0;
-    double maxAltSeen = 0.0;
-    const double homePositionAltitude = _settingsItem->coordinate().altitude();
-    minAltSeen = maxAltSeen = _settingsItem->coordinate().altitude();
+    if (startIndex == 0) {
+        lastCoordinateItem = qobject_cast<VisualMissionItem*>(_visualItems->get(0));
 
-    _resetMissionFlightStatus();
+        // No values for first item
+        lastCoordinateItem->setAltDifference(0.0);
+        lastCoordinateItem->setAzimuth(0.0);
+        lastCoordinateItem->setDistance(0.0);
 
-    bool vtolInHover = true;
-    bool linkStartToHome = false;
-    bool linkEndToHome = false;
+        _resetMissionFlightStatus();
 
-    if (showHomePosition) {
-        SimpleMissionItem* lastItem = _visualItems->value<SimpleMissionItem*>(_visualItems->count() - 1);
-        if (lastItem && (int)lastItem->command() == MAV_CMD_NAV_RETURN_TO_LAUNCH) {
-            linkEndToHome = true;
-        } else {
-            linkEndToHome = _settingsItem->missionEndRTL();
-        }
+        firstCoordinateItem = true;
+        vtolInHover = true;
+        linkStartToHome = false;
+
+        _flightStatusItems.resize(_visualItems->count() + 1);
+        _resetFlightStatusRanges();
+    } else {
+        const FlightStatusWalk_t& walk = _flightStatusItems[startIndex].walk;
+
+        _missionFlightStatus = walk.status;
+        lastCoordinateItem = walk.lastCoordinateItem;
+        firstCoordinateItem = walk.firstCoordinateItem;
+        vtolInHover = walk.vtolInHover;
+        linkStartToHome = walk.linkStartToHome;
     }
 
-    for (int i=0; i<_visualItems->count(); i++) {
+    int     endIndex =              _visualItems->count();
+    int     syncIndex =             -1;
+    bool    passedCoordinateItem =  false;
+
+    for (int i=startIndex; i<endIndex; i++) {
         VisualMissionItem* item = qobject_cast<VisualMissionItem*>(_visualItems->get(i));
         SimpleMissionItem* simpleItem = qobject_cast<SimpleMissionItem*>(item);
         ComplexMissionItem* complexItem = qobject_cast<ComplexMissionItem*>(item);
+        FlightStatusItem_t& flightStatusItem = _flightStatusItems[i];
+
+        // Once we are past a coordinate item which follows the change, a matching walk state means nothing else changes
+        if (startIndex != 0 && passedCoordinateItem && _flightStatusWalkMatches(flightStatusItem.walk, lastCoordinateItem, firstCoordinateItem, vtolInHover, linkStartToHome)) {
+            syncIndex = i;
+            break;
+        }
+
+        flightStatusItem.walk.status =              _missionFlightStatus;
+        flightStatusItem.walk.lastCoordinateItem =  lastCoordinateItem;
+        flightStatusItem.walk.firstCoordinateItem = firstCoordinateItem;
+        flightStatusItem.walk.vtolInHover =         vtolInHover;
+        flightStatusItem.walk.linkStartToHome =     linkStartToHome;
+        flightStatusItem.minAltitude =              std::numeric_limits<double>::quiet_NaN();
+        flightStatusItem.maxAltitude =              std::numeric_limits<double>::quiet_NaN();
+        flightStatusItem.maxTelemetryDistance =     0.0;
+        flightStatusItem.batteryLegCount =          0;
 
         // Assume the worst
         item->setAzimuth(0.0);
@@ -1146,6 +1611,7 @@ void MissionController::_recalcMissionFlightStatus()
 
         if (i == 0) {
             // We only process speed and gimbal from Mission Settings item
+            _setFlightStatusRange(flightStatusItem.rangeSlot, flightStatusItem.minAltitude, flightStatusItem.maxAltitude, flightStatusItem.maxTelemetryDistance);
             continue;
         }
 
@@ -1158,7 +1624,7 @@ void MissionController::_recalcMissionFlightStatus()
                     double azimuth, distance, altDifference;
                     _calcPrevWaypointValues(homePositionAltitude, _settingsItem, simpleItem, &azimuth, &distance, &altDifference);
                     double takeoffTime = qAbs(altDifference) / _appSettings->offlineEditingAscentSpeed()->rawValue().toDouble();
-                    _addHoverTime(takeoffTime, 0, -1);
+                    _addHoverTime(takeoffTime, 0);
                 }
             }
         }
@@ -1203,16 +1669,15 @@ void MissionController::_recalcMissionFlightStatus()
             if (item->coordinateHasRelativeAltitude()) {
                 absoluteAltitude += homePositionAltitude;
             }
-            minAltSeen = std::min(minAltSeen, absoluteAltitude);
-            maxAltSeen = std::max(maxAltSeen, absoluteAltitude);
+            flightStatusItem.minAltitude = flightStatusItem.maxAltitude = absoluteAltitude;
 
             if (!item->exitCoordinateSameAsEntry()) {
                 absoluteAltitude = item->exitCoordinate().altitude();
                 if (item->exitCoordinateHasRelativeAltitude()) {
                     absoluteAltitude += homePositionAltitude;
                 }
-                minAltSeen = std::min(minAltSeen, absoluteAltitude);
-                maxAltSeen = std::max(maxAltSeen, absoluteAltitude);
+                flightStatusItem.minAltitude = std::min(flightStatusItem.minAltitude, absoluteAltitude);
+                flightStatusItem.maxAltitude = std::max(flightStatusItem.maxAltitude, absoluteAltitude);
             }
 
             if (!item->isStandaloneCoordinate()) {
@@ -1226,33 +1691,89 @@ void MissionController::_recalcMissionFlightStatus()
                     item->setAzimuth(azimuth);
                     item->setDistance(distance);
 
-                    _missionFlightStatus.maxTelemetryDistance = qMax(_missionFlightStatus.maxTelemetryDistance, _calcDistanceToHome(item, _settingsItem));
+                    if (showHomePosition) {
+                        flightStatusItem.maxTelemetryDistance = qMax(flightStatusItem.maxTelemetryDistance, _calcDistanceToHome(item, homeOrigin));
+                    }
 
                     // Calculate time/distance
                     double hoverTime = distance / _missionFlightStatus.hoverSpeed;
                     double cruiseTime = distance / _missionFlightStatus.cruiseSpeed;
-                    _addTimeDistance(vtolInHover, hoverTime, cruiseTime, 0, distance, item->sequenceNumber());
+                    _addTimeDistance(vtolInHover, hoverTime, cruiseTime, 0, distance, &flightStatusItem);
                 }
 
                 if (complexItem) {
                     // Add in distance/time inside complex items as well
                     double distance = complexItem->complexDistance();
-                    _missionFlightStatus.maxTelemetryDistance = qMax(_missionFlightStatus.maxTelemetryDistance, complexItem->greatestDistanceTo(complexItem->exitCoordinate()));
+                    flightStatusItem.maxTelemetryDistance = qMax(flightStatusItem.maxTelemetryDistance, complexItem->greatestDistanceTo(complexItem->exitCoordinate()));
 
                     double hoverTime = distance / _missionFlightStatus.hoverSpeed;
                     double cruiseTime = distance / _missionFlightStatus.cruiseSpeed;
                     double extraTime = complexItem->additionalTimeDelay();
-                    _addTimeDistance(vtolInHover, hoverTime, cruiseTime, extraTime, distance, item->sequenceNumber());
+                    _addTimeDistance(vtolInHover, hoverTime, cruiseTime, extraTime, distance, &flightStatusItem);
                 }
 
                 item->setMissionFlightStatus(_missionFlightStatus);
+
+                if (i > startIndex && i > lastChangedIndex) {
+                    passedCoordinateItem = true;
+                }
             }
 
             lastCoordinateItem = item;
         }
+
+        _setFlightStatusRange(flightStatusItem.rangeSlot, flightStatusItem.minAltitude, flightStatusItem.maxAltitude, flightStatusItem.maxTelemetryDistance);
+    }
+
+    FlightStatusWalk_t& endWalk = _flightStatusItems[endIndex].walk;
+    if (syncIndex == -1) {
+        endWalk.status =                _missionFlightStatus;
+        endWalk.lastCoordinateItem =    lastCoordinateItem;
+        endWalk.firstCoordinateItem =   firstCoordinateItem;
+        endWalk.vtolInHover =           vtolInHover;
+        endWalk.linkStartToHome =       linkStartToHome;
+    } else {
+        // Shift the prefix sums for the rest of the mission by the change in totals
+        const MissionFlightStatus_t& syncStatus = _flightStatusItems[syncIndex].walk.status;
+        double totalDistanceDelta =     _missionFlightStatus.totalDistance - syncStatus.totalDistance;
+        double totalTimeDelta =         _missionFlightStatus.totalTime - syncStatus.totalTime;
+        double hoverDistanceDelta =     _missionFlightStatus.hoverDistance - syncStatus.hoverDistance;
+        double hoverTimeDelta =         _missionFlightStatus.hoverTime - syncStatus.hoverTime;
+        double cruiseDistanceDelta =    _missionFlightStatus.cruiseDistance - syncStatus.cruiseDistance;
+        double cruiseTimeDelta =        _missionFlightStatus.cruiseTime - syncStatus.cruiseTime;
+
+        for (int i=syncIndex; i<=endIndex; i++) {
+            FlightStatusItem_t& flightStatusItem = _flightStatusItems[i];
+            MissionFlightStatus_t& status = flightStatusItem.walk.status;
+
+            status.totalDistance +=     totalDistanceDelta;
+            status.totalTime +=         totalTimeDelta;
+            status.hoverDistance +=     hoverDistanceDelta;
+            status.hoverTime +=         hoverTimeDelta;
+            status.cruiseDistance +=    cruiseDistanceDelta;
+            status.cruiseTime +=        cruiseTimeDelta;
+            for (int leg=0; leg<flightStatusItem.batteryLegCount; leg++) {
+                flightStatusItem.batteryLegHoverTime[leg] += hoverTimeDelta;
+                flightStatusItem.batteryLegCruiseTime[leg] += cruiseTimeDelta;
+            }
+        }
+
+        _missionFlightStatus = endWalk.status;
+        lastCoordinateItem = endWalk.lastCoordinateItem;
+        vtolInHover = endWalk.vtolInHover;
     }
     lastCoordinateItem->setMissionVehicleYaw(_missionFlightStatus.vehicleYaw);
 
+    bool linkEndToHome = false;
+    if (showHomePosition) {
+        SimpleMissionItem* lastItem = _visualItems->value<SimpleMissionItem*>(_visualItems->count() - 1);
+        if (lastItem && (int)lastItem->command() == MAV_CMD_NAV_RETURN_TO_LAUNCH) {
+            linkEndToHome = true;
+        } else {
+            linkEndToHome = _settingsItem->missionEndRTL();
+        }
+    }
+
     if (linkEndToHome && lastCoordinateItem != _settingsItem) {
         double azimuth, distance, altDifference;
         _calcPrevWaypointValues(homePositionAltitude, lastCoordinateItem, _settingsItem, &azimuth, &distance, &altDifference);
@@ -1261,9 +1782,25 @@ void MissionController::_recalcMissionFlightStatus()
         double hoverTime = distance / _missionFlightStatus.hoverSpeed;
         double cruiseTime = distance / _missionFlightStatus.cruiseSpeed;
         double landTime = qAbs(altDifference) / _appSettings->offlineEditingDescentSpeed()->rawValue().toDouble();
-        _addTimeDistance(vtolInHover, hoverTime, cruiseTime, distance, landTime, -1);
+        _addTimeDistance(vtolInHover, hoverTime, cruiseTime, distance, landTime, NULL);
     }
 
+    // Mission wide values come from the root of the range tree
+    const FlightStatusRange_t& missionRange = _flightStatusRanges[1];
+    double minAltSeen = std::min(homePositionAltitude, missionRange.minAltitude);
+    double maxAltSeen = std::max(homePositionAltitude, missionRange.maxAltitude);
+    _missionFlightStatus.maxTelemetryDistance = missionRange.maxTelemetryDistance;
+    _missionFlightStatus.batteryChangePoint = -1;
+    if (_missionFlightStatus.mAhBattery != 0) {
+        int changeIndex = _batteryChangeIndex();
+        if (changeIndex != -1) {
+            _missionFlightStatus.batteryChangePoint = _visualItems->value<VisualMissionItem*>(changeIndex)->sequenceNumber() - 1;
+        }
+    }
+
+    if (endIndex > 1) {
+        _updateBatteryInfo();
+    }
     if (_missionFlightStatus.mAhBattery != 0 && _missionFlightStatus.batteryChangePoint == -1) {
         _missionFlightStatus.batteryChangePoint = 0;
     }
@@ -1278,9 +1815,26 @@ void MissionController::_recalcMissionFlightStatus()
     emit batteryChangePointChanged(_missionFlightStatus.batteryChangePoint);
     emit batteriesRequiredChanged(_missionFlightStatus.batteriesRequired);
 
-    // Walk the list again calculating altitude percentages
+    if (startIndex == 0 || minAltSeen != _minAltSeen || maxAltSeen != _maxAltSeen) {
+        _updateAltPercents(0, endIndex - 1, minAltSeen, maxAltSeen);
+    } else {
+        // Altitude range is unchanged, so only the items which were walked can have a new percentage
+        _updateAltPercents(startIndex, syncIndex == -1 ? endIndex - 1 : syncIndex - 1, minAltSeen, maxAltSeen);
+    }
+    _minAltSeen = minAltSeen;
+    _maxAltSeen = maxAltSeen;
+
+    _optimizeSurveyRoute();
+    _updateTerrainClearance(startIndex, lastChangedIndex);
+}
+
+/// Updates the altitude percentage for the specified range of items
+void MissionController::_updateAltPercents(int firstIndex, int lastIndex, double minAltSeen, double maxAltSeen)
+{
+    const double homePositionAltitude = _settingsItem->coordinate().altitude();
     double altRange = maxAltSeen - minAltSeen;
-    for (int i=0; i<_visualItems->count(); i++) {
+
+    for (int i=firstIndex; i<=lastIndex; i++) {
         VisualMissionItem* item = qobject_cast<VisualMissionItem*>(_visualItems->get(i));
 
         if (item->specifiesCoordinate()) {
@@ -1297,32 +1851,55 @@ void MissionController::_recalcMissionFlightStatus()
     }
 }
 
-// This will update the sequence numbers to be sequential starting from 0
-void MissionController::_recalcSequence(void)
+// This will update the sequence numbers to be sequential starting from 0. Items prior to startIndex must already be sequential.
+void MissionController::_recalcSequence(int startIndex)
 {
-    // Setup ascending sequence numbers for all visual items
+    if (_recalcSequenceActive) {
+        // Signalled by an item we are renumbering, the loop below already picks up its new last sequence number
+        return;
+    }
+    _recalcSequenceActive = true;
 
     int sequenceNumber = 0;
-    for (int i=0; i<_visualItems->count(); i++) {
+    if (startIndex > 0) {
+        sequenceNumber = _visualItems->value<VisualMissionItem*>(startIndex - 1)->lastSequenceNumber() + 1;
+    } else {
+        _visualItemIndexes.clear();
+    }
+
+    for (int i=startIndex; i<_visualItems->count(); i++) {
         VisualMissionItem* item = qobject_cast<VisualMissionItem*>(_visualItems->get(i));
 
         item->setSequenceNumber(sequenceNumber);
         sequenceNumber = item->lastSequenceNumber() + 1;
+        _visualItemIndexes[item] = i;
     }
+
+    _recalcSequenceActive = false;
 }
 
-// This will update the child item hierarchy
-void MissionController::_recalcChildItems(void)
+// This will update the child item hierarchy for items from startIndex through lastChangedIndex
+void MissionController::_recalcChildItems(int startIndex, int lastChangedIndex)
 {
-    VisualMissionItem* currentParentItem = qobject_cast<VisualMissionItem*>(_visualItems->get(0));
+    // Start from the coordinate item which owns the first changed item
+    int parentIndex = qMax(startIndex - 1, 0);
+    while (parentIndex > 0 && !_visualItems->value<VisualMissionItem*>(parentIndex)->specifiesCoordinate()) {
+        parentIndex--;
+    }
+
+    VisualMissionItem* currentParentItem = qobject_cast<VisualMissionItem*>(_visualItems->get(parentIndex));
 
     currentParentItem->childItems()->clear();
 
-    for (int i=1; i<_visualItems->count(); i++) {
+    for (int i=parentIndex+1; i<_visualItems->count(); i++) {
         VisualMissionItem* item = qobject_cast<VisualMissionItem*>(_visualItems->get(i));
 
         // Set up non-coordinate item child hierarchy
         if (item->specifiesCoordinate()) {
+            if (startIndex > 0 && i > lastChangedIndex) {
+                // Children of the remaining coordinate items are not affected
+                break;
+            }
             item->childItems()->clear();
             currentParentItem = item;
         } else if (item->isSimpleItem()) {
@@ -1349,13 +1926,150 @@ void MissionController::_setPlannedHomePositionFromFirstCoordinate(void)
 
 
 void MissionController::_recalcAll(void)
+{
+    _recalcAllFrom(0);
+}
+
+/// Recalculates everything which depends on the visual items at or after startIndex. Any queued recalc is folded in.
+void MissionController::_recalcAllFrom(int startIndex)
 {
     if (_editMode) {
         _setPlannedHomePositionFromFirstCoordinate();
     }
-    _recalcSequence();
-    _recalcChildItems();
-    _recalcWaypointLines();
+
+    // Queued indices may have shifted due to an insert/remove, so cover the full range
+    int waypointLinesIndex = startIndex;
+    int waypointLinesLastIndex = startIndex;
+    if (_pendingWaypointLinesIndex != -1) {
+        waypointLinesIndex = qMin(startIndex, _pendingWaypointLinesIndex);
+        waypointLinesLastIndex = qMax(startIndex, _pendingWaypointLinesLastIndex + 1);
+    }
+    int flightStatusIndex = startIndex;
+    int lastChangedIndex = startIndex;
+    if (_pendingFlightStatusIndex != -1) {
+        flightStatusIndex = qMin(startIndex, _pendingFlightStatusIndex);
+        lastChangedIndex = qMax(startIndex, _pendingFlightStatusLastIndex + 1);
+    }
+    _clearPendingRecalc();
+
+    _recalcSequence(startIndex);
+    _recalcChildItems(waypointLinesIndex, waypointLinesLastIndex);
+    _updateWaypointLinesFrom(waypointLinesIndex, waypointLinesLastIndex);
+    _recalcMissionFlightStatusFrom(flightStatusIndex, lastChangedIndex);
+    emit waypointLinesChanged();
+}
+
+void MissionController::_clearPendingRecalc(void)
+{
+    _pendingWaypointLinesIndex = -1;
+    _pendingWaypointLinesLastIndex = -1;
+    _pendingFlightStatusIndex = -1;
+    _pendingFlightStatusLastIndex = -1;
+    _cancelRecalc();
+}
+
+void MissionController::_queueRecalcAll(void)
+{
+    _queueWaypointLinesRecalcFrom(0);
+}
+
+void MissionController::_queueWaypointLinesRecalcFrom(int index)
+{
+    if (_pendingWaypointLinesIndex == -1) {
+        _pendingWaypointLinesIndex = index;
+        _pendingWaypointLinesLastIndex = index;
+    } else {
+        _pendingWaypointLinesIndex = qMin(_pendingWaypointLinesIndex, index);
+        _pendingWaypointLinesLastIndex = qMax(_pendingWaypointLinesLastIndex, index);
+    }
+
+    // Changes to the lines change the flight path from that item on
+    _queueFlightStatusRecalcFrom(index);
+}
+
+void MissionController::_queueFlightStatusRecalc(void)
+{
+    _queueFlightStatusRecalcFrom(0);
+}
+
+void MissionController::_queueFlightStatusRecalcFrom(int index)
+{
+    if (_pendingFlightStatusIndex == -1) {
+        _pendingFlightStatusIndex = index;
+        _pendingFlightStatusLastIndex = index;
+    } else {
+        _pendingFlightStatusIndex = qMin(_pendingFlightStatusIndex, index);
+        _pendingFlightStatusLastIndex = qMax(_pendingFlightStatusLastIndex, index);
+    }
+    _queueRecalc();
+}
+
+/// Performs the recalculations queued by item changes since control last returned to the event loop
+void MissionController::_recalc(void)
+{
+    int waypointLinesIndex =        _pendingWaypointLinesIndex;
+    int waypointLinesLastIndex =    _pendingWaypointLinesLastIndex;
+    int flightStatusIndex =         _pendingFlightStatusIndex;
+    int lastChangedIndex =          _pendingFlightStatusLastIndex;
+    _clearPendingRecalc();
+
+    if (!_visualItems || !_settingsItem) {
+        return;
+    }
+
+    qCDebug(MissionControllerLog) << "_recalc waypointLinesIndex:flightStatusIndex" << waypointLinesIndex << flightStatusIndex;
+
+    if (waypointLinesIndex != -1) {
+        _recalcChildItems(waypointLinesIndex, waypointLinesLastIndex);
+        _updateWaypointLinesFrom(waypointLinesIndex, waypointLinesLastIndex);
+    }
+    if (flightStatusIndex != -1) {
+        _recalcMissionFlightStatusFrom(flightStatusIndex, lastChangedIndex);
+    }
+    if (waypointLinesIndex != -1) {
+        emit waypointLinesChanged();
+    }
+}
+
+/// @return Index of the specified item within the visual item list, -1 if not in the list
+int MissionController::_visualItemIndex(VisualMissionItem* visualItem)
+{
+    int index = _visualItemIndexes.value(visualItem, -1);
+
+    if (index == -1 || index >= _visualItems->count() || _visualItems->get(index) != visualItem) {
+        index = _visualItems->indexOf(visualItem);
+    }
+
+    return index;
+}
+
+void MissionController::_itemFlightStatusChanged(void)
+{
+    int index = _visualItemIndex(qobject_cast<VisualMissionItem*>(sender()));
+
+    // Items which are not in the list yet are calculated when they are inserted
+    if (index != -1) {
+        _queueFlightStatusRecalcFrom(index);
+    }
+}
+
+void MissionController::_itemWaypointLinesChanged(void)
+{
+    int index = _visualItemIndex(qobject_cast<VisualMissionItem*>(sender()));
+
+    // Items which are not in the list yet are calculated when they are inserted
+    if (index != -1) {
+        _queueWaypointLinesRecalcFrom(index);
+    }
+}
+
+void MissionController::_itemLastSequenceNumberChanged(void)
+{
+    int index = _visualItemIndex(qobject_cast<VisualMissionItem*>(sender()));
+
+    if (index != -1) {
+        _recalcSequence(index + 1);
+    }
 }
 
 /// Initializes a new set of mission items
@@ -1376,8 +2090,8 @@ void MissionController::_initAllVisualItems(void)
         _settingsItem->setCoordinate(_managerVehicle->homePosition());
     }
 
-    connect(_settingsItem, &MissionSettingsItem::coordinateChanged,     this, &MissionController::_recalcAll);
-    connect(_settingsItem, &MissionSettingsItem::missionEndRTLChanged,  this, &MissionController::_recalcAll);
+    connect(_settingsItem, &MissionSettingsItem::coordinateChanged,     this, &MissionController::_queueRecalcAll);
+    connect(_settingsItem, &MissionSettingsItem::missionEndRTLChanged,  this, &MissionController::_queueRecalcAll);
     connect(_settingsItem, &MissionSettingsItem::coordinateChanged,     this, &MissionController::plannedHomePositionChanged);
 
     for (int i=0; i<_visualItems->count(); i++) {
@@ -1399,7 +2113,7 @@ void MissionController::_initAllVisualItems(void)
 
 void MissionController::_deinitAllVisualItems(void)
 {
-    disconnect(_settingsItem, &MissionSettingsItem::coordinateChanged, this, &MissionController::_recalcAll);
+    disconnect(_settingsItem, &MissionSettingsItem::coordinateChanged, this, &MissionController::_queueRecalcAll);
     disconnect(_settingsItem, &MissionSettingsItem::coordinateChanged, this, &MissionController::plannedHomePositionChanged);
 
     for (int i=0; i<_visualItems->count(); i++) {
@@ -1408,32 +2122,53 @@ void MissionController::_deinitAllVisualItems(void)
 
     disconnect(_visualItems, &QmlObjectListModel::dirtyChanged, this, &MissionController::dirtyChanged);
     disconnect(_visualItems, &QmlObjectListModel::countChanged, this, &MissionController::_updateContainsItems);
+
+    _flightStatusItems.clear();
+    _clearWaypointLines();
+    _routeVariants.clear();
+    _visualItemIndexes.clear();
+    _clearPendingRecalc();
+    _clearSurveyRoute();
+    _clearTerrainClearance();
 }
 
 void MissionController::_initVisualItem(VisualMissionItem* visualItem)
 {
     setDirty(false);
 
-    connect(visualItem, &VisualMissionItem::specifiesCoordinateChanged,                 this, &MissionController::_recalcWaypointLines);
-    connect(visualItem, &VisualMissionItem::coordinateHasRelativeAltitudeChanged,       this, &MissionController::_recalcWaypointLines);
-    connect(visualItem, &VisualMissionItem::exitCoordinateHasRelativeAltitudeChanged,   this, &MissionController::_recalcWaypointLines);
-    connect(visualItem, &VisualMissionItem::specifiedFlightSpeedChanged,                this, &MissionController::_recalcMissionFlightStatus);
-    connect(visualItem, &VisualMissionItem::specifiedGimbalYawChanged,                  this, &MissionController::_recalcMissionFlightStatus);
-    connect(visualItem, &VisualMissionItem::lastSequenceNumberChanged,                  this, &MissionController::_recalcSequence);
+    connect(visualItem, &VisualMissionItem::specifiesCoordinateChanged,                 this, &MissionController::_itemWaypointLinesChanged);
+    connect(visualItem, &VisualMissionItem::coordinateHasRelativeAltitudeChanged,       this, &MissionController::_itemFlightStatusChanged);
+    connect(visualItem, &VisualMissionItem::exitCoordinateHasRelativeAltitudeChanged,   this, &MissionController::_itemFlightStatusChanged);
+    connect(visualItem, &VisualMissionItem::specifiedFlightSpeedChanged,                this, &MissionController::_itemFlightStatusChanged);
+    connect(visualItem, &VisualMissionItem::specifiedGimbalYawChanged,                  this, &MissionController::_itemFlightStatusChanged);
+    connect(visualItem, &VisualMissionItem::lastSequenceNumberChanged,                  this, &MissionController::_itemLastSequenceNumberChanged);
+
+    if (visualItem != _settingsItem) {
+        // Mission Settings coordinate changes go through _queueRecalcAll
+        connect(visualItem, &VisualMissionItem::coordinateChanged,                      this, &MissionController::_itemFlightStatusChanged);
+    }
 
     if (visualItem->isSimpleItem()) {
         // We need to track commandChanged on simple item since recalc has special handling for takeoff command
         SimpleMissionItem* simpleItem = qobject_cast<SimpleMissionItem*>(visualItem);
         if (simpleItem) {
-            connect(&simpleItem->missionItem()._commandFact, &Fact::valueChanged, this, &MissionController::_itemCommandChanged);
+            connect(simpleItem, &SimpleMissionItem::commandChanged, this, &MissionController::_itemCommandChanged);
         } else {
             qWarning() << "isSimpleItem == true, yet not SimpleMissionItem";
         }
     } else {
         ComplexMissionItem* complexItem = qobject_cast<ComplexMissionItem*>(visualItem);
         if (complexItem) {
-            connect(complexItem, &ComplexMissionItem::complexDistanceChanged,       this, &MissionController::_recalcMissionFlightStatus);
-            connect(complexItem, &ComplexMissionItem::additionalTimeDelayChanged,   this, &MissionController::_recalcMissionFlightStatus);
+            connect(complexItem, &ComplexMissionItem::complexDistanceChanged,       this, &MissionController::_itemFlightStatusChanged);
+            connect(complexItem, &ComplexMissionItem::additionalTimeDelayChanged,   this, &MissionController::_itemFlightStatusChanged);
+            if (visualItem != _settingsItem) {
+                connect(complexItem, &ComplexMissionItem::exitCoordinateChanged,    this, &MissionController::_itemFlightStatusChanged);
+            }
+            SurveyMissionItem* surveyItem = qobject_cast<SurveyMissionItem*>(complexItem);
+            if (surveyItem) {
+                // The terrain path follows the grid, which can change without changing the survey distance
+                connect(surveyItem, &SurveyMissionItem::gridPointsChanged,          this, &MissionController::_itemFlightStatusChanged);
+            }
         } else {
             qWarning() << "ComplexMissionItem not found";
         }
@@ -1448,8 +2183,8 @@ void MissionController::_deinitVisualItem(VisualMissionItem* visualItem)
 
 void MissionController::_itemCommandChanged(void)
 {
-    _recalcChildItems();
-    _recalcWaypointLines();
+    // Takeoff, VTOL transition and RTL commands only change the lines and flight status from the item on
+    _itemWaypointLinesChanged();
 }
 
 void MissionController::managerVehicleChanged(Vehicle* managerVehicle)
@@ -1477,8 +2212,8 @@ void MissionController::managerVehicleChanged(Vehicle* managerVehicle)
     connect(_missionManager, &MissionManager::lastCurrentIndexChanged,  this, &MissionController::resumeMissionIndexChanged);
     connect(_missionManager, &MissionManager::resumeMissionReady,       this, &MissionController::resumeMissionReady);
     connect(_managerVehicle, &Vehicle::homePositionChanged,             this, &MissionController::_managerVehicleHomePositionChanged);
-    connect(_managerVehicle, &Vehicle::defaultCruiseSpeedChanged,       this, &MissionController::_recalcMissionFlightStatus);
-    connect(_managerVehicle, &Vehicle::defaultHoverSpeedChanged,        this, &MissionController::_recalcMissionFlightStatus);
+    connect(_managerVehicle, &Vehicle::defaultCruiseSpeedChanged,       this, &MissionController::_queueFlightStatusRecalc);
+    connect(_managerVehicle, &Vehicle::defaultHoverSpeedChanged,        this, &MissionController::_queueFlightStatusRecalc);
     connect(_managerVehicle, &Vehicle::vehicleTypeChanged,              this, &MissionController::complexMissionItemNamesChanged);
 
     if (!_masterController->offline()) {
@@ -1811,3 +2546,452 @@ void MissionController::_managerRemoveAllComplete(bool error)
         showPlanFromManagerVehicle();
     }
 }
+
+/// Splits the mission into runs of consecutive survey items. The surveys within a run can be flown in any order
+/// without changing what the rest of the mission does.
+///     @param[out] runSurveys Survey items for each run
+QList<SurveyRouteOptimizer::Run_t> MissionController::_surveyRouteRuns(QList<QList<QPointer<SurveyMissionItem>>>& runSurveys)
+{
+    QList<SurveyRouteOptimizer::Run_t> runs;
+
+    runSurveys.clear();
+
+    bool                homeValid = _settingsItem->coordinate().isValid();
+    VisualMissionItem*  lastCoordinateItem = homeValid ? _settingsItem : NULL;
+
+    int i = 1;
+    while (i < _visualItems->count()) {
+        SurveyMissionItem* surveyItem = _visualItems->value<SurveyMissionItem*>(i);
+        if (!surveyItem || !surveyItem->specifiesCoordinate()) {
+            VisualMissionItem* item = _visualItems->value<VisualMissionItem*>(i);
+            if (item->specifiesCoordinate() && !item->isStandaloneCoordinate()) {
+                lastCoordinateItem = item;
+            }
+            i++;
+            continue;
+        }
+
+        SurveyRouteOptimizer::Run_t         run;
+        QList<QPointer<SurveyMissionItem>>  surveys;
+
+        run.start = lastCoordinateItem ? lastCoordinateItem->exitCoordinate() : QGeoCoordinate();
+        while (i < _visualItems->count()) {
+            surveyItem = _visualItems->value<SurveyMissionItem*>(i);
+            if (!surveyItem || !surveyItem->specifiesCoordinate()) {
+                break;
+            }
+            run.surveys.append(surveyItem->gridParams());
+            surveys.append(surveyItem);
+            i++;
+        }
+        lastCoordinateItem = surveys.last();
+
+        // The route ends at the next item the vehicle flies to, or back at home
+        for (int j=i; j<_visualItems->count(); j++) {
+            VisualMissionItem* item = _visualItems->value<VisualMissionItem*>(j);
+            if (item->specifiesCoordinate() && !item->isStandaloneCoordinate()) {
+                run.end = item->coordinate();
+                break;
+            }
+        }
+        if (!run.end.isValid() && homeValid && _settingsItem->missionEndRTL()) {
+            run.end = _settingsItem->coordinate();
+        }
+
+        runs.append(run);
+        runSurveys.append(surveys);
+    }
+
+    return runs;
+}
+
+/// Schedules a survey route update once the plan stops changing
+void MissionController::_optimizeSurveyRoute(void)
+{
+    if (!_editMode || !_visualItems || !_settingsItem) {
+        return;
+    }
+
+    _routeTimer.start();
+}
+
+/// Starts a background optimization of the survey route if the surveys or their surroundings have changed
+void MissionController::_updateSurveyRoute(void)
+{
+    if (!_editMode || !_visualItems || !_settingsItem) {
+        return;
+    }
+
+    QList<QList<QPointer<SurveyMissionItem>>> runSurveys;
+    QList<SurveyRouteOptimizer::Run_t> runs = _surveyRouteRuns(runSurveys);
+
+    if (runSurveys == _routeSurveys && SurveyRouteOptimizer::sameRuns(runs, _routeRuns)) {
+        return;
+    }
+
+    // Surveys which are flown the same way as last time keep their variants, only the rest are regenerated
+    QHash<SurveyMissionItem*, RouteVariants_t> routeVariants;
+    for (int i=0; i<runs.count(); i++) {
+        SurveyRouteOptimizer::Run_t& run = runs[i];
+        for (int j=0; j<run.surveys.count(); j++) {
+            SurveyMissionItem*  surveyItem = runSurveys[i][j];
+            RouteVariants_t     cached = _routeVariants.value(surveyItem);
+
+            SurveyGridGenerator::Params_t params = run.surveys[j];
+            params.entryLocation = cached.params.entryLocation;
+            if (!cached.variants.isEmpty() && SurveyRouteOptimizer::sameParams(params, cached.params)) {
+                run.variants.append(cached.variants);
+                routeVariants[surveyItem] = cached;
+            } else {
+                run.variants.append(QVector<SurveyRouteOptimizer::Variant_t>());
+            }
+        }
+    }
+    _routeVariants = routeVariants;
+
+    _routeRuns = runs;
+    _routeSurveys = runSurveys;
+    _routeResults.clear();
+    _routeGeneration++;
+    _setRouteSavings(0, 0);
+
+    if (_routeRuns.isEmpty()) {
+        _routeCancel.store(1);
+    } else if (_routeWatcher.isRunning()) {
+        // Restarted for the new runs once the running optimization finishes
+        _routeCancel.store(1);
+    } else {
+        _startSurveyRouteOptimization();
+    }
+}
+
+void MissionController::_startSurveyRouteOptimization(void)
+{
+    qCDebug(MissionControllerLog) << "_startSurveyRouteOptimization runs:generation" << _routeRuns.count() << _routeGeneration;
+
+    _routeCancel.store(0);
+    _routeRunningGeneration = _routeGeneration;
+    _routeWatcher.setFuture(QtConcurrent::run(SurveyRouteOptimizer::optimize, _routeRuns, &_routeCancel));
+}
+
+void MissionController::_surveyRouteOptimized(void)
+{
+    if (_routeWatcher.isRunning()) {
+        // Late notification for an optimization which has already been replaced
+        return;
+    }
+    if (_routeRunningGeneration != _routeGeneration) {
+        // Plan changed while we were running, the results are for runs which no longer exist
+        if (!_routeRuns.isEmpty()) {
+            _startSurveyRouteOptimization();
+        }
+        return;
+    }
+    if (_routeCancel.load() || _routeRuns.isEmpty()) {
+        return;
+    }
+
+    QList<SurveyRouteOptimizer::Result_t> results = _routeWatcher.result();
+
+    // Keep the variants for the next optimization, even if it was cut short
+    for (int i=0; i<results.count(); i++) {
+        const QVector<QVector<SurveyRouteOptimizer::Variant_t>>& surveyVariants = results[i].surveyVariants;
+        for (int j=0; j<surveyVariants.count() && j<_routeSurveys[i].count(); j++) {
+            SurveyMissionItem* surveyItem = _routeSurveys[i][j];
+            if (surveyItem) {
+                RouteVariants_t& routeVariants = _routeVariants[surveyItem];
+                routeVariants.params = _routeRuns[i].surveys[j];
+                routeVariants.variants = surveyVariants[j];
+            }
+        }
+    }
+
+    if (results.count() != _routeRuns.count()) {
+        return;
+    }
+    _routeResults = results;
+
+    double savedDistance = 0;
+    for (int i=0; i<_routeResults.count(); i++) {
+        savedDistance += _routeResults[i].currentDistance - _routeResults[i].optimizedDistance;
+    }
+    double speed = _controllerVehicle->multiRotor() ? _missionFlightStatus.hoverSpeed : _missionFlightStatus.cruiseSpeed;
+    _setRouteSavings(savedDistance, speed > 0 ? savedDistance / speed : 0);
+}
+
+void MissionController::_clearSurveyRoute(void)
+{
+    _routeCancel.store(1);
+    _routeTimer.stop();
+    _routeGeneration++;
+    _routeRuns.clear();
+    _routeSurveys.clear();
+    _routeResults.clear();
+    _setRouteSavings(0, 0);
+}
+
+void MissionController::_setRouteSavings(double savedDistance, double savedTime)
+{
+    if (savedDistance != _routeSavedDistance || savedTime != _routeSavedTime) {
+        _routeSavedDistance = savedDistance;
+        _routeSavedTime = savedTime;
+        emit missionRouteSavingsChanged();
+    }
+}
+
+void MissionController::applySurveyRouteOptimization(void)
+{
+    if (_routeWatcher.isRunning() || _routeResults.isEmpty() || _routeResults.count() != _routeSurveys.count()) {
+        qCDebug(MissionControllerLog) << "applySurveyRouteOptimization no results available";
+        return;
+    }
+
+    // Make sure the plan still matches what was optimized before touching anything. Edits which have not reached
+    // the route timer yet show up here as well.
+    QList<QList<QPointer<SurveyMissionItem>>> runSurveys;
+    QList<SurveyRouteOptimizer::Run_t> runs = _surveyRouteRuns(runSurveys);
+    if (runSurveys != _routeSurveys || !SurveyRouteOptimizer::sameRuns(runs, _routeRuns)) {
+        qWarning() << "MissionController::applySurveyRouteOptimization plan changed since optimization";
+        return;
+    }
+
+    QList<QList<QPointer<SurveyMissionItem>>> routeSurveys = _routeSurveys;
+    QList<SurveyRouteOptimizer::Result_t>   routeResults = _routeResults;
+
+    for (int i=0; i<routeSurveys.count(); i++) {
+        const QList<QPointer<SurveyMissionItem>>& surveys = routeSurveys[i];
+        const SurveyRouteOptimizer::Result_t&   result = routeResults[i];
+        int                                     firstIndex = _visualItemIndex(surveys[0]);
+
+        for (int j=surveys.count() - 1; j>=0; j--) {
+            _visualItems->removeAt(firstIndex + j);
+        }
+        for (int j=0; j<result.order.count(); j++) {
+            SurveyMissionItem* surveyItem = surveys[result.order[j]];
+            _visualItems->insert(firstIndex + j, surveyItem);
+            surveyItem->gridEntryLocation()->setRawValue(result.variants[result.order[j]]);
+        }
+    }
+
+    _clearSurveyRoute();
+    _recalcAll();
+}
+
+/// Builds the flight path leading to an item the vehicle flies to. The path through a survey follows its whole grid.
+///     @param lastCoordinateItem Previous item flown to, NULL if there is none
+TerrainClearance::Path_t MissionController::_terrainPath(VisualMissionItem* lastCoordinateItem, VisualMissionItem* item)
+{
+    TerrainClearance::Path_t path;
+
+    if (lastCoordinateItem == _settingsItem) {
+        // The vehicle climbs above home before heading out, so the first leg is flown at the altitude of the item
+        QGeoCoordinate homeCoord = _settingsItem->coordinate();
+        homeCoord.setAltitude(item->coordinate().altitude());
+        path.coordinates.append(homeCoord);
+        path.relativeAltitude.append(item->coordinateHasRelativeAltitude());
+    } else if (lastCoordinateItem) {
+        path.coordinates.append(lastCoordinateItem->exitCoordinate());
+        path.relativeAltitude.append(lastCoordinateItem->exitCoordinateHasRelativeAltitude());
+    }
+
+    SurveyMissionItem* surveyItem = qobject_cast<SurveyMissionItem*>(item);
+    QVariantList gridPoints = surveyItem ? surveyItem->gridPoints() : QVariantList();
+    if (gridPoints.count()) {
+        double altitude = surveyItem->gridAltitude()->rawValue().toDouble();
+        for (int j=0; j<gridPoints.count(); j++) {
+            QGeoCoordinate gridCoord = gridPoints[j].value<QGeoCoordinate>();
+            gridCoord.setAltitude(altitude);
+            path.coordinates.append(gridCoord);
+            path.relativeAltitude.append(surveyItem->coordinateHasRelativeAltitude());
+        }
+    } else {
+        path.coordinates.append(item->coordinate());
+        path.relativeAltitude.append(item->coordinateHasRelativeAltitude());
+        if (!item->exitCoordinateSameAsEntry()) {
+            path.coordinates.append(item->exitCoordinate());
+            path.relativeAltitude.append(item->exitCoordinateHasRelativeAltitude());
+        }
+    }
+
+    return path;
+}
+
+/// Rebuilds the paths which may have changed and starts a background computation of the terrain clearance for the
+/// ones which did. Only the items from startIndex through lastChangedIndex are rebuilt, plus the first item flown to
+/// after them since its path starts at their exit. A full rebuild happens when startIndex is 0 or home has moved.
+void MissionController::_updateTerrainClearance(int startIndex, int lastChangedIndex)
+{
+    if (!_editMode || !_visualItems || !_settingsItem) {
+        return;
+    }
+
+    // Relative altitudes and the first leg of every path depend on home
+    QGeoCoordinate  home = _settingsItem->coordinate();
+    bool            homeChanged = false;
+    if (home.isValid() || _terrainHome.isValid()) {
+        homeChanged = !home.isValid() || !_terrainHome.isValid() ||
+                home.latitude() != _terrainHome.latitude() || home.longitude() != _terrainHome.longitude() ||
+                (home.altitude() != _terrainHome.altitude() && !(qIsNaN(home.altitude()) && qIsNaN(_terrainHome.altitude())));
+    }
+    if (homeChanged) {
+        _terrainHome = home;
+        _terrainCancel.store(1);
+        _terrainDirtyItems = _terrainPaths.keys().toSet();
+    }
+    if (startIndex <= 0 || homeChanged) {
+        startIndex = 1;
+        lastChangedIndex = _visualItems->count() - 1;
+    }
+
+    // The path of the first item rebuilt starts at the previous item flown to
+    VisualMissionItem* lastCoordinateItem = home.isValid() ? _settingsItem : NULL;
+    for (int i=startIndex-1; i>0; i--) {
+        VisualMissionItem* item = _visualItems->value<VisualMissionItem*>(i);
+        if (item->specifiesCoordinate() && !item->isStandaloneCoordinate()) {
+            lastCoordinateItem = item;
+            break;
+        }
+    }
+
+    for (int i=startIndex; i<_visualItems->count(); i++) {
+        VisualMissionItem* item = _visualItems->value<VisualMissionItem*>(i);
+        if (!item->specifiesCoordinate() || item->isStandaloneCoordinate()) {
+            _removeTerrainItem(item);
+            continue;
+        }
+
+        TerrainClearance::Path_t path = _terrainPath(lastCoordinateItem, item);
+        if (!_terrainPaths.contains(item) || !TerrainClearance::samePath(path, _terrainPaths[item])) {
+            _terrainPaths[item] = path;
+            _terrainDirtyItems.insert(item);
+        }
+        lastCoordinateItem = item;
+
+        if (i > lastChangedIndex) {
+            break;
+        }
+    }
+
+    _updateMinTerrainClearance();
+    _startTerrainClearance();
+}
+
+void MissionController::_terrainTilesLoaded(void)
+{
+    if (_terrainTilesPending) {
+        _terrainTilesPending = false;
+        _startTerrainClearance();
+    }
+}
+
+/// Starts computing the clearance of the paths which changed, unless a computation is already running. Paths which
+/// change while it runs are picked up once it finishes.
+void MissionController::_startTerrainClearance(void)
+{
+    if (_terrainWatcher.isRunning() || _terrainDirtyItems.isEmpty()) {
+        return;
+    }
+
+    QList<QPointer<VisualMissionItem>>  runItems;
+    QList<TerrainClearance::Path_t>     paths;
+    foreach (VisualMissionItem* item, _terrainDirtyItems) {
+        runItems.append(item);
+        paths.append(_terrainPaths[item]);
+    }
+
+    // Tiles are loaded on the main thread, the computation starts once all of them are available
+    if (!qgcApp()->toolbox()->terrainTileManager()->requestTiles(TerrainClearance::tileKeys(_terrainHome, paths))) {
+        _terrainTilesPending = true;
+        return;
+    }
+    _terrainTilesPending = false;
+
+    qCDebug(MissionControllerLog) << "_startTerrainClearance paths" << paths.count();
+
+    _terrainRunItems = runItems;
+    _terrainDirtyItems.clear();
+    _terrainCancel.store(0);
+    _terrainWatcher.setFuture(QtConcurrent::run(TerrainClearance::compute, _terrainHome, paths, qgcApp()->toolbox()->terrainTileManager()->tiles(), &_terrainCancel));
+}
+
+void MissionController::_terrainClearanceComputed(void)
+{
+    QList<TerrainClearance::Result_t>   results = _terrainWatcher.result();
+    QList<QPointer<VisualMissionItem>>  runItems = _terrainRunItems;
+
+    _terrainRunItems.clear();
+
+    for (int i=0; i<runItems.count(); i++) {
+        VisualMissionItem* item = runItems[i];
+
+        // Items which were removed or changed again while we were running have no use for the result
+        if (!item || !_terrainPaths.contains(item) || _terrainDirtyItems.contains(item)) {
+            continue;
+        }
+        if (i < results.count()) {
+            _setTerrainItemClearance(item, results[i].minClearance);
+        } else {
+            // Cancelled before reaching this path
+            _terrainDirtyItems.insert(item);
+        }
+    }
+
+    _updateMinTerrainClearance();
+    _startTerrainClearance();
+}
+
+/// Sets the computed clearance of an item and keeps the clearance counts in step
+void MissionController::_setTerrainItemClearance(VisualMissionItem* item, double clearance)
+{
+    QHash<VisualMissionItem*, double>::iterator it = _terrainClearances.find(item);
+    if (it != _terrainClearances.end()) {
+        if (!qIsNaN(it.value()) && --_terrainClearanceCounts[it.value()] == 0) {
+            _terrainClearanceCounts.remove(it.value());
+        }
+        _terrainClearances.erase(it);
+    }
+
+    if (!qIsNaN(clearance)) {
+        _terrainClearances[item] = clearance;
+        _terrainClearanceCounts[clearance]++;
+    }
+    item->setTerrainClearance(clearance);
+}
+
+/// Forgets the path and clearance of an item the vehicle no longer flies to
+void MissionController::_removeTerrainItem(VisualMissionItem* item)
+{
+    if (_terrainPaths.remove(item)) {
+        _terrainDirtyItems.remove(item);
+        _setTerrainItemClearance(item, std::numeric_limits<double>::quiet_NaN());
+    }
+}
+
+void MissionController::_clearTerrainClearance(void)
+{
+    _terrainCancel.store(1);
+    _terrainTilesPending = false;
+    _terrainHome = QGeoCoordinate();
+    _terrainPaths.clear();
+    _terrainClearances.clear();
+    _terrainClearanceCounts.clear();
+    _terrainDirtyItems.clear();
+    _terrainRunItems.clear();
+    _setMinTerrainClearance(std::numeric_limits<double>::quiet_NaN());
+}
+
+void MissionController::_updateMinTerrainClearance(void)
+{
+    _setMinTerrainClearance(_terrainClearanceCounts.isEmpty() ? std::numeric_limits<double>::quiet_NaN() : _terrainClearanceCounts.firstKey());
+}
+
+void MissionController::_setMinTerrainClearance(double minTerrainClearance)
+{
+    if (qIsNaN(minTerrainClearance) && qIsNaN(_minTerrainClearance)) {
+        return;
+    }
+    if (minTerrainClearance != _minTerrainClearance) {
+        _minTerrainClearance = minTerrainClearance;
+        emit missionMinTerrainClearanceChanged(_minTerrainClearance);
+    }
+}
@@ -16,8 +16,20 @@
 #include "Vehicle.h"
 #include "QGCLoggingCategory.h"
 #include "MavlinkQmlSingleton.h"
+#include "SurveyRouteOptimizer.h"
+#include "TerrainClearance.h"
+#include "JsonStreamReader.h"
+#include "QGCGeo.h"
 
+#include <QFutureWatcher>
 #include <QHash>
+#include <QMap>
+#include <QPointer>
+#include <QSet>
+#include <QTimer>
+#include <QVector>
+
+#include <functional>
 
 class CoordinateVector;
 class VisualMissionItem;
@@ -26,6 +38,8 @@ class MissionSettingsItem;
 class AppSettings;
 class MissionManager;
 class SimpleMissionItem;
+class SurveyMissionItem;
+class JsonStreamWriter;
 
 Q_DECLARE_LOGGING_CATEGORY(MissionControllerLog)
 
@@ -84,6 +98,11 @@ public:
     Q_PROPERTY(int                  batteryChangePoint      READ batteryChangePoint         NOTIFY batteryChangePointChanged)
     Q_PROPERTY(int                  batteriesRequired       READ batteriesRequired          NOTIFY batteriesRequiredChanged)
 
+    Q_PROPERTY(double               missionRouteSavedDistance   READ missionRouteSavedDistance  NOTIFY missionRouteSavingsChanged)  ///< Distance applySurveyRouteOptimization would save
+    Q_PROPERTY(double               missionRouteSavedTime       READ missionRouteSavedTime      NOTIFY missionRouteSavingsChanged)  ///< Flight time applySurveyRouteOptimization would save
+
+    Q_PROPERTY(double               missionMinTerrainClearance  READ missionMinTerrainClearance NOTIFY missionMinTerrainClearanceChanged)   ///< Lowest height above terrain along the whole mission, NaN if unknown
+
     Q_INVOKABLE void removeMissionItem(int index);
 
     /// Add a new simple mission item to the list
@@ -103,12 +122,22 @@ public:
     /// Updates the altitudes of the items in the current mission to the new default altitude
     Q_INVOKABLE void applyDefaultMissionAltitude(void);
 
+    /// Reorders consecutive survey items and picks their entry locations for the shortest route, as found by the
+    /// background route optimization. Does nothing if the optimization for the current plan is still running.
+    Q_INVOKABLE void applySurveyRouteOptimization(void);
+
     /// Sends the mission items to the specified vehicle
     static void sendItemsToVehicle(Vehicle* vehicle, QmlObjectListModel* visualMissionItems);
 
     bool loadJsonFile(QFile& file, QString& errorString);
     bool loadTextFile(QFile& file, QString& errorString);
 
+    /// Loads the mission object of a plan file one item at a time, without parsing the whole item array up front
+    bool load(const JsonStreamReader& reader, const JsonStreamReader::Span_t& missionSpan, QString& errorString);
+
+    /// Writes the members of the mission object one item at a time, without building the whole item array in memory
+    void save(JsonStreamWriter& writer);
+
     // Overrides from PlanElementController
     void start                      (bool editMode) final;
     void save                       (QJsonObject& json) final;
@@ -146,6 +175,11 @@ public:
     int  batteryChangePoint         (void) const { return _missionFlightStatus.batteryChangePoint; }    ///< -1 for not supported, 0 for not needed
     int  batteriesRequired          (void) const { return _missionFlightStatus.batteriesRequired; }     ///< -1 for not supported
 
+    double  missionRouteSavedDistance   (void) const { return _routeSavedDistance; }
+    double  missionRouteSavedTime       (void) const { return _routeSavedTime; }
+
+    double  missionMinTerrainClearance  (void) const { return _minTerrainClearance; }
+
 signals:
     void visualItemsChanged(void);
     void waypointLinesChanged(void);
@@ -165,6 +199,8 @@ signals:
     void plannedHomePositionChanged(QGeoCoordinate plannedHomePosition);
     void progressPctChanged(double progressPct);
     void currentMissionIndexChanged(int currentMissionIndex);
+    void missionRouteSavingsChanged(void);
+    void missionMinTerrainClearanceChanged(double missionMinTerrainClearance);
 
 private slots:
     void _newMissionItemsAvailableFromVehicle(bool removeAllRequested);
@@ -172,26 +208,108 @@ private slots:
     void _managerVehicleHomePositionChanged(const QGeoCoordinate& homePosition);
     void _inProgressChanged(bool inProgress);
     void _currentMissionIndexChanged(int sequenceNumber);
-    void _recalcWaypointLines(void);
     void _recalcMissionFlightStatus(void);
+    void _queueRecalcAll(void);
+    void _itemWaypointLinesChanged(void);
+    void _queueFlightStatusRecalc(void);
+    void _itemFlightStatusChanged(void);
+    void _itemLastSequenceNumberChanged(void);
     void _updateContainsItems(void);
     void _progressPctChanged(double progressPct);
     void _visualItemsDirtyChanged(bool dirty);
     void _managerSendComplete(bool error);
     void _managerRemoveAllComplete(bool error);
+    void _updateSurveyRoute(void);
+    void _surveyRouteOptimized(void);
+    void _terrainTilesLoaded(void);
+    void _terrainClearanceComputed(void);
 
 private:
+#ifdef UNITTEST_BUILD
+    friend class MissionControllerTest;
+#endif
+
+    /// Flight status walk state at the start of a visual item
+    typedef struct {
+        MissionFlightStatus_t   status;                 ///< Time/distance values are prefix sums over all prior items
+        VisualMissionItem*      lastCoordinateItem;
+        bool                    firstCoordinateItem;
+        bool                    vtolInHover;
+        bool                    linkStartToHome;
+    } FlightStatusWalk_t;
+
+    /// Flight status values recorded for each visual item, used to recalculate from a changed item onward
+    typedef struct {
+        FlightStatusWalk_t  walk;                       ///< Walk state before the item is processed
+        double              minAltitude;                ///< Absolute altitude range of the item, NaN for no coordinate
+        double              maxAltitude;
+        double              maxTelemetryDistance;
+        int                 batteryLegCount;            ///< Number of waypoint legs checked for a battery change
+        double              batteryLegHoverTime[2];     ///< Total hover time at the end of each leg
+        double              batteryLegCruiseTime[2];    ///< Total cruise time at the end of each leg
+        int                 rangeSlot;                  ///< Leaf in _flightStatusRanges holding the values above, -1 for none
+    } FlightStatusItem_t;
+
+    /// Altitude/telemetry range over a set of items, one node of the _flightStatusRanges tree
+    typedef struct {
+        double  minAltitude;
+        double  maxAltitude;
+        double  maxTelemetryDistance;
+    } FlightStatusRange_t;
+
+    /// Waypoint line shown in _waypointLines
+    typedef struct {
+        CoordinateVector*   line;                       ///< NULL for no line
+        VisualMissionItem*  from;
+        VisualMissionItem*  to;
+    } WaypointLine_t;
+
+    /// Waypoint line walk state recorded for each visual item, used to update the lines from a changed item onward
+    typedef struct {
+        VisualMissionItem*  item;                       ///< Item the entry was recorded for
+        VisualMissionItem*  lastCoordinateItem;         ///< Walk state before the item is processed
+        bool                firstCoordinateItem;
+        bool                linkStartToHome;
+        WaypointLine_t      line;                       ///< Line which ends at the item
+    } WaypointLineItem_t;
+
+    /// Ways of flying a survey, valid while the survey parameters other than entry location are unchanged
+    typedef struct {
+        SurveyGridGenerator::Params_t               params;
+        QVector<SurveyRouteOptimizer::Variant_t>    variants;
+    } RouteVariants_t;
+
     void _init(void);
-    void _recalcSequence(void);
-    void _recalcChildItems(void);
+    void _recalcSequence(int startIndex);
+    void _recalcChildItems(int startIndex, int lastChangedIndex);
     void _recalcAll(void);
+    void _recalcAllFrom(int startIndex);
+    void _updateWaypointLinesFrom(int startIndex, int lastChangedIndex);
+    void _setWaypointLine(WaypointLine_t& waypointLine, VisualMissionItem* from, VisualMissionItem* to);
+    void _removeWaypointLine(CoordinateVector* line);
+    void _clearWaypointLines(void);
+    void _recalcMissionFlightStatusFrom(int startIndex, int lastChangedIndex);
+    void _resetFlightStatusRanges(void);
+    int _allocFlightStatusRange(void);
+    void _setFlightStatusRange(int slot, double minAltitude, double maxAltitude, double maxTelemetryDistance);
+    void _freeFlightStatusRange(int slot);
+    int _batteryChangeIndex(void);
+    void _insertRecalcState(int index);
+    void _removeRecalcState(int index);
+    void _queueWaypointLinesRecalcFrom(int index);
+    void _queueFlightStatusRecalcFrom(int index);
+    void _clearPendingRecalc(void);
+    void _recalc(void) final;
+    bool _flightStatusWalkMatches(const FlightStatusWalk_t& walk, VisualMissionItem* lastCoordinateItem, bool firstCoordinateItem, bool vtolInHover, bool linkStartToHome);
+    void _updateAltPercents(int firstIndex, int lastIndex, double minAltSeen, double maxAltSeen);
+    int _visualItemIndex(VisualMissionItem* visualItem);
     void _initAllVisualItems(void);
     void _deinitAllVisualItems(void);
     void _initVisualItem(VisualMissionItem* item);
     void _deinitVisualItem(VisualMissionItem* item);
     void _setupActiveVehicle(Vehicle* activeVehicle, bool forceLoadFromVehicle);
     void _calcPrevWaypointValues(double homeAlt, VisualMissionItem* currentItem, VisualMissionItem* prevItem, double* azimuth, double* distance, double* altDifference);
-    static double _calcDistanceToHome(VisualMissionItem* currentItem, VisualMissionItem* homeItem);
+    static double _calcDistanceToHome(VisualMissionItem* currentItem, const GeoOrigin_t& homeOrigin);
     bool _findPreviousAltitude(int newIndex, double* prevAltitude, MAV_FRAME* prevFrame);
     static double _normalizeLat(double lat);
     static double _normalizeLon(double lon);
@@ -199,35 +317,90 @@ private:
     bool _loadJsonMissionFile(const QByteArray& bytes, QmlObjectListModel* visualItems, QString& errorString);
     bool _loadJsonMissionFileV1(const QJsonObject& json, QmlObjectListModel* visualItems, QString& errorString);
     bool _loadJsonMissionFileV2(const QJsonObject& json, QmlObjectListModel* visualItems, QString& errorString);
+    bool _loadJsonMissionStreamV2(const JsonStreamReader& reader, const QJsonObject& json, const QVector<JsonStreamReader::Span_t>& itemSpans, QmlObjectListModel* visualItems, QString& errorString);
+    bool _loadJsonMissionV2(const QJsonObject& json, int itemCount, const std::function<bool(int, QJsonValue&, QString&)>& readItem, QmlObjectListModel* visualItems, QString& errorString);
+    bool _readMissionObject(const JsonStreamReader& reader, const JsonStreamReader::Span_t& missionSpan, QJsonObject& json, QVector<JsonStreamReader::Span_t>& itemSpans, QString& errorString);
+    bool _saveHeader(QJsonObject& json);
+    void _saveEndMissionItem(QJsonArray& rgJsonMissionItems);
     bool _loadTextMissionFile(QTextStream& stream, QmlObjectListModel* visualItems, QString& errorString);
     int _nextSequenceNumber(void);
     static void _scanForAdditionalSettings(QmlObjectListModel* visualItems, Vehicle* vehicle);
     static bool _convertToMissionItems(QmlObjectListModel* visualMissionItems, QList<MissionItem*>& rgMissionItems, QObject* missionItemParent);
     void _setPlannedHomePositionFromFirstCoordinate(void);
     void _resetMissionFlightStatus(void);
-    void _addHoverTime(double hoverTime, double hoverDistance, int waypointIndex);
-    void _addCruiseTime(double cruiseTime, double cruiseDistance, int wayPointIndex);
-    void _updateBatteryInfo(int waypointIndex);
-    bool _loadItemsFromJson(const QJsonObject& json, QmlObjectListModel* visualItems, QString& errorString);
+    void _addHoverTime(double hoverTime, double hoverDistance);
+    void _addCruiseTime(double cruiseTime, double cruiseDistance);
+    void _updateBatteryInfo(void);
+    int _batteriesRequired(double hoverTime, double cruiseTime);
     void _initLoadedVisualItems(QmlObjectListModel* loadedVisualItems);
-    void _addWaypointLineSegment(CoordVectHashTable& prevItemPairHashTable, VisualItemPair& pair);
     void _addCommandTimeDelay(SimpleMissionItem* simpleItem, bool vtolInHover);
-    void _addTimeDistance(bool vtolInHover, double hoverTime, double cruiseTime, double extraTime, double distance, int seqNum);
+    void _addTimeDistance(bool vtolInHover, double hoverTime, double cruiseTime, double extraTime, double distance, FlightStatusItem_t* waypointLeg);
+    QList<SurveyRouteOptimizer::Run_t> _surveyRouteRuns(QList<QList<QPointer<SurveyMissionItem>>>& runSurveys);
+    void _optimizeSurveyRoute(void);
+    void _startSurveyRouteOptimization(void);
+    void _clearSurveyRoute(void);
+    void _setRouteSavings(double savedDistance, double savedTime);
+    TerrainClearance::Path_t _terrainPath(VisualMissionItem* lastCoordinateItem, VisualMissionItem* item);
+    void _updateTerrainClearance(int startIndex, int lastChangedIndex);
+    void _startTerrainClearance(void);
+    void _setTerrainItemClearance(VisualMissionItem* item, double clearance);
+    void _removeTerrainItem(VisualMissionItem* item);
+    void _clearTerrainClearance(void);
+    void _updateMinTerrainClearance(void);
+    void _setMinTerrainClearance(double minTerrainClearance);
 
 private:
     MissionManager*         _missionManager;
     QmlObjectListModel*     _visualItems;
     MissionSettingsItem*    _settingsItem;
     QmlObjectListModel      _waypointLines;
-    CoordVectHashTable      _linesTable;
+    QVector<WaypointLineItem_t> _waypointLineItems;     ///< One entry per visual item, plus one for the end of the mission
+    QHash<CoordinateVector*, int> _waypointLineRows;    ///< Row of each line within _waypointLines
+    WaypointLine_t          _homeWaypointLine;          ///< Line from the end of the mission back to home
+    bool                    _waypointLinesShowHome;     ///< Home position validity the lines were last updated for
     bool                    _firstItemsFromVehicle;
     bool                    _itemsRequested;
     MissionFlightStatus_t   _missionFlightStatus;
+    QVector<FlightStatusItem_t> _flightStatusItems;     ///< One entry per visual item, plus one for the end of the mission
+    QVector<FlightStatusRange_t> _flightStatusRanges;   ///< Tree of item ranges, node n combines nodes 2n and 2n+1, leaves start at _flightStatusRangeLeaves
+    QVector<int>            _freeFlightStatusRanges;    ///< Leaf slots not used by any item
+    int                     _flightStatusRangeLeaves;
+    double                  _minAltSeen;
+    double                  _maxAltSeen;
+    QHash<VisualMissionItem*, int> _visualItemIndexes;  ///< Last known index of each visual item
+    bool                    _recalcSequenceActive;
+    int                     _pendingWaypointLinesIndex;     ///< First item which needs a queued child item/waypoint line recalc, -1 for none
+    int                     _pendingWaypointLinesLastIndex; ///< Last item which changed since the waypoint line recalc was queued
+    int                     _pendingFlightStatusIndex;      ///< First item which needs a queued flight status recalc, -1 for none
+    int                     _pendingFlightStatusLastIndex;  ///< Last item which changed since the flight status recalc was queued
     QString                 _surveyMissionItemName;
     QString                 _fwLandingMissionItemName;
     AppSettings*            _appSettings;
     double                  _progressPct;
 
+    QFutureWatcher<QList<SurveyRouteOptimizer::Result_t>> _routeWatcher;   ///< Survey route optimization running on worker thread
+    QAtomicInt                          _routeCancel;           ///< Non-zero: running route optimization has been superseded
+    QTimer                              _routeTimer;            ///< Delays route optimization until editing pauses
+    int                                 _routeGeneration;       ///< Incremented each time _routeRuns changes
+    int                                 _routeRunningGeneration;///< _routeGeneration the running optimization was started for
+    QList<SurveyRouteOptimizer::Run_t>  _routeRuns;             ///< Input for the latest route optimization
+    QList<QList<QPointer<SurveyMissionItem>>> _routeSurveys;    ///< Survey items for each run in _routeRuns
+    QHash<SurveyMissionItem*, RouteVariants_t> _routeVariants;  ///< Variants last generated for each survey
+    QList<SurveyRouteOptimizer::Result_t> _routeResults;        ///< Results for _routeRuns, empty until optimization completes
+    double                              _routeSavedDistance;
+    double                              _routeSavedTime;
+
+    QFutureWatcher<QList<TerrainClearance::Result_t>> _terrainWatcher; ///< Terrain clearance computation running on worker thread
+    QAtomicInt                          _terrainCancel;         ///< Non-zero: running terrain clearance computation has been superseded
+    QGeoCoordinate                      _terrainHome;           ///< Home position _terrainPaths were built for
+    QHash<VisualMissionItem*, TerrainClearance::Path_t> _terrainPaths;  ///< Path leading to each item the vehicle flies to
+    QHash<VisualMissionItem*, double>   _terrainClearances;     ///< Computed clearance of the items in _terrainPaths, NaN results are left out
+    QMap<double, int>                   _terrainClearanceCounts;///< Number of items with each clearance, the first key is the mission minimum
+    QSet<VisualMissionItem*>            _terrainDirtyItems;     ///< Items whose path changed since the computation for them started
+    QList<QPointer<VisualMissionItem>>  _terrainRunItems;       ///< Items the running computation is for
+    bool                                _terrainTilesPending;   ///< true: waiting for the tiles needed for _terrainDirtyItems
+    double                              _minTerrainClearance;
+
     static const char*  _settingsGroup;
 
     // Json file keys for persistence
@@ -16,6 +16,10 @@
 #include "QGCApplication.h"
 #include "SettingsManager.h"
 #include "AppSettings.h"
+#include "SurveyMissionItem.h"
+#include "SurveyRouteOptimizer.h"
+
+#include <QElapsedTimer>
 
 MissionControllerTest::MissionControllerTest(void)
     : _multiSpyMissionController(NULL)
@@ -221,10 +225,258 @@ void MissionControllerTest::_testGimbalRecalc(void)
     settingsItem->cameraSection()->gimbalYaw()->setRawValue(0.0);
     for (int i=1; i<_missionController->visualItems()->count(); i++) {
         VisualMissionItem* visualItem = _missionController->visualItems()->value<VisualMissionItem*>(i);
-        QCOMPARE(visualItem->missionGimbalYaw(), 0.0);
+        QTRY_COMPARE(visualItem->missionGimbalYaw(), 0.0);
+    }
+}
+
+/// @return End points of each waypoint line, sorted so line order within the model does not matter
+static QStringList _waypointLineEndPoints(QmlObjectListModel* waypointLines)
+{
+    QStringList endPoints;
+
+    for (int i=0; i<waypointLines->count(); i++) {
+        QObject* line = waypointLines->get(i);
+        endPoints.append(line->property("coordinate1").value<QGeoCoordinate>().toString() + " " + line->property("coordinate2").value<QGeoCoordinate>().toString());
+    }
+    endPoints.sort();
+
+    return endPoints;
+}
+
+/// Edits a large mission and checks the incremental recalculation against a full recalculation
+void MissionControllerTest::_testLargeMissionEdit(void)
+{
+    _initForFirmwareType(MAV_AUTOPILOT_PX4);
+
+    const int       cWaypoints = 2000;
+    const int       cEdits = 100;
+    QGeoCoordinate  coordinate(37.803784, -122.462276);
+    QElapsedTimer   timer;
+
+    timer.start();
+    for (int i=0; i<cWaypoints; i++) {
+        _missionController->insertSimpleMissionItem(coordinate.atDistanceAndAzimuth(i * 20, (i % 2) * 90), _missionController->visualItems()->count());
+    }
+    qDebug() << "Adding" << cWaypoints << "waypoints took" << timer.elapsed() << "msecs";
+
+    QmlObjectListModel* visualItems = _missionController->visualItems();
+    QCOMPARE(visualItems->count(), cWaypoints + 1);
+
+    // Drag a waypoint in the middle of the mission around
+    VisualMissionItem* dragItem = visualItems->value<VisualMissionItem*>(cWaypoints / 2);
+    timer.restart();
+    for (int i=0; i<cEdits; i++) {
+        dragItem->setCoordinate(dragItem->coordinate().atDistanceAndAzimuth(5, i * 10));
+        _missionController->_flushRecalc();
+    }
+    qint64 moveMsecs = timer.elapsed();
+    qDebug() << "Moving a waypoint" << cEdits << "times took" << moveMsecs << "msecs";
+
+    // Insert and remove waypoints in the middle of the mission
+    timer.restart();
+    for (int i=0; i<cEdits; i++) {
+        _missionController->insertSimpleMissionItem(coordinate.atDistanceAndAzimuth(i, 180), cWaypoints / 3);
+    }
+    for (int i=0; i<cEdits / 2; i++) {
+        _missionController->removeMissionItem(cWaypoints / 4);
+    }
+    qint64 insertRemoveMsecs = timer.elapsed();
+    qDebug() << "Inserting" << cEdits << "and removing" << cEdits / 2 << "waypoints took" << insertRemoveMsecs << "msecs";
+
+    // Commands which change the lines part way through and at the end of the mission
+    visualItems->value<SimpleMissionItem*>(cWaypoints / 2)->setCommand(MavlinkQmlSingleton::MAV_CMD_DO_CHANGE_SPEED);
+    visualItems->value<SimpleMissionItem*>(visualItems->count() - 1)->setCommand(MavlinkQmlSingleton::MAV_CMD_NAV_RETURN_TO_LAUNCH);
+    _missionController->_flushRecalc();
+
+    // Sequence numbers must still be sequential
+    for (int i=1; i<visualItems->count(); i++) {
+        QCOMPARE(visualItems->value<VisualMissionItem*>(i)->sequenceNumber(), visualItems->value<VisualMissionItem*>(i - 1)->lastSequenceNumber() + 1);
+    }
+
+    double          missionDistance =   _missionController->missionDistance();
+    double          missionTime =       _missionController->missionTime();
+    double          missionMaxTelemetry = _missionController->missionMaxTelemetry();
+    double          minAltSeen =        _missionController->_minAltSeen;
+    double          maxAltSeen =        _missionController->_maxAltSeen;
+    QStringList     waypointLines =     _waypointLineEndPoints(_missionController->waypointLines());
+    QList<double>   itemDistances;
+    QList<double>   itemAltPercents;
+    for (int i=0; i<visualItems->count(); i++) {
+        itemDistances.append(visualItems->value<VisualMissionItem*>(i)->distance());
+        itemAltPercents.append(visualItems->value<VisualMissionItem*>(i)->altPercent());
+    }
+
+    // Incremental values must match a full recalculation
+    timer.restart();
+    _missionController->_recalcMissionFlightStatus();
+    qDebug() << "Full flight status recalculation took" << timer.elapsed() << "msecs";
+
+    QVERIFY(qAbs(_missionController->missionDistance() - missionDistance) < 0.01);
+    QVERIFY(qAbs(_missionController->missionTime() - missionTime) < 0.01);
+    QCOMPARE(_missionController->missionMaxTelemetry(), missionMaxTelemetry);
+    QCOMPARE(_missionController->_minAltSeen, minAltSeen);
+    QCOMPARE(_missionController->_maxAltSeen, maxAltSeen);
+    for (int i=0; i<visualItems->count(); i++) {
+        QCOMPARE(visualItems->value<VisualMissionItem*>(i)->distance(), itemDistances[i]);
+        QCOMPARE(visualItems->value<VisualMissionItem*>(i)->altPercent(), itemAltPercents[i]);
+    }
+
+    // Incrementally updated lines must match lines built from scratch
+    _missionController->_clearWaypointLines();
+    _missionController->_updateWaypointLinesFrom(0, visualItems->count());
+    QCOMPARE(_missionController->waypointLines()->count(), waypointLines.count());
+    QCOMPARE(_waypointLineEndPoints(_missionController->waypointLines()), waypointLines);
+}
+
+/// Changes to many items at once must only cause a single recalculation
+void MissionControllerTest::_testCoalescedRecalc(void)
+{
+    _initForFirmwareType(MAV_AUTOPILOT_PX4);
+
+    QGeoCoordinate coordinate(37.803784, -122.462276);
+    for (int i=0; i<50; i++) {
+        _missionController->insertSimpleMissionItem(coordinate.atDistanceAndAzimuth(i * 20, 0), _missionController->visualItems()->count());
+    }
+    QTest::qWait(100);
+
+    QmlObjectListModel* visualItems = _missionController->visualItems();
+    int recalcCount = _missionController->recalcCount();
+
+    // New altitude for every item
+    Fact* altitudeFact = qgcApp()->toolbox()->settingsManager()->appSettings()->defaultMissionItemAltitude();
+    QVariant oldAltitude = altitudeFact->rawValue();
+    double newAltitude = oldAltitude.toDouble() + 10.0;
+    altitudeFact->setRawValue(newAltitude);
+    _missionController->applyDefaultMissionAltitude();
+    altitudeFact->setRawValue(oldAltitude);
+    QCOMPARE(_missionController->recalcCount(), recalcCount);
+    QTRY_COMPARE(_missionController->recalcCount(), recalcCount + 1);
+    QTest::qWait(100);
+    QCOMPARE(_missionController->recalcCount(), recalcCount + 1);
+    for (int i=1; i<visualItems->count(); i++) {
+        QCOMPARE(visualItems->value<VisualMissionItem*>(i)->coordinate().altitude(), newAltitude);
+    }
+
+    // Moving many items
+    recalcCount = _missionController->recalcCount();
+    for (int i=1; i<visualItems->count(); i++) {
+        VisualMissionItem* item = visualItems->value<VisualMissionItem*>(i);
+        item->setCoordinate(item->coordinate().atDistanceAndAzimuth(10, 90));
+    }
+    QTRY_COMPARE(_missionController->recalcCount(), recalcCount + 1);
+    QTest::qWait(100);
+    QCOMPARE(_missionController->recalcCount(), recalcCount + 1);
+}
+
+/// Surveys lined up west to east, currently flown out of order and backwards
+void MissionControllerTest::_testSurveyRouteOptimizer(void)
+{
+    const int       cSurveys = 5;
+    const int       surveyOrder[cSurveys] = { 0, 3, 1, 4, 2 };
+    QGeoCoordinate  start(37.803784, -122.462276);
+
+    QVector<QVector<SurveyRouteOptimizer::Variant_t>>   variants;
+    QVector<int>                                        currentVariants;
+    for (int i=0; i<cSurveys; i++) {
+        // Variant 0 flies west to east, variant 1 east to west
+        QGeoCoordinate west = start.atDistanceAndAzimuth(((surveyOrder[i] + 1) * 1000) - 100, 90);
+        QGeoCoordinate east = start.atDistanceAndAzimuth(((surveyOrder[i] + 1) * 1000) + 100, 90);
+        SurveyRouteOptimizer::Variant_t westToEast = { west, east, 200 };
+        SurveyRouteOptimizer::Variant_t eastToWest = { east, west, 200 };
+
+        variants.append(QVector<SurveyRouteOptimizer::Variant_t>() << westToEast << eastToWest);
+        currentVariants.append(1);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    SurveyRouteOptimizer::Result_t result = SurveyRouteOptimizer::optimizeRoute(start, QGeoCoordinate(), variants, currentVariants, NULL);
+    qDebug() << "Optimizing route through" << cSurveys << "surveys took" << timer.elapsed() << "msecs";
+
+    QCOMPARE(result.order.count(), cSurveys);
+    for (int i=0; i<cSurveys; i++) {
+        QCOMPARE(surveyOrder[result.order[i]], i);
+        QCOMPARE(result.variants[i], 0);
+    }
+
+    // 900m to the first survey, 200m within each survey and 800m between them
+    QVERIFY(qAbs(result.optimizedDistance - 5100.0) < 5.0);
+    QVERIFY(result.currentDistance > result.optimizedDistance);
+
+    // An already optimal route is left alone
+    QVector<QVector<SurveyRouteOptimizer::Variant_t>>   optimalVariants;
+    QVector<int>                                        optimalCurrentVariants;
+    for (int i=0; i<cSurveys; i++) {
+        optimalVariants.append(variants[result.order[i]]);
+        optimalCurrentVariants.append(result.variants[result.order[i]]);
+    }
+    result = SurveyRouteOptimizer::optimizeRoute(start, QGeoCoordinate(), optimalVariants, optimalCurrentVariants, NULL);
+    QCOMPARE(result.currentDistance, result.optimizedDistance);
+    for (int i=0; i<cSurveys; i++) {
+        QCOMPARE(result.order[i], i);
     }
 }
 
+/// Survey items placed out of order are reordered when the optimization is applied
+void MissionControllerTest::_testSurveyRouteOptimization(void)
+{
+    _initForFirmwareType(MAV_AUTOPILOT_PX4);
+
+    const int       cSurveys = 3;
+    const double    surveyOffsets[cSurveys] = { 0, 2000, 1000 };
+    QGeoCoordinate  origin(37.803784, -122.462276);
+
+    QmlObjectListModel* visualItems = _missionController->visualItems();
+    for (int i=0; i<cSurveys; i++) {
+        QGeoCoordinate topLeft = origin.atDistanceAndAzimuth(surveyOffsets[i], 90);
+        _missionController->insertComplexMissionItem(_missionController->_surveyMissionItemName, topLeft, visualItems->count());
+
+        SurveyMissionItem* surveyItem = visualItems->value<SurveyMissionItem*>(visualItems->count() - 1);
+        QVERIFY(surveyItem);
+        QList<QGeoCoordinate> square;
+        square << topLeft
+               << topLeft.atDistanceAndAzimuth(200, 90)
+               << topLeft.atDistanceAndAzimuth(200, 90).atDistanceAndAzimuth(200, 180)
+               << topLeft.atDistanceAndAzimuth(200, 180);
+        surveyItem->mapPolygon()->setPath(square);
+    }
+
+    QTRY_VERIFY_WITH_TIMEOUT(_missionController->missionRouteSavedDistance() > 1000, 10000);
+    double hoverSpeed = _missionController->_missionFlightStatus.hoverSpeed;
+    QVERIFY(qAbs(_missionController->missionRouteSavedTime() - (_missionController->missionRouteSavedDistance() / hoverSpeed)) < 0.1);
+    double missionDistance = _missionController->missionDistance();
+    double savedDistance = _missionController->missionRouteSavedDistance();
+    QCOMPARE(_missionController->_routeVariants.count(), cSurveys);
+
+    // Results are not applied once the plan has changed, and only the changed survey is regenerated
+    SurveyMissionItem* changedItem = visualItems->value<SurveyMissionItem*>(2);
+    changedItem->gridSpacing()->setRawValue(changedItem->gridSpacing()->rawValue().toDouble() + 1);
+    _missionController->_flushRecalc();
+    _missionController->applySurveyRouteOptimization();
+    QCOMPARE(visualItems->value<SurveyMissionItem*>(2), changedItem);
+    _missionController->_routeTimer.stop();
+    _missionController->_updateSurveyRoute();
+    QCOMPARE(_missionController->_routeRuns.count(), 1);
+    const SurveyRouteOptimizer::Run_t& run = _missionController->_routeRuns[0];
+    QCOMPARE(run.variants.count(), cSurveys);
+    for (int i=0; i<cSurveys; i++) {
+        QCOMPARE(run.variants[i].isEmpty(), i == 1);
+    }
+    QTRY_VERIFY_WITH_TIMEOUT(_missionController->missionRouteSavedDistance() > savedDistance / 2, 10000);
+    missionDistance = _missionController->missionDistance();
+
+    _missionController->applySurveyRouteOptimization();
+
+    // Surveys are now flown west to east
+    for (int i=2; i<visualItems->count(); i++) {
+        QVERIFY(visualItems->value<SurveyMissionItem*>(i - 1)->mapPolygon()->center().longitude() < visualItems->value<SurveyMissionItem*>(i)->mapPolygon()->center().longitude());
+        QCOMPARE(visualItems->value<VisualMissionItem*>(i)->sequenceNumber(), visualItems->value<VisualMissionItem*>(i - 1)->lastSequenceNumber() + 1);
+    }
+
+    QTRY_VERIFY_WITH_TIMEOUT(_missionController->missionDistance() < missionDistance - 1000, 10000);
+    QTRY_VERIFY_WITH_TIMEOUT(_missionController->missionRouteSavedDistance() < 1.0, 10000);
+}
+
 void MissionControllerTest::_testLoadJsonSectionAvailable(void)
 {
     _initForFirmwareType(MAV_AUTOPILOT_PX4);
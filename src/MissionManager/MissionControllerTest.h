@@ -38,6 +38,10 @@ private slots:
     void _testEmptyVehiclePX4(void);
     void _testAddWayppointAPM(void);
     void _testAddWayppointPX4(void);
+    void _testLargeMissionEdit(void);
+    void _testCoalescedRecalc(void);
+    void _testSurveyRouteOptimizer(void);
+    void _testSurveyRouteOptimization(void);
 
 private:
 #if 0
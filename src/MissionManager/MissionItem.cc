@@ -35,25 +35,17 @@ MissionItem::MissionItem(QObject* parent)
     , _sequenceNumber(0)
     , _doJumpId(-1)
     , _isCurrentItem(false)
-    , _autoContinueFact             (0, "AutoContinue",                 FactMetaData::valueTypeUint32)
-    , _commandFact                  (0, "",                             FactMetaData::valueTypeUint32)
-    , _frameFact                    (0, "",                             FactMetaData::valueTypeUint32)
-    , _param1Fact                   (0, "Param1:",                      FactMetaData::valueTypeDouble)
-    , _param2Fact                   (0, "Param2:",                      FactMetaData::valueTypeDouble)
-    , _param3Fact                   (0, "Param3:",                      FactMetaData::valueTypeDouble)
-    , _param4Fact                   (0, "Param4:",                      FactMetaData::valueTypeDouble)
-    , _param5Fact                   (0, "Latitude:",                    FactMetaData::valueTypeDouble)
-    , _param6Fact                   (0, "Longitude:",                   FactMetaData::valueTypeDouble)
-    , _param7Fact                   (0, "Altitude:",                    FactMetaData::valueTypeDouble)
+    , _command(MAV_CMD_NAV_WAYPOINT)
+    , _frame(MAV_FRAME_GLOBAL_RELATIVE_ALT)
+    , _autoContinue(true)
+    , _autoContinueFact(NULL)
+    , _commandFact(NULL)
+    , _frameFact(NULL)
 {
-    // Need a good command and frame before we start passing signals around
-    _commandFact.setRawValue(MAV_CMD_NAV_WAYPOINT);
-    _frameFact.setRawValue(MAV_FRAME_GLOBAL_RELATIVE_ALT);
-
-    setAutoContinue(true);
-
-    connect(&_param2Fact, &Fact::rawValueChanged, this, &MissionItem::_param2Changed);
-    connect(&_param3Fact, &Fact::rawValueChanged, this, &MissionItem::_param3Changed);
+    for (int i=0; i<7; i++) {
+        _params[i] = 0;
+        _paramFacts[i] = NULL;
+    }
 }
 
 MissionItem::MissionItem(int             sequenceNumber,
@@ -73,34 +65,24 @@ MissionItem::MissionItem(int             sequenceNumber,
     , _sequenceNumber(sequenceNumber)
     , _doJumpId(-1)
     , _isCurrentItem(isCurrentItem)
-    , _commandFact                  (0, "",                             FactMetaData::valueTypeUint32)
-    , _frameFact                    (0, "",                             FactMetaData::valueTypeUint32)
-    , _param1Fact                   (0, "Param1:",                      FactMetaData::valueTypeDouble)
-    , _param2Fact                   (0, "Param2:",                      FactMetaData::valueTypeDouble)
-    , _param3Fact                   (0, "Param3:",                      FactMetaData::valueTypeDouble)
-    , _param4Fact                   (0, "Param4:",                      FactMetaData::valueTypeDouble)
-    , _param5Fact                   (0, "Lat/X:",                       FactMetaData::valueTypeDouble)
-    , _param6Fact                   (0, "Lon/Y:",                       FactMetaData::valueTypeDouble)
-    , _param7Fact                   (0, "Alt/Z:",                       FactMetaData::valueTypeDouble)
+    , _command(command)
+    , _frame(frame)
+    , _autoContinue(autoContinue)
+    , _autoContinueFact(NULL)
+    , _commandFact(NULL)
+    , _frameFact(NULL)
 {
-    // Need a good command and frame before we start passing signals around
-    _commandFact.setRawValue(MAV_CMD_NAV_WAYPOINT);
-    _frameFact.setRawValue(MAV_FRAME_GLOBAL_RELATIVE_ALT);
-
-    setCommand(command);
-    setFrame(frame);
-    setAutoContinue(autoContinue);
-
-    _param1Fact.setRawValue(param1);
-    _param2Fact.setRawValue(param2);
-    _param3Fact.setRawValue(param3);
-    _param4Fact.setRawValue(param4);
-    _param5Fact.setRawValue(param5);
-    _param6Fact.setRawValue(param6);
-    _param7Fact.setRawValue(param7);
-
-    connect(&_param2Fact, &Fact::rawValueChanged, this, &MissionItem::_param2Changed);
-    connect(&_param3Fact, &Fact::rawValueChanged, this, &MissionItem::_param3Changed);
+    _params[0] = param1;
+    _params[1] = param2;
+    _params[2] = param3;
+    _params[3] = param4;
+    _params[4] = param5;
+    _params[5] = param6;
+    _params[6] = param7;
+
+    for (int i=0; i<7; i++) {
+        _paramFacts[i] = NULL;
+    }
 }
 
 MissionItem::MissionItem(const MissionItem& other, QObject* parent)
@@ -108,24 +90,19 @@ MissionItem::MissionItem(const MissionItem& other, QObject* parent)
     , _sequenceNumber(0)
     , _doJumpId(-1)
     , _isCurrentItem(false)
-    , _commandFact                  (0, "",                             FactMetaData::valueTypeUint32)
-    , _frameFact                    (0, "",                             FactMetaData::valueTypeUint32)
-    , _param1Fact                   (0, "Param1:",                      FactMetaData::valueTypeDouble)
-    , _param2Fact                   (0, "Param2:",                      FactMetaData::valueTypeDouble)
-    , _param3Fact                   (0, "Param3:",                      FactMetaData::valueTypeDouble)
-    , _param4Fact                   (0, "Param4:",                      FactMetaData::valueTypeDouble)
-    , _param5Fact                   (0, "Lat/X:",                       FactMetaData::valueTypeDouble)
-    , _param6Fact                   (0, "Lon/Y:",                       FactMetaData::valueTypeDouble)
-    , _param7Fact                   (0, "Alt/Z:",                       FactMetaData::valueTypeDouble)
+    , _command(MAV_CMD_NAV_WAYPOINT)
+    , _frame(MAV_FRAME_GLOBAL_RELATIVE_ALT)
+    , _autoContinue(true)
+    , _autoContinueFact(NULL)
+    , _commandFact(NULL)
+    , _frameFact(NULL)
 {
-    // Need a good command and frame before we start passing signals around
-    _commandFact.setRawValue(MAV_CMD_NAV_WAYPOINT);
-    _frameFact.setRawValue(MAV_FRAME_GLOBAL_RELATIVE_ALT);
+    for (int i=0; i<7; i++) {
+        _params[i] = 0;
+        _paramFacts[i] = NULL;
+    }
 
     *this = other;
-
-    connect(&_param2Fact, &Fact::rawValueChanged, this, &MissionItem::_param2Changed);
-    connect(&_param3Fact, &Fact::rawValueChanged, this, &MissionItem::_param3Changed);
 }
 
 const MissionItem& MissionItem::operator=(const MissionItem& other)
@@ -138,13 +115,9 @@ const MissionItem& MissionItem::operator=(const MissionItem& other)
     setAutoContinue(other.autoContinue());
     setIsCurrentItem(other._isCurrentItem);
 
-    _param1Fact.setRawValue(other._param1Fact.rawValue());
-    _param2Fact.setRawValue(other._param2Fact.rawValue());
-    _param3Fact.setRawValue(other._param3Fact.rawValue());
-    _param4Fact.setRawValue(other._param4Fact.rawValue());
-    _param5Fact.setRawValue(other._param5Fact.rawValue());
-    _param6Fact.setRawValue(other._param6Fact.rawValue());
-    _param7Fact.setRawValue(other._param7Fact.rawValue());
+    for (int i=1; i<=7; i++) {
+        _setParam(i, other._params[i-1]);
+    }
 
     return *this;
 }
@@ -332,22 +305,34 @@ void MissionItem::setSequenceNumber(int sequenceNumber)
 
 void MissionItem::setCommand(MAV_CMD command)
 {
-    if ((MAV_CMD)this->command() != command) {
-        _commandFact.setRawValue(command);
+    if (_command != command) {
+        _command = command;
+        if (_commandFact) {
+            _commandFact->setRawValue(command);
+        }
+        emit commandChanged(command);
     }
 }
 
 void MissionItem::setFrame(MAV_FRAME frame)
 {
-    if (this->frame() != frame) {
-        _frameFact.setRawValue(frame);
+    if (_frame != frame) {
+        _frame = frame;
+        if (_frameFact) {
+            _frameFact->setRawValue(frame);
+        }
+        emit frameChanged(frame);
     }
 }
 
 void MissionItem::setAutoContinue(bool autoContinue)
 {
-    if (this->autoContinue() != autoContinue) {
-        _autoContinueFact.setRawValue(autoContinue);
+    if (_autoContinue != autoContinue) {
+        _autoContinue = autoContinue;
+        if (_autoContinueFact) {
+            _autoContinueFact->setRawValue(autoContinue);
+        }
+        emit autoContinueChanged(autoContinue);
     }
 }
 
@@ -361,53 +346,115 @@ void MissionItem::setIsCurrentItem(bool isCurrentItem)
 
 void MissionItem::setParam1(double param)
 {
-    if (param1() != param) {
-        _param1Fact.setRawValue(param);
-    }
+    _setParam(1, param);
 }
 
 void MissionItem::setParam2(double param)
 {
-    if (param2() != param) {
-        _param2Fact.setRawValue(param);
-    }
+    _setParam(2, param);
 }
 
 void MissionItem::setParam3(double param)
 {
-    if (param3() != param) {
-        _param3Fact.setRawValue(param);
-    }
+    _setParam(3, param);
 }
 
 void MissionItem::setParam4(double param)
 {
-    if (param4() != param) {
-        _param4Fact.setRawValue(param);
-    }
+    _setParam(4, param);
 }
 
 void MissionItem::setParam5(double param)
 {
-    if (param5() != param) {
-        _param5Fact.setRawValue(param);
-    }
+    _setParam(5, param);
 }
 
 void MissionItem::setParam6(double param)
 {
-    if (param6() != param) {
-        _param6Fact.setRawValue(param);
-    }
+    _setParam(6, param);
 }
 
 void MissionItem::setParam7(double param)
 {
-    if (param7() != param) {
-        _param7Fact.setRawValue(param);
+    _setParam(7, param);
+}
+
+/// Sets the specified param (1-7), NaN is considered equal to NaN so setting it again does not signal
+void MissionItem::_setParam(int param, double value)
+{
+    double& currentValue = _params[param-1];
+
+    if (currentValue == value || (qIsNaN(currentValue) && qIsNaN(value))) {
+        return;
+    }
+
+    currentValue = value;
+    if (_paramFacts[param-1]) {
+        _paramFacts[param-1]->setRawValue(value);
+    }
+    emit paramChanged(param, value);
+
+    if (param == 2) {
+        double flightSpeed = specifiedFlightSpeed();
+        if (!qIsNaN(flightSpeed)) {
+            emit specifiedFlightSpeedChanged(flightSpeed);
+        }
+    } else if (param == 3) {
+        double gimbalYaw = specifiedGimbalYaw();
+        if (!qIsNaN(gimbalYaw)) {
+            emit specifiedGimbalYawChanged(gimbalYaw);
+        }
     }
 }
 
+Fact* MissionItem::_createFact(const QString& name, FactMetaData::ValueType_t type, const QVariant& rawValue)
+{
+    Fact* fact = new Fact(0, name, type, this);
+
+    fact->setRawValue(rawValue);
+
+    return fact;
+}
+
+Fact* MissionItem::autoContinueFact(void)
+{
+    if (!_autoContinueFact) {
+        _autoContinueFact = _createFact(QStringLiteral("AutoContinue"), FactMetaData::valueTypeUint32, _autoContinue);
+        connect(_autoContinueFact, &Fact::rawValueChanged, this, [this](QVariant value) { setAutoContinue(value.toBool()); });
+    }
+    return _autoContinueFact;
+}
+
+Fact* MissionItem::commandFact(void)
+{
+    if (!_commandFact) {
+        _commandFact = _createFact(QString(), FactMetaData::valueTypeUint32, _command);
+        connect(_commandFact, &Fact::rawValueChanged, this, [this](QVariant value) { setCommand((MAV_CMD)value.toInt()); });
+    }
+    return _commandFact;
+}
+
+Fact* MissionItem::frameFact(void)
+{
+    if (!_frameFact) {
+        _frameFact = _createFact(QString(), FactMetaData::valueTypeUint32, _frame);
+        connect(_frameFact, &Fact::rawValueChanged, this, [this](QVariant value) { setFrame((MAV_FRAME)value.toInt()); });
+    }
+    return _frameFact;
+}
+
+Fact* MissionItem::_paramFact(int param)
+{
+    static const char* rgParamNames[7] = { "Param1:", "Param2:", "Param3:", "Param4:", "Lat/X:", "Lon/Y:", "Alt/Z:" };
+
+    if (!_paramFacts[param-1]) {
+        Fact* fact = _createFact(rgParamNames[param-1], FactMetaData::valueTypeDouble, _params[param-1]);
+        connect(fact, &Fact::rawValueChanged, this, [this, param](QVariant value) { _setParam(param, value.toDouble()); });
+        _paramFacts[param-1] = fact;
+    }
+    return _paramFacts[param-1];
+}
+
 void MissionItem::setCoordinate(const QGeoCoordinate& coordinate)
 {
     setParam5(coordinate.latitude());
@@ -424,8 +471,8 @@ double MissionItem::specifiedFlightSpeed(void) const
 {
     double flightSpeed = std::numeric_limits<double>::quiet_NaN();
 
-    if (_commandFact.rawValue().toInt() == MAV_CMD_DO_CHANGE_SPEED && _param2Fact.rawValue().toDouble() > 0) {
-        flightSpeed = _param2Fact.rawValue().toDouble();
+    if (_command == MAV_CMD_DO_CHANGE_SPEED && param2() > 0) {
+        flightSpeed = param2();
     }
 
     return flightSpeed;
@@ -435,29 +482,9 @@ double MissionItem::specifiedGimbalYaw(void) const
 {
     double gimbalYaw = std::numeric_limits<double>::quiet_NaN();
 
-    if (_commandFact.rawValue().toInt() == MAV_CMD_DO_MOUNT_CONTROL && _param7Fact.rawValue().toInt() == MAV_MOUNT_MODE_MAVLINK_TARGETING) {
-        gimbalYaw = _param3Fact.rawValue().toDouble();
+    if (_command == MAV_CMD_DO_MOUNT_CONTROL && (int)param7() == MAV_MOUNT_MODE_MAVLINK_TARGETING) {
+        gimbalYaw = param3();
     }
 
     return gimbalYaw;
 }
-
-void MissionItem::_param2Changed(QVariant value)
-{
-    Q_UNUSED(value);
-
-    double flightSpeed = specifiedFlightSpeed();
-    if (!qIsNaN(flightSpeed)) {
-        emit specifiedFlightSpeedChanged(flightSpeed);
-    }
-}
-
-void MissionItem::_param3Changed(QVariant value)
-{
-    Q_UNUSED(value);
-
-    double gimbalYaw = specifiedGimbalYaw();
-    if (!qIsNaN(gimbalYaw)) {
-        emit specifiedGimbalYawChanged(gimbalYaw);
-    }
-}
@@ -61,18 +61,18 @@ public:
 
     const MissionItem& operator=(const MissionItem& other);
     
-    MAV_CMD         command         (void) const { return (MAV_CMD)_commandFact.rawValue().toInt(); }
+    MAV_CMD         command         (void) const { return _command; }
     bool            isCurrentItem   (void) const { return _isCurrentItem; }
     int             sequenceNumber  (void) const { return _sequenceNumber; }
-    MAV_FRAME       frame           (void) const { return (MAV_FRAME)_frameFact.rawValue().toInt(); }
-    bool            autoContinue    (void) const { return _autoContinueFact.rawValue().toBool(); }
-    double          param1          (void) const { return _param1Fact.rawValue().toDouble(); }
-    double          param2          (void) const { return _param2Fact.rawValue().toDouble(); }
-    double          param3          (void) const { return _param3Fact.rawValue().toDouble(); }
-    double          param4          (void) const { return _param4Fact.rawValue().toDouble(); }
-    double          param5          (void) const { return _param5Fact.rawValue().toDouble(); }
-    double          param6          (void) const { return _param6Fact.rawValue().toDouble(); }
-    double          param7          (void) const { return _param7Fact.rawValue().toDouble(); }
+    MAV_FRAME       frame           (void) const { return _frame; }
+    bool            autoContinue    (void) const { return _autoContinue; }
+    double          param1          (void) const { return _params[0]; }
+    double          param2          (void) const { return _params[1]; }
+    double          param3          (void) const { return _params[2]; }
+    double          param4          (void) const { return _params[3]; }
+    double          param5          (void) const { return _params[4]; }
+    double          param6          (void) const { return _params[5]; }
+    double          param7          (void) const { return _params[6]; }
     QGeoCoordinate  coordinate      (void) const;
     int             doJumpId        (void) const { return _doJumpId; }
 
@@ -96,6 +96,19 @@ public:
     void setParam7          (double param7);
     void setCoordinate      (const QGeoCoordinate& coordinate);
     
+    // Facts used to edit the values from the ui. Values are stored outside of the Facts, so the Facts are only created
+    // the first time they are asked for and then kept in sync with the values.
+    Fact* autoContinueFact  (void);
+    Fact* commandFact       (void);
+    Fact* frameFact         (void);
+    Fact* param1Fact        (void) { return _paramFact(1); }
+    Fact* param2Fact        (void) { return _paramFact(2); }
+    Fact* param3Fact        (void) { return _paramFact(3); }
+    Fact* param4Fact        (void) { return _paramFact(4); }
+    Fact* param5Fact        (void) { return _paramFact(5); }
+    Fact* param6Fact        (void) { return _paramFact(6); }
+    Fact* param7Fact        (void) { return _paramFact(7); }
+
     void save(QJsonObject& json) const;
     bool load(QTextStream &loadStream);
     bool load(const QJsonObject& json, int sequenceNumber, QString& errorString);
@@ -105,31 +118,33 @@ public:
 signals:
     void isCurrentItemChanged       (bool isCurrentItem);
     void sequenceNumberChanged      (int sequenceNumber);
+    void commandChanged             (int command);
+    void frameChanged               (int frame);
+    void autoContinueChanged        (bool autoContinue);
+    void paramChanged               (int param, double value);  ///< param is 1-7
     void specifiedFlightSpeedChanged(double flightSpeed);
     void specifiedGimbalYawChanged  (double gimbalYaw);
 
-private slots:
-    void _param2Changed         (QVariant value);
-    void _param3Changed         (QVariant value);
-
 private:
-    bool _convertJsonV1ToV2(const QJsonObject& json, QJsonObject& v2Json, QString& errorString);
-    bool _convertJsonV2ToV3(QJsonObject& json, QString& errorString);
-
-    int     _sequenceNumber;
-    int     _doJumpId;
-    bool    _isCurrentItem;
-
-    Fact    _autoContinueFact;
-    Fact    _commandFact;
-    Fact    _frameFact;
-    Fact    _param1Fact;
-    Fact    _param2Fact;
-    Fact    _param3Fact;
-    Fact    _param4Fact;
-    Fact    _param5Fact;
-    Fact    _param6Fact;
-    Fact    _param7Fact;
+    bool    _convertJsonV1ToV2  (const QJsonObject& json, QJsonObject& v2Json, QString& errorString);
+    bool    _convertJsonV2ToV3  (QJsonObject& json, QString& errorString);
+    void    _setParam           (int param, double value);
+    Fact*   _paramFact          (int param);
+    Fact*   _createFact         (const QString& name, FactMetaData::ValueType_t type, const QVariant& rawValue);
+
+    int         _sequenceNumber;
+    int         _doJumpId;
+    bool        _isCurrentItem;
+    MAV_CMD     _command;
+    MAV_FRAME   _frame;
+    bool        _autoContinue;
+    double      _params[7];
+
+    // Created on first use, see commandFact()
+    Fact*   _autoContinueFact;
+    Fact*   _commandFact;
+    Fact*   _frameFact;
+    Fact*   _paramFacts[7];
     
     // Keys for Json save
     static const char*  _jsonFrameKey;
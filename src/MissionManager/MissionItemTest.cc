@@ -161,7 +161,7 @@ void MissionItemTest::_testFactSignals(void)
 
 
     // command
-    QSignalSpy commandSpy(&missionItem._commandFact, SIGNAL(valueChanged(QVariant)));
+    QSignalSpy commandSpy(missionItem.commandFact(), SIGNAL(valueChanged(QVariant)));
     missionItem.setCommand(MAV_CMD_NAV_WAYPOINT);
     QCOMPARE(commandSpy.count(), 0);
     missionItem.setCommand(MAV_CMD_NAV_ALTITUDE_WAIT);
@@ -171,7 +171,7 @@ void MissionItemTest::_testFactSignals(void)
     QCOMPARE((MAV_CMD)arguments.at(0).toInt(), MAV_CMD_NAV_ALTITUDE_WAIT);
 
     // frame
-    QSignalSpy frameSpy(&missionItem._frameFact, SIGNAL(valueChanged(QVariant)));
+    QSignalSpy frameSpy(missionItem.frameFact(), SIGNAL(valueChanged(QVariant)));
     missionItem.setFrame(MAV_FRAME_GLOBAL_RELATIVE_ALT);
     QCOMPARE(frameSpy.count(), 0);
     missionItem.setFrame(MAV_FRAME_BODY_NED);
@@ -181,7 +181,7 @@ void MissionItemTest::_testFactSignals(void)
     QCOMPARE((MAV_FRAME)arguments.at(0).toInt(), MAV_FRAME_BODY_NED);
 
     // param1
-    QSignalSpy param1Spy(&missionItem._param1Fact, SIGNAL(valueChanged(QVariant)));
+    QSignalSpy param1Spy(missionItem.param1Fact(), SIGNAL(valueChanged(QVariant)));
     missionItem.setParam1(1.0);
     QCOMPARE(param1Spy.count(), 0);
     missionItem.setParam1(2.0);
@@ -191,7 +191,7 @@ void MissionItemTest::_testFactSignals(void)
     QCOMPARE(arguments.at(0).toDouble(), 2.0);
 
     // param2
-    QSignalSpy param2Spy(&missionItem._param2Fact, SIGNAL(valueChanged(QVariant)));
+    QSignalSpy param2Spy(missionItem.param2Fact(), SIGNAL(valueChanged(QVariant)));
     missionItem.setParam2(2.0);
     QCOMPARE(param2Spy.count(), 0);
     missionItem.setParam2(3.0);
@@ -201,7 +201,7 @@ void MissionItemTest::_testFactSignals(void)
     QCOMPARE(arguments.at(0).toDouble(), 3.0);
 
     // param3
-    QSignalSpy param3Spy(&missionItem._param3Fact, SIGNAL(valueChanged(QVariant)));
+    QSignalSpy param3Spy(missionItem.param3Fact(), SIGNAL(valueChanged(QVariant)));
     missionItem.setParam3(3.0);
     QCOMPARE(param3Spy.count(), 0);
     missionItem.setParam3(4.0);
@@ -211,7 +211,7 @@ void MissionItemTest::_testFactSignals(void)
     QCOMPARE(arguments.at(0).toDouble(), 4.0);
 
     // param4
-    QSignalSpy param4Spy(&missionItem._param4Fact, SIGNAL(valueChanged(QVariant)));
+    QSignalSpy param4Spy(missionItem.param4Fact(), SIGNAL(valueChanged(QVariant)));
     missionItem.setParam4(4.0);
     QCOMPARE(param4Spy.count(), 0);
     missionItem.setParam4(5.0);
@@ -221,7 +221,7 @@ void MissionItemTest::_testFactSignals(void)
     QCOMPARE(arguments.at(0).toDouble(), 5.0);
 
     // param6
-    QSignalSpy param6Spy(&missionItem._param6Fact, SIGNAL(valueChanged(QVariant)));
+    QSignalSpy param6Spy(missionItem.param6Fact(), SIGNAL(valueChanged(QVariant)));
     missionItem.setParam6(6.0);
     QCOMPARE(param6Spy.count(), 0);
     missionItem.setParam6(7.0);
@@ -231,7 +231,7 @@ void MissionItemTest::_testFactSignals(void)
     QCOMPARE(arguments.at(0).toDouble(), 7.0);
 
     // param7
-    QSignalSpy param7Spy(&missionItem._param7Fact, SIGNAL(valueChanged(QVariant)));
+    QSignalSpy param7Spy(missionItem.param7Fact(), SIGNAL(valueChanged(QVariant)));
     missionItem.setParam7(7.0);
     QCOMPARE(param7Spy.count(), 0);
     missionItem.setParam7(8.0);
@@ -241,6 +241,57 @@ void MissionItemTest::_testFactSignals(void)
     QCOMPARE(arguments.at(0).toDouble(), 8.0);
 }
 
+// Facts are only created when asked for and must stay in sync with the item values both ways
+void MissionItemTest::_testLazyFacts(void)
+{
+    MissionItem missionItem(1,                                  // sequenceNumber
+                            MAV_CMD_NAV_WAYPOINT,               // command
+                            MAV_FRAME_GLOBAL_RELATIVE_ALT,      // MAV_FRAME
+                            1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0,  // params
+                            true,                               // autoContinue
+                            true);                              // isCurrentItem
+
+    missionItem.setParam1(10.0);
+    missionItem.setCommand(MAV_CMD_NAV_LOITER_TIME);
+    QVERIFY(missionItem._commandFact == NULL);
+    QVERIFY(missionItem._frameFact == NULL);
+    QVERIFY(missionItem._autoContinueFact == NULL);
+    for (int i=0; i<7; i++) {
+        QVERIFY(missionItem._paramFacts[i] == NULL);
+    }
+    QCOMPARE(missionItem.children().count(), 0);
+
+    // Fact picks up current value
+    QCOMPARE(missionItem.param1Fact()->rawValue().toDouble(), 10.0);
+    QCOMPARE(missionItem.commandFact()->rawValue().toInt(), (int)MAV_CMD_NAV_LOITER_TIME);
+    QVERIFY(missionItem._paramFacts[1] == NULL);
+
+    // Changes from the Fact go to the item
+    QSignalSpy paramSpy(&missionItem, SIGNAL(paramChanged(int, double)));
+    missionItem.param1Fact()->setRawValue(20.0);
+    QCOMPARE(missionItem.param1(), 20.0);
+    QCOMPARE(paramSpy.count(), 1);
+    QList<QVariant> arguments = paramSpy.takeFirst();
+    QCOMPARE(arguments.at(0).toInt(), 1);
+    QCOMPARE(arguments.at(1).toDouble(), 20.0);
+
+    // Changes from the item go to the Fact
+    missionItem.setParam1(30.0);
+    QCOMPARE(missionItem.param1Fact()->rawValue().toDouble(), 30.0);
+    QCOMPARE(paramSpy.count(), 1);
+    paramSpy.clear();
+
+    // Setting NaN again is not a change
+    missionItem.setParam4(qQNaN());
+    missionItem.setParam4(qQNaN());
+    QCOMPARE(paramSpy.count(), 1);
+
+    QSignalSpy commandSpy(&missionItem, SIGNAL(commandChanged(int)));
+    missionItem.commandFact()->setRawValue(MAV_CMD_NAV_WAYPOINT);
+    QCOMPARE(missionItem.command(), MAV_CMD_NAV_WAYPOINT);
+    QCOMPARE(commandSpy.count(), 1);
+}
+
 void MissionItemTest::_checkExpectedMissionItem(const MissionItem& missionItem, bool allNaNs)
 {
     QCOMPARE(missionItem.sequenceNumber(), _seq);
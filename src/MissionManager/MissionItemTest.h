@@ -31,6 +31,7 @@ private slots:
     void _testSetGet(void);
     void _testSignals(void);
     void _testFactSignals(void);
+    void _testLazyFacts(void);
     void _testLoadFromStream(void);
     void _testSimpleLoadFromStream(void);
     void _testLoadFromJsonV1(void);
@@ -18,9 +18,24 @@
 #include "QGCApplication.h"
 #include "MissionCommandTree.h"
 #include "MissionCommandUIInfo.h"
+#include "JsonHelper.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSettings>
+
+#include <algorithm>
 
 QGC_LOGGING_CATEGORY(MissionManagerLog, "MissionManagerLog")
 
+const char* MissionManager::_jsonItemsKey = "items";
+const char* MissionManager::_jsonHashKey =  "hash";
+
 MissionManager::MissionManager(Vehicle* vehicle)
     : _vehicle(vehicle)
     , _dedicatedLink(NULL)
@@ -28,6 +43,10 @@ MissionManager::MissionManager(Vehicle* vehicle)
     , _expectedAck(AckNone)
     , _transactionInProgress(TransactionNone)
     , _resumeMission(false)
+    , _partialWrite(false)
+    , _partialWriteAccepted(false)
+    , _writeRangeStart(0)
+    , _writeRangeEnd(-1)
     , _lastMissionRequest(-1)
     , _currentMissionIndex(-1)
     , _lastCurrentIndex(-1)
@@ -39,6 +58,9 @@ MissionManager::MissionManager(Vehicle* vehicle)
     _ackTimeoutTimer->setInterval(_ackTimeoutMilliseconds);
     
     connect(_ackTimeoutTimer, &QTimer::timeout, this, &MissionManager::_ackTimeout);
+
+    // Ensure the cache directory exists
+    QFileInfo(QSettings().fileName()).dir().mkdir("MissionCache");
 }
 
 MissionManager::~MissionManager()
@@ -54,14 +76,56 @@ void MissionManager::_writeMissionItemsWorker(void)
 
     qCDebug(MissionManagerLog) << "writeMissionItems count:" << _writeMissionItems.count();
 
-    // Prime write list
+    _writeItemHashes.clear();
     for (int i=0; i<_writeMissionItems.count(); i++) {
-        _itemIndicesToWrite << i;
+        _writeItemHashes.append(_writeItemHash(_writeMissionItems[i]));
+    }
+
+    // Only the changed items need to be sent if we know what is on the vehicle and the item count stays the same
+    _partialWrite = false;
+    _partialWriteAccepted = false;
+    _partialWriteRanges.clear();
+    if (_vehicle->firmwarePlugin()->supportsMissionPartialWrite() && _writeItemHashes.count() != 0 && _writeItemHashes.count() == _vehicleItemHashes.count()) {
+        _partialWriteRanges = _changedItemRanges(_writeItemHashes);
+
+        int changedCount = 0;
+        for (int i=0; i<_partialWriteRanges.count(); i++) {
+            changedCount += _partialWriteRanges[i].second - _partialWriteRanges[i].first + 1;
+        }
+        _partialWrite = changedCount < _writeItemHashes.count();
+        qCDebug(MissionManagerLog) << "writeMissionItems changed items:ranges" << changedCount << _partialWriteRanges.count();
     }
 
     _transactionInProgress = TransactionWrite;
     _retryCount = 0;
     emit inProgressChanged(true);
+
+    if (!_partialWrite) {
+        _writeFullMission();
+    } else if (_partialWriteRanges.count()) {
+        _writeNextPartialRange();
+    } else {
+        // Vehicle already has this mission. Complete the transaction from the event loop, the same as a write would.
+        qCDebug(MissionManagerLog) << "writeMissionItems no items changed";
+        QTimer::singleShot(0, this, [this]() { _finishTransaction(true); });
+    }
+}
+
+/// Starts a write of all items, replacing the whole mission on the vehicle
+void MissionManager::_writeFullMission(void)
+{
+    _partialWrite = false;
+    _partialWriteRanges.clear();
+
+    // Prime write list
+    _itemIndicesToWrite.clear();
+    for (int i=0; i<_writeMissionItems.count(); i++) {
+        _itemIndicesToWrite << i;
+    }
+    _writeRangeStart = 0;
+    _writeRangeEnd = _writeMissionItems.count() - 1;
+
+    _retryCount = 0;
     _writeMissionCount();
 
     _currentMissionIndex = -1;
@@ -70,6 +134,78 @@ void MissionManager::_writeMissionItemsWorker(void)
     emit lastCurrentIndexChanged(-1);
 }
 
+/// Starts the write of the next range of changed items
+void MissionManager::_writeNextPartialRange(void)
+{
+    QPair<int, int> range = _partialWriteRanges.takeFirst();
+
+    _itemIndicesToWrite.clear();
+    for (int i=range.first; i<=range.second; i++) {
+        _itemIndicesToWrite << i;
+    }
+    _writeRangeStart = range.first;
+    _writeRangeEnd = range.second;
+
+    _retryCount = 0;
+    _writeMissionPartialList();
+}
+
+/// Vehicle did not accept MISSION_WRITE_PARTIAL_LIST, send the whole mission instead
+void MissionManager::_fallbackToFullWrite(void)
+{
+    qCDebug(MissionManagerLog) << "_fallbackToFullWrite vehicle did not accept partial write";
+    _writeFullMission();
+}
+
+/// @return Ranges of items which differ from the items on the vehicle. Ranges separated by only a few unchanged items
+/// are merged into one.
+QList<QPair<int, int>> MissionManager::_changedItemRanges(const QVector<QByteArray>& itemHashes)
+{
+    QList<QPair<int, int>> ranges;
+
+    for (int i=0; i<itemHashes.count(); i++) {
+        if (itemHashes[i] == _vehicleItemHashes[i]) {
+            continue;
+        }
+        if (ranges.count() && i - ranges.last().second - 1 <= _partialWriteMergeGap) {
+            ranges.last().second = i;
+        } else {
+            ranges.append(qMakePair(i, i));
+        }
+    }
+
+    return ranges;
+}
+
+/// @return Hash of the mission item content as it is encoded on the wire. Sequence number and current flag are not
+/// included since they do not change what the vehicle flies.
+QByteArray MissionManager::_itemHash(int command, int frame, float param1, float param2, float param3, float param4, double x, double y, float z, bool autoContinue)
+{
+    QByteArray  itemBytes;
+    QDataStream stream(&itemBytes, QIODevice::WriteOnly);
+
+    stream << command << frame << param1 << param2 << param3 << param4 << x << y << z << autoContinue;
+
+    return QCryptographicHash::hash(itemBytes, QCryptographicHash::Md5);
+}
+
+QByteArray MissionManager::_writeItemHash(const MissionItem* item)
+{
+    double x;
+    double y;
+
+    // Must match the encoding in _handleMissionRequest
+    if (_vehicle->supportsMissionItemInt()) {
+        x = (int32_t)(item->param5() * qPow(10.0, 7.0));
+        y = (int32_t)(item->param6() * qPow(10.0, 7.0));
+    } else {
+        x = (float)item->param5();
+        y = (float)item->param6();
+    }
+
+    return _itemHash(item->command(), item->frame(), item->param1(), item->param2(), item->param3(), item->param4(), x, y, item->param7(), item->autoContinue());
+}
+
 
 void MissionManager::writeMissionItems(const QList<MissionItem*>& missionItems)
 {
@@ -130,6 +266,31 @@ void MissionManager::_writeMissionCount(void)
     _startAckTimeout(AckMissionRequest);
 }
 
+/// This begins the write sequence for the current range of changed items. This may be called during a retry.
+void MissionManager::_writeMissionPartialList(void)
+{
+    qCDebug(MissionManagerLog) << "_writeMissionPartialList start:end:_retryCount" << _writeRangeStart << _writeRangeEnd << _retryCount;
+
+    mavlink_message_t                       message;
+    mavlink_mission_write_partial_list_t    partialList;
+
+    memset(&partialList, 0, sizeof(partialList));
+    partialList.target_system = _vehicle->id();
+    partialList.target_component = MAV_COMP_ID_MISSIONPLANNER;
+    partialList.start_index = _writeRangeStart;
+    partialList.end_index = _writeRangeEnd;
+
+    _dedicatedLink = _vehicle->priorityLink();
+    mavlink_msg_mission_write_partial_list_encode_chan(qgcApp()->toolbox()->mavlinkProtocol()->getSystemId(),
+                                                       qgcApp()->toolbox()->mavlinkProtocol()->getComponentId(),
+                                                       _dedicatedLink->mavlinkChannel(),
+                                                       &message,
+                                                       &partialList);
+
+    _vehicle->sendMessageOnLink(_dedicatedLink, message);
+    _startAckTimeout(AckMissionRequest);
+}
+
 void MissionManager::writeArduPilotGuidedMissionItem(const QGeoCoordinate& gotoCoord, bool altChangeOnly)
 {
     if (inProgress()) {
@@ -200,6 +361,7 @@ void MissionManager::_requestList(void)
     memset(&request, 0, sizeof(request));
 
     _itemIndicesToRead.clear();
+    _readItemHashes.clear();
     _clearMissionItems();
 
     request.target_system = _vehicle->id();
@@ -255,15 +417,23 @@ void MissionManager::_ackTimeout(void)
             // Vehicle did not send final MISSION_ACK at end of sequence
             _sendError(VehicleError, QStringLiteral("Mission write failed, vehicle failed to send final ack."));
             _finishTransaction(false);
-        } else if (_itemIndicesToWrite[0] == 0) {
-            // Vehicle did not respond to MISSION_COUNT, try again
-            if (_retryCount > _maxRetryCount) {
+        } else if (_itemIndicesToWrite[0] == _writeRangeStart) {
+            // Vehicle did not respond to MISSION_COUNT or MISSION_WRITE_PARTIAL_LIST
+            if (_partialWrite && !_partialWriteAccepted) {
+                // Vehicle may not support partial writes
+                _fallbackToFullWrite();
+            } else if (_retryCount > _maxRetryCount) {
                 _sendError(VehicleError, QStringLiteral("Mission write mission count failed, maximum retries exceeded."));
                 _finishTransaction(false);
             } else {
                 _retryCount++;
-                qCDebug(MissionManagerLog) << "Retrying MISSION_COUNT retry Count" << _retryCount;
-                _writeMissionCount();
+                if (_partialWrite) {
+                    qCDebug(MissionManagerLog) << "Retrying MISSION_WRITE_PARTIAL_LIST retry Count" << _retryCount;
+                    _writeMissionPartialList();
+                } else {
+                    qCDebug(MissionManagerLog) << "Retrying MISSION_COUNT retry Count" << _retryCount;
+                    _writeMissionCount();
+                }
             }
         } else {
             // Vehicle did not request all items from ground station
@@ -322,7 +492,17 @@ bool MissionManager::_checkForExpectedAck(AckType_t receivedAck)
 void MissionManager::_readTransactionComplete(void)
 {
     qCDebug(MissionManagerLog) << "_readTransactionComplete read sequence complete";
-    
+
+    // Spot check items for the mission cache are read out of order
+    std::sort(_missionItems.begin(), _missionItems.end(), [](const MissionItem* item1, const MissionItem* item2) { return item1->sequenceNumber() < item2->sequenceNumber(); });
+
+    _sendReadAck();
+    _finishTransaction(true);
+}
+
+/// Sends the MISSION_ACK which ends a read sequence on the vehicle
+void MissionManager::_sendReadAck(void)
+{
     mavlink_message_t       message;
     mavlink_mission_ack_t   missionAck;
 
@@ -339,8 +519,6 @@ void MissionManager::_readTransactionComplete(void)
                                         &missionAck);
     
     _vehicle->sendMessageOnLink(_dedicatedLink, message);
-
-    _finishTransaction(true);
 }
 
 void MissionManager::_handleMissionCount(const mavlink_message_t& message)
@@ -356,12 +534,25 @@ void MissionManager::_handleMissionCount(const mavlink_message_t& message)
     mavlink_msg_mission_count_decode(&message, &missionCount);
     qCDebug(MissionManagerLog) << "_handleMissionCount count:" << missionCount.count;
 
+    _readItemHashes = QVector<QByteArray>(missionCount.count);
+
     if (missionCount.count == 0) {
         _readTransactionComplete();
     } else {
-        // Prime read list
-        for (int i=0; i<missionCount.count; i++) {
-            _itemIndicesToRead << i;
+        if (_loadMissionCache(missionCount.count)) {
+            // Only read a few spot check items. If they match the cache the rest comes from the cache.
+            QList<int> checkIndices;
+            checkIndices << 0 << _firstCheckedCacheItem() << missionCount.count / 2 << missionCount.count - 1;
+            for (int i=0; i<checkIndices.count(); i++) {
+                if (checkIndices[i] < missionCount.count && !_itemIndicesToRead.contains(checkIndices[i])) {
+                    _itemIndicesToRead << checkIndices[i];
+                }
+            }
+        } else {
+            // Prime read list
+            for (int i=0; i<missionCount.count; i++) {
+                _itemIndicesToRead << i;
+            }
         }
         _requestNextMissionItem();
     }
@@ -420,6 +611,8 @@ void MissionManager::_handleMissionItem(const mavlink_message_t& message, bool m
     double      param5;
     double      param6;
     double      param7;
+    double      wireX;
+    double      wireY;
     bool        autoContinue;
     bool        isCurrentItem;
     int         seq;
@@ -437,6 +630,8 @@ void MissionManager::_handleMissionItem(const mavlink_message_t& message, bool m
         param5 =        (double)missionItem.x / qPow(10.0, 7.0);
         param6 =        (double)missionItem.y / qPow(10.0, 7.0);
         param7 =        (double)missionItem.z;
+        wireX =         missionItem.x;
+        wireY =         missionItem.y;
         autoContinue =  missionItem.autocontinue;
         isCurrentItem = missionItem.current;
         seq =           missionItem.seq;
@@ -453,6 +648,8 @@ void MissionManager::_handleMissionItem(const mavlink_message_t& message, bool m
         param5 =        missionItem.x;
         param6 =        missionItem.y;
         param7 =        missionItem.z;
+        wireX =         missionItem.x;
+        wireY =         missionItem.y;
         autoContinue =  missionItem.autocontinue;
         isCurrentItem = missionItem.current;
         seq =           missionItem.seq;
@@ -481,11 +678,16 @@ void MissionManager::_handleMissionItem(const mavlink_message_t& message, bool m
     if (ardupilotHomePositionUpdate) {
         QGeoCoordinate newHomePosition(param5, param6, param7);
         _vehicle->_setHomePosition(newHomePosition);
+        if (_vehicleItemHashes.count()) {
+            // Item 0 on the vehicle no longer matches what we know about it
+            _vehicleItemHashes[0].clear();
+        }
         return;
     }
     
     if (_itemIndicesToRead.contains(seq)) {
         _itemIndicesToRead.removeOne(seq);
+        _readItemHashes[seq] = _itemHash(command, frame, param1, param2, param3, param4, wireX, wireY, param7, autoContinue);
 
         MissionItem* item = new MissionItem(seq,
                                             command,
@@ -517,6 +719,9 @@ void MissionManager::_handleMissionItem(const mavlink_message_t& message, bool m
     emit progressPct((double)seq / (double)_missionItems.count());
     
     _retryCount = 0;
+    if (_itemIndicesToRead.count() == 0 && _cacheMissionItems.count()) {
+        _checkMissionCache();
+    }
     if (_itemIndicesToRead.count() == 0) {
         _readTransactionComplete();
     } else {
@@ -550,6 +755,7 @@ void MissionManager::_handleMissionRequest(const mavlink_message_t& message, boo
     emit progressPct((double)missionRequest.seq / (double)_writeMissionItems.count());
 
     _lastMissionRequest = missionRequest.seq;
+    _partialWriteAccepted = true;
     if (!_itemIndicesToWrite.contains(missionRequest.seq)) {
         qCDebug(MissionManagerLog) << "_handleMissionRequest sequence number requested which has already been sent, sending again:" << missionRequest.seq;
     } else {
@@ -652,12 +858,20 @@ void MissionManager::_handleMissionAck(const mavlink_message_t& message)
         // MISSION_REQUEST is expected, or MISSION_ACK to end sequence
         if (missionAck.type == MAV_MISSION_ACCEPTED) {
             if (_itemIndicesToWrite.count() == 0) {
-                qCDebug(MissionManagerLog) << "_handleMissionAck write sequence complete";
-                _finishTransaction(true);
+                if (_partialWrite && _partialWriteRanges.count()) {
+                    qCDebug(MissionManagerLog) << "_handleMissionAck partial write range complete";
+                    _writeNextPartialRange();
+                } else {
+                    qCDebug(MissionManagerLog) << "_handleMissionAck write sequence complete";
+                    _finishTransaction(true);
+                }
             } else {
                 _sendError(MissingRequestsError, QString("Vehicle did not request all items during write sequence, missed count %1.").arg(_itemIndicesToWrite.count()));
                 _finishTransaction(false);
             }
+        } else if (_partialWrite && !_partialWriteAccepted) {
+            // Vehicle rejected MISSION_WRITE_PARTIAL_LIST
+            _fallbackToFullWrite();
         } else {
             _sendError(VehicleError, QString("Vehicle returned error: %1.").arg(_missionResultToString((MAV_MISSION_RESULT)missionAck.type)));
             _finishTransaction(false);
@@ -854,6 +1068,9 @@ void MissionManager::_finishTransaction(bool success)
 
     _itemIndicesToRead.clear();
     _itemIndicesToWrite.clear();
+    _clearCacheMissionItems();
+    _partialWrite = false;
+    _partialWriteRanges.clear();
 
     // First thing we do is clear the transaction. This way inProgesss is off when we signal transaction complete.
     TransactionType_t currentTransactionType = _transactionInProgress;
@@ -866,10 +1083,15 @@ void MissionManager::_finishTransaction(bool success)
 
     switch (currentTransactionType) {
     case TransactionRead:
-        if (!success) {
+        if (success) {
+            _vehicleItemHashes = _readItemHashes;
+            _saveMissionCache(false /* writtenItems */);
+        } else {
             // Read from vehicle failed, clear partial list
             _clearAndDeleteMissionItems();
+            _vehicleItemHashes.clear();
         }
+        _readItemHashes.clear();
         emit newMissionItemsAvailable(false);
         break;
     case TransactionWrite:
@@ -880,13 +1102,20 @@ void MissionManager::_finishTransaction(bool success)
                 _missionItems.append(_writeMissionItems[i]);
             }
             _writeMissionItems.clear();
+            _vehicleItemHashes = _writeItemHashes;
+            _saveMissionCache(true /* writtenItems */);
         } else {
-            // Write failed, throw out the write list
+            // Write failed, throw out the write list. What is left on the vehicle is unknown.
             _clearAndDeleteWriteMissionItems();
+            _vehicleItemHashes.clear();
+            _removeMissionCache();
         }
+        _writeItemHashes.clear();
         emit sendComplete(!success /* error */);
         break;
     case TransactionRemoveAll:
+        _vehicleItemHashes.clear();
+        _removeMissionCache();
         emit removeAllComplete(!success /* error */);
         break;
     default:
@@ -1142,3 +1371,151 @@ void MissionManager::_clearAndDeleteWriteMissionItems(void)
     }
     _writeMissionItems.clear();
 }
+
+QDir MissionManager::missionCacheDir(void)
+{
+    const QString spath(QFileInfo(QSettings().fileName()).dir().absolutePath());
+    return spath + QDir::separator() + "MissionCache";
+}
+
+QString MissionManager::missionCacheFile(void) const
+{
+    if (_vehicle->uid() == 0) {
+        return QString();
+    }
+    return missionCacheDir().filePath(QString("%1_%2.json").arg(_vehicle->firmwareType()).arg(_vehicle->uid(), 16, 16, QChar('0')));
+}
+
+/// Loads the cached mission for the vehicle if it has the specified item count
+/// @return true: cached mission loaded into _cacheMissionItems
+bool MissionManager::_loadMissionCache(int count)
+{
+    _clearCacheMissionItems();
+
+    QString cacheFileName = missionCacheFile();
+    if (cacheFileName.isEmpty()) {
+        return false;
+    }
+
+    QFile cacheFile(cacheFileName);
+    if (!cacheFile.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QJsonObject json = QJsonDocument::fromJson(cacheFile.readAll()).object();
+    QJsonArray  jsonItems = json[_jsonItemsKey].toArray();
+    if (json[JsonHelper::jsonVersionKey].toInt() != _missionCacheVersion || jsonItems.count() != count) {
+        qCDebug(MissionManagerLog) << "_loadMissionCache cache does not match, version:count" << json[JsonHelper::jsonVersionKey].toInt() << jsonItems.count();
+        return false;
+    }
+
+    for (int i=0; i<jsonItems.count(); i++) {
+        QJsonObject     jsonItem = jsonItems[i].toObject();
+        MissionItem*    item = new MissionItem(this);
+        QString         errorString;
+
+        _cacheMissionItems.append(item);
+        _cacheItemHashes.append(QByteArray::fromBase64(jsonItem[_jsonHashKey].toString().toLatin1()));
+        if (!item->load(jsonItem, i, errorString)) {
+            qCDebug(MissionManagerLog) << "_loadMissionCache load failed" << errorString;
+            _clearCacheMissionItems();
+            return false;
+        }
+    }
+
+    qCDebug(MissionManagerLog) << "_loadMissionCache loaded cached mission count:" << count;
+    return true;
+}
+
+/// @return Index of the first cached item which is compared against the vehicle. On ArduPilot item 0 holds the home
+/// position, which changes without the mission changing.
+int MissionManager::_firstCheckedCacheItem(void) const
+{
+    return _vehicle->firmwarePlugin()->sendHomePositionToVehicle() ? 1 : 0;
+}
+
+/// Called once the spot check items have been read. If they match the cache the remaining items are taken from the
+/// cache, otherwise they are queued to be read from the vehicle.
+void MissionManager::_checkMissionCache(void)
+{
+    int firstCheckedItem = _firstCheckedCacheItem();
+
+    QList<int>  readIndices;
+    bool        cacheMatches = true;
+    for (int i=0; i<_missionItems.count(); i++) {
+        int seq = _missionItems[i]->sequenceNumber();
+        readIndices.append(seq);
+        if (seq >= firstCheckedItem && _readItemHashes[seq] != _cacheItemHashes[seq]) {
+            cacheMatches = false;
+        }
+    }
+
+    for (int i=0; i<_cacheMissionItems.count(); i++) {
+        if (readIndices.contains(i)) {
+            continue;
+        }
+        if (cacheMatches) {
+            _missionItems.append(new MissionItem(*_cacheMissionItems[i], this));
+            _readItemHashes[i] = _cacheItemHashes[i];
+        } else {
+            _itemIndicesToRead << i;
+        }
+    }
+
+    qCDebug(MissionManagerLog) << "_checkMissionCache cache matches" << cacheMatches;
+    _clearCacheMissionItems();
+}
+
+/// Saves the current mission items to the mission cache
+///     @param writtenItems true: items were written to the vehicle, false: items were read from the vehicle
+void MissionManager::_saveMissionCache(bool writtenItems)
+{
+    QString cacheFileName = missionCacheFile();
+    if (cacheFileName.isEmpty()) {
+        return;
+    }
+
+    QJsonArray jsonItems;
+
+    for (int i=0; i<_missionItems.count(); i++) {
+        MissionItem item(*_missionItems[i]);
+
+        if (writtenItems && item.command() == MAV_CMD_DO_JUMP && !_vehicle->firmwarePlugin()->sendHomePositionToVehicle()) {
+            // Cache holds items as they are after a read, with home in position 0
+            item.setParam1((int)item.param1() + 1);
+        }
+
+        QJsonObject jsonItem;
+        item.save(jsonItem);
+        jsonItem[_jsonHashKey] = QString(_vehicleItemHashes.value(i).toBase64());
+        jsonItems.append(jsonItem);
+    }
+
+    QJsonObject json;
+    json[JsonHelper::jsonVersionKey] = _missionCacheVersion;
+    json[_jsonItemsKey] = jsonItems;
+
+    QFile cacheFile(cacheFileName);
+    if (!cacheFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCWarning(MissionManagerLog) << "Unable to write mission cache" << cacheFile.fileName();
+        return;
+    }
+    cacheFile.write(QJsonDocument(json).toJson(QJsonDocument::Compact));
+}
+
+void MissionManager::_removeMissionCache(void)
+{
+    QString cacheFileName = missionCacheFile();
+    if (!cacheFileName.isEmpty()) {
+        QFile::remove(cacheFileName);
+    }
+}
+
+void MissionManager::_clearCacheMissionItems(void)
+{
+    for (int i=0; i<_cacheMissionItems.count(); i++) {
+        _cacheMissionItems[i]->deleteLater();
+    }
+    _cacheMissionItems.clear();
+    _cacheItemHashes.clear();
+}
@@ -16,6 +16,9 @@
 #include <QThread>
 #include <QMutex>
 #include <QTimer>
+#include <QDir>
+#include <QPair>
+#include <QVector>
 
 #include "MissionItem.h"
 #include "QGCMAVLink.h"
@@ -47,10 +50,21 @@ public:
     ///     Signals newMissionItemsAvailable when done
     void loadFromVehicle(void);
     
-    /// Writes the specified set of mission items to the vehicle
+    /// Writes the specified set of mission items to the vehicle. If the vehicle supports partial writes and the item
+    /// count is unchanged, only the items which differ from what was last read from or written to the vehicle are sent.
     ///     @param missionItems Items to send to vehicle
     ///     Signals sendComplete when done
     void writeMissionItems(const QList<MissionItem*>& missionItems);
+
+    /// Forgets what is known about the mission on the vehicle, the next write will send all items
+    void clearVehicleItemHashes(void) { _vehicleItemHashes.clear(); }
+
+    /// @return Directory of mission caches
+    static QDir missionCacheDir(void);
+
+    /// @return Location of the cache file for the last mission read from or written to this vehicle. The file is keyed
+    /// by firmware type and the AUTOPILOT_VERSION uid. Empty if the vehicle did not report a uid, no cache is kept then.
+    QString missionCacheFile(void) const;
     
     /// Writes the specified set mission items to the vehicle as an ArduPilot guided mode mission item.
     ///     @param gotoCoord Coordinate to move to
@@ -80,6 +94,9 @@ public:
     // These values are public so the unit test can set appropriate signal wait times
     static const int _ackTimeoutMilliseconds = 1000;
     static const int _maxRetryCount = 5;
+
+    /// Unchanged items between two changed ranges which are sent anyway to save a MISSION_WRITE_PARTIAL_LIST round trip
+    static const int _partialWriteMergeGap = 2;
     
 signals:
     void newMissionItemsAvailable(bool removeAllRequested);
@@ -116,6 +133,7 @@ private:
     void _startAckTimeout(AckType_t ack);
     bool _checkForExpectedAck(AckType_t receivedAck);
     void _readTransactionComplete(void);
+    void _sendReadAck(void);
     void _handleMissionCount(const mavlink_message_t& message);
     void _handleMissionItem(const mavlink_message_t& message, bool missionItemInt);
     void _handleMissionRequest(const mavlink_message_t& message, bool missionItemInt);
@@ -129,11 +147,24 @@ private:
     void _finishTransaction(bool success);
     void _requestList(void);
     void _writeMissionCount(void);
+    void _writeMissionPartialList(void);
+    void _writeFullMission(void);
+    void _writeNextPartialRange(void);
+    void _fallbackToFullWrite(void);
     void _writeMissionItemsWorker(void);
+    QList<QPair<int, int>> _changedItemRanges(const QVector<QByteArray>& itemHashes);
+    static QByteArray _itemHash(int command, int frame, float param1, float param2, float param3, float param4, double x, double y, float z, bool autoContinue);
+    QByteArray _writeItemHash(const MissionItem* item);
     void _clearAndDeleteMissionItems(void);
     void _clearAndDeleteWriteMissionItems(void);
     QString _lastMissionReqestString(MAV_MISSION_RESULT result);
     void _removeAllWorker(void);
+    bool _loadMissionCache(int count);
+    void _saveMissionCache(bool writtenItems);
+    void _removeMissionCache(void);
+    void _checkMissionCache(void);
+    int _firstCheckedCacheItem(void) const;
+    void _clearCacheMissionItems(void);
 
 private:
     Vehicle*            _vehicle;
@@ -147,14 +178,28 @@ private:
     bool                _resumeMission;
     QList<int>          _itemIndicesToWrite;    ///< List of mission items which still need to be written to vehicle
     QList<int>          _itemIndicesToRead;     ///< List of mission items which still need to be requested from vehicle
+    bool                _partialWrite;          ///< true: Write transaction only sends changed items using MISSION_WRITE_PARTIAL_LIST
+    bool                _partialWriteAccepted;  ///< true: Vehicle requested an item in response to MISSION_WRITE_PARTIAL_LIST
+    int                 _writeRangeStart;       ///< First item of the range currently being written
+    int                 _writeRangeEnd;         ///< Last item of the range currently being written
+    QList<QPair<int, int>> _partialWriteRanges; ///< Item ranges which still need a MISSION_WRITE_PARTIAL_LIST
     int                 _lastMissionRequest;    ///< Index of item last requested by MISSION_REQUEST
     
     QMutex _dataMutex;
     
     QList<MissionItem*> _missionItems;          ///< Set of mission items on vehicle
     QList<MissionItem*> _writeMissionItems;     ///< Set of mission items currently being written to vehicle
+    QVector<QByteArray> _vehicleItemHashes;     ///< Content hash of each item on the vehicle, as last read or written. Empty if unknown.
+    QVector<QByteArray> _readItemHashes;        ///< Content hash of each item being read from the vehicle
+    QVector<QByteArray> _writeItemHashes;       ///< Content hash of each item being written to the vehicle
+    QList<MissionItem*> _cacheMissionItems;     ///< Items from the mission cache, waiting on the spot check of a read
+    QVector<QByteArray> _cacheItemHashes;       ///< Content hash of each item in _cacheMissionItems
     int                 _currentMissionIndex;
     int                 _lastCurrentIndex;
+
+    static const int    _missionCacheVersion = 1;
+    static const char*  _jsonItemsKey;
+    static const char*  _jsonHashKey;
 };
 
 #endif
@@ -11,6 +11,9 @@
 #include "MissionManagerTest.h"
 #include "LinkManager.h"
 #include "MultiVehicleManager.h"
+#include "QGCApplication.h"
+
+#include <QSignalSpy>
 
 const MissionManagerTest::TestCase_t MissionManagerTest::_rgTestCases[] = {
     { "0\t0\t3\t16\t10\t20\t30\t40\t-10\t-20\t-30\t1\r\n",  { 0, QGeoCoordinate(-10.0, -20.0, -30.0), MAV_CMD_NAV_WAYPOINT,     10.0, 20.0, 30.0, 40.0, true, false, MAV_FRAME_GLOBAL_RELATIVE_ALT } },
@@ -27,13 +30,8 @@ MissionManagerTest::MissionManagerTest(void)
     
 }
 
-void MissionManagerTest::_writeItems(MockLinkMissionItemHandler::FailureMode_t failureMode, bool shouldFail)
+void MissionManagerTest::_createTestItems(QList<MissionItem*>& missionItems)
 {
-    _mockLink->setMissionItemFailureMode(failureMode);
-    
-    // Setup our test case data
-    QList<MissionItem*> missionItems;
-    
     // Editor has a home position item on the front, so we do the same
     MissionItem* homeItem = new MissionItem(NULL /* Vehicle */, this);
     homeItem->setCommand(MAV_CMD_NAV_WAYPOINT);
@@ -54,7 +52,24 @@ void MissionManagerTest::_writeItems(MockLinkMissionItemHandler::FailureMode_t f
         
         missionItems.append(missionItem);
     }
+}
+
+void MissionManagerTest::_writeItems(MockLinkMissionItemHandler::FailureMode_t failureMode, bool shouldFail)
+{
+    _mockLink->setMissionItemFailureMode(failureMode);
     
+    // Setup our test case data
+    QList<MissionItem*> missionItems;
+    _createTestItems(missionItems);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+
+    _writeItemList(missionItems, shouldFail);
+}
+
+void MissionManagerTest::_writeItemList(const QList<MissionItem*>& missionItems, bool shouldFail)
+{
     // Send the items to the vehicle
     _missionManager->writeMissionItems(missionItems);
     
@@ -101,10 +116,10 @@ void MissionManagerTest::_writeItems(MockLinkMissionItemHandler::FailureMode_t f
 
         // Validate item count in mission manager
 
-        int expectedCount = (int)_cTestCases;
-        if (_mockLink->getFirmwareType() == MAV_AUTOPILOT_ARDUPILOTMEGA) {
-            // Home position at position 0 comes from vehicle
-            expectedCount++;
+        int expectedCount = missionItems.count();
+        if (_mockLink->getFirmwareType() != MAV_AUTOPILOT_ARDUPILOTMEGA) {
+            // Home position is not sent to vehicle
+            expectedCount--;
         }
 
         QCOMPARE(_missionManager->missionItems().count(), expectedCount);
@@ -119,6 +134,9 @@ void MissionManagerTest::_roundTripItems(MockLinkMissionItemHandler::FailureMode
     
     _mockLink->setMissionItemFailureMode(failureMode);
 
+    // Failure modes are tied to specific items, so everything must be read from the vehicle
+    QFile::remove(_missionManager->missionCacheFile());
+
     // Read the items back from the vehicle
     _missionManager->loadFromVehicle();
     
@@ -254,6 +272,7 @@ void MissionManagerTest::_testWriteFailureHandlingWorker(void)
         qDebug() << "TEST CASE " << pCase->failureText;
         _writeItems(pCase->failureMode, pCase->shouldFail);
         _mockLink->resetMissionItemHandler();
+        _missionManager->clearVehicleItemHashes();
     }
 }
 
@@ -299,6 +318,7 @@ void MissionManagerTest::_testReadFailureHandlingWorker(void)
         qDebug() << "TEST CASE " << pCase->failureText;
         _roundTripItems(pCase->failureMode, pCase->shouldFail);
         _mockLink->resetMissionItemHandler();
+        _missionManager->clearVehicleItemHashes();
         _multiSpyMissionManager->clearAllSignals();
     }
 }
@@ -327,3 +347,147 @@ void MissionManagerTest::_testReadFailureHandlingPX4(void)
     _initForFirmwareType(MAV_AUTOPILOT_PX4);
     _testReadFailureHandlingWorker();
 }
+
+void MissionManagerTest::_testPartialWriteAPM(void)
+{
+    _initForFirmwareType(MAV_AUTOPILOT_ARDUPILOTMEGA);
+    _mockLink->setMissionItemFailureMode(MockLinkMissionItemHandler::FailNone);
+
+    QList<MissionItem*> missionItems;
+    _createTestItems(missionItems);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+    int itemCount = missionItems.count();
+
+    // First write sends everything
+    _writeItemList(missionItems, false);
+    QCOMPARE(_mockLink->missionItemWriteCount(), itemCount);
+
+    // Vehicle already has an unchanged mission
+    _writeItemList(missionItems, false);
+    QCOMPARE(_mockLink->missionItemWriteCount(), itemCount);
+
+    // Only the changed item is sent
+    missionItems[3]->setParam1(missionItems[3]->param1() + 1);
+    _writeItemList(missionItems, false);
+    QCOMPARE(_mockLink->missionItemWriteCount(), itemCount + 1);
+    QCOMPARE(_missionManager->missionItems()[3]->param1(), missionItems[3]->param1());
+
+    // Changes separated by a single unchanged item are sent as one range
+    missionItems[1]->setParam1(missionItems[1]->param1() + 1);
+    missionItems[3]->setParam1(missionItems[3]->param1() + 1);
+    _writeItemList(missionItems, false);
+    QCOMPARE(_mockLink->missionItemWriteCount(), itemCount + 4);
+
+    // Changing the item count needs a full write
+    MissionItem* extraItem = new MissionItem(*missionItems.last(), this);
+    extraItem->setSequenceNumber(extraItem->sequenceNumber() + 1);
+    missionItems.append(extraItem);
+    _writeItemList(missionItems, false);
+    QCOMPARE(_mockLink->missionItemWriteCount(), (itemCount * 2) + 5);
+    itemCount++;
+
+    // A vehicle which rejects the partial write gets the whole mission
+    int writeCount = _mockLink->missionItemWriteCount();
+    _mockLink->setMissionItemFailureMode(MockLinkMissionItemHandler::FailWritePartialListErrorAck);
+    missionItems[2]->setParam1(missionItems[2]->param1() + 1);
+    _writeItemList(missionItems, false);
+    QCOMPARE(_mockLink->missionItemWriteCount(), writeCount + itemCount);
+}
+
+void MissionManagerTest::_readItems(void)
+{
+    _missionManager->loadFromVehicle();
+    QVERIFY(_missionManager->inProgress());
+
+    _multiSpyMissionManager->waitForSignalByIndex(newMissionItemsAvailableSignalIndex, _missionManagerSignalWaitTime);
+    QCOMPARE(_multiSpyMissionManager->checkSignalByMask(newMissionItemsAvailableSignalMask | inProgressChangedSignalMask), true);
+    QCOMPARE(_multiSpyMissionManager->checkNoSignalByMask(errorSignalMask), true);
+    _multiSpyMissionManager->clearAllSignals();
+}
+
+void MissionManagerTest::_testMissionCachePX4(void)
+{
+    _initForFirmwareType(MAV_AUTOPILOT_PX4);
+    _mockLink->setMissionItemFailureMode(MockLinkMissionItemHandler::FailNone);
+
+    // The cache is keyed by the uid MockLink reports in AUTOPILOT_VERSION
+    Vehicle* vehicle = qgcApp()->toolbox()->multiVehicleManager()->activeVehicle();
+    QVERIFY(vehicle->uid() != 0);
+    QString cacheFileName = _missionManager->missionCacheFile();
+    QVERIFY(QFileInfo(cacheFileName).fileName().contains(QString::number(vehicle->uid(), 16)));
+
+    QList<MissionItem*> missionItems;
+    _createTestItems(missionItems);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+
+    // Home position is not sent to PX4
+    int vehicleItemCount = missionItems.count() - 1;
+
+    // Writing the mission caches it
+    _writeItemList(missionItems, false);
+    QVERIFY(QFile::exists(cacheFileName));
+
+    // Without the cache every item is read
+    QVERIFY(QFile::remove(cacheFileName));
+
+    int readCount = _mockLink->missionItemReadCount();
+    _readItems();
+    QCOMPARE(_mockLink->missionItemReadCount() - readCount, vehicleItemCount);
+
+    // Unchanged mission only reads the first, middle and last items, the rest comes from the cache
+    QList<int> checkIndices;
+    checkIndices << 0;
+    if (!checkIndices.contains(vehicleItemCount / 2)) {
+        checkIndices << vehicleItemCount / 2;
+    }
+    if (!checkIndices.contains(vehicleItemCount - 1)) {
+        checkIndices << vehicleItemCount - 1;
+    }
+    QVERIFY(checkIndices.count() < vehicleItemCount);
+
+    readCount = _mockLink->missionItemReadCount();
+    _readItems();
+    QCOMPARE(_mockLink->missionItemReadCount() - readCount, checkIndices.count());
+    QCOMPARE(_missionManager->missionItems().count(), vehicleItemCount);
+    for (int i=0; i<vehicleItemCount; i++) {
+        MissionItem* actual = _missionManager->missionItems()[i];
+        MissionItem* expected = missionItems[i + 1];
+        QCOMPARE(actual->sequenceNumber(), i);
+        QCOMPARE((int)actual->command(), (int)expected->command());
+        QCOMPARE(actual->param1(), expected->param1());
+        QCOMPARE(actual->coordinate(), expected->coordinate());
+    }
+
+    // Nothing else is read once the mission is available
+    QTest::qWait(MissionManager::_ackTimeoutMilliseconds);
+    QCOMPARE(_mockLink->missionItemReadCount() - readCount, checkIndices.count());
+    QVERIFY(!_missionManager->inProgress());
+
+    // Mission changed on the vehicle since it was cached. Change the middle item, then put the old cache back.
+    QFile cacheFile(cacheFileName);
+    QVERIFY(cacheFile.open(QIODevice::ReadOnly));
+    QByteArray cache = cacheFile.readAll();
+    cacheFile.close();
+
+    int changedIndex = vehicleItemCount / 2;
+    missionItems[changedIndex + 1]->setParam1(missionItems[changedIndex + 1]->param1() + 1);
+    _writeItemList(missionItems, false);
+
+    QVERIFY(cacheFile.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    cacheFile.write(cache);
+    cacheFile.close();
+
+    // The spot check finds the changed item, the items which were not checked are then read as well
+    readCount = _mockLink->missionItemReadCount();
+    _readItems();
+    QCOMPARE(_mockLink->missionItemReadCount() - readCount, vehicleItemCount);
+    QCOMPARE(_missionManager->missionItems().count(), vehicleItemCount);
+    for (int i=0; i<vehicleItemCount; i++) {
+        QCOMPARE(_missionManager->missionItems()[i]->sequenceNumber(), i);
+    }
+    QCOMPARE(_missionManager->missionItems()[changedIndex]->param1(), missionItems[changedIndex + 1]->param1());
+}
@@ -31,10 +31,15 @@ private slots:
     void _testWriteFailureHandlingAPM(void);
     void _testReadFailureHandlingPX4(void);
     void _testReadFailureHandlingAPM(void);
+    void _testPartialWriteAPM(void);
+    void _testMissionCachePX4(void);
 
 private:
     void _roundTripItems(MockLinkMissionItemHandler::FailureMode_t failureMode, bool shouldFail);
+    void _createTestItems(QList<MissionItem*>& missionItems);
     void _writeItems(MockLinkMissionItemHandler::FailureMode_t failureMode, bool shouldFail);
+    void _writeItemList(const QList<MissionItem*>& missionItems, bool shouldFail);
+    void _readItems(void);
     void _testWriteFailureHandlingWorker(void);
     void _testReadFailureHandlingWorker(void);
     
@@ -20,8 +20,11 @@ PlanElementController::PlanElementController(PlanMasterController* masterControl
     , _controllerVehicle(masterController->controllerVehicle())
     , _managerVehicle(masterController->managerVehicle())
     , _editMode(false)
+    , _recalcCount(0)
 {
-
+    _recalcTimer.setSingleShot(true);
+    _recalcTimer.setInterval(0);
+    connect(&_recalcTimer, &QTimer::timeout, this, &PlanElementController::_recalcTimeout);
 }
 
 PlanElementController::~PlanElementController()
@@ -38,3 +41,24 @@ void PlanElementController::managerVehicleChanged(Vehicle* managerVehicle)
 {
     _managerVehicle = managerVehicle;
 }
+
+void PlanElementController::_queueRecalc(void)
+{
+    if (!_recalcTimer.isActive()) {
+        _recalcTimer.start();
+    }
+}
+
+void PlanElementController::_flushRecalc(void)
+{
+    if (_recalcTimer.isActive()) {
+        _recalcTimer.stop();
+        _recalcTimeout();
+    }
+}
+
+void PlanElementController::_recalcTimeout(void)
+{
+    _recalcCount++;
+    _recalc();
+}
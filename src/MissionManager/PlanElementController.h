@@ -11,6 +11,7 @@
 #define PlanElementController_H
 
 #include <QObject>
+#include <QTimer>
 
 #include "Vehicle.h"
 #include "MultiVehicleManager.h"
@@ -57,6 +58,10 @@ public:
     /// Called when a new manager vehicle has been set.
     virtual void managerVehicleChanged(Vehicle* managerVehicle) = 0;
 
+    /// @return Number of queued recalculations which have been performed. Used by unit tests to verify that batch edits
+    /// only cause a single recalculation.
+    int recalcCount(void) const { return _recalcCount; }
+
 signals:
     void containsItemsChanged   (bool containsItems);
     void syncInProgressChanged  (bool syncInProgress);
@@ -66,10 +71,30 @@ signals:
     void removeAllComplete      (void);
 
 protected:
+    /// Queues a call to _recalc once control returns to the event loop. Any number of calls before then result in a
+    /// single _recalc, so editing many items at once does not recalculate once per item.
+    void _queueRecalc(void);
+
+    /// Calls _recalc immediately if one is queued
+    void _flushRecalc(void);
+
+    /// Cancels a queued _recalc. Used when the derived class recalculated everything itself.
+    void _cancelRecalc(void) { _recalcTimer.stop(); }
+
+    /// Recalculates the values which were marked dirty before _queueRecalc was called
+    virtual void _recalc(void) { }
+
     PlanMasterController*   _masterController;
     Vehicle*                _controllerVehicle;
     Vehicle*                _managerVehicle;
     bool                    _editMode;
+
+private slots:
+    void _recalcTimeout(void);
+
+private:
+    QTimer  _recalcTimer;
+    int     _recalcCount;
 };
 
 #endif
@@ -13,9 +13,10 @@
 #include "SettingsManager.h"
 #include "AppSettings.h"
 #include "JsonHelper.h"
+#include "JsonStreamReader.h"
+#include "JsonStreamWriter.h"
 #include "MissionManager.h"
 
-#include <QJsonDocument>
 #include <QFileInfo>
 
 QGC_LOGGING_CATEGORY(PlanMasterControllerLog, "PlanMasterControllerLog")
@@ -265,16 +266,34 @@ void PlanMasterController::loadFromFile(const QString& filename)
 
     QString fileExtension(".%1");
     if (filename.endsWith(fileExtension.arg(AppSettings::planFileExtension))) {
-        QJsonDocument   jsonDoc;
-        QByteArray      bytes = file.readAll();
+        // The mission is by far the largest part of a plan, so its items are left in the file until they are loaded
+        JsonStreamReader            reader(file);
+        JsonStreamReader::Members_t members;
+        QJsonObject                 json;
 
-        if (!JsonHelper::isJsonFile(bytes, jsonDoc, errorString)) {
+        if (!reader.objectMembers(reader.document(), members, errorString) ||
+                !reader.objectExcept(members, QStringList(_jsonMissionObjectKey), json, errorString)) {
             qgcApp()->showMessage(errorMessage.arg(errorString));
             return;
         }
 
+        JsonStreamReader::Span_t missionSpan = { 0, 0 };
+        for (int i=0; i<members.count(); i++) {
+            if (members[i].first == _jsonMissionObjectKey) {
+                missionSpan = members[i].second;
+                if (reader.isObject(missionSpan)) {
+                    json[_jsonMissionObjectKey] = QJsonObject();
+                } else {
+                    // Let key validation report the bad type
+                    QJsonValue missionValue;
+                    if (reader.value(missionSpan, missionValue, errorString)) {
+                        json[_jsonMissionObjectKey] = missionValue;
+                    }
+                }
+            }
+        }
+
         int version;
-        QJsonObject json = jsonDoc.object();
         if (!JsonHelper::validateQGCJsonFile(json, _planFileType, _planFileVersion, _planFileVersion, version, errorString)) {
             qgcApp()->showMessage(errorMessage.arg(errorString));
             return;
@@ -290,7 +309,7 @@ void PlanMasterController::loadFromFile(const QString& filename)
             return;
         }
 
-        if (!_missionController.load(json[_jsonMissionObjectKey].toObject(), errorString) ||
+        if (!_missionController.load(reader, missionSpan, errorString) ||
                 !_geoFenceController.load(json[_jsonGeoFenceObjectKey].toObject(), errorString) ||
                 !_rallyPointController.load(json[_jsonRallyPointsObjectKey].toObject(), errorString)) {
             qgcApp()->showMessage(errorMessage.arg(errorString));
@@ -327,21 +346,29 @@ void PlanMasterController::saveToFile(const QString& filename)
     if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
         qgcApp()->showMessage(tr("Plan save error %1 : %2").arg(filename).arg(file.errorString()));
     } else {
-        QJsonObject planJson;
-        QJsonObject missionJson;
-        QJsonObject fenceJson;
-        QJsonObject rallyJson;
+        QJsonObject         planJson;
+        QJsonObject         fenceJson;
+        QJsonObject         rallyJson;
+        JsonStreamWriter    writer(&file);
 
         JsonHelper::saveQGCJsonFileHeader(planJson, _planFileType, _planFileVersion);
-        _missionController.save(missionJson);
         _geoFenceController.save(fenceJson);
         _rallyPointController.save(rallyJson);
-        planJson[_jsonMissionObjectKey] = missionJson;
         planJson[_jsonGeoFenceObjectKey] = fenceJson;
         planJson[_jsonRallyPointsObjectKey] = rallyJson;
 
-        QJsonDocument saveDoc(planJson);
-        file.write(saveDoc.toJson());
+        // The mission is written item by item straight to the file
+        writer.beginObject();
+        writer.writeMembers(planJson);
+        writer.writeKey(_jsonMissionObjectKey);
+        writer.beginObject();
+        _missionController.save(writer);
+        writer.endObject();
+        writer.endObject();
+
+        if (!writer.ok()) {
+            qgcApp()->showMessage(tr("Plan save error %1 : %2").arg(filename).arg(file.errorString()));
+        }
     }
 
     // Only clear dirty bit if we are offline
@@ -15,6 +15,13 @@
 #include "QGCApplication.h"
 #include "SettingsManager.h"
 #include "AppSettings.h"
+#include "JsonHelper.h"
+#include "JsonStreamWriter.h"
+
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QTextStream>
 
 PlanMasterControllerTest::PlanMasterControllerTest(void)
     : _masterController(NULL)
@@ -50,3 +57,160 @@ void PlanMasterControllerTest::_testMissionPlannerFileLoad(void)
     _masterController->loadFromFile(":/unittest/MissionPlanner.waypoints");
     QCOMPARE(_masterController->missionController()->visualItems()->count(), 6);
 }
+
+/// Adding many geofence vertices or rally points at once must only cause a single recalculation
+void PlanMasterControllerTest::_testRecalcCoalesced(void)
+{
+    GeoFenceController*     geoFenceController =    _masterController->geoFenceController();
+    RallyPointController*   rallyPointController =  _masterController->rallyPointController();
+    QGeoCoordinate          coordinate(37.803784, -122.462276);
+
+    QTest::qWait(100);
+    int geoFenceRecalcCount =   geoFenceController->recalcCount();
+    int rallyPointRecalcCount = rallyPointController->recalcCount();
+
+    for (int i=0; i<20; i++) {
+        geoFenceController->mapPolygon()->appendVertex(coordinate.atDistanceAndAzimuth(100, i * 18));
+        rallyPointController->addPoint(coordinate.atDistanceAndAzimuth(50, i * 18));
+    }
+    QCOMPARE(geoFenceController->recalcCount(), geoFenceRecalcCount);
+    QCOMPARE(rallyPointController->recalcCount(), rallyPointRecalcCount);
+
+    QTRY_COMPARE(geoFenceController->recalcCount(), geoFenceRecalcCount + 1);
+    QTRY_COMPARE(rallyPointController->recalcCount(), rallyPointRecalcCount + 1);
+    QTest::qWait(100);
+    QCOMPARE(geoFenceController->recalcCount(), geoFenceRecalcCount + 1);
+    QCOMPARE(rallyPointController->recalcCount(), rallyPointRecalcCount + 1);
+
+    QCOMPARE(geoFenceController->containsItems(), true);
+    QCOMPARE(rallyPointController->containsItems(), true);
+}
+
+/// Writes a plan with the specified number of waypoints in the mission
+void PlanMasterControllerTest::_writePlan(const QString& filename, int itemCount)
+{
+    QFile file(filename);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Text));
+
+    QJsonObject planJson;
+    QJsonObject fenceJson;
+    QJsonObject rallyJson;
+    JsonHelper::saveQGCJsonFileHeader(planJson, "Plan", 1);
+    _masterController->geoFenceController()->save(fenceJson);
+    _masterController->rallyPointController()->save(rallyJson);
+    planJson["geoFence"] = fenceJson;
+    planJson["rallyPoints"] = rallyJson;
+
+    QGeoCoordinate  homeCoordinate(37.803784, -122.462276, 10);
+    QJsonValue      homeValue;
+    QJsonObject     missionJson;
+    JsonHelper::saveGeoCoordinate(homeCoordinate, true /* writeAltitude */, homeValue);
+    missionJson["version"] = 2;
+    missionJson["firmwareType"] = MAV_AUTOPILOT_PX4;
+    missionJson["plannedHomePosition"] = homeValue;
+
+    JsonStreamWriter writer(&file);
+    writer.beginObject();
+    writer.writeMembers(planJson);
+    writer.writeKey("mission");
+    writer.beginObject();
+    writer.writeMembers(missionJson);
+    writer.writeKey("items");
+    writer.beginArray();
+    for (int i=0; i<itemCount; i++) {
+        QGeoCoordinate  coordinate = homeCoordinate.atDistanceAndAzimuth((i / 100) * 20, (i % 100) * 3.6);
+        MissionItem     missionItem(i + 1, MAV_CMD_NAV_WAYPOINT, MAV_FRAME_GLOBAL_RELATIVE_ALT, 0, 0, 0, 0, coordinate.latitude(), coordinate.longitude(), 50, true /* autoContinue */, false /* isCurrentItem */);
+        QJsonObject     itemJson;
+
+        missionItem.save(itemJson);
+        writer.writeValue(itemJson);
+    }
+    writer.endArray();
+    writer.endObject();
+    writer.endObject();
+
+    QVERIFY(writer.ok());
+}
+
+/// @return Peak resident memory of the process, where the platform reports it
+QString PlanMasterControllerTest::_peakMemory(void)
+{
+    QFile file(QStringLiteral("/proc/self/status"));
+
+    if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        QTextStream stream(&file);
+        while (!stream.atEnd()) {
+            QString line = stream.readLine();
+            if (line.startsWith(QStringLiteral("VmHWM:"))) {
+                return line.mid(6).trimmed();
+            }
+        }
+    }
+
+    return QStringLiteral("unknown");
+}
+
+/// Round trips a plan with the specified number of waypoints through the streaming load and save. The saved plan must
+/// load back the same.
+///     @param benchmark true: log timings and peak memory
+void PlanMasterControllerTest::_roundTripPlan(int itemCount, bool benchmark)
+{
+    QTemporaryDir   tempDir;
+    QString         loadFilename = tempDir.filePath(QStringLiteral("plan.plan"));
+    QString         saveFilename = tempDir.filePath(QStringLiteral("plan-saved.plan"));
+    QElapsedTimer   timer;
+
+    QVERIFY(tempDir.isValid());
+    _writePlan(loadFilename, itemCount);
+    if (benchmark) {
+        qDebug() << "Large plan file size" << QFileInfo(loadFilename).size() << "peak memory before load" << _peakMemory();
+    }
+
+    timer.start();
+    _masterController->loadFromFile(loadFilename);
+    if (benchmark) {
+        qDebug() << "Loading" << itemCount << "items took" << timer.elapsed() << "msecs, peak memory" << _peakMemory();
+    }
+
+    QmlObjectListModel* visualItems = _masterController->missionController()->visualItems();
+    QCOMPARE(visualItems->count(), itemCount + 1);
+    QCOMPARE(visualItems->value<VisualMissionItem*>(itemCount)->sequenceNumber(), itemCount);
+
+    QStringList             commandNames;
+    QList<QGeoCoordinate>   coordinates;
+    for (int i=1; i<visualItems->count(); i++) {
+        commandNames.append(visualItems->value<VisualMissionItem*>(i)->commandName());
+        coordinates.append(visualItems->value<VisualMissionItem*>(i)->coordinate());
+    }
+
+    timer.restart();
+    _masterController->saveToFile(saveFilename);
+    if (benchmark) {
+        qDebug() << "Saving" << itemCount << "items took" << timer.elapsed() << "msecs, peak memory" << _peakMemory();
+    }
+
+    _masterController->loadFromFile(saveFilename);
+    visualItems = _masterController->missionController()->visualItems();
+    QCOMPARE(visualItems->count(), itemCount + 1);
+    for (int i=1; i<visualItems->count(); i++) {
+        VisualMissionItem* item = visualItems->value<VisualMissionItem*>(i);
+        QCOMPARE(item->sequenceNumber(), i);
+        QCOMPARE(item->commandName(), commandNames[i - 1]);
+        QCOMPARE(item->coordinate(), coordinates[i - 1]);
+    }
+}
+
+void PlanMasterControllerTest::_testPlanLoadSave(void)
+{
+    _roundTripPlan(50, false /* benchmark */);
+}
+
+/// Round trips a 20k item plan. Only runs when large benchmarks are enabled, see UnitTest::largeBenchmarksEnabled.
+void PlanMasterControllerTest::_testLargePlanLoadSave(void)
+{
+    if (!largeBenchmarksEnabled()) {
+        QSKIP("Set QGC_UNITTEST_BENCHMARKS to run the large plan load and save benchmark");
+    }
+
+    _roundTripPlan(20000, true /* benchmark */);
+}
@@ -33,7 +33,14 @@ private slots:
 
     void _testMissionFileLoad(void);
     void _testMissionPlannerFileLoad(void);
+    void _testRecalcCoalesced(void);
+    void _testPlanLoadSave(void);
+    void _testLargePlanLoadSave(void);
 
 private:
+    void    _writePlan      (const QString& filename, int itemCount);
+    QString _peakMemory     (void);
+    void    _roundTripPlan  (int itemCount, bool benchmark);
+
     PlanMasterController*   _masterController;
 };
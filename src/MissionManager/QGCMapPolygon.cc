@@ -24,10 +24,15 @@ QGCMapPolygon::QGCMapPolygon(QObject* newCoordParent, QObject* parent)
     , _dirty(false)
     , _centerDrag(false)
     , _ignoreCenterUpdates(false)
+    , _containsIndexCacheValid(false)
 {
     connect(&_polygonModel, &QmlObjectListModel::dirtyChanged, this, &QGCMapPolygon::_polygonModelDirtyChanged);
     connect(&_polygonModel, &QmlObjectListModel::countChanged, this, &QGCMapPolygon::_polygonModelCountChanged);
     connect(&_polygonModel, &QmlObjectListModel::countChanged, this, &QGCMapPolygon::_updateCenter);
+
+    // Any path change invalidates the index used for containment checks
+    connect(this, &QGCMapPolygon::pathChanged,  this, &QGCMapPolygon::_invalidateContainsIndex);
+    connect(this, &QGCMapPolygon::cleared,      this, &QGCMapPolygon::_invalidateContainsIndex);
 }
 
 void QGCMapPolygon::clear(void)
@@ -54,6 +59,7 @@ void QGCMapPolygon::clear(void)
 void QGCMapPolygon::adjustVertex(int vertexIndex, const QGeoCoordinate coordinate)
 {
     _polygonPath[vertexIndex] = QVariant::fromValue(coordinate);
+    _invalidateContainsIndex();
     if (!_centerDrag) {
         // When dragging center we don't signal path changed until add vertices are updated
         emit pathChanged();
@@ -109,21 +115,55 @@ QPolygonF QGCMapPolygon::_toPolygonF(void) const
     QPolygonF polygon;
 
     if (_polygonPath.count() > 2) {
-        for (int i=0; i<_polygonPath.count(); i++) {
-            polygon.append(_pointFFromCoord(_polygonPath[i].value<QGeoCoordinate>()));
+        int             count = _polygonPath.count();
+        QVector<double> latitudes(count);
+        QVector<double> longitudes(count);
+        QVector<double> north(count);
+        QVector<double> east(count);
+
+        for (int i=0; i<count; i++) {
+            QGeoCoordinate vertex = _polygonPath[i].value<QGeoCoordinate>();
+            latitudes[i] = vertex.latitude();
+            longitudes[i] = vertex.longitude();
+        }
+
+        // Same projection as _pointFFromCoord, with the tangent origin set up once for all vertices
+        GeoOrigin_t tangentOrigin = geoOrigin(_polygonPath[0].value<QGeoCoordinate>());
+        convertGeoToNed(latitudes.constData(), longitudes.constData(), count, tangentOrigin, north.data(), east.data());
+
+        polygon.reserve(count);
+        for (int i=0; i<count; i++) {
+            polygon.append(QPointF(east[i], -north[i]));
         }
     }
 
     return polygon;
 }
 
-bool QGCMapPolygon::containsCoordinate(const QGeoCoordinate& coordinate) const
+void QGCMapPolygon::_invalidateContainsIndex(void)
 {
-    if (_polygonPath.count() > 2) {
-        return _toPolygonF().containsPoint(_pointFFromCoord(coordinate), Qt::OddEvenFill);
-    } else {
-        return false;
+    _containsIndexCacheValid = false;
+}
+
+const GeoFenceIndex& QGCMapPolygon::_containsIndex(void) const
+{
+    if (!_containsIndexCacheValid) {
+        _containsIndexCache.clear();
+        _containsIndexCache.addPolygon(coordinateList());
+        _containsIndexCacheValid = true;
     }
+
+    return _containsIndexCache;
+}
+
+bool QGCMapPolygon::containsCoordinate(const QGeoCoordinate& coordinate) const
+{
+    return _containsIndex().contains(0, coordinate);
+}
+
+QVector<bool> QGCMapPolygon::containsCoordinates(const QList<QGeoCoordinate>& coordinates) const
+{
+    return _containsIndex().contains(0, coordinates);
 }
 
 void QGCMapPolygon::setPath(const QList<QGeoCoordinate>& path)
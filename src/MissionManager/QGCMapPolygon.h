@@ -16,6 +16,7 @@
 #include <QPolygon>
 
 #include "QmlObjectListModel.h"
+#include "GeoFenceIndex.h"
 
 /// The QGCMapPolygon class provides a polygon which can be displayed on a map using a map visuals control.
 /// It maintains a representation of the polygon on QVariantList and QmlObjectListModel format.
@@ -48,6 +49,9 @@ public:
     /// Returns true if the specified coordinate is within the polygon
     Q_INVOKABLE bool containsCoordinate(const QGeoCoordinate& coordinate) const;
 
+    /// Batch version of containsCoordinate
+    QVector<bool> containsCoordinates(const QList<QGeoCoordinate>& coordinates) const;
+
     /// Returns the path in a list of QGeoCoordinate's format
     QList<QGeoCoordinate> coordinateList(void) const;
 
@@ -93,11 +97,13 @@ private slots:
     void _polygonModelCountChanged(int count);
     void _polygonModelDirtyChanged(bool dirty);
     void _updateCenter(void);
+    void _invalidateContainsIndex(void);
 
 private:
     QPolygonF _toPolygonF(void) const;
     QGeoCoordinate _coordFromPointF(const QPointF& point) const;
     QPointF _pointFFromCoord(const QGeoCoordinate& coordinate) const;
+    const GeoFenceIndex& _containsIndex(void) const;
 
     QObject*            _newCoordParent;
     QVariantList        _polygonPath;
@@ -106,6 +112,9 @@ private:
     QGeoCoordinate      _center;
     bool                _centerDrag;
     bool                _ignoreCenterUpdates;
+
+    mutable GeoFenceIndex   _containsIndexCache;        ///< Built on first containment check after the path changes
+    mutable bool            _containsIndexCacheValid;
 };
 
 #endif
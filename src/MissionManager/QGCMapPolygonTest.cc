@@ -10,6 +10,11 @@
 #include "QGCMapPolygonTest.h"
 #include "QGCApplication.h"
 #include "QGCQGeoCoordinate.h"
+#include "GeoFenceIndex.h"
+#include "QGCGeo.h"
+
+#include <QElapsedTimer>
+#include <QPolygonF>
 
 QGCMapPolygonTest::QGCMapPolygonTest(void)
 {
@@ -197,3 +202,126 @@ void QGCMapPolygonTest::_testVertexManipulation(void)
     QCOMPARE(polyList.count(), 0);
     QCOMPARE(_pathModel->count(), 0);
 }
+
+void QGCMapPolygonTest::_testContainsCoordinate(void)
+{
+    _mapPolygon->setPath(_polyPoints);
+
+    QGeoCoordinate center = _mapPolygon->center();
+    QGeoCoordinate outside(47.64, -122.09);
+    QVERIFY(_mapPolygon->containsCoordinate(center));
+    QVERIFY(!_mapPolygon->containsCoordinate(outside));
+
+    QList<QGeoCoordinate> coords;
+    coords << center << outside;
+    QVector<bool> results = _mapPolygon->containsCoordinates(coords);
+    QCOMPARE(results.count(), 2);
+    QCOMPARE(results[0], true);
+    QCOMPARE(results[1], false);
+
+    // Moving a vertex must be picked up by the next check
+    _mapPolygon->adjustVertex(0, QGeoCoordinate(47.645, -122.09269407980834));
+    QVERIFY(_mapPolygon->containsCoordinate(outside));
+
+    // Moving the whole polygon through a center drag
+    _mapPolygon->setCenterDrag(true);
+    _mapPolygon->setCenter(center.atDistanceAndAzimuth(5000, 90));
+    _mapPolygon->setCenterDrag(false);
+    QVERIFY(!_mapPolygon->containsCoordinate(center));
+
+    _mapPolygon->clear();
+    QVERIFY(!_mapPolygon->containsCoordinate(center));
+}
+
+void QGCMapPolygonTest::_testFenceIndex(void)
+{
+    // Concave polygon, checked against QPolygonF on the same tangent plane
+    QList<QGeoCoordinate> polygon;
+    QGeoCoordinate origin(47.63, -122.09);
+    polygon << origin <<
+               origin.atDistanceAndAzimuth(1000, 0) <<
+               origin.atDistanceAndAzimuth(1000, 45).atDistanceAndAzimuth(500, 180) <<
+               origin.atDistanceAndAzimuth(1000, 90);
+
+    QPolygonF referencePolygon;
+    for (int i=0; i<polygon.count(); i++) {
+        double north, east, down;
+        convertGeoToNed(polygon[i], origin, &north, &east, &down);
+        referencePolygon.append(QPointF(east, north));
+    }
+
+    GeoFenceIndex index;
+    int polygonFence = index.addPolygon(polygon);
+    QList<QGeoCoordinate> coords;
+    QGeoCoordinate gridOrigin = origin.atDistanceAndAzimuth(100, 180).atDistanceAndAzimuth(100, 270);
+    for (int x=0; x<40; x++) {
+        for (int y=0; y<40; y++) {
+            coords.append(gridOrigin.atDistanceAndAzimuth(0.1 + (x * 30), 90).atDistanceAndAzimuth(0.1 + (y * 30), 0));
+        }
+    }
+    QVector<bool> results = index.contains(polygonFence, coords);
+    for (int i=0; i<coords.count(); i++) {
+        double north, east, down;
+        convertGeoToNed(coords[i], origin, &north, &east, &down);
+        QCOMPARE(results[i], referencePolygon.containsPoint(QPointF(east, north), Qt::OddEvenFill));
+    }
+
+    // Circle
+    QGeoCoordinate circleCenter = origin.atDistanceAndAzimuth(1000, 90);
+    int circleFence = index.addCircle(circleCenter, 300);
+    QVERIFY(index.contains(circleFence, circleCenter.atDistanceAndAzimuth(290, 30)));
+    QVERIFY(!index.contains(circleFence, circleCenter.atDistanceAndAzimuth(310, 30)));
+
+    QGeoCoordinate insideBoth = origin.atDistanceAndAzimuth(800, 90).atDistanceAndAzimuth(50, 0);
+    QVERIFY(index.contains(polygonFence, insideBoth));
+    QVERIFY(index.insideAll(insideBoth));
+    QCOMPARE(index.fencesContaining(insideBoth).count(), 2);
+    QCOMPARE(index.fencesContaining(circleCenter.atDistanceAndAzimuth(100, 180)), QVector<int>() << circleFence);
+    QVERIFY(!index.insideAll(origin.atDistanceAndAzimuth(50, 45)));
+
+    // Degenerate polygon never contains anything
+    QCOMPARE(index.contains(index.addPolygon(polygon.mid(0, 2)), origin), false);
+
+    // Large fence far north. Its edges are straight on the tangent plane and curve well outside the lat/lon range of
+    // the vertices, so points near them must not be rejected by the bounding box.
+    QGeoCoordinate northOrigin(70, 10);
+    QPolygonF northReference;
+    northReference << QPointF(0, 0) << QPointF(800000, 0) << QPointF(800000, 800000) << QPointF(-800000, 800000) << QPointF(-800000, 0);
+    QList<QGeoCoordinate> northPolygon;
+    double maxVertexLat = -90;
+    for (int i=0; i<northReference.count(); i++) {
+        QGeoCoordinate vertex;
+        convertNedToGeo(northReference[i].y(), northReference[i].x(), 0, northOrigin, &vertex);
+        northPolygon.append(vertex);
+        maxVertexLat = qMax(maxVertexLat, vertex.latitude());
+    }
+    GeoFenceIndex northIndex;
+    int northFence = northIndex.addPolygon(northPolygon);
+    int edgeHits = 0;
+    for (int x=-810; x<=810; x+=20) {
+        for (int y=-10; y<=810; y+=20) {
+            QGeoCoordinate coord;
+            convertNedToGeo(y * 1000.0, x * 1000.0, 0, northOrigin, &coord);
+            bool expected = northReference.containsPoint(QPointF(x * 1000.0, y * 1000.0), Qt::OddEvenFill);
+            QCOMPARE(northIndex.contains(northFence, coord), expected);
+            if (expected && coord.latitude() > maxVertexLat) {
+                edgeHits++;
+            }
+        }
+    }
+    // Make sure some inside points really were outside the lat/lon range of the vertices
+    QVERIFY(edgeHits > 0);
+
+    // Timing with a large polygon
+    QList<QGeoCoordinate> circlePolygon;
+    for (int i=0; i<1000; i++) {
+        circlePolygon.append(origin.atDistanceAndAzimuth(1000 + ((i % 2) * 100), i * 0.36));
+    }
+    GeoFenceIndex largeIndex;
+    largeIndex.addPolygon(circlePolygon);
+    QElapsedTimer timer;
+    timer.start();
+    QVector<bool> largeResults = largeIndex.insideAll(coords);
+    qDebug() << "Checked" << coords.count() << "coordinates against" << circlePolygon.count() << "vertex polygon in" << timer.nsecsElapsed() / 1000 << "usecs";
+    QCOMPARE(largeResults.count(), coords.count());
+}
@@ -29,6 +29,8 @@ protected:
 private slots:
     void _testDirty(void);
     void _testVertexManipulation(void);
+    void _testContainsCoordinate(void);
+    void _testFenceIndex(void);
 
 private:
     enum {
@@ -277,6 +277,12 @@ bool RallyPointController::containsItems(void) const
 }
 
 void RallyPointController::_updateContainsItems(void)
+{
+    // Points are added and removed one at a time, only signal once they are done
+    _queueRecalc();
+}
+
+void RallyPointController::_recalc(void)
 {
     emit containsItemsChanged(containsItems());
 }
@@ -70,6 +70,8 @@ private slots:
     void _updateContainsItems(void);
 
 private:
+    void _recalc(void) final;
+
     RallyPointManager*  _rallyPointManager;
     bool                _dirty;
     QmlObjectListModel  _points;
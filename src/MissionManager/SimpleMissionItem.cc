@@ -55,21 +55,16 @@ SimpleMissionItem::SimpleMissionItem(Vehicle* vehicle, QObject* parent)
     , _speedSection(NULL)
     , _cameraSection(NULL)
     , _commandTree(qgcApp()->toolbox()->missionCommandTree())
-    , _altitudeRelativeToHomeFact   (0, "Altitude is relative to home", FactMetaData::valueTypeUint32)
-    , _supportedCommandFact         (0, "Command:",                     FactMetaData::valueTypeUint32)
-    , _param1MetaData(FactMetaData::valueTypeDouble)
-    , _param2MetaData(FactMetaData::valueTypeDouble)
-    , _param3MetaData(FactMetaData::valueTypeDouble)
-    , _param4MetaData(FactMetaData::valueTypeDouble)
-    , _param5MetaData(FactMetaData::valueTypeDouble)
-    , _param6MetaData(FactMetaData::valueTypeDouble)
-    , _param7MetaData(FactMetaData::valueTypeDouble)
+    , _editorFactsCreated(false)
+    , _altitudeRelativeToHomeFact(NULL)
     , _syncingAltitudeRelativeToHomeAndFrame    (false)
     , _syncingHeadingDegreesAndParam4           (false)
 {
     _editorQml = QStringLiteral("qrc:/qml/SimpleItemEditor.qml");
 
-    _altitudeRelativeToHomeFact.setRawValue(true);
+    for (int i=0; i<7; i++) {
+        _paramMetaData[i] = NULL;
+    }
 
     _setupMetaData();
     _connectSignals();
@@ -94,21 +89,16 @@ SimpleMissionItem::SimpleMissionItem(Vehicle* vehicle, const MissionItem& missio
     , _speedSection(NULL)
     , _cameraSection(NULL)
     , _commandTree(qgcApp()->toolbox()->missionCommandTree())
-    , _altitudeRelativeToHomeFact   (0, "Altitude is relative to home", FactMetaData::valueTypeUint32)
-    , _supportedCommandFact         (0, "Command:",                     FactMetaData::valueTypeUint32)
-    , _param1MetaData(FactMetaData::valueTypeDouble)
-    , _param2MetaData(FactMetaData::valueTypeDouble)
-    , _param3MetaData(FactMetaData::valueTypeDouble)
-    , _param4MetaData(FactMetaData::valueTypeDouble)
-    , _param5MetaData(FactMetaData::valueTypeDouble)
-    , _param6MetaData(FactMetaData::valueTypeDouble)
-    , _param7MetaData(FactMetaData::valueTypeDouble)
+    , _editorFactsCreated(false)
+    , _altitudeRelativeToHomeFact(NULL)
     , _syncingAltitudeRelativeToHomeAndFrame    (false)
     , _syncingHeadingDegreesAndParam4           (false)
 {
     _editorQml = QStringLiteral("qrc:/qml/SimpleItemEditor.qml");
 
-    _altitudeRelativeToHomeFact.setRawValue(true);
+    for (int i=0; i<7; i++) {
+        _paramMetaData[i] = NULL;
+    }
     _isCurrentItem = missionItem.isCurrentItem();
 
     _setupMetaData();
@@ -127,17 +117,17 @@ SimpleMissionItem::SimpleMissionItem(const SimpleMissionItem& other, QObject* pa
     , _speedSection(NULL)
     , _cameraSection(NULL)
     , _commandTree(qgcApp()->toolbox()->missionCommandTree())
-    , _altitudeRelativeToHomeFact   (0, "Altitude is relative to home", FactMetaData::valueTypeUint32)
-    , _supportedCommandFact         (0, "Command:",                     FactMetaData::valueTypeUint32)
-    , _param1MetaData(FactMetaData::valueTypeDouble)
-    , _param2MetaData(FactMetaData::valueTypeDouble)
-    , _param3MetaData(FactMetaData::valueTypeDouble)
-    , _param4MetaData(FactMetaData::valueTypeDouble)
+    , _editorFactsCreated(false)
+    , _altitudeRelativeToHomeFact(NULL)
     , _syncingAltitudeRelativeToHomeAndFrame    (false)
     , _syncingHeadingDegreesAndParam4           (false)
 {
     _editorQml = QStringLiteral("qrc:/qml/SimpleItemEditor.qml");
 
+    for (int i=0; i<7; i++) {
+        _paramMetaData[i] = NULL;
+    }
+
     _setupMetaData();
     _connectSignals();
     _updateOptionalSections();
@@ -163,47 +153,35 @@ const SimpleMissionItem& SimpleMissionItem::operator=(const SimpleMissionItem& o
 void SimpleMissionItem::_connectSignals(void)
 {
     // Connect to change signals to track dirty state
-    connect(&_missionItem._param1Fact,  &Fact::valueChanged,                    this, &SimpleMissionItem::_setDirtyFromSignal);
-    connect(&_missionItem._param2Fact,  &Fact::valueChanged,                    this, &SimpleMissionItem::_setDirtyFromSignal);
-    connect(&_missionItem._param3Fact,  &Fact::valueChanged,                    this, &SimpleMissionItem::_setDirtyFromSignal);
-    connect(&_missionItem._param4Fact,  &Fact::valueChanged,                    this, &SimpleMissionItem::_setDirtyFromSignal);
-    connect(&_missionItem._param5Fact,  &Fact::valueChanged,                    this, &SimpleMissionItem::_setDirtyFromSignal);
-    connect(&_missionItem._param6Fact,  &Fact::valueChanged,                    this, &SimpleMissionItem::_setDirtyFromSignal);
-    connect(&_missionItem._param7Fact,  &Fact::valueChanged,                    this, &SimpleMissionItem::_setDirtyFromSignal);
-    connect(&_missionItem._frameFact,   &Fact::valueChanged,                    this, &SimpleMissionItem::_setDirtyFromSignal);
-    connect(&_missionItem._commandFact, &Fact::valueChanged,                    this, &SimpleMissionItem::_setDirtyFromSignal);
-    connect(&_missionItem,              &MissionItem::sequenceNumberChanged,    this, &SimpleMissionItem::_setDirtyFromSignal);
-
-    // Values from these facts must propagate back and forth between the real object storage
-    connect(&_altitudeRelativeToHomeFact,   &Fact::valueChanged,    this, &SimpleMissionItem::_syncAltitudeRelativeToHomeToFrame);
-    connect(&_missionItem._frameFact,       &Fact::valueChanged,    this, &SimpleMissionItem::_syncFrameToAltitudeRelativeToHome);
+    connect(&_missionItem, &MissionItem::paramChanged,          this, &SimpleMissionItem::_paramChanged);
+    connect(&_missionItem, &MissionItem::frameChanged,          this, &SimpleMissionItem::_setDirtyFromSignal);
+    connect(&_missionItem, &MissionItem::commandChanged,        this, &SimpleMissionItem::_setDirtyFromSignal);
+    connect(&_missionItem, &MissionItem::sequenceNumberChanged, this, &SimpleMissionItem::_setDirtyFromSignal);
 
-    // These are coordinate parameters, they must emit coordinateChanged signal
-    connect(&_missionItem._param5Fact, &Fact::valueChanged, this, &SimpleMissionItem::_sendCoordinateChanged);
-    connect(&_missionItem._param6Fact, &Fact::valueChanged, this, &SimpleMissionItem::_sendCoordinateChanged);
-    connect(&_missionItem._param7Fact, &Fact::valueChanged, this, &SimpleMissionItem::_sendCoordinateChanged);
+    // Values must propagate back and forth between the frame and the altitude relative to home checkbox
+    connect(&_missionItem, &MissionItem::frameChanged, this, &SimpleMissionItem::_syncFrameToAltitudeRelativeToHome);
 
     // The following changes may also change friendlyEditAllowed
-    connect(&_missionItem._autoContinueFact,    &Fact::valueChanged, this, &SimpleMissionItem::_sendFriendlyEditAllowedChanged);
-    connect(&_missionItem._commandFact,         &Fact::valueChanged, this, &SimpleMissionItem::_sendFriendlyEditAllowedChanged);
-    connect(&_missionItem._frameFact,           &Fact::valueChanged, this, &SimpleMissionItem::_sendFriendlyEditAllowedChanged);
+    connect(&_missionItem, &MissionItem::autoContinueChanged,   this, &SimpleMissionItem::_sendFriendlyEditAllowedChanged);
+    connect(&_missionItem, &MissionItem::commandChanged,        this, &SimpleMissionItem::_sendFriendlyEditAllowedChanged);
+    connect(&_missionItem, &MissionItem::frameChanged,          this, &SimpleMissionItem::_sendFriendlyEditAllowedChanged);
 
     // A command change triggers a number of other changes as well.
-    connect(&_missionItem._commandFact, &Fact::valueChanged, this, &SimpleMissionItem::setDefaultsForCommand);
-    connect(&_missionItem._commandFact, &Fact::valueChanged, this, &SimpleMissionItem::commandNameChanged);
-    connect(&_missionItem._commandFact, &Fact::valueChanged, this, &SimpleMissionItem::commandDescriptionChanged);
-    connect(&_missionItem._commandFact, &Fact::valueChanged, this, &SimpleMissionItem::abbreviationChanged);
-    connect(&_missionItem._commandFact, &Fact::valueChanged, this, &SimpleMissionItem::specifiesCoordinateChanged);
-    connect(&_missionItem._commandFact, &Fact::valueChanged, this, &SimpleMissionItem::specifiesAltitudeOnlyChanged);
-    connect(&_missionItem._commandFact, &Fact::valueChanged, this, &SimpleMissionItem::isStandaloneCoordinateChanged);
+    connect(&_missionItem, &MissionItem::commandChanged, this, &SimpleMissionItem::setDefaultsForCommand);
+    connect(&_missionItem, &MissionItem::commandChanged, this, &SimpleMissionItem::commandNameChanged);
+    connect(&_missionItem, &MissionItem::commandChanged, this, &SimpleMissionItem::commandDescriptionChanged);
+    connect(&_missionItem, &MissionItem::commandChanged, this, &SimpleMissionItem::abbreviationChanged);
+    connect(&_missionItem, &MissionItem::commandChanged, this, &SimpleMissionItem::specifiesCoordinateChanged);
+    connect(&_missionItem, &MissionItem::commandChanged, this, &SimpleMissionItem::specifiesAltitudeOnlyChanged);
+    connect(&_missionItem, &MissionItem::commandChanged, this, &SimpleMissionItem::isStandaloneCoordinateChanged);
 
     // Whenever these properties change the ui model changes as well
     connect(this, &SimpleMissionItem::commandChanged, this, &SimpleMissionItem::_rebuildFacts);
     connect(this, &SimpleMissionItem::rawEditChanged, this, &SimpleMissionItem::_rebuildFacts);
 
-    // These fact signals must alway signal out through SimpleMissionItem signals
-    connect(&_missionItem._commandFact,     &Fact::valueChanged, this, &SimpleMissionItem::_sendCommandChanged);
-    connect(&_missionItem._frameFact,       &Fact::valueChanged, this, &SimpleMissionItem::_sendFrameChanged);
+    // These signals must alway signal out through SimpleMissionItem signals
+    connect(&_missionItem, &MissionItem::commandChanged,    this, &SimpleMissionItem::commandChanged);
+    connect(&_missionItem, &MissionItem::frameChanged,      this, &SimpleMissionItem::frameChanged);
 
     // Sequence number is kept in mission iteem, so we need to propagate signal up as well
     connect(&_missionItem, &MissionItem::sequenceNumberChanged, this, &SimpleMissionItem::sequenceNumberChanged);
@@ -252,9 +230,28 @@ void SimpleMissionItem::_setupMetaData(void)
         _longitudeMetaData->setDecimalPlaces(7);
 
     }
+}
 
-    _missionItem._commandFact.setMetaData(_commandMetaData);
-    _missionItem._frameFact.setMetaData(_frameMetaData);
+/// Creates the Facts and meta data used by the editing ui. Items which are never shown in the editor never need them.
+void SimpleMissionItem::_createEditorFacts(void)
+{
+    if (_editorFactsCreated) {
+        return;
+    }
+    _editorFactsCreated = true;
+
+    _altitudeRelativeToHomeFact = new Fact(0, "Altitude is relative to home", FactMetaData::valueTypeUint32, this);
+    _altitudeRelativeToHomeFact->setRawValue(relativeAltitude());
+    connect(_altitudeRelativeToHomeFact, &Fact::valueChanged, this, &SimpleMissionItem::_syncAltitudeRelativeToHomeToFrame);
+
+    for (int i=0; i<7; i++) {
+        _paramMetaData[i] = new FactMetaData(FactMetaData::valueTypeDouble, this);
+    }
+
+    _missionItem.commandFact()->setMetaData(_commandMetaData);
+    _missionItem.frameFact()->setMetaData(_frameMetaData);
+
+    _rebuildFacts();
 }
 
 SimpleMissionItem::~SimpleMissionItem()
@@ -370,27 +367,27 @@ void SimpleMissionItem::_rebuildTextFieldFacts(void)
     _textFieldFacts.clear();
     
     if (rawEdit()) {
-        _missionItem._param1Fact._setName("Param1");
-        _missionItem._param1Fact.setMetaData(_defaultParamMetaData);
-        _textFieldFacts.append(&_missionItem._param1Fact);
-        _missionItem._param2Fact._setName("Param2");
-        _missionItem._param2Fact.setMetaData(_defaultParamMetaData);
-        _textFieldFacts.append(&_missionItem._param2Fact);
-        _missionItem._param3Fact._setName("Param3");
-        _missionItem._param3Fact.setMetaData(_defaultParamMetaData);
-        _textFieldFacts.append(&_missionItem._param3Fact);
-        _missionItem._param4Fact._setName("Param4");
-        _missionItem._param4Fact.setMetaData(_defaultParamMetaData);
-        _textFieldFacts.append(&_missionItem._param4Fact);
-        _missionItem._param5Fact._setName("Lat/X");
-        _missionItem._param5Fact.setMetaData(_defaultParamMetaData);
-        _textFieldFacts.append(&_missionItem._param5Fact);
-        _missionItem._param6Fact._setName("Lon/Y");
-        _missionItem._param6Fact.setMetaData(_defaultParamMetaData);
-        _textFieldFacts.append(&_missionItem._param6Fact);
-        _missionItem._param7Fact._setName("Alt/Z");
-        _missionItem._param7Fact.setMetaData(_defaultParamMetaData);
-        _textFieldFacts.append(&_missionItem._param7Fact);
+        _missionItem.param1Fact()->_setName("Param1");
+        _missionItem.param1Fact()->setMetaData(_defaultParamMetaData);
+        _textFieldFacts.append(_missionItem.param1Fact());
+        _missionItem.param2Fact()->_setName("Param2");
+        _missionItem.param2Fact()->setMetaData(_defaultParamMetaData);
+        _textFieldFacts.append(_missionItem.param2Fact());
+        _missionItem.param3Fact()->_setName("Param3");
+        _missionItem.param3Fact()->setMetaData(_defaultParamMetaData);
+        _textFieldFacts.append(_missionItem.param3Fact());
+        _missionItem.param4Fact()->_setName("Param4");
+        _missionItem.param4Fact()->setMetaData(_defaultParamMetaData);
+        _textFieldFacts.append(_missionItem.param4Fact());
+        _missionItem.param5Fact()->_setName("Lat/X");
+        _missionItem.param5Fact()->setMetaData(_defaultParamMetaData);
+        _textFieldFacts.append(_missionItem.param5Fact());
+        _missionItem.param6Fact()->_setName("Lon/Y");
+        _missionItem.param6Fact()->setMetaData(_defaultParamMetaData);
+        _textFieldFacts.append(_missionItem.param6Fact());
+        _missionItem.param7Fact()->_setName("Alt/Z");
+        _missionItem.param7Fact()->setMetaData(_defaultParamMetaData);
+        _textFieldFacts.append(_missionItem.param7Fact());
     } else {
         _ignoreDirtyChangeSignals = true;
 
@@ -401,8 +398,8 @@ void SimpleMissionItem::_rebuildTextFieldFacts(void)
             command = _missionItem.command();
         }
 
-        Fact*           rgParamFacts[7] =       { &_missionItem._param1Fact, &_missionItem._param2Fact, &_missionItem._param3Fact, &_missionItem._param4Fact, &_missionItem._param5Fact, &_missionItem._param6Fact, &_missionItem._param7Fact };
-        FactMetaData*   rgParamMetaData[7] =    { &_param1MetaData, &_param2MetaData, &_param3MetaData, &_param4MetaData, &_param5MetaData, &_param6MetaData, &_param7MetaData };
+        Fact*           rgParamFacts[7] =       { _missionItem.param1Fact(), _missionItem.param2Fact(), _missionItem.param3Fact(), _missionItem.param4Fact(), _missionItem.param5Fact(), _missionItem.param6Fact(), _missionItem.param7Fact() };
+        FactMetaData**  rgParamMetaData =       _paramMetaData;
 
         const MissionCommandUIInfo* uiInfo = _commandTree->getUIInfo(_vehicle, command);
 
@@ -422,9 +419,9 @@ void SimpleMissionItem::_rebuildTextFieldFacts(void)
         }
 
         if (uiInfo->specifiesCoordinate() || uiInfo->specifiesAltitudeOnly()) {
-            _missionItem._param7Fact._setName("Altitude");
-            _missionItem._param7Fact.setMetaData(_altitudeMetaData);
-            _textFieldFacts.append(&_missionItem._param7Fact);
+            _missionItem.param7Fact()->_setName("Altitude");
+            _missionItem.param7Fact()->setMetaData(_altitudeMetaData);
+            _textFieldFacts.append(_missionItem.param7Fact());
         }
 
         _ignoreDirtyChangeSignals = false;
@@ -445,8 +442,8 @@ void SimpleMissionItem::_rebuildNaNFacts(void)
             command = _missionItem.command();
         }
 
-        Fact*           rgParamFacts[7] =       { &_missionItem._param1Fact, &_missionItem._param2Fact, &_missionItem._param3Fact, &_missionItem._param4Fact, &_missionItem._param5Fact, &_missionItem._param6Fact, &_missionItem._param7Fact };
-        FactMetaData*   rgParamMetaData[7] =    { &_param1MetaData, &_param2MetaData, &_param3MetaData, &_param4MetaData, &_param5MetaData, &_param6MetaData, &_param7MetaData };
+        Fact*           rgParamFacts[7] =       { _missionItem.param1Fact(), _missionItem.param2Fact(), _missionItem.param3Fact(), _missionItem.param4Fact(), _missionItem.param5Fact(), _missionItem.param6Fact(), _missionItem.param7Fact() };
+        FactMetaData**  rgParamMetaData =       _paramMetaData;
 
         const MissionCommandUIInfo* uiInfo = _commandTree->getUIInfo(_vehicle, command);
 
@@ -485,9 +482,9 @@ void SimpleMissionItem::_rebuildCheckboxFacts(void)
     _checkboxFacts.clear();
 
     if (rawEdit()) {
-        _checkboxFacts.append(&_missionItem._autoContinueFact);
+        _checkboxFacts.append(_missionItem.autoContinueFact());
     } else if ((specifiesCoordinate() || specifiesAltitudeOnly()) && !_homePositionSpecialCase) {
-        _checkboxFacts.append(&_altitudeRelativeToHomeFact);
+        _checkboxFacts.append(_altitudeRelativeToHomeFact);
     }
 }
 
@@ -496,11 +493,11 @@ void SimpleMissionItem::_rebuildComboBoxFacts(void)
     _comboboxFacts.clear();
 
     if (rawEdit()) {
-        _comboboxFacts.append(&_missionItem._commandFact);
-        _comboboxFacts.append(&_missionItem._frameFact);
+        _comboboxFacts.append(_missionItem.commandFact());
+        _comboboxFacts.append(_missionItem.frameFact());
     } else {
-        Fact*           rgParamFacts[7] =       { &_missionItem._param1Fact, &_missionItem._param2Fact, &_missionItem._param3Fact, &_missionItem._param4Fact, &_missionItem._param5Fact, &_missionItem._param6Fact, &_missionItem._param7Fact };
-        FactMetaData*   rgParamMetaData[7] =    { &_param1MetaData, &_param2MetaData, &_param3MetaData, &_param4MetaData, &_param5MetaData, &_param6MetaData, &_param7MetaData };
+        Fact*           rgParamFacts[7] =       { _missionItem.param1Fact(), _missionItem.param2Fact(), _missionItem.param3Fact(), _missionItem.param4Fact(), _missionItem.param5Fact(), _missionItem.param6Fact(), _missionItem.param7Fact() };
+        FactMetaData**  rgParamMetaData =       _paramMetaData;
 
         MAV_CMD command;
         if (_homePositionSpecialCase) {
@@ -529,6 +526,11 @@ void SimpleMissionItem::_rebuildComboBoxFacts(void)
 
 void SimpleMissionItem::_rebuildFacts(void)
 {
+    if (!_editorFactsCreated) {
+        // Built when the editor first asks for them
+        return;
+    }
+
     _rebuildTextFieldFacts();
     _rebuildNaNFacts();
     _rebuildCheckboxFacts();
@@ -579,7 +581,7 @@ void SimpleMissionItem::setDirty(bool dirty)
 {
     if (!_homePositionSpecialCase || (_dirty != dirty)) {
         _dirty = dirty;
-        if (!dirty) {
+        if (!dirty && _cameraSection) {
             _cameraSection->setDirty(false);
             _speedSection->setDirty(false);
         }
@@ -594,9 +596,14 @@ void SimpleMissionItem::_setDirtyFromSignal(void)
     }
 }
 
-void SimpleMissionItem::_sendCoordinateChanged(void)
+void SimpleMissionItem::_paramChanged(int param)
 {
-    emit coordinateChanged(coordinate());
+    _setDirtyFromSignal();
+
+    // These are coordinate parameters, they must emit coordinateChanged signal
+    if (param >= 5) {
+        emit coordinateChanged(coordinate());
+    }
 }
 
 void SimpleMissionItem::_syncAltitudeRelativeToHomeToFrame(const QVariant& value)
@@ -613,8 +620,10 @@ void SimpleMissionItem::_syncFrameToAltitudeRelativeToHome(void)
 {
     if (!_syncingAltitudeRelativeToHomeAndFrame) {
         _syncingAltitudeRelativeToHomeAndFrame = true;
-        _altitudeRelativeToHomeFact.setRawValue(relativeAltitude());
-        emit coordinateHasRelativeAltitudeChanged(_altitudeRelativeToHomeFact.rawValue().toBool());
+        if (_altitudeRelativeToHomeFact) {
+            _altitudeRelativeToHomeFact->setRawValue(relativeAltitude());
+        }
+        emit coordinateHasRelativeAltitudeChanged(relativeAltitude());
         _syncingAltitudeRelativeToHomeAndFrame = false;
     }
 }
@@ -630,8 +639,8 @@ void SimpleMissionItem::setDefaultsForCommand(void)
         for (int i=1; i<=7; i++) {
             const MissionCmdParamInfo* paramInfo = uiInfo->getParamInfo(i);
             if (paramInfo) {
-                Fact* rgParamFacts[7] = { &_missionItem._param1Fact, &_missionItem._param2Fact, &_missionItem._param3Fact, &_missionItem._param4Fact, &_missionItem._param5Fact, &_missionItem._param6Fact, &_missionItem._param7Fact };
-                rgParamFacts[paramInfo->param()-1]->setRawValue(paramInfo->defaultValue());
+                void (MissionItem::*rgParamSetters[7])(double) = { &MissionItem::setParam1, &MissionItem::setParam2, &MissionItem::setParam3, &MissionItem::setParam4, &MissionItem::setParam5, &MissionItem::setParam6, &MissionItem::setParam7 };
+                (_missionItem.*rgParamSetters[paramInfo->param()-1])(paramInfo->defaultValue());
             }
         }
     }
@@ -656,16 +665,6 @@ void SimpleMissionItem::setDefaultsForCommand(void)
     setRawEdit(false);
 }
 
-void SimpleMissionItem::_sendFrameChanged(void)
-{
-    emit frameChanged(_missionItem.frame());
-}
-
-void SimpleMissionItem::_sendCommandChanged(void)
-{
-    emit commandChanged(command());
-}
-
 void SimpleMissionItem::_sendFriendlyEditAllowedChanged(void)
 {
     emit friendlyEditAllowedChanged(friendlyEditAllowed());
@@ -703,7 +702,7 @@ void SimpleMissionItem::setSequenceNumber(int sequenceNumber)
 
 double SimpleMissionItem::specifiedFlightSpeed(void)
 {
-    if (_speedSection->specifyFlightSpeed()) {
+    if (_speedSection && _speedSection->specifyFlightSpeed()) {
         return _speedSection->flightSpeed()->rawValue().toDouble();
     } else {
         return missionItem().specifiedFlightSpeed();
@@ -712,7 +711,7 @@ double SimpleMissionItem::specifiedFlightSpeed(void)
 
 double SimpleMissionItem::specifiedGimbalYaw(void)
 {
-    return _cameraSection->available() ? _cameraSection->specifiedGimbalYaw() : missionItem().specifiedGimbalYaw();
+    return _cameraSection && _cameraSection->available() ? _cameraSection->specifiedGimbalYaw() : missionItem().specifiedGimbalYaw();
 }
 
 bool SimpleMissionItem::scanForSections(QmlObjectListModel* visualItems, int scanIndex, Vehicle* vehicle)
@@ -721,6 +720,28 @@ bool SimpleMissionItem::scanForSections(QmlObjectListModel* visualItems, int sca
 
     Q_UNUSED(vehicle);
 
+    // Sections are only created if there is something for them to pick up, most waypoints don't have any
+    if ((MAV_CMD)command() != MAV_CMD_NAV_WAYPOINT || scanIndex >= visualItems->count()) {
+        return false;
+    }
+    SimpleMissionItem* item = visualItems->value<SimpleMissionItem*>(scanIndex);
+    if (!item) {
+        return false;
+    }
+    switch ((MAV_CMD)item->command()) {
+    case MAV_CMD_DO_MOUNT_CONTROL:
+    case MAV_CMD_IMAGE_START_CAPTURE:
+    case MAV_CMD_DO_SET_CAM_TRIGG_DIST:
+    case MAV_CMD_VIDEO_START_CAPTURE:
+    case MAV_CMD_VIDEO_STOP_CAPTURE:
+    case MAV_CMD_SET_CAMERA_MODE:
+    case MAV_CMD_DO_CHANGE_SPEED:
+        break;
+    default:
+        return false;
+    }
+
+    _createOptionalSections();
     if (_cameraSection->available()) {
         sectionFound |= _cameraSection->scanForSection(visualItems, scanIndex);
     }
@@ -731,19 +752,13 @@ bool SimpleMissionItem::scanForSections(QmlObjectListModel* visualItems, int sca
     return sectionFound;
 }
 
-void SimpleMissionItem::_updateOptionalSections(void)
+/// Creates the camera and speed sections the first time they are needed. Until then the item behaves as if it had
+/// sections with nothing specified.
+void SimpleMissionItem::_createOptionalSections(void)
 {
-    // Remove previous sections
     if (_cameraSection) {
-        _cameraSection->deleteLater();
-        _cameraSection = NULL;
+        return;
     }
-    if (_speedSection) {
-        _speedSection->deleteLater();
-        _speedSection = NULL;
-    }
-
-    // Add new sections
 
     _cameraSection = new CameraSection(_vehicle, this);
     _speedSection = new SpeedSection(_vehicle, this);
@@ -762,6 +777,19 @@ void SimpleMissionItem::_updateOptionalSections(void)
     connect(_speedSection,                  &SpeedSection::itemCountChanged,            this, &SimpleMissionItem::_updateLastSequenceNumber);
     connect(_speedSection,                  &SpeedSection::specifyFlightSpeedChanged,   this, &SimpleMissionItem::specifiedFlightSpeedChanged);
     connect(_speedSection->flightSpeed(),   &Fact::rawValueChanged,                     this, &SimpleMissionItem::specifiedFlightSpeedChanged);
+}
+
+void SimpleMissionItem::_updateOptionalSections(void)
+{
+    // Remove previous sections, new ones are created when needed
+    if (_cameraSection) {
+        _cameraSection->deleteLater();
+        _cameraSection = NULL;
+    }
+    if (_speedSection) {
+        _speedSection->deleteLater();
+        _speedSection = NULL;
+    }
 
     emit cameraSectionChanged(_cameraSection);
     emit speedSectionChanged(_speedSection);
@@ -792,8 +820,10 @@ void SimpleMissionItem::appendMissionItems(QList<MissionItem*>& items, QObject*
     items.append(new MissionItem(missionItem(), missionItemParent));
     seqNum++;
 
-    _cameraSection->appendSectionItems(items, missionItemParent, seqNum);
-    _speedSection->appendSectionItems(items, missionItemParent, seqNum);
+    if (_cameraSection) {
+        _cameraSection->appendSectionItems(items, missionItemParent, seqNum);
+        _speedSection->appendSectionItems(items, missionItemParent, seqNum);
+    }
 }
 
 void SimpleMissionItem::applyNewAltitude(double newAltitude)
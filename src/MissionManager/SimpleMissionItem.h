@@ -57,16 +57,17 @@ public:
     // Property accesors
     
     QString         category            (void) const;
-    MavlinkQmlSingleton::Qml_MAV_CMD command(void) const { return (MavlinkQmlSingleton::Qml_MAV_CMD)_missionItem._commandFact.cookedValue().toInt(); }
+    MavlinkQmlSingleton::Qml_MAV_CMD command(void) const { return (MavlinkQmlSingleton::Qml_MAV_CMD)_missionItem.command(); }
     bool            friendlyEditAllowed (void) const;
     bool            rawEdit             (void) const;
-    CameraSection*  cameraSection       (void) { return _cameraSection; }
-    SpeedSection*   speedSection        (void) { return _speedSection; }
+    CameraSection*  cameraSection       (void) { _createOptionalSections(); return _cameraSection; }
+    SpeedSection*   speedSection        (void) { _createOptionalSections(); return _speedSection; }
 
-    QmlObjectListModel* textFieldFacts  (void) { return &_textFieldFacts; }
-    QmlObjectListModel* nanFacts        (void) { return &_nanFacts; }
-    QmlObjectListModel* checkboxFacts   (void) { return &_checkboxFacts; }
-    QmlObjectListModel* comboboxFacts   (void) { return &_comboboxFacts; }
+    // The editing ui models are only built the first time the item is shown in the editor
+    QmlObjectListModel* textFieldFacts  (void) { _createEditorFacts(); return &_textFieldFacts; }
+    QmlObjectListModel* nanFacts        (void) { _createEditorFacts(); return &_nanFacts; }
+    QmlObjectListModel* checkboxFacts   (void) { _createEditorFacts(); return &_checkboxFacts; }
+    QmlObjectListModel* comboboxFacts   (void) { _createEditorFacts(); return &_comboboxFacts; }
 
     void setRawEdit(bool rawEdit);
     
@@ -131,9 +132,7 @@ signals:
 private slots:
     void _setDirtyFromSignal                (void);
     void _sectionDirtyChanged               (bool dirty);
-    void _sendCommandChanged                (void);
-    void _sendCoordinateChanged             (void);
-    void _sendFrameChanged                  (void);
+    void _paramChanged                      (int param);
     void _sendFriendlyEditAllowedChanged    (void);
     void _syncAltitudeRelativeToHomeToFrame (const QVariant& value);
     void _syncFrameToAltitudeRelativeToHome (void);
@@ -143,6 +142,8 @@ private slots:
 private:
     void _connectSignals        (void);
     void _setupMetaData         (void);
+    void _createEditorFacts     (void);
+    void _createOptionalSections(void);
     void _updateOptionalSections(void);
     void _rebuildTextFieldFacts (void);
     void _rebuildNaNFacts       (void);
@@ -154,13 +155,13 @@ private:
     bool        _dirty;
     bool        _ignoreDirtyChangeSignals;
 
-    SpeedSection*   _speedSection;
-    CameraSection* _cameraSection;
+    SpeedSection*   _speedSection;     ///< NULL until needed, see _createOptionalSections
+    CameraSection* _cameraSection;      ///< NULL until needed, see _createOptionalSections
 
     MissionCommandTree* _commandTree;
 
-    Fact    _altitudeRelativeToHomeFact;
-    Fact    _supportedCommandFact;
+    bool    _editorFactsCreated;
+    Fact*   _altitudeRelativeToHomeFact;    ///< NULL until _createEditorFacts
 
     QmlObjectListModel  _textFieldFacts;
     QmlObjectListModel  _nanFacts;
@@ -174,16 +175,14 @@ private:
     static FactMetaData*    _latitudeMetaData;
     static FactMetaData*    _longitudeMetaData;
 
-    FactMetaData    _param1MetaData;
-    FactMetaData    _param2MetaData;
-    FactMetaData    _param3MetaData;
-    FactMetaData    _param4MetaData;
-    FactMetaData    _param5MetaData;
-    FactMetaData    _param6MetaData;
-    FactMetaData    _param7MetaData;
+    FactMetaData*   _paramMetaData[7];  ///< NULL until _createEditorFacts
 
     bool _syncingAltitudeRelativeToHomeAndFrame;    ///< true: already in a sync signal, prevents signal loop
     bool _syncingHeadingDegreesAndParam4;           ///< true: already in a sync signal, prevents signal loop
+
+#ifdef UNITTEST_BUILD
+    friend class SimpleMissionItemTest;
+#endif
 };
 
 #endif
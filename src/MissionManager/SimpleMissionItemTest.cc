@@ -13,6 +13,9 @@
 #include "QGroundControlQmlGlobal.h"
 #include "SettingsManager.h"
 
+#include <QFile>
+#include <QTextStream>
+
 const SimpleMissionItemTest::ItemInfo_t SimpleMissionItemTest::_rgItemInfo[] = {
     { MAV_CMD_NAV_WAYPOINT,     MAV_FRAME_GLOBAL_RELATIVE_ALT },
     { MAV_CMD_NAV_LOITER_UNLIM, MAV_FRAME_GLOBAL_RELATIVE_ALT },
@@ -320,3 +323,64 @@ void SimpleMissionItemTest::_testSpeedSection(void)
     QCOMPARE(_spyVisualItem->checkSignalsByMask(specifiedFlightSpeedChangedMask), true);
     QCOMPARE(_simpleItem->dirty(), true);
 }
+
+/// @return Resident memory of the process in bytes, 0 if the platform doesn't report it
+qint64 SimpleMissionItemTest::_residentMemory(void)
+{
+    QFile file(QStringLiteral("/proc/self/status"));
+
+    if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        QTextStream stream(&file);
+        while (!stream.atEnd()) {
+            QString line = stream.readLine();
+            if (line.startsWith(QStringLiteral("VmRSS:"))) {
+                return line.mid(6).trimmed().split(QChar(' ')).first().toLongLong() * 1024;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/// Items which are never shown in the editor must not pay for the editor Facts or the optional sections
+void SimpleMissionItemTest::_testLazyCreation(void)
+{
+    SimpleMissionItem item(_offlineVehicle, _simpleItem->missionItem());
+
+    QCOMPARE(item._editorFactsCreated, false);
+    QVERIFY(item._altitudeRelativeToHomeFact == NULL);
+    QVERIFY(item._cameraSection == NULL);
+    QVERIFY(item._speedSection == NULL);
+    // The MissionItem Facts are its only Fact children, they are created on first use
+    QVERIFY(item.missionItem().findChildren<Fact*>().isEmpty());
+    int lazyObjectCount = item.findChildren<QObject*>().count() + item.missionItem().findChildren<QObject*>().count();
+
+    // Asking for the ui models creates the Facts with the current values
+    QVERIFY(item.textFieldFacts()->count() > 0);
+    QCOMPARE(item._editorFactsCreated, true);
+    QCOMPARE(item.missionItem().param7Fact()->rawValue().toDouble(), item.missionItem().param7());
+    QCOMPARE(item.checkboxFacts()->count(), 1);
+    QVERIFY(item.cameraSection());
+    QCOMPARE(item.cameraSection()->available(), true);
+    int expandedObjectCount = item.findChildren<QObject*>().count() + item.missionItem().findChildren<QObject*>().count();
+    QVERIFY(expandedObjectCount > lazyObjectCount);
+    qDebug() << "Child objects per item lazy:expanded" << lazyObjectCount << expandedObjectCount;
+
+    // Editing through the Facts must still go through the item
+    item.setDirty(false);
+    item.missionItem().param7Fact()->setRawValue(item.missionItem().param7() + 1);
+    QCOMPARE(item.dirty(), true);
+
+    // Memory cost per item for a large mission which is never expanded
+    const int                   cItems = 5000;
+    QList<SimpleMissionItem*>   items;
+    qint64                      residentBefore = _residentMemory();
+    for (int i=0; i<cItems; i++) {
+        items.append(new SimpleMissionItem(_offlineVehicle, _simpleItem->missionItem()));
+    }
+    qint64 residentAfter = _residentMemory();
+    if (residentBefore && residentAfter) {
+        qDebug() << "Resident memory per item" << (residentAfter - residentBefore) / cItems << "bytes";
+    }
+    qDeleteAll(items);
+}
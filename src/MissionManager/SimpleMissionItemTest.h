@@ -31,8 +31,11 @@ private slots:
     void _testSpeedSectionDirty(void);
     void _testCameraSection(void);
     void _testSpeedSection(void);
+    void _testLazyCreation(void);
 
 private:
+    static qint64 _residentMemory(void);
+
     enum {
         commandChangedIndex = 0,
         frameChangedIndex,
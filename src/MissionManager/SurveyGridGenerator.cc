@@ -0,0 +1,835 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#include "SurveyGridGenerator.h"
+#include "QGCGeo.h"
+#include "QGCLoggingCategory.h"
+
+#include <QRectF>
+#include <QtMath>
+
+#include <algorithm>
+#include <limits>
+
+QGC_LOGGING_CATEGORY(SurveyGridGeneratorLog, "SurveyGridGeneratorLog")
+
+QGeoCoordinate SurveyGridGenerator::Transects::coordinate(int transectIndex, int pointIndex) const
+{
+    const Point_t& gridPoint = point(transectIndex, pointIndex);
+    return QGeoCoordinate(gridPoint.latitude, gridPoint.longitude);
+}
+
+void SurveyGridGenerator::Transects::reverseTransectOrder(void)
+{
+    QVector<Point_t>    reversedPoints;
+    QVector<int>        reversedStarts;
+
+    reversedPoints.reserve(_points.count());
+    reversedStarts.reserve(_starts.count());
+    reversedStarts.append(0);
+    for (int i=count() - 1; i>=0; i--) {
+        for (int j=_starts[i]; j<_starts[i + 1]; j++) {
+            reversedPoints.append(_points[j]);
+        }
+        reversedStarts.append(reversedPoints.count());
+    }
+
+    _points = reversedPoints;
+    _starts = reversedStarts;
+}
+
+void SurveyGridGenerator::Transects::reverseInternalPoints(void)
+{
+    for (int i=0; i<count(); i++) {
+        std::reverse(_points.begin() + _starts[i], _points.begin() + _starts[i + 1]);
+    }
+}
+
+void SurveyGridGenerator::Transects::clear(void)
+{
+    _points.clear();
+    _starts.clear();
+    _starts.append(0);
+}
+
+SurveyGridGenerator::Grid_t SurveyGridGenerator::generate(const Params_t& params, const QAtomicInt* cancel)
+{
+    Grid_t grid;
+
+    grid.coveredArea = 0;
+    grid.surveyDistance = 0;
+    grid.cameraShots = 0;
+
+    if (params.polygon.count() < 3 || params.gridSpacing <= 0) {
+        return grid;
+    }
+
+    QList<QPolygonF>        rings;
+    QList<QList<QPointF>>   transectSegments;
+
+    // Convert polygon and exclusion polygons to NED. The first ring is the survey area, the rest are holes.
+    GeoOrigin_t tangentOrigin = geoOrigin(params.polygon[0]);
+    qCDebug(SurveyGridGeneratorLog) << "Convert polygon to NED - tangentOrigin" << params.polygon[0];
+    rings.append(_polygonToNed(params.polygon, tangentOrigin));
+    for (int i=0; i<params.holes.count(); i++) {
+        if (params.holes[i].count() < 3) {
+            continue;
+        }
+
+        // A hole which reaches outside the survey area or overlaps another hole would add transects outside the area
+        // and be subtracted from the covered area more than once, so it is ignored
+        QPolygonF hole = _polygonToNed(params.holes[i], tangentOrigin);
+        bool validHole = _ringInsideRing(hole, rings[0]);
+        for (int j=1; validHole && j<rings.count(); j++) {
+            validHole = !_ringsOverlap(hole, rings[j]);
+        }
+        if (validHole) {
+            rings.append(hole);
+        } else {
+            qCDebug(SurveyGridGeneratorLog) << "Ignoring exclusion polygon outside survey area or overlapping another, index" << i;
+        }
+    }
+
+    double coveredArea = _polygonArea(rings[0]);
+    for (int i=1; i<rings.count(); i++) {
+        coveredArea -= _polygonArea(rings[i]);
+    }
+    grid.coveredArea = qMax(coveredArea, 0.0);
+
+    // Generate grid
+    int cameraShots = 0;
+    cameraShots += _gridGenerator(params, rings, transectSegments, false /* refly */, cancel);
+    if (_cancelled(cancel)) {
+        return grid;
+    }
+    _convertTransectToGeo(transectSegments, tangentOrigin, grid.transects);
+    _adjustTransectsToEntryPointLocation(params, grid.transects);
+    _appendGridPointsFromTransects(grid.transects, grid.gridPoints);
+    if (params.refly90Degrees) {
+        transectSegments.clear();
+        cameraShots += _gridGenerator(params, rings, transectSegments, true /* refly */, cancel);
+        if (_cancelled(cancel)) {
+            return grid;
+        }
+        _convertTransectToGeo(transectSegments, tangentOrigin, grid.reflyTransects);
+        if (!grid.transects.isEmpty()) {
+            _optimizeTransectsForShortestDistance(grid.transects.exit(grid.transects.count() - 1), grid.reflyTransects);
+        }
+        _appendGridPointsFromTransects(grid.reflyTransects, grid.gridPoints);
+    }
+
+    // Calc survey distance through the grid points
+    QVector<double> latitudes;
+    QVector<double> longitudes;
+    _appendEntryExitPoints(grid.transects, latitudes, longitudes);
+    _appendEntryExitPoints(grid.reflyTransects, latitudes, longitudes);
+    double surveyDistance = geoPathLength(latitudes.constData(), longitudes.constData(), latitudes.count());
+    grid.surveyDistance = surveyDistance;
+
+    if (cameraShots == 0 && params.triggerDistance > 0) {
+        cameraShots = (int)ceil(surveyDistance / params.triggerDistance);
+    }
+    grid.cameraShots = cameraShots;
+
+    return grid;
+}
+
+QPolygonF SurveyGridGenerator::_polygonToNed(const QList<QGeoCoordinate>& polygon, const GeoOrigin_t& tangentOrigin)
+{
+    QPolygonF       polygonNed;
+    QVector<double> latitudes(polygon.count());
+    QVector<double> longitudes(polygon.count());
+    QVector<double> north(polygon.count());
+    QVector<double> east(polygon.count());
+
+    for (int i=0; i<polygon.count(); i++) {
+        latitudes[i] = polygon[i].latitude();
+        longitudes[i] = polygon[i].longitude();
+    }
+    convertGeoToNed(latitudes.constData(), longitudes.constData(), polygon.count(), tangentOrigin, north.data(), east.data());
+
+    polygonNed.reserve(polygon.count());
+    for (int i=0; i<polygon.count(); i++) {
+        polygonNed << QPointF(east[i], north[i]);
+        qCDebug(SurveyGridGeneratorLog) << "vertex:x:y" << polygon[i] << polygonNed.last().x() << polygonNed.last().y();
+    }
+
+    return polygonNed;
+}
+
+/// @return true: Any edge of ring1 crosses or touches an edge of ring2
+bool SurveyGridGenerator::_ringEdgesCross(const QPolygonF& ring1, const QPolygonF& ring2)
+{
+    QRectF ring2Bounds = ring2.boundingRect();
+
+    for (int i=0; i<ring1.count(); i++) {
+        QLineF edge1(ring1[i], ring1[(i + 1) % ring1.count()]);
+
+        // Only edges which reach the other ring can cross it
+        if (!QRectF(edge1.p1(), edge1.p2()).normalized().adjusted(-1e-9, -1e-9, 1e-9, 1e-9).intersects(ring2Bounds)) {
+            continue;
+        }
+        for (int j=0; j<ring2.count(); j++) {
+            QLineF edge2(ring2[j], ring2[(j + 1) % ring2.count()]);
+            if (edge1.intersect(edge2, NULL) == QLineF::BoundedIntersection) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/// @return true: inner lies completely within outer, touching the boundary of outer counts as outside
+bool SurveyGridGenerator::_ringInsideRing(const QPolygonF& inner, const QPolygonF& outer)
+{
+    return !_ringEdgesCross(inner, outer) && outer.containsPoint(inner[0], Qt::OddEvenFill);
+}
+
+/// @return true: The rings share any area
+bool SurveyGridGenerator::_ringsOverlap(const QPolygonF& ring1, const QPolygonF& ring2)
+{
+    if (!ring1.boundingRect().intersects(ring2.boundingRect())) {
+        return false;
+    }
+
+    return _ringEdgesCross(ring1, ring2) || ring1.containsPoint(ring2[0], Qt::OddEvenFill) || ring2.containsPoint(ring1[0], Qt::OddEvenFill);
+}
+
+/// @return Area of the polygon, regardless of winding direction
+double SurveyGridGenerator::_polygonArea(const QPolygonF& polygon)
+{
+    double area = 0.0;
+
+    for (int i=0; i<polygon.count(); i++) {
+        const QPointF& previous = polygon[i == 0 ? polygon.count() - 1 : i - 1];
+        area += previous.x() * polygon[i].y() - polygon[i].x() * previous.y();
+    }
+
+    return 0.5 * fabs(area);
+}
+
+QPointF SurveyGridGenerator::_rotatePoint(const QPointF& point, const QPointF& origin, double angle)
+{
+    QPointF rotated;
+    double radians = (M_PI / 180.0) * -angle;
+
+    rotated.setX(((point.x() - origin.x()) * cos(radians)) - ((point.y() - origin.y()) * sin(radians)) + origin.x());
+    rotated.setY(((point.x() - origin.x()) * sin(radians)) + ((point.y() - origin.y()) * cos(radians)) + origin.y());
+
+    return rotated;
+}
+
+double SurveyGridGenerator::_clampGridAngle90(double gridAngle)
+{
+    // Clamp grid angle to -90<->90. This prevents transects from being rotated to a reversed order.
+    if (gridAngle > 90.0) {
+        gridAngle -= 180.0;
+    } else if (gridAngle < -90.0) {
+        gridAngle += 180;
+    }
+    return gridAngle;
+}
+
+int SurveyGridGenerator::_gridGenerator(const Params_t& params, const QList<QPolygonF>& rings, QList<QList<QPointF>>& transectSegments, bool refly, const QAtomicInt* cancel)
+{
+    int cameraShots = 0;
+
+    double gridAngle = params.gridAngle;
+    double gridSpacing = params.gridSpacing;
+
+    gridAngle = _clampGridAngle90(gridAngle);
+    gridAngle += refly ? 90 : 0;
+    qCDebug(SurveyGridGeneratorLog) << "Clamped grid angle" << gridAngle;
+
+    qCDebug(SurveyGridGeneratorLog) << "SurveyGridGenerator::_gridGenerator gridSpacing:gridAngle:refly" << gridSpacing << gridAngle << refly;
+
+    transectSegments.clear();
+
+    // Convert polygon to bounding rect
+
+    QRectF smallBoundRect = rings[0].boundingRect();
+    QPointF boundingCenter = smallBoundRect.center();
+    qCDebug(SurveyGridGeneratorLog) << "Bounding rect" << smallBoundRect.topLeft().x() << smallBoundRect.topLeft().y() << smallBoundRect.bottomRight().x() << smallBoundRect.bottomRight().y();
+
+    // Rotate the bounding rect around it's center to generate the larger bounding rect
+    QPolygonF boundPolygon;
+    boundPolygon << _rotatePoint(smallBoundRect.topLeft(),      boundingCenter, gridAngle);
+    boundPolygon << _rotatePoint(smallBoundRect.topRight(),     boundingCenter, gridAngle);
+    boundPolygon << _rotatePoint(smallBoundRect.bottomRight(),  boundingCenter, gridAngle);
+    boundPolygon << _rotatePoint(smallBoundRect.bottomLeft(),   boundingCenter, gridAngle);
+    boundPolygon << boundPolygon[0];
+    QRectF largeBoundRect = boundPolygon.boundingRect();
+    qCDebug(SurveyGridGeneratorLog) << "Rotated bounding rect" << largeBoundRect.topLeft().x() << largeBoundRect.topLeft().y() << largeBoundRect.bottomRight().x() << largeBoundRect.bottomRight().y();
+
+    // Create the set of parallel scanlines within the expanded bounding rect. Scanlines are positioned in the unrotated
+    // frame where they are either vertical or horizontal. Their order determines which side of the polygon the grid
+    // starts from.
+
+    QVector<double> scanPositions;
+    bool northSouthTransects = _gridAngleIsNorthSouthTransects(params.gridAngle);
+    int entryLocation = params.entryLocation;
+
+    if (northSouthTransects) {
+        qCDebug(SurveyGridGeneratorLog) << "Clamped grid angle" << gridAngle;
+        if (entryLocation == EntryLocationTopLeft || entryLocation == EntryLocationBottomLeft) {
+            // Generate transects from left to right
+            qCDebug(SurveyGridGeneratorLog) << "Generate left to right";
+            float x = largeBoundRect.topLeft().x() - (gridSpacing / 2);
+            while (x < largeBoundRect.bottomRight().x()) {
+                scanPositions += x;
+                x += gridSpacing;
+            }
+        } else {
+            // Generate transects from right to left
+            qCDebug(SurveyGridGeneratorLog) << "Generate right to left";
+            float x = largeBoundRect.topRight().x() + (gridSpacing / 2);
+            while (x > largeBoundRect.bottomLeft().x()) {
+                scanPositions += x;
+                x -= gridSpacing;
+            }
+        }
+    } else {
+        gridAngle = _clampGridAngle90(gridAngle - 90.0);
+        qCDebug(SurveyGridGeneratorLog) << "Clamped grid angle" << gridAngle;
+        if (entryLocation == EntryLocationTopLeft || entryLocation == EntryLocationTopRight) {
+            // Generate transects from top to bottom
+            qCDebug(SurveyGridGeneratorLog) << "Generate top to bottom";
+            float y = largeBoundRect.bottomLeft().y() + (gridSpacing / 2);
+            while (y > largeBoundRect.topRight().y()) {
+                scanPositions += y;
+                y -= gridSpacing;
+            }
+        } else {
+            // Generate transects from bottom to top
+            qCDebug(SurveyGridGeneratorLog) << "Generate bottom to top";
+            float y = largeBoundRect.topLeft().y() - (gridSpacing / 2);
+            while (y < largeBoundRect.bottomRight().y()) {
+                scanPositions += y;
+                y += gridSpacing;
+            }
+        }
+    }
+
+    // Rotate the polygon into the unrotated frame and transpose it for north/south transects, so every scanline
+    // is horizontal for the clipper.
+    QList<QPolygonF> scanRings;
+    for (int i=0; i<rings.count(); i++) {
+        QPolygonF scanRing;
+        for (int j=0; j<rings[i].count(); j++) {
+            QPointF point = _rotatePoint(rings[i][j], boundingCenter, -gridAngle);
+            scanRing << (northSouthTransects ? QPointF(point.y(), point.x()) : point);
+        }
+        scanRings.append(scanRing);
+    }
+
+    // Now clip the scanlines against the polygon
+    QVector<QVector<QPointF>> scanIntervals;
+    int intervalCount = _clipScanlines(scanRings, scanPositions, scanIntervals, cancel);
+    if (_cancelled(cancel)) {
+        return 0;
+    }
+
+    // Less than two transects intersected with the polygon:
+    //      Create a single transect which goes through the center of the polygon
+    //      Intersect it with the polygon
+    if (intervalCount < 2) {
+        scanPositions.clear();
+        scanPositions += northSouthTransects ? boundingCenter.x() : boundingCenter.y();
+        _clipScanlines(scanRings, scanPositions, scanIntervals, cancel);
+    }
+
+    // Convert the intervals back to lines in the rotated frame. All lines point the same direction along their
+    // scanline, which is the same direction the scanlines would have had before clipping.
+    QVector<QVector<QLineF>> scanLines(scanIntervals.count());
+    for (int i=0; i<scanIntervals.count(); i++) {
+        const QVector<QPointF>& intervals = scanIntervals[i];
+        for (int j=0; j<intervals.count(); j++) {
+            QPointF p1, p2;
+            if (northSouthTransects) {
+                p1 = QPointF(scanPositions[i], intervals[j].x());
+                p2 = QPointF(scanPositions[i], intervals[j].y());
+            } else {
+                p1 = QPointF(intervals[j].x(), scanPositions[i]);
+                p2 = QPointF(intervals[j].y(), scanPositions[i]);
+            }
+            scanLines[i] += QLineF(_rotatePoint(p1, boundingCenter, gridAngle), _rotatePoint(p2, boundingCenter, gridAngle));
+        }
+    }
+
+    // Order the transects for the shortest flight between them
+    QList<QLineF> resultLines;
+    _orderTransects(scanLines, scanPositions, resultLines, cancel);
+    if (_cancelled(cancel)) {
+        return 0;
+    }
+
+    bool triggerCamera = params.triggerDistance > 0;
+    bool hasTurnaround = params.turnaroundDistance > 0;
+
+    // Calc camera shots here if there are no images in turnaround
+    if (triggerCamera && !params.imagesEverywhere) {
+        for (int i=0; i<resultLines.count(); i++) {
+            cameraShots += (int)ceil(resultLines[i].length() / params.triggerDistance);
+        }
+    }
+
+    // Turn into a path
+    for (int i=0; i<resultLines.count(); i++) {
+        QList<QPointF>  transectPoints;
+        const QLineF&   transectLine = resultLines[i];
+
+        float turnaroundPosition = params.turnaroundDistance / transectLine.length();
+
+        // Build the points along the transect
+
+        if (hasTurnaround) {
+            transectPoints.append(transectLine.pointAt(-turnaroundPosition));
+        }
+
+        // Polygon entry point
+        transectPoints.append(transectLine.p1());
+
+        // For hover and capture we need points for each camera location
+        if (triggerCamera && params.hoverAndCapture) {
+            if (params.triggerDistance < transectLine.length()) {
+                int innerPoints = floor(transectLine.length() / params.triggerDistance);
+                qCDebug(SurveyGridGeneratorLog) << "innerPoints" << innerPoints;
+                float transectPositionIncrement = params.triggerDistance / transectLine.length();
+                for (int i=0; i<innerPoints; i++) {
+                    transectPoints.append(transectLine.pointAt(transectPositionIncrement * (i + 1)));
+                }
+            }
+        }
+
+        // Polygon exit point
+        transectPoints.append(transectLine.p2());
+
+        if (hasTurnaround) {
+            transectPoints.append(transectLine.pointAt(1 + turnaroundPosition));
+        }
+
+        transectSegments.append(transectPoints);
+    }
+
+    return cameraShots;
+}
+
+/// Clips horizontal scanlines against a set of polygon rings using a sweep over the polygon edges. Coverage follows the
+/// even-odd rule, so rings inside the first ring cut holes into it. Edges are sorted once by their lower end and are
+/// active only while the sweep is within their vertical span. Each scanline therefore only looks at the edges which
+/// cross it, giving O((n + k) log n) for n edges and k crossings instead of testing every edge against every scanline.
+///     @param rings Polygon rings, closing edge from last to first vertex is implied
+///     @param scanPositions Y position of each scanline, in any order
+///     @param[out] scanIntervals For each scanline the x start/end of each inside interval, in increasing x order
+/// @return Total number of intervals
+int SurveyGridGenerator::_clipScanlines(const QList<QPolygonF>& rings, const QVector<double>& scanPositions, QVector<QVector<QPointF>>& scanIntervals, const QAtomicInt* cancel)
+{
+    QVector<ScanEdge_t> edges;
+
+    for (int i=0; i<rings.count(); i++) {
+        const QPolygonF& ring = rings[i];
+        for (int j=0; j<ring.count(); j++) {
+            QPointF p1 = ring[j];
+            QPointF p2 = ring[(j + 1) % ring.count()];
+
+            if (p1.y() == p2.y()) {
+                // Horizontal edges never cross a scanline, their neighbouring edges account for them
+                continue;
+            }
+            if (p1.y() > p2.y()) {
+                std::swap(p1, p2);
+            }
+
+            ScanEdge_t edge = { p1.y(), p2.y(), p1.x(), (p2.x() - p1.x()) / (p2.y() - p1.y()) };
+            edges.append(edge);
+        }
+    }
+    std::sort(edges.begin(), edges.end(), [](const ScanEdge_t& edge1, const ScanEdge_t& edge2) { return edge1.yMin < edge2.yMin; });
+
+    // Sweep scanlines in increasing y order
+    QVector<int> scanOrder(scanPositions.count());
+    for (int i=0; i<scanOrder.count(); i++) {
+        scanOrder[i] = i;
+    }
+    std::sort(scanOrder.begin(), scanOrder.end(), [&scanPositions](int index1, int index2) { return scanPositions[index1] < scanPositions[index2]; });
+
+    scanIntervals.clear();
+    scanIntervals.resize(scanPositions.count());
+
+    int             intervalCount = 0;
+    int             nextEdge = 0;
+    QVector<int>    activeEdges;
+    QVector<double> crossings;
+
+    for (int i=0; i<scanOrder.count(); i++) {
+        int     scanIndex = scanOrder[i];
+        double  y = scanPositions[scanIndex];
+
+        if (_cancelled(cancel)) {
+            return intervalCount;
+        }
+
+        while (nextEdge < edges.count() && edges[nextEdge].yMin <= y) {
+            activeEdges.append(nextEdge++);
+        }
+
+        // Edges span [yMin, yMax) so a scanline through a vertex counts it exactly once
+        crossings.clear();
+        for (int j=0; j<activeEdges.count(); ) {
+            const ScanEdge_t& edge = edges[activeEdges[j]];
+            if (edge.yMax <= y) {
+                // Sweep has passed this edge for good
+                activeEdges[j] = activeEdges.last();
+                activeEdges.removeLast();
+                continue;
+            }
+            crossings.append(edge.xAtYMin + ((y - edge.yMin) * edge.dxdy));
+            j++;
+        }
+        std::sort(crossings.begin(), crossings.end());
+
+        for (int j=0; j+1<crossings.count(); j+=2) {
+            if (crossings[j + 1] > crossings[j]) {
+                scanIntervals[scanIndex].append(QPointF(crossings[j], crossings[j + 1]));
+                intervalCount++;
+            }
+        }
+    }
+
+    return intervalCount;
+}
+
+/// Updates the next transect to fly if the specified transect can be reached in a shorter distance
+void SurveyGridGenerator::_checkNextTransect(const QPointF& position, const QLineF& line, int lineIndex, int& next, double& nextDistance, bool& nextReversed)
+{
+    double p1Distance = QLineF(position, line.p1()).length();
+    double p2Distance = QLineF(position, line.p2()).length();
+
+    if (next == -1 || qMin(p1Distance, p2Distance) < nextDistance) {
+        next = lineIndex;
+        nextDistance = qMin(p1Distance, p2Distance);
+        nextReversed = p2Distance < p1Distance;
+    }
+}
+
+/// Follows the links to the nearest scanline which still has unvisited transects, compressing the path on the way
+int SurveyGridGenerator::_findScan(QVector<int>& links, int index)
+{
+    int root = index;
+    while (links[root] != root) {
+        root = links[root];
+    }
+    while (links[index] != root) {
+        int next = links[index];
+        links[index] = root;
+        index = next;
+    }
+
+    return root;
+}
+
+/// Orders the clipped transects to keep the distance flown between them short. Flight sweeps back and forth across
+/// neighbouring scanlines, entering each transect from the end closest to the exit of the previous one. Concave areas
+/// and holes split scanlines into multiple transects. When the sweep reaches a dead end it continues with the closest
+/// remaining transect, so each separate lobe is flown as one sweep.
+///     @param scanLines Transects for each scanline in scanline order, all pointing the same direction
+///     @param scanPositions Position of each scanline across the scan direction, increasing or decreasing
+///     @param[out] resultLines Transects in flight order and direction
+void SurveyGridGenerator::_orderTransects(const QVector<QVector<QLineF>>& scanLines, const QVector<double>& scanPositions, QList<QLineF>& resultLines, const QAtomicInt* cancel)
+{
+    QVector<QLineF> lines;
+    QVector<int>    lineScan;       ///< Scanline index for each line
+    QVector<int>    scanStart;      ///< Index of first line for each scanline, followed by total line count
+
+    resultLines.clear();
+
+    for (int i=0; i<scanLines.count(); i++) {
+        scanStart.append(lines.count());
+        for (int j=0; j<scanLines[i].count(); j++) {
+            lines.append(scanLines[i][j]);
+            lineScan.append(i);
+        }
+    }
+    scanStart.append(lines.count());
+
+    if (lines.isEmpty()) {
+        return;
+    }
+
+    // Dead end searches skip scanlines without unvisited transects. nextScan[s] leads to the first such scanline at or
+    // after s, scanLines.count() for none. previousScan[s + 1] leads to the last one at or before s, plus one.
+    int             scanCount = scanLines.count();
+    QVector<int>    remaining(scanCount);
+    QVector<int>    nextScan(scanCount + 1);
+    QVector<int>    previousScan(scanCount + 1);
+    for (int i=0; i<scanCount; i++) {
+        remaining[i] = scanStart[i + 1] - scanStart[i];
+        nextScan[i] = remaining[i] ? i : i + 1;
+        previousScan[i + 1] = remaining[i] ? i + 1 : i;
+    }
+    nextScan[scanCount] = scanCount;
+    previousScan[0] = 0;
+
+    QVector<bool>   visited(lines.count(), false);
+    int             current = 0;
+    bool            reversed = false;
+    int             direction = 1;
+
+    resultLines.reserve(lines.count());
+
+    for (int visitedCount=0; visitedCount<lines.count(); visitedCount++) {
+        if (_cancelled(cancel)) {
+            return;
+        }
+
+        visited[current] = true;
+        if (--remaining[lineScan[current]] == 0) {
+            nextScan[lineScan[current]] = lineScan[current] + 1;
+            previousScan[lineScan[current] + 1] = lineScan[current];
+        }
+        resultLines.append(reversed ? QLineF(lines[current].p2(), lines[current].p1()) : lines[current]);
+
+        QPointF position =  resultLines.last().p2();
+        int     scan =      lineScan[current];
+        int     next =      -1;
+        double  nextDistance = 0;
+        bool    nextReversed = false;
+
+        // Look at the scanline ahead in the current sweep direction first, so ties keep the sweep going
+        int neighbourScans[2] = { scan + direction, scan - direction };
+        for (int i=0; i<2; i++) {
+            int neighbourScan = neighbourScans[i];
+            if (neighbourScan < 0 || neighbourScan >= scanLines.count()) {
+                continue;
+            }
+            for (int j=scanStart[neighbourScan]; j<scanStart[neighbourScan + 1]; j++) {
+                if (visited[j]) {
+                    continue;
+                }
+                _checkNextTransect(position, lines[j], j, next, nextDistance, nextReversed);
+            }
+        }
+
+        if (next == -1) {
+            // Dead end, continue with the closest transect left anywhere. A transect can't be closer than the distance
+            // between the scanlines, so the search works outward from the current scanline and stops once no
+            // remaining scanline can hold a closer transect.
+            int after = _findScan(nextScan, scan);
+            int before = _findScan(previousScan, scan) - 1;
+            while (after < scanCount || before >= 0) {
+                double afterGap = after < scanCount ? qAbs(scanPositions[after] - scanPositions[scan]) : std::numeric_limits<double>::infinity();
+                double beforeGap = before >= 0 ? qAbs(scanPositions[scan] - scanPositions[before]) : std::numeric_limits<double>::infinity();
+                if (next != -1 && qMin(afterGap, beforeGap) >= nextDistance) {
+                    break;
+                }
+
+                int searchScan;
+                if (afterGap <= beforeGap) {
+                    searchScan = after;
+                    after = _findScan(nextScan, after + 1);
+                } else {
+                    searchScan = before;
+                    before = _findScan(previousScan, before) - 1;
+                }
+                for (int j=scanStart[searchScan]; j<scanStart[searchScan + 1]; j++) {
+                    if (!visited[j]) {
+                        _checkNextTransect(position, lines[j], j, next, nextDistance, nextReversed);
+                    }
+                }
+            }
+        }
+
+        if (next == -1) {
+            break;
+        }
+        if (lineScan[next] != scan) {
+            direction = lineScan[next] > scan ? 1 : -1;
+        }
+        current = next;
+        reversed = nextReversed;
+    }
+}
+
+void SurveyGridGenerator::_convertTransectToGeo(const QList<QList<QPointF>>& transectSegmentsNED, const GeoOrigin_t& tangentOrigin, Transects& transects)
+{
+    transects.clear();
+
+    int pointCount = 0;
+    for (int i=0; i<transectSegmentsNED.count(); i++) {
+        pointCount += transectSegmentsNED[i].count();
+    }
+
+    // Convert all points in one pass, then split them back up into transects
+    QVector<double> north(pointCount);
+    QVector<double> east(pointCount);
+    QVector<double> latitudes(pointCount);
+    QVector<double> longitudes(pointCount);
+
+    int pointIndex = 0;
+    for (int i=0; i<transectSegmentsNED.count(); i++) {
+        const QList<QPointF>& transectPoints = transectSegmentsNED[i];
+        for (int j=0; j<transectPoints.count(); j++) {
+            north[pointIndex] = transectPoints[j].y();
+            east[pointIndex] = transectPoints[j].x();
+            pointIndex++;
+        }
+    }
+    convertNedToGeo(north.constData(), east.constData(), pointCount, tangentOrigin, latitudes.data(), longitudes.data());
+
+    pointIndex = 0;
+    for (int i=0; i<transectSegmentsNED.count(); i++) {
+        for (int j=0; j<transectSegmentsNED[i].count(); j++) {
+            Point_t gridPoint = { latitudes[pointIndex], longitudes[pointIndex] };
+            transects.appendPoint(gridPoint);
+            pointIndex++;
+        }
+        transects.endTransect();
+    }
+}
+
+/// Reorders the transects such that the first transect is the shortest distance to the specified coordinate
+/// and the first point within that transect is the shortest distance to the specified coordinate.
+///     @param distanceCoord Coordinate to measure distance against
+///     @param transects Transects to test and reorder
+void SurveyGridGenerator::_optimizeTransectsForShortestDistance(const QGeoCoordinate& distanceCoord, Transects& transects)
+{
+    if (transects.isEmpty()) {
+        return;
+    }
+
+    double rgTransectDistance[4];
+    rgTransectDistance[0] = transects.entry(0).distanceTo(distanceCoord);
+    rgTransectDistance[1] = transects.exit(0).distanceTo(distanceCoord);
+    rgTransectDistance[2] = transects.entry(transects.count() - 1).distanceTo(distanceCoord);
+    rgTransectDistance[3] = transects.exit(transects.count() - 1).distanceTo(distanceCoord);
+
+    int shortestIndex = 0;
+    double shortestDistance = rgTransectDistance[0];
+    for (int i=1; i<3; i++) {
+        if (rgTransectDistance[i] < shortestDistance) {
+            shortestIndex = i;
+            shortestDistance = rgTransectDistance[i];
+        }
+    }
+
+    if (shortestIndex > 1) {
+        // We need to reverse the order of segments
+        transects.reverseTransectOrder();
+    }
+    if (shortestIndex & 1) {
+        // We need to reverse the points within each segment
+        transects.reverseInternalPoints();
+    }
+}
+
+void SurveyGridGenerator::_appendGridPointsFromTransects(const Transects& transects, QVariantList& gridPoints)
+{
+    if (transects.isEmpty()) {
+        return;
+    }
+
+    qCDebug(SurveyGridGeneratorLog) << "Entry point _appendGridPointsFromTransects" << transects.entry(0);
+
+    gridPoints.reserve(gridPoints.count() + (transects.count() * 2));
+    for (int i=0; i<transects.count(); i++) {
+        gridPoints.append(QVariant::fromValue(transects.entry(i)));
+        gridPoints.append(QVariant::fromValue(transects.exit(i)));
+    }
+}
+
+/// Appends the entry and exit of each transect, which are the same locations _appendGridPointsFromTransects adds
+void SurveyGridGenerator::_appendEntryExitPoints(const Transects& transects, QVector<double>& latitudes, QVector<double>& longitudes)
+{
+    for (int i=0; i<transects.count(); i++) {
+        const Point_t& entry = transects.point(i, 0);
+        const Point_t& exit = transects.point(i, transects.pointCount(i) - 1);
+
+        latitudes << entry.latitude << exit.latitude;
+        longitudes << entry.longitude << exit.longitude;
+    }
+}
+
+/// Returns true if the specified grid angle generates north/south oriented transects
+bool SurveyGridGenerator::_gridAngleIsNorthSouthTransects(double gridAngle)
+{
+    // Grid angle ranges from -360<->360
+    gridAngle = qAbs(gridAngle);
+    return gridAngle < 45.0 || (gridAngle > 360.0 - 45.0) || (gridAngle > 90.0 + 45.0 && gridAngle < 270.0 - 45.0);
+}
+
+void SurveyGridGenerator::_adjustTransectsToEntryPointLocation(const Params_t& params, Transects& transects)
+{
+    if (transects.count() == 0) {
+        return;
+    }
+
+    // First determine what location the current entry point is at
+
+    QGeoCoordinate firstTransectEntry = transects.entry(0);
+    QGeoCoordinate firstTransectExit = transects.exit(0);
+    QGeoCoordinate lastTransectExit = transects.exit(transects.count() - 1);
+
+    bool northSouthTransects = _gridAngleIsNorthSouthTransects(params.gridAngle);
+    bool entryPointBottom;
+    bool entryPointLeft;
+
+    qCDebug(SurveyGridGeneratorLog) << "Original entry point" << firstTransectEntry;
+    qCDebug(SurveyGridGeneratorLog) << "northSouthTransects" << northSouthTransects;
+
+    if (northSouthTransects) {
+        double firstTransectAzimuth = firstTransectEntry.azimuthTo(firstTransectExit);
+        qCDebug(SurveyGridGeneratorLog) << "firstTransectAzimuth" << firstTransectAzimuth;
+        entryPointBottom = (firstTransectAzimuth >= 0.0 && firstTransectAzimuth < 90.0) || (firstTransectAzimuth > 270.0 && firstTransectAzimuth <= 360.0);
+        qCDebug(SurveyGridGeneratorLog) << (entryPointBottom ? "Entry point is at bottom" : "Entry point is at top");
+
+        double entryToExitAzimuth = firstTransectEntry.azimuthTo(lastTransectExit);
+        qCDebug(SurveyGridGeneratorLog) << "entryToExitAzimuth" << entryToExitAzimuth;
+        entryPointLeft = entryToExitAzimuth <= 180.0;
+        qCDebug(SurveyGridGeneratorLog) << (entryPointLeft ? "Entry point is at left" : "Entry point is at right");
+    } else {
+        double firstTransectAzimuth = firstTransectEntry.azimuthTo(firstTransectExit);
+        qCDebug(SurveyGridGeneratorLog) << "firstTransectAzimuth" << firstTransectAzimuth;
+        entryPointLeft = firstTransectAzimuth <= 180.0;
+        qCDebug(SurveyGridGeneratorLog) << (entryPointLeft ? "Entry point is at left" : "Entry point is at right");
+
+        double entryToExitAzimuth = firstTransectEntry.azimuthTo(lastTransectExit);
+        qCDebug(SurveyGridGeneratorLog) << "entryToExitAzimuth" << entryToExitAzimuth;
+        entryPointBottom = (entryToExitAzimuth >= 0.0 && entryToExitAzimuth < 90.0) || (entryToExitAzimuth > 270.0 && entryToExitAzimuth <= 360.0);
+        qCDebug(SurveyGridGeneratorLog) << (entryPointBottom ? "Entry point is at bottom" : "Entry point is at top");
+    }
+
+    // Now adjust the transects such that the entry point matches the requested location
+
+    int entryLocation = params.entryLocation;
+    bool reverseTransects;
+    bool reversePoints;
+    if (northSouthTransects) {
+        reversePoints = ((entryLocation == EntryLocationTopLeft || entryLocation == EntryLocationTopRight) && entryPointBottom) ||
+                ((entryLocation == EntryLocationBottomLeft || entryLocation == EntryLocationBottomRight) && !entryPointBottom);
+        reverseTransects = ((entryLocation == EntryLocationTopRight || entryLocation == EntryLocationBottomRight) && entryPointLeft) ||
+                ((entryLocation == EntryLocationTopLeft || entryLocation == EntryLocationBottomLeft) && !entryPointLeft);
+    } else {
+        reverseTransects = ((entryLocation == EntryLocationTopLeft || entryLocation == EntryLocationTopRight) && entryPointBottom) ||
+                ((entryLocation == EntryLocationBottomLeft || entryLocation == EntryLocationBottomRight) && !entryPointBottom);
+        reversePoints = ((entryLocation == EntryLocationTopRight || entryLocation == EntryLocationBottomRight) && entryPointLeft) ||
+                ((entryLocation == EntryLocationTopLeft || entryLocation == EntryLocationBottomLeft) && !entryPointLeft);
+    }
+    if (reversePoints) {
+        qCDebug(SurveyGridGeneratorLog) << "Reverse Points";
+        transects.reverseInternalPoints();
+    }
+    if (reverseTransects) {
+        // The only way we should end up here is if there is a bug in the original grid line generation
+        qCDebug(SurveyGridGeneratorLog) << "Not Reverse Transects";
+        //transects.reverseTransectOrder();
+    }
+    qCDebug(SurveyGridGeneratorLog) << "Modified entry point" << transects.entry(0);
+}
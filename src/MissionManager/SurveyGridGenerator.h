@@ -0,0 +1,144 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#ifndef SurveyGridGenerator_H
+#define SurveyGridGenerator_H
+
+#include "QGCGeo.h"
+
+#include <QAtomicInt>
+#include <QGeoCoordinate>
+#include <QLineF>
+#include <QList>
+#include <QLoggingCategory>
+#include <QPointF>
+#include <QPolygonF>
+#include <QVariantList>
+#include <QVector>
+
+Q_DECLARE_LOGGING_CATEGORY(SurveyGridGeneratorLog)
+
+/// Generates the transects for a survey polygon.
+///
+/// The survey polygon may be concave and may contain exclusion polygons. Transects are clipped against all of them with
+/// a scanline sweep, so a single transect line can produce several transects.
+///
+/// Generation works only on the values passed in through Params_t and never touches a Fact or QObject, so it can be run
+/// on a worker thread. A running generation checks the cancel flag between steps and returns early once it is set.
+class SurveyGridGenerator
+{
+public:
+    /// Must match SurveyMissionItem::EntryLocation
+    enum EntryLocation {
+        EntryLocationTopLeft,
+        EntryLocationTopRight,
+        EntryLocationBottomLeft,
+        EntryLocationBottomRight,
+    };
+
+    /// Point within a transect. Plain doubles avoid the per point allocation of QGeoCoordinate.
+    typedef struct {
+        double latitude;
+        double longitude;
+    } Point_t;
+
+    /// Set of transects stored back to back in a single point array
+    class Transects {
+    public:
+        Transects(void) { _starts.append(0); }
+
+        int     count       (void) const { return _starts.count() - 1; }
+        bool    isEmpty     (void) const { return count() == 0; }
+        int     pointCount  (int transectIndex) const { return _starts[transectIndex + 1] - _starts[transectIndex]; }
+
+        const Point_t&  point       (int transectIndex, int pointIndex) const { return _points[_starts[transectIndex] + pointIndex]; }
+        QGeoCoordinate  coordinate  (int transectIndex, int pointIndex) const;
+        QGeoCoordinate  entry       (int transectIndex) const { return coordinate(transectIndex, 0); }
+        QGeoCoordinate  exit        (int transectIndex) const { return coordinate(transectIndex, pointCount(transectIndex) - 1); }
+
+        /// Adds a point to the end of the transect which is currently being built
+        void appendPoint(const Point_t& point) { _points.append(point); }
+
+        /// Completes the transect which is currently being built
+        void endTransect(void) { _starts.append(_points.count()); }
+
+        /// Reverse the order of the transects. First transect becomes last and so forth.
+        void reverseTransectOrder(void);
+
+        /// Reverse the order of all points within each transect. First point becomes last and so forth.
+        void reverseInternalPoints(void);
+
+        void clear(void);
+
+    private:
+        QVector<Point_t>    _points;    ///< Points for all transects
+        QVector<int>        _starts;    ///< Index of first point for each transect, followed by the total point count
+    };
+
+    typedef struct {
+        QList<QGeoCoordinate>           polygon;                ///< Survey area, may be concave
+        QList<QList<QGeoCoordinate>>    holes;                  ///< Exclusion areas within the survey area
+        double                          gridAngle;
+        double                          gridSpacing;
+        int                             entryLocation;
+        double                          turnaroundDistance;     ///< 0 for no turnaround
+        double                          triggerDistance;        ///< 0 for no camera triggering
+        bool                            imagesEverywhere;       ///< true: camera triggers in turnarounds as well
+        bool                            hoverAndCapture;
+        bool                            refly90Degrees;
+    } Params_t;
+
+    typedef struct {
+        Transects       transects;          ///< Transects including turnaround and internal camera points
+        Transects       reflyTransects;     ///< Refly transects, empty if no refly
+        QVariantList    gridPoints;         ///< Entry and exit coordinates of each transect for map visuals
+        double          coveredArea;
+        double          surveyDistance;
+        int             cameraShots;
+    } Grid_t;
+
+    /// Generates the grid for the specified parameters.
+    ///     @param cancel Generation stops early if this becomes non-zero, NULL for no cancellation
+    /// @return Generated grid, only partially filled in if generation was cancelled
+    static Grid_t generate(const Params_t& params, const QAtomicInt* cancel);
+
+private:
+    /// Polygon edge for the scanline sweep, oriented from lower to upper y
+    typedef struct {
+        double yMin;
+        double yMax;
+        double xAtYMin;
+        double dxdy;
+    } ScanEdge_t;
+
+    static bool     _cancelled                          (const QAtomicInt* cancel) { return cancel && cancel->load(); }
+    static int      _gridGenerator                      (const Params_t& params, const QList<QPolygonF>& rings, QList<QList<QPointF>>& transectSegments, bool refly, const QAtomicInt* cancel);
+    static QPolygonF _polygonToNed                      (const QList<QGeoCoordinate>& polygon, const GeoOrigin_t& tangentOrigin);
+    static double   _polygonArea                        (const QPolygonF& polygon);
+    static bool     _ringEdgesCross                     (const QPolygonF& ring1, const QPolygonF& ring2);
+    static bool     _ringInsideRing                     (const QPolygonF& inner, const QPolygonF& outer);
+    static bool     _ringsOverlap                       (const QPolygonF& ring1, const QPolygonF& ring2);
+    static QPointF  _rotatePoint                        (const QPointF& point, const QPointF& origin, double angle);
+    static int      _clipScanlines                      (const QList<QPolygonF>& rings, const QVector<double>& scanPositions, QVector<QVector<QPointF>>& scanIntervals, const QAtomicInt* cancel);
+    static void     _orderTransects                     (const QVector<QVector<QLineF>>& scanLines, const QVector<double>& scanPositions, QList<QLineF>& resultLines, const QAtomicInt* cancel);
+    static int      _findScan                           (QVector<int>& links, int index);
+    static void     _checkNextTransect                  (const QPointF& position, const QLineF& line, int lineIndex, int& next, double& nextDistance, bool& nextReversed);
+    static void     _convertTransectToGeo               (const QList<QList<QPointF>>& transectSegmentsNED, const GeoOrigin_t& tangentOrigin, Transects& transects);
+    static void     _optimizeTransectsForShortestDistance(const QGeoCoordinate& distanceCoord, Transects& transects);
+    static void     _adjustTransectsToEntryPointLocation(const Params_t& params, Transects& transects);
+    static void     _appendGridPointsFromTransects      (const Transects& transects, QVariantList& gridPoints);
+    static void     _appendEntryExitPoints              (const Transects& transects, QVector<double>& latitudes, QVector<double>& longitudes);
+    static bool     _gridAngleIsNorthSouthTransects     (double gridAngle);
+    static double   _clampGridAngle90                   (double gridAngle);
+};
+
+Q_DECLARE_TYPEINFO(SurveyGridGenerator::Point_t, Q_PRIMITIVE_TYPE);
+
+#endif
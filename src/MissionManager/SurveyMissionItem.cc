@@ -9,13 +9,12 @@
 
 
 #include "SurveyMissionItem.h"
+#include "QGCGeo.h"
 #include "JsonHelper.h"
 #include "MissionController.h"
-#include "QGCGeo.h"
 #include "QGroundControlQmlGlobal.h"
-#include "QGCQGeoCoordinate.h"
 
-#include <QPolygonF>
+#include <QtConcurrent>
 
 QGC_LOGGING_CATEGORY(SurveyMissionItemLog, "SurveyMissionItemLog")
 
@@ -46,6 +45,7 @@ const char* SurveyMissionItem::_jsonManualGridKey =                 "manualGrid"
 const char* SurveyMissionItem::_jsonCameraOrientationLandscapeKey = "orientationLandscape";
 const char* SurveyMissionItem::_jsonFixedValueIsAltitudeKey =       "fixedValueIsAltitude";
 const char* SurveyMissionItem::_jsonRefly90DegreesKey =             "refly90Degrees";
+const char* SurveyMissionItem::_jsonExclusionPolygonsKey =          "exclusionPolygons";
 
 const char* SurveyMissionItem::settingsGroup =                  "Survey";
 const char* SurveyMissionItem::manualGridName =                 "ManualGrid";
@@ -86,6 +86,8 @@ SurveyMissionItem::SurveyMissionItem(Vehicle* vehicle, QObject* parent)
     , _cameraShots(0)
     , _coveredArea(0.0)
     , _timeBetweenShots(0.0)
+    , _gridRegeneratePending(false)
+    , _gridPublishPending(false)
     , _metaDataMap(FactMetaData::createMapFromJsonFile(QStringLiteral(":/json/Survey.SettingsGroup.json"), this))
     , _manualGridFact                   (settingsGroup, _metaDataMap[manualGridName])
     , _gridAltitudeFact                 (settingsGroup, _metaDataMap[gridAltitudeName])
@@ -128,7 +130,7 @@ SurveyMissionItem::SurveyMissionItem(Vehicle* vehicle, QObject* parent)
 
     connect(&_gridAltitudeFact,                 &Fact::valueChanged, this, &SurveyMissionItem::_updateCoordinateAltitude);
 
-    connect(&_gridAltitudeRelativeFact,         &Fact::valueChanged, this, &SurveyMissionItem::_setDirty);
+    connect(&_gridAltitudeRelativeFact,         &Fact::valueChanged, this, &SurveyMissionItem::_updateCoordinateAltitudeRelative);
 
     // Signal to Qml when camera value changes so it can recalc
     connect(&_groundResolutionFact,             &Fact::valueChanged, this, &SurveyMissionItem::_cameraValueChanged);
@@ -145,6 +147,18 @@ SurveyMissionItem::SurveyMissionItem(Vehicle* vehicle, QObject* parent)
 
     connect(&_mapPolygon, &QGCMapPolygon::dirtyChanged, this, &SurveyMissionItem::_polygonDirtyChanged);
     connect(&_mapPolygon, &QGCMapPolygon::pathChanged,  this, &SurveyMissionItem::_generateGrid);
+
+    // Exclusion polygons report dirty through the list model
+    connect(&_exclusionPolygons, &QmlObjectListModel::dirtyChanged, this, &SurveyMissionItem::_polygonDirtyChanged);
+
+    connect(&_gridWatcher, &QFutureWatcherBase::finished, this, &SurveyMissionItem::_gridGenerationFinished);
+}
+
+SurveyMissionItem::~SurveyMissionItem()
+{
+    // A running generation references _gridCancel so it can't outlive us
+    _cancelGridGeneration();
+    _gridWatcher.waitForFinished();
 }
 
 void SurveyMissionItem::_setSurveyDistance(double surveyDistance)
@@ -180,6 +194,8 @@ void SurveyMissionItem::_clearInternal(void)
     emit gridPointsChanged();
     _simpleGridPoints.clear();
     _transectSegments.clear();
+    _reflyTransectSegments.clear();
+    _cancelGridGeneration();
 
     _missionCommandCount = 0;
 
@@ -253,6 +269,17 @@ void SurveyMissionItem::save(QJsonArray&  missionItems)
     // Polygon shape
     _mapPolygon.saveToJson(saveObject);
 
+    if (_exclusionPolygons.count()) {
+        QJsonArray exclusionArray;
+        for (int i=0; i<_exclusionPolygons.count(); i++) {
+            QJsonObject exclusionObject;
+            _exclusionPolygons.value<QGCMapPolygon*>(i)->saveToJson(exclusionObject);
+            exclusionArray.append(exclusionObject);
+        }
+        saveObject[_jsonExclusionPolygonsKey] = exclusionArray;
+    }
+    _exclusionPolygons.setDirty(false);
+
     missionItems.append(saveObject);
 }
 
@@ -302,6 +329,7 @@ bool SurveyMissionItem::load(const QJsonObject& complexObject, int sequenceNumbe
         { _jsonFixedValueIsAltitudeKey,                 QJsonValue::Bool,   true },
         { _jsonHoverAndCaptureKey,                      QJsonValue::Bool,   false },
         { _jsonRefly90DegreesKey,                       QJsonValue::Bool,   false },
+        { _jsonExclusionPolygonsKey,                    QJsonValue::Array,  false },
     };
     if (!JsonHelper::validateKeys(v2Object, mainKeyInfoList, errorString)) {
         return false;
@@ -317,6 +345,7 @@ bool SurveyMissionItem::load(const QJsonObject& complexObject, int sequenceNumbe
     _ignoreRecalc = true;
 
     _mapPolygon.clear();
+    _exclusionPolygons.clearAndDeleteContents();
 
     setSequenceNumber(sequenceNumber);
 
@@ -407,20 +436,45 @@ bool SurveyMissionItem::load(const QJsonObject& complexObject, int sequenceNumbe
         return false;
     }
 
+    QJsonArray exclusionArray = v2Object[_jsonExclusionPolygonsKey].toArray();
+    for (int i=0; i<exclusionArray.count(); i++) {
+        QGCMapPolygon* exclusionPolygon = _newExclusionPolygon();
+        if (!exclusionPolygon->loadFromJson(exclusionArray[i].toObject(), true /* required */, errorString)) {
+            _mapPolygon.clear();
+            _exclusionPolygons.clearAndDeleteContents();
+            return false;
+        }
+    }
+    _exclusionPolygons.setDirty(false);
+
     _ignoreRecalc = false;
-    _generateGrid();
+    _generateGridNow();
 
     return true;
 }
 
 double SurveyMissionItem::greatestDistanceTo(const QGeoCoordinate &other) const
 {
-    double greatestDistance = 0.0;
-    for (int i=0; i<_simpleGridPoints.count(); i++) {
+    double          greatestDistance = 0.0;
+    int             count = _simpleGridPoints.count();
+    QVector<double> latitudes(count);
+    QVector<double> longitudes(count);
+    QVector<double> distances(count);
+
+    if (!other.isValid()) {
+        return greatestDistance;
+    }
+
+    for (int i=0; i<count; i++) {
         QGeoCoordinate currentCoord = _simpleGridPoints[i].value<QGeoCoordinate>();
-        double distance = currentCoord.distanceTo(other);
-        if (distance > greatestDistance) {
-            greatestDistance = distance;
+        latitudes[i] = currentCoord.latitude();
+        longitudes[i] = currentCoord.longitude();
+    }
+    geoDistances(other.latitude(), other.longitude(), latitudes.constData(), longitudes.constData(), count, distances.data());
+
+    for (int i=0; i<count; i++) {
+        if (distances[i] > greatestDistance) {
+            greatestDistance = distances[i];
         }
     }
     return greatestDistance;
@@ -439,313 +493,116 @@ bool SurveyMissionItem::specifiesCoordinate(void) const
     return _mapPolygon.count() > 2;
 }
 
-void _calcCameraShots()
-{
-
-}
-
-void SurveyMissionItem::_convertTransectToGeo(const QList<QList<QPointF>>& transectSegmentsNED, const QGeoCoordinate& tangentOrigin, QList<QList<QGeoCoordinate>>& transectSegmentsGeo)
-{
-    transectSegmentsGeo.clear();
-
-    for (int i=0; i<transectSegmentsNED.count(); i++) {
-        QList<QGeoCoordinate>   transectCoords;
-        const QList<QPointF>&   transectPoints = transectSegmentsNED[i];
-
-        for (int j=0; j<transectPoints.count(); j++) {
-            QGeoCoordinate coord;
-            const QPointF& point = transectPoints[j];
-            convertNedToGeo(point.y(), point.x(), 0, tangentOrigin, &coord);
-            transectCoords.append(coord);
-        }
-        transectSegmentsGeo.append(transectCoords);
-    }
-}
-
-/// Reverse the order of the transects. First transect becomes last and so forth.
-void SurveyMissionItem::_reverseTransectOrder(QList<QList<QGeoCoordinate>>& transects)
+/// Starts generation of the grid on a worker thread. If a generation is already running it is cancelled and the grid is
+/// generated again once it finishes, so only the result for the latest values is published.
+void SurveyMissionItem::_generateGrid(void)
 {
-    QList<QList<QGeoCoordinate>> rgReversedTransects;
-    for (int i=transects.count() - 1; i>=0; i--) {
-        rgReversedTransects.append(transects[i]);
+    if (_ignoreRecalc) {
+        return;
     }
-    transects = rgReversedTransects;
-}
 
-/// Reverse the order of all points withing each transect, First point becomes last and so forth.
-void SurveyMissionItem::_reverseInternalTransectPoints(QList<QList<QGeoCoordinate>>& transects)
-{
-    for (int i=0; i<transects.count(); i++) {
-        QList<QGeoCoordinate> rgReversedCoords;
-        QList<QGeoCoordinate>& rgOriginalCoords = transects[i];
-        for (int j=rgOriginalCoords.count()-1; j>=0; j--) {
-            rgReversedCoords.append(rgOriginalCoords[j]);
-        }
-        transects[i] = rgReversedCoords;
+    if (_mapPolygon.count() < 3 || _gridSpacingFact.rawValue().toDouble() <= 0) {
+        _clearInternal();
+        return;
     }
-}
 
-/// Reorders the transects such that the first transect is the shortest distance to the specified coordinate
-/// and the first point within that transect is the shortest distance to the specified coordinate.
-///     @param distanceCoord Coordinate to measure distance against
-///     @param transects Transects to test and reorder
-void SurveyMissionItem::_optimizeTransectsForShortestDistance(const QGeoCoordinate& distanceCoord, QList<QList<QGeoCoordinate>>& transects)
-{
-    double rgTransectDistance[4];
-    rgTransectDistance[0] = transects.first().first().distanceTo(distanceCoord);
-    rgTransectDistance[1] = transects.first().last().distanceTo(distanceCoord);
-    rgTransectDistance[2] = transects.last().first().distanceTo(distanceCoord);
-    rgTransectDistance[3] = transects.last().last().distanceTo(distanceCoord);
-
-    int shortestIndex = 0;
-    double shortestDistance = rgTransectDistance[0];
-    for (int i=1; i<3; i++) {
-        if (rgTransectDistance[i] < shortestDistance) {
-            shortestIndex = i;
-            shortestDistance = rgTransectDistance[i];
-        }
+    if (_gridWatcher.isRunning()) {
+        _gridCancel.store(1);
+        _gridRegeneratePending = true;
+    } else {
+        _startGridGeneration();
     }
 
-    if (shortestIndex > 1) {
-        // We need to reverse the order of segments
-        _reverseTransectOrder(transects);
-    }
-    if (shortestIndex & 1) {
-        // We need to reverse the points within each segment
-        _reverseInternalTransectPoints(transects);
-    }
+    // The grid values themselves change once generation completes, but the user edit makes us dirty right away
+    setDirty(true);
 }
 
-void SurveyMissionItem::_appendGridPointsFromTransects(QList<QList<QGeoCoordinate>>& rgTransectSegments)
+SurveyGridGenerator::Params_t SurveyMissionItem::gridParams(void) const
 {
-    qCDebug(SurveyMissionItemLog) << "Entry point _appendGridPointsFromTransects" << rgTransectSegments.first().first();
+    SurveyGridGenerator::Params_t params;
 
-    for (int i=0; i<rgTransectSegments.count(); i++) {
-        _simpleGridPoints.append(QVariant::fromValue(rgTransectSegments[i].first()));
-        _simpleGridPoints.append(QVariant::fromValue(rgTransectSegments[i].last()));
+    params.polygon =            _mapPolygon.coordinateList();
+    for (int i=0; i<_exclusionPolygons.count(); i++) {
+        params.holes.append(qobject_cast<const QGCMapPolygon*>(_exclusionPolygons[i])->coordinateList());
     }
-}
+    params.gridAngle =          _gridAngleFact.rawValue().toDouble();
+    params.gridSpacing =        _gridSpacingFact.rawValue().toDouble();
+    params.entryLocation =      _gridEntryLocationFact.rawValue().toInt();
+    params.turnaroundDistance = _hasTurnaround() ? _turnaroundDistance() : 0;
+    params.triggerDistance =    _triggerCamera() ? _triggerDistance() : 0;
+    params.imagesEverywhere =   _imagesEverywhere();
+    params.hoverAndCapture =    _hoverAndCaptureEnabled();
+    params.refly90Degrees =     _refly90Degrees;
 
-qreal SurveyMissionItem::_ccw(QPointF pt1, QPointF pt2, QPointF pt3)
-{
-    return (pt2.x()-pt1.x())*(pt3.y()-pt1.y()) - (pt2.y()-pt1.y())*(pt3.x()-pt1.x());
+    return params;
 }
 
-qreal SurveyMissionItem::_dp(QPointF pt1, QPointF pt2)
+void SurveyMissionItem::_startGridGeneration(void)
 {
-    return (pt2.x()-pt1.x())/qSqrt((pt2.x()-pt1.x())*(pt2.x()-pt1.x()) + (pt2.y()-pt1.y())*(pt2.y()-pt1.y()));
+    qCDebug(SurveyMissionItemLog) << "_startGridGeneration";
+
+    _gridCancel.store(0);
+    _gridRegeneratePending = false;
+    _gridPublishPending = true;
+    _gridWatcher.setFuture(QtConcurrent::run(SurveyGridGenerator::generate, gridParams(), &_gridCancel));
 }
 
-void SurveyMissionItem::_swapPoints(QList<QPointF>& points, int index1, int index2)
+void SurveyMissionItem::_cancelGridGeneration(void)
 {
-    QPointF temp = points[index1];
-    points[index1] = points[index2];
-    points[index2] = temp;
+    _gridCancel.store(1);
+    _gridRegeneratePending = false;
+    _gridPublishPending = false;
 }
 
-QList<QPointF> SurveyMissionItem::_convexPolygon(const QList<QPointF>& polygon)
+void SurveyMissionItem::_gridGenerationFinished(void)
 {
-    // We use the Graham scan algorithem to convert the possibly concave polygon to a convex polygon
-    // https://en.wikipedia.org/wiki/Graham_scan
-
-    QList<QPointF> workPolygon(polygon);
-
-    // First point must be lowest y-coordinate point
-    for (int i=1; i<workPolygon.count(); i++) {
-        if (workPolygon[i].y() < workPolygon[0].y()) {
-            _swapPoints(workPolygon, i, 0);
-        }
-    }
-
-    // Sort the points by angle with first point
-    for (int i=1; i<workPolygon.count(); i++) {
-        qreal angle = _dp(workPolygon[0], workPolygon[i]);
-        for (int j=i+1; j<workPolygon.count(); j++) {
-            if (_dp(workPolygon[0], workPolygon[j]) > angle) {
-                _swapPoints(workPolygon, i, j);
-                angle = _dp(workPolygon[0], workPolygon[j]);
-            }
-        }
-    }
-
-    // Perform the the Graham scan
-
-    workPolygon.insert(0, workPolygon.last());  // Sentinel for algo stop
-    int convexCount = 1;                        // Number of points on the convex hull.
-
-    for (int i=2; i<=polygon.count(); i++) {
-        while (_ccw(workPolygon[convexCount-1], workPolygon[convexCount], workPolygon[i]) <= 0) {
-            if (convexCount > 1) {
-                convexCount -= 1;
-            } else if (i == polygon.count()) {
-                break;
-            } else {
-                i++;
-            }
+    if (_gridCancel.load()) {
+        qCDebug(SurveyMissionItemLog) << "_gridGenerationFinished superseded, regenerate:" << _gridRegeneratePending;
+        if (_gridRegeneratePending) {
+            _startGridGeneration();
         }
-        convexCount++;
-        _swapPoints(workPolygon, convexCount, i);
+        return;
     }
 
-    return workPolygon.mid(1, convexCount);
-}
-
-/// Returns true if the current grid angle generates north/south oriented transects
-bool SurveyMissionItem::_gridAngleIsNorthSouthTransects()
-{
-    // Grid angle ranges from -360<->360
-    double gridAngle = qAbs(_gridAngleFact.rawValue().toDouble());
-    return gridAngle < 45.0 || (gridAngle > 360.0 - 45.0) || (gridAngle > 90.0 + 45.0 && gridAngle < 270.0 - 45.0);
+    _publishGrid(_gridWatcher.result());
 }
 
-void SurveyMissionItem::_adjustTransectsToEntryPointLocation(QList<QList<QGeoCoordinate>>& transects)
+/// Makes sure the published grid matches the current values, generating it right away if a generation is outstanding
+void SurveyMissionItem::_flushGridGeneration(void)
 {
-    if (transects.count() == 0) {
-        return;
-    }
-
-    // First determine what location the current entry point is at
-
-    QGeoCoordinate& firstTransectEntry = transects.first().first();
-    QGeoCoordinate& firstTransectExit = transects.first().last();
-    QGeoCoordinate& lastTransectExit = transects.last().last();
-
-    bool northSouthTransects = _gridAngleIsNorthSouthTransects();
-    bool entryPointBottom;
-    bool entryPointLeft;
-
-    qCDebug(SurveyMissionItemLog) << "Original entry point" << transects.first().first();
-    qCDebug(SurveyMissionItemLog) << "northSouthTransects" << northSouthTransects;
-
-    if (northSouthTransects) {
-        double firstTransectAzimuth = firstTransectEntry.azimuthTo(firstTransectExit);
-        qCDebug(SurveyMissionItemLog) << "firstTransectAzimuth" << firstTransectAzimuth;
-        entryPointBottom = (firstTransectAzimuth >= 0.0 && firstTransectAzimuth < 90.0) || (firstTransectAzimuth > 270.0 && firstTransectAzimuth <= 360.0);
-        qCDebug(SurveyMissionItemLog) << (entryPointBottom ? "Entry point is at bottom" : "Entry point is at top");
-
-        double entryToExitAzimuth = firstTransectEntry.azimuthTo(lastTransectExit);
-        qCDebug(SurveyMissionItemLog) << "entryToExitAzimuth" << entryToExitAzimuth;
-        entryPointLeft = entryToExitAzimuth <= 180.0;
-        qCDebug(SurveyMissionItemLog) << (entryPointLeft ? "Entry point is at left" : "Entry point is at right");
-    } else {
-        double firstTransectAzimuth = firstTransectEntry.azimuthTo(firstTransectExit);
-        qCDebug(SurveyMissionItemLog) << "firstTransectAzimuth" << firstTransectAzimuth;
-        entryPointLeft = firstTransectAzimuth <= 180.0;
-        qCDebug(SurveyMissionItemLog) << (entryPointLeft ? "Entry point is at left" : "Entry point is at right");
-
-        double entryToExitAzimuth = firstTransectEntry.azimuthTo(lastTransectExit);
-        qCDebug(SurveyMissionItemLog) << "entryToExitAzimuth" << entryToExitAzimuth;
-        entryPointBottom = (entryToExitAzimuth >= 0.0 && entryToExitAzimuth < 90.0) || (entryToExitAzimuth > 270.0 && entryToExitAzimuth <= 360.0);
-        qCDebug(SurveyMissionItemLog) << (entryPointBottom ? "Entry point is at bottom" : "Entry point is at top");
-    }
-
-    // Now adjust the transects such that the entry point matches the requested location
-
-    int entryLocation = _gridEntryLocationFact.rawValue().toInt();
-    bool reverseTransects;
-    bool reversePoints;
-    if (northSouthTransects) {
-        reversePoints = ((entryLocation == EntryLocationTopLeft || entryLocation == EntryLocationTopRight) && entryPointBottom) ||
-                ((entryLocation == EntryLocationBottomLeft || entryLocation == EntryLocationBottomRight) && !entryPointBottom);
-        reverseTransects = ((entryLocation == EntryLocationTopRight || entryLocation == EntryLocationBottomRight) && entryPointLeft) ||
-                ((entryLocation == EntryLocationTopLeft || entryLocation == EntryLocationBottomLeft) && !entryPointLeft);
-    } else {
-        reverseTransects = ((entryLocation == EntryLocationTopLeft || entryLocation == EntryLocationTopRight) && entryPointBottom) ||
-                ((entryLocation == EntryLocationBottomLeft || entryLocation == EntryLocationBottomRight) && !entryPointBottom);
-        reversePoints = ((entryLocation == EntryLocationTopRight || entryLocation == EntryLocationBottomRight) && entryPointLeft) ||
-                ((entryLocation == EntryLocationTopLeft || entryLocation == EntryLocationBottomLeft) && !entryPointLeft);
-    }
-    if (reversePoints) {
-        qCDebug(SurveyMissionItemLog) << "Reverse Points";
-        _reverseInternalTransectPoints(transects);
+    if (_gridPublishPending) {
+        _generateGridNow();
     }
-    if (reverseTransects) {
-        // The only way we should end up here is if there is a bug in the original grid line generation
-        qCDebug(SurveyMissionItemLog) << "Not Reverse Transects";
-        //_reverseTransectOrder(transects);
-    }
-    qCDebug(SurveyMissionItemLog) << "Modified entry point" << transects.first().first();
 }
 
-void SurveyMissionItem::_generateGrid(void)
+void SurveyMissionItem::_generateGridNow(void)
 {
-    if (_ignoreRecalc) {
-        return;
-    }
+    _cancelGridGeneration();
+    _gridWatcher.waitForFinished();
 
     if (_mapPolygon.count() < 3 || _gridSpacingFact.rawValue().toDouble() <= 0) {
         _clearInternal();
         return;
     }
 
-    _simpleGridPoints.clear();
-    _transectSegments.clear();
-    _reflyTransectSegments.clear();
-    _additionalFlightDelaySeconds = 0;
-
-    QList<QPointF>          polygonPoints;
-    QList<QList<QPointF>>   transectSegments;
-
-    // Convert polygon to NED
-    QGeoCoordinate tangentOrigin = _mapPolygon.pathModel().value<QGCQGeoCoordinate*>(0)->coordinate();
-    qCDebug(SurveyMissionItemLog) << "Convert polygon to NED - tangentOrigin" << tangentOrigin;
-    for (int i=0; i<_mapPolygon.count(); i++) {
-        double y, x, down;
-        QGeoCoordinate vertex = _mapPolygon.pathModel().value<QGCQGeoCoordinate*>(i)->coordinate();
-        if (i == 0) {
-            // This avoids a nan calculation that comes out of convertGeoToNed
-            x = y = 0;
-        } else {
-            convertGeoToNed(vertex, tangentOrigin, &y, &x, &down);
-        }
-        polygonPoints += QPointF(x, y);
-        qCDebug(SurveyMissionItemLog) << "vertex:x:y" << vertex << polygonPoints.last().x() << polygonPoints.last().y();
-    }
-
-    polygonPoints = _convexPolygon(polygonPoints);
-
-    double coveredArea = 0.0;
-    for (int i=0; i<polygonPoints.count(); i++) {
-        if (i != 0) {
-            coveredArea += polygonPoints[i - 1].x() * polygonPoints[i].y() - polygonPoints[i].x() * polygonPoints[i -1].y();
-        } else {
-            coveredArea += polygonPoints.last().x() * polygonPoints[i].y() - polygonPoints[i].x() * polygonPoints.last().y();
-        }
-    }
-    _setCoveredArea(0.5 * fabs(coveredArea));
-
-    // Generate grid
-    int cameraShots = 0;
-    cameraShots += _gridGenerator(polygonPoints, transectSegments, false /* refly */);
-    _convertTransectToGeo(transectSegments, tangentOrigin, _transectSegments);
-    _adjustTransectsToEntryPointLocation(_transectSegments);
-    _appendGridPointsFromTransects(_transectSegments);
-    if (_refly90Degrees) {
-        QVariantList reflyPointsGeo;
+    _publishGrid(SurveyGridGenerator::generate(gridParams(), NULL));
+}
 
-        transectSegments.clear();
-        cameraShots += _gridGenerator(polygonPoints, transectSegments, true /* refly */);
-        _convertTransectToGeo(transectSegments, tangentOrigin, _reflyTransectSegments);
-        _optimizeTransectsForShortestDistance(_transectSegments.last().last(), _reflyTransectSegments);
-        _appendGridPointsFromTransects(_reflyTransectSegments);
-    }
+void SurveyMissionItem::_publishGrid(const SurveyGridGenerator::Grid_t& grid)
+{
+    _gridPublishPending = false;
 
-    // Calc survey distance
-    double surveyDistance = 0.0;
-    for (int i=1; i<_simpleGridPoints.count(); i++) {
-        QGeoCoordinate coord1 = _simpleGridPoints[i-1].value<QGeoCoordinate>();
-        QGeoCoordinate coord2 = _simpleGridPoints[i].value<QGeoCoordinate>();
-        surveyDistance += coord1.distanceTo(coord2);
-    }
-    _setSurveyDistance(surveyDistance);
+    _simpleGridPoints = grid.gridPoints;
+    _transectSegments = grid.transects;
+    _reflyTransectSegments = grid.reflyTransects;
 
-    if (cameraShots == 0 && _triggerCamera()) {
-        cameraShots = (int)ceil(surveyDistance / _triggerDistance());
-    }
-    _setCameraShots(cameraShots);
+    _setCoveredArea(grid.coveredArea);
+    _setSurveyDistance(grid.surveyDistance);
+    _setCameraShots(grid.cameraShots);
 
+    _additionalFlightDelaySeconds = 0;
     if (_hoverAndCaptureEnabled()) {
-        _additionalFlightDelaySeconds = cameraShots * _hoverAndCaptureDelaySeconds;
+        _additionalFlightDelaySeconds = grid.cameraShots * _hoverAndCaptureDelaySeconds;
     }
     emit additionalTimeDelayChanged(_additionalFlightDelaySeconds);
 
@@ -755,12 +612,12 @@ void SurveyMissionItem::_generateGrid(void)
 
     _missionCommandCount= 0;
     for (int i=0; i<_transectSegments.count(); i++) {
-        const QList<QGeoCoordinate>& transectSegment = _transectSegments[i];
+        int pointCount = _transectSegments.pointCount(i);
 
-        _missionCommandCount += transectSegment.count();    // This accounts for all waypoints
+        _missionCommandCount += pointCount;                 // This accounts for all waypoints
         if (_hoverAndCaptureEnabled()) {
             // Internal camera trigger points are entry point, plus all points before exit point
-            _missionCommandCount += transectSegment.count() - (_hasTurnaround() ? 2 : 0) - 1;
+            _missionCommandCount += pointCount - (_hasTurnaround() ? 2 : 0) - 1;
         } else if (_triggerCamera()) {
             _missionCommandCount += 2;                          // Camera on/off at entry/exit
         }
@@ -789,325 +646,11 @@ void SurveyMissionItem::_updateCoordinateAltitude(void)
     setDirty(true);
 }
 
-QPointF SurveyMissionItem::_rotatePoint(const QPointF& point, const QPointF& origin, double angle)
-{
-    QPointF rotated;
-    double radians = (M_PI / 180.0) * -angle;
-
-    rotated.setX(((point.x() - origin.x()) * cos(radians)) - ((point.y() - origin.y()) * sin(radians)) + origin.x());
-    rotated.setY(((point.x() - origin.x()) * sin(radians)) + ((point.y() - origin.y()) * cos(radians)) + origin.y());
-
-    return rotated;
-}
-
-void SurveyMissionItem::_intersectLinesWithRect(const QList<QLineF>& lineList, const QRectF& boundRect, QList<QLineF>& resultLines)
+void SurveyMissionItem::_updateCoordinateAltitudeRelative(void)
 {
-    QLineF topLine      (boundRect.topLeft(),       boundRect.topRight());
-    QLineF bottomLine   (boundRect.bottomLeft(),    boundRect.bottomRight());
-    QLineF leftLine     (boundRect.topLeft(),       boundRect.bottomLeft());
-    QLineF rightLine    (boundRect.topRight(),      boundRect.bottomRight());
-
-    for (int i=0; i<lineList.count(); i++) {
-        QPointF intersectPoint;
-        QLineF intersectLine;
-        const QLineF& line = lineList[i];
-
-        int foundCount = 0;
-        if (line.intersect(topLine, &intersectPoint) == QLineF::BoundedIntersection) {
-            intersectLine.setP1(intersectPoint);
-            foundCount++;
-        }
-        if (line.intersect(rightLine, &intersectPoint) == QLineF::BoundedIntersection) {
-            if (foundCount == 0) {
-                intersectLine.setP1(intersectPoint);
-            } else {
-                if (foundCount != 1) {
-                    qWarning() << "Found more than two intersecting points";
-                }
-                intersectLine.setP2(intersectPoint);
-            }
-            foundCount++;
-        }
-        if (line.intersect(bottomLine, &intersectPoint) == QLineF::BoundedIntersection) {
-            if (foundCount == 0) {
-                intersectLine.setP1(intersectPoint);
-            } else {
-                if (foundCount != 1) {
-                    qWarning() << "Found more than two intersecting points";
-                }
-                intersectLine.setP2(intersectPoint);
-            }
-            foundCount++;
-        }
-        if (line.intersect(leftLine, &intersectPoint) == QLineF::BoundedIntersection) {
-            if (foundCount == 0) {
-                intersectLine.setP1(intersectPoint);
-            } else {
-                if (foundCount != 1) {
-                    qWarning() << "Found more than two intersecting points";
-                }
-                intersectLine.setP2(intersectPoint);
-            }
-            foundCount++;
-        }
-
-        if (foundCount == 2) {
-            resultLines += intersectLine;
-        }
-    }
-}
-
-void SurveyMissionItem::_intersectLinesWithPolygon(const QList<QLineF>& lineList, const QPolygonF& polygon, QList<QLineF>& resultLines)
-{
-    resultLines.clear();
-    for (int i=0; i<lineList.count(); i++) {
-        int foundCount = 0;
-        QLineF intersectLine;
-        const QLineF& line = lineList[i];
-
-        for (int j=0; j<polygon.count()-1; j++) {
-            QPointF intersectPoint;
-            QLineF polygonLine = QLineF(polygon[j], polygon[j+1]);
-            if (line.intersect(polygonLine, &intersectPoint) == QLineF::BoundedIntersection) {
-                if (foundCount == 0) {
-                    foundCount++;
-                    intersectLine.setP1(intersectPoint);
-                } else {
-                    foundCount++;
-                    intersectLine.setP2(intersectPoint);
-                    break;
-                }
-            }
-        }
-
-        if (foundCount == 2) {
-            resultLines += intersectLine;
-        }
-    }
-}
-
-/// Adjust the line segments such that they are all going the same direction with respect to going from P1->P2
-void SurveyMissionItem::_adjustLineDirection(const QList<QLineF>& lineList, QList<QLineF>& resultLines)
-{
-    qreal firstAngle = 0;
-    for (int i=0; i<lineList.count(); i++) {
-        const QLineF& line = lineList[i];
-        QLineF adjustedLine;
-
-        if (i == 0) {
-            firstAngle = line.angle();
-        }
-
-        if (qAbs(line.angle() - firstAngle) > 1.0) {
-            adjustedLine.setP1(line.p2());
-            adjustedLine.setP2(line.p1());
-        } else {
-            adjustedLine = line;
-        }
-
-        resultLines += adjustedLine;
-    }
-}
-
-double SurveyMissionItem::_clampGridAngle90(double gridAngle)
-{
-    // Clamp grid angle to -90<->90. This prevents transects from being rotated to a reversed order.
-    if (gridAngle > 90.0) {
-        gridAngle -= 180.0;
-    } else if (gridAngle < -90.0) {
-        gridAngle += 180;
-    }
-    return gridAngle;
-}
-
-int SurveyMissionItem::_gridGenerator(const QList<QPointF>& polygonPoints,  QList<QList<QPointF>>& transectSegments, bool refly)
-{
-    int cameraShots = 0;
-
-    double gridAngle = _gridAngleFact.rawValue().toDouble();
-    double gridSpacing = _gridSpacingFact.rawValue().toDouble();
-
-    gridAngle = _clampGridAngle90(gridAngle);
-    gridAngle += refly ? 90 : 0;
-    qCDebug(SurveyMissionItemLog) << "Clamped grid angle" << gridAngle;
-
-    qCDebug(SurveyMissionItemLog) << "SurveyMissionItem::_gridGenerator gridSpacing:gridAngle:refly" << gridSpacing << gridAngle << refly;
-
-    transectSegments.clear();
-
-    // Convert polygon to bounding rect
-
-    qCDebug(SurveyMissionItemLog) << "Polygon";
-    QPolygonF polygon;
-    for (int i=0; i<polygonPoints.count(); i++) {
-        qCDebug(SurveyMissionItemLog) << polygonPoints[i];
-        polygon << polygonPoints[i];
-    }
-    polygon << polygonPoints[0];
-    QRectF smallBoundRect = polygon.boundingRect();
-    QPointF boundingCenter = smallBoundRect.center();
-    qCDebug(SurveyMissionItemLog) << "Bounding rect" << smallBoundRect.topLeft().x() << smallBoundRect.topLeft().y() << smallBoundRect.bottomRight().x() << smallBoundRect.bottomRight().y();
-
-    // Rotate the bounding rect around it's center to generate the larger bounding rect
-    QPolygonF boundPolygon;
-    boundPolygon << _rotatePoint(smallBoundRect.topLeft(),      boundingCenter, gridAngle);
-    boundPolygon << _rotatePoint(smallBoundRect.topRight(),     boundingCenter, gridAngle);
-    boundPolygon << _rotatePoint(smallBoundRect.bottomRight(),  boundingCenter, gridAngle);
-    boundPolygon << _rotatePoint(smallBoundRect.bottomLeft(),   boundingCenter, gridAngle);
-    boundPolygon << boundPolygon[0];
-    QRectF largeBoundRect = boundPolygon.boundingRect();
-    qCDebug(SurveyMissionItemLog) << "Rotated bounding rect" << largeBoundRect.topLeft().x() << largeBoundRect.topLeft().y() << largeBoundRect.bottomRight().x() << largeBoundRect.bottomRight().y();
-
-    // Create set of rotated parallel lines within the expanded bounding rect. Make the lines larger than the
-    // bounding box to guarantee intersection.
-
-    QList<QLineF> lineList;
-    bool northSouthTransects = _gridAngleIsNorthSouthTransects();
-    int entryLocation = _gridEntryLocationFact.rawValue().toInt();
-
-    if (northSouthTransects) {
-        qCDebug(SurveyMissionItemLog) << "Clamped grid angle" << gridAngle;
-        if (entryLocation == EntryLocationTopLeft || entryLocation == EntryLocationBottomLeft) {
-            // Generate transects from left to right
-            qCDebug(SurveyMissionItemLog) << "Generate left to right";
-            float x = largeBoundRect.topLeft().x() - (gridSpacing / 2);
-            while (x < largeBoundRect.bottomRight().x()) {
-                float yTop =    largeBoundRect.topLeft().y() - 10000.0;
-                float yBottom = largeBoundRect.bottomRight().y() + 10000.0;
-
-                lineList += QLineF(_rotatePoint(QPointF(x, yTop), boundingCenter, gridAngle), _rotatePoint(QPointF(x, yBottom), boundingCenter, gridAngle));
-                qCDebug(SurveyMissionItemLog) << "line(" << lineList.last().x1() << ", " << lineList.last().y1() << ")-(" << lineList.last().x2() <<", " << lineList.last().y2() << ")";
-
-                x += gridSpacing;
-            }
-        } else {
-            // Generate transects from right to left
-            qCDebug(SurveyMissionItemLog) << "Generate right to left";
-            float x = largeBoundRect.topRight().x() + (gridSpacing / 2);
-            while (x > largeBoundRect.bottomLeft().x()) {
-                float yTop =    largeBoundRect.topRight().y() - 10000.0;
-                float yBottom = largeBoundRect.bottomLeft().y() + 10000.0;
-
-                lineList += QLineF(_rotatePoint(QPointF(x, yTop), boundingCenter, gridAngle), _rotatePoint(QPointF(x, yBottom), boundingCenter, gridAngle));
-                qCDebug(SurveyMissionItemLog) << "line(" << lineList.last().x1() << ", " << lineList.last().y1() << ")-(" << lineList.last().x2() <<", " << lineList.last().y2() << ")";
-
-                x -= gridSpacing;
-            }
-        }
-    } else {
-        gridAngle = _clampGridAngle90(gridAngle - 90.0);
-        qCDebug(SurveyMissionItemLog) << "Clamped grid angle" << gridAngle;
-        if (entryLocation == EntryLocationTopLeft || entryLocation == EntryLocationTopRight) {
-            // Generate transects from top to bottom
-            qCDebug(SurveyMissionItemLog) << "Generate top to bottom";
-            float y = largeBoundRect.bottomLeft().y() + (gridSpacing / 2);
-            while (y > largeBoundRect.topRight().y()) {
-                float xLeft =   largeBoundRect.bottomLeft().x() - 10000.0;
-                float xRight =  largeBoundRect.topRight().x() + 10000.0;
-
-                lineList += QLineF(_rotatePoint(QPointF(xLeft, y), boundingCenter, gridAngle), _rotatePoint(QPointF(xRight, y), boundingCenter, gridAngle));
-                qCDebug(SurveyMissionItemLog) << "y:xLeft:xRight" << y << xLeft << xRight << "line(" << lineList.last().x1() << ", " << lineList.last().y1() << ")-(" << lineList.last().x2() <<", " << lineList.last().y2() << ")";
-
-                y -= gridSpacing;
-            }
-        } else {
-            // Generate transects from bottom to top
-            qCDebug(SurveyMissionItemLog) << "Generate bottom to top";
-            float y = largeBoundRect.topLeft().y() - (gridSpacing / 2);
-            while (y < largeBoundRect.bottomRight().y()) {
-                float xLeft =   largeBoundRect.topLeft().x() - 10000.0;
-                float xRight =  largeBoundRect.bottomRight().x() + 10000.0;
-
-                lineList += QLineF(_rotatePoint(QPointF(xLeft, y), boundingCenter, gridAngle), _rotatePoint(QPointF(xRight, y), boundingCenter, gridAngle));
-                qCDebug(SurveyMissionItemLog) << "y:xLeft:xRight" << y << xLeft << xRight << "line(" << lineList.last().x1() << ", " << lineList.last().y1() << ")-(" << lineList.last().x2() <<", " << lineList.last().y2() << ")";
-
-                y += gridSpacing;
-            }
-        }
-    }
-
-    // Now intersect the lines with the polygon
-    QList<QLineF> intersectLines;
-#if 1
-    _intersectLinesWithPolygon(lineList, polygon, intersectLines);
-#else
-    // This is handy for debugging grid problems, not for release
-    intersectLines = lineList;
-#endif
-
-    // Less than two transects intersected with the polygon:
-    //      Create a single transect which goes through the center of the polygon
-    //      Intersect it with the polygon
-    if (intersectLines.count() < 2) {
-        _mapPolygon.center();
-        QLineF firstLine = lineList.first();
-        QPointF lineCenter = firstLine.pointAt(0.5);
-        QPointF centerOffset = boundingCenter - lineCenter;
-        firstLine.translate(centerOffset);
-        lineList.clear();
-        lineList.append(firstLine);
-        intersectLines = lineList;
-        _intersectLinesWithPolygon(lineList, polygon, intersectLines);
-    }
-
-    // Make sure all lines are going to same direction. Polygon intersection leads to line which
-    // can be in varied directions depending on the order of the intesecting sides.
-    QList<QLineF> resultLines;
-    _adjustLineDirection(intersectLines, resultLines);
-
-    // Calc camera shots here if there are no images in turnaround
-    if (_triggerCamera() && !_imagesEverywhere()) {
-        for (int i=0; i<resultLines.count(); i++) {
-            cameraShots += (int)ceil(resultLines[i].length() / _triggerDistance());
-        }
-    }
-
-    // Turn into a path
-    for (int i=0; i<resultLines.count(); i++) {
-        QLineF          transectLine;
-        QList<QPointF>  transectPoints;
-        const QLineF&   line = resultLines[i];
-
-        float turnaroundPosition = _turnaroundDistance() / line.length();
-
-        if (i & 1) {
-            transectLine = QLineF(line.p2(), line.p1());
-        } else {
-            transectLine = QLineF(line.p1(), line.p2());
-        }
-
-        // Build the points along the transect
-
-        if (_hasTurnaround()) {
-            transectPoints.append(transectLine.pointAt(-turnaroundPosition));
-        }
-
-        // Polygon entry point
-        transectPoints.append(transectLine.p1());
-
-        // For hover and capture we need points for each camera location
-        if (_triggerCamera() && _hoverAndCaptureEnabled()) {
-            if (_triggerDistance() < transectLine.length()) {
-                int innerPoints = floor(transectLine.length() / _triggerDistance());
-                qCDebug(SurveyMissionItemLog) << "innerPoints" << innerPoints;
-                float transectPositionIncrement = _triggerDistance() / transectLine.length();
-                for (int i=0; i<innerPoints; i++) {
-                    transectPoints.append(transectLine.pointAt(transectPositionIncrement * (i + 1)));
-                }
-            }
-        }
-
-        // Polygon exit point
-        transectPoints.append(transectLine.p2());
-
-        if (_hasTurnaround()) {
-            transectPoints.append(transectLine.pointAt(1 + turnaroundPosition));
-        }
-
-        transectSegments.append(transectPoints);
-    }
-
-    return cameraShots;
+    emit coordinateHasRelativeAltitudeChanged(coordinateHasRelativeAltitude());
+    emit exitCoordinateHasRelativeAltitudeChanged(exitCoordinateHasRelativeAltitude());
+    setDirty(true);
 }
 
 int SurveyMissionItem::_appendWaypointToMission(QList<MissionItem*>& items, int seqNum, QGeoCoordinate& coord, CameraTriggerCode cameraTrigger, QObject* missionItemParent)
@@ -1178,14 +721,14 @@ int SurveyMissionItem::_appendWaypointToMission(QList<MissionItem*>& items, int
     return seqNum;
 }
 
-bool SurveyMissionItem::_nextTransectCoord(const QList<QGeoCoordinate>& transectPoints, int pointIndex, QGeoCoordinate& coord)
+bool SurveyMissionItem::_nextTransectCoord(const SurveyGridGenerator::Transects& transects, int transectIndex, int pointIndex, QGeoCoordinate& coord)
 {
-    if (pointIndex > transectPoints.count()) {
+    if (pointIndex >= transects.pointCount(transectIndex)) {
         qWarning() << "Bad grid generation";
         return false;
     }
 
-    coord = transectPoints[pointIndex];
+    coord = transects.coordinate(transectIndex, pointIndex);
     return true;
 }
 
@@ -1202,7 +745,7 @@ bool SurveyMissionItem::_appendMissionItemsWorker(QList<MissionItem*>& items, QO
 
     qCDebug(SurveyMissionItemLog) << "hasTurnaround:triggerCamera:hoverAndCapture:imagesEverywhere:hasRefly:buildRefly" << _hasTurnaround() << _triggerCamera() << _hoverAndCaptureEnabled() << _imagesEverywhere() << hasRefly << buildRefly;
 
-    QList<QList<QGeoCoordinate>>& transectSegments = buildRefly ? _reflyTransectSegments : _transectSegments;
+    const SurveyGridGenerator::Transects& transectSegments = buildRefly ? _reflyTransectSegments : _transectSegments;
 
     if (!buildRefly && _imagesEverywhere()) {
         firstWaypointTrigger = true;
@@ -1212,13 +755,13 @@ bool SurveyMissionItem::_appendMissionItemsWorker(QList<MissionItem*>& items, QO
         int pointIndex = 0;
         QGeoCoordinate coord;
         CameraTriggerCode cameraTrigger;
-        const QList<QGeoCoordinate>& segment = transectSegments[segmentIndex];
+        int segmentCount = transectSegments.pointCount(segmentIndex);
 
-        qCDebug(SurveyMissionItemLog) << "segment.count" << segment.count();
+        qCDebug(SurveyMissionItemLog) << "segment.count" << segmentCount;
 
         if (_hasTurnaround()) {
             // Add entry turnaround point
-            if (!_nextTransectCoord(segment, pointIndex++, coord)) {
+            if (!_nextTransectCoord(transectSegments, segmentIndex, pointIndex++, coord)) {
                 return false;
             }
             seqNum = _appendWaypointToMission(items, seqNum, coord, firstWaypointTrigger ? CameraTriggerOn : CameraTriggerNone, missionItemParent);
@@ -1226,7 +769,7 @@ bool SurveyMissionItem::_appendMissionItemsWorker(QList<MissionItem*>& items, QO
         }
 
         // Add polygon entry point
-        if (!_nextTransectCoord(segment, pointIndex++, coord)) {
+        if (!_nextTransectCoord(transectSegments, segmentIndex, pointIndex++, coord)) {
             return false;
         }
         if (firstWaypointTrigger) {
@@ -1239,10 +782,10 @@ bool SurveyMissionItem::_appendMissionItemsWorker(QList<MissionItem*>& items, QO
 
         // Add internal hover and capture points
         if (_hoverAndCaptureEnabled()) {
-            int lastHoverAndCaptureIndex = segment.count() - 1 - (_hasTurnaround() ? 1 : 0);
+            int lastHoverAndCaptureIndex = segmentCount - 1 - (_hasTurnaround() ? 1 : 0);
             qCDebug(SurveyMissionItemLog) << "lastHoverAndCaptureIndex" << lastHoverAndCaptureIndex;
             for (; pointIndex < lastHoverAndCaptureIndex; pointIndex++) {
-                if (!_nextTransectCoord(segment, pointIndex, coord)) {
+                if (!_nextTransectCoord(transectSegments, segmentIndex, pointIndex, coord)) {
                     return false;
                 }
                 seqNum = _appendWaypointToMission(items, seqNum, coord, CameraTriggerHoverAndCapture, missionItemParent);
@@ -1250,7 +793,7 @@ bool SurveyMissionItem::_appendMissionItemsWorker(QList<MissionItem*>& items, QO
         }
 
         // Add polygon exit point
-        if (!_nextTransectCoord(segment, pointIndex++, coord)) {
+        if (!_nextTransectCoord(transectSegments, segmentIndex, pointIndex++, coord)) {
             return false;
         }
         cameraTrigger = _imagesEverywhere() || !_triggerCamera() ? CameraTriggerNone : (_hoverAndCaptureEnabled() ? CameraTriggerNone : CameraTriggerOff);
@@ -1258,7 +801,7 @@ bool SurveyMissionItem::_appendMissionItemsWorker(QList<MissionItem*>& items, QO
 
         if (_hasTurnaround()) {
             // Add exit turnaround point
-            if (!_nextTransectCoord(segment, pointIndex++, coord)) {
+            if (!_nextTransectCoord(transectSegments, segmentIndex, pointIndex++, coord)) {
                 return false;
             }
             seqNum = _appendWaypointToMission(items, seqNum, coord, CameraTriggerNone, missionItemParent);
@@ -1285,6 +828,8 @@ bool SurveyMissionItem::_appendMissionItemsWorker(QList<MissionItem*>& items, QO
 
 void SurveyMissionItem::appendMissionItems(QList<MissionItem*>& items, QObject* missionItemParent)
 {
+    _flushGridGeneration();
+
     int seqNum = _sequenceNumber;
 
     if (!_appendMissionItemsWorker(items, missionItemParent, seqNum, _refly90Degrees, false /* buildRefly */)) {
@@ -1372,6 +917,52 @@ void SurveyMissionItem::setRefly90Degrees(bool refly90Degrees)
     }
 }
 
+QGCMapPolygon* SurveyMissionItem::_newExclusionPolygon(void)
+{
+    QGCMapPolygon* exclusionPolygon = new QGCMapPolygon(this, this);
+
+    connect(exclusionPolygon, &QGCMapPolygon::pathChanged, this, &SurveyMissionItem::_generateGrid);
+    _exclusionPolygons.append(exclusionPolygon);
+
+    return exclusionPolygon;
+}
+
+void SurveyMissionItem::addExclusionPolygon(void)
+{
+    if (_mapPolygon.count() < 3) {
+        return;
+    }
+
+    // Start out with a square small enough to sit well inside the survey area
+    QGeoCoordinate center = _mapPolygon.center();
+    double halfWidth = -1;
+    QList<QGeoCoordinate> vertices = _mapPolygon.coordinateList();
+    for (int i=0; i<vertices.count(); i++) {
+        double distance = center.distanceTo(vertices[i]) / 4.0;
+        if (halfWidth < 0 || distance < halfWidth) {
+            halfWidth = distance;
+        }
+    }
+    double cornerDistance = halfWidth * M_SQRT2;
+
+    QList<QGeoCoordinate> square;
+    square << center.atDistanceAndAzimuth(cornerDistance, -45)
+           << center.atDistanceAndAzimuth(cornerDistance, 45)
+           << center.atDistanceAndAzimuth(cornerDistance, 135)
+           << center.atDistanceAndAzimuth(cornerDistance, -135);
+
+    // Setting the path regenerates the grid
+    _newExclusionPolygon()->setPath(square);
+}
+
+void SurveyMissionItem::clearExclusionPolygons(void)
+{
+    if (_exclusionPolygons.count()) {
+        _exclusionPolygons.clearAndDeleteContents();
+        _generateGrid();
+    }
+}
+
 void SurveyMissionItem::_polygonDirtyChanged(bool dirty)
 {
     if (dirty) {
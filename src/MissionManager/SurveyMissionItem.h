@@ -16,6 +16,10 @@
 #include "SettingsFact.h"
 #include "QGCLoggingCategory.h"
 #include "QGCMapPolygon.h"
+#include "QmlObjectListModel.h"
+#include "SurveyGridGenerator.h"
+
+#include <QFutureWatcher>
 
 Q_DECLARE_LOGGING_CATEGORY(SurveyMissionItemLog)
 
@@ -25,6 +29,7 @@ class SurveyMissionItem : public ComplexMissionItem
 
 public:
     SurveyMissionItem(Vehicle* vehicle, QObject* parent = NULL);
+    ~SurveyMissionItem();
 
     Q_PROPERTY(Fact*                gridAltitude                READ gridAltitude                   CONSTANT)
     Q_PROPERTY(Fact*                gridAltitudeRelative        READ gridAltitudeRelative           CONSTANT)
@@ -59,6 +64,13 @@ public:
     Q_PROPERTY(double               coveredArea                 READ coveredArea                    NOTIFY coveredAreaChanged)
 
     Q_PROPERTY(QGCMapPolygon*       mapPolygon                  READ mapPolygon                     CONSTANT)
+    Q_PROPERTY(QmlObjectListModel*  exclusionPolygons           READ exclusionPolygons              CONSTANT)   ///< List of QGCMapPolygon areas which are not surveyed
+
+    /// Adds a new exclusion polygon in the center of the survey area
+    Q_INVOKABLE void addExclusionPolygon(void);
+
+    /// Removes all exclusion polygons
+    Q_INVOKABLE void clearExclusionPolygons(void);
 
     QVariantList gridPoints (void) { return _simpleGridPoints; }
 
@@ -90,9 +102,13 @@ public:
     bool            hoverAndCaptureAllowed  (void) const;
     bool            refly90Degrees          (void) const { return _refly90Degrees; }
     QGCMapPolygon*  mapPolygon              (void) { return &_mapPolygon; }
+    QmlObjectListModel* exclusionPolygons   (void) { return &_exclusionPolygons; }
 
     void setRefly90Degrees(bool refly90Degrees);
 
+    /// @return Snapshot of the values which grid generation depends on
+    SurveyGridGenerator::Params_t gridParams(void) const;
+
     // Overrides from ComplexMissionItem
 
     double              complexDistance     (void) const final { return _surveyDistance; }
@@ -180,8 +196,14 @@ private slots:
     void _setDirty(void);
     void _polygonDirtyChanged(bool dirty);
     void _clearInternal(void);
+    void _generateGrid(void);
+    void _gridGenerationFinished(void);
 
 private:
+#ifdef UNITTEST_BUILD
+    friend class SurveyMissionItemTest;
+#endif
+
     enum CameraTriggerCode {
         CameraTriggerNone,
         CameraTriggerOn,
@@ -190,45 +212,35 @@ private:
     };
 
     void _setExitCoordinate(const QGeoCoordinate& coordinate);
-    void _generateGrid(void);
     void _updateCoordinateAltitude(void);
-    int _gridGenerator(const QList<QPointF>& polygonPoints, QList<QList<QPointF>>& transectSegments, bool refly);
-    QPointF _rotatePoint(const QPointF& point, const QPointF& origin, double angle);
-    void _intersectLinesWithRect(const QList<QLineF>& lineList, const QRectF& boundRect, QList<QLineF>& resultLines);
-    void _intersectLinesWithPolygon(const QList<QLineF>& lineList, const QPolygonF& polygon, QList<QLineF>& resultLines);
-    void _adjustLineDirection(const QList<QLineF>& lineList, QList<QLineF>& resultLines);
+    void _updateCoordinateAltitudeRelative(void);
     void _setSurveyDistance(double surveyDistance);
     void _setCameraShots(int cameraShots);
     void _setCoveredArea(double coveredArea);
     void _cameraValueChanged(void);
     int _appendWaypointToMission(QList<MissionItem*>& items, int seqNum, QGeoCoordinate& coord, CameraTriggerCode cameraTrigger, QObject* missionItemParent);
-    bool _nextTransectCoord(const QList<QGeoCoordinate>& transectPoints, int pointIndex, QGeoCoordinate& coord);
+    bool _nextTransectCoord(const SurveyGridGenerator::Transects& transects, int transectIndex, int pointIndex, QGeoCoordinate& coord);
     double _triggerDistance(void) const;
     bool _triggerCamera(void) const;
     bool _imagesEverywhere(void) const;
     bool _hoverAndCaptureEnabled(void) const;
     bool _hasTurnaround(void) const;
     double _turnaroundDistance(void) const;
-    void _convertTransectToGeo(const QList<QList<QPointF>>& transectSegmentsNED, const QGeoCoordinate& tangentOrigin, QList<QList<QGeoCoordinate>>& transectSegmentsGeo);
     bool _appendMissionItemsWorker(QList<MissionItem*>& items, QObject* missionItemParent, int& seqNum, bool hasRefly, bool buildRefly);
-    void _optimizeTransectsForShortestDistance(const QGeoCoordinate& distanceCoord, QList<QList<QGeoCoordinate>>& transects);
-    void _appendGridPointsFromTransects(QList<QList<QGeoCoordinate>>& rgTransectSegments);
-    qreal _ccw(QPointF pt1, QPointF pt2, QPointF pt3);
-    qreal _dp(QPointF pt1, QPointF pt2);
-    void _swapPoints(QList<QPointF>& points, int index1, int index2);
-    QList<QPointF> _convexPolygon(const QList<QPointF>& polygon);
-    void _reverseTransectOrder(QList<QList<QGeoCoordinate>>& transects);
-    void _reverseInternalTransectPoints(QList<QList<QGeoCoordinate>>& transects);
-    void _adjustTransectsToEntryPointLocation(QList<QList<QGeoCoordinate>>& transects);
-    bool _gridAngleIsNorthSouthTransects();
-    double _clampGridAngle90(double gridAngle);
+    void _startGridGeneration(void);
+    void _cancelGridGeneration(void);
+    void _flushGridGeneration(void);
+    void _generateGridNow(void);
+    void _publishGrid(const SurveyGridGenerator::Grid_t& grid);
+    QGCMapPolygon* _newExclusionPolygon(void);
 
     int                             _sequenceNumber;
     bool                            _dirty;
     QGCMapPolygon                   _mapPolygon;
+    QmlObjectListModel              _exclusionPolygons;     ///< QGCMapPolygon areas cut out of _mapPolygon
     QVariantList                    _simpleGridPoints;      ///< Grid points for drawing simple grid visuals
-    QList<QList<QGeoCoordinate>>    _transectSegments;      ///< Internal transect segments including grid exit, turnaround and internal camera points
-    QList<QList<QGeoCoordinate>>    _reflyTransectSegments; ///< Refly segments
+    SurveyGridGenerator::Transects  _transectSegments;      ///< Internal transect segments including grid exit, turnaround and internal camera points
+    SurveyGridGenerator::Transects  _reflyTransectSegments; ///< Refly segments
     QGeoCoordinate                  _coordinate;
     QGeoCoordinate                  _exitCoordinate;
     bool                            _cameraOrientationFixed;
@@ -244,6 +256,11 @@ private:
     double          _timeBetweenShots;
     double          _cruiseSpeed;
 
+    QFutureWatcher<SurveyGridGenerator::Grid_t> _gridWatcher;           ///< Grid generation running on worker thread
+    QAtomicInt                                  _gridCancel;            ///< Non-zero: running grid generation has been superseded
+    bool                                        _gridRegeneratePending; ///< true: grid must be generated again once the running generation finishes
+    bool                                        _gridPublishPending;    ///< true: published grid does not reflect the current values yet
+
     QMap<QString, FactMetaData*> _metaDataMap;
 
     SettingsFact    _manualGridFact;
@@ -293,6 +310,7 @@ private:
     static const char* _jsonCameraOrientationLandscapeKey;
     static const char* _jsonFixedValueIsAltitudeKey;
     static const char* _jsonRefly90DegreesKey;
+    static const char* _jsonExclusionPolygonsKey;
 
     static const int _hoverAndCaptureDelaySeconds = 1;
 };
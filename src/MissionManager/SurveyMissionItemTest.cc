@@ -9,6 +9,10 @@
 
 #include "SurveyMissionItemTest.h"
 #include "QGCApplication.h"
+#include "QGCGeo.h"
+
+#include <QElapsedTimer>
+#include <QtMath>
 
 SurveyMissionItemTest::SurveyMissionItemTest(void)
     : _offlineVehicle(NULL)
@@ -211,6 +215,7 @@ void SurveyMissionItemTest::_testGridAngle(void)
 
     for (double gridAngle=-360.0; gridAngle<=360.0; gridAngle++) {
         _surveyItem->gridAngle()->setRawValue(gridAngle);
+        _surveyItem->_flushGridGeneration();
 
         QVariantList gridPoints = _surveyItem->gridPoints();
         QGeoCoordinate firstTransectEntry = gridPoints[0].value<QGeoCoordinate>();
@@ -245,9 +250,296 @@ void SurveyMissionItemTest::_testEntryLocation(void)
             int entryLocation = rgEntryLocation[i];
 
             _surveyItem->gridEntryLocation()->setRawValue(entryLocation);
+            _surveyItem->_flushGridGeneration();
             QVERIFY(!rgSeenEntryCoords.contains(_surveyItem->coordinate()));
             rgSeenEntryCoords << _surveyItem->coordinate();
         }
         rgSeenEntryCoords.clear();
     }
 }
+
+void SurveyMissionItemTest::_testGridGenerationSuperseded(void)
+{
+    for (int i=0; i<_polyPoints.count(); i++) {
+        _mapPolygon->appendVertex(_polyPoints[i]);
+    }
+    _surveyItem->_flushGridGeneration();
+    _multiSpy->clearAllSignals();
+
+    // Each change supersedes the generation started by the previous one, only the final grid should be published
+    for (double gridAngle=0; gridAngle<=45.0; gridAngle+=5.0) {
+        _surveyItem->gridAngle()->setRawValue(gridAngle);
+    }
+    QVERIFY(_multiSpy->checkNoSignalByMask(gridPointsChangedMask));
+    QTRY_VERIFY(_multiSpy->checkSignalByMask(gridPointsChangedMask));
+    QTest::qWait(100);
+    QCOMPARE(_multiSpy->getSpyByIndex(gridPointsChangedIndex)->count(), 1);
+
+    SurveyGridGenerator::Grid_t grid = SurveyGridGenerator::generate(_surveyItem->gridParams(), NULL);
+    QCOMPARE(_surveyItem->gridPoints(), grid.gridPoints);
+    QCOMPARE(_surveyItem->complexDistance(), grid.surveyDistance);
+}
+
+/// Timing of a grid with around 10000 transects. Only runs when large benchmarks are enabled, see
+/// UnitTest::largeBenchmarksEnabled.
+void SurveyMissionItemTest::_testLargeGrid(void)
+{
+    if (!largeBenchmarksEnabled()) {
+        QSKIP("Set QGC_UNITTEST_BENCHMARKS to run the large survey grid benchmark");
+    }
+
+    // Roughly 10km square with 1m spacing gives around 10000 transects
+    QGeoCoordinate topLeft(47.6, -122.1);
+    QGeoCoordinate topRight = topLeft.atDistanceAndAzimuth(10000, 90);
+    QGeoCoordinate bottomRight = topRight.atDistanceAndAzimuth(10000, 180);
+    QGeoCoordinate bottomLeft = topLeft.atDistanceAndAzimuth(10000, 180);
+
+    _surveyItem->gridSpacing()->setRawValue(1.0);
+    _surveyItem->gridAngle()->setRawValue(0.0);
+    _mapPolygon->appendVertex(topLeft);
+    _mapPolygon->appendVertex(topRight);
+    _mapPolygon->appendVertex(bottomRight);
+    _mapPolygon->appendVertex(bottomLeft);
+
+    QElapsedTimer timer;
+
+    timer.start();
+    SurveyGridGenerator::Grid_t grid = SurveyGridGenerator::generate(_surveyItem->gridParams(), NULL);
+    qDebug() << "Generating" << grid.transects.count() << "transects took" << timer.elapsed() << "msecs";
+    QVERIFY(grid.transects.count() >= 10000);
+
+    // Drag a vertex around, the gui thread should only pay for starting generations
+    _surveyItem->_flushGridGeneration();
+    _multiSpy->clearAllSignals();
+    timer.start();
+    for (int i=0; i<20; i++) {
+        _mapPolygon->adjustVertex(1, topRight.atDistanceAndAzimuth(i * 10, 90));
+    }
+    qDebug() << "Moving a vertex 20 times took" << timer.elapsed() << "msecs on the gui thread";
+    QTRY_VERIFY_WITH_TIMEOUT(_multiSpy->checkSignalByMask(gridPointsChangedMask), 30000);
+    qDebug() << "Final grid published after" << timer.elapsed() << "msecs";
+    QCOMPARE(_multiSpy->getSpyByIndex(gridPointsChangedIndex)->count(), 1);
+
+    grid = SurveyGridGenerator::generate(_surveyItem->gridParams(), NULL);
+    QCOMPARE(_surveyItem->gridPoints().count(), grid.gridPoints.count());
+    QCOMPARE(_surveyItem->gridPoints().last(), grid.gridPoints.last());
+}
+
+QGeoCoordinate SurveyMissionItemTest::_offsetCoordinate(const QGeoCoordinate& origin, double north, double east)
+{
+    QGeoCoordinate coord;
+
+    convertNedToGeo(north, east, 0, origin, &coord);
+    return coord;
+}
+
+/// @return Number of times the flight from one transect to the next is longer than maxJump
+int SurveyMissionItemTest::_longTransectJumps(const SurveyGridGenerator::Transects& transects, double maxJump)
+{
+    int longJumps = 0;
+
+    for (int i=1; i<transects.count(); i++) {
+        if (transects.exit(i - 1).distanceTo(transects.entry(i)) > maxJump) {
+            longJumps++;
+        }
+    }
+
+    return longJumps;
+}
+
+void SurveyMissionItemTest::_testConcavePolygon(void)
+{
+    // U shaped area, 300m square with a 100m wide 200m deep notch cut into the north side
+    QGeoCoordinate origin(47.6, -122.1);
+    QList<QGeoCoordinate> uShape;
+    uShape << _offsetCoordinate(origin, 0, 0)
+           << _offsetCoordinate(origin, 300, 0)
+           << _offsetCoordinate(origin, 300, 100)
+           << _offsetCoordinate(origin, 100, 100)
+           << _offsetCoordinate(origin, 100, 200)
+           << _offsetCoordinate(origin, 300, 200)
+           << _offsetCoordinate(origin, 300, 300)
+           << _offsetCoordinate(origin, 0, 300);
+
+    double gridSpacing = 20;
+    _surveyItem->gridSpacing()->setRawValue(gridSpacing);
+    _surveyItem->gridAngle()->setRawValue(90.0);
+    _mapPolygon->setPath(uShape);
+    _surveyItem->_flushGridGeneration();
+
+    SurveyGridGenerator::Grid_t grid = SurveyGridGenerator::generate(_surveyItem->gridParams(), NULL);
+    QVERIFY(grid.transects.count() > 0);
+    QVERIFY(qAbs(grid.coveredArea - (300.0 * 300.0 - 100.0 * 200.0)) < 700.0);
+
+    // The notch splits the upper transects in two, none of them may cross it
+    int notchTransects = 0;
+    for (int i=0; i<grid.transects.count(); i++) {
+        QGeoCoordinate entry = grid.transects.entry(i);
+        QGeoCoordinate exit = grid.transects.exit(i);
+        QGeoCoordinate midpoint = entry.atDistanceAndAzimuth(entry.distanceTo(exit) / 2, entry.azimuthTo(exit));
+        QVERIFY(_mapPolygon->containsCoordinate(midpoint));
+        if (entry.distanceTo(exit) < 150) {
+            notchTransects++;
+        }
+    }
+    QVERIFY(notchTransects > 0);
+
+    // Each arm of the U should be flown in one sweep, so there is at most a single jump between the arms
+    QVERIFY(_longTransectJumps(grid.transects, gridSpacing * 3) <= 2);
+    QCOMPARE(_surveyItem->gridPoints(), grid.gridPoints);
+}
+
+void SurveyMissionItemTest::_testExclusionPolygon(void)
+{
+    QGeoCoordinate origin(47.6, -122.1);
+    QList<QGeoCoordinate> square;
+    square << _offsetCoordinate(origin, 0, 0)
+           << _offsetCoordinate(origin, 300, 0)
+           << _offsetCoordinate(origin, 300, 300)
+           << _offsetCoordinate(origin, 0, 300);
+
+    double gridSpacing = 10;
+    _surveyItem->gridSpacing()->setRawValue(gridSpacing);
+    _mapPolygon->setPath(square);
+    _surveyItem->_flushGridGeneration();
+    double fullArea = _surveyItem->coveredArea();
+    int fullTransectCount = _surveyItem->_transectSegments.count();
+
+    _surveyItem->addExclusionPolygon();
+    QCOMPARE(_surveyItem->exclusionPolygons()->count(), 1);
+    _surveyItem->_flushGridGeneration();
+    QVERIFY(_surveyItem->coveredArea() < fullArea);
+    QVERIFY(_surveyItem->_transectSegments.count() > fullTransectCount);
+    QVERIFY(_surveyItem->dirty());
+
+    // No transect may fly over the exclusion area
+    QGCMapPolygon* exclusionPolygon = _surveyItem->exclusionPolygons()->value<QGCMapPolygon*>(0);
+    const SurveyGridGenerator::Transects& transects = _surveyItem->_transectSegments;
+    for (int i=0; i<transects.count(); i++) {
+        QGeoCoordinate entry = transects.entry(i);
+        QGeoCoordinate exit = transects.exit(i);
+        double distance = entry.distanceTo(exit);
+        double azimuth = entry.azimuthTo(exit);
+        for (double step=gridSpacing / 2; step<distance; step+=gridSpacing) {
+            QVERIFY(!exclusionPolygon->containsCoordinate(entry.atDistanceAndAzimuth(step, azimuth)));
+        }
+    }
+
+    // Exclusion areas round trip through the plan file
+    QJsonArray items;
+    _surveyItem->save(items);
+    SurveyMissionItem* loadedItem = new SurveyMissionItem(_offlineVehicle, this);
+    QString errorString;
+    QVERIFY(loadedItem->load(items[0].toObject(), 1, errorString));
+    QCOMPARE(loadedItem->exclusionPolygons()->count(), 1);
+    QCOMPARE(loadedItem->coveredArea(), _surveyItem->coveredArea());
+    QCOMPARE(loadedItem->gridPoints(), _surveyItem->gridPoints());
+    delete loadedItem;
+
+    _surveyItem->clearExclusionPolygons();
+    QCOMPARE(_surveyItem->exclusionPolygons()->count(), 0);
+    _surveyItem->_flushGridGeneration();
+    QCOMPARE(_surveyItem->coveredArea(), fullArea);
+}
+
+void SurveyMissionItemTest::_testConcavePolygonPerformance(void)
+{
+    // 500 vertex star with a ring of holes, concave at every other vertex
+    QGeoCoordinate center(47.6, -122.1);
+    SurveyGridGenerator::Params_t params;
+
+    for (int i=0; i<500; i++) {
+        double radius = (i & 1) ? 1200 : 2000;
+        params.polygon.append(center.atDistanceAndAzimuth(radius, i * (360.0 / 500.0)));
+    }
+    for (int i=0; i<10; i++) {
+        QGeoCoordinate holeCenter = center.atDistanceAndAzimuth(600, i * 36.0);
+        QList<QGeoCoordinate> hole;
+        for (int j=0; j<50; j++) {
+            hole.append(holeCenter.atDistanceAndAzimuth(100, j * (360.0 / 50.0)));
+        }
+        params.holes.append(hole);
+    }
+    params.gridAngle =          30;
+    params.gridSpacing =        2;
+    params.entryLocation =      SurveyGridGenerator::EntryLocationTopLeft;
+    params.turnaroundDistance = 10;
+    params.triggerDistance =    0;
+    params.imagesEverywhere =   false;
+    params.hoverAndCapture =    false;
+    params.refly90Degrees =     false;
+
+    QElapsedTimer timer;
+    timer.start();
+    SurveyGridGenerator::Grid_t grid = SurveyGridGenerator::generate(params, NULL);
+    qint64 elapsed = timer.elapsed();
+    qDebug() << "Generating" << grid.transects.count() << "transects for 500 vertex concave polygon with" << params.holes.count() << "holes took" << elapsed << "msecs";
+
+    // Every scanline crosses the polygon, many of them cross spikes and holes more than once
+    QVERIFY(grid.transects.count() > 4000 / params.gridSpacing);
+
+    // Star is made of triangles between neighbouring vertices, holes are 50 sided regular polygons
+    double starArea = 500 * 0.5 * 2000 * 1200 * sin(2 * M_PI / 500);
+    double holeArea = 50 * 0.5 * 100 * 100 * sin(2 * M_PI / 50);
+    double expectedArea = starArea - (params.holes.count() * holeArea);
+    QVERIFY2(qAbs(grid.coveredArea - expectedArea) < expectedArea * 0.01, qPrintable(QStringLiteral("Covered area %1 expected %2").arg(grid.coveredArea).arg(expectedArea)));
+}
+
+void SurveyMissionItemTest::_testExclusionPolygonOutside(void)
+{
+    QGeoCoordinate origin(47.6, -122.1);
+    SurveyGridGenerator::Params_t params;
+
+    params.polygon << _offsetCoordinate(origin, 0, 0)
+                   << _offsetCoordinate(origin, 300, 0)
+                   << _offsetCoordinate(origin, 300, 300)
+                   << _offsetCoordinate(origin, 0, 300);
+    params.gridAngle =          0;
+    params.gridSpacing =        10;
+    params.entryLocation =      SurveyGridGenerator::EntryLocationTopLeft;
+    params.turnaroundDistance = 0;
+    params.triggerDistance =    0;
+    params.imagesEverywhere =   false;
+    params.hoverAndCapture =    false;
+    params.refly90Degrees =     false;
+
+    SurveyGridGenerator::Grid_t fullGrid = SurveyGridGenerator::generate(params, NULL);
+
+    // Completely outside, reaching across the boundary, and overlapping a valid hole
+    QList<QGeoCoordinate> outsideHole;
+    outsideHole << _offsetCoordinate(origin, 400, 0)
+                << _offsetCoordinate(origin, 500, 0)
+                << _offsetCoordinate(origin, 500, 100)
+                << _offsetCoordinate(origin, 400, 100);
+    QList<QGeoCoordinate> crossingHole;
+    crossingHole << _offsetCoordinate(origin, 250, 100)
+                 << _offsetCoordinate(origin, 350, 100)
+                 << _offsetCoordinate(origin, 350, 200)
+                 << _offsetCoordinate(origin, 250, 200);
+    params.holes << outsideHole << crossingHole;
+
+    SurveyGridGenerator::Grid_t grid = SurveyGridGenerator::generate(params, NULL);
+    QCOMPARE(grid.coveredArea, fullGrid.coveredArea);
+    QCOMPARE(grid.transects.count(), fullGrid.transects.count());
+    QCOMPARE(grid.gridPoints, fullGrid.gridPoints);
+
+    QList<QGeoCoordinate> validHole;
+    validHole << _offsetCoordinate(origin, 50, 50)
+              << _offsetCoordinate(origin, 150, 50)
+              << _offsetCoordinate(origin, 150, 150)
+              << _offsetCoordinate(origin, 50, 150);
+    QList<QGeoCoordinate> overlappingHole;
+    overlappingHole << _offsetCoordinate(origin, 100, 100)
+                    << _offsetCoordinate(origin, 200, 100)
+                    << _offsetCoordinate(origin, 200, 200)
+                    << _offsetCoordinate(origin, 100, 200);
+    params.holes.clear();
+    params.holes << validHole;
+    SurveyGridGenerator::Grid_t validGrid = SurveyGridGenerator::generate(params, NULL);
+    QVERIFY(qAbs(validGrid.coveredArea - (fullGrid.coveredArea - 100.0 * 100.0)) < 100.0);
+
+    params.holes << overlappingHole;
+    grid = SurveyGridGenerator::generate(params, NULL);
+    QCOMPARE(grid.coveredArea, validGrid.coveredArea);
+    QCOMPARE(grid.gridPoints, validGrid.gridPoints);
+}
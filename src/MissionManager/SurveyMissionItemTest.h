@@ -36,9 +36,17 @@ private slots:
     void _testCameraTrigger(void);
     void _testGridAngle(void);
     void _testEntryLocation(void);
+    void _testGridGenerationSuperseded(void);
+    void _testLargeGrid(void);
+    void _testConcavePolygon(void);
+    void _testExclusionPolygon(void);
+    void _testConcavePolygonPerformance(void);
+    void _testExclusionPolygonOutside(void);
 
 private:
-    double _clampGridAngle180(double gridAngle);
+    double          _clampGridAngle180  (double gridAngle);
+    QGeoCoordinate  _offsetCoordinate   (const QGeoCoordinate& origin, double north, double east);
+    int             _longTransectJumps  (const SurveyGridGenerator::Transects& transects, double maxJump);
 
     enum {
         gridPointsChangedIndex = 0,
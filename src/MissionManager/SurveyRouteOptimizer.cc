@@ -0,0 +1,353 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#include "SurveyRouteOptimizer.h"
+#include "QGCGeo.h"
+#include "QGCLoggingCategory.h"
+
+#include <algorithm>
+#include <limits>
+
+QGC_LOGGING_CATEGORY(SurveyRouteOptimizerLog, "SurveyRouteOptimizerLog")
+
+QList<SurveyRouteOptimizer::Result_t> SurveyRouteOptimizer::optimize(const QList<Run_t>& runs, const QAtomicInt* cancel)
+{
+    QList<Result_t> results;
+
+    for (int i=0; i<runs.count(); i++) {
+        const Run_t& run = runs[i];
+
+        QVector<QVector<Variant_t>> variants;
+        QVector<int>                currentVariants;
+        for (int j=0; j<run.surveys.count(); j++) {
+            // Generating the grid for every entry location is the expensive part, so known variants are reused
+            if (j < run.variants.count() && !run.variants[j].isEmpty()) {
+                variants.append(run.variants[j]);
+            } else {
+                variants.append(_surveyVariants(run.surveys[j], cancel));
+            }
+            currentVariants.append(run.surveys[j].entryLocation);
+            if (_cancelled(cancel)) {
+                return results;
+            }
+        }
+
+        Result_t result = optimizeRoute(run.start, run.end, variants, currentVariants, cancel);
+        if (_cancelled(cancel)) {
+            return results;
+        }
+        result.surveyVariants = variants;
+        qCDebug(SurveyRouteOptimizerLog) << "Run" << i << "surveys:current:optimized" << run.surveys.count() << result.currentDistance << result.optimizedDistance;
+        results.append(result);
+    }
+
+    return results;
+}
+
+/// @return Entry, exit and distance of the survey for each entry location
+QVector<SurveyRouteOptimizer::Variant_t> SurveyRouteOptimizer::_surveyVariants(const SurveyGridGenerator::Params_t& params, const QAtomicInt* cancel)
+{
+    QVector<Variant_t> variants;
+
+    for (int entryLocation=SurveyGridGenerator::EntryLocationTopLeft; entryLocation<=SurveyGridGenerator::EntryLocationBottomRight; entryLocation++) {
+        SurveyGridGenerator::Params_t variantParams = params;
+        variantParams.entryLocation = entryLocation;
+
+        SurveyGridGenerator::Grid_t grid = SurveyGridGenerator::generate(variantParams, cancel);
+        if (_cancelled(cancel)) {
+            return variants;
+        }
+
+        Variant_t variant;
+        if (grid.gridPoints.isEmpty()) {
+            variant.entry = variant.exit = params.polygon.count() ? params.polygon[0] : QGeoCoordinate();
+            variant.distance = 0;
+        } else {
+            variant.entry = grid.gridPoints.first().value<QGeoCoordinate>();
+            variant.exit = grid.gridPoints.last().value<QGeoCoordinate>();
+            variant.distance = grid.surveyDistance;
+        }
+        variants.append(variant);
+    }
+
+    return variants;
+}
+
+SurveyRouteOptimizer::Distances_t SurveyRouteOptimizer::_buildDistances(const QGeoCoordinate& start, const QGeoCoordinate& end, const QVector<QVector<Variant_t>>& variants)
+{
+    Distances_t         distances;
+    QVector<Variant_t>  nodes;
+
+    for (int i=0; i<variants.count(); i++) {
+        distances.nodeStart.append(nodes.count());
+        nodes += variants[i];
+    }
+    distances.nodeStart.append(nodes.count());
+    distances.nodeCount = nodes.count();
+
+    // Distances are computed a row at a time over plain arrays of the node entries and exits
+    int             nodeCount = nodes.count();
+    QVector<double> entryLatitudes(nodeCount);
+    QVector<double> entryLongitudes(nodeCount);
+    QVector<double> exitLatitudes(nodeCount);
+    QVector<double> exitLongitudes(nodeCount);
+
+    for (int i=0; i<nodeCount; i++) {
+        distances.nodeDistance.append(nodes[i].distance);
+        entryLatitudes[i] = nodes[i].entry.latitude();
+        entryLongitudes[i] = nodes[i].entry.longitude();
+        exitLatitudes[i] = nodes[i].exit.latitude();
+        exitLongitudes[i] = nodes[i].exit.longitude();
+    }
+
+    distances.startDistance.fill(0.0, nodeCount);
+    distances.endDistance.fill(0.0, nodeCount);
+    if (start.isValid()) {
+        geoDistances(start.latitude(), start.longitude(), entryLatitudes.constData(), entryLongitudes.constData(), nodeCount, distances.startDistance.data());
+    }
+    if (end.isValid()) {
+        geoDistances(end.latitude(), end.longitude(), exitLatitudes.constData(), exitLongitudes.constData(), nodeCount, distances.endDistance.data());
+    }
+
+    distances.links.resize(nodeCount * nodeCount);
+    for (int i=0; i<nodeCount; i++) {
+        geoDistances(exitLatitudes[i], exitLongitudes[i], entryLatitudes.constData(), entryLongitudes.constData(), nodeCount, distances.links.data() + (i * nodeCount));
+    }
+
+    // Keep the zero distance QGeoCoordinate::distanceTo gives for invalid coordinates instead of nan
+    for (int i=0; i<nodeCount; i++) {
+        if (!nodes[i].entry.isValid()) {
+            distances.startDistance[i] = 0.0;
+            for (int j=0; j<nodeCount; j++) {
+                distances.links[(j * nodeCount) + i] = 0.0;
+            }
+        }
+        if (!nodes[i].exit.isValid()) {
+            distances.endDistance[i] = 0.0;
+            for (int j=0; j<nodeCount; j++) {
+                distances.links[(i * nodeCount) + j] = 0.0;
+            }
+        }
+    }
+
+    return distances;
+}
+
+/// Calculates the shortest route distance for the specified survey order. The best variant for each survey only
+/// depends on the variant picked for the survey before it, so all choices are covered by a single pass which keeps
+/// the best distance to each variant of the current survey.
+///     @param[out] variants Best variant for each survey, indexed by survey, NULL if not needed
+double SurveyRouteOptimizer::_routeDistance(const Distances_t& distances, const QVector<int>& order, QVector<int>* variants)
+{
+    if (order.isEmpty()) {
+        return 0;
+    }
+
+    QVector<double>         previousDistance;
+    QVector<double>         currentDistance;
+    QVector<QVector<int>>   previousNode(order.count());    ///< Best node in previous survey for each node in survey
+
+    int firstSurvey = order[0];
+    for (int node=distances.nodeStart[firstSurvey]; node<distances.nodeStart[firstSurvey + 1]; node++) {
+        currentDistance.append(distances.startDistance[node] + distances.nodeDistance[node]);
+    }
+
+    for (int i=1; i<order.count(); i++) {
+        int previousSurvey = order[i - 1];
+        int survey = order[i];
+
+        previousDistance = currentDistance;
+        currentDistance.clear();
+        for (int node=distances.nodeStart[survey]; node<distances.nodeStart[survey + 1]; node++) {
+            double  bestDistance = std::numeric_limits<double>::max();
+            int     bestNode = -1;
+            for (int prevNode=distances.nodeStart[previousSurvey]; prevNode<distances.nodeStart[previousSurvey + 1]; prevNode++) {
+                double distance = previousDistance[prevNode - distances.nodeStart[previousSurvey]] + distances.links[(prevNode * distances.nodeCount) + node];
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    bestNode = prevNode;
+                }
+            }
+            currentDistance.append(bestDistance + distances.nodeDistance[node]);
+            previousNode[i].append(bestNode);
+        }
+    }
+
+    int     lastSurvey = order.last();
+    double  bestDistance = std::numeric_limits<double>::max();
+    int     bestNode = -1;
+    for (int node=distances.nodeStart[lastSurvey]; node<distances.nodeStart[lastSurvey + 1]; node++) {
+        double distance = currentDistance[node - distances.nodeStart[lastSurvey]] + distances.endDistance[node];
+        if (distance < bestDistance) {
+            bestDistance = distance;
+            bestNode = node;
+        }
+    }
+
+    if (variants) {
+        variants->resize(order.count());
+        for (int i=order.count() - 1; i>=0; i--) {
+            int survey = order[i];
+            int variant = bestNode - distances.nodeStart[survey];
+            (*variants)[survey] = variant;
+            if (i > 0) {
+                bestNode = previousNode[i][variant];
+            }
+        }
+    }
+
+    return bestDistance;
+}
+
+/// @return Survey order from always flying to the closest survey left next. Every survey must have at least one variant.
+QVector<int> SurveyRouteOptimizer::_nearestNeighbourOrder(const Distances_t& distances)
+{
+    int             surveyCount = distances.nodeStart.count() - 1;
+    QVector<bool>   visited(surveyCount, false);
+    QVector<int>    order;
+    int             currentNode = -1;
+
+    for (int i=0; i<surveyCount; i++) {
+        double  bestDistance = std::numeric_limits<double>::max();
+        int     bestSurvey = -1;
+        int     bestNode = -1;
+
+        for (int survey=0; survey<surveyCount; survey++) {
+            if (visited[survey]) {
+                continue;
+            }
+            for (int node=distances.nodeStart[survey]; node<distances.nodeStart[survey + 1]; node++) {
+                double linkDistance = currentNode == -1 ? distances.startDistance[node] : distances.links[(currentNode * distances.nodeCount) + node];
+                double distance = linkDistance + distances.nodeDistance[node];
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    bestSurvey = survey;
+                    bestNode = node;
+                }
+            }
+        }
+
+        visited[bestSurvey] = true;
+        order.append(bestSurvey);
+        currentNode = bestNode;
+    }
+
+    return order;
+}
+
+SurveyRouteOptimizer::Result_t SurveyRouteOptimizer::optimizeRoute(const QGeoCoordinate& start, const QGeoCoordinate& end, const QVector<QVector<Variant_t>>& variants, const QVector<int>& currentVariants, const QAtomicInt* cancel)
+{
+    Result_t result;
+
+    result.currentDistance = 0;
+    result.optimizedDistance = 0;
+    for (int i=0; i<variants.count(); i++) {
+        result.order.append(i);
+    }
+    result.variants = currentVariants;
+
+    for (int i=0; i<variants.count(); i++) {
+        if (variants[i].isEmpty() || currentVariants[i] < 0 || currentVariants[i] >= variants[i].count()) {
+            // Nothing to choose between
+            return result;
+        }
+    }
+    if (variants.isEmpty()) {
+        return result;
+    }
+
+    Distances_t distances = _buildDistances(start, end, variants);
+
+    // Distance for the route as it is flown now
+    double  currentDistance = 0;
+    int     previousNode = -1;
+    for (int i=0; i<variants.count(); i++) {
+        int node = distances.nodeStart[i] + currentVariants[i];
+        currentDistance += previousNode == -1 ? distances.startDistance[node] : distances.links[(previousNode * distances.nodeCount) + node];
+        currentDistance += distances.nodeDistance[node];
+        previousNode = node;
+    }
+    currentDistance += distances.endDistance[previousNode];
+    result.currentDistance = result.optimizedDistance = currentDistance;
+
+    // Start 2-opt from the better of the current order and the nearest neighbour order
+    QVector<int>    bestOrder = _nearestNeighbourOrder(distances);
+    double          bestDistance = _routeDistance(distances, bestOrder, NULL);
+    double          currentOrderDistance = _routeDistance(distances, result.order, NULL);
+    if (currentOrderDistance <= bestDistance) {
+        bestOrder = result.order;
+        bestDistance = currentOrderDistance;
+    }
+
+    bool improved = true;
+    while (improved) {
+        improved = false;
+        for (int i=0; i<bestOrder.count() - 1; i++) {
+            for (int j=i+1; j<bestOrder.count(); j++) {
+                if (_cancelled(cancel)) {
+                    return result;
+                }
+
+                QVector<int> order = bestOrder;
+                std::reverse(order.begin() + i, order.begin() + j + 1);
+                double distance = _routeDistance(distances, order, NULL);
+                if (distance < bestDistance - 0.01) {
+                    bestOrder = order;
+                    bestDistance = distance;
+                    improved = true;
+                }
+            }
+        }
+    }
+
+    if (bestDistance < currentDistance) {
+        result.order = bestOrder;
+        result.optimizedDistance = _routeDistance(distances, bestOrder, &result.variants);
+    }
+
+    return result;
+}
+
+bool SurveyRouteOptimizer::sameParams(const SurveyGridGenerator::Params_t& params1, const SurveyGridGenerator::Params_t& params2)
+{
+    return params1.polygon == params2.polygon &&
+            params1.holes == params2.holes &&
+            params1.gridAngle == params2.gridAngle &&
+            params1.gridSpacing == params2.gridSpacing &&
+            params1.entryLocation == params2.entryLocation &&
+            params1.turnaroundDistance == params2.turnaroundDistance &&
+            params1.triggerDistance == params2.triggerDistance &&
+            params1.imagesEverywhere == params2.imagesEverywhere &&
+            params1.hoverAndCapture == params2.hoverAndCapture &&
+            params1.refly90Degrees == params2.refly90Degrees;
+}
+
+bool SurveyRouteOptimizer::sameRuns(const QList<Run_t>& runs1, const QList<Run_t>& runs2)
+{
+    if (runs1.count() != runs2.count()) {
+        return false;
+    }
+
+    for (int i=0; i<runs1.count(); i++) {
+        const Run_t& run1 = runs1[i];
+        const Run_t& run2 = runs2[i];
+
+        if (run1.start != run2.start || run1.end != run2.end || run1.surveys.count() != run2.surveys.count()) {
+            return false;
+        }
+        for (int j=0; j<run1.surveys.count(); j++) {
+            if (!sameParams(run1.surveys[j], run2.surveys[j])) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,92 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#ifndef SurveyRouteOptimizer_H
+#define SurveyRouteOptimizer_H
+
+#include "SurveyGridGenerator.h"
+
+#include <QAtomicInt>
+#include <QGeoCoordinate>
+#include <QList>
+#include <QLoggingCategory>
+#include <QVector>
+
+Q_DECLARE_LOGGING_CATEGORY(SurveyRouteOptimizerLog)
+
+/// Finds the shortest route through a set of surveys which can be flown in any order.
+///
+/// Each survey can be flown from each of its entry locations, which gives a different entry and exit point and a
+/// slightly different distance within the survey. The route is seeded by a nearest neighbour walk, then improved with
+/// 2-opt moves over the survey order. For each order tried the best entry location of every survey is picked exactly,
+/// since it only depends on the neighbouring surveys.
+///
+/// Like SurveyGridGenerator the optimizer works only on the values passed in, so it can run on a worker thread.
+class SurveyRouteOptimizer
+{
+public:
+    /// One way of flying a survey
+    typedef struct {
+        QGeoCoordinate  entry;
+        QGeoCoordinate  exit;
+        double          distance;   ///< Distance flown within the survey
+    } Variant_t;
+
+    /// Consecutive surveys in a mission which can be reordered freely
+    typedef struct {
+        QGeoCoordinate                          start;      ///< Vehicle position before the first survey, invalid for none
+        QGeoCoordinate                          end;        ///< Vehicle destination after the last survey, invalid for none
+        QList<SurveyGridGenerator::Params_t>    surveys;    ///< In current mission order
+        QList<QVector<Variant_t>>               variants;   ///< Known variants for each survey, empty where they still have to be generated
+    } Run_t;
+
+    typedef struct {
+        QVector<int>    order;              ///< Survey indices in flight order
+        QVector<int>    variants;           ///< Variant to fly for each survey, indexed by survey. For a survey the variant is its entry location.
+        double          currentDistance;    ///< Route distance for the current order and entry locations
+        double          optimizedDistance;  ///< Route distance for the optimized order and variants, never more than currentDistance
+        QVector<QVector<Variant_t>> surveyVariants; ///< Variants of each survey in run order, so later runs can reuse them
+    } Result_t;
+
+    /// Optimizes each run of surveys independently.
+    ///     @param cancel Optimization stops early if this becomes non-zero, NULL for no cancellation
+    /// @return One result per run, fewer if cancelled
+    static QList<Result_t> optimize(const QList<Run_t>& runs, const QAtomicInt* cancel);
+
+    /// Optimizes the route through a set of surveys given the ways each of them can be flown.
+    ///     @param variants Variants for each survey
+    ///     @param currentVariants Variant which is currently flown for each survey, in the current order
+    static Result_t optimizeRoute(const QGeoCoordinate& start, const QGeoCoordinate& end, const QVector<QVector<Variant_t>>& variants, const QVector<int>& currentVariants, const QAtomicInt* cancel);
+
+    /// @return true: Both sets of runs produce the same result
+    static bool sameRuns(const QList<Run_t>& runs1, const QList<Run_t>& runs2);
+
+    /// @return true: Both surveys are flown the same way
+    static bool sameParams(const SurveyGridGenerator::Params_t& params1, const SurveyGridGenerator::Params_t& params2);
+
+private:
+    /// Distances between all variants of all surveys
+    typedef struct {
+        int             nodeCount;
+        QVector<int>    nodeStart;      ///< Index of first node for each survey, followed by the node count
+        QVector<double> nodeDistance;   ///< Distance within the survey for each node
+        QVector<double> startDistance;  ///< Distance from start to each node entry
+        QVector<double> endDistance;    ///< Distance from each node exit to end
+        QVector<double> links;          ///< Distance from exit of node a to entry of node b at [a * nodeCount + b]
+    } Distances_t;
+
+    static bool             _cancelled          (const QAtomicInt* cancel) { return cancel && cancel->load(); }
+    static QVector<Variant_t> _surveyVariants   (const SurveyGridGenerator::Params_t& params, const QAtomicInt* cancel);
+    static Distances_t      _buildDistances     (const QGeoCoordinate& start, const QGeoCoordinate& end, const QVector<QVector<Variant_t>>& variants);
+    static double           _routeDistance      (const Distances_t& distances, const QVector<int>& order, QVector<int>* variants);
+    static QVector<int>     _nearestNeighbourOrder(const Distances_t& distances);
+};
+
+#endif
@@ -30,6 +30,7 @@ VisualMissionItem::VisualMissionItem(Vehicle* vehicle, QObject* parent)
     , _altPercent(0.0)
     , _azimuth(0.0)
     , _distance(0.0)
+    , _terrainClearance(std::numeric_limits<double>::quiet_NaN())
     , _missionGimbalYaw(std::numeric_limits<double>::quiet_NaN())
     , _missionVehicleYaw(std::numeric_limits<double>::quiet_NaN())
 {
@@ -46,6 +47,7 @@ VisualMissionItem::VisualMissionItem(const VisualMissionItem& other, QObject* pa
     , _altPercent(0.0)
     , _azimuth(0.0)
     , _distance(0.0)
+    , _terrainClearance(std::numeric_limits<double>::quiet_NaN())
 {
     *this = other;
 }
@@ -61,6 +63,7 @@ const VisualMissionItem& VisualMissionItem::operator=(const VisualMissionItem& o
     setAltPercent(other._altPercent);
     setAzimuth(other._azimuth);
     setDistance(other._distance);
+    setTerrainClearance(other._terrainClearance);
 
     return *this;
 }
@@ -85,6 +88,17 @@ void VisualMissionItem::setDistance(double distance)
     }
 }
 
+void VisualMissionItem::setTerrainClearance(double terrainClearance)
+{
+    if (qIsNaN(_terrainClearance) && qIsNaN(terrainClearance)) {
+        return;
+    }
+    if (_terrainClearance != terrainClearance) {
+        _terrainClearance = terrainClearance;
+        emit terrainClearanceChanged(_terrainClearance);
+    }
+}
+
 void VisualMissionItem::setAltDifference(double altDifference)
 {
     if (!qFuzzyCompare(_altDifference, altDifference)) {
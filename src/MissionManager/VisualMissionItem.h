@@ -74,6 +74,7 @@ public:
     Q_PROPERTY(double altPercent        READ altPercent         WRITE setAltPercent         NOTIFY altPercentChanged)           ///< Percent of total altitude change in mission altitude
     Q_PROPERTY(double azimuth           READ azimuth            WRITE setAzimuth            NOTIFY azimuthChanged)              ///< Azimuth to previous waypoint
     Q_PROPERTY(double distance          READ distance           WRITE setDistance           NOTIFY distanceChanged)             ///< Distance to previous waypoint
+    Q_PROPERTY(double terrainClearance  READ terrainClearance   WRITE setTerrainClearance   NOTIFY terrainClearanceChanged)     ///< Lowest height above terrain from previous waypoint through this item, NaN if unknown
 
     // Property accesors
 
@@ -84,6 +85,7 @@ public:
     double altPercent       (void) const { return _altPercent; }
     double azimuth          (void) const { return _azimuth; }
     double distance         (void) const { return _distance; }
+    double terrainClearance (void) const { return _terrainClearance; }
     bool   isCurrentItem    (void) const { return _isCurrentItem; }
 
     QmlObjectListModel* childItems(void) { return &_childItems; }
@@ -93,6 +95,7 @@ public:
     void setAltPercent      (double altPercent);
     void setAzimuth         (double azimuth);
     void setDistance        (double distance);
+    void setTerrainClearance(double terrainClearance);
 
     Vehicle* vehicle(void) { return _vehicle; }
 
@@ -159,6 +162,7 @@ signals:
     void exitCoordinateChanged          (const QGeoCoordinate& exitCoordinate);
     void dirtyChanged                   (bool dirty);
     void distanceChanged                (double distance);
+    void terrainClearanceChanged        (double terrainClearance);
     void isCurrentItemChanged           (bool isCurrentItem);
     void sequenceNumberChanged          (int sequenceNumber);
     void isSimpleItemChanged            (bool isSimpleItem);
@@ -184,6 +188,7 @@ protected:
     double      _altPercent;                ///< Percent of total altitude change in mission
     double      _azimuth;                   ///< Azimuth to previous waypoint
     double      _distance;                  ///< Distance to previous waypoint
+    double      _terrainClearance;          ///< Lowest height above terrain from previous waypoint
     QString     _editorQml;                 ///< Qml resource for editing item
     double      _missionGimbalYaw;
     double      _missionVehicleYaw;
@@ -75,7 +75,7 @@ Item {
         mapPolygon:     _mapPolygon
         interactive:    _interactive
         borderWidth:    2
-        borderColor:    "orange"
+        borderColor:    planView || myGeoFenceController.vehicleInsidePolygon ? "orange" : "red"
         visible:        _polygonSupported && (planView || _polygonEnabled)
     }
 
@@ -60,6 +60,8 @@ Rectangle {
     property bool   _batteryInfoAvailable:      _batteryChangePoint >= 0 || _batteriesRequired >= 0
     property real   _controllerProgressPct:     _controllerValid ? planMasterController.missionController.progressPct : 0
     property bool   _syncInProgress:            _controllerValid ? planMasterController.missionController.syncInProgress : false
+    property real   _routeSavedDistance:        _controllerValid ? planMasterController.missionController.missionRouteSavedDistance : 0
+    property real   _routeSavedTime:            _controllerValid ? planMasterController.missionController.missionRouteSavedTime : 0
 
     property string _distanceText:              isNaN(_distance) ?              "-.-" : QGroundControl.metersToAppSettingsDistanceUnits(_distance).toFixed(1) + " " + QGroundControl.appSettingsDistanceUnitsString
     property string _altDifferenceText:         isNaN(_altDifference) ?         "-.-" : QGroundControl.metersToAppSettingsDistanceUnits(_altDifference).toFixed(1) + " " + QGroundControl.appSettingsDistanceUnitsString
@@ -70,6 +72,7 @@ Rectangle {
     property string _missionMaxTelemetryText:   isNaN(_missionMaxTelemetry) ?   "-.-" : QGroundControl.metersToAppSettingsDistanceUnits(_missionMaxTelemetry).toFixed(0) + " " + QGroundControl.appSettingsDistanceUnitsString
     property string _batteryChangePointText:    _batteryChangePoint < 0 ?       "N/A" : _batteryChangePoint
     property string _batteriesRequiredText:     _batteriesRequired < 0 ?        "N/A" : _batteriesRequired
+    property string _routeSavedDistanceText:    QGroundControl.metersToAppSettingsDistanceUnits(_routeSavedDistance).toFixed(0) + " " + QGroundControl.appSettingsDistanceUnitsString
 
     readonly property real _margins: ScreenTools.defaultFontPixelWidth
 
@@ -83,6 +86,11 @@ Rectangle {
         return Qt.formatTime(t, 'hh:mm:ss')
     }
 
+    function getRouteSavedTime() {
+        var t = new Date(0, 0, 0, 0, 0, Number(_routeSavedTime))
+        return Qt.formatTime(t, 'hh:mm:ss')
+    }
+
     //-- Eat mouse events, preventing them from reaching toolbar, which is underneath us.
     MouseArea {
         anchors.fill:   parent
@@ -291,6 +299,41 @@ Rectangle {
                 Layout.minimumWidth:    _mediumValueWidth
             }
         }
+
+        GridLayout {
+            anchors.verticalCenter: parent.verticalCenter
+            columns:                3
+            rowSpacing:             _rowSpacing
+            columnSpacing:          _labelToValueSpacing
+            Layout.alignment:       Qt.AlignHCenter
+            visible:                _routeSavedDistance >= 1
+
+            QGCLabel {
+                text:               qsTr("Survey Route")
+                Layout.columnSpan:  2
+                font.pointSize:     ScreenTools.smallFontPointSize
+            }
+
+            QGCButton {
+                text:               qsTr("Optimize")
+                Layout.rowSpan:     3
+                onClicked:          planMasterController.missionController.applySurveyRouteOptimization()
+            }
+
+            QGCLabel { text: qsTr("Saves distance:"); font.pointSize: _dataFontSize; }
+            QGCLabel {
+                text:                   _routeSavedDistanceText
+                font.pointSize:         _dataFontSize
+                Layout.minimumWidth:    _largeValueWidth
+            }
+
+            QGCLabel { text: qsTr("Saves time:"); font.pointSize: _dataFontSize; }
+            QGCLabel {
+                text:                   getRouteSavedTime()
+                font.pointSize:         _dataFontSize
+                Layout.minimumWidth:    _largeValueWidth
+            }
+        }
     }
 
     QGCButton {
@@ -478,6 +478,17 @@ Rectangle {
                     Layout.columnSpan:  2
                 }
 
+                QGCButton {
+                    text:       qsTr("Add exclusion area")
+                    onClicked:  missionItem.addExclusionPolygon()
+                }
+
+                QGCButton {
+                    text:       qsTr("Clear exclusion areas")
+                    enabled:    missionItem.exclusionPolygons.count > 0
+                    onClicked:  missionItem.clearExclusionPolygons()
+                }
+
                 QGCLabel {
                     wrapMode:               Text.WordWrap
                     text:                   qsTr("Select one:")
@@ -591,6 +602,17 @@ Rectangle {
                 Layout.columnSpan:  2
             }
 
+            QGCButton {
+                text:       qsTr("Add exclusion area")
+                onClicked:  missionItem.addExclusionPolygon()
+            }
+
+            QGCButton {
+                text:       qsTr("Clear exclusion areas")
+                enabled:    missionItem.exclusionPolygons.count > 0
+                onClicked:  missionItem.clearExclusionPolygons()
+            }
+
             FactCheckBox {
                 anchors.left:       parent.left
                 text:               qsTr("Relative altitude")
@@ -98,6 +98,21 @@ Item {
         interiorOpacity:    0.5
     }
 
+    // Exclusion areas cut out of the survey polygon
+    Repeater {
+        model: _missionItem.exclusionPolygons
+
+        QGCMapPolygonVisuals {
+            mapControl:         map
+            mapPolygon:         object
+            interactive:        _missionItem.isCurrentItem
+            borderWidth:        1
+            borderColor:        "black"
+            interiorColor:      "red"
+            interiorOpacity:    0.5
+        }
+    }
+
     // Survey grid lines
     Component {
         id: gridComponent
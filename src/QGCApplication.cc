@@ -279,6 +279,11 @@ QGCApplication::QGCApplication(int &argc, char* argv[], bool unitTesting)
         QDir paramDir(ParameterManager::parameterCacheDir());
         paramDir.removeRecursively();
         paramDir.mkpath(paramDir.absolutePath());
+
+        // Clear mission cache
+        QDir missionDir(MissionManager::missionCacheDir());
+        missionDir.removeRecursively();
+        missionDir.mkpath(missionDir.absolutePath());
     } else {
         // Determine if upgrade message for settings version bump is required. Check and clear must happen before toolbox is started since
         // that will write some settings.
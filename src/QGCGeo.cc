@@ -23,61 +23,183 @@
 #define CONSTANTS_AIR_GAS_CONST				287.1f 			/* J/(kg * K)		*/
 #define CONSTANTS_ABSOLUTE_NULL_CELSIUS			-273.15f		/* °C			*/
 #define CONSTANTS_RADIUS_OF_EARTH			6371000			/* meters (m)		*/
+#define CONSTANTS_EARTH_MEAN_RADIUS			6371007.2		/* meters (m), same as QGeoCoordinate	*/
 
 static const float epsilon = std::numeric_limits<double>::epsilon();
 
-void convertGeoToNed(QGeoCoordinate coord, QGeoCoordinate origin, double* x, double* y, double* z) {
-
-    double lat_rad = coord.latitude() * M_DEG_TO_RAD;
-    double lon_rad = coord.longitude() * M_DEG_TO_RAD;
+// The kernels below are shared by the single point and the batch functions so both give identical results. They work
+// on plain doubles only, which lets the compiler inline them into the batch loops.
 
-    double ref_lon_rad = origin.longitude() * M_DEG_TO_RAD;
-    double ref_lat_rad = origin.latitude() * M_DEG_TO_RAD;
+static inline void _geoToNed(double lat_deg, double lon_deg, const GeoOrigin_t& origin, double* x, double* y)
+{
+    double lat_rad = lat_deg * M_DEG_TO_RAD;
+    double d_lon = (lon_deg * M_DEG_TO_RAD) - origin.lonRad;
 
     double sin_lat = sin(lat_rad);
     double cos_lat = cos(lat_rad);
-    double cos_d_lon = cos(lon_rad - ref_lon_rad);
+    double cos_d_lon = cos(d_lon);
 
-    double ref_sin_lat = sin(ref_lat_rad);
-    double ref_cos_lat = cos(ref_lat_rad);
-
-    double c = acos(ref_sin_lat * sin_lat + ref_cos_lat * cos_lat * cos_d_lon);
+    // Rounding can push the cosine just past 1 for locations at the origin, which would make acos return nan
+    double cos_c = qBound(-1.0, origin.sinLat * sin_lat + origin.cosLat * cos_lat * cos_d_lon, 1.0);
+    double c = acos(cos_c);
     double k = (fabs(c) < epsilon) ? 1.0 : (c / sin(c));
 
-    *x = k * (ref_cos_lat * sin_lat - ref_sin_lat * cos_lat * cos_d_lon) * CONSTANTS_RADIUS_OF_EARTH;
-    *y = k * cos_lat * sin(lon_rad - ref_lon_rad) * CONSTANTS_RADIUS_OF_EARTH;
-
-    *z = -(coord.altitude() - origin.altitude());
+    *x = k * (origin.cosLat * sin_lat - origin.sinLat * cos_lat * cos_d_lon) * CONSTANTS_RADIUS_OF_EARTH;
+    *y = k * cos_lat * sin(d_lon) * CONSTANTS_RADIUS_OF_EARTH;
 }
 
-void convertNedToGeo(double x, double y, double z, QGeoCoordinate origin, QGeoCoordinate *coord) {
+static inline void _nedToGeo(double x, double y, const GeoOrigin_t& origin, double* lat_deg, double* lon_deg)
+{
     double x_rad = x / CONSTANTS_RADIUS_OF_EARTH;
     double y_rad = y / CONSTANTS_RADIUS_OF_EARTH;
-    double c = sqrtf(x_rad * x_rad + y_rad * y_rad);
+    double c = sqrt(x_rad * x_rad + y_rad * y_rad);
     double sin_c = sin(c);
     double cos_c = cos(c);
 
-    double ref_lon_rad = origin.longitude() * M_DEG_TO_RAD;
-    double ref_lat_rad = origin.latitude() * M_DEG_TO_RAD;
-
-    double ref_sin_lat = sin(ref_lat_rad);
-    double ref_cos_lat = cos(ref_lat_rad);
-
     double lat_rad;
     double lon_rad;
 
     if (fabs(c) > epsilon) {
-        lat_rad = asin(cos_c * ref_sin_lat + (x_rad * sin_c * ref_cos_lat) / c);
-        lon_rad = (ref_lon_rad + atan2(y_rad * sin_c, c * ref_cos_lat * cos_c - x_rad * ref_sin_lat * sin_c));
-
+        lat_rad = asin(cos_c * origin.sinLat + (x_rad * sin_c * origin.cosLat) / c);
+        lon_rad = (origin.lonRad + atan2(y_rad * sin_c, c * origin.cosLat * cos_c - x_rad * origin.sinLat * sin_c));
     } else {
-        lat_rad = ref_lat_rad;
-        lon_rad = ref_lon_rad;
+        lat_rad = origin.latRad;
+        lon_rad = origin.lonRad;
     }
 
-    coord->setLatitude(lat_rad * M_RAD_TO_DEG);
-    coord->setLongitude(lon_rad * M_RAD_TO_DEG);
+    *lat_deg = lat_rad * M_RAD_TO_DEG;
+    *lon_deg = lon_rad * M_RAD_TO_DEG;
+}
+
+static inline double _haversine(double lat1_rad, double cos_lat1, double lon1_deg, double lat2_rad, double cos_lat2, double lon2_deg)
+{
+    double sin_d_lat = sin((lat2_rad - lat1_rad) / 2.0);
+    double sin_d_lon = sin(((lon2_deg - lon1_deg) * M_DEG_TO_RAD) / 2.0);
+
+    double h = (sin_d_lat * sin_d_lat) + (cos_lat1 * cos_lat2 * sin_d_lon * sin_d_lon);
+    return 2.0 * asin(sqrt(h)) * CONSTANTS_EARTH_MEAN_RADIUS;
+}
+
+static inline double _haversine(double lat1_rad, double cos_lat1, double lon1_deg, double lat2_deg, double lon2_deg)
+{
+    double lat2_rad = lat2_deg * M_DEG_TO_RAD;
+
+    return _haversine(lat1_rad, cos_lat1, lon1_deg, lat2_rad, cos(lat2_rad), lon2_deg);
+}
+
+static inline double _azimuth(double sin_lat1, double cos_lat1, double lon1_deg, double sin_lat2, double cos_lat2, double lon2_deg)
+{
+    double d_lon = (lon2_deg - lon1_deg) * M_DEG_TO_RAD;
+
+    double y = sin(d_lon) * cos_lat2;
+    double x = cos_lat1 * sin_lat2 - sin_lat1 * cos_lat2 * cos(d_lon);
+
+    double whole;
+    double fraction = modf((atan2(y, x) * M_RAD_TO_DEG) + 360.0, &whole);
+    return (((int)whole + 360) % 360) + fraction;
+}
+
+GeoOrigin_t geoOrigin(const QGeoCoordinate& origin)
+{
+    GeoOrigin_t geoOrigin;
+
+    geoOrigin.latRad = origin.latitude() * M_DEG_TO_RAD;
+    geoOrigin.lonRad = origin.longitude() * M_DEG_TO_RAD;
+    geoOrigin.sinLat = sin(geoOrigin.latRad);
+    geoOrigin.cosLat = cos(geoOrigin.latRad);
+    geoOrigin.altitude = origin.altitude();
+
+    return geoOrigin;
+}
+
+void convertGeoToNed(QGeoCoordinate coord, QGeoCoordinate origin, double* x, double* y, double* z) {
+    _geoToNed(coord.latitude(), coord.longitude(), geoOrigin(origin), x, y);
+    *z = -(coord.altitude() - origin.altitude());
+}
+
+void convertNedToGeo(double x, double y, double z, QGeoCoordinate origin, QGeoCoordinate *coord) {
+    double latitude, longitude;
+
+    _nedToGeo(x, y, geoOrigin(origin), &latitude, &longitude);
 
+    coord->setLatitude(latitude);
+    coord->setLongitude(longitude);
     coord->setAltitude(-z + origin.altitude());
 }
 
+void convertGeoToNed(double latitude, double longitude, const GeoOrigin_t& origin, double* x, double* y)
+{
+    _geoToNed(latitude, longitude, origin, x, y);
+}
+
+void convertNedToGeo(double x, double y, const GeoOrigin_t& origin, double* latitude, double* longitude)
+{
+    _nedToGeo(x, y, origin, latitude, longitude);
+}
+
+void convertGeoToNed(const double* latitudes, const double* longitudes, int count, const GeoOrigin_t& origin, double* x, double* y)
+{
+    for (int i=0; i<count; i++) {
+        _geoToNed(latitudes[i], longitudes[i], origin, &x[i], &y[i]);
+    }
+}
+
+void convertNedToGeo(const double* x, const double* y, int count, const GeoOrigin_t& origin, double* latitudes, double* longitudes)
+{
+    for (int i=0; i<count; i++) {
+        _nedToGeo(x[i], y[i], origin, &latitudes[i], &longitudes[i]);
+    }
+}
+
+double geoDistance(double latitude1, double longitude1, double latitude2, double longitude2)
+{
+    double lat1_rad = latitude1 * M_DEG_TO_RAD;
+
+    return _haversine(lat1_rad, cos(lat1_rad), longitude1, latitude2, longitude2);
+}
+
+double geoDistance(const GeoOrigin_t& origin, double latitude, double longitude)
+{
+    return _haversine(origin.latRad, origin.cosLat, origin.lonRad * M_RAD_TO_DEG, latitude, longitude);
+}
+
+void geoDistances(double latitude, double longitude, const double* latitudes, const double* longitudes, int count, double* distances)
+{
+    double lat_rad = latitude * M_DEG_TO_RAD;
+    double cos_lat = cos(lat_rad);
+
+    for (int i=0; i<count; i++) {
+        distances[i] = _haversine(lat_rad, cos_lat, longitude, latitudes[i], longitudes[i]);
+    }
+}
+
+double geoPathLength(const double* latitudes, const double* longitudes, int count)
+{
+    double length = 0.0;
+
+    if (count > 1) {
+        double lat_rad = latitudes[0] * M_DEG_TO_RAD;
+        double cos_lat = cos(lat_rad);
+
+        for (int i=1; i<count; i++) {
+            length += _haversine(lat_rad, cos_lat, longitudes[i - 1], latitudes[i], longitudes[i]);
+
+            // The end of this leg is the start of the next one, so its cosine is reused
+            lat_rad = latitudes[i] * M_DEG_TO_RAD;
+            cos_lat = cos(lat_rad);
+        }
+    }
+
+    return length;
+}
+
+void geoDistanceAzimuth(double latitude1, double longitude1, double latitude2, double longitude2, double* distance, double* azimuth)
+{
+    double lat1_rad = latitude1 * M_DEG_TO_RAD;
+    double lat2_rad = latitude2 * M_DEG_TO_RAD;
+    double cos_lat1 = cos(lat1_rad);
+    double cos_lat2 = cos(lat2_rad);
+
+    *distance = _haversine(lat1_rad, cos_lat1, longitude1, lat2_rad, cos_lat2, longitude2);
+    *azimuth = _azimuth(sin(lat1_rad), cos_lat1, longitude1, sin(lat2_rad), cos_lat2, longitude2);
+}
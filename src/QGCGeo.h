@@ -46,4 +46,106 @@ void convertGeoToNed(QGeoCoordinate coord, QGeoCoordinate origin, double* x, dou
  */
 void convertNedToGeo(double x, double y, double z, QGeoCoordinate origin, QGeoCoordinate *coord);
 
+/**
+ * @brief Local tangential plane origin with its trigonometry computed up front. Use it when many coordinates are
+ * converted against the same origin.
+ */
+typedef struct {
+    double latRad;      ///< Origin latitude in radians
+    double lonRad;      ///< Origin longitude in radians
+    double sinLat;      ///< sin(latRad)
+    double cosLat;      ///< cos(latRad)
+    double altitude;    ///< Origin altitude in meters
+} GeoOrigin_t;
+
+/**
+ * @brief Precompute the values needed to project coordinates against the specified origin.
+ * @param[in] origin Geodetic origin for LTP projection.
+ */
+GeoOrigin_t geoOrigin(const QGeoCoordinate& origin);
+
+/**
+ * @brief Project a geodetic location on to the local tangential plane of a precomputed origin.
+ * @param[in] latitude Latitude of location in degrees.
+ * @param[in] longitude Longitude of location in degrees.
+ * @param[in] origin Precomputed origin for LTP projection.
+ * @param[out] x North component of location in local plane.
+ * @param[out] y East component of location in local plane.
+ */
+void convertGeoToNed(double latitude, double longitude, const GeoOrigin_t& origin, double* x, double* y);
+
+/**
+ * @brief Transform a local North, East location on the tangential plane of a precomputed origin to geodetic.
+ * @param[in] x North component of local location in meters.
+ * @param[in] y East component of local location in meters.
+ * @param[in] origin Precomputed origin for LTP.
+ * @param[out] latitude Latitude of location in degrees.
+ * @param[out] longitude Longitude of location in degrees.
+ */
+void convertNedToGeo(double x, double y, const GeoOrigin_t& origin, double* latitude, double* longitude);
+
+/**
+ * @brief Project count geodetic locations on to the local tangential plane. Input and output are separate contiguous
+ * arrays so the loop has no aliasing and no per point allocation.
+ * @param[in] latitudes Latitudes in degrees.
+ * @param[in] longitudes Longitudes in degrees.
+ * @param[in] count Number of locations.
+ * @param[in] origin Precomputed origin for LTP projection.
+ * @param[out] x North components, count entries.
+ * @param[out] y East components, count entries.
+ */
+void convertGeoToNed(const double* latitudes, const double* longitudes, int count, const GeoOrigin_t& origin, double* x, double* y);
+
+/**
+ * @brief Transform count local North, East locations to geodetic.
+ * @param[in] x North components in meters.
+ * @param[in] y East components in meters.
+ * @param[in] count Number of locations.
+ * @param[in] origin Precomputed origin for LTP.
+ * @param[out] latitudes Latitudes in degrees, count entries.
+ * @param[out] longitudes Longitudes in degrees, count entries.
+ */
+void convertNedToGeo(const double* x, const double* y, int count, const GeoOrigin_t& origin, double* latitudes, double* longitudes);
+
+/**
+ * @brief Great circle distance between two locations. Same haversine formula and earth radius as
+ * QGeoCoordinate::distanceTo, without the validity checks and object overhead.
+ * @return Distance in meters.
+ */
+double geoDistance(double latitude1, double longitude1, double latitude2, double longitude2);
+
+/**
+ * @brief Great circle distance from a precomputed origin to a location. Matches geoDistance to within rounding.
+ * @param[in] origin Precomputed origin to measure from.
+ * @param[in] latitude Latitude of location to measure to in degrees.
+ * @param[in] longitude Longitude of location to measure to in degrees.
+ * @return Distance in meters.
+ */
+double geoDistance(const GeoOrigin_t& origin, double latitude, double longitude);
+
+/**
+ * @brief Great circle distance from one location to each of count locations.
+ * @param[in] latitude Latitude of location to measure from in degrees.
+ * @param[in] longitude Longitude of location to measure from in degrees.
+ * @param[in] latitudes Latitudes to measure to in degrees.
+ * @param[in] longitudes Longitudes to measure to in degrees.
+ * @param[in] count Number of locations to measure to.
+ * @param[out] distances Distances in meters, count entries.
+ */
+void geoDistances(double latitude, double longitude, const double* latitudes, const double* longitudes, int count, double* distances);
+
+/**
+ * @brief Length of the path which runs through count locations in order.
+ * @return Sum of the great circle distances between consecutive locations in meters.
+ */
+double geoPathLength(const double* latitudes, const double* longitudes, int count);
+
+/**
+ * @brief Great circle distance and initial heading from the first to the second location, sharing the trigonometry
+ * of the two latitudes. Same distance as geoDistance and same azimuth as QGeoCoordinate::azimuthTo.
+ * @param[out] distance Distance in meters.
+ * @param[out] azimuth Azimuth in degrees, 0 to 360.
+ */
+void geoDistanceAzimuth(double latitude1, double longitude1, double latitude2, double longitude2, double* distance, double* azimuth);
+
 #endif // QGCGEO_H
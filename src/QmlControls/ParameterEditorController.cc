@@ -44,6 +44,7 @@ ParameterEditorController::ParameterEditorController(void)
     connect(this, &ParameterEditorController::searchTextChanged, this, &ParameterEditorController::_updateParameters);
     connect(this, &ParameterEditorController::currentComponentIdChanged, this, &ParameterEditorController::_updateParameters);
     connect(this, &ParameterEditorController::currentGroupChanged, this, &ParameterEditorController::_updateParameters);
+    connect(_vehicle->parameterManager(), &ParameterManager::bulkWriteComplete, this, &ParameterEditorController::_bulkWriteComplete);
 }
 
 ParameterEditorController::~ParameterEditorController()
@@ -67,24 +68,7 @@ QStringList ParameterEditorController::getParametersForGroup(int componentId, QS
 
 QStringList ParameterEditorController::searchParametersForComponent(int componentId, const QString& searchText, bool searchInName, bool searchInDescriptions)
 {
-    QStringList list;
-    
-    foreach(const QString &paramName, _vehicle->parameterManager()->parameterNames(componentId)) {
-        if (searchText.isEmpty()) {
-            list += paramName;
-        } else {
-            Fact* fact = _vehicle->parameterManager()->getParameter(componentId, paramName);
-            
-            if (searchInName && fact->name().contains(searchText, Qt::CaseInsensitive)) {
-                list += paramName;
-            } else if (searchInDescriptions && (fact->shortDescription().contains(searchText, Qt::CaseInsensitive) || fact->longDescription().contains(searchText, Qt::CaseInsensitive))) {
-                list += paramName;
-            }
-        }
-    }
-    list.sort();
-    
-    return list;
+    return _vehicle->parameterManager()->searchParameters(componentId, searchText, searchInName, searchInDescriptions);
 }
 
 void ParameterEditorController::clearRCToParam(void)
@@ -132,6 +116,13 @@ void ParameterEditorController::loadFromFile(const QString& filename)
     }
 }
 
+void ParameterEditorController::_bulkWriteComplete(QStringList failedParameters)
+{
+    if (!failedParameters.isEmpty()) {
+        emit showErrorMessage(tr("Vehicle did not accept parameters: %1").arg(failedParameters.join(", ")));
+    }
+}
+
 void ParameterEditorController::refresh(void)
 {
     _vehicle->parameterManager()->refreshAllParameters();
@@ -165,13 +156,9 @@ void ParameterEditorController::_updateParameters(void)
             newParameterList.append(_vehicle->parameterManager()->getParameter(_currentComponentId, parameter));
         }
     } else {
-        foreach(const QString &parameter, _vehicle->parameterManager()->parameterNames(_vehicle->defaultComponentId())) {
-            Fact* fact = _vehicle->parameterManager()->getParameter(_vehicle->defaultComponentId(), parameter);
-            if (fact->name().contains(_searchText, Qt::CaseInsensitive) ||
-                    fact->shortDescription().contains(_searchText, Qt::CaseInsensitive) ||
-                    fact->longDescription().contains(_searchText, Qt::CaseInsensitive)) {
-                newParameterList.append(fact);
-            }
+        // Only the matching parameters need Facts
+        foreach(const QString &parameter, _vehicle->parameterManager()->searchParameters(_vehicle->defaultComponentId(), _searchText, true, true)) {
+            newParameterList.append(_vehicle->parameterManager()->getParameter(_vehicle->defaultComponentId(), parameter));
         }
     }
 
@@ -57,6 +57,7 @@ signals:
 
 private slots:
     void _updateParameters(void);
+    void _bulkWriteComplete(QStringList failedParameters);
 
 private:
     QVariantList        _componentIds;
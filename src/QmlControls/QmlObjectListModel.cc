@@ -174,6 +174,31 @@ void QmlObjectListModel::insert(int i, QObject* object)
     setDirty(true);
 }
 
+/// Replaces the object at the specified index. Views see a single changed row instead of a remove and insert.
+///     @return Object which was replaced
+QObject* QmlObjectListModel::replace(int i, QObject* object)
+{
+    QObject* replacedObject = _objectList[i];
+    bool trackDirty = !_skipDirtyFirstItem || i != 0;
+
+    // Look for a dirtyChanged signal on the objects
+    if (trackDirty && replacedObject->metaObject()->indexOfSignal(QMetaObject::normalizedSignature("dirtyChanged(bool)")) != -1) {
+        QObject::disconnect(replacedObject, SIGNAL(dirtyChanged(bool)), this, SLOT(_childDirtyChanged(bool)));
+    }
+
+    QQmlEngine::setObjectOwnership(object, QQmlEngine::CppOwnership);
+
+    if (trackDirty && object->metaObject()->indexOfSignal(QMetaObject::normalizedSignature("dirtyChanged(bool)")) != -1) {
+        QObject::connect(object, SIGNAL(dirtyChanged(bool)), this, SLOT(_childDirtyChanged(bool)));
+    }
+
+    setData(index(i), QVariant::fromValue(object), ObjectRole);
+
+    setDirty(true);
+
+    return replacedObject;
+}
+
 void QmlObjectListModel::append(QObject* object)
 {
     insert(_objectList.count(), object);
@@ -42,6 +42,7 @@ public:
     QObject* removeAt(int i);
     QObject* removeOne(QObject* object) { return removeAt(indexOf(object)); }
     void insert(int i, QObject* object);
+    QObject* replace(int i, QObject* object);
     QObject* operator[](int i);
     const QObject* operator[](int i) const;
     bool contains(QObject* object) { return _objectList.indexOf(object) != -1; }
@@ -190,16 +190,20 @@ QGCMapEngine::_wipeOldCaches()
 
 //-----------------------------------------------------------------------------
 void
-QGCMapEngine::init()
+QGCMapEngine::init(const QString& cachePath)
 {
-    //-- Delete old style caches (if present)
-    _wipeOldCaches();
-    //-- Figure out cache path
+    QString cacheDir = cachePath;
+    //-- A given cache path (unit tests) leaves the user's cache alone
+    if(cacheDir.isEmpty()) {
+        //-- Delete old style caches (if present)
+        _wipeOldCaches();
+        //-- Figure out cache path
 #ifdef __mobile__
-    QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)      + QLatin1String("/QGCMapCache" CACHE_PATH_VERSION);
+        cacheDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)      + QLatin1String("/QGCMapCache" CACHE_PATH_VERSION);
 #else
-    QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QLatin1String("/QGCMapCache" CACHE_PATH_VERSION);
+        cacheDir = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QLatin1String("/QGCMapCache" CACHE_PATH_VERSION);
 #endif
+    }
     if(!QDir::root().mkpath(cacheDir)) {
         qWarning() << "Could not create mapping disk cache directory: " << cacheDir;
         cacheDir = QDir::homePath() + QLatin1String("/.qgcmapscache/");
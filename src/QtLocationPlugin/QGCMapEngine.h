@@ -69,7 +69,7 @@ public:
     QGCMapEngine                ();
     ~QGCMapEngine               ();
 
-    void                        init                ();
+    void                        init                (const QString& cachePath = QString());
     void                        addTask             (QGCMapTask *task);
     void                        cacheTile           (UrlFactory::MapType type, int x, int y, int z, const QByteArray& image, const QString& format, qulonglong set = UINT64_MAX);
     void                        cacheTile           (UrlFactory::MapType type, const QString& hash, const QByteArray& image, const QString& format, qulonglong set = UINT64_MAX);
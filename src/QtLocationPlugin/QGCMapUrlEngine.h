@@ -72,7 +72,9 @@ public:
 
         EsriWorldStreet         = 7000,
         EsriWorldSatellite      = 7001,
-        EsriTerrain             = 7002
+        EsriTerrain             = 7002,
+
+        TerrainElevation        = 8000      ///< SRTM style elevation tiles, only kept in the cache. Not a map.
     };
 
     UrlFactory      ();
@@ -51,6 +51,7 @@ const char* AppSettings::telemetryDirectory =       "Telemetry";
 const char* AppSettings::missionDirectory =         "Missions";
 const char* AppSettings::logDirectory =             "Logs";
 const char* AppSettings::videoDirectory =           "Video";
+const char* AppSettings::terrainDirectory =         "Terrain";
 
 AppSettings::AppSettings(QObject* parent)
     : SettingsGroup(appSettingsGroupName, QString() /* root settings group */, parent)
@@ -115,6 +116,7 @@ void AppSettings::_checkSavePathDirectories(void)
         savePathDir.mkdir(missionDirectory);
         savePathDir.mkdir(logDirectory);
         savePathDir.mkdir(videoDirectory);
+        savePathDir.mkdir(terrainDirectory);
     }
 }
 
@@ -330,6 +332,19 @@ QString AppSettings::videoSavePath(void)
     return fullPath;
 }
 
+QString AppSettings::terrainSavePath(void)
+{
+    QString fullPath;
+
+    QString path = savePath()->rawValue().toString();
+    if (!path.isEmpty() && QDir(path).exists()) {
+        QDir dir(path);
+        return dir.filePath(terrainDirectory);
+    }
+
+    return fullPath;
+}
+
 Fact* AppSettings::autoLoadMissions(void)
 {
     if (!_autoLoadMissionsFact) {
@@ -0,0 +1,167 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TerrainClearance.h"
+
+#include <QtMath>
+
+#include <cmath>
+#include <limits>
+
+const double TerrainClearance::sampleSpacing = 30.0;
+
+QList<TerrainClearance::Result_t> TerrainClearance::compute(const QGeoCoordinate& home, const QList<Path_t>& paths, const TerrainTileSet& tiles, const QAtomicInt* cancel)
+{
+    QList<Result_t> results;
+
+    // The vehicle takes off from the ground, so relative altitudes are relative to the terrain at home. Fall back to
+    // the home altitude when there is no terrain data for it.
+    double homeAltitude = std::numeric_limits<double>::quiet_NaN();
+    if (home.isValid()) {
+        homeAltitude = tiles.elevation(home.latitude(), home.longitude());
+        if (qIsNaN(homeAltitude)) {
+            homeAltitude = home.altitude();
+        }
+    }
+
+    for (int i=0; i<paths.count(); i++) {
+        if (_cancelled(cancel)) {
+            return results;
+        }
+        results.append(_clearance(homeAltitude, paths[i], tiles));
+    }
+
+    return results;
+}
+
+TerrainClearance::Result_t TerrainClearance::_clearance(double homeAltitude, const Path_t& path, const TerrainTileSet& tiles)
+{
+    Result_t            result;
+    const TerrainTile*  tile = NULL;
+
+    result.minClearance = std::numeric_limits<double>::quiet_NaN();
+    result.maxTerrain = std::numeric_limits<double>::quiet_NaN();
+    result.sampleCount = 0;
+    result.missingCount = 0;
+
+    for (int i=0; i<path.coordinates.count(); i++) {
+        const QGeoCoordinate& coord2 = path.coordinates[i];
+        double altitude2 = coord2.altitude() + (path.relativeAltitude[i] ? homeAltitude : 0);
+
+        // The first coordinate is sampled on its own, every following one along the segment leading up to it
+        QGeoCoordinate  coord1 = i == 0 ? coord2 : path.coordinates[i - 1];
+        double          altitude1 = i == 0 ? altitude2 : coord1.altitude() + (path.relativeAltitude[i - 1] ? homeAltitude : 0);
+        int             steps = i == 0 ? 1 : qMax(1, (int)std::ceil(coord1.distanceTo(coord2) / sampleSpacing));
+        int             firstStep = i == 0 ? steps : 1;
+
+        double latDelta = coord2.latitude() - coord1.latitude();
+        double lonDelta = coord2.longitude() - coord1.longitude();
+        if (lonDelta > 180) {
+            lonDelta -= 360;
+        } else if (lonDelta < -180) {
+            lonDelta += 360;
+        }
+
+        for (int step=firstStep; step<=steps; step++) {
+            double fraction = (double)step / steps;
+            double latitude = coord1.latitude() + (latDelta * fraction);
+            double longitude = coord1.longitude() + (lonDelta * fraction);
+            if (longitude > 180) {
+                longitude -= 360;
+            } else if (longitude < -180) {
+                longitude += 360;
+            }
+
+            // Consecutive samples are nearly always in the same tile, so skip the lookup for those
+            if (!tile || !tile->contains(latitude, longitude)) {
+                tile = tiles.tile(latitude, longitude);
+            }
+
+            double terrain = tile ? tile->elevation(latitude, longitude) : std::numeric_limits<double>::quiet_NaN();
+            double altitude = altitude1 + ((altitude2 - altitude1) * fraction);
+
+            result.sampleCount++;
+            if (qIsNaN(terrain) || qIsNaN(altitude)) {
+                result.missingCount++;
+                continue;
+            }
+
+            double clearance = altitude - terrain;
+            if (qIsNaN(result.minClearance) || clearance < result.minClearance) {
+                result.minClearance = clearance;
+                result.minLocation = QGeoCoordinate(latitude, longitude, terrain);
+            }
+            if (qIsNaN(result.maxTerrain) || terrain > result.maxTerrain) {
+                result.maxTerrain = terrain;
+            }
+        }
+    }
+
+    return result;
+}
+
+QSet<int> TerrainClearance::tileKeys(const QGeoCoordinate& home, const QList<Path_t>& paths)
+{
+    QSet<int> keys;
+
+    if (home.isValid()) {
+        keys.insert(TerrainTile::tileKey(home.latitude(), home.longitude()));
+    }
+
+    for (int i=0; i<paths.count(); i++) {
+        const QVector<QGeoCoordinate>& coordinates = paths[i].coordinates;
+
+        for (int j=0; j<coordinates.count(); j++) {
+            const QGeoCoordinate& coord1 = coordinates[j == 0 ? 0 : j - 1];
+            const QGeoCoordinate& coord2 = coordinates[j];
+
+            // All tiles in the bounding box of the segment, which is exact for the short segments of a mission
+            int minLatIndex = TerrainTile::tileIndex(qMin(coord1.latitude(), coord2.latitude()));
+            int maxLatIndex = TerrainTile::tileIndex(qMax(coord1.latitude(), coord2.latitude()));
+            int minLonIndex = TerrainTile::tileIndex(qMin(coord1.longitude(), coord2.longitude()));
+            int maxLonIndex = TerrainTile::tileIndex(qMax(coord1.longitude(), coord2.longitude()));
+            if (maxLonIndex - minLonIndex > 180) {
+                // Crosses the antimeridian, only the tiles at the edges are needed
+                keys.insert(TerrainTile::tileKey(coord1.latitude(), coord1.longitude()));
+                keys.insert(TerrainTile::tileKey(coord2.latitude(), coord2.longitude()));
+                continue;
+            }
+
+            for (int latIndex=minLatIndex; latIndex<=maxLatIndex; latIndex++) {
+                for (int lonIndex=minLonIndex; lonIndex<=maxLonIndex; lonIndex++) {
+                    keys.insert(TerrainTile::tileKey(qBound(-90, latIndex, 89), qBound(-180, lonIndex, 179)));
+                }
+            }
+        }
+    }
+
+    return keys;
+}
+
+bool TerrainClearance::samePath(const Path_t& path1, const Path_t& path2)
+{
+    if (path1.relativeAltitude != path2.relativeAltitude || path1.coordinates.count() != path2.coordinates.count()) {
+        return false;
+    }
+
+    for (int i=0; i<path1.coordinates.count(); i++) {
+        const QGeoCoordinate& coord1 = path1.coordinates[i];
+        const QGeoCoordinate& coord2 = path2.coordinates[i];
+
+        // QGeoCoordinate equality ignores small differences, which would leave a stale result behind
+        if (coord1.latitude() != coord2.latitude() || coord1.longitude() != coord2.longitude()) {
+            return false;
+        }
+        if (coord1.altitude() != coord2.altitude() && !(qIsNaN(coord1.altitude()) && qIsNaN(coord2.altitude()))) {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,63 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#ifndef TerrainClearance_H
+#define TerrainClearance_H
+
+#include "TerrainTile.h"
+
+#include <QAtomicInt>
+#include <QGeoCoordinate>
+#include <QList>
+#include <QSet>
+#include <QVector>
+
+/// Computes the height above terrain along flight paths.
+///
+/// Each path is sampled along its straight segments at a fixed spacing close to the resolution of SRTM1 data, and the
+/// terrain elevation is interpolated at every sample. Relative altitudes are taken to be relative to the terrain at
+/// the home position, since that is where the vehicle takes off from.
+///
+/// Like SurveyRouteOptimizer it works only on the values passed in, so it can run on a worker thread.
+class TerrainClearance
+{
+public:
+    typedef struct {
+        QVector<QGeoCoordinate> coordinates;
+        QVector<bool>           relativeAltitude;   ///< true: altitude of the coordinate at the same index is relative to home
+    } Path_t;
+
+    typedef struct {
+        double          minClearance;       ///< Lowest height above terrain along the path, NaN if there is no terrain data for it
+        QGeoCoordinate  minLocation;        ///< Where minClearance occurs, the altitude is the terrain elevation
+        double          maxTerrain;         ///< Highest terrain elevation along the path, NaN if there is no terrain data for it
+        int             sampleCount;
+        int             missingCount;       ///< Samples without terrain data
+    } Result_t;
+
+    /// Computes the clearance along each path.
+    ///     @param home Home position, used for relative altitudes
+    ///     @param cancel Computation stops early if this becomes non-zero, NULL for no cancellation
+    /// @return One result per path, fewer if cancelled
+    static QList<Result_t> compute(const QGeoCoordinate& home, const QList<Path_t>& paths, const TerrainTileSet& tiles, const QAtomicInt* cancel);
+
+    /// @return Keys of all the tiles needed to compute the clearance of the paths
+    static QSet<int> tileKeys(const QGeoCoordinate& home, const QList<Path_t>& paths);
+
+    /// @return true: Both paths produce the same result
+    static bool samePath(const Path_t& path1, const Path_t& path2);
+
+    static const double sampleSpacing;  ///< Distance between samples in meters
+
+private:
+    static bool     _cancelled  (const QAtomicInt* cancel) { return cancel && cancel->load(); }
+    static Result_t _clearance  (double homeAltitude, const Path_t& path, const TerrainTileSet& tiles);
+};
+
+#endif
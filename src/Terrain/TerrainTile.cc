@@ -0,0 +1,126 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TerrainTile.h"
+
+#include <QtEndian>
+#include <QtMath>
+
+#include <cmath>
+#include <limits>
+
+const char* TerrainTile::fileExtension = "hgt";
+
+TerrainTile::TerrainTile(int latIndex, int lonIndex, const QByteArray& hgtBytes)
+    : _latIndex(latIndex)
+    , _lonIndex(lonIndex)
+    , _samplesPerSide(0)
+{
+    int sampleCount = hgtBytes.count() / 2;
+    int samplesPerSide = qRound(std::sqrt((double)sampleCount));
+
+    if (samplesPerSide < 2 || samplesPerSide * samplesPerSide != sampleCount || hgtBytes.count() % 2) {
+        return;
+    }
+
+    const uchar* data = (const uchar*)hgtBytes.constData();
+    _heights.resize(sampleCount);
+    for (int i=0; i<sampleCount; i++) {
+        _heights[i] = qFromBigEndian<qint16>(data + (i * 2));
+    }
+    _samplesPerSide = samplesPerSide;
+}
+
+int TerrainTile::tileIndex(double degrees)
+{
+    return (int)std::floor(degrees);
+}
+
+QString TerrainTile::tileName(int latIndex, int lonIndex)
+{
+    return QString("%1%2%3%4")
+            .arg(latIndex < 0 ? QLatin1Char('S') : QLatin1Char('N'))
+            .arg(qAbs(latIndex), 2, 10, QLatin1Char('0'))
+            .arg(lonIndex < 0 ? QLatin1Char('W') : QLatin1Char('E'))
+            .arg(qAbs(lonIndex), 3, 10, QLatin1Char('0'));
+}
+
+bool TerrainTile::contains(double latitude, double longitude) const
+{
+    return latitude >= _latIndex && latitude <= _latIndex + 1 && longitude >= _lonIndex && longitude <= _lonIndex + 1;
+}
+
+double TerrainTile::_sample(int row, int column) const
+{
+    qint16 height = _heights[(row * _samplesPerSide) + column];
+    return height == _voidHeight ? std::numeric_limits<double>::quiet_NaN() : height;
+}
+
+double TerrainTile::elevation(double latitude, double longitude) const
+{
+    if (!isValid() || !contains(latitude, longitude)) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    int     lastSpacing = _samplesPerSide - 1;
+    double  y = (_latIndex + 1 - latitude) * lastSpacing;
+    double  x = (longitude - _lonIndex) * lastSpacing;
+    int     row = qBound(0, (int)y, lastSpacing - 1);
+    int     column = qBound(0, (int)x, lastSpacing - 1);
+    double  fy = y - row;
+    double  fx = x - column;
+
+    double samples[4] = {
+        _sample(row,        column),
+        _sample(row,        column + 1),
+        _sample(row + 1,    column),
+        _sample(row + 1,    column + 1),
+    };
+    double weights[4] = {
+        (1 - fx) * (1 - fy),
+        fx * (1 - fy),
+        (1 - fx) * fy,
+        fx * fy,
+    };
+
+    double weightedSum = 0;
+    double totalWeight = 0;
+    for (int i=0; i<4; i++) {
+        if (!qIsNaN(samples[i])) {
+            weightedSum += samples[i] * weights[i];
+            totalWeight += weights[i];
+        }
+    }
+
+    if (totalWeight <= 0) {
+        // Either all samples are void, or the location sits exactly on one that is
+        for (int i=0; i<4; i++) {
+            if (!qIsNaN(samples[i])) {
+                return samples[i];
+            }
+        }
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    return weightedSum / totalWeight;
+}
+
+const TerrainTile* TerrainTileSet::tile(double latitude, double longitude) const
+{
+    QHash<int, QSharedPointer<const TerrainTile>>::const_iterator it = _tiles.constFind(TerrainTile::tileKey(latitude, longitude));
+
+    return it == _tiles.constEnd() ? NULL : it.value().data();
+}
+
+double TerrainTileSet::elevation(double latitude, double longitude) const
+{
+    const TerrainTile* terrainTile = tile(latitude, longitude);
+
+    return terrainTile ? terrainTile->elevation(latitude, longitude) : std::numeric_limits<double>::quiet_NaN();
+}
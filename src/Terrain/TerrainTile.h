@@ -0,0 +1,94 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#ifndef TerrainTile_H
+#define TerrainTile_H
+
+#include <QByteArray>
+#include <QGeoCoordinate>
+#include <QHash>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+/// Elevation data for a one by one degree area, loaded from an SRTM style .hgt file.
+///
+/// A .hgt file is a square grid of big endian 16 bit heights in meters above mean sea level. The first row is the
+/// northern edge of the tile and the first column is the western edge, so the outermost rows and columns overlap with
+/// the neighbouring tiles. SRTM3 files have 1201 samples per side, SRTM1 files 3601, any other square size is accepted
+/// as well. The file name gives the south west corner of the tile, for example N47W123.hgt.
+///
+/// Tiles are immutable once created, so they can be shared with worker threads.
+class TerrainTile
+{
+public:
+    /// Creates a tile from the contents of a .hgt file. Check isValid to see if the contents could be used.
+    TerrainTile(int latIndex, int lonIndex, const QByteArray& hgtBytes);
+
+    bool    isValid         (void) const { return _samplesPerSide > 1; }
+    int     latIndex        (void) const { return _latIndex; }
+    int     lonIndex        (void) const { return _lonIndex; }
+    int     key             (void) const { return tileKey(_latIndex, _lonIndex); }
+    int     samplesPerSide  (void) const { return _samplesPerSide; }
+
+    /// @return true: coordinate is within the area covered by this tile
+    bool contains(double latitude, double longitude) const;
+
+    /// Bilinear interpolation of the four samples surrounding the location. Void samples are left out of the
+    /// interpolation.
+    /// @return Elevation in meters AMSL, NaN if outside the tile or there is no data at the location
+    double elevation(double latitude, double longitude) const;
+
+    /// @return Index of the tile containing the specified latitude or longitude, which is the south or west edge of it
+    static int tileIndex(double degrees);
+
+    /// @return Unique key for the tile, used to look up tiles in a TerrainTileSet
+    static int tileKey(int latIndex, int lonIndex) { return ((latIndex + 90) * 360) + lonIndex + 180; }
+    static int tileKey(double latitude, double longitude) { return tileKey(tileIndex(latitude), tileIndex(longitude)); }
+
+    static int latIndexFromKey(int key) { return (key / 360) - 90; }
+    static int lonIndexFromKey(int key) { return (key % 360) - 180; }
+
+    /// @return SRTM style tile name such as N47W123, without the file extension
+    static QString tileName(int latIndex, int lonIndex);
+
+    static const char* fileExtension;
+
+private:
+    double _sample(int row, int column) const;
+
+    int             _latIndex;
+    int             _lonIndex;
+    int             _samplesPerSide;
+    QVector<qint16> _heights;           ///< Row major, converted to host byte order
+
+    static const qint16 _voidHeight = -32768;
+};
+
+/// Set of loaded tiles which elevations can be looked up from. Copies are cheap and can be passed to worker threads.
+class TerrainTileSet
+{
+public:
+    void        insert      (QSharedPointer<const TerrainTile> tile) { _tiles[tile->key()] = tile; }
+    void        remove      (int key) { _tiles.remove(key); }
+    bool        contains    (int key) const { return _tiles.contains(key); }
+    int         count       (void) const { return _tiles.count(); }
+    QList<int>  keys        (void) const { return _tiles.keys(); }
+
+    /// @return Tile containing the location, NULL if it is not loaded
+    const TerrainTile* tile(double latitude, double longitude) const;
+
+    /// @return Elevation in meters AMSL, NaN if there is no data for the location
+    double elevation(double latitude, double longitude) const;
+
+private:
+    QHash<int, QSharedPointer<const TerrainTile>> _tiles;
+};
+
+#endif
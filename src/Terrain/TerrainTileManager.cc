@@ -0,0 +1,190 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TerrainTileManager.h"
+#include "QGCLoggingCategory.h"
+#include "QGCMapEngine.h"
+#include "SettingsManager.h"
+#include "AppSettings.h"
+
+#include <QDir>
+#include <QFile>
+#include <QtConcurrent>
+
+QGC_LOGGING_CATEGORY(TerrainTileManagerLog, "TerrainTileManagerLog")
+
+TerrainTileManager::TerrainTileManager(QGCApplication* app, QGCToolbox* toolbox)
+    : QGCTool(app, toolbox)
+{
+
+}
+
+void TerrainTileManager::setToolbox(QGCToolbox* toolbox)
+{
+    QGCTool::setToolbox(toolbox);
+
+    connect(_toolbox->settingsManager()->appSettings(), &AppSettings::savePathsChanged, this, &TerrainTileManager::_savePathsChanged);
+    _savePathsChanged();
+}
+
+void TerrainTileManager::_savePathsChanged(void)
+{
+    setTileDirectory(_toolbox->settingsManager()->appSettings()->terrainSavePath());
+}
+
+void TerrainTileManager::setTileDirectory(const QString& tileDirectory)
+{
+    if (tileDirectory != _tileDirectory) {
+        _tileDirectory = tileDirectory;
+        _unavailableTiles.clear();
+    }
+}
+
+bool TerrainTileManager::requestTiles(const QSet<int>& tileKeys)
+{
+    if (tileKeys.count() > maxTiles) {
+        // Nothing is left out, the mission just holds more tiles in memory than usual
+        qWarning() << "TerrainTileManager: request needs more than maxTiles tiles" << tileKeys.count();
+    }
+
+    // Make room for the new tiles by dropping the ones which are no longer needed
+    QList<int> loadedKeys = _tiles.keys();
+    for (int i=0; i<loadedKeys.count() && _tiles.count() + tileKeys.count() > maxTiles; i++) {
+        if (!tileKeys.contains(loadedKeys[i])) {
+            _tiles.remove(loadedKeys[i]);
+        }
+    }
+
+    foreach (int key, tileKeys) {
+        if (_tiles.contains(key) || _pendingTiles.contains(key)) {
+            continue;
+        }
+
+        if (_unavailableTiles.contains(key)) {
+            // Files may have been copied to the tile directory since the last request. The request does not wait for
+            // them, a tile which turns up is used from the next request on.
+            if (!_retryingTiles.contains(key) && _loadFromDirectory(key)) {
+                _retryingTiles.insert(key);
+            }
+            continue;
+        }
+
+        qCDebug(TerrainTileManagerLog) << "Fetching from cache" << TerrainTile::tileName(TerrainTile::latIndexFromKey(key), TerrainTile::lonIndexFromKey(key));
+        _pendingTiles.insert(key);
+        QGCFetchTileTask* task = getQGCMapEngine()->createFetchTileTask(UrlFactory::TerrainElevation, TerrainTile::lonIndexFromKey(key) + 180, TerrainTile::latIndexFromKey(key) + 90, 0);
+        connect(task, &QGCFetchTileTask::tileFetched, this, [this, key](QGCCacheTile* cacheTile) { _cacheTileFetched(key, cacheTile); });
+        connect(task, &QGCMapTask::error, this, [this, key](QGCMapTask::TaskType, QString) { _cacheTileMissing(key); });
+        getQGCMapEngine()->addTask(task);
+    }
+
+    return _pendingTiles.isEmpty();
+}
+
+void TerrainTileManager::_cacheTileFetched(int key, QGCCacheTile* cacheTile)
+{
+    _startTileLoad(key, cacheTile->img(), QString());
+    cacheTile->deleteLater();
+}
+
+void TerrainTileManager::_cacheTileMissing(int key)
+{
+    if (!_loadFromDirectory(key)) {
+        _unavailableTiles.insert(key);
+        _tileDone(key);
+    }
+}
+
+/// Parses the tile on a worker thread, _tileLoaded is called with the result
+///     @param bytes Tile contents, ignored if filePath is set
+///     @param filePath Tile file to read on the worker thread, empty for none
+void TerrainTileManager::_startTileLoad(int key, const QByteArray& bytes, const QString& filePath)
+{
+    QFutureWatcher<LoadedTile_t>* watcher = new QFutureWatcher<LoadedTile_t>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher]() {
+        _tileLoaded(watcher->result());
+        watcher->deleteLater();
+    });
+    watcher->setFuture(QtConcurrent::run(_loadTile, key, bytes, filePath));
+}
+
+/// Starts loading the tile from the tile directory
+///     @return false: No tile directory is set
+bool TerrainTileManager::_loadFromDirectory(int key)
+{
+    if (_tileDirectory.isEmpty()) {
+        return false;
+    }
+
+    QString fileName = QStringLiteral("%1.%2").arg(TerrainTile::tileName(TerrainTile::latIndexFromKey(key), TerrainTile::lonIndexFromKey(key))).arg(TerrainTile::fileExtension);
+    _startTileLoad(key, QByteArray(), QDir(_tileDirectory).filePath(fileName));
+
+    return true;
+}
+
+/// Runs on a worker thread. Tile files are up to 25MB, so they are read here as well.
+TerrainTileManager::LoadedTile_t TerrainTileManager::_loadTile(int key, QByteArray bytes, QString filePath)
+{
+    LoadedTile_t loadedTile;
+
+    loadedTile.key = key;
+    loadedTile.fromDirectory = !filePath.isEmpty();
+
+    if (loadedTile.fromDirectory) {
+        QFile file(filePath);
+        if (!file.open(QIODevice::ReadOnly)) {
+            return loadedTile;
+        }
+        bytes = file.readAll();
+    }
+
+    QSharedPointer<const TerrainTile> tile(new TerrainTile(TerrainTile::latIndexFromKey(key), TerrainTile::lonIndexFromKey(key), bytes));
+    if (!tile->isValid()) {
+        qWarning() << "TerrainTileManager: invalid tile" << (loadedTile.fromDirectory ? filePath : QStringLiteral("in cache")) << TerrainTile::tileName(tile->latIndex(), tile->lonIndex());
+        return loadedTile;
+    }
+
+    loadedTile.tile = tile;
+    if (loadedTile.fromDirectory) {
+        loadedTile.fileBytes = bytes;
+    }
+
+    return loadedTile;
+}
+
+void TerrainTileManager::_tileLoaded(const LoadedTile_t& loadedTile)
+{
+    int key = loadedTile.key;
+
+    if (loadedTile.tile) {
+        qCDebug(TerrainTileManagerLog) << "Loaded" << (loadedTile.fromDirectory ? "from directory" : "from cache") << TerrainTile::tileName(loadedTile.tile->latIndex(), loadedTile.tile->lonIndex()) << "samples per side" << loadedTile.tile->samplesPerSide();
+        _tiles.insert(loadedTile.tile);
+        _unavailableTiles.remove(key);
+        if (loadedTile.fromDirectory) {
+            getQGCMapEngine()->cacheTile(UrlFactory::TerrainElevation, TerrainTile::lonIndexFromKey(key) + 180, TerrainTile::latIndexFromKey(key) + 90, 0, loadedTile.fileBytes, TerrainTile::fileExtension);
+        }
+    } else if (!loadedTile.fromDirectory && _loadFromDirectory(key)) {
+        // Invalid tile in the cache database, the tile directory may still have it
+        return;
+    } else {
+        _unavailableTiles.insert(key);
+    }
+
+    if (_retryingTiles.remove(key)) {
+        return;
+    }
+    _tileDone(key);
+}
+
+void TerrainTileManager::_tileDone(int key)
+{
+    _pendingTiles.remove(key);
+    if (_pendingTiles.isEmpty()) {
+        emit tilesLoaded();
+    }
+}
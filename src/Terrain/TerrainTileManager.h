@@ -0,0 +1,85 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#ifndef TerrainTileManager_H
+#define TerrainTileManager_H
+
+#include "QGCToolbox.h"
+#include "TerrainTile.h"
+
+#include <QFutureWatcher>
+#include <QLoggingCategory>
+#include <QSet>
+#include <QSharedPointer>
+#include <QString>
+
+class QGCCacheTile;
+
+Q_DECLARE_LOGGING_CATEGORY(TerrainTileManagerLog)
+
+/// Loads the elevation tiles for the areas missions are planned in.
+///
+/// Tiles are looked up in memory first, then in the map tile cache database and last in the Terrain directory below
+/// the save path. Copying .hgt files into that directory makes terrain data available without any network. Tiles found
+/// in the directory are added to the cache database, so they are kept and exported along with the map tiles. Tile files
+/// are read and parsed on a worker thread.
+class TerrainTileManager : public QGCTool
+{
+    Q_OBJECT
+
+public:
+    TerrainTileManager(QGCApplication* app, QGCToolbox* toolbox);
+
+    // Overrides from QGCTool
+    void setToolbox(QGCToolbox* toolbox) final;
+
+    /// Starts loading the specified tiles. All of them are kept in memory, tiles which are not part of the request may
+    /// be dropped from memory.
+    /// @return true: All tiles are already loaded or unavailable, false: tilesLoaded is signalled once they are
+    bool requestTiles(const QSet<int>& tileKeys);
+
+    /// @return All tiles currently loaded
+    TerrainTileSet tiles(void) const { return _tiles; }
+
+    QString tileDirectory   (void) const { return _tileDirectory; }
+    void    setTileDirectory(const QString& tileDirectory);
+
+    static const int maxTiles = 16; ///< Most tiles kept in memory unless a single request needs more, SRTM1 tiles are 25MB each
+
+signals:
+    void tilesLoaded(void);
+
+private slots:
+    void _savePathsChanged(void);
+
+private:
+    typedef struct {
+        int                                 key;
+        bool                                fromDirectory;
+        QByteArray                          fileBytes;  ///< Contents of the tile file, to add to the cache database
+        QSharedPointer<const TerrainTile>   tile;       ///< NULL if there was no valid tile
+    } LoadedTile_t;
+
+    static LoadedTile_t _loadTile(int key, QByteArray bytes, QString filePath);
+
+    void _cacheTileFetched  (int key, QGCCacheTile* cacheTile);
+    void _cacheTileMissing  (int key);
+    void _startTileLoad     (int key, const QByteArray& bytes, const QString& filePath);
+    bool _loadFromDirectory (int key);
+    void _tileLoaded        (const LoadedTile_t& loadedTile);
+    void _tileDone          (int key);
+
+    QString         _tileDirectory;
+    TerrainTileSet  _tiles;
+    QSet<int>       _pendingTiles;      ///< Waiting for the cache database or the worker thread
+    QSet<int>       _unavailableTiles;  ///< Neither in the cache database nor in the tile directory
+    QSet<int>       _retryingTiles;     ///< Unavailable tiles being looked for in the tile directory again
+};
+
+#endif
@@ -0,0 +1,302 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TerrainTileTest.h"
+#include "TerrainClearance.h"
+#include "TerrainTileManager.h"
+#include "QGCApplication.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QtEndian>
+
+TerrainTileTest::TerrainTileTest(void)
+{
+
+}
+
+QByteArray TerrainTileTest::_hgtBytes(const QVector<qint16>& heights)
+{
+    QByteArray bytes(heights.count() * 2, 0);
+
+    for (int i=0; i<heights.count(); i++) {
+        qToBigEndian<qint16>(heights[i], (uchar*)bytes.data() + (i * 2));
+    }
+
+    return bytes;
+}
+
+/// @return Tile which rises from west to east by the specified height for each column
+QByteArray TerrainTileTest::_rampHgtBytes(int samplesPerSide, int heightPerColumn)
+{
+    QVector<qint16> heights;
+
+    for (int row=0; row<samplesPerSide; row++) {
+        for (int column=0; column<samplesPerSide; column++) {
+            heights.append(column * heightPerColumn);
+        }
+    }
+
+    return _hgtBytes(heights);
+}
+
+void TerrainTileTest::_testTileName(void)
+{
+    QCOMPARE(TerrainTile::tileName(47, -123), QStringLiteral("N47W123"));
+    QCOMPARE(TerrainTile::tileName(-1, 0), QStringLiteral("S01E000"));
+    QCOMPARE(TerrainTile::tileName(0, 7), QStringLiteral("N00E007"));
+
+    QCOMPARE(TerrainTile::tileIndex(47.9), 47);
+    QCOMPARE(TerrainTile::tileIndex(-0.5), -1);
+    QCOMPARE(TerrainTile::tileIndex(-122.1), -123);
+
+    int latIndices[] = { -90, 89, 47, 0 };
+    int lonIndices[] = { -180, 179, -123, 0 };
+    for (size_t i=0; i<sizeof(latIndices)/sizeof(latIndices[0]); i++) {
+        int key = TerrainTile::tileKey(latIndices[i], lonIndices[i]);
+        QCOMPARE(TerrainTile::latIndexFromKey(key), latIndices[i]);
+        QCOMPARE(TerrainTile::lonIndexFromKey(key), lonIndices[i]);
+    }
+    QCOMPARE(TerrainTile::tileKey(47.5, -122.5), TerrainTile::tileKey(47, -123));
+}
+
+void TerrainTileTest::_testElevation(void)
+{
+    // 3x3 tile, first row is the northern edge
+    QVector<qint16> heights;
+    heights << 100 << 200 << 300 <<
+               400 << 500 << 600 <<
+               700 << 800 << 900;
+
+    TerrainTile tile(47, -123, _hgtBytes(heights));
+    QVERIFY(tile.isValid());
+    QCOMPARE(tile.samplesPerSide(), 3);
+    QCOMPARE(tile.elevation(48, -123), 100.0);
+    QCOMPARE(tile.elevation(47, -122), 900.0);
+    QCOMPARE(tile.elevation(47.5, -122.5), 500.0);
+    QCOMPARE(tile.elevation(47.75, -122.75), 300.0);
+    QCOMPARE(tile.elevation(47.5, -122.25), 550.0);
+    QVERIFY(qIsNaN(tile.elevation(46.9, -122.5)));
+    QVERIFY(qIsNaN(tile.elevation(47.5, -121.9)));
+
+    // Void samples are left out of the interpolation
+    heights[4] = -32768;
+    TerrainTile voidTile(47, -123, _hgtBytes(heights));
+    QVERIFY(qAbs(voidTile.elevation(47.75, -122.75) - (700.0 / 3.0)) < 0.001);
+    QVERIFY(!qIsNaN(voidTile.elevation(47.5, -122.5)));
+    QVector<qint16> voidHeights(9, -32768);
+    QVERIFY(qIsNaN(TerrainTile(47, -123, _hgtBytes(voidHeights)).elevation(47.5, -122.5)));
+
+    // Contents which are not a square grid of 16 bit samples
+    QVERIFY(!TerrainTile(47, -123, QByteArray(5, 0)).isValid());
+    QVERIFY(!TerrainTile(47, -123, QByteArray(12, 0)).isValid());
+    QVERIFY(!TerrainTile(47, -123, QByteArray(2, 0)).isValid());
+    QVERIFY(qIsNaN(TerrainTile(47, -123, QByteArray()).elevation(47.5, -122.5)));
+
+    // Tile set looks up the right tile
+    TerrainTileSet tiles;
+    tiles.insert(QSharedPointer<const TerrainTile>(new TerrainTile(47, -123, _hgtBytes(heights))));
+    QCOMPARE(tiles.elevation(47, -123), 700.0);
+    QVERIFY(qIsNaN(tiles.elevation(46.5, -122.5)));
+    QVERIFY(tiles.tile(47.5, -122.5));
+    QVERIFY(!tiles.tile(47.5, -121.5));
+
+    // Timing with an SRTM3 sized tile
+    TerrainTile srtm3Tile(47, -123, _rampHgtBytes(1201, 1));
+    QCOMPARE(srtm3Tile.samplesPerSide(), 1201);
+    QElapsedTimer timer;
+    timer.start();
+    double sum = 0;
+    for (int i=0; i<100000; i++) {
+        sum += srtm3Tile.elevation(47.0 + (i % 1000) * 0.001, -123.0 + (i / 1000) * 0.01);
+    }
+    qDebug() << "Sampled 100000 elevations in" << timer.nsecsElapsed() / 1000 << "usecs" << sum;
+    QVERIFY(qAbs(srtm3Tile.elevation(47.5, -122.5) - 600.0) < 0.001);
+}
+
+void TerrainTileTest::_testClearance(void)
+{
+    // Terrain rises 1000 meters from west to east across the tile
+    TerrainTileSet tiles;
+    tiles.insert(QSharedPointer<const TerrainTile>(new TerrainTile(47, -123, _rampHgtBytes(11, 100))));
+
+    QGeoCoordinate home(47.5, -122.95, 0);
+    QVERIFY(qAbs(tiles.elevation(home.latitude(), home.longitude()) - 50) < 0.001);
+
+    QList<TerrainClearance::Path_t> paths;
+    TerrainClearance::Path_t        path;
+
+    // Absolute altitude
+    path.coordinates << QGeoCoordinate(47.5, -122.9, 1200) << QGeoCoordinate(47.5, -122.1, 1200);
+    path.relativeAltitude << false << false;
+    paths.append(path);
+
+    // Relative altitudes are relative to the terrain at home
+    path.coordinates[0].setAltitude(1000);
+    path.coordinates[1].setAltitude(1000);
+    path.relativeAltitude[0] = true;
+    path.relativeAltitude[1] = true;
+    paths.append(path);
+
+    // Runs off the loaded tile
+    path.coordinates[0] = QGeoCoordinate(47.5, -122.5, 1200);
+    path.coordinates[1] = QGeoCoordinate(47.5, -121.5, 1200);
+    path.relativeAltitude[0] = false;
+    path.relativeAltitude[1] = false;
+    paths.append(path);
+
+    // No terrain data at all
+    path.coordinates[0] = QGeoCoordinate(10.5, 10.5, 100);
+    path.coordinates[1] = QGeoCoordinate(10.5, 10.6, 100);
+    paths.append(path);
+
+    QList<TerrainClearance::Result_t> results = TerrainClearance::compute(home, paths, tiles, NULL);
+    QCOMPARE(results.count(), paths.count());
+
+    QVERIFY(qAbs(results[0].minClearance - 300) < 0.01);
+    QVERIFY(qAbs(results[0].minLocation.longitude() - -122.1) < 0.0001);
+    QVERIFY(qAbs(results[0].maxTerrain - 900) < 0.01);
+    QVERIFY(results[0].sampleCount > 1000);
+    QCOMPARE(results[0].missingCount, 0);
+
+    QVERIFY(qAbs(results[1].minClearance - 150) < 0.01);
+
+    // Nearest sample to the tile edge is within one sample spacing
+    QVERIFY(qAbs(results[2].minClearance - 200) < 1);
+    QVERIFY(results[2].missingCount > 0);
+    QVERIFY(results[2].missingCount < results[2].sampleCount);
+
+    QVERIFY(qIsNaN(results[3].minClearance));
+    QVERIFY(qIsNaN(results[3].maxTerrain));
+    QCOMPARE(results[3].missingCount, results[3].sampleCount);
+
+    // Cancelled computation returns early
+    QAtomicInt cancel(1);
+    QCOMPARE(TerrainClearance::compute(home, paths, tiles, &cancel).count(), 0);
+
+    // Tiles needed for the paths
+    QSet<int> keys = TerrainClearance::tileKeys(home, paths);
+    QVERIFY(keys.contains(TerrainTile::tileKey(47, -123)));
+    QVERIFY(keys.contains(TerrainTile::tileKey(47, -122)));
+    QVERIFY(keys.contains(TerrainTile::tileKey(10, 10)));
+    QCOMPARE(keys.count(), 3);
+
+    // Long legs are never cut short
+    TerrainClearance::Path_t longPath;
+    longPath.coordinates << QGeoCoordinate(47.5, -122.5, 1200) << QGeoCoordinate(47.5, -100.5, 1200);
+    longPath.relativeAltitude << false << false;
+    QCOMPARE(TerrainClearance::tileKeys(home, QList<TerrainClearance::Path_t>() << longPath).count(), 23);
+
+    TerrainClearance::Path_t changedPath = paths[1];
+    QVERIFY(TerrainClearance::samePath(paths[1], changedPath));
+    changedPath.coordinates[1].setAltitude(1001);
+    QVERIFY(!TerrainClearance::samePath(paths[1], changedPath));
+}
+
+void TerrainTileTest::_testTileDirectory(void)
+{
+    QTemporaryDir tileDir;
+    QVERIFY(tileDir.isValid());
+
+    // Unit tests run against a temporary cache database, so it holds only what the tests put in it.
+    // The tile without valid data in the directory is never added to the cache database.
+    int latIndex = -89;
+    int validLonIndex = -180;
+    int invalidLonIndex = -179;
+    int validKey = TerrainTile::tileKey(latIndex, validLonIndex);
+    int invalidKey = TerrainTile::tileKey(latIndex, invalidLonIndex);
+
+    QFile validFile(QDir(tileDir.path()).filePath(TerrainTile::tileName(latIndex, validLonIndex) + QStringLiteral(".hgt")));
+    QVERIFY(validFile.open(QIODevice::WriteOnly));
+    QByteArray tileBytes = _rampHgtBytes(11, 100);
+    QCOMPARE(validFile.write(tileBytes), (qint64)tileBytes.count());
+    validFile.close();
+
+    QFile invalidFile(QDir(tileDir.path()).filePath(TerrainTile::tileName(latIndex, invalidLonIndex) + QStringLiteral(".hgt")));
+    QVERIFY(invalidFile.open(QIODevice::WriteOnly));
+    QCOMPARE(invalidFile.write(QByteArray(5, 0)), (qint64)5);
+    invalidFile.close();
+
+    QSet<int> keys;
+    keys << validKey << invalidKey;
+
+    {
+        TerrainTileManager manager(qgcApp(), qgcApp()->toolbox());
+        manager.setTileDirectory(tileDir.path());
+
+        QSignalSpy spyTilesLoaded(&manager, &TerrainTileManager::tilesLoaded);
+        if (!manager.requestTiles(keys)) {
+            QVERIFY(spyTilesLoaded.wait(10000));
+        }
+        QVERIFY(manager.tiles().contains(validKey));
+        QVERIFY(!manager.tiles().contains(invalidKey));
+        QVERIFY(qAbs(manager.tiles().elevation(latIndex + 0.5, validLonIndex + 0.5) - 500) < 0.001);
+
+        // Everything is known now, so nothing to wait for
+        spyTilesLoaded.clear();
+        QVERIFY(manager.requestTiles(keys));
+        QCOMPARE(spyTilesLoaded.count(), 0);
+    }
+
+    // The tile loaded from the directory is now in the cache database
+    {
+        QTemporaryDir emptyDir;
+        TerrainTileManager manager(qgcApp(), qgcApp()->toolbox());
+        manager.setTileDirectory(emptyDir.path());
+
+        QSignalSpy spyTilesLoaded(&manager, &TerrainTileManager::tilesLoaded);
+        QVERIFY(!manager.requestTiles(keys));
+        QVERIFY(spyTilesLoaded.wait(10000));
+        QVERIFY(manager.tiles().contains(validKey));
+        QVERIFY(!manager.tiles().contains(invalidKey));
+    }
+}
+
+void TerrainTileTest::_testRequestAboveMaxTiles(void)
+{
+    QTemporaryDir tileDir;
+    QVERIFY(tileDir.isValid());
+
+    QSet<int> keys;
+    QByteArray tileBytes = _rampHgtBytes(11, 100);
+    for (int i=0; i<TerrainTileManager::maxTiles + 1; i++) {
+        int latIndex = -88;
+        int lonIndex = -180 + i;
+
+        QFile file(QDir(tileDir.path()).filePath(TerrainTile::tileName(latIndex, lonIndex) + QStringLiteral(".hgt")));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QCOMPARE(file.write(tileBytes), (qint64)tileBytes.count());
+        file.close();
+        keys.insert(TerrainTile::tileKey(latIndex, lonIndex));
+    }
+
+    TerrainTileManager manager(qgcApp(), qgcApp()->toolbox());
+    manager.setTileDirectory(tileDir.path());
+
+    QSignalSpy spyTilesLoaded(&manager, &TerrainTileManager::tilesLoaded);
+    if (!manager.requestTiles(keys)) {
+        QVERIFY(spyTilesLoaded.wait(10000));
+    }
+
+    // None of the requested tiles is dropped to stay within maxTiles
+    QCOMPARE(manager.tiles().count(), keys.count());
+    foreach (int key, keys) {
+        QVERIFY(manager.tiles().contains(key));
+    }
+
+    // A later request drops the unneeded tiles again
+    QSet<int> oneKey;
+    oneKey.insert(TerrainTile::tileKey(-88, -180));
+    QVERIFY(manager.requestTiles(oneKey));
+    QVERIFY(manager.tiles().count() <= TerrainTileManager::maxTiles);
+    QVERIFY(manager.tiles().contains(TerrainTile::tileKey(-88, -180)));
+}
@@ -0,0 +1,36 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "TerrainTile.h"
+
+#include <QByteArray>
+#include <QVector>
+
+/// Unit test for TerrainTile, TerrainClearance and TerrainTileManager
+class TerrainTileTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    TerrainTileTest(void);
+
+private slots:
+    void _testTileName(void);
+    void _testElevation(void);
+    void _testClearance(void);
+    void _testTileDirectory(void);
+    void _testRequestAboveMaxTiles(void);
+
+private:
+    QByteArray _hgtBytes(const QVector<qint16>& heights);
+    QByteArray _rampHgtBytes(int samplesPerSide, int heightPerColumn);
+};
@@ -40,6 +40,9 @@ static const char* kPublicLogKey            = "PublicLog";
 static const char* kFeedback                = "feedback";
 static const char* kVideoURL                = "videoUrl";
 
+static const int kWriteBufferSize           = 64 * 1024;
+static const int kMaxULogMessageLength      = 0xFFFF + 3;
+
 //-----------------------------------------------------------------------------
 MAVLinkLogFiles::MAVLinkLogFiles(MAVLinkLogManager* manager, const QString& filePath, bool newFile)
     : _manager(manager)
@@ -110,17 +113,51 @@ MAVLinkLogFiles::setUploaded(bool uploaded)
     emit uploadedChanged();
 }
 
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+MAVLinkLogWriter::MAVLinkLogWriter(FILE* fd)
+    : _fd(fd)
+    , _error(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogWriter::write(QByteArray data)
+{
+    if(_fd && !error()) {
+        if(fwrite(data.constData(), 1, data.size(), _fd) != (size_t)data.size()) {
+            qCDebug(MAVLinkLogManagerLog) << "File IO error:" << data.size() << "bytes";
+            _error.store(1);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogWriter::close()
+{
+    if(_fd) {
+        if(fclose(_fd) != 0) {
+            _error.store(1);
+        }
+        _fd = NULL;
+    }
+}
+
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 MAVLinkLogProcessor::MAVLinkLogProcessor()
-    : _fd(NULL)
-    , _written(0)
+    : _written(0)
     , _sequence(-1)
     , _numDrops(0)
     , _gotHeader(false)
-    , _error(false)
     , _record(NULL)
+    , _writerThread(NULL)
+    , _writer(NULL)
 {
+    _ulogMessage.reserve(kMaxULogMessageLength);
+    _writeBuffer.reserve(kWriteBufferSize);
 }
 
 //-----------------------------------------------------------------------------
@@ -133,9 +170,19 @@ MAVLinkLogProcessor::~MAVLinkLogProcessor()
 void
 MAVLinkLogProcessor::close()
 {
-    if(_fd) {
-        fclose(_fd);
-        _fd = NULL;
+    if(_writer) {
+        _flush();
+        //-- Runs after the writes already queued
+        QMetaObject::invokeMethod(_writer, "close", Qt::BlockingQueuedConnection);
+        _writerThread->quit();
+        _writerThread->wait();
+        delete _writer;
+        delete _writerThread;
+        _writer = NULL;
+        _writerThread = NULL;
+        if(_record) {
+            _record->setSize(_written);
+        }
     }
 }
 
@@ -143,7 +190,7 @@ MAVLinkLogProcessor::close()
 bool
 MAVLinkLogProcessor::valid()
 {
-    return (_fd != NULL) && (_record != NULL);
+    return (_writer != NULL) && (_record != NULL);
 }
 
 //-----------------------------------------------------------------------------
@@ -155,8 +202,12 @@ MAVLinkLogProcessor::create(MAVLinkLogManager* manager, const QString path, uint
                       id,
                       QDateTime::currentDateTime().toString("yyyy-MM-dd-hh-mm-ss-zzz").toLocal8Bit().data(),
                       manager->logExtension().toLocal8Bit().data());
-    _fd = fopen(_fileName.toLocal8Bit().data(), "wb");
-    if(_fd) {
+    FILE* fd = fopen(_fileName.toLocal8Bit().data(), "wb");
+    if(fd) {
+        _writer = new MAVLinkLogWriter(fd);
+        _writerThread = new QThread();
+        _writer->moveToThread(_writerThread);
+        _writerThread->start();
         _record = new MAVLinkLogFiles(manager, _fileName, true);
         _record->setWriting(true);
         _sequence = -1;
@@ -201,97 +252,104 @@ MAVLinkLogProcessor::_checkSequence(uint16_t seq, int& num_drops)
 
 //-----------------------------------------------------------------------------
 void
-MAVLinkLogProcessor::_writeData(void* data, int len)
+MAVLinkLogProcessor::_writeData(const void* data, int len)
 {
-    if(!_error) {
-        _error = fwrite(data, 1, len, _fd) != (size_t)len;
-        if(!_error) {
-            _written += len;
-            if(_record) {
-                _record->setSize(_written);
-            }
-        } else {
-            qCDebug(MAVLinkLogManagerLog) << "File IO error:" << len << "bytes into" << _fileName;
-        }
+    _writeBuffer.append((const char*)data, len);
+    _written += len;
+    if(_writeBuffer.size() >= kWriteBufferSize) {
+        _flush();
     }
 }
 
 //-----------------------------------------------------------------------------
-QByteArray
-MAVLinkLogProcessor::_writeUlogMessage(QByteArray& data)
+void
+MAVLinkLogProcessor::_flush()
 {
-    //-- Write ulog data w/o integrity checking, assuming data starts with a
-    //   valid ulog message. returns the remaining data at the end.
-    while(data.length() > 2) {
-        uint8_t* ptr = (uint8_t*)data.data();
-        int message_length = ptr[0] + (ptr[1] * 256) + 3; // 3 = ULog msg header
-        if(message_length > data.length())
+    if(_writeBuffer.size()) {
+        //-- The writer gets the buffer without a copy, a new one is started for the following data
+        QMetaObject::invokeMethod(_writer, "write", Qt::QueuedConnection, Q_ARG(QByteArray, _writeBuffer));
+        _writeBuffer = QByteArray();
+        _writeBuffer.reserve(kWriteBufferSize);
+    }
+}
+
+//-----------------------------------------------------------------------------
+/// Writes the complete ULog messages at the start of the data in a single write, without integrity checking.
+///     @return Length of the complete messages, the rest is the start of a message which continues in the next payload
+int
+MAVLinkLogProcessor::_frameUlogMessages(const uint8_t* data, int len)
+{
+    int pos = 0;
+    while(len - pos > 2) {
+        int message_length = data[pos] + (data[pos + 1] * 256) + 3; // 3 = ULog msg header
+        if(message_length > len - pos)
             break;
-        _writeData(data.data(), message_length);
-        data.remove(0, message_length);
+        pos += message_length;
+    }
+    if(pos) {
+        _writeData(data, pos);
     }
-    return data;
+    return pos;
 }
 
 //-----------------------------------------------------------------------------
 bool
-MAVLinkLogProcessor::processStreamData(uint16_t sequence, uint8_t first_message, QByteArray data)
+MAVLinkLogProcessor::processStreamData(uint16_t sequence, uint8_t first_message, const QByteArray& data)
 {
+    if(_writer->error()) {
+        return false;
+    }
     int num_drops = 0;
-    _error = false;
-    while(_checkSequence(sequence, num_drops)) {
-        //-- The first 16 bytes need special treatment (this sounds awfully brittle)
-        if(!_gotHeader) {
-            if(data.size() < 16) {
-                //-- Shouldn't happen but if it does, we might as well close shop.
-                qCWarning(MAVLinkLogManagerLog) << "Corrupt log header. Canceling log download.";
-                return false;
-            }
-            //-- Write header
-            _writeData(data.data(), 16);
-            data.remove(0, 16);
-            _gotHeader = true;
-            // What about data start offset now that we removed 16 bytes off the start?
-        }
-        if(_gotHeader && num_drops > 0) {
-            if(num_drops > 25) num_drops = 25;
-            //-- Hocus Pocus
-            //   Write a dropout message. We don't really know the actual duration,
-            //   so just use the number of drops * 10 ms
-            uint8_t bogus[] = {2, 0, 79, 0, 0};
-            bogus[3] = num_drops * 10;
-            _writeData(bogus, sizeof(bogus));
-        }
-        if(num_drops > 0) {
-            _writeUlogMessage(_ulogMessage);
-            _ulogMessage.clear();
-            //-- If no useful information in this message. Drop it.
-            if(first_message == 255) {
-                break;
-            }
-            if(first_message > 0) {
-                data.remove(0, first_message);
-                first_message = 0;
-            }
-        }
-        if(first_message == 255 && _ulogMessage.length() > 0) {
-            _ulogMessage.append(data);
-            break;
-        }
-        if(_ulogMessage.length()) {
-            _writeData(_ulogMessage.data(), _ulogMessage.length());
-            if(first_message) {
-                _writeData(data.left(first_message).data(), first_message);
-            }
-            _ulogMessage.clear();
+    if(!_checkSequence(sequence, num_drops)) {
+        return true;
+    }
+    const uint8_t*  ptr = (const uint8_t*)data.constData();
+    const int       len = data.size();
+    int             pos = 0;
+    //-- The first 16 bytes need special treatment (this sounds awfully brittle)
+    if(!_gotHeader) {
+        if(len < 16) {
+            //-- Shouldn't happen but if it does, we might as well close shop.
+            qCWarning(MAVLinkLogManagerLog) << "Corrupt log header. Canceling log download.";
+            return false;
         }
-        if(first_message) {
-            data.remove(0, first_message);
+        //-- Write header
+        _writeData(ptr, 16);
+        pos = 16;
+        _gotHeader = true;
+    }
+    //-- first_message is an offset from the start of the payload, including the header
+    int message_start = first_message == 255 ? len : qBound(pos, (int)first_message, len);
+    if(num_drops > 0) {
+        if(num_drops > 25) num_drops = 25;
+        //-- Hocus Pocus
+        //   Write a dropout message. We don't really know the actual duration,
+        //   so just use the number of drops * 10 ms
+        uint8_t bogus[] = {2, 0, 79, 0, 0};
+        bogus[3] = num_drops * 10;
+        _writeData(bogus, sizeof(bogus));
+        //-- The rest of the message in progress was lost
+        _ulogMessage.resize(0);
+    } else if(_ulogMessage.size()) {
+        //-- Complete the message in progress with the data before the next message starts
+        _ulogMessage.append((const char*)ptr + pos, message_start - pos);
+        const uint8_t* message = (const uint8_t*)_ulogMessage.constData();
+        bool complete = _ulogMessage.size() > 2 && _ulogMessage.size() >= message[0] + (message[1] * 256) + 3;
+        if(first_message != 255 || complete) {
+            _writeData(_ulogMessage.constData(), _ulogMessage.size());
+            _ulogMessage.resize(0);
         }
-        _ulogMessage = _writeUlogMessage(data);
-        break;
     }
-    return !_error;
+    //-- Frame the messages which start in this payload, there are none if first_message is 255
+    if(message_start < len) {
+        int framed = _frameUlogMessages(ptr + message_start, len - message_start);
+        //-- Keeps the allocation for the next partial message
+        _ulogMessage.append((const char*)ptr + message_start + framed, len - message_start - framed);
+    }
+    if(_record) {
+        _record->setSize(_written);
+    }
+    return !_writer->error();
 }
 
 //-----------------------------------------------------------------------------
@@ -12,6 +12,8 @@
 #define MAVLinkLogManager_H
 
 #include <QObject>
+#include <QAtomicInt>
+#include <QThread>
 
 #include "QmlObjectListModel.h"
 #include "QGCLoggingCategory.h"
@@ -73,6 +75,24 @@ private:
 };
 
 //-----------------------------------------------------------------------------
+/// Writes log data to the file from its own thread, so file IO does not block the GUI thread.
+class MAVLinkLogWriter : public QObject
+{
+    Q_OBJECT
+public:
+    MAVLinkLogWriter    (FILE* fd);
+    bool                error       () { return _error.load() != 0; }
+public slots:
+    void                write       (QByteArray data);
+    void                close       ();
+private:
+    FILE*               _fd;
+    QAtomicInt          _error;
+};
+
+//-----------------------------------------------------------------------------
+/// Frames the ULog messages in LOGGING_DATA payloads. Complete messages are copied straight from the payload into
+/// the write buffer, only a message which continues in the next payload is kept back.
 class MAVLinkLogProcessor
 {
 public:
@@ -83,21 +103,23 @@ public:
     bool                create      (MAVLinkLogManager *manager, const QString path, uint8_t id);
     MAVLinkLogFiles*    record      () { return _record; }
     QString             fileName    () { return _fileName; }
-    bool                processStreamData(uint16_t _sequence, uint8_t first_message, QByteArray data);
+    bool                processStreamData(uint16_t _sequence, uint8_t first_message, const QByteArray& data);
 private:
     bool                _checkSequence(uint16_t seq, int &num_drops);
-    QByteArray          _writeUlogMessage(QByteArray &data);
-    void                _writeData(void* data, int len);
+    int                 _frameUlogMessages(const uint8_t* data, int len);
+    void                _writeData(const void* data, int len);
+    void                _flush      ();
 private:
-    FILE*               _fd;
     quint32             _written;
     int                 _sequence;
     int                 _numDrops;
     bool                _gotHeader;
-    bool                _error;
-    QByteArray          _ulogMessage;
+    QByteArray          _ulogMessage;       ///< Start of a message which continues in the next payload
+    QByteArray          _writeBuffer;       ///< Data waiting to be handed to the writer thread
     QString             _fileName;
     MAVLinkLogFiles*    _record;
+    QThread*            _writerThread;
+    MAVLinkLogWriter*   _writer;
 };
 
 //-----------------------------------------------------------------------------
@@ -0,0 +1,148 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkLogProcessorTest.h"
+#include "MAVLinkLogManager.h"
+#include "QGCApplication.h"
+
+#include <QDir>
+#include <QFile>
+
+#include <ctime>
+
+MAVLinkLogProcessorTest::MAVLinkLogProcessorTest(void)
+{
+
+}
+
+/// Builds a ULog stream of messages with varied lengths, some longer than a LOGGING_DATA payload
+///     @param messageStarts Filled with the offset of each message in the stream
+QByteArray MAVLinkLogProcessorTest::_ulogStream(int size, QVector<int>& messageStarts)
+{
+    QByteArray stream;
+    stream.reserve(size + 1024);
+    stream.append("ULog\x01\x12\x35\x01", 8);
+    stream.append(QByteArray(_headerLength - 8, '\0'));
+
+    for (int i=0; stream.size() < size; i++) {
+        int payloadLength = (i * 37) % 400 + 1;
+        messageStarts.append(stream.size());
+        stream.append((char)(payloadLength & 0xFF));
+        stream.append((char)(payloadLength >> 8));
+        stream.append('D');
+        for (int j=0; j<payloadLength; j++) {
+            stream.append((char)((i + j) & 0xFF));
+        }
+    }
+
+    return stream;
+}
+
+/// Replays the stream through a MAVLinkLogProcessor the way the vehicle sends it
+///     @param dropPayload Index of payload to drop, -1 for none
+///     @return Name of the log file written, empty on failure
+QString MAVLinkLogProcessorTest::_replay(const QByteArray& stream, const QVector<int>& messageStarts, int dropPayload)
+{
+    MAVLinkLogManager*  manager = qgcApp()->toolbox()->mavlinkLogManager();
+    MAVLinkLogProcessor processor;
+
+    if (!processor.create(manager, QDir::tempPath(), 1)) {
+        return QString();
+    }
+
+    std::clock_t    cpuStart = std::clock();
+    int             nextStart = 0;
+    bool            result = true;
+
+    for (int payload=0; payload * _payloadLength < stream.size() && result; payload++) {
+        int offset = payload * _payloadLength;
+        int length = qMin(_payloadLength, stream.size() - offset);
+
+        // Offset of the first message which starts in the payload, 255 for none
+        while (nextStart < messageStarts.count() && messageStarts[nextStart] < offset) {
+            nextStart++;
+        }
+        int firstMessage = 255;
+        if (nextStart < messageStarts.count() && messageStarts[nextStart] < offset + length) {
+            firstMessage = messageStarts[nextStart] - offset;
+        }
+
+        if (payload != dropPayload) {
+            QByteArray data = QByteArray::fromRawData(stream.constData() + offset, length);
+            result = processor.processStreamData((uint16_t)payload, (uint8_t)firstMessage, data);
+        }
+    }
+    processor.close();
+
+    double cpuMsecs = 1000.0 * (std::clock() - cpuStart) / CLOCKS_PER_SEC;
+    qDebug() << "Replayed" << stream.size() << "bytes," << cpuMsecs / (stream.size() / (1024.0 * 1024.0)) << "ms CPU per MB";
+
+    QString fileName = processor.fileName();
+    delete processor.record();
+
+    return result ? fileName : QString();
+}
+
+/// @return true if the log after the header is made of complete ULog messages
+bool MAVLinkLogProcessorTest::_framed(const QByteArray& log, int& dropoutCount)
+{
+    const uint8_t*  data = (const uint8_t*)log.constData();
+    int             pos = _headerLength;
+
+    dropoutCount = 0;
+    while (pos + 3 <= log.size()) {
+        if (data[pos + 2] == 'O') {
+            dropoutCount++;
+        }
+        pos += data[pos] + (data[pos + 1] * 256) + 3;
+    }
+
+    return pos == log.size();
+}
+
+void MAVLinkLogProcessorTest::_replayTest(void)
+{
+    QVector<int>    messageStarts;
+    QByteArray      stream = _ulogStream(16 * 1024 * 1024, messageStarts);
+
+    QString fileName = _replay(stream, messageStarts, -1);
+    QVERIFY(!fileName.isEmpty());
+
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QByteArray log = file.readAll();
+    file.close();
+    QFile::remove(fileName);
+
+    QCOMPARE(log.size(), stream.size());
+    QVERIFY(log == stream);
+}
+
+void MAVLinkLogProcessorTest::_dropTest(void)
+{
+    QVector<int>    messageStarts;
+    QByteArray      stream = _ulogStream(256 * 1024, messageStarts);
+
+    // Lose a payload part way through a message
+    QString fileName = _replay(stream, messageStarts, 100);
+    QVERIFY(!fileName.isEmpty());
+
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QByteArray log = file.readAll();
+    file.close();
+    QFile::remove(fileName);
+
+    // The message broken by the drop is left out and replaced by a dropout message
+    int dropoutCount;
+    QVERIFY(_framed(log, dropoutCount));
+    QCOMPARE(dropoutCount, 1);
+    QVERIFY(log.size() < stream.size());
+    QVERIFY(log.startsWith(stream.left(100 * _payloadLength - 500)));
+}
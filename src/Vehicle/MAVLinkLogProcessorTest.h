@@ -0,0 +1,39 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#ifndef MAVLinkLogProcessorTest_H
+#define MAVLinkLogProcessorTest_H
+
+#include "UnitTest.h"
+
+#include <QByteArray>
+#include <QVector>
+
+/// Unit test for the ULog framing of MAVLinkLogProcessor. Replays a ULog stream split into LOGGING_DATA payloads.
+class MAVLinkLogProcessorTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    MAVLinkLogProcessorTest(void);
+
+private slots:
+    void _replayTest(void);
+    void _dropTest(void);
+
+private:
+    QByteArray  _ulogStream (int size, QVector<int>& messageStarts);
+    QString     _replay     (const QByteArray& stream, const QVector<int>& messageStarts, int dropPayload);
+    bool        _framed     (const QByteArray& log, int& dropoutCount);
+
+    static const int _headerLength = 16;
+    static const int _payloadLength = 249;  ///< Size of LOGGING_DATA data field
+};
+
+#endif
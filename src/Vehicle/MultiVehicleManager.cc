@@ -35,6 +35,7 @@ MultiVehicleManager::MultiVehicleManager(QGCApplication* app, QGCToolbox* toolbo
     , _parameterReadyVehicleAvailable(false)
     , _activeVehicle(NULL)
     , _offlineEditingVehicle(NULL)
+    , _parameterDownloadCoordinator(NULL)
     , _firmwarePluginManager(NULL)
     , _joystickManager(NULL)
     , _mavlinkProtocol(NULL)
@@ -65,6 +66,8 @@ void MultiVehicleManager::setToolbox(QGCToolbox *toolbox)
 
    connect(_mavlinkProtocol, &MAVLinkProtocol::vehicleHeartbeatInfo, this, &MultiVehicleManager::_vehicleHeartbeatInfo);
 
+   _parameterDownloadCoordinator = new ParameterDownloadCoordinator(this, _toolbox->linkManager(), this);
+
    SettingsManager* settingsManager = toolbox->settingsManager();
    _offlineEditingVehicle = new Vehicle(static_cast<MAV_AUTOPILOT>(settingsManager->appSettings()->offlineEditingFirmwareType()->rawValue().toInt()),
                                         static_cast<MAV_TYPE>(settingsManager->appSettings()->offlineEditingVehicleType()->rawValue().toInt()),
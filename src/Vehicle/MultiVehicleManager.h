@@ -19,6 +19,7 @@
 #include "QmlObjectListModel.h"
 #include "QGCToolbox.h"
 #include "QGCLoggingCategory.h"
+#include "ParameterDownloadCoordinator.h"
 
 class FirmwarePluginManager;
 class FollowMe;
@@ -47,6 +48,9 @@ public:
     /// A disconnected vehicle used for offline editing. It will match the vehicle type specified in Settings.
     Q_PROPERTY(Vehicle*             offlineEditingVehicle           READ offlineEditingVehicle                                          CONSTANT)
 
+    /// Schedules parameter downloads for all vehicles, also provides aggregate parameter download throughput
+    Q_PROPERTY(ParameterDownloadCoordinator* parameterDownloadCoordinator READ parameterDownloadCoordinator                          CONSTANT)
+
     // Methods
 
     Q_INVOKABLE Vehicle* getVehicleById(int vehicleId);
@@ -69,6 +73,8 @@ public:
 
     Vehicle* offlineEditingVehicle(void) { return _offlineEditingVehicle; }
 
+    ParameterDownloadCoordinator* parameterDownloadCoordinator(void) { return _parameterDownloadCoordinator; }
+
     /// Determines if the link is in use by a Vehicle
     ///     @param link Link to test against
     ///     @param skipVehicle Don't consider this Vehicle as part of the test
@@ -104,6 +110,8 @@ private:
     Vehicle*    _activeVehicle;                     ///< Currently active vehicle from a ui perspective
     Vehicle*    _offlineEditingVehicle;             ///< Disconnected vechicle used for offline editing
 
+    ParameterDownloadCoordinator*   _parameterDownloadCoordinator;
+
     QList<Vehicle*> _vehiclesBeingDeleted;          ///< List of Vehicles being deleted in queued phases
     Vehicle*        _vehicleBeingSetActive;         ///< Vehicle being set active in queued phases
 
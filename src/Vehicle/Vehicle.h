@@ -645,6 +645,9 @@ public:
 
     QString gitHash(void) const { return _gitHash; }
 
+    /// @return Unique hardware id reported in AUTOPILOT_VERSION, 0 if the vehicle did not report one
+    quint64 uid(void) const { return _uid; }
+
     bool soloFirmware(void) const { return _soloFirmware; }
     void setSoloFirmware(bool soloFirmware);
 
@@ -1006,6 +1009,7 @@ private:
     FIRMWARE_VERSION_TYPE _firmwareVersionType;
 
     QString _gitHash;
+    quint64 _uid;
 
     int _lastAnnouncedLowBatteryPercent;
 
@@ -71,8 +71,14 @@ MockLink::MockLink(SharedLinkConfigurationPointer& config)
     , _sendGPSPositionDelayCount            (100)   // No gps lock for 5 seconds
     , _currentParamRequestListComponentIndex(-1)
     , _currentParamRequestListParamIndex    (-1)
+    , _logDownloadFileSizes                 (QList<uint32_t>() << 1000)
+    , _logDownloadCurrentId                 (0)
     , _logDownloadCurrentOffset             (0)
     , _logDownloadBytesRemaining            (0)
+    , _logDownloadPacketsPerTick            (1)
+    , _logDownloadLossPercent               (0)
+    , _logDownloadPacketCount               (0)
+    , _logDownloadBytesSent                 (0)
 {
     MockConfiguration* mockConfig = qobject_cast<MockConfiguration*>(_config.data());
     _firmwareType = mockConfig->firmwareType();
@@ -97,8 +103,8 @@ MockLink::MockLink(SharedLinkConfigurationPointer& config)
 MockLink::~MockLink(void)
 {
     _disconnect();
-    if (!_logDownloadFilename.isEmpty()) {
-        QFile::remove(_logDownloadFilename);
+    foreach (const QString& logDownloadFilename, _logDownloadFilenames) {
+        QFile::remove(logDownloadFilename);
     }
 }
 
@@ -902,7 +908,7 @@ void MockLink::_respondWithAutopilotVersion(void)
                                             (uint8_t *)&customVersion,       // os_custom_version,
                                             0,                               // vendor_id,
                                             0,                               // product_id,
-                                            0);                              // uid
+                                            0x4D4F434B00000000ull | _vehicleSystemId); // uid
     respondWithMavlinkMessage(msg);
 }
 
@@ -1193,17 +1199,19 @@ void MockLink::_handleLogRequestList(const mavlink_message_t& msg)
         return;
     }
 
-    mavlink_message_t responseMsg;
-    mavlink_msg_log_entry_pack_chan(_vehicleSystemId,
-                                    _vehicleComponentId,
-                                    _mavlinkChannel,
-                                    &responseMsg,
-                                    _logDownloadLogId,       // log id
-                                    1,                       // num_logs
-                                    1,                       // last_log_num
-                                    0,                       // time_utc
-                                    _logDownloadFileSize);   // size
-    respondWithMavlinkMessage(responseMsg);
+    for (int logId=0; logId<_logDownloadFileSizes.count(); logId++) {
+        mavlink_message_t responseMsg;
+        mavlink_msg_log_entry_pack_chan(_vehicleSystemId,
+                                        _vehicleComponentId,
+                                        _mavlinkChannel,
+                                        &responseMsg,
+                                        logId,                                  // log id
+                                        _logDownloadFileSizes.count(),          // num_logs
+                                        _logDownloadFileSizes.count() - 1,      // last_log_num
+                                        0,                                      // time_utc
+                                        _logDownloadFileSizes[logId]);          // size
+        respondWithMavlinkMessage(responseMsg);
+    }
 }
 
 void MockLink::_handleLogRequestData(const mavlink_message_t& msg)
@@ -1212,26 +1220,29 @@ void MockLink::_handleLogRequestData(const mavlink_message_t& msg)
 
     mavlink_msg_log_request_data_decode(&msg, &request);
 
-    if (_logDownloadFilename.isEmpty()) {
-        #ifdef UNITTEST_BUILD
-        _logDownloadFilename = UnitTest::createRandomFile(_logDownloadFileSize);
-        #endif
+    if (request.id >= _logDownloadFileSizes.count()) {
+        qWarning() << "MockLink::_handleLogRequestData id out of range" << request.id;
+        return;
     }
 
-    if (request.id != 0) {
-        qWarning() << "MockLink::_handleLogRequestData id must be 0";
-        return;
+    uint32_t logDownloadFileSize = _logDownloadFileSizes[request.id];
+
+    if (!_logDownloadFilenames.contains(request.id)) {
+        #ifdef UNITTEST_BUILD
+        _logDownloadFilenames[request.id] = UnitTest::createRandomFile(logDownloadFileSize);
+        #endif
     }
 
-    if (request.ofs > _logDownloadFileSize - 1) {
-        qWarning() << "MockLink::_handleLogRequestData offset past end of file request.ofs:size" << request.ofs << _logDownloadFileSize;
+    if (request.ofs > logDownloadFileSize - 1) {
+        qWarning() << "MockLink::_handleLogRequestData offset past end of file request.ofs:size" << request.ofs << logDownloadFileSize;
         return;
     }
 
     // This will trigger _logDownloadWorker to send data
+    _logDownloadCurrentId = request.id;
     _logDownloadCurrentOffset = request.ofs;
-    if (request.ofs + request.count > _logDownloadFileSize) {
-        request.count = _logDownloadFileSize - request.ofs;
+    if (request.ofs + request.count > logDownloadFileSize) {
+        request.count = logDownloadFileSize - request.ofs;
     }
     _logDownloadBytesRemaining = request.count;
 }
@@ -1239,29 +1250,38 @@ void MockLink::_handleLogRequestData(const mavlink_message_t& msg)
 void MockLink::_logDownloadWorker(void)
 {
     if (_logDownloadBytesRemaining != 0) {
-        QFile file(_logDownloadFilename);
+        QFile file(_logDownloadFilenames.value(_logDownloadCurrentId));
         if (file.open(QIODevice::ReadOnly)) {
-            uint8_t buffer[MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN];
-
-            qint64 bytesToRead = qMin(_logDownloadBytesRemaining, (uint32_t)MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
-            Q_ASSERT(file.seek(_logDownloadCurrentOffset));
-            Q_ASSERT(file.read((char *)buffer, bytesToRead) == bytesToRead);
-
-            qDebug() << "MockLink::_logDownloadWorker" << _logDownloadCurrentOffset << _logDownloadBytesRemaining;
-
-            mavlink_message_t responseMsg;
-            mavlink_msg_log_data_pack_chan(_vehicleSystemId,
-                                           _vehicleComponentId,
-                                           _mavlinkChannel,
-                                           &responseMsg,
-                                           _logDownloadLogId,
-                                           _logDownloadCurrentOffset,
-                                           bytesToRead,
-                                           &buffer[0]);
-            respondWithMavlinkMessage(responseMsg);
-
-            _logDownloadCurrentOffset += bytesToRead;
-            _logDownloadBytesRemaining -= bytesToRead;
+            for (int i=0; i<_logDownloadPacketsPerTick && _logDownloadBytesRemaining != 0; i++) {
+                uint8_t buffer[MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN];
+
+                qint64 bytesToRead = qMin(_logDownloadBytesRemaining, (uint32_t)MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
+                if (!file.seek(_logDownloadCurrentOffset) || file.read((char *)buffer, bytesToRead) != bytesToRead) {
+                    qWarning() << "MockLink::_logDownloadWorker read failed" << file.errorString();
+                    break;
+                }
+
+                qCDebug(MockLinkVerboseLog) << "MockLink::_logDownloadWorker" << _logDownloadCurrentOffset << _logDownloadBytesRemaining;
+
+                // Spread the dropped packets evenly rather than dropping a run of them
+                _logDownloadPacketCount++;
+                if ((int)((_logDownloadPacketCount * 19) % 100) >= _logDownloadLossPercent) {
+                    mavlink_message_t responseMsg;
+                    mavlink_msg_log_data_pack_chan(_vehicleSystemId,
+                                                   _vehicleComponentId,
+                                                   _mavlinkChannel,
+                                                   &responseMsg,
+                                                   _logDownloadCurrentId,
+                                                   _logDownloadCurrentOffset,
+                                                   bytesToRead,
+                                                   &buffer[0]);
+                    respondWithMavlinkMessage(responseMsg);
+                }
+
+                _logDownloadCurrentOffset += bytesToRead;
+                _logDownloadBytesRemaining -= bytesToRead;
+                _logDownloadBytesSent += bytesToRead;
+            }
 
             file.close();
         } else {
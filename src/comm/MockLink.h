@@ -141,8 +141,29 @@ public:
     /// Reset the state of the MissionItemHandler to no items, no transactions in progress.
     void resetMissionItemHandler(void) { _missionItemHandler.reset(); }
 
+    /// @return Number of mission items written to the MissionItemHandler since the last reset
+    int missionItemWriteCount(void) const { return _missionItemHandler.writeItemCount(); }
+
+    /// @return Number of mission items requested from the MissionItemHandler since the last reset
+    int missionItemReadCount(void) const { return _missionItemHandler.readRequestCount(); }
+
     /// Returns the filename for the simulated log file. Only available after a download is requested.
-    QString logDownloadFile(void) { return _logDownloadFilename; }
+    QString logDownloadFile(int logId = 0) { return _logDownloadFilenames.value(logId); }
+
+    /// Sets the size of the simulated log file, must be called before the log list is requested
+    void setLogDownloadFileSize(uint32_t size) { setLogDownloadFileSizes(QList<uint32_t>() << size); }
+
+    /// Sets the number of simulated log files and their sizes, must be called before the log list is requested
+    void setLogDownloadFileSizes(const QList<uint32_t>& sizes) { _logDownloadFileSizes = sizes; }
+
+    /// Sets the number of LOG_DATA packets sent in each 2 msec interval
+    void setLogDownloadPacketsPerTick(int packetsPerTick) { _logDownloadPacketsPerTick = packetsPerTick; }
+
+    /// Sets the percentage of LOG_DATA packets which are dropped instead of sent
+    void setLogDownloadLossPercent(int lossPercent) { _logDownloadLossPercent = lossPercent; }
+
+    /// @return Number of log bytes sent or dropped since the link was created
+    quint64 logDownloadBytesSent(void) const { return _logDownloadBytesSent; }
 
     static MockLink* startPX4MockLink            (bool sendStatusText, MockConfiguration::FailureMode_t failureMode = MockConfiguration::FailNone);
     static MockLink* startGenericMockLink        (bool sendStatusText, MockConfiguration::FailureMode_t failureMode = MockConfiguration::FailNone);
@@ -233,12 +254,15 @@ private:
     int _currentParamRequestListComponentIndex; // Current component index for param request list workflow, -1 for no request in progress
     int _currentParamRequestListParamIndex;     // Current parameter index for param request list workflow
 
-    static const uint16_t _logDownloadLogId = 0;        ///< Id of siumulated log file
-    static const uint32_t _logDownloadFileSize = 1000;  ///< Size of simulated log file
-
-    QString _logDownloadFilename;           ///< Filename for log download which is in progress
+    QList<uint32_t> _logDownloadFileSizes;  ///< Sizes of simulated log files, index is the log id
+    QMap<int, QString> _logDownloadFilenames; ///< Filenames of logs which have been requested, key is the log id
+    uint16_t    _logDownloadCurrentId;      ///< Id of log we are sending from
     uint32_t    _logDownloadCurrentOffset;  ///< Current offset we are sending from
     uint32_t    _logDownloadBytesRemaining; ///< Number of bytes still to send, 0 = send inactive
+    int         _logDownloadPacketsPerTick; ///< LOG_DATA packets sent per 500Hz task run
+    int         _logDownloadLossPercent;    ///< Percentage of LOG_DATA packets dropped
+    uint32_t    _logDownloadPacketCount;    ///< LOG_DATA packets sent or dropped, used to pick the ones to drop
+    quint64     _logDownloadBytesSent;
 
     static double       _defaultVehicleLatitude;
     static double       _defaultVehicleLongitude;
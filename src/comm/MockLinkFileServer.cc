@@ -10,6 +10,7 @@
 
 #include "MockLinkFileServer.h"
 #include "MockLink.h"
+#include "QGC.h"
 
 const MockLinkFileServer::ErrorMode_t MockLinkFileServer::rgFailureModes[] = {
     MockLinkFileServer::errModeNoResponse,
@@ -32,8 +33,14 @@ const MockLinkFileServer::FileTestCase MockLinkFileServer::rgFileTestCases[MockL
 // We only support a single fixed session
 const uint8_t MockLinkFileServer::_sessionId = 1;
 
+const int MockLinkFileServer::_burstPacketCount = 200;
+
 MockLinkFileServer::MockLinkFileServer(uint8_t systemIdServer, uint8_t componentIdServer, MockLink* mockLink) :
+    _readFileLength(0),
     _errMode(errModeNone),
+    _burstLossPercent(0),
+    _burstDuplicatePercent(0),
+    _burstPacketIndex(0),
     _systemIdServer(systemIdServer),
     _componentIdServer(componentIdServer),
     _mockLink(mockLink)
@@ -41,6 +48,23 @@ MockLinkFileServer::MockLinkFileServer(uint8_t systemIdServer, uint8_t component
 
 }
 
+/// @brief Looks up the length of one of the files known to the server.
+///     @return true: file found, false: unknown file
+bool MockLinkFileServer::_findFile(const QString& path, uint32_t& length)
+{
+    for (size_t i=0; i<cFileTestCases; i++) {
+        if (path == rgFileTestCases[i].filename) {
+            length = rgFileTestCases[i].length;
+            return true;
+        }
+    }
+    if (_extraFiles.contains(path)) {
+        length = _extraFiles[path];
+        return true;
+    }
+    return false;
+}
+
 /// @brief Handles List command requests. Only supports root folder paths.
 ///         File list returned is set using the setFileList method.
 void MockLinkFileServer::_listCommand(uint8_t senderSystemId, uint8_t senderComponentId, FileManager::Request* request, uint16_t seqNumber)
@@ -109,16 +133,7 @@ void MockLinkFileServer::_openCommand(uint8_t senderSystemId, uint8_t senderComp
     path = (char *)request->data;
     
     // Check path against one of our known test cases
-
-    bool found = false;
-    for (size_t i=0; i<cFileTestCases; i++) {
-        if (path == rgFileTestCases[i].filename) {
-            found = true;
-            _readFileLength = rgFileTestCases[i].length;
-            break;
-        }
-    }
-    if (!found) {
+    if (!_findFile(path, _readFileLength)) {
         _sendNak(senderSystemId, senderComponentId, FileManager::kErrFail, outgoingSeqNumber, FileManager::kCmdOpenFileRO);
         return;
     }
@@ -191,11 +206,12 @@ void MockLinkFileServer::_streamCommand(uint8_t senderSystemId, uint8_t senderCo
         return;
     }
     
-    uint32_t readOffset = 0;	// offset into file for reading
-    uint32_t ackOffset = 0;     // offset for ack
-    uint8_t cDataAck;           // number of bytes in ack
+    uint32_t readOffset = request->hdr.offset;  // offset into file for reading
+    uint32_t ackOffset = readOffset;            // offset for ack
+    uint8_t cDataAck;                           // number of bytes in ack
     
-    while (readOffset < _readFileLength) {
+    // The burst continues from the requested offset, up to _burstPacketCount packets
+    for (int packet=0; packet<_burstPacketCount && readOffset < _readFileLength; packet++) {
         cDataAck = 0;
         
         if (readOffset != 0) {
@@ -218,19 +234,63 @@ void MockLinkFileServer::_streamCommand(uint8_t senderSystemId, uint8_t senderCo
         // We should always have written something, otherwise there is something wrong with the code above
         Q_ASSERT(cDataAck);
         
+        bool lastPacket = packet == _burstPacketCount - 1 || readOffset >= _readFileLength;
+
         response.hdr.session = _sessionId;
         response.hdr.size = cDataAck;
         response.hdr.offset = ackOffset;
         response.hdr.opcode = FileManager::kRspAck;
         response.hdr.req_opcode = FileManager::kCmdBurstReadFile;
+        response.hdr.burstComplete = lastPacket && readOffset < _readFileLength;
         
-        _sendResponse(senderSystemId, senderComponentId, &response, outgoingSeqNumber);
+        // Simulated packet loss skips the packet but still uses up its sequence number
+        if (lastPacket || (_burstPacketIndex * 19) % 100 >= (uint32_t)_burstLossPercent) {
+            _sendResponse(senderSystemId, senderComponentId, &response, outgoingSeqNumber);
+            if ((_burstPacketIndex * 23) % 100 < (uint32_t)_burstDuplicatePercent) {
+                _sendResponse(senderSystemId, senderComponentId, &response, outgoingSeqNumber);
+            }
+        }
+        _burstPacketIndex++;
         
         outgoingSeqNumber = _nextSeqNumber(outgoingSeqNumber);
         ackOffset += cDataAck;
     }
 	
-    _sendNak(senderSystemId, senderComponentId, FileManager::kErrEOF, outgoingSeqNumber, FileManager::kCmdBurstReadFile);
+    if (readOffset >= _readFileLength) {
+        _sendNak(senderSystemId, senderComponentId, FileManager::kErrEOF, outgoingSeqNumber, FileManager::kCmdBurstReadFile);
+    }
+}
+
+/// @brief Handles CalcFileCRC32 command requests. Returns the CRC32 of the file contents.
+void MockLinkFileServer::_calcCRC32Command(uint8_t senderSystemId, uint8_t senderComponentId, FileManager::Request* request, uint16_t seqNumber)
+{
+    FileManager::Request    response;
+    uint16_t                outgoingSeqNumber = _nextSeqNumber(seqNumber);
+    uint32_t                length;
+
+    QString path = QString::fromLatin1((char *)request->data, (int)strnlen((char *)request->data, sizeof(request->data)));
+    if (!_findFile(path, length)) {
+        _sendNak(senderSystemId, senderComponentId, FileManager::kErrFail, outgoingSeqNumber, FileManager::kCmdCalcFileCRC32);
+        return;
+    }
+
+    // Data is a repeating sequence of 0x00, 0x01, .. 0xFF.
+    quint8 pattern[256];
+    for (int i=0; i<256; i++) {
+        pattern[i] = i;
+    }
+    quint32 checksum = 0;
+    for (uint32_t offset=0; offset<length; offset+=sizeof(pattern)) {
+        checksum = QGC::crc32(pattern, qMin((uint32_t)sizeof(pattern), length - offset), checksum);
+    }
+
+    response.hdr.opcode = FileManager::kRspAck;
+    response.hdr.req_opcode = FileManager::kCmdCalcFileCRC32;
+    response.hdr.session = 0;
+    response.hdr.size = sizeof(uint32_t);
+    response.checksum = checksum;
+
+    _sendResponse(senderSystemId, senderComponentId, &response, outgoingSeqNumber);
 }
 
 void MockLinkFileServer::_terminateCommand(uint8_t senderSystemId, uint8_t senderComponentId, FileManager::Request* request, uint16_t seqNumber)
@@ -316,6 +376,10 @@ void MockLinkFileServer::handleFTPMessage(const mavlink_message_t& message)
             _streamCommand(message.sysid, message.compid, request, incomingSeqNumber);
             break;
 
+        case FileManager::kCmdCalcFileCRC32:
+            _calcCRC32Command(message.sysid, message.compid, request, incomingSeqNumber);
+            break;
+
         case FileManager::kCmdTerminateSession:
             _terminateCommand(message.sysid, message.compid, request, incomingSeqNumber);
             break;
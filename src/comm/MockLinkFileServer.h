@@ -16,6 +16,7 @@
 
 #include "FileManager.h"
 
+#include <QMap>
 #include <QStringList>
 
 class MockLink;
@@ -45,6 +46,17 @@ public:
     /// @brief Sets the error mode for command responses. This allows you to simulate various server errors.
     void setErrorMode(ErrorMode_t errMode) { _errMode = errMode; };
     
+    /// @brief Adds a file which can be downloaded along with the test case files. The contents follow the same
+    /// pattern as the test case files.
+    void addFile(const QString& filename, uint32_t length) { _extraFiles[filename] = length; }
+    
+    /// @brief Sets the percentage of Burst packets dropped to simulate a lossy link. The last packet of each
+    /// burst is always sent.
+    void setBurstLossPercent(int lossPercent) { _burstLossPercent = lossPercent; }
+    
+    /// @brief Sets the percentage of Burst packets sent twice, to simulate a link which repeats packets.
+    void setBurstDuplicatePercent(int duplicatePercent) { _burstDuplicatePercent = duplicatePercent; }
+    
     /// @brief Array of failure modes you can cycle through for testing. By looping through this array you can avoid
     /// hardcoding the specific error modes in your unit test. This way when new error modes are added your unit test
     /// code may not need to be modified.
@@ -85,15 +97,23 @@ private:
     void _openCommand(uint8_t senderSystemId, uint8_t senderComponentId, FileManager::Request* request, uint16_t seqNumber);
     void _readCommand(uint8_t senderSystemId, uint8_t senderComponentId, FileManager::Request* request, uint16_t seqNumber);
 	void _streamCommand(uint8_t senderSystemId, uint8_t senderComponentId, FileManager::Request* request, uint16_t seqNumber);
+    void _calcCRC32Command(uint8_t senderSystemId, uint8_t senderComponentId, FileManager::Request* request, uint16_t seqNumber);
+    bool _findFile(const QString& path, uint32_t& length);
     void _terminateCommand(uint8_t senderSystemId, uint8_t senderComponentId, FileManager::Request* request, uint16_t seqNumber);
     void _resetCommand(uint8_t senderSystemId, uint8_t senderComponentId, uint16_t seqNumber);
     uint16_t _nextSeqNumber(uint16_t seqNumber);
     
     QStringList _fileList;  ///< List of files returned by List command
     
+    QMap<QString, uint32_t> _extraFiles;    ///< Files added with addFile, value is file length
+    
     static const uint8_t    _sessionId;
-    uint8_t                 _readFileLength;    ///< Length of active file being read
+    static const int        _burstPacketCount;  ///< Maximum number of packets in a burst
+    uint32_t                _readFileLength;    ///< Length of active file being read
     ErrorMode_t             _errMode;           ///< Currently set error mode, as specified by setErrorMode
+    int                     _burstLossPercent;  ///< Percentage of Burst packets dropped
+    int                     _burstDuplicatePercent; ///< Percentage of Burst packets sent twice
+    uint32_t                _burstPacketIndex;  ///< Burst packets sent or dropped, used to pick the ones to drop
     const uint8_t           _systemIdServer;    ///< System ID for server
     const uint8_t           _componentIdServer; ///< Component ID for server
     MockLink*               _mockLink;          ///< MockLink to communicate through
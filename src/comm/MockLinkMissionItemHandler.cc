@@ -17,6 +17,8 @@ QGC_LOGGING_CATEGORY(MockLinkMissionItemHandlerLog, "MockLinkMissionItemHandlerL
 
 MockLinkMissionItemHandler::MockLinkMissionItemHandler(MockLink* mockLink, MAVLinkProtocol* mavlinkProtocol)
     : _mockLink(mockLink)
+    , _writeItemCount(0)
+    , _readRequestCount(0)
     , _missionItemResponseTimer(NULL)
     , _failureMode(FailNone)
     , _sendHomePositionOnEmptyList(false)
@@ -60,6 +62,10 @@ bool MockLinkMissionItemHandler::handleMessage(const mavlink_message_t& msg)
         case MAVLINK_MSG_ID_MISSION_COUNT:
             _handleMissionCount(msg);
             break;
+
+        case MAVLINK_MSG_ID_MISSION_WRITE_PARTIAL_LIST:
+            _handleMissionWritePartialList(msg);
+            break;
             
         case MAVLINK_MSG_ID_MISSION_ACK:
             // Acks are received back for each MISSION_ITEM message
@@ -129,6 +135,8 @@ void MockLinkMissionItemHandler::_handleMissionRequest(const mavlink_message_t&
     
     Q_ASSERT(request.target_system == _mockLink->vehicleId());
     Q_ASSERT(request.seq < _missionItems.count());
+
+    _readRequestCount++;
     
     if (_failureMode == FailReadRequest0NoResponse && request.seq == 0) {
         qCDebug(MockLinkMissionItemHandlerLog) << "_handleMissionRequest not responding due to failure mode FailReadRequest0NoResponse";
@@ -215,6 +223,32 @@ void MockLinkMissionItemHandler::_handleMissionCount(const mavlink_message_t& ms
     }
 }
 
+void MockLinkMissionItemHandler::_handleMissionWritePartialList(const mavlink_message_t& msg)
+{
+    mavlink_mission_write_partial_list_t partialList;
+
+    mavlink_msg_mission_write_partial_list_decode(&msg, &partialList);
+    Q_ASSERT(partialList.target_system == _mockLink->vehicleId());
+
+    qCDebug(MockLinkMissionItemHandlerLog) << "_handleMissionWritePartialList write sequence start:end" << partialList.start_index << partialList.end_index;
+
+    if (_failureMode == FailWritePartialListErrorAck) {
+        qCDebug(MockLinkMissionItemHandlerLog) << "_handleMissionWritePartialList sending ack error due to failure mode";
+        _sendAck(MAV_MISSION_UNSUPPORTED);
+        return;
+    }
+
+    if (partialList.start_index < 0 || partialList.start_index > partialList.end_index || partialList.end_index >= _missionItems.count()) {
+        _sendAck(MAV_MISSION_ERROR);
+        return;
+    }
+
+    // Existing items are kept, only the items in the range are replaced
+    _writeSequenceIndex = partialList.start_index;
+    _writeSequenceCount = partialList.end_index + 1;
+    _requestNextMissionItem(_writeSequenceIndex);
+}
+
 void MockLinkMissionItemHandler::_requestNextMissionItem(int sequenceNumber)
 {
     qCDebug(MockLinkMissionItemHandlerLog) << "_requestNextMissionItem write sequence sequenceNumber:" << sequenceNumber << "_failureMode:" << _failureMode;
@@ -291,6 +325,7 @@ void MockLinkMissionItemHandler::_handleMissionItem(const mavlink_message_t& msg
     Q_ASSERT(missionItem.target_system == _mockLink->vehicleId());
     
     _missionItems[missionItem.seq] = missionItem;
+    _writeItemCount++;
     
     _writeSequenceIndex++;
     if (_writeSequenceIndex < _writeSequenceCount) {
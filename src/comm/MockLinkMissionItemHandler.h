@@ -60,6 +60,7 @@ public:
         FailWriteFinalAckNoResponse,        // Don't send the final MISSION_ACK
         FailWriteFinalAckErrorAck,          // Send an error as the final MISSION_ACK
         FailWriteFinalAckMissingRequests,   // Send the MISSION_ACK before all items have been requested
+        FailWritePartialListErrorAck,       // Respond to MISSION_WRITE_PARTIAL_LIST with MISSION_ACK error, as if partial writes are not supported
     } FailureMode_t;
 
     /// Sets a failure mode for unit testing
@@ -76,7 +77,13 @@ public:
     void sendUnexpectedMissionRequest(void);
     
     /// Reset the state of the MissionItemHandler to no items, no transactions in progress.
-    void reset(void) { _missionItems.clear(); }
+    void reset(void) { _missionItems.clear(); _writeItemCount = 0; _readRequestCount = 0; }
+
+    /// @return Number of MISSION_ITEM messages received in write sequences since the last reset
+    int writeItemCount(void) const { return _writeItemCount; }
+
+    /// @return Number of MISSION_REQUEST messages received in read sequences since the last reset
+    int readRequestCount(void) const { return _readRequestCount; }
 
     void setSendHomePositionOnEmptyList(bool sendHomePositionOnEmptyList) { _sendHomePositionOnEmptyList = sendHomePositionOnEmptyList; }
 
@@ -88,6 +95,7 @@ private:
     void _handleMissionRequest(const mavlink_message_t& msg);
     void _handleMissionItem(const mavlink_message_t& msg);
     void _handleMissionCount(const mavlink_message_t& msg);
+    void _handleMissionWritePartialList(const mavlink_message_t& msg);
     void _requestNextMissionItem(int sequenceNumber);
     void _sendAck(MAV_MISSION_RESULT ackType);
     void _startMissionItemResponseTimer(void);
@@ -97,6 +105,8 @@ private:
     
     int _writeSequenceCount;    ///< Numbers of items about to be written
     int _writeSequenceIndex;    ///< Current index being reqested
+    int _writeItemCount;        ///< Number of items received in write sequences
+    int _readRequestCount;      ///< Number of items requested in read sequences
     
     typedef QMap<uint16_t, mavlink_mission_item_t>   MissionList_t;
     MissionList_t   _missionItems;
@@ -24,6 +24,8 @@
 #include <QUdpSocket>
 #include <QtPlugin>
 #include <QStringListModel>
+#include <QScopedPointer>
+#include <QTemporaryDir>
 #include "QGCApplication.h"
 #include "AppMessages.h"
 
@@ -222,7 +224,18 @@ int main(int argc, char *argv[])
 
     app->_initCommon();
     //-- Initialize Cache System
-    getQGCMapEngine()->init();
+    QString                         mapCachePath;
+    QScopedPointer<QTemporaryDir>   unitTestMapCacheDir;
+#ifdef UNITTEST_BUILD
+    if (runUnitTests) {
+        // Unit tests write to the map cache, keep them away from the user's tiles
+        unitTestMapCacheDir.reset(new QTemporaryDir());
+        if (unitTestMapCacheDir->isValid()) {
+            mapCachePath = unitTestMapCacheDir->path();
+        }
+    }
+#endif
+    getQGCMapEngine()->init(mapCachePath);
 
     int exitCode = 0;
 
@@ -16,6 +16,8 @@
 #include "UAS.h"
 #include "QGCApplication.h"
 
+#include <QElapsedTimer>
+
 FileManagerTest::FileManagerTest(void)
     : _fileServer(NULL)
     , _fileManager(NULL)
@@ -194,6 +196,89 @@ void FileManagerTest::_listTest(void)
     }
 }
 
+/// Burst downloads a large file over a link which loses and repeats packets. The lost data is read again, repeated
+/// packets are dropped, the file is verified with the CRC32 from the server and the download rate is reported.
+void FileManagerTest::_burstDownloadTest(void)
+{
+    Q_ASSERT(_fileManager);
+    Q_ASSERT(_multiSpy);
+    Q_ASSERT(_multiSpy->checkNoSignals() == true);
+
+    const char*     filename = "large.qgc";
+    const uint32_t  fileLength = 2 * 1024 * 1024;
+
+    _fileServer->addFile(filename, fileLength);
+    _fileServer->setBurstLossPercent(2);
+    _fileServer->setBurstDuplicatePercent(2);
+
+    QString filePath = QDir::temp().absoluteFilePath(filename);
+    QFile::remove(filePath);
+
+    QElapsedTimer timer;
+    timer.start();
+    _fileManager->streamPath(filename, QDir::temp());
+    QVERIFY(_multiSpy->waitForSignalByIndex(commandCompleteSignalIndex, 60000));
+    qint64 msecs = timer.elapsed();
+    QCOMPARE(_multiSpy->checkNoSignalByMask(commandErrorSignalMask), true);
+
+    qDebug() << "Burst downloaded" << fileLength << "bytes at" << (fileLength / (1024.0 * 1024.0)) / (msecs / 1000.0) << "MB/s";
+
+    _validateFileContents(filePath, fileLength);
+    QVERIFY(!QFile::exists(filePath + ".part"));
+    QFile::remove(filePath);
+}
+
+/// A download which fails part way through leaves the existing local copy of the file untouched
+void FileManagerTest::_failedDownloadKeepsFileTest(void)
+{
+    Q_ASSERT(_fileManager);
+    Q_ASSERT(_multiSpy);
+    Q_ASSERT(_multiSpy->checkNoSignals() == true);
+
+    const char*     filename = "large.qgc";
+    const QByteArray localContents("local copy");
+
+    _fileServer->addFile(filename, 2 * 1024 * 1024);
+    _fileServer->setErrorMode(MockLinkFileServer::errModeNakSecondResponse);
+
+    QString filePath = QDir::temp().absoluteFilePath(filename);
+    QFile localFile(filePath);
+    QVERIFY(localFile.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    QCOMPARE(localFile.write(localContents), (qint64)localContents.size());
+    localFile.close();
+
+    _fileManager->streamPath(filename, QDir::temp());
+    QVERIFY(_multiSpy->waitForSignalByIndex(commandErrorSignalIndex, 60000));
+    QCOMPARE(_multiSpy->checkNoSignalByMask(commandCompleteSignalMask), true);
+
+    QVERIFY(localFile.open(QIODevice::ReadOnly));
+    QCOMPARE(localFile.readAll(), localContents);
+    localFile.close();
+    QVERIFY(!QFile::exists(filePath + ".part"));
+    QFile::remove(filePath);
+}
+
+void FileManagerTest::_validateFileContents(const QString& filePath, uint32_t length)
+{
+	QFile file(filePath);
+	
+	// Make sure file size is correct
+	QCOMPARE(file.size(), (qint64)length);
+	
+	// Read data
+	QVERIFY(file.open(QIODevice::ReadOnly));
+	QByteArray bytes = file.readAll();
+	file.close();
+	
+	// Validate file contents:
+	//      Repeating 0x00, 0x01 .. 0xFF until file is full
+	for (int i=0; i<bytes.length(); i++) {
+		if ((uint8_t)bytes[i] != (uint8_t)(i & 0xFF)) {
+			QCOMPARE((uint8_t)bytes[i], (uint8_t)(i & 0xFF));
+		}
+	}
+}
+
 #if 0
 // Trying to write test code for read and burst mode download as well as implement support in MockLineFileServer reached a point
 // of diminishing returns where the test code and mock server were generating more bugs in themselves than finding problems.
@@ -369,22 +454,4 @@ void FileManagerTest::_streamDownloadTest(void)
     }
 }
 
-void FileManagerTest::_validateFileContents(const QString& filePath, uint8_t length)
-{
-	QFile file(filePath);
-	
-	// Make sure file size is correct
-	QCOMPARE(file.size(), (qint64)length);
-	
-	// Read data
-	QVERIFY(file.open(QIODevice::ReadOnly));
-	QByteArray bytes = file.readAll();
-	file.close();
-	
-	// Validate file contents:
-	//      Repeating 0x00, 0x01 .. 0xFF until file is full
-	for (uint8_t i=0; i<bytes.length(); i++) {
-		QCOMPARE((uint8_t)bytes[i], (uint8_t)(i & 0xFF));
-	}
-}
 #endif
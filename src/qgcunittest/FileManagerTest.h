@@ -40,12 +40,14 @@ private slots:
     void _ackTest(void);
     void _noAckTest(void);
     void _listTest(void);
+    void _burstDownloadTest(void);
+    void _failedDownloadKeepsFileTest(void);
 	
     // Connected to FileManager listEntry signal
     void listEntry(const QString& entry);
     
 private:
-    void _validateFileContents(const QString& filePath, uint8_t length);
+    void _validateFileContents(const QString& filePath, uint32_t length);
 
     enum {
         listEntrySignalIndex = 0,
@@ -16,6 +16,10 @@
 #include "GeoTest.h"
 #include "QGCGeo.h"
 
+#include <QElapsedTimer>
+
+#include <limits>
+
 /*
 GeoTest::GeoTest(void)
 {
@@ -91,3 +95,242 @@ void GeoTest::_convertNedToGeoAtOrigin_test(void)
     QCOMPARE(coord.longitude(), expectedLon);
     QCOMPARE(coord.altitude(), expectedAlt);
 }
+
+/// Fills the arrays with locations spread over a few kilometers around the origin
+void GeoTest::_gridCoordinates(int count, QVector<double>& latitudes, QVector<double>& longitudes)
+{
+    latitudes.resize(count);
+    longitudes.resize(count);
+
+    for (int i=0; i<count; i++) {
+        latitudes[i] = _origin.latitude() + ((i % 100) - 50) * 0.0005;
+        longitudes[i] = _origin.longitude() + ((i / 100) % 100 - 50) * 0.0007;
+    }
+}
+
+void GeoTest::_convertBatch_test(void)
+{
+    QVector<double> latitudes;
+    QVector<double> longitudes;
+    _gridCoordinates(1000, latitudes, longitudes);
+
+    // Include the existing test coordinate and the origin itself
+    latitudes[0] = 47.364869;
+    longitudes[0] = 8.594398;
+    latitudes[1] = _origin.latitude();
+    longitudes[1] = _origin.longitude();
+
+    int             count = latitudes.count();
+    GeoOrigin_t     origin = geoOrigin(_origin);
+    QVector<double> north(count);
+    QVector<double> east(count);
+    convertGeoToNed(latitudes.constData(), longitudes.constData(), count, origin, north.data(), east.data());
+
+    QCOMPARE(north[0], -1281.152128182419801305514);
+    QCOMPARE(east[0], 3486.949719522415307437768);
+    QCOMPARE(north[1], 0.0);
+    QCOMPARE(east[1], 0.0);
+
+    // Batch and single point conversions agree, the batch code is free to order the math differently
+    const double nedTolerance = 1e-6;
+    for (int i=0; i<count; i++) {
+        double x, y, z;
+        convertGeoToNed(QGeoCoordinate(latitudes[i], longitudes[i], 0), _origin, &x, &y, &z);
+        QVERIFY(qAbs(north[i] - x) < nedTolerance);
+        QVERIFY(qAbs(east[i] - y) < nedTolerance);
+
+        convertGeoToNed(latitudes[i], longitudes[i], origin, &x, &y);
+        QVERIFY(qAbs(north[i] - x) < nedTolerance);
+        QVERIFY(qAbs(east[i] - y) < nedTolerance);
+    }
+
+    QVector<double> roundTripLatitudes(count);
+    QVector<double> roundTripLongitudes(count);
+    convertNedToGeo(north.constData(), east.constData(), count, origin, roundTripLatitudes.data(), roundTripLongitudes.data());
+
+    QCOMPARE(roundTripLatitudes[0], 47.364869);
+    QCOMPARE(roundTripLongitudes[0], 8.594398);
+    QCOMPARE(roundTripLatitudes[1], _origin.latitude());
+    QCOMPARE(roundTripLongitudes[1], _origin.longitude());
+
+    const double geoTolerance = 1e-12;
+    for (int i=0; i<count; i++) {
+        QGeoCoordinate coord;
+        convertNedToGeo(north[i], east[i], 0, _origin, &coord);
+        QVERIFY(qAbs(roundTripLatitudes[i] - coord.latitude()) < geoTolerance);
+        QVERIFY(qAbs(roundTripLongitudes[i] - coord.longitude()) < geoTolerance);
+
+        // Round trip is well below a millimeter
+        QVERIFY(qAbs(roundTripLatitudes[i] - latitudes[i]) < 1e-8);
+        QVERIFY(qAbs(roundTripLongitudes[i] - longitudes[i]) < 1e-8);
+    }
+}
+
+void GeoTest::_distance_test(void)
+{
+    QVector<double> latitudes;
+    QVector<double> longitudes;
+    _gridCoordinates(1000, latitudes, longitudes);
+
+    // Long distances and crossing the antimeridian
+    latitudes[0] = -33.8688;
+    longitudes[0] = 151.2093;
+    latitudes[1] = 37.7749;
+    longitudes[1] = -122.4194;
+    latitudes[2] = 10.0;
+    longitudes[2] = 179.9;
+    latitudes[3] = 10.0;
+    longitudes[3] = -179.9;
+
+    int             count = latitudes.count();
+    QVector<double> distances(count);
+    geoDistances(_origin.latitude(), _origin.longitude(), latitudes.constData(), longitudes.constData(), count, distances.data());
+
+    double pathLength = 0;
+    for (int i=0; i<count; i++) {
+        QGeoCoordinate coord(latitudes[i], longitudes[i]);
+
+        double expectedDistance = _origin.distanceTo(coord);
+        QVERIFY(qAbs(distances[i] - expectedDistance) < 1e-6);
+        QVERIFY(qAbs(geoDistance(_origin.latitude(), _origin.longitude(), latitudes[i], longitudes[i]) - expectedDistance) < 1e-6);
+
+        double legDistance, azimuth;
+        geoDistanceAzimuth(_origin.latitude(), _origin.longitude(), latitudes[i], longitudes[i], &legDistance, &azimuth);
+        QCOMPARE(legDistance, geoDistance(_origin.latitude(), _origin.longitude(), latitudes[i], longitudes[i]));
+        QVERIFY(qAbs(azimuth - _origin.azimuthTo(coord)) < 1e-9);
+        QVERIFY(azimuth >= 0 && azimuth < 360);
+
+        QVERIFY(qAbs(geoDistance(geoOrigin(_origin), latitudes[i], longitudes[i]) - expectedDistance) < 1e-6);
+
+        if (i > 0) {
+            pathLength += QGeoCoordinate(latitudes[i - 1], longitudes[i - 1]).distanceTo(coord);
+        }
+    }
+    QVERIFY(qAbs(geoPathLength(latitudes.constData(), longitudes.constData(), count) - pathLength) < 1e-3);
+
+    QVERIFY(qAbs(geoDistance(10.0, 179.9, 10.0, -179.9) - QGeoCoordinate(10.0, 179.9).distanceTo(QGeoCoordinate(10.0, -179.9))) < 1e-6);
+    QCOMPARE(geoDistance(_origin.latitude(), _origin.longitude(), _origin.latitude(), _origin.longitude()), 0.0);
+    QCOMPARE(geoPathLength(latitudes.constData(), longitudes.constData(), 1), 0.0);
+    QCOMPARE(geoPathLength(latitudes.constData(), longitudes.constData(), 0), 0.0);
+}
+
+/// Timing of the batch functions against the per point QGeoCoordinate based code they replace. Each side runs several
+/// times and only its fastest run is reported. The results of both sides must agree, the timings are only logged. Only
+/// runs when large benchmarks are enabled, see UnitTest::largeBenchmarksEnabled.
+void GeoTest::_batchPerformance_test(void)
+{
+    if (!largeBenchmarksEnabled()) {
+        QSKIP("Set QGC_UNITTEST_BENCHMARKS to run the geo batch benchmark");
+    }
+
+    const int       count = 100000;
+    const int       runs = 5;
+    QVector<double> latitudes;
+    QVector<double> longitudes;
+    _gridCoordinates(count, latitudes, longitudes);
+
+    QElapsedTimer   timer;
+    QVector<double> north(count);
+    QVector<double> east(count);
+    double          x, y, z;
+    double          sum = 0;
+    qint64          singleNsecs = std::numeric_limits<qint64>::max();
+    qint64          batchNsecs = std::numeric_limits<qint64>::max();
+
+    for (int run=0; run<runs; run++) {
+        sum = 0;
+        timer.start();
+        for (int i=0; i<count; i++) {
+            convertGeoToNed(QGeoCoordinate(latitudes[i], longitudes[i]), _origin, &x, &y, &z);
+            sum += x + y;
+        }
+        singleNsecs = qMin(singleNsecs, timer.nsecsElapsed());
+
+        timer.start();
+        convertGeoToNed(latitudes.constData(), longitudes.constData(), count, geoOrigin(_origin), north.data(), east.data());
+        batchNsecs = qMin(batchNsecs, timer.nsecsElapsed());
+    }
+    qDebug() << "convertGeoToNed" << count << "points: single" << singleNsecs / 1000 << "usecs, batch" << batchNsecs / 1000 << "usecs";
+    double batchSum = 0;
+    for (int i=0; i<count; i++) {
+        batchSum += north[i] + east[i];
+    }
+    QVERIFY(qAbs(batchSum - sum) < 1e-3);
+
+    QVector<double> roundTripLatitudes(count);
+    QVector<double> roundTripLongitudes(count);
+    QGeoCoordinate  coord;
+    singleNsecs = batchNsecs = std::numeric_limits<qint64>::max();
+
+    for (int run=0; run<runs; run++) {
+        sum = 0;
+        timer.start();
+        for (int i=0; i<count; i++) {
+            convertNedToGeo(north[i], east[i], 0, _origin, &coord);
+            sum += coord.latitude();
+        }
+        singleNsecs = qMin(singleNsecs, timer.nsecsElapsed());
+
+        timer.start();
+        convertNedToGeo(north.constData(), east.constData(), count, geoOrigin(_origin), roundTripLatitudes.data(), roundTripLongitudes.data());
+        batchNsecs = qMin(batchNsecs, timer.nsecsElapsed());
+    }
+    qDebug() << "convertNedToGeo" << count << "points: single" << singleNsecs / 1000 << "usecs, batch" << batchNsecs / 1000 << "usecs";
+    batchSum = 0;
+    for (int i=0; i<count; i++) {
+        batchSum += roundTripLatitudes[i];
+    }
+    QVERIFY(qAbs(batchSum - sum) < 1e-6);
+
+    QVector<double> distances(count);
+    singleNsecs = batchNsecs = std::numeric_limits<qint64>::max();
+
+    for (int run=0; run<runs; run++) {
+        sum = 0;
+        timer.start();
+        for (int i=0; i<count; i++) {
+            sum += _origin.distanceTo(QGeoCoordinate(latitudes[i], longitudes[i]));
+        }
+        singleNsecs = qMin(singleNsecs, timer.nsecsElapsed());
+
+        timer.start();
+        geoDistances(_origin.latitude(), _origin.longitude(), latitudes.constData(), longitudes.constData(), count, distances.data());
+        batchNsecs = qMin(batchNsecs, timer.nsecsElapsed());
+    }
+    qDebug() << "distanceTo" << count << "points: single" << singleNsecs / 1000 << "usecs, batch" << batchNsecs / 1000 << "usecs";
+    batchSum = 0;
+    for (int i=0; i<count; i++) {
+        batchSum += distances[i];
+    }
+    QVERIFY(qAbs(batchSum - sum) < 1e-3);
+
+    // Legs between consecutive locations, as computed for each item by the mission flight status walk
+    double azimuthSum = 0;
+    double batchAzimuthSum = 0;
+    double distance, azimuth;
+    singleNsecs = batchNsecs = std::numeric_limits<qint64>::max();
+
+    for (int run=0; run<runs; run++) {
+        sum = azimuthSum = 0;
+        timer.start();
+        for (int i=1; i<count; i++) {
+            QGeoCoordinate prevCoord(latitudes[i - 1], longitudes[i - 1]);
+            QGeoCoordinate currentCoord(latitudes[i], longitudes[i]);
+            sum += prevCoord.distanceTo(currentCoord);
+            azimuthSum += prevCoord.azimuthTo(currentCoord);
+        }
+        singleNsecs = qMin(singleNsecs, timer.nsecsElapsed());
+
+        batchSum = batchAzimuthSum = 0;
+        timer.start();
+        for (int i=1; i<count; i++) {
+            geoDistanceAzimuth(latitudes[i - 1], longitudes[i - 1], latitudes[i], longitudes[i], &distance, &azimuth);
+            batchSum += distance;
+            batchAzimuthSum += azimuth;
+        }
+        batchNsecs = qMin(batchNsecs, timer.nsecsElapsed());
+    }
+    qDebug() << "distanceTo and azimuthTo" << count - 1 << "legs: single" << singleNsecs / 1000 << "usecs, shared" << batchNsecs / 1000 << "usecs";
+    QVERIFY(qAbs(batchSum - sum) < 1e-3);
+    QVERIFY(qAbs(batchAzimuthSum - azimuthSum) < 1e-3);
+}
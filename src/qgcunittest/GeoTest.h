@@ -17,6 +17,7 @@
 #define GEOTEST_H
 
 #include <QGeoCoordinate>
+#include <QVector>
 
 #include "UnitTest.h"
 
@@ -34,7 +35,12 @@ private slots:
     void _convertGeoToNedAtOrigin_test(void);
     void _convertNedToGeo_test(void);
     void _convertNedToGeoAtOrigin_test(void);
+    void _convertBatch_test(void);
+    void _distance_test(void);
+    void _batchPerformance_test(void);
 private:
+    void _gridCoordinates(int count, QVector<double>& latitudes, QVector<double>& longitudes);
+
     QGeoCoordinate _origin;
 };
 
@@ -0,0 +1,211 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LogCompressorTest.h"
+#include "LogCompressor.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSignalSpy>
+#include <QStorageInfo>
+
+#include <cstring>
+
+/// Log lines are: timestamp, component, key, value. Values for the same timestamp are collected into one row, with
+/// the lines for timestamp 100 split across the file so that they end up in different parse chunks.
+static const char* _testLog =
+        "100\tcomp\tb\t2\n"
+        "100\tcomp\ta\t1\n"
+        "200\tcomp\ta\t3\n"
+        "300\tcomp\tb\t4\r\n"
+        "short line\n"
+        "\n"
+        "300\tcomp\tc\t5\n"
+        "400\tcomp\ta\t6\n"
+        "500\tcomp\tc\tNaN\n"
+        "400\tcomp\ta\t7\n"
+        "100\tcomp\tc\t8";
+
+static const char* _testHeader = "TIMESTAMPms\ta\tb\tc\n";
+
+LogCompressorTest::LogCompressorTest(void)
+{
+
+}
+
+QString LogCompressorTest::_writeLog(const QString& name, const QByteArray& log)
+{
+    QString fileName = _tempDir.path() + "/" + name;
+    QFile   file(fileName);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(log) != log.size()) {
+        return QString();
+    }
+
+    return fileName;
+}
+
+/// Runs the compressor on the log file
+///     @return Output file name, empty if the compressor did not finish
+QString LogCompressorTest::_compress(const QString& logFile, bool holeFilling)
+{
+    LogCompressor   compressor(logFile);
+    QSignalSpy      spyFinished(&compressor, &LogCompressor::finishedFile);
+
+    // The dimensions of the dataset are always reported
+    setExpectedMessageBox(QMessageBox::Ok);
+    compressor.startCompression(holeFilling);
+    if (!spyFinished.wait(600000)) {
+        return QString();
+    }
+    compressor.wait();
+
+    // Let the message box from the compressor thread through
+    QTest::qWait(100);
+    checkExpectedMessageBox();
+
+    return spyFinished[0][0].toString();
+}
+
+QByteArray LogCompressorTest::_readFile(const QString& fileName)
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return QByteArray();
+    }
+
+    return file.readAll();
+}
+
+void LogCompressorTest::_compressTest(void)
+{
+    QString logFile = _writeLog("compress.log", _testLog);
+    QVERIFY(!logFile.isEmpty());
+
+    QString outFile = _compress(logFile, false);
+    QVERIFY(!outFile.isEmpty());
+
+    // The first two rows are dropped since they may be incomplete, the later value for a key wins
+    QByteArray expected(_testHeader);
+    expected += "300\t\t4\t5\n";
+    expected += "400\t7\t\t\n";
+    expected += "500\t\t\tNaN\n";
+    QCOMPARE(_readFile(outFile), expected);
+}
+
+void LogCompressorTest::_holeFillingTest(void)
+{
+    QString logFile = _writeLog("holes.log", _testLog);
+    QVERIFY(!logFile.isEmpty());
+
+    QString outFile = _compress(logFile, true);
+    QVERIFY(!outFile.isEmpty());
+
+    // Holes are filled from the previous row, starting with the second row of the log
+    QByteArray expected(_testHeader);
+    expected += "300\t3\t4\t5\n";
+    expected += "400\t7\t4\t5\n";
+    expected += "500\t7\t4\t5\n";
+    QCOMPARE(_readFile(outFile), expected);
+}
+
+/// A value longer than 64 KB is written out whole
+void LogCompressorTest::_longValueTest(void)
+{
+    const QByteArray longValue(70000, 'x');
+
+    QByteArray log;
+    log += "100\tcomp\ta\t1\n";
+    log += "200\tcomp\ta\t2\n";
+    log += "300\tcomp\ta\t" + longValue + "\n";
+    log += "400\tcomp\ta\t3\n";
+
+    QString logFile = _writeLog("long.log", log);
+    QVERIFY(!logFile.isEmpty());
+
+    QString outFile = _compress(logFile, false);
+    QVERIFY(!outFile.isEmpty());
+
+    QByteArray expected("TIMESTAMPms\ta\n");
+    expected += "300\t" + longValue + "\n";
+    expected += "400\t3\n";
+    QCOMPARE(_readFile(outFile), expected);
+}
+
+/// Timing of a 1 GB log. Only runs when large benchmarks are enabled, see UnitTest::largeBenchmarksEnabled.
+void LogCompressorTest::_benchmarkTest(void)
+{
+    if (!largeBenchmarksEnabled()) {
+        QSKIP("Set QGC_UNITTEST_BENCHMARKS to run the log compressor benchmark");
+    }
+
+    const qint64    logSize = 1024LL * 1024 * 1024;
+    const int       keyCount = 32;
+
+    QStorageInfo storage(_tempDir.path());
+    if (storage.bytesAvailable() < 3 * logSize) {
+        QSKIP("Not enough space for the benchmark log");
+    }
+
+    // Each timestamp has a value for every key. The same block of lines is written repeatedly with the timestamps
+    // updated.
+    const int       timestampsPerBlock = 1024;
+    const int       timestampDigits = 12;
+    QByteArray      block;
+    QList<int>      timestampOffsets;
+    for (int i=0; i<timestampsPerBlock; i++) {
+        for (int key=0; key<keyCount; key++) {
+            timestampOffsets.append(block.size());
+            block += QByteArray(timestampDigits, '0') + "\tMAVLINK\tATTITUDE.field_" + QByteArray::number(key) + "\t" + QByteArray::number(key * 0.125 + i, 'f', 6) + "\n";
+        }
+    }
+
+    QString logFile = _tempDir.path() + "/benchmark.log";
+    QFile   file(logFile);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    quint64 timestamp = 0;
+    while (file.size() < logSize) {
+        for (int i=0; i<timestampOffsets.count(); i++) {
+            if (i % keyCount == 0) {
+                timestamp++;
+            }
+            QByteArray digits = QByteArray::number(timestamp).rightJustified(timestampDigits, '0');
+            memcpy(block.data() + timestampOffsets[i], digits.constData(), timestampDigits);
+        }
+        QCOMPARE(file.write(block), (qint64)block.size());
+    }
+    qint64 size = file.size();
+    file.close();
+
+    QElapsedTimer timer;
+    timer.start();
+    QString outFile = _compress(logFile, true);
+    qint64 msecs = timer.elapsed();
+    QVERIFY(!outFile.isEmpty());
+
+    // One row for each timestamp after the first two, plus the header
+    QFile output(outFile);
+    QVERIFY(output.open(QIODevice::ReadOnly));
+    qint64 rows = 0;
+    QByteArray lastRow;
+    while (!output.atEnd()) {
+        lastRow = output.readLine();
+        rows++;
+    }
+    output.close();
+    QCOMPARE(rows, (qint64)timestamp - 1);
+    QCOMPARE(lastRow.left(lastRow.indexOf('\t')), QByteArray::number(timestamp));
+
+    qDebug() << "Log compressor" << size / (1024 * 1024) << "MB:" << timestamp << "timestamps in" << msecs << "msecs,"
+             << (size / (1024.0 * 1024.0)) / qMax(msecs, (qint64)1) * 1000.0 << "MB/sec";
+
+    QFile::remove(logFile);
+    QFile::remove(outFile);
+}
@@ -0,0 +1,39 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#ifndef LogCompressorTest_H
+#define LogCompressorTest_H
+
+#include "UnitTest.h"
+
+#include <QTemporaryDir>
+
+/// Unit test for the conversion of line based logs to CSV by LogCompressor
+class LogCompressorTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    LogCompressorTest(void);
+
+private slots:
+    void _compressTest(void);
+    void _holeFillingTest(void);
+    void _longValueTest(void);
+    void _benchmarkTest(void);
+
+private:
+    QString     _writeLog   (const QString& name, const QByteArray& log);
+    QString     _compress   (const QString& logFile, bool holeFilling);
+    QByteArray  _readFile   (const QString& fileName);
+
+    QTemporaryDir _tempDir;
+};
+
+#endif
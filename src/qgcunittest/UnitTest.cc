@@ -517,3 +517,8 @@ bool UnitTest::doubleNaNCompare(double value1, double value2)
         return ret;
     }
 }
+
+bool UnitTest::largeBenchmarksEnabled(void)
+{
+    return !qgetenv("QGC_UNITTEST_BENCHMARKS").isEmpty();
+}
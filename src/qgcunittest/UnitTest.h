@@ -96,6 +96,10 @@ public:
     /// @return true: equal
     static bool doubleNaNCompare(double value1, double value2);
 
+    /// Benchmarks which generate hundreds of MB only run when the QGC_UNITTEST_BENCHMARKS environment variable is set
+    /// @return true: run the large benchmarks
+    static bool largeBenchmarksEnabled(void);
+
 protected slots:
     
     // These are all pure virtuals to force the derived class to implement each one and in turn
@@ -38,6 +38,13 @@
 #include "PlanMasterControllerTest.h"
 #include "MissionSettingsTest.h"
 #include "QGCMapPolygonTest.h"
+#include "TerrainTileTest.h"
+#include "GeoTagTest.h"
+#include "ULogReaderTest.h"
+#include "PX4LogParserTest.h"
+#include "MAVLinkLogProcessorTest.h"
+#include "LogCompressorTest.h"
+#include "ParameterDownloadCoordinatorTest.h"
 
 UT_REGISTER_TEST(FactSystemTestGeneric)
 UT_REGISTER_TEST(FactSystemTestPX4)
@@ -63,6 +70,13 @@ UT_REGISTER_TEST(SpeedSectionTest)
 UT_REGISTER_TEST(PlanMasterControllerTest)
 UT_REGISTER_TEST(MissionSettingsTest)
 UT_REGISTER_TEST(QGCMapPolygonTest)
+UT_REGISTER_TEST(TerrainTileTest)
+UT_REGISTER_TEST(GeoTagTest)
+UT_REGISTER_TEST(ULogReaderTest)
+UT_REGISTER_TEST(PX4LogParserTest)
+UT_REGISTER_TEST(MAVLinkLogProcessorTest)
+UT_REGISTER_TEST(LogCompressorTest)
+UT_REGISTER_TEST(ParameterDownloadCoordinatorTest)
 
 // List of unit test which are currently disabled.
 // If disabling a new test, include reason in comment.
@@ -21,6 +21,9 @@
 
 QGC_LOGGING_CATEGORY(FileManagerLog, "FileManagerLog")
 
+const char* FileManager::_partialSuffix = ".part";
+const char* FileManager::_backupSuffix =  ".old";
+
 FileManager::FileManager(QObject* parent, Vehicle* vehicle)
     : QObject(parent)
     , _currentOperation(kCOIdle)
@@ -51,10 +54,24 @@ void FileManager::_openAckResponse(Request* openAck)
     Q_ASSERT(openAck->hdr.size == sizeof(uint32_t));
     _downloadFileSize = openAck->openFileLength;
     
+    // Data is written to a partial file as it arrives, an existing local copy is only replaced once the download is complete
+    QString downloadFilePath = _readFileDownloadDir.absoluteFilePath(_readFileDownloadFilename) + _partialSuffix;
+    _downloadFile.setFileName(downloadFilePath);
+    if (!_downloadFile.open(QIODevice::ReadWrite | QIODevice::Truncate)) {
+        _currentOperation = kCOIdle;
+        _emitErrorMessage(tr("Unable to open local file for writing (%1)").arg(downloadFilePath));
+        _sendResetCommand();
+        return;
+    }
+
     // Start the sequence of read commands
 
     _downloadOffset = 0;            // Start reading at beginning of file
-    _readFileAccumulator.clear();   // Start with an empty file
+    _downloadBytesReceived = 0;
+    _downloadGaps.clear();
+    _downloadCRCOffset = 0;
+    _downloadCRC32 = 0;
+    _downloadRetries = 0;
 
     Request request;
     request.hdr.session = _activeSession;
@@ -73,29 +90,37 @@ void FileManager::_closeDownloadSession(bool success)
     qCDebug(FileManagerLog) << QString("_closeDownloadSession: success(%1)").arg(success);
     
     _currentOperation = kCOIdle;
+    _downloadGaps.clear();
     
     if (success) {
+        _downloadFile.close();
         QString downloadFilePath = _readFileDownloadDir.absoluteFilePath(_readFileDownloadFilename);
+        QString backupFilePath = downloadFilePath + _backupSuffix;
 
-        QFile file(downloadFilePath);
-        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
-            _emitErrorMessage(tr("Unable to open local file for writing (%1)").arg(downloadFilePath));
-            return;
+        // Move an existing local copy aside, it is only deleted once the new file is in place
+        bool backedUp = false;
+        if (QFile::exists(downloadFilePath)) {
+            QFile::remove(backupFilePath);
+            backedUp = QFile::rename(downloadFilePath, backupFilePath);
         }
 
-        qint64 bytesWritten = file.write((const char *)_readFileAccumulator, _readFileAccumulator.length());
-        if (bytesWritten != _readFileAccumulator.length()) {
-            file.close();
-            _emitErrorMessage(tr("Unable to write data to local file (%1)").arg(downloadFilePath));
-            return;
+        if (_downloadFile.rename(downloadFilePath)) {
+            if (backedUp) {
+                QFile::remove(backupFilePath);
+            }
+            emit commandComplete();
+        } else {
+            _downloadFile.remove();
+            if (backedUp) {
+                QFile::rename(backupFilePath, downloadFilePath);
+            }
+            _emitErrorMessage(tr("Unable to rename downloaded file to (%1)").arg(downloadFilePath));
         }
-        file.close();
-
-        emit commandComplete();
+    } else {
+        // Don't leave a partial file behind
+        _downloadFile.remove();
     }
     
-    _readFileAccumulator.clear();
-    
     // Close the open session
     _sendResetCommand();
 }
@@ -128,7 +153,9 @@ void FileManager::_downloadAckResponse(Request* readAck, bool readFile)
         return;
     }
 
-    if (readAck->hdr.offset != _downloadOffset) {
+    // Burst packets can be lost, the missing data is read again once the burst reaches the end of the file. Burst
+    // packets behind the data already received have been dropped by receiveMessage.
+    if (readFile && readAck->hdr.offset != _downloadOffset) {
         _closeDownloadSession(false /* failure */);
         _emitErrorMessage(tr("Download: Offset returned (%1) differs from offset requested/expected (%2)").arg(readAck->hdr.offset).arg(_downloadOffset));
         return;
@@ -136,29 +163,229 @@ void FileManager::_downloadAckResponse(Request* readAck, bool readFile)
     
     qCDebug(FileManagerLog) << QString("_downloadAckResponse: offset(%1) size(%2) burstComplete(%3)").arg(readAck->hdr.offset).arg(readAck->hdr.size).arg(readAck->hdr.burstComplete);
 
-	_downloadOffset += readAck->hdr.size;
-    _readFileAccumulator.append((const char*)readAck->data, readAck->hdr.size);
+    if (readAck->hdr.offset > _downloadOffset) {
+        _downloadGaps.append(qMakePair(_downloadOffset, readAck->hdr.offset - _downloadOffset));
+    }
+    if (!_writeDownloadData(readAck->hdr.offset, readAck->data, readAck->hdr.size)) {
+        _closeDownloadSession(false /* failure */);
+        _emitErrorMessage(tr("Unable to write data to local file (%1)").arg(_downloadFile.fileName()));
+        return;
+    }
+    uint32_t nextOffset = readAck->hdr.offset + readAck->hdr.size;
+    if (nextOffset > _downloadOffset) {
+        // Burst retries only count timeouts which made no progress
+        _downloadRetries = 0;
+    }
+    _downloadOffset = nextOffset;
     
     if (_downloadFileSize != 0) {
-        emit commandProgress(100 * ((float)_readFileAccumulator.length() / (float)_downloadFileSize));
+        emit commandProgress(100 * ((float)_downloadBytesReceived / (float)_downloadFileSize));
     }
 
-    if (readFile || readAck->hdr.burstComplete) {
+    if (readFile) {
         // Possibly still more data to read, send next read request
 
         Request request;
         request.hdr.session = _activeSession;
-        request.hdr.opcode = readFile ? kCmdReadFile : kCmdBurstReadFile;
+        request.hdr.opcode = kCmdReadFile;
         request.hdr.offset = _downloadOffset;
         request.hdr.size = 0;
 
         _sendRequest(&request);
-    } else if (!readFile) {
+    } else if (readAck->hdr.burstComplete) {
+        // Possibly still more data to read, start the next burst
+        _sendBurstReadCommand();
+    } else {
         // Streaming, so next ack should come automatically
         _setupAckTimeout();
     }
 }
 
+/// Respond to the Ack associated with a Read command for data lost during a Burst download.
+void FileManager::_gapReadAckResponse(Request* readAck)
+{
+    QPair<uint32_t, uint32_t>& gap = _downloadGaps.first();
+
+    if (readAck->hdr.session != _activeSession) {
+        _closeDownloadSession(false /* failure */);
+        _emitErrorMessage(tr("Download: Incorrect session returned"));
+        return;
+    }
+
+    if (readAck->hdr.offset != gap.first || readAck->hdr.size == 0) {
+        _closeDownloadSession(false /* failure */);
+        _emitErrorMessage(tr("Download: Offset returned (%1) differs from offset requested/expected (%2)").arg(readAck->hdr.offset).arg(gap.first));
+        return;
+    }
+
+    // The server fills the whole response, only the part which is missing is used
+    uint32_t size = qMin((uint32_t)readAck->hdr.size, gap.second);
+    if (!_writeDownloadData(gap.first, readAck->data, size)) {
+        _closeDownloadSession(false /* failure */);
+        _emitErrorMessage(tr("Unable to write data to local file (%1)").arg(_downloadFile.fileName()));
+        return;
+    }
+    gap.first += size;
+    gap.second -= size;
+    if (gap.second == 0) {
+        _downloadGaps.removeFirst();
+    }
+
+    if (_downloadFileSize != 0) {
+        emit commandProgress(100 * ((float)_downloadBytesReceived / (float)_downloadFileSize));
+    }
+
+    if (_downloadGaps.isEmpty()) {
+        _downloadDataComplete();
+    } else {
+        _sendGapReadCommand();
+    }
+}
+
+/// Respond to the Ack associated with the CalcFileCRC32 command sent to verify a download.
+void FileManager::_calcCRCAckResponse(Request* crcAck)
+{
+    if (crcAck->hdr.size != sizeof(uint32_t)) {
+        _closeDownloadSession(false /* failure */);
+        _emitErrorMessage(tr("Download: Returned invalid size of CRC32 data"));
+        return;
+    }
+
+    if (crcAck->checksum != _downloadCRC32) {
+        _closeDownloadSession(false /* failure */);
+        _emitErrorMessage(tr("Download: CRC32 of downloaded file (%1) differs from vehicle (%2)").arg(_downloadCRC32, 8, 16, QChar('0')).arg(crcAck->checksum, 8, 16, QChar('0')));
+        return;
+    }
+
+    qCDebug(FileManagerLog) << "_calcCRCAckResponse: download verified" << _downloadCRC32;
+    _closeDownloadSession(true /* success */);
+}
+
+/// Writes downloaded data to the local file. The CRC32 is updated while the data arrives in order.
+bool FileManager::_writeDownloadData(uint32_t offset, const uint8_t* data, uint32_t size)
+{
+    // Seeking flushes the write buffer, so only seek when the data does not follow the previous data
+    if (_downloadFile.pos() != (qint64)offset && !_downloadFile.seek(offset)) {
+        return false;
+    }
+    if (_downloadFile.write((const char*)data, size) != (qint64)size) {
+        return false;
+    }
+    _downloadBytesReceived += size;
+
+    if (offset == _downloadCRCOffset) {
+        _downloadCRC32 = QGC::crc32(data, size, _downloadCRC32);
+        _downloadCRCOffset += size;
+    }
+
+    return true;
+}
+
+/// Called when the end of the file has been reached. Reads the data lost during a Burst download, then verifies the
+/// downloaded file.
+void FileManager::_downloadDataComplete(void)
+{
+    if (_downloadOffset < _downloadFileSize) {
+        // Data at the end of the file was lost
+        _downloadGaps.append(qMakePair(_downloadOffset, _downloadFileSize - _downloadOffset));
+        _downloadOffset = _downloadFileSize;
+    }
+
+    if (!_downloadGaps.isEmpty()) {
+        qCDebug(FileManagerLog) << "_downloadDataComplete: reading lost data, gaps:" << _downloadGaps.count();
+        _currentOperation = kCOGapRead;
+        _sendGapReadCommand();
+        return;
+    }
+
+    if (!_finishDownloadCRC()) {
+        _closeDownloadSession(false /* failure */);
+        _emitErrorMessage(tr("Unable to read data from local file (%1)").arg(_downloadFile.fileName()));
+        return;
+    }
+
+    // Verify against the CRC32 calculated by the vehicle
+    _currentOperation = kCOCalcCRC;
+
+    Request request;
+    request.hdr.session = 0;
+    request.hdr.opcode = kCmdCalcFileCRC32;
+    request.hdr.offset = 0;
+    request.hdr.size = 0;
+    _fillRequestWithString(&request, _downloadRemotePath);
+    _sendRequest(&request);
+}
+
+/// Adds the data which was not received in order to the CRC32 of the download, by reading it back from the local file.
+bool FileManager::_finishDownloadCRC(void)
+{
+    if (!_downloadFile.flush()) {
+        return false;
+    }
+
+    if (_downloadCRCOffset < _downloadFile.size()) {
+        if (!_downloadFile.seek(_downloadCRCOffset)) {
+            return false;
+        }
+        while (!_downloadFile.atEnd()) {
+            QByteArray buffer = _downloadFile.read(64 * 1024);
+            if (buffer.isEmpty()) {
+                return false;
+            }
+            _downloadCRC32 = QGC::crc32((const quint8*)buffer.constData(), buffer.size(), _downloadCRC32);
+            _downloadCRCOffset += buffer.size();
+        }
+    }
+
+    return true;
+}
+
+/// Sends a Read command for the first block of data lost during a Burst download.
+void FileManager::_sendGapReadCommand(void)
+{
+    const QPair<uint32_t, uint32_t>& gap = _downloadGaps.first();
+
+    Request request;
+    request.hdr.session = _activeSession;
+    request.hdr.opcode = kCmdReadFile;
+    request.hdr.offset = gap.first;
+    request.hdr.size = qMin(gap.second, (uint32_t)sizeof(request.data));
+
+    _sendRequest(&request);
+}
+
+/// @return true: Packet belongs to a Burst which has moved past it, or to a Burst which has ended
+bool FileManager::_isStaleBurstPacket(Request* request, uint16_t expectedSeqNumber)
+{
+    if (request->hdr.opcode != kRspAck || request->hdr.req_opcode != kCmdBurstReadFile) {
+        return false;
+    }
+
+    switch (_currentOperation) {
+        case kCOBurst:
+            return (int16_t)(request->hdr.seqNumber - expectedSeqNumber) < 0 || request->hdr.offset < _downloadOffset;
+
+        case kCOGapRead:
+        case kCOCalcCRC:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+/// Sends a Burst command to continue from the last data received.
+void FileManager::_sendBurstReadCommand(void)
+{
+    Request request;
+    request.hdr.session = _activeSession;
+    request.hdr.opcode = kCmdBurstReadFile;
+    request.hdr.offset = _downloadOffset;
+    request.hdr.size = 0;
+
+    _sendRequest(&request);
+}
+
 /// @brief Respond to the Ack associated with the List command.
 void FileManager::_listAckResponse(Request* listAck)
 {
@@ -321,12 +548,22 @@ void FileManager::receiveMessage(mavlink_message_t message)
 	
     uint16_t incomingSeqNumber = request->hdr.seqNumber;
     
-    // Make sure we have a good sequence number
+    // Make sure we have a good sequence number. Packets lost from a Burst download skip sequence numbers, the
+    // missing data is found from the offsets.
     uint16_t expectedSeqNumber = _lastOutgoingSeqNumber + 1;
-    if (incomingSeqNumber != expectedSeqNumber) {
+    if (_isStaleBurstPacket(request, expectedSeqNumber)) {
+        // Repeated or late Burst packet, its data has already been received or is read again
+        qCDebug(FileManagerLog) << "Dropped stale burst packet: seqNumber:" << incomingSeqNumber << "offset:" << request->hdr.offset;
+        _setupAckTimeout();
+        return;
+    } else if (_currentOperation == kCOBurst && (int16_t)(incomingSeqNumber - expectedSeqNumber) > 0) {
+        qCDebug(FileManagerLog) << "Burst packets lost:" << (uint16_t)(incomingSeqNumber - expectedSeqNumber);
+    } else if (incomingSeqNumber != expectedSeqNumber) {
         switch (_currentOperation) {
             case kCOBurst:
             case kCORead:
+            case kCOGapRead:
+            case kCOCalcCRC:
                 _closeDownloadSession(false /* failure */);
                 break;
             
@@ -367,7 +604,11 @@ void FileManager::receiveMessage(mavlink_message_t message)
 				break;
 				
 			case kCmdReadFile:
-				_downloadAckResponse(request, true /* read file */);
+                if (_currentOperation == kCOGapRead) {
+                    _gapReadAckResponse(request);
+                } else {
+                    _downloadAckResponse(request, true /* read file */);
+                }
 				break;
 				
 			case kCmdBurstReadFile:
@@ -382,6 +623,10 @@ void FileManager::receiveMessage(mavlink_message_t message)
                 _writeAckResponse(request);
                 break;
                 
+            case kCmdCalcFileCRC32:
+                _calcCRCAckResponse(request);
+                break;
+
 			default:
 				// Ack back from operation which does not require additional work
 				_currentOperation = kCOIdle;
@@ -393,14 +638,20 @@ void FileManager::receiveMessage(mavlink_message_t message)
         // Nak's normally have 1 byte of data for error code, except for kErrFailErrno which has additional byte for errno
         Q_ASSERT((errorCode == kErrFailErrno && request->hdr.size == 2) || request->hdr.size == 1);
         
+        OperationState nakOperation = _currentOperation;
         _currentOperation = kCOIdle;
 
         if (request->hdr.req_opcode == kCmdListDirectory && errorCode == kErrEOF) {
             // This is not an error, just the end of the list loop
             emit commandComplete();
             return;
-        } else if ((request->hdr.req_opcode == kCmdReadFile || request->hdr.req_opcode == kCmdBurstReadFile) && errorCode == kErrEOF) {
+        } else if ((request->hdr.req_opcode == kCmdReadFile || request->hdr.req_opcode == kCmdBurstReadFile) && errorCode == kErrEOF && nakOperation != kCOGapRead) {
             // This is not an error, just the end of the download loop
+            _downloadDataComplete();
+            return;
+        } else if (request->hdr.req_opcode == kCmdCalcFileCRC32) {
+            // Vehicle is not able to calculate the CRC32, the download is kept without being verified
+            qCDebug(FileManagerLog) << "Download not verified, CalcFileCRC32 failed:" << errorString(errorCode);
             _closeDownloadSession(true /* success */);
             return;
         } else if (request->hdr.req_opcode == kCmdCreateFile) {
@@ -520,6 +771,7 @@ void FileManager::_downloadWorker(const QString& from, const QDir& downloadDir,
 	}
 	i++; // move past slash
 	_readFileDownloadFilename = from.right(from.size() - i);
+	_downloadRemotePath = from;
 	
 	_currentOperation = readFile ? kCOOpenRead : kCOOpenBurst;
 	
@@ -664,8 +916,20 @@ void FileManager::_ackTimeout(void)
     // to idle. FileView UI works this way with the List command.
 
     switch (_currentOperation) {
-        case kCORead:
         case kCOBurst:
+            if (_downloadRetries++ < _maxBurstRetries) {
+                // The end of the burst was lost, continue from the last data received
+                qCDebug(FileManagerLog) << "_ackTimeout: restarting burst at offset" << _downloadOffset;
+                _sendBurstReadCommand();
+                break;
+            }
+            _closeDownloadSession(false /* failure */);
+            _emitErrorMessage(tr("Timeout waiting for ack: Download failed"));
+            break;
+
+        case kCORead:
+        case kCOGapRead:
+        case kCOCalcCRC:
             _closeDownloadSession(false /* failure */);
             _emitErrorMessage(tr("Timeout waiting for ack: Download failed"));
             break;
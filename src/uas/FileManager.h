@@ -13,6 +13,8 @@
 
 #include <QObject>
 #include <QDir>
+#include <QFile>
+#include <QPair>
 #include <QTimer>
 
 #include "UASInterface.h"
@@ -42,7 +44,8 @@ public:
 	///     @param downloadDir Local directory to download file to
 	void downloadPath(const QString& from, const QDir& downloadDir);
 	
-	/// Stream downloads the specified file.
+	/// Stream downloads the specified file. Data lost from a burst is read again once the burst reaches the end
+	/// of the file.
 	///     @param from File to download from UAS, fully qualified path
 	///     @param downloadDir Local directory to download file to
 	void streamPath(const QString& from, const QDir& downloadDir);
@@ -109,6 +112,9 @@ private:
 
             // Length of file chunk written by write command
             uint32_t writeFileLength;
+
+            // CRC32 returned by CalcFileCRC32 command
+            uint32_t checksum;
         };
     };
 
@@ -164,6 +170,8 @@ private:
 			kCOBurst,		// waiting for Burst response
             kCOWrite,       // waiting for Write response
             kCOCreate,      // waiting for Create response
+            kCOGapRead,     // waiting for Read response for data lost during Burst download
+            kCOCalcCRC,     // waiting for CalcFileCRC32 response to verify download
         };
     
     bool _sendOpcodeOnlyCmd(uint8_t opcode, OperationState newOpState);
@@ -175,6 +183,14 @@ private:
     void _fillRequestWithString(Request* request, const QString& str);
     void _openAckResponse(Request* openAck);
     void _downloadAckResponse(Request* readAck, bool readFile);
+    void _gapReadAckResponse(Request* readAck);
+    void _calcCRCAckResponse(Request* crcAck);
+    bool _writeDownloadData(uint32_t offset, const uint8_t* data, uint32_t size);
+    void _downloadDataComplete(void);
+    void _sendGapReadCommand(void);
+    void _sendBurstReadCommand(void);
+    bool _isStaleBurstPacket(Request* request, uint16_t expectedSeqNumber);
+    bool _finishDownloadCRC(void);
     void _listAckResponse(Request* listAck);
     void _createAckResponse(Request* createAck);
     void _writeAckResponse(Request* writeAck);
@@ -187,6 +203,10 @@ private:
     
     static QString errorString(uint8_t errorCode);
 
+    static const int _maxBurstRetries = 3;  ///< Burst requests sent again after a timeout before the download fails
+    static const char* _partialSuffix;      ///< Appended to the local file name until the download is verified
+    static const char* _backupSuffix;       ///< Appended to an existing local copy while it is replaced by a download
+
     OperationState  _currentOperation;              ///< Current operation of state machine
     QTimer          _ackTimer;                      ///< Used to signal a timeout waiting for an ack
     
@@ -208,10 +228,16 @@ private:
     QByteArray  _writeFileAccumulator;      ///< Holds file being uploaded
     
     uint32_t    _downloadOffset;            ///< current download offset
-    QByteArray  _readFileAccumulator;       ///< Holds file being downloaded
+    QFile       _downloadFile;              ///< Partial local file data is written to as it arrives
     QDir        _readFileDownloadDir;       ///< Directory to download file to
     QString     _readFileDownloadFilename;  ///< Filename (no path) for download file
+    QString     _downloadRemotePath;        ///< Fully qualified path of file being downloaded
     uint32_t    _downloadFileSize;          ///< Size of file being downloaded
+    uint32_t    _downloadBytesReceived;     ///< Bytes written to the local file
+    QList<QPair<uint32_t, uint32_t> > _downloadGaps;  ///< Offset and length of data lost during a burst download
+    uint32_t    _downloadCRCOffset;         ///< Data before this offset is included in _downloadCRC32
+    quint32     _downloadCRC32;             ///< CRC32 of the downloaded data, calculated as it arrives
+    int         _downloadRetries;           ///< Burst requests sent again after a timeout since data last arrived
 
     uint8_t     _systemIdQGC;               ///< System ID for QGC
     uint8_t     _systemIdServer;            ///< System ID for server